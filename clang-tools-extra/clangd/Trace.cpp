@@ -11,6 +11,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/Chrono.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormatProviders.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Threading.h"
@@ -187,6 +188,75 @@ private:
 
 Key<std::unique_ptr<JSONTracer::JSONSpan>> JSONTracer::SpanKey;
 
+// Writes one line per measurement. Lines are written whole under a lock, so
+// measurements from different threads do not interleave.
+class CSVMetricTracer : public EventTracer {
+public:
+  CSVMetricTracer(llvm::raw_ostream &Out)
+      : Out(Out), Start(std::chrono::steady_clock::now()) {
+    Out << "Kind,Metric,Label,Value,Timestamp\n";
+    Out.flush();
+  }
+
+  Context beginSpan(llvm::StringRef Name, llvm::json::Object *Args) override {
+    return Context::current().clone();
+  }
+
+  void instant(llvm::StringRef Name, llvm::json::Object &&Args) override {}
+
+  void record(const Metric &Metric, double Value,
+              llvm::StringRef Label) override {
+    assert(!needsQuote(Metric.Name) && "metric names are identifiers");
+    std::string QuotedLabel;
+    if (needsQuote(Label))
+      Label = QuotedLabel = quote(Label);
+    uint64_t Micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - Start)
+                          .count();
+    std::lock_guard<std::mutex> Lock(Mu);
+    Out << llvm::formatv("{0},{1},{2},{3:e},{4}.{5:6}\n",
+                         typeName(Metric.Type), Metric.Name, Label, Value,
+                         Micros / 1000000, Micros % 1000000);
+    Out.flush();
+  }
+
+private:
+  static llvm::StringLiteral typeName(Metric::MetricType T) {
+    switch (T) {
+    case Metric::Value:
+      return "v";
+    case Metric::Counter:
+      return "c";
+    case Metric::Distribution:
+      return "d";
+    }
+    llvm_unreachable("Unknown Metric::MetricType enum");
+  }
+
+  static bool needsQuote(llvm::StringRef Text) {
+    // https://www.ietf.org/rfc/rfc4180.txt section 2.6
+    return Text.find_first_of(",\"\r\n") != llvm::StringRef::npos;
+  }
+
+  static std::string quote(llvm::StringRef Text) {
+    std::string Result = "\"";
+    for (char C : Text) {
+      Result.push_back(C);
+      if (C == '"')
+        Result.push_back('"');
+    }
+    Result.push_back('"');
+    return Result;
+  }
+
+  std::mutex Mu;
+  llvm::raw_ostream &Out /*GUARDED_BY(Mu)*/;
+  const std::chrono::steady_clock::time_point Start;
+};
+
+constexpr Metric SpanLatency("span_latency", Metric::Distribution,
+                             "span_name");
+
 EventTracer *T = nullptr;
 } // namespace
 
@@ -202,6 +272,18 @@ std::unique_ptr<EventTracer> createJSONTracer(llvm::raw_ostream &OS,
   return std::make_unique<JSONTracer>(OS, Pretty);
 }
 
+std::unique_ptr<EventTracer> createCSVMetricTracer(llvm::raw_ostream &OS) {
+  return std::make_unique<CSVMetricTracer>(OS);
+}
+
+void Metric::record(double Value, llvm::StringRef Label) const {
+  if (!T)
+    return;
+  assert((LabelName.empty() == Label.empty()) &&
+         "recording a measurement with inconsistent labeling");
+  T->record(*this, Value, Label);
+}
+
 void log(const llvm::Twine &Message) {
   if (!T)
     return;
@@ -221,13 +303,25 @@ static Context makeSpanContext(llvm::Twine Name, llvm::json::Object *Args) {
 // Span keeps a non-owning pointer to the args, which is how users access them.
 // The args are owned by the context though. They stick around until the
 // beginSpan() context is destroyed, when the tracing engine will consume them.
-Span::Span(llvm::Twine Name)
+Span::Span(llvm::Twine Name) : Span(Name, SpanLatency) {}
+
+Span::Span(llvm::Twine Name, const Metric &LatencyMetric)
     : Args(T ? new llvm::json::Object() : nullptr),
-      RestoreCtx(makeSpanContext(Name, Args)) {}
+      RestoreCtx(makeSpanContext(Name, Args)), LatencyMetric(LatencyMetric) {
+  if (T) {
+    this->Name = Name.str();
+    StartTime = std::chrono::steady_clock::now();
+  }
+}
 
 Span::~Span() {
-  if (T)
-    T->endSpan();
+  if (!T)
+    return;
+  T->endSpan();
+  LatencyMetric.record(std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - StartTime)
+                           .count(),
+                       Name);
 }
 
 } // namespace trace
@@ -8,6 +8,8 @@
 //
 // Supports writing performance traces describing clangd's behavior.
 // Traces are consumed by implementations of the EventTracer interface.
+// Metrics, such as the latency of each Span, are reported to the same
+// EventTracer.
 //
 //
 // All APIs are no-ops unless a Session is active (created by ClangdMain).
@@ -18,14 +20,53 @@
 #define LLVM_CLANG_TOOLS_EXTRA_CLANGD_TRACE_H_
 
 #include "Context.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/JSON.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <string>
 
 namespace clang {
 namespace clangd {
 namespace trace {
 
+/// A measurement of clangd's behavior, e.g. the latency of an operation.
+/// Measurements are recorded per label, e.g. the name of the operation.
+/// Metrics that do not need labels use the empty label.
+///
+/// Metrics are usually defined as static constants next to the code they
+/// measure:
+///   constexpr trace::Metric RequestLatency("request_latency",
+///                                          trace::Metric::Distribution,
+///                                          "method_name");
+///   RequestLatency.record(Millis, "textDocument/completion");
+struct Metric {
+  enum MetricType {
+    /// A number whose current value is meaningful. Each measurement replaces
+    /// the previous one.
+    Value,
+    /// A number whose rate of change is meaningful. Each measurement is an
+    /// increment.
+    Counter,
+    /// A distribution of values, e.g. latencies. Each measurement is a sample.
+    Distribution,
+  };
+
+  constexpr Metric(llvm::StringLiteral Name, MetricType Type,
+                   llvm::StringLiteral LabelName = llvm::StringLiteral(""))
+      : Name(Name), Type(Type), LabelName(LabelName) {}
+
+  /// Records a measurement of this metric in the active tracer, if any.
+  void record(double Value, llvm::StringRef Label = "") const;
+
+  /// Uniquely identifies the metric. Should use snake_case identifiers.
+  const llvm::StringLiteral Name;
+  const MetricType Type;
+  /// Describes what the labels are, e.g. "method_name".
+  const llvm::StringLiteral LabelName;
+};
+
 /// A consumer of trace events. The events are produced by Spans and trace::log.
 /// Implementations of this interface must be thread-safe.
 class EventTracer {
@@ -47,6 +88,10 @@ public:
 
   /// Called for instant events.
   virtual void instant(llvm::StringRef Name, llvm::json::Object &&Args) = 0;
+
+  /// Called whenever a metric records a measurement.
+  virtual void record(const Metric &Metric, double Value,
+                      llvm::StringRef Label) {}
 };
 
 /// Sets up a global EventTracer that consumes events produced by Span and
@@ -66,6 +111,13 @@ public:
 std::unique_ptr<EventTracer> createJSONTracer(llvm::raw_ostream &OS,
                                               bool Pretty = false);
 
+/// Create an instance of EventTracer that writes every metric measurement as a
+/// line of CSV, and ignores spans and instant events. The columns are:
+///   Kind,Metric,Label,Value,Timestamp
+/// where Kind is the MetricType and Timestamp is in seconds since the tracer
+/// was created.
+std::unique_ptr<EventTracer> createCSVMetricTracer(llvm::raw_ostream &OS);
+
 /// Records a single instant event, associated with the current thread.
 void log(const llvm::Twine &Name);
 
@@ -78,9 +130,14 @@ void log(const llvm::Twine &Name);
 ///   SPAN_ATTACH(MySpan, "Payload", SomeJSONExpr);
 ///
 /// SomeJSONExpr is evaluated and copied only if actually needed.
+///
+/// The time the Span object is alive is recorded in milliseconds, with the name
+/// of the span as the label, in the "span_latency" distribution or in
+/// \p LatencyMetric.
 class Span {
 public:
   Span(llvm::Twine Name);
+  Span(llvm::Twine Name, const Metric &LatencyMetric);
   ~Span();
 
   /// Mutable metadata, if this span is interested.
@@ -90,6 +147,10 @@ public:
 
 private:
   WithContext RestoreCtx;
+  const Metric &LatencyMetric;
+  /// Set only if a tracer is active.
+  std::string Name;
+  std::chrono::steady_clock::time_point StartTime;
 };
 
 /// Attach a key-value pair to a Span event.
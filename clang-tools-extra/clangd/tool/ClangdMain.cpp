@@ -528,10 +528,13 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
 
   // Setup tracing facilities if CLANGD_TRACE is set. In practice enabling a
   // trace flag in your editor's config is annoying, launching with
-  // `CLANGD_TRACE=trace.json vim` is easier.
+  // `CLANGD_TRACE=trace.json vim` is easier. CLANGD_METRICS=metrics.csv
+  // records only the metrics, e.g. the latency of every span, as CSV.
   llvm::Optional<llvm::raw_fd_ostream> TraceStream;
   std::unique_ptr<trace::EventTracer> Tracer;
-  if (auto *TraceFile = getenv("CLANGD_TRACE")) {
+  const char *JSONTraceFile = getenv("CLANGD_TRACE");
+  const char *MetricsCSVFile = getenv("CLANGD_METRICS");
+  if (const char *TraceFile = JSONTraceFile ? JSONTraceFile : MetricsCSVFile) {
     std::error_code EC;
     TraceStream.emplace(TraceFile, /*ref*/ EC,
                         llvm::sys::fs::FA_Read | llvm::sys::fs::FA_Write);
@@ -540,7 +543,9 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
       llvm::errs() << "Error while opening trace file " << TraceFile << ": "
                    << EC.message();
     } else {
-      Tracer = trace::createJSONTracer(*TraceStream, PrettyPrint);
+      Tracer = TraceFile == JSONTraceFile
+                   ? trace::createJSONTracer(*TraceStream, PrettyPrint)
+                   : trace::createCSVMetricTracer(*TraceStream);
     }
   }
 
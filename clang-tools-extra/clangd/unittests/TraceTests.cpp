@@ -10,16 +10,22 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/YAMLParser.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include <mutex>
 
 namespace clang {
 namespace clangd {
 namespace {
 
+using testing::ElementsAre;
+using testing::SizeIs;
+using testing::StartsWith;
+
 MATCHER_P(StringNode, Val, "") {
   if (arg->getType() != llvm::yaml::Node::NK_Scalar) {
     *result_listener << "is a " << arg->getVerbatimTag();
@@ -122,6 +128,88 @@ TEST(TraceTest, SmokeTest) {
   ASSERT_EQ(++Prop, Root->end());
 }
 
+// Collects the measurements of all metrics.
+class TestTracer : public trace::EventTracer {
+public:
+  Context beginSpan(llvm::StringRef Name, llvm::json::Object *Args) override {
+    return Context::current().clone();
+  }
+  void instant(llvm::StringRef Name, llvm::json::Object &&Args) override {}
+  void record(const trace::Metric &Metric, double Value,
+              llvm::StringRef Label) override {
+    std::lock_guard<std::mutex> Lock(Mu);
+    Measurements[Metric.Name][Label].push_back(Value);
+  }
+
+  // Returns and forgets the measurements of \p Metric with \p Label.
+  std::vector<double> take(llvm::StringRef Metric, llvm::StringRef Label = "") {
+    std::lock_guard<std::mutex> Lock(Mu);
+    auto It = Measurements.find(Metric);
+    if (It == Measurements.end())
+      return {};
+    auto Result = std::move(It->second[Label]);
+    It->second.erase(Label);
+    return Result;
+  }
+
+private:
+  std::mutex Mu;
+  llvm::StringMap<llvm::StringMap<std::vector<double>>> Measurements;
+};
+
+TEST(MetricsTracer, SpanLatency) {
+  TestTracer Tracer;
+  trace::Session Session(Tracer);
+  {
+    trace::Span Span("op");
+    // The latency is recorded when the span ends.
+    EXPECT_THAT(Tracer.take("span_latency", "op"), SizeIs(0));
+  }
+  EXPECT_THAT(Tracer.take("span_latency", "op"), SizeIs(1));
+
+  constexpr trace::Metric OpLatency("op_latency", trace::Metric::Distribution,
+                                    "op_name");
+  { trace::Span Span("op", OpLatency); }
+  EXPECT_THAT(Tracer.take("op_latency", "op"), SizeIs(1));
+  EXPECT_THAT(Tracer.take("span_latency", "op"), SizeIs(0));
+}
+
+TEST(MetricsTracer, Record) {
+  TestTracer Tracer;
+  constexpr trace::Metric Count("count", trace::Metric::Counter);
+  // Nothing is recorded without a session.
+  Count.record(1);
+  {
+    trace::Session Session(Tracer);
+    Count.record(2);
+    Count.record(3);
+  }
+  EXPECT_THAT(Tracer.take("count"), ElementsAre(2, 3));
+}
+
+TEST(CSVMetricTracer, Output) {
+  std::string Output;
+  llvm::raw_string_ostream OS(Output);
+  auto Tracer = trace::createCSVMetricTracer(OS);
+  {
+    trace::Session Session(*Tracer);
+    constexpr trace::Metric Dist("dist", trace::Metric::Distribution, "lbl");
+    constexpr trace::Metric Counter("cnt", trace::Metric::Counter);
+    Dist.record(1, "x");
+    Counter.record(1);
+    // Labels with separators or quotes are quoted.
+    Dist.record(2, "a,\"b\"");
+  }
+  llvm::SmallVector<llvm::StringRef, 4> Split;
+  llvm::StringRef(OS.str()).split(Split, "\n", -1, /*KeepEmpty=*/false);
+  std::vector<std::string> Lines(Split.begin(), Split.end());
+  EXPECT_THAT(Lines,
+              ElementsAre("Kind,Metric,Label,Value,Timestamp",
+                          StartsWith("d,dist,x,1.000000e+00,"),
+                          StartsWith("c,cnt,,1.000000e+00,"),
+                          StartsWith(R"(d,dist,"a,""b""",2.000000e+00,)")));
+}
+
 } // namespace
 } // namespace clangd
 } // namespace clang
@@ -21,6 +21,11 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
+#include <memory>
+
+namespace llvm {
+class MemoryBuffer;
+}
 
 namespace clang {
 class CompilerInstance;
@@ -90,6 +95,43 @@ parseCrossTUIndex(StringRef IndexPath, StringRef CrossTUDir);
 
 std::string createCrossTUIndexString(const llvm::StringMap<std::string> &Index);
 
+/// Write \p Index in the binary format read by CrossTUIndexTable.
+void writeCrossTUIndexTable(const llvm::StringMap<std::string> &Index,
+                            raw_ostream &OS);
+
+/// A read-only view of an index written by writeCrossTUIndexTable.
+///
+/// The table is sorted by USR and searched in place in a memory mapped file,
+/// so the analyzer processes of a build share a single copy of the index and
+/// none of them has to parse all of it before the first lookup.
+class CrossTUIndexTable {
+public:
+  /// Returns true if \p Data starts like an index table rather than a textual
+  /// index.
+  static bool isIndexTable(StringRef Data);
+
+  /// Create a view of the index table in \p Buffer. \p IndexPath is used for
+  /// error messages.
+  static llvm::Expected<std::unique_ptr<CrossTUIndexTable>>
+  create(std::unique_ptr<llvm::MemoryBuffer> Buffer, StringRef IndexPath);
+
+  ~CrossTUIndexTable();
+
+  /// Returns the file path recorded for \p LookupName, if any.
+  llvm::Optional<StringRef> lookup(StringRef LookupName) const;
+
+  size_t size() const { return NumEntries; }
+
+private:
+  CrossTUIndexTable(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                    uint32_t NumEntries);
+
+  StringRef getString(uint32_t Index, unsigned Field) const;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  uint32_t NumEntries;
+};
+
 // Returns true if the variable or any field of a record variable is const.
 bool containsConst(const VarDecl *VD, const ASTContext &ACtx);
 
@@ -274,6 +316,9 @@ private:
 
   private:
     llvm::Error ensureCTUIndexLoaded(StringRef CrossTUDir, StringRef IndexName);
+    /// Look up the AST file of \p FunctionName in the loaded index.
+    llvm::Optional<std::string> lookupIndex(StringRef FunctionName,
+                                            StringRef CrossTUDir) const;
     llvm::Expected<ASTUnit *> getASTUnitForFile(StringRef FileName,
                                                 bool DisplayCTUProgress);
 
@@ -287,6 +332,9 @@ private:
     using IndexMapTy = BaseMapTy<std::string>;
     IndexMapTy NameFileMap;
 
+    /// Set instead of NameFileMap when the index is a binary index table.
+    std::unique_ptr<CrossTUIndexTable> IndexTable;
+
     ASTFileLoader FileAccessor;
 
     /// Limit the number of loaded ASTs. Used to limit the  memory usage of the
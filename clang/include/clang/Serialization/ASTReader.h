@@ -960,6 +960,15 @@ private:
   /// in the chain.
   unsigned TotalNumStatements = 0;
 
+  /// The number of declaration bodies (function bodies and similar
+  /// statements loaded through GetExternalDeclStmt) de-serialized from the
+  /// chain.
+  unsigned NumDeclBodiesRead = 0;
+
+  /// The size, in bits, of the declaration bodies de-serialized from the
+  /// chain.
+  uint64_t DeclBodyBitsRead = 0;
+
   /// The number of macros de-serialized from the chain.
   unsigned NumMacrosRead = 0;
 
@@ -80,6 +80,10 @@ public:
     return MaybeStat->getName();
   }
 
+  /// \returns True if \p Stat, the current status of the file system entity
+  /// this entry was created from, shows that the entity has changed since.
+  bool isOutOfDate(const llvm::ErrorOr<llvm::vfs::Status> &Stat) const;
+
   /// Return the mapping between location -> distance that is used to speed up
   /// the block skipping in the preprocessor.
   const PreprocessorSkippedRangeMapping &getPPSkippedRangeMapping() const {
@@ -99,6 +103,8 @@ private:
   // Note: small size of 1 allows us to store an empty string with an implicit
   // null terminator without any allocations.
   llvm::SmallString<1> Contents;
+  /// The size of the file before minimization.
+  uint64_t OriginalSize = 0;
   PreprocessorSkippedRangeMapping PPSkippedRangeMapping;
 };
 
@@ -122,6 +128,17 @@ public:
   /// thread safe call.
   SharedFileSystemEntry &get(StringRef Key);
 
+  /// Reset the entries whose file system entity has changed in \p FS since
+  /// it was cached, so that the next lookup reads it again. This keeps the
+  /// cache correct when it outlives a build.
+  ///
+  /// Workers keep pointers to cache entries, so this must only be called when
+  /// no worker is running, and workers created before the call must not be
+  /// used after it.
+  ///
+  /// \returns The number of entries that were reset.
+  unsigned invalidateChangedEntries(llvm::vfs::FileSystem &FS);
+
 private:
   struct CacheShard {
     std::mutex CacheLock;
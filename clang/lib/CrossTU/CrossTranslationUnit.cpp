@@ -20,8 +20,10 @@
 #include "clang/Index/USRGeneration.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <fstream>
@@ -166,6 +168,101 @@ createCrossTUIndexString(const llvm::StringMap<std::string> &Index) {
   return Result.str();
 }
 
+// The index table starts with a header, followed by one entry per USR sorted
+// by USR, followed by the strings. All integers are little-endian.
+//
+//   Header: "CTUIDX01" uint32 NumEntries uint32 Reserved
+//   Entry:  uint32 USROffset uint32 USRLength
+//           uint32 FileOffset uint32 FileLength
+//
+// Offsets are relative to the start of the strings.
+static const char IndexTableMagic[] = {'C', 'T', 'U', 'I', 'D', 'X', '0', '1'};
+static const size_t IndexTableHeaderSize = 16;
+static const size_t IndexTableEntrySize = 16;
+
+void writeCrossTUIndexTable(const llvm::StringMap<std::string> &Index,
+                            raw_ostream &OS) {
+  std::vector<const llvm::StringMapEntry<std::string> *> Entries;
+  Entries.reserve(Index.size());
+  for (const auto &E : Index)
+    Entries.push_back(&E);
+  llvm::sort(Entries, [](const llvm::StringMapEntry<std::string> *LHS,
+                         const llvm::StringMapEntry<std::string> *RHS) {
+    return LHS->getKey() < RHS->getKey();
+  });
+
+  llvm::support::endian::Writer W(OS, llvm::support::little);
+  OS.write(IndexTableMagic, sizeof(IndexTableMagic));
+  W.write<uint32_t>(Entries.size());
+  W.write<uint32_t>(0);
+  uint32_t Offset = 0;
+  for (const auto *E : Entries) {
+    W.write<uint32_t>(Offset);
+    W.write<uint32_t>(E->getKey().size());
+    Offset += E->getKey().size();
+    W.write<uint32_t>(Offset);
+    W.write<uint32_t>(E->getValue().size());
+    Offset += E->getValue().size();
+  }
+  for (const auto *E : Entries)
+    OS << E->getKey() << E->getValue();
+}
+
+bool CrossTUIndexTable::isIndexTable(StringRef Data) {
+  return Data.startswith(StringRef(IndexTableMagic, sizeof(IndexTableMagic)));
+}
+
+llvm::Expected<std::unique_ptr<CrossTUIndexTable>>
+CrossTUIndexTable::create(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                          StringRef IndexPath) {
+  StringRef Data = Buffer->getBuffer();
+  if (Data.size() < IndexTableHeaderSize || !isIndexTable(Data))
+    return llvm::make_error<IndexError>(index_error_code::invalid_index_format,
+                                        IndexPath.str());
+  uint32_t NumEntries = llvm::support::endian::read32le(Data.data() + 8);
+  if (Data.size() - IndexTableHeaderSize <
+      uint64_t(NumEntries) * IndexTableEntrySize)
+    return llvm::make_error<IndexError>(index_error_code::invalid_index_format,
+                                        IndexPath.str());
+  return std::unique_ptr<CrossTUIndexTable>(
+      new CrossTUIndexTable(std::move(Buffer), NumEntries));
+}
+
+CrossTUIndexTable::CrossTUIndexTable(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                                     uint32_t NumEntries)
+    : Buffer(std::move(Buffer)), NumEntries(NumEntries) {}
+
+CrossTUIndexTable::~CrossTUIndexTable() = default;
+
+StringRef CrossTUIndexTable::getString(uint32_t Index, unsigned Field) const {
+  StringRef Data = Buffer->getBuffer();
+  const char *Entry = Data.data() + IndexTableHeaderSize +
+                      size_t(Index) * IndexTableEntrySize + Field * 8;
+  StringRef Strings =
+      Data.drop_front(IndexTableHeaderSize + size_t(NumEntries) *
+                                                 IndexTableEntrySize);
+  // Out of range strings come back truncated, which is enough to make a
+  // corrupt table fail lookups instead of reading past the buffer.
+  return Strings.substr(llvm::support::endian::read32le(Entry),
+                        llvm::support::endian::read32le(Entry + 4));
+}
+
+llvm::Optional<StringRef>
+CrossTUIndexTable::lookup(StringRef LookupName) const {
+  uint32_t Lo = 0, Hi = NumEntries;
+  while (Lo < Hi) {
+    uint32_t Mid = Lo + (Hi - Lo) / 2;
+    int Cmp = getString(Mid, 0).compare(LookupName);
+    if (Cmp == 0)
+      return getString(Mid, 1);
+    if (Cmp < 0)
+      Lo = Mid + 1;
+    else
+      Hi = Mid;
+  }
+  return llvm::None;
+}
+
 bool containsConst(const VarDecl *VD, const ASTContext &ACtx) {
   CanQualType CT = ACtx.getCanonicalType(VD->getType());
   if (!CT.isConstQualified()) {
@@ -417,7 +514,9 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
       return std::move(IndexLoadError);
 
     // Check if there is and entry in the index for the function.
-    if (!NameFileMap.count(FunctionName)) {
+    llvm::Optional<std::string> FileName =
+        lookupIndex(FunctionName, CrossTUDir);
+    if (!FileName) {
       ++NumNotInOtherTU;
       return llvm::make_error<IndexError>(index_error_code::missing_definition);
     }
@@ -425,7 +524,7 @@ CrossTranslationUnitContext::ASTUnitStorage::getASTUnitForFunction(
     // Search in the index for the filename where the definition of FuncitonName
     // resides.
     if (llvm::Expected<ASTUnit *> FoundForFile =
-            getASTUnitForFile(NameFileMap[FunctionName], DisplayCTUProgress)) {
+            getASTUnitForFile(*FileName, DisplayCTUProgress)) {
 
       // Update the cache.
       NameASTUnitMap[FunctionName] = *FoundForFile;
@@ -445,13 +544,31 @@ CrossTranslationUnitContext::ASTUnitStorage::getFileForFunction(
     StringRef FunctionName, StringRef CrossTUDir, StringRef IndexName) {
   if (llvm::Error IndexLoadError = ensureCTUIndexLoaded(CrossTUDir, IndexName))
     return std::move(IndexLoadError);
-  return NameFileMap[FunctionName];
+  return lookupIndex(FunctionName, CrossTUDir).getValueOr(std::string());
+}
+
+llvm::Optional<std::string>
+CrossTranslationUnitContext::ASTUnitStorage::lookupIndex(
+    StringRef FunctionName, StringRef CrossTUDir) const {
+  if (IndexTable) {
+    llvm::Optional<StringRef> FileName = IndexTable->lookup(FunctionName);
+    if (!FileName)
+      return llvm::None;
+    SmallString<256> FilePath = CrossTUDir;
+    llvm::sys::path::append(FilePath, *FileName);
+    return std::string(FilePath);
+  }
+
+  auto It = NameFileMap.find(FunctionName);
+  if (It == NameFileMap.end())
+    return llvm::None;
+  return It->second;
 }
 
 llvm::Error CrossTranslationUnitContext::ASTUnitStorage::ensureCTUIndexLoaded(
     StringRef CrossTUDir, StringRef IndexName) {
   // Dont initialize if the map is filled.
-  if (!NameFileMap.empty())
+  if (!NameFileMap.empty() || IndexTable)
     return llvm::Error::success();
 
   // Get the absolute path to the index file.
@@ -461,6 +578,18 @@ llvm::Error CrossTranslationUnitContext::ASTUnitStorage::ensureCTUIndexLoaded(
   else
     llvm::sys::path::append(IndexFile, IndexName);
 
+  // A binary index table is searched in place instead of being parsed.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(IndexFile, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (Buffer && CrossTUIndexTable::isIndexTable((*Buffer)->getBuffer())) {
+    auto Table = CrossTUIndexTable::create(std::move(*Buffer), IndexFile);
+    if (!Table)
+      return Table.takeError();
+    IndexTable = std::move(*Table);
+    return llvm::Error::success();
+  }
+
   if (auto IndexMapping = parseCrossTUIndex(IndexFile, CrossTUDir)) {
     // Initialize member map.
     NameFileMap = *IndexMapping;
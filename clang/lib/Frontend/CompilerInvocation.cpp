@@ -2235,6 +2235,9 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args,
 
   for (const auto *A : Args.filtered(OPT_ivfsoverlay))
     Opts.AddVFSOverlayFile(A->getValue());
+
+  for (const auto *A : Args.filtered(OPT_ivfsstatcache))
+    Opts.AddVFSStatCacheFile(A->getValue());
 }
 
 void CompilerInvocation::setLangDefaults(LangOptions &Opts, InputKind IK,
@@ -3783,12 +3786,34 @@ createVFSFromCompilerInvocation(const CompilerInvocation &CI,
 IntrusiveRefCntPtr<llvm::vfs::FileSystem> createVFSFromCompilerInvocation(
     const CompilerInvocation &CI, DiagnosticsEngine &Diags,
     IntrusiveRefCntPtr<llvm::vfs::FileSystem> BaseFS) {
-  if (CI.getHeaderSearchOpts().VFSOverlayFiles.empty())
+  const HeaderSearchOptions &HSOpts = CI.getHeaderSearchOpts();
+  if (HSOpts.VFSOverlayFiles.empty() && HSOpts.VFSStatCacheFiles.empty())
     return BaseFS;
 
   IntrusiveRefCntPtr<llvm::vfs::FileSystem> Result = BaseFS;
+  // Stat caches describe the real file system, so they go below the overlays.
+  for (const auto &File : HSOpts.VFSStatCacheFiles) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        Result->getBufferForFile(File, /*FileSize=*/-1,
+                                 /*RequiresNullTerminator=*/false);
+    if (!Buffer) {
+      Diags.Report(diag::err_missing_vfs_stat_cache_file) << File;
+      continue;
+    }
+
+    auto FS = llvm::vfs::StatCacheFileSystem::create(std::move(Buffer.get()),
+                                                     Result);
+    if (!FS) {
+      Diags.Report(diag::err_invalid_vfs_stat_cache)
+          << File << llvm::toString(FS.takeError());
+      continue;
+    }
+
+    Result = std::move(*FS);
+  }
+
   // earlier vfs files are on the bottom
-  for (const auto &File : CI.getHeaderSearchOpts().VFSOverlayFiles) {
+  for (const auto &File : HSOpts.VFSOverlayFiles) {
     llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
         Result->getBufferForFile(File);
     if (!Buffer) {
@@ -7385,7 +7385,10 @@ Stmt *ASTReader::GetExternalDeclStmt(uint64_t Offset) {
   assert(NumCurrentElementsDeserializing == 0 &&
          "should not be called while already deserializing");
   Deserializing D(this);
-  return ReadStmtFromStream(*Loc.F);
+  Stmt *Body = ReadStmtFromStream(*Loc.F);
+  ++NumDeclBodiesRead;
+  DeclBodyBitsRead += Loc.F->DeclsCursor.GetCurrentBitNo() - Loc.Offset;
+  return Body;
 }
 
 void ASTReader::FindExternalLexicalDecls(
@@ -7642,6 +7645,10 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u statements read (%f%%)\n",
                  NumStatementsRead, TotalNumStatements,
                  ((float)NumStatementsRead/TotalNumStatements * 100));
+  if (NumDeclBodiesRead)
+    std::fprintf(stderr, "  %u declaration bodies read (%llu bytes)\n",
+                 NumDeclBodiesRead,
+                 (unsigned long long)(DeclBodyBitsRead / 8));
   if (TotalNumMacros)
     std::fprintf(stderr, "  %u/%u macros read (%f%%)\n",
                  NumMacrosRead, TotalNumMacros,
@@ -42,6 +42,7 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
     // if the minimization failed.
     // FIXME: Propage the diagnostic if desired by the client.
     CachedFileSystemEntry Result;
+    Result.OriginalSize = Stat->getSize();
     Result.MaybeStat = std::move(*Stat);
     Result.Contents.reserve(Buffer->getBufferSize() + 1);
     Result.Contents.append(Buffer->getBufferStart(), Buffer->getBufferEnd());
@@ -52,6 +53,7 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
   }
 
   CachedFileSystemEntry Result;
+  Result.OriginalSize = Stat->getSize();
   size_t Size = MinimizedFileContents.size();
   Result.MaybeStat = llvm::vfs::Status(Stat->getName(), Stat->getUniqueID(),
                                        Stat->getLastModificationTime(),
@@ -99,6 +101,21 @@ CachedFileSystemEntry::createDirectoryEntry(llvm::vfs::Status &&Stat) {
   return Result;
 }
 
+bool CachedFileSystemEntry::isOutOfDate(
+    const llvm::ErrorOr<llvm::vfs::Status> &Stat) const {
+  assert(isValid() && "not initialized");
+  // A cached error is out of date once the entity can be found.
+  if (!MaybeStat || !Stat)
+    return bool(MaybeStat) != bool(Stat);
+  if (MaybeStat->isDirectory() || Stat->isDirectory())
+    return MaybeStat->isDirectory() != Stat->isDirectory();
+  // The status of a minimized file reports the minimized size, so compare the
+  // size of the file with the size it had when it was read.
+  return Stat->getLastModificationTime() !=
+             MaybeStat->getLastModificationTime() ||
+         Stat->getSize() != OriginalSize;
+}
+
 DependencyScanningFilesystemSharedCache::
     DependencyScanningFilesystemSharedCache() {
   // This heuristic was chosen using a empirical testing on a
@@ -122,6 +139,25 @@ DependencyScanningFilesystemSharedCache::get(StringRef Key) {
   return It.first->getValue();
 }
 
+unsigned DependencyScanningFilesystemSharedCache::invalidateChangedEntries(
+    llvm::vfs::FileSystem &FS) {
+  unsigned NumInvalidated = 0;
+  for (unsigned I = 0; I != NumShards; ++I) {
+    CacheShard &Shard = CacheShards[I];
+    std::unique_lock<std::mutex> LockGuard(Shard.CacheLock);
+    for (auto &KeyAndEntry : Shard.Cache) {
+      SharedFileSystemEntry &Entry = KeyAndEntry.getValue();
+      std::unique_lock<std::mutex> ValueGuard(Entry.ValueLock);
+      if (!Entry.Value.isValid() ||
+          !Entry.Value.isOutOfDate(FS.status(KeyAndEntry.getKey())))
+        continue;
+      Entry.Value = CachedFileSystemEntry();
+      ++NumInvalidated;
+    }
+  }
+  return NumInvalidated;
+}
+
 /// Whitelist file extensions that should be minimized, treating no extension as
 /// a source file that should be minimized.
 ///
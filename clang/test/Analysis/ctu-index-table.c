@@ -0,0 +1,35 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: mkdir -p %t/ctudir
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu \
+// RUN:   -emit-pch -o %t/ctudir/ctu-other.c.ast %S/Inputs/ctu-other.c
+// RUN: clang-extdef-table -o %t/ctudir/externalDefMap.txt \
+// RUN:   %S/Inputs/ctu-other.c.externalDefMap.txt
+// RUN: head -c 8 %t/ctudir/externalDefMap.txt | FileCheck %s --check-prefix=MAGIC
+// RUN: %clang_cc1 -triple x86_64-pc-linux-gnu -fsyntax-only -std=c89 -analyze \
+// RUN:   -analyzer-checker=core,debug.ExprInspection \
+// RUN:   -analyzer-config experimental-enable-naive-ctu-analysis=true \
+// RUN:   -analyzer-config ctu-dir=%t/ctudir \
+// RUN:   -verify %s
+//
+// Merging a map with itself defines every function twice.
+// RUN: not clang-extdef-table -o %t/dup.table \
+// RUN:   %S/Inputs/ctu-other.c.externalDefMap.txt \
+// RUN:   %S/Inputs/ctu-other.c.externalDefMap.txt 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=DUP
+// RUN: not test -e %t/dup.table
+
+// MAGIC: CTUIDX01
+// DUP: error: Multiple definitions in the index file.
+
+// The analyzer looks definitions up in the index table just as in the
+// textual map.
+
+void clang_analyzer_eval(int);
+
+int f(int);
+int enumCheck(void);
+
+void testImportedFunction() {
+  clang_analyzer_eval(f(5) == 1);         // expected-warning{{TRUE}}
+  clang_analyzer_eval(enumCheck() == 42); // expected-warning{{TRUE}}
+}
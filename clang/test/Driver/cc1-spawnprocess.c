@@ -18,5 +18,11 @@
 // RUN:     %clang -fintegrated-cc1 -### %s 2>&1 \
 // RUN:     | FileCheck %s --check-prefix=NO
 
+// The integrated assembler runs in-process too.
+// RUN: %clang -fintegrated-cc1 -fintegrated-as -c -### -x assembler %s 2>&1 \
+// RUN:     | FileCheck %s --check-prefix=YES
+// RUN: %clang -fno-integrated-cc1 -fintegrated-as -c -### -x assembler %s 2>&1 \
+// RUN:     | FileCheck %s --check-prefix=NO
+
 // YES: (in-process)
 // NO-NOT: (in-process)
@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t/include %t/other
+// RUN: echo '#define FOO 1' > %t/include/foo.h
+// RUN: echo '#define BAR 1' > %t/other/bar.h
+// RUN: clang-stat-cache -o %t/cache %t/include
+// RUN: %clang_cc1 -fsyntax-only -verify -ivfsstatcache %t/cache -I %t/include -I %t/other %s
+
+// RUN: echo '#define BAZ 1' > %t/include/baz.h
+// RUN: %clang_cc1 -fsyntax-only -verify -DBAZ -ivfsstatcache %t/cache -I %t/include -I %t/other %s
+
+// RUN: not %clang_cc1 -fsyntax-only -ivfsstatcache %t/missing %s 2>&1 | FileCheck %s -check-prefix=MISSING
+// MISSING: stat cache file '{{.*}}missing' not found
+
+// RUN: echo 'not a stat cache' > %t/bad
+// RUN: not %clang_cc1 -fsyntax-only -ivfsstatcache %t/bad %s 2>&1 | FileCheck %s -check-prefix=INVALID
+// INVALID: invalid stat cache file '{{.*}}bad'
+
+// expected-no-diagnostics
+#include "foo.h"
+#include "bar.h"
+#ifdef BAZ
+#include "baz.h"
+#endif
@@ -0,0 +1,28 @@
+// Check that -print-stats reports the function bodies read from a PCH.
+
+// RUN: %clang_cc1 -std=c++11 -emit-pch -o %t %s
+// RUN: %clang_cc1 -std=c++11 -include-pch %t -fsyntax-only -print-stats %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=NO-BODIES
+// RUN: %clang_cc1 -std=c++11 -include-pch %t -fsyntax-only -print-stats -DUSE_BODY %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=ONE-BODY
+
+#ifndef HEADER
+#define HEADER
+
+constexpr int used() { return 42; }
+constexpr int unused() { return 0; }
+
+#else
+
+// Bodies are only read when they are needed, here to evaluate the call.
+#ifdef USE_BODY
+static_assert(used() == 42, "");
+#endif
+
+// NO-BODIES: *** AST File Statistics:
+// NO-BODIES-NOT: declaration bodies read
+
+// ONE-BODY: *** AST File Statistics:
+// ONE-BODY: {{^}}  1 declaration bodies read ({{[0-9]+}} bytes)
+
+#endif
@@ -0,0 +1,70 @@
+//===- ClangExtDefTable.cpp ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===--------------------------------------------------------------------===//
+//
+// Clang tool which converts the textual external definition maps produced by
+// clang-extdef-mapping into a single index table. The analyzer memory maps the
+// table and searches it in place, which avoids parsing the whole index in
+// every analyzer process of a cross translation unit analysis.
+//
+//===--------------------------------------------------------------------===//
+
+#include "clang/CrossTU/CrossTranslationUnit.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace clang::cross_tu;
+
+static cl::OptionCategory
+    ClangExtDefTableCategory("clang-extdef-table options");
+
+static cl::opt<std::string> Output("o", cl::Required,
+                                   cl::desc("Output filename"),
+                                   cl::value_desc("filename"),
+                                   cl::cat(ClangExtDefTableCategory));
+
+static cl::list<std::string> Inputs(cl::Positional, cl::OneOrMore,
+                                    cl::desc("<external definition maps>"),
+                                    cl::cat(ClangExtDefTableCategory));
+
+int main(int argc, const char **argv) {
+  InitLLVM X(argc, argv);
+  cl::HideUnrelatedOptions(ClangExtDefTableCategory);
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "Merge external definition maps into an index table for the analyzer's "
+      "ctu-index-name option.\n");
+
+  auto ReportError = [argv](Error E) {
+    logAllUnhandledErrors(std::move(E), WithColor::error(errs(), argv[0]));
+    return 1;
+  };
+
+  StringMap<std::string> Index;
+  for (const std::string &Input : Inputs) {
+    Expected<StringMap<std::string>> Map = parseCrossTUIndex(Input, "");
+    if (!Map)
+      return ReportError(Map.takeError());
+    for (auto &E : *Map) {
+      if (!Index.insert({E.getKey(), std::move(E.getValue())}).second)
+        return ReportError(make_error<IndexError>(
+            index_error_code::multiple_definitions, Input));
+    }
+  }
+
+  if (Error E = writeFileAtomically(Output + "-%%%%%%%%", Output,
+                                    [&](raw_ostream &OS) {
+                                      writeCrossTUIndexTable(Index, OS);
+                                      return Error::success();
+                                    }))
+    return ReportError(std::move(E));
+  return 0;
+}
@@ -0,0 +1,60 @@
+//===-- clang-stat-cache/ClangStatCache.cpp ---------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Writes a stat cache describing one or more directory trees, for use with
+/// clang's -ivfsstatcache option. The cache is written atomically so that it
+/// can be regenerated while compilers are reading an older copy.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/Version.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+static cl::OptionCategory ClangStatCacheCategory("clang-stat-cache options");
+
+static cl::opt<std::string> Output("o", cl::Required,
+                                   cl::desc("Output filename"),
+                                   cl::value_desc("filename"),
+                                   cl::cat(ClangStatCacheCategory));
+
+static cl::list<std::string> Roots(cl::Positional, cl::OneOrMore,
+                                   cl::desc("<directories>"),
+                                   cl::cat(ClangStatCacheCategory));
+
+int main(int argc, const char **argv) {
+  InitLLVM X(argc, argv);
+
+  cl::HideUnrelatedOptions(ClangStatCacheCategory);
+  cl::SetVersionPrinter([](raw_ostream &OS) {
+    OS << clang::getClangToolFullVersion("clang-stat-cache") << '\n';
+  });
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "A tool to record the file system state of the given directories in a "
+      "stat cache\nthat clang can use through -ivfsstatcache.\n");
+
+  IntrusiveRefCntPtr<vfs::FileSystem> FS = vfs::getRealFileSystem();
+  Error E = writeFileAtomically(
+      Output + "-%%%%%%%%", Output, [&](raw_ostream &OS) {
+        return vfs::StatCacheFileSystem::writeStatCache(*FS, Roots, OS);
+      });
+  if (E) {
+    logAllUnhandledErrors(std::move(E), WithColor::error(errs(), argv[0]));
+    return 1;
+  }
+  return 0;
+}
@@ -327,6 +327,8 @@ getOutputStream(StringRef Path, DiagnosticsEngine &Diags, bool Binary) {
       Path, EC, (Binary ? sys::fs::OF_None : sys::fs::OF_Text));
   if (EC) {
     Diags.Report(diag::err_fe_unable_to_open_output) << Path << EC.message();
+    if (Path != "-")
+      sys::DontRemoveFileOnSignal(Path);
     return nullptr;
   }
 
@@ -536,6 +538,7 @@ static bool ExecuteAssembler(AssemblerInvocation &Opts,
   // Close the output stream early.
   BOS.reset();
   FDOS.reset();
+  DwoOS.reset();
 
   // Delete output file if there were errors.
   if (Failed) {
@@ -545,6 +548,13 @@ static bool ExecuteAssembler(AssemblerInvocation &Opts,
       sys::fs::remove(Opts.SplitDwarfOutput);
   }
 
+  // The outputs are complete (or gone), and the driver may carry on running
+  // other jobs in this process, so a later signal must not remove them.
+  if (Opts.OutputPath != "-")
+    sys::DontRemoveFileOnSignal(Opts.OutputPath);
+  if (!Opts.SplitDwarfOutput.empty() && Opts.SplitDwarfOutput != "-")
+    sys::DontRemoveFileOnSignal(Opts.SplitDwarfOutput);
+
   return Failed;
 }
 
@@ -554,6 +564,10 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
 
   Diags.Report(diag::err_fe_error_backend) << Message;
 
+  // Run the interrupt handlers to make sure any special cleanups get done, in
+  // particular that we remove files registered with RemoveFileOnSignal.
+  llvm::sys::RunInterruptHandlers();
+
   // We cannot recover from llvm errors.
   exit(1);
 }
@@ -12,6 +12,7 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "gtest/gtest.h"
@@ -193,5 +194,39 @@ TEST(CrossTranslationUnit, CTUDirIsHandledCorrectly) {
   EXPECT_EQ(ParsedIndex["a"], "/ctudir/b/c/d");
 }
 
+TEST(CrossTranslationUnit, IndexTableCanBeSearched) {
+  llvm::StringMap<std::string> Index;
+  Index["c:@F@g"] = "g.cpp.ast";
+  Index["c:@F@f"] = "f.cpp.ast";
+  Index["c:@F@h#I#"] = "dir/h.cpp.ast";
+
+  std::string Table;
+  llvm::raw_string_ostream OS(Table);
+  writeCrossTUIndexTable(Index, OS);
+  OS.flush();
+  EXPECT_TRUE(CrossTUIndexTable::isIndexTable(Table));
+  EXPECT_FALSE(CrossTUIndexTable::isIndexTable(createCrossTUIndexString(Index)));
+
+  auto TableOrErr = CrossTUIndexTable::create(
+      llvm::MemoryBuffer::getMemBuffer(Table, "index", false), "index");
+  ASSERT_TRUE((bool)TableOrErr);
+  CrossTUIndexTable &T = **TableOrErr;
+  EXPECT_EQ(T.size(), Index.size());
+  for (const auto &E : Index) {
+    llvm::Optional<StringRef> File = T.lookup(E.getKey());
+    ASSERT_TRUE(File.hasValue());
+    EXPECT_EQ(*File, E.getValue());
+  }
+  EXPECT_FALSE(T.lookup("c:@F@missing").hasValue());
+  EXPECT_FALSE(T.lookup("").hasValue());
+
+  auto Truncated = CrossTUIndexTable::create(
+      llvm::MemoryBuffer::getMemBuffer(StringRef(Table).take_front(20),
+                                       "index", false),
+      "index");
+  EXPECT_FALSE((bool)Truncated);
+  llvm::consumeError(Truncated.takeError());
+}
+
 } // end namespace cross_tu
 } // end namespace clang
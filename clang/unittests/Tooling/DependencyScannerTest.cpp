@@ -14,6 +14,7 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FormatVariadic.h"
@@ -203,5 +204,53 @@ TEST(DependencyScanner, ScanDepsReuseFilemanagerHasInclude) {
   EXPECT_EQ(convert_to_slash(Deps[5]), "/root/symlink.h");
 }
 
+TEST(DependencyScanner, InvalidateChangedEntries) {
+  using namespace dependencies;
+  auto Contents = [](DependencyScanningWorkerFilesystem &DepFS,
+                     StringRef Path) -> std::string {
+    auto File = DepFS.openFileForRead(Path);
+    if (!File)
+      return "<error>";
+    auto Buffer = (*File)->getBuffer(Path);
+    if (!Buffer)
+      return "<error>";
+    return std::string((*Buffer)->getBuffer());
+  };
+
+  auto AddFile = [](llvm::vfs::InMemoryFileSystem &FS, StringRef Path,
+                    time_t ModificationTime, StringRef Contents) {
+    FS.addFile(Path, ModificationTime,
+               llvm::MemoryBuffer::getMemBufferCopy(Contents));
+  };
+
+  auto OldFS = new llvm::vfs::InMemoryFileSystem();
+  AddFile(*OldFS, "/changed.h", 1, "#define OLD\n");
+  AddFile(*OldFS, "/same.h", 1, "#define same\n");
+
+  DependencyScanningFilesystemSharedCache SharedCache;
+  {
+    DependencyScanningWorkerFilesystem DepFS(SharedCache, OldFS, nullptr);
+    EXPECT_EQ(Contents(DepFS, "/changed.h"), "#define OLD\n");
+    EXPECT_EQ(Contents(DepFS, "/same.h"), "#define same\n");
+    // The failure to find a source file is cached too.
+    EXPECT_FALSE(DepFS.status("/added.h"));
+  }
+
+  // In the next build, /changed.h has a new modification time and /added.h
+  // exists. /same.h has the same modification time and size, so the cache
+  // keeps serving it without reading the file again.
+  auto NewFS = new llvm::vfs::InMemoryFileSystem();
+  AddFile(*NewFS, "/changed.h", 2, "#define NEW\n");
+  AddFile(*NewFS, "/same.h", 1, "#define SAME\n");
+  AddFile(*NewFS, "/added.h", 2, "#define ADDED\n");
+  EXPECT_EQ(SharedCache.invalidateChangedEntries(*NewFS), 2u);
+  EXPECT_EQ(SharedCache.invalidateChangedEntries(*NewFS), 0u);
+
+  DependencyScanningWorkerFilesystem DepFS(SharedCache, NewFS, nullptr);
+  EXPECT_EQ(Contents(DepFS, "/changed.h"), "#define NEW\n");
+  EXPECT_EQ(Contents(DepFS, "/same.h"), "#define same\n");
+  EXPECT_EQ(Contents(DepFS, "/added.h"), "#define ADDED\n");
+}
+
 } // end namespace tooling
 } // end namespace clang
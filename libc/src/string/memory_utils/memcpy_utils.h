@@ -0,0 +1,64 @@
+//===---------------------------- Memcpy utils ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_MEMORY_UTILS_MEMCPY_UTILS_H
+#define LLVM_LIBC_SRC_MEMORY_UTILS_MEMCPY_UTILS_H
+
+#include "src/string/memory_utils/utils.h"
+#include <stddef.h> // size_t
+
+namespace __llvm_libc {
+
+// Copies `kBlockSize` bytes from `src` to `dst`.
+// The copy is expanded inline so that memcpy never calls back into itself.
+template <size_t kBlockSize>
+static void CopyBlock(char *__restrict dst, const char *__restrict src) {
+#if __has_builtin(__builtin_memcpy_inline)
+  __builtin_memcpy_inline(dst, src, kBlockSize);
+#else
+  __builtin_memcpy(dst, src, kBlockSize);
+#endif
+}
+
+// Copies the last `kBlockSize` bytes of a buffer of `count` bytes.
+// Precondition: `count >= kBlockSize`.
+template <size_t kBlockSize>
+static void CopyLastBlock(char *__restrict dst, const char *__restrict src,
+                          size_t count) {
+  const size_t offset = count - kBlockSize;
+  CopyBlock<kBlockSize>(dst + offset, src + offset);
+}
+
+// Copies `count` bytes as two possibly overlapping blocks, one at the start and
+// one at the end of the buffer. This covers every size in a power of two range
+// with the same two loads and two stores, and no branch on `count`.
+// Precondition: `kBlockSize <= count <= 2 * kBlockSize`.
+template <size_t kBlockSize>
+static void CopyBlockOverlap(char *__restrict dst, const char *__restrict src,
+                             size_t count) {
+  CopyBlock<kBlockSize>(dst, src);
+  CopyLastBlock<kBlockSize>(dst, src, count);
+}
+
+// Copies `count` bytes with stores aligned to `kBlockSize` in `dst`.
+// The first and last blocks are copied unaligned and may overlap the aligned
+// ones, so no byte-sized tail loop is needed.
+// Precondition: `count > 2 * kBlockSize`.
+template <size_t kBlockSize>
+static void CopyAlignedBlocks(char *__restrict dst, const char *__restrict src,
+                              size_t count) {
+  CopyBlock<kBlockSize>(dst, src);
+  size_t offset = offset_to_next_aligned<kBlockSize>(dst);
+  for (; offset + kBlockSize < count; offset += kBlockSize)
+    CopyBlock<kBlockSize>(dst + offset, src + offset);
+  CopyLastBlock<kBlockSize>(dst, src, count);
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_MEMORY_UTILS_MEMCPY_UTILS_H
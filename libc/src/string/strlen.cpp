@@ -0,0 +1,51 @@
+//===-------------------- Implementation of strlen -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/strlen.h"
+
+#include "src/__support/common.h"
+#include <stdint.h> // uintptr_t
+
+namespace __llvm_libc {
+
+// Words are read through a type that may alias the string's chars.
+typedef uintptr_t __attribute__((__may_alias__)) Word;
+
+static constexpr Word kLowBits = ~Word(0) / 0xFF; // 0x0101...01
+static constexpr Word kHighBits = kLowBits << 7;  // 0x8080...80
+
+// Returns whether one of the bytes of `word` is zero.
+static inline bool HasZeroByte(Word word) {
+  return ((word - kLowBits) & ~word & kHighBits) != 0;
+}
+
+// Scans byte by byte up to a word boundary, then a word at a time. An aligned
+// word never straddles a page boundary, so reading the whole word that holds
+// the terminator cannot fault even when the string ends inside it.
+__attribute__((no_sanitize("address"))) static size_t
+strlen_impl(const char *src) {
+  const char *char_ptr = src;
+  for (; reinterpret_cast<uintptr_t>(char_ptr) % sizeof(Word) != 0;
+       ++char_ptr) {
+    if (*char_ptr == '\0')
+      return char_ptr - src;
+  }
+  const Word *word_ptr = reinterpret_cast<const Word *>(char_ptr);
+  while (!HasZeroByte(*word_ptr))
+    ++word_ptr;
+  for (char_ptr = reinterpret_cast<const char *>(word_ptr); *char_ptr != '\0';
+       ++char_ptr)
+    ;
+  return char_ptr - src;
+}
+
+size_t LLVM_LIBC_ENTRYPOINT(strlen)(const char *src) {
+  return strlen_impl(src);
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,46 @@
+//===----------------------- Unittests for memcpy -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memcpy.h"
+#include "utils/CPP/Array.h"
+#include "utils/UnitTest/Test.h"
+
+using __llvm_libc::cpp::Array;
+
+static constexpr size_t kMaxSize = 400;
+static constexpr size_t kMaxOffset = 64;
+static constexpr size_t kGuard = 8;
+static constexpr char kSentinel = '\x5A';
+
+// Byte at position `i` of the source buffer. 251 is prime so the pattern does
+// not repeat with any block size the implementation uses.
+static char Pattern(size_t i) { return static_cast<char>(i % 251 + 1); }
+
+TEST(MemcpyTest, SizesAndAlignments) {
+  Array<char, kMaxSize + kMaxOffset> src;
+  Array<char, kGuard + kMaxSize + kMaxOffset + kGuard> dst;
+  for (size_t i = 0; i < src.size(); ++i)
+    src[i] = Pattern(i);
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    for (size_t offset = 0; offset < kMaxOffset; offset += 7) {
+      for (size_t i = 0; i < dst.size(); ++i)
+        dst[i] = kSentinel;
+      char *const dst_begin = dst.data() + kGuard + offset;
+      const char *const src_begin = src.data() + (kMaxOffset - 1 - offset);
+      void *result = __llvm_libc::memcpy(dst_begin, src_begin, size);
+      ASSERT_EQ(result, static_cast<void *>(dst_begin));
+      for (size_t i = 0; i < size; ++i)
+        ASSERT_EQ(dst_begin[i], src_begin[i]);
+      // Bytes around the destination must not be written.
+      for (char *p = dst.data(); p != dst_begin; ++p)
+        ASSERT_EQ(*p, kSentinel);
+      for (char *p = dst_begin + size; p != dst.data() + dst.size(); ++p)
+        ASSERT_EQ(*p, kSentinel);
+    }
+  }
+}
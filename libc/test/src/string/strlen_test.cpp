@@ -0,0 +1,46 @@
+//===----------------------- Unittests for strlen -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/strlen.h"
+#include "utils/CPP/Array.h"
+#include "utils/UnitTest/Test.h"
+
+TEST(StrLenTest, EmptyString) {
+  const char *empty = "";
+
+  size_t result = __llvm_libc::strlen(empty);
+  ASSERT_EQ((size_t)0, result);
+}
+
+TEST(StrLenTest, AnyString) {
+  const char *any = "Hello World!";
+
+  size_t result = __llvm_libc::strlen(any);
+  ASSERT_EQ((size_t)12, result);
+}
+
+TEST(StrLenTest, AllLengthsAndAlignments) {
+  // The terminator is placed at every position relative to a word boundary,
+  // with non-zero bytes after it that must not be counted.
+  __llvm_libc::cpp::Array<char, 128> buffer;
+  for (size_t start = 0; start < 16; ++start) {
+    for (size_t length = 0; start + length + 1 < buffer.size(); ++length) {
+      for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = 'a';
+      buffer[start + length] = '\0';
+      ASSERT_EQ(length, __llvm_libc::strlen(buffer.data() + start));
+    }
+  }
+}
+
+TEST(StrLenTest, HighBitBytes) {
+  // Bytes with the high bit set must not be mistaken for a terminator.
+  const char bytes[] = {'\x80', '\x81', '\xFF', '\x7F', '\x01', '\x80', '\xFE',
+                        '\x80', '\x80', '\x80', '\0'};
+  ASSERT_EQ(sizeof(bytes) - 1, __llvm_libc::strlen(bytes));
+}
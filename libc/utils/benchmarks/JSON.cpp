@@ -201,6 +201,7 @@ static Error fromJson(const json::Value &V,
   O.map("AddressAlignment", Out.AddressAlignment);
   O.map("MemsetValue", Out.MemsetValue);
   O.map("MemcmpMismatchAt", Out.MemcmpMismatchAt);
+  O.map("SizeDistribution", Out.SizeDistribution);
   return O.takeError();
 }
 
@@ -323,6 +324,11 @@ static void Serialize(const StudyConfiguration &SC, json::OStream &JOS) {
                     static_cast<int64_t>(SC.AddressAlignment->value()));
     JOS.attribute("MemsetValue", SC.MemsetValue);
     JOS.attribute("MemcmpMismatchAt", SC.MemcmpMismatchAt);
+    if (!SC.SizeDistribution.empty())
+      JOS.attributeArray("SizeDistribution", [&]() {
+        for (const double Weight : SC.SizeDistribution)
+          JOS.value(Weight);
+      });
   });
 }
 
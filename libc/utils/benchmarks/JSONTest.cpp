@@ -21,7 +21,7 @@ Study getStudy() {
           "CpuName", 123, {CacheInfo{"A", 1, 2, 3}, CacheInfo{"B", 4, 5, 6}}},
       BenchmarkOptions{std::chrono::seconds(1), std::chrono::seconds(2), 10,
                        100, 6, 100, 0.1, 2, BenchmarkLog::Full},
-      StudyConfiguration{2, 3, SizeRange{4, 5, 6}, Align(8), 9, 10},
+      StudyConfiguration{2, 3, SizeRange{4, 5, 6}, Align(8), 9, 10, {0.25, 1}},
       {FunctionMeasurements{"A",
                             {Measurement{3, std::chrono::seconds(3)},
                              Measurement{3, std::chrono::seconds(4)}}},
@@ -78,7 +78,8 @@ auto Equals(const StudyConfiguration &SC) -> auto {
       Field(&StudyConfiguration::Size, Equals(SC.Size)),
       Field(&StudyConfiguration::AddressAlignment, SC.AddressAlignment),
       Field(&StudyConfiguration::MemsetValue, SC.MemsetValue),
-      Field(&StudyConfiguration::MemcmpMismatchAt, SC.MemcmpMismatchAt));
+      Field(&StudyConfiguration::MemcmpMismatchAt, SC.MemcmpMismatchAt),
+      Field(&StudyConfiguration::SizeDistribution, SC.SizeDistribution));
 }
 
 MATCHER(EqualsMeasurement, "") {
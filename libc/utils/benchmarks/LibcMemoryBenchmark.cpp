@@ -11,6 +11,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
 #include <algorithm>
+#include <numeric>
 
 namespace llvm {
 namespace libc_benchmarks {
@@ -58,5 +59,26 @@ MismatchOffsetDistribution::MismatchOffsetDistribution(
       std::uniform_int_distribution<size_t>(0, MismatchIndices.size() - 1);
 }
 
+SizeDistribution::SizeDistribution(const StudyConfiguration &Conf)
+    : Distribution(Conf.SizeDistribution.begin(),
+                   Conf.SizeDistribution.end()),
+      From(Conf.Size.From), Step(Conf.Size.Step),
+      Enabled(!Conf.SizeDistribution.empty()) {
+  if (!Enabled)
+    return;
+  if (Conf.Size.Step == 0 || Conf.Size.To < Conf.Size.From)
+    report_fatal_error("Invalid Size configuration");
+  const size_t NumSizes = (Conf.Size.To - Conf.Size.From) / Conf.Size.Step + 1;
+  if (Conf.SizeDistribution.size() != NumSizes)
+    report_fatal_error(
+        "SizeDistribution must have one element per size in Size");
+  const auto &Weights = Conf.SizeDistribution;
+  if (std::any_of(Weights.begin(), Weights.end(),
+                  [](double W) { return W < 0; }) ||
+      std::accumulate(Weights.begin(), Weights.end(), 0.0) <= 0)
+    report_fatal_error("SizeDistribution must have a positive total weight "
+                       "and no negative weight");
+}
+
 } // namespace libc_benchmarks
 } // namespace llvm
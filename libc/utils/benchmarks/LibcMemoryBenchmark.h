@@ -18,6 +18,7 @@
 #include "llvm/Support/Alignment.h"
 #include <cstdint>
 #include <random>
+#include <vector>
 
 namespace llvm {
 namespace libc_benchmarks {
@@ -59,6 +60,13 @@ struct StudyConfiguration {
   // The mismatch position for memcmp.
   uint32_t MemcmpMismatchAt = 0; //  0 : Buffer compare equal,
                                  // >0 : Buffer compare different at byte N-1.
+
+  // The relative frequency of each size in `Size`, e.g. as recorded from a
+  // production workload. When empty, every size in `Size` is measured on its
+  // own. Otherwise there is one element per size in `Size` and each call
+  // samples its size from this distribution, so a run yields a single
+  // measurement of the mix.
+  std::vector<double> SizeDistribution;
 };
 
 //--------
@@ -66,7 +74,7 @@ struct StudyConfiguration {
 //--------
 
 // The time to run one iteration of the function under test for the specified
-// Size.
+// Size. Size is 0 when sizes are sampled from `SizeDistribution`.
 struct Measurement {
   uint32_t Size = 0;
   Duration Runtime = {};
@@ -177,6 +185,25 @@ public:
   }
 };
 
+// Helper to generate sizes that follow the configuration's SizeDistribution.
+// When the configuration has no distribution the helper is disabled and the
+// caller uses the size currently being measured.
+class SizeDistribution {
+  std::discrete_distribution<uint32_t> Distribution;
+  uint32_t From;
+  uint32_t Step;
+  bool Enabled;
+
+public:
+  explicit SizeDistribution(const StudyConfiguration &Conf);
+
+  explicit operator bool() const { return Enabled; }
+
+  template <class Generator> uint32_t operator()(Generator &G) {
+    return From + Distribution(G) * Step;
+  }
+};
+
 } // namespace libc_benchmarks
 } // namespace llvm
 
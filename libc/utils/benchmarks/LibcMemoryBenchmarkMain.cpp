@@ -55,19 +55,23 @@ void Main() {
 
   const auto Runs = S.Configuration.Runs;
   const auto &SR = S.Configuration.Size;
+  // When sizes are sampled from a distribution, each run is a single
+  // measurement of the whole mix.
+  const bool SamplesSizes = !S.Configuration.SizeDistribution.empty();
+  const uint32_t To = SamplesSizes ? SR.From : SR.To;
   std::unique_ptr<BenchmarkRunner> Runner = getRunner(S.Configuration);
-  const size_t TotalSteps =
-      Runner->getFunctionNames().size() * Runs * ((SR.To - SR.From) / SR.Step);
+  const size_t TotalSteps = Runner->getFunctionNames().size() * Runs *
+                            ((To - SR.From) / SR.Step + 1);
   size_t Steps = 0;
   for (auto FunctionName : Runner->getFunctionNames()) {
     FunctionMeasurements FM;
     FM.Name = FunctionName;
     for (size_t Run = 0; Run < Runs; ++Run) {
-      for (uint32_t Size = SR.From; Size <= SR.To; Size += SR.Step) {
+      for (uint32_t Size = SR.From; Size <= To; Size += SR.Step) {
         const auto Result = Runner->benchmark(S.Options, FunctionName, Size);
         Measurement Measurement;
         Measurement.Runtime = Result.BestGuess;
-        Measurement.Size = Size;
+        Measurement.Size = SamplesSizes ? 0 : Size;
         FM.Measurements.push_back(Measurement);
         outs() << format("%3d%% run: %2d / %2d size: %5d ",
                          (Steps * 100 / TotalSteps), Run, Runs, Size)
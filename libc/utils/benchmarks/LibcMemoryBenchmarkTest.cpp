@@ -107,6 +107,26 @@ TEST(MismatchOffsetDistribution, MismatchAt2) {
   }
 }
 
+TEST(SizeDistribution, DisabledWithoutDistribution) {
+  StudyConfiguration Conf;
+
+  SizeDistribution SD(Conf);
+  EXPECT_FALSE(SD);
+}
+
+TEST(SizeDistribution, SamplesConfiguredSizes) {
+  StudyConfiguration Conf;
+  Conf.Size = SizeRange{8, 32, 8};
+  // Sizes 8 and 24 only.
+  Conf.SizeDistribution = {1, 0, 3, 0};
+
+  SizeDistribution SD(Conf);
+  EXPECT_TRUE(SD);
+  std::default_random_engine Gen;
+  for (size_t I = 0; I <= 100; ++I)
+    EXPECT_THAT(SD(Gen), AnyOf(8U, 24U));
+}
+
 } // namespace
 } // namespace libc_benchmarks
 } // namespace llvm
@@ -21,11 +21,12 @@ struct MemcmpContext : public BenchmarkRunner {
 
   struct ParameterType {
     uint16_t Offset = 0;
+    uint32_t Size = 0;
   };
 
   explicit MemcmpContext(const StudyConfiguration &Conf)
-      : MOD(Conf), OD(Conf), ABuffer(Conf.BufferSize), BBuffer(Conf.BufferSize),
-        PP(*this) {
+      : MOD(Conf), OD(Conf), SD(Conf), ABuffer(Conf.BufferSize),
+        BBuffer(Conf.BufferSize), PP(*this) {
     std::uniform_int_distribution<char> Dis;
     // Generate random buffer A.
     for (size_t I = 0; I < Conf.BufferSize; ++I)
@@ -44,12 +45,10 @@ struct MemcmpContext : public BenchmarkRunner {
 
   // Needed by the ParameterProvider to update the current batch of parameter.
   void Randomize(MutableArrayRef<ParameterType> Parameters) {
-    if (MOD)
-      for (auto &P : Parameters)
-        P.Offset = MOD(Gen, CurrentSize);
-    else
-      for (auto &P : Parameters)
-        P.Offset = OD(Gen);
+    for (auto &P : Parameters) {
+      P.Size = SD ? SD(Gen) : CurrentSize;
+      P.Offset = MOD ? MOD(Gen, P.Size) : OD(Gen);
+    }
   }
 
   ArrayRef<StringRef> getFunctionNames() const override {
@@ -64,8 +63,8 @@ struct MemcmpContext : public BenchmarkRunner {
     FunctionPrototype Function =
         StringSwitch<FunctionPrototype>(FunctionName).Case("memcmp", &::memcmp);
     return llvm::libc_benchmarks::benchmark(
-        Options, PP, [this, Function, Size](ParameterType p) {
-          return Function(ABuffer + p.Offset, BBuffer + p.Offset, Size);
+        Options, PP, [this, Function](ParameterType p) {
+          return Function(ABuffer + p.Offset, BBuffer + p.Offset, p.Size);
         });
   }
 
@@ -73,7 +72,8 @@ private:
   std::default_random_engine Gen;
   MismatchOffsetDistribution MOD;
   OffsetDistribution OD;
-  size_t CurrentSize = 0;
+  SizeDistribution SD;
+  uint32_t CurrentSize = 0;
   AlignedBuffer ABuffer;
   AlignedBuffer BBuffer;
   SmallParameterProvider<MemcmpContext> PP;
@@ -23,17 +23,19 @@ struct MemcpyContext : public BenchmarkRunner {
   struct ParameterType {
     uint16_t SrcOffset = 0;
     uint16_t DstOffset = 0;
+    uint32_t Size = 0;
   };
 
   explicit MemcpyContext(const StudyConfiguration &Conf)
-      : OD(Conf), SrcBuffer(Conf.BufferSize), DstBuffer(Conf.BufferSize),
-        PP(*this) {}
+      : OD(Conf), SD(Conf), SrcBuffer(Conf.BufferSize),
+        DstBuffer(Conf.BufferSize), PP(*this) {}
 
   // Needed by the ParameterProvider to update the current batch of parameter.
   void Randomize(MutableArrayRef<ParameterType> Parameters) {
     for (auto &P : Parameters) {
       P.DstOffset = OD(Gen);
       P.SrcOffset = OD(Gen);
+      P.Size = SD ? SD(Gen) : CurrentSize;
     }
   }
 
@@ -44,11 +46,12 @@ struct MemcpyContext : public BenchmarkRunner {
 
   BenchmarkResult benchmark(const BenchmarkOptions &Options,
                             StringRef FunctionName, size_t Size) override {
+    CurrentSize = Size;
     FunctionPrototype Function =
         StringSwitch<FunctionPrototype>(FunctionName).Case("memcpy", &::memcpy);
     return llvm::libc_benchmarks::benchmark(
-        Options, PP, [this, Function, Size](ParameterType p) {
-          Function(DstBuffer + p.DstOffset, SrcBuffer + p.SrcOffset, Size);
+        Options, PP, [this, Function](ParameterType p) {
+          Function(DstBuffer + p.DstOffset, SrcBuffer + p.SrcOffset, p.Size);
           return DstBuffer + p.DstOffset;
         });
   }
@@ -56,6 +59,8 @@ struct MemcpyContext : public BenchmarkRunner {
 private:
   std::default_random_engine Gen;
   OffsetDistribution OD;
+  SizeDistribution SD;
+  uint32_t CurrentSize = 0;
   AlignedBuffer SrcBuffer;
   AlignedBuffer DstBuffer;
   SmallParameterProvider<MemcpyContext> PP;
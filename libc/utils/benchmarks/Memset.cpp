@@ -21,16 +21,18 @@ struct MemsetContext : public BenchmarkRunner {
 
   struct ParameterType {
     uint16_t DstOffset = 0;
+    uint32_t Size = 0;
   };
 
   explicit MemsetContext(const StudyConfiguration &Conf)
-      : OD(Conf), DstBuffer(Conf.BufferSize), MemsetValue(Conf.MemsetValue),
-        PP(*this) {}
+      : OD(Conf), SD(Conf), DstBuffer(Conf.BufferSize),
+        MemsetValue(Conf.MemsetValue), PP(*this) {}
 
   // Needed by the ParameterProvider to update the current batch of parameter.
   void Randomize(MutableArrayRef<ParameterType> Parameters) {
     for (auto &P : Parameters) {
       P.DstOffset = OD(Gen);
+      P.Size = SD ? SD(Gen) : CurrentSize;
     }
   }
 
@@ -41,11 +43,12 @@ struct MemsetContext : public BenchmarkRunner {
 
   BenchmarkResult benchmark(const BenchmarkOptions &Options,
                             StringRef FunctionName, size_t Size) override {
+    CurrentSize = Size;
     FunctionPrototype Function =
         StringSwitch<FunctionPrototype>(FunctionName).Case("memset", &::memset);
     return llvm::libc_benchmarks::benchmark(
-        Options, PP, [this, Function, Size](ParameterType p) {
-          Function(DstBuffer + p.DstOffset, MemsetValue, Size);
+        Options, PP, [this, Function](ParameterType p) {
+          Function(DstBuffer + p.DstOffset, MemsetValue, p.Size);
           return DstBuffer + p.DstOffset;
         });
   }
@@ -53,6 +56,8 @@ struct MemsetContext : public BenchmarkRunner {
 private:
   std::default_random_engine Gen;
   OffsetDistribution OD;
+  SizeDistribution SD;
+  uint32_t CurrentSize = 0;
   AlignedBuffer DstBuffer;
   const uint8_t MemsetValue;
   SmallParameterProvider<MemsetContext> PP;
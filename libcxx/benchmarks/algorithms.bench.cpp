@@ -248,6 +248,23 @@ struct PopHeap {
   };
 };
 
+struct FindChar {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    // Only the last element matches, so every iteration scans the whole range.
+    std::vector<char> V(Quantity, 'a');
+    V.back() = 'b';
+    while (state.KeepRunningBatch(Quantity)) {
+      benchmark::DoNotOptimize(std::find(V.begin(), V.end(), 'b'));
+    }
+  }
+
+  std::string name() const {
+    return "BM_FindChar_" + std::to_string(Quantity);
+  };
+};
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -272,5 +289,6 @@ int main(int argc, char** argv) {
       Quantities);
   makeCartesianProductBenchmark<PushHeap, AllValueTypes, AllOrders>(Quantities);
   makeCartesianProductBenchmark<PopHeap, AllValueTypes>(Quantities);
+  makeCartesianProductBenchmark<FindChar>(Quantities);
   benchmark::RunSpecifiedBenchmarks();
 }
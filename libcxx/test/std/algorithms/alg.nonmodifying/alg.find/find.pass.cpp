@@ -29,6 +29,23 @@ TEST_CONSTEXPR bool test_constexpr() {
     }
 #endif
 
+// Ranges of bytes must only match values that compare equal after the usual
+// arithmetic conversions, not values that merely share the low byte.
+void test_bytes() {
+    signed char sc[] = {0, 1, -1, 127, -128};
+    unsigned char uc[] = {0, 1, 255, 127, 128};
+    const unsigned s = sizeof(sc)/sizeof(sc[0]);
+    assert(std::find(sc, sc+s, -1) == sc+2);
+    assert(std::find(sc, sc+s, 255) == sc+s);
+    assert(std::find(sc, sc+s, 0xFFFFFFFFu) == sc+2);
+    assert(std::find(sc, sc+s, static_cast<unsigned short>(0xFFFF)) == sc+s);
+    assert(std::find(sc, sc+s, 256 + 1) == sc+s);
+    assert(std::find(uc, uc+s, 255) == uc+2);
+    assert(std::find(uc, uc+s, -1) == uc+s);
+    assert(std::find(uc, uc+s, 128L) == uc+4);
+    assert(std::find(uc, uc, 0) == uc);
+}
+
 int main(int, char**)
 {
     int ia[] = {0, 1, 2, 3, 4, 5};
@@ -39,6 +56,8 @@ int main(int, char**)
     r = std::find(input_iterator<const int*>(ia), input_iterator<const int*>(ia+s), 10);
     assert(r == input_iterator<const int*>(ia+s));
 
+    test_bytes();
+
 #if TEST_STD_VER > 17
     static_assert(test_constexpr());
 #endif
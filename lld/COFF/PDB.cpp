@@ -59,6 +59,7 @@
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ScopedPrinter.h"
+#include <atomic>
 #include <memory>
 
 using namespace llvm;
@@ -107,6 +108,11 @@ public:
   /// Link info for each import file in the symbol table into the PDB.
   void addImportFilesToPDB(ArrayRef<OutputSection *> outputSections);
 
+  /// With /DEBUG:GHASH, compute the global type hashes of all objects that
+  /// don't carry a usable .debug$H section. Hashing is independent per object,
+  /// so this is done in parallel ahead of the (serial) type merging.
+  void computeGlobalTypeHashes();
+
   /// Link CodeView from a single object file into the target (output) PDB.
   /// When a precompiled headers object is linked, its TPI map might be provided
   /// externally.
@@ -178,6 +184,10 @@ private:
 
   llvm::SmallString<128> nativePath;
 
+  /// Global type hashes computed by computeGlobalTypeHashes(), keyed by
+  /// object file. Entries are dropped once the object's types are merged.
+  DenseMap<const ObjFile *, std::vector<GloballyHashedType>> globalTypeHashes;
+
   /// Type index mappings of type server PDBs that we've loaded so far.
   std::map<codeview::GUID, CVIndexMap> typeServerIndexMappings;
 
@@ -324,17 +334,71 @@ getHashesFromDebugH(ArrayRef<uint8_t> debugH) {
   return {reinterpret_cast<const GloballyHashedType *>(debugH.data()), count};
 }
 
+// Returns the type records of an object's .debug$T section.
+static CVTypeArray readDebugTypes(ObjFile *file) {
+  CVTypeArray types;
+  BinaryStreamReader reader(file->debugTypes, support::little);
+  cantFail(reader.readArray(types, reader.getLength()));
+
+  if (file->debugTypesObj->kind == TpiSource::UsingPCH) {
+    // Drop LF_PRECOMP record from the input stream, as it is replaced with
+    // the precompiled headers Type stream by mergeInPrecompHeaderObj(). Note
+    // that we can't just call Types.drop_front(), as we explicitly want to
+    // rebase the stream.
+    CVTypeArray::Iterator firstType = types.begin();
+    types.setUnderlyingStream(
+        types.getUnderlyingStream().drop_front(firstType->RecordData.size()));
+  }
+  return types;
+}
+
 static void addTypeInfo(pdb::TpiStreamBuilder &tpiBuilder,
                         TypeCollection &typeTable) {
   // Start the TPI or IPI stream header.
   tpiBuilder.setVersionHeader(pdb::PdbTpiV80);
 
-  // Flatten the in memory type table and hash each type.
-  typeTable.ForEachRecord([&](TypeIndex ti, const CVType &type) {
-    auto hash = pdb::hashTypeRecord(type);
-    if (auto e = hash.takeError())
-      fatal("type hashing error");
-    tpiBuilder.addTypeRecord(type.RecordData, *hash);
+  // Flatten the in memory type table and hash each type. Hashing is by far
+  // the most expensive part, so do it in parallel.
+  std::vector<CVType> types;
+  types.reserve(typeTable.size());
+  typeTable.ForEachRecord(
+      [&](TypeIndex ti, const CVType &type) { types.push_back(type); });
+
+  std::vector<uint32_t> hashes(types.size());
+  std::atomic<bool> failed{false};
+  parallelForEachN(0, types.size(), [&](size_t i) {
+    Expected<uint32_t> hash = pdb::hashTypeRecord(types[i]);
+    if (!hash) {
+      consumeError(hash.takeError());
+      failed = true;
+      return;
+    }
+    hashes[i] = *hash;
+  });
+  if (failed)
+    fatal("type hashing error");
+
+  for (size_t i = 0, e = types.size(); i != e; ++i)
+    tpiBuilder.addTypeRecord(types[i].RecordData, hashes[i]);
+}
+
+void PDBLinker::computeGlobalTypeHashes() {
+  ScopedTimer t(typeMergingTimer);
+
+  std::vector<ObjFile *> files;
+  for (ObjFile *file : ObjFile::instances) {
+    if (!file->debugTypesObj ||
+        file->debugTypesObj->kind == TpiSource::UsingPDB || getDebugH(file))
+      continue;
+    globalTypeHashes[file];
+    files.push_back(file);
+  }
+
+  // The map is not modified while the hashes are computed, so each thread can
+  // safely fill in its own entry.
+  parallelForEach(files, [&](ObjFile *file) {
+    globalTypeHashes.find(file)->second =
+        GloballyHashedType::hashTypes(readDebugTypes(file));
   });
 }
 
@@ -375,10 +439,6 @@ PDBLinker::mergeDebugT(ObjFile *file, CVIndexMap *objectIndexMap) {
     return maybeMergeTypeServerPDB(file);
   }
 
-  CVTypeArray types;
-  BinaryStreamReader reader(file->debugTypes, support::little);
-  cantFail(reader.readArray(types, reader.getLength()));
-
   if (file->debugTypesObj->kind == TpiSource::UsingPCH) {
     // This object was compiled with /Yu, so process the corresponding
     // precompiled headers object (/Yc) first. Some type indices in the current
@@ -387,23 +447,22 @@ PDBLinker::mergeDebugT(ObjFile *file, CVIndexMap *objectIndexMap) {
     Error e = mergeInPrecompHeaderObj(file, objectIndexMap);
     if (e)
       return std::move(e);
-
-    // Drop LF_PRECOMP record from the input stream, as it has been replaced
-    // with the precompiled headers Type stream in the mergeInPrecompHeaderObj()
-    // call above. Note that we can't just call Types.drop_front(), as we
-    // explicitly want to rebase the stream.
-    CVTypeArray::Iterator firstType = types.begin();
-    types.setUnderlyingStream(
-        types.getUnderlyingStream().drop_front(firstType->RecordData.size()));
   }
 
+  CVTypeArray types = readDebugTypes(file);
+
   // Fill in the temporary, caller-provided ObjectIndexMap.
   if (config->debugGHashes) {
     ArrayRef<GloballyHashedType> hashes;
     std::vector<GloballyHashedType> ownedHashes;
-    if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file))
+    auto it = globalTypeHashes.find(file);
+    if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file)) {
       hashes = getHashesFromDebugH(*debugH);
-    else {
+    } else if (it != globalTypeHashes.end()) {
+      ownedHashes = std::move(it->second);
+      globalTypeHashes.erase(it);
+      hashes = ownedHashes;
+    } else {
       ownedHashes = GloballyHashedType::hashTypes(types);
       hashes = ownedHashes;
     }
@@ -1315,6 +1374,9 @@ void PDBLinker::addObjectsToPDB() {
 
   createModuleDBI(builder);
 
+  if (config->debugGHashes)
+    computeGlobalTypeHashes();
+
   for (ObjFile *file : ObjFile::instances)
     addObjFile(file);
 
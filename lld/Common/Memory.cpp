@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "lld/Common/Memory.h"
+#include <mutex>
 
 using namespace llvm;
 using namespace lld;
@@ -15,6 +16,13 @@ BumpPtrAllocator lld::bAlloc;
 StringSaver lld::saver{bAlloc};
 std::vector<SpecificAllocBase *> lld::SpecificAllocBase::instances;
 
+static std::mutex instancesMutex;
+
+SpecificAllocBase::SpecificAllocBase() {
+  std::lock_guard<std::mutex> lock(instancesMutex);
+  instances.push_back(this);
+}
+
 void lld::freeArena() {
   for (SpecificAllocBase *alloc : SpecificAllocBase::instances)
     alloc->reset();
@@ -38,6 +38,12 @@
 ///   * If not, then combine the clusters.
 /// * Sort non-empty clusters by density
 ///
+/// Input sections that the compiler already classified as hot (.text.hot.*)
+/// or cold (.text.unlikely.*) are only clustered with sections of the same
+/// class, and hot clusters are placed before normal ones, which are placed
+/// before cold ones. This keeps the code that is actually executed together
+/// even when the profile has edges into cold split-out parts.
+///
 //===----------------------------------------------------------------------===//
 
 #include "CallGraphSort.h"
@@ -58,8 +64,13 @@ struct Edge {
   uint64_t weight;
 };
 
+// The hotness class of an input section, inferred from its name. Clusters
+// are laid out in this order.
+enum class Hotness { Hot, Normal, Cold };
+
 struct Cluster {
-  Cluster(int sec, size_t s) : next(sec), prev(sec), size(s) {}
+  Cluster(int sec, size_t s, Hotness h)
+      : next(sec), prev(sec), size(s), hotness(h) {}
 
   double getDensity() const {
     if (size == 0)
@@ -73,6 +84,7 @@ struct Cluster {
   uint64_t weight = 0;
   uint64_t initialWeight = 0;
   Edge bestPred = {-1, 0};
+  Hotness hotness;
 };
 
 class CallGraphSort {
@@ -97,6 +109,15 @@ constexpr uint64_t MAX_CLUSTER_SIZE = 1024 * 1024;
 using SectionPair =
     std::pair<const InputSectionBase *, const InputSectionBase *>;
 
+static Hotness getHotness(const InputSectionBase *isec) {
+  StringRef name = isec->name;
+  if (name == ".text.hot" || name.startswith(".text.hot."))
+    return Hotness::Hot;
+  if (name == ".text.unlikely" || name.startswith(".text.unlikely."))
+    return Hotness::Cold;
+  return Hotness::Normal;
+}
+
 // Take the edge list in Config->CallGraphProfile, resolve symbol names to
 // Symbols, and generate a graph between InputSections with the provided
 // weights.
@@ -108,7 +129,8 @@ CallGraphSort::CallGraphSort() {
     auto res = secToCluster.try_emplace(isec, clusters.size());
     if (res.second) {
       sections.push_back(isec);
-      clusters.emplace_back(clusters.size(), isec->getSize());
+      clusters.emplace_back(clusters.size(), isec->getSize(),
+                            getHotness(isec));
     }
     return res.first->second;
   };
@@ -206,6 +228,10 @@ DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
     if (c.size + predC->size > MAX_CLUSTER_SIZE)
       continue;
 
+    // Don't mix hot or cold code into clusters of a different class.
+    if (c.hotness != predC->hotness)
+      continue;
+
     if (isNewDensityBad(*predC, c))
       continue;
 
@@ -213,12 +239,14 @@ DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
     mergeClusters(clusters, *predC, predL, c, l);
   }
 
-  // Sort remaining non-empty clusters by density.
+  // Sort remaining non-empty clusters by hotness class, then by density.
   sorted.clear();
   for (int i = 0, e = (int)clusters.size(); i != e; ++i)
     if (clusters[i].size > 0)
       sorted.push_back(i);
   llvm::stable_sort(sorted, [&](int a, int b) {
+    if (clusters[a].hotness != clusters[b].hotness)
+      return clusters[a].hotness < clusters[b].hotness;
     return clusters[a].getDensity() > clusters[b].getDensity();
   });
 
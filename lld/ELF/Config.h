@@ -109,6 +109,7 @@ struct Configuration {
   llvm::StringRef optRemarksFormat;
   llvm::StringRef progName;
   llvm::StringRef printSymbolOrder;
+  llvm::StringRef skipIfUnchanged;
   llvm::StringRef soName;
   llvm::StringRef sysroot;
   llvm::StringRef thinLTOCacheDir;
@@ -180,7 +181,9 @@ struct Configuration {
   bool picThunk;
   bool pie;
   bool printGcSections;
+  bool printDynamicRelocStats;
   bool printIcfSections;
+  bool releaseOutputPages;
   bool relocatable;
   bool relrPackDynRelocs;
   bool saveTemps;
@@ -94,6 +94,7 @@ bool link(ArrayRef<const char *> args, bool canExitEarly, raw_ostream &stdoutOS,
   bitcodeFiles.clear();
   objectFiles.clear();
   sharedFiles.clear();
+  inputFileHashes.clear();
 
   config = make<Configuration>();
   driver = make<LinkerDriver>();
@@ -173,6 +174,8 @@ std::vector<std::pair<MemoryBufferRef, uint64_t>> static getArchiveMembers(
                   ": could not get the buffer for a child of the archive");
     if (addToTar)
       tar->append(relativeToRoot(check(c.getFullName())), mbref.getBuffer());
+    if (file->isThin())
+      recordInputFile(check(c.getFullName()), mbref.getBuffer());
     v.push_back(std::make_pair(mbref, c.getChildOffset()));
   }
   if (err)
@@ -500,6 +503,13 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
     if (errorCount())
       return;
 
+    // Skip the link if nothing has changed since the link that wrote the
+    // --skip-if-unchanged file.
+    if (!config->skipIfUnchanged.empty() && !tar && isLinkStateUpToDate(args)) {
+      log("--skip-if-unchanged: " + config->outputFile + " is up to date");
+      return;
+    }
+
     inferMachineType();
     setConfigs(args);
     checkOptions();
@@ -527,6 +537,9 @@ void LinkerDriver::main(ArrayRef<const char *> argsArr) {
     default:
       llvm_unreachable("unknown Config->EKind");
     }
+
+    if (!config->skipIfUnchanged.empty() && !errorCount())
+      writeLinkState(args);
   }
 
   if (config->timeTraceEnabled) {
@@ -949,6 +962,7 @@ static void readConfigs(opt::InputArgList &args) {
   config->outputFile = args.getLastArgValue(OPT_o);
   config->pacPlt = hasZOption(args, "pac-plt");
   config->pie = args.hasFlag(OPT_pie, OPT_no_pie, false);
+  config->printDynamicRelocStats = args.hasArg(OPT_print_dynamic_reloc_stats);
   config->printIcfSections =
       args.hasFlag(OPT_print_icf_sections, OPT_no_print_icf_sections, false);
   config->printGcSections =
@@ -956,12 +970,15 @@ static void readConfigs(opt::InputArgList &args) {
   config->printSymbolOrder =
       args.getLastArgValue(OPT_print_symbol_order);
   config->rpath = getRpath(args);
+  config->releaseOutputPages = args.hasFlag(
+      OPT_release_output_pages, OPT_no_release_output_pages, false);
   config->relocatable = args.hasArg(OPT_relocatable);
   config->saveTemps = args.hasArg(OPT_save_temps);
   config->searchPaths = args::getStrings(args, OPT_library_path);
   config->sectionStartMap = getSectionStartMap(args);
   config->shared = args.hasArg(OPT_shared);
   config->singleRoRx = args.hasArg(OPT_no_rosegment);
+  config->skipIfUnchanged = args.getLastArgValue(OPT_skip_if_unchanged);
   config->soName = args.getLastArgValue(OPT_soname);
   config->sortSection = getSortSection(args);
   config->splitStackAdjustSize = args::getInteger(args, OPT_split_stack_adjust_size, 16384);
@@ -1803,6 +1820,32 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
   // appended to the Files vector.
   {
     llvm::TimeTraceScope timeScope("Parse input files");
+
+    if (threadsEnabled) {
+      // Section headers, section names and group signatures of an object
+      // file do not depend on other files, so decode them in parallel.
+      std::vector<ObjFile<ELFT> *> objs;
+      for (InputFile *f : files)
+        if (auto *obj = dyn_cast<ObjFile<ELFT>>(f))
+          if (obj->ekind == config->ekind && !obj->justSymbols)
+            objs.push_back(obj);
+      parallelForEach(objs,
+                      [](ObjFile<ELFT> *obj) { obj->decodeSectionHeaders(); });
+
+      // Archive members cannot be fetched before the first archive or lazy
+      // object file is seen, so the global symbols of the leading run of
+      // object files can be inserted in parallel without changing the order
+      // in which symbols are created.
+      std::vector<ObjFile<ELFT> *> leadingObjs;
+      for (InputFile *f : files) {
+        auto *obj = dyn_cast<ObjFile<ELFT>>(f);
+        if (!obj || obj->ekind != config->ekind)
+          break;
+        leadingObjs.push_back(obj);
+      }
+      symtab->insertObjSymbols<ELFT>(leadingObjs);
+    }
+
     for (size_t i = 0; i < files.size(); ++i)
       parseFile(files[i]);
   }
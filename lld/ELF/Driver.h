@@ -71,6 +71,9 @@ llvm::Optional<std::string> searchScript(StringRef path);
 llvm::Optional<std::string> searchLibraryBaseName(StringRef path);
 llvm::Optional<std::string> searchLibrary(StringRef path);
 
+bool isLinkStateUpToDate(const llvm::opt::InputArgList &args);
+void writeLinkState(const llvm::opt::InputArgList &args);
+
 } // namespace elf
 } // namespace lld
 
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Driver.h"
+#include "InputFiles.h"
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Reproduce.h"
@@ -25,6 +26,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace llvm;
 using namespace llvm::sys;
@@ -252,5 +254,92 @@ Optional<std::string> searchScript(StringRef name) {
   return findFromSearchPaths(name);
 }
 
+// --skip-if-unchanged=<file> records what the last successful link
+// consumed: a hash of the command line, the size and modification time of
+// the output file, and the paths and content hashes of all input files in
+// the order they were read. If none of them has changed, the output is
+// already up to date and the link can be skipped. Any difference results
+// in a full link.
+static const char linkStateMagic[] = "lld-link-state v1";
+
+static std::string hashArgs(const opt::InputArgList &args) {
+  std::string s = getLLDVersion();
+  for (auto *arg : args) {
+    s += '\0';
+    s += arg->getAsString(args);
+  }
+  return utohexstr(xxHash64(s));
+}
+
+// Returns the size and modification time of the output file, or the empty
+// string if it does not exist.
+static std::string getOutputStamp() {
+  fs::file_status st;
+  if (fs::status(config->outputFile, st) || !fs::exists(st))
+    return "";
+  return (Twine(st.getSize()) + " " +
+          Twine(st.getLastModificationTime().time_since_epoch().count()))
+      .str();
+}
+
+bool isLinkStateUpToDate(const opt::InputArgList &args) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr =
+      MemoryBuffer::getFile(config->skipIfUnchanged);
+  if (!mbOrErr)
+    return false;
+
+  SmallVector<StringRef, 0> lines;
+  (*mbOrErr)->getBuffer().split(lines, '\n', -1, /*KeepEmpty=*/false);
+  std::string stamp = getOutputStamp();
+  if (lines.size() < 3 || lines[0] != linkStateMagic ||
+      lines[1] != "args " + hashArgs(args) || stamp.empty() ||
+      lines[2] != "output " + stamp)
+    return false;
+
+  // Files read so far by the driver must be the same ones, in the same
+  // order. Files that were read later (e.g. archive members or dependent
+  // libraries) are read and hashed here.
+  size_t numRead = inputFileHashes.size();
+  ArrayRef<StringRef> entries = makeArrayRef(lines).slice(3);
+  if (entries.size() < numRead)
+    return false;
+
+  for (size_t i = 0, e = entries.size(); i != e; ++i) {
+    StringRef hashStr, path;
+    std::tie(hashStr, path) = entries[i].split(' ');
+    uint64_t hash;
+    if (hashStr.getAsInteger(16, hash))
+      return false;
+
+    if (i < numRead) {
+      if (inputFileHashes[i].first != path ||
+          inputFileHashes[i].second != hash)
+        return false;
+      continue;
+    }
+
+    ErrorOr<std::unique_ptr<MemoryBuffer>> fileOrErr =
+        MemoryBuffer::getFile(path, -1, false);
+    if (!fileOrErr || xxHash64((*fileOrErr)->getBuffer()) != hash)
+      return false;
+  }
+  return true;
+}
+
+void writeLinkState(const opt::InputArgList &args) {
+  std::error_code ec;
+  raw_fd_ostream os(config->skipIfUnchanged, ec, fs::OF_None);
+  if (ec) {
+    error("cannot open " + config->skipIfUnchanged + ": " + ec.message());
+    return;
+  }
+
+  os << linkStateMagic << "\n";
+  os << "args " << hashArgs(args) << "\n";
+  os << "output " << getOutputStamp() << "\n";
+  for (const std::pair<std::string, uint64_t> &entry : inputFileHashes)
+    os << utohexstr(entry.second) << " " << entry.first << "\n";
+}
+
 } // namespace elf
 } // namespace lld
@@ -430,6 +430,36 @@ void ICF<ELFT>::forEachClass(llvm::function_ref<void(size_t, size_t)> fn) {
   ++cnt;
 }
 
+// Compute the initial hash of a section from its contents and the parts of
+// its relocations that equalsConstant compares exactly (offsets and types),
+// in a single pass. Sections whose bytes are identical but which only differ
+// in relocations are common in template-heavy C++ code; hashing the
+// relocations up front keeps them out of each other's classes so that
+// segregate does not have to compare them.
+template <class ELFT, class RelTy>
+static uint32_t computeConstantHash(InputSection *isec, ArrayRef<RelTy> rels) {
+  uint64_t hash = xxHash64(isec->data());
+  for (const RelTy &rel : rels)
+    hash = hash_combine(hash, (uint64_t)rel.r_offset,
+                        rel.getType(config->isMips64EL));
+  return hash;
+}
+
+// Returns true if the result of equalsVariable for the given section can
+// depend on equivalence classes, i.e. if one of its relocations refers to a
+// section subject to ICF.
+template <class ELFT, class RelTy>
+static bool hasVariableTargets(InputSection *isec, ArrayRef<RelTy> rels) {
+  for (const RelTy &rel : rels) {
+    Symbol &s = isec->template getFile<ELFT>()->getRelocTargetSym(rel);
+    if (auto *d = dyn_cast<Defined>(&s))
+      if (auto *relSec = dyn_cast_or_null<InputSection>(d->section))
+        if (relSec->eqClass[0] != 0 || relSec->eqClass[1] != 0)
+          return true;
+  }
+  return false;
+}
+
 // Combine the hashes of the sections referenced by the given section into its
 // hash.
 template <class ELFT, class RelTy>
@@ -468,7 +498,10 @@ template <class ELFT> void ICF<ELFT>::run() {
 
   // Initially, we use hash values to partition sections.
   parallelForEach(sections, [&](InputSection *s) {
-    s->eqClass[0] = xxHash64(s->data());
+    if (s->areRelocsRela)
+      s->eqClass[0] = computeConstantHash<ELFT>(s, s->template relas<ELFT>());
+    else
+      s->eqClass[0] = computeConstantHash<ELFT>(s, s->template rels<ELFT>());
   });
 
   for (unsigned cnt = 0; cnt != 2; ++cnt) {
@@ -489,12 +522,43 @@ template <class ELFT> void ICF<ELFT>::run() {
   // Compare static contents and assign unique IDs for each static content.
   forEachClass([&](size_t begin, size_t end) { segregate(begin, end, true); });
 
-  // Split groups by comparing relocations until convergence is obtained.
-  do {
-    repeat = false;
-    forEachClass(
-        [&](size_t begin, size_t end) { segregate(begin, end, false); });
-  } while (repeat);
+  // Split groups by comparing relocations.
+  repeat = false;
+  forEachClass([&](size_t begin, size_t end) { segregate(begin, end, false); });
+
+  // After that, a class none of whose members refers to a section subject to
+  // ICF cannot be split any further, because equalsVariable only depends on
+  // the classes of such sections. Since that class is never split, its
+  // members do not move in Sections either, so we can mark it by position
+  // and skip it in the remaining iterations.
+  if (repeat) {
+    std::vector<uint8_t> isFixed(sections.size());
+    parallelForEachN(0, sections.size(), [&](size_t i) {
+      InputSection *s = sections[i];
+      if (s->areRelocsRela)
+        isFixed[i] = !hasVariableTargets<ELFT>(s, s->template relas<ELFT>());
+      else
+        isFixed[i] = !hasVariableTargets<ELFT>(s, s->template rels<ELFT>());
+    });
+    forEachClassRange(0, sections.size(), [&](size_t begin, size_t end) {
+      bool fixed = std::all_of(isFixed.begin() + begin, isFixed.begin() + end,
+                               [](uint8_t b) { return b; });
+      std::fill(isFixed.begin() + begin, isFixed.begin() + end, fixed);
+    });
+
+    // Iterate until convergence is obtained.
+    do {
+      repeat = false;
+      forEachClass([&](size_t begin, size_t end) {
+        if (!isFixed[begin]) {
+          segregate(begin, end, false);
+          return;
+        }
+        for (size_t i = begin; i < end; ++i)
+          sections[i]->eqClass[next] = end;
+      });
+    } while (repeat);
+  }
 
   log("ICF needed " + Twine(cnt) + " iterations");
 
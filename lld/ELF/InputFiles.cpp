@@ -29,6 +29,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace llvm;
 using namespace llvm::ELF;
@@ -62,6 +63,7 @@ std::vector<InputFile *> objectFiles;
 std::vector<SharedFile *> sharedFiles;
 
 std::unique_ptr<TarWriter> tar;
+std::vector<std::pair<std::string, uint64_t>> inputFileHashes;
 
 static ELFKind getELFKind(MemoryBufferRef mb, StringRef archiveName) {
   unsigned char size;
@@ -121,9 +123,15 @@ Optional<MemoryBufferRef> readFile(StringRef path) {
 
   if (tar)
     tar->append(relativeToRoot(path), mbref.getBuffer());
+  recordInputFile(path, mbref.getBuffer());
   return mbref;
 }
 
+void recordInputFile(StringRef path, StringRef contents) {
+  if (!config->skipIfUnchanged.empty())
+    inputFileHashes.push_back({std::string(path), xxHash64(contents)});
+}
+
 // All input object files must be for the same architecture
 // (e.g. it does not make sense to link x86 object files with
 // MIPS object files.) This function checks for that error.
@@ -535,15 +543,41 @@ static void handleSectionGroup(ArrayRef<InputSectionBase *> sections,
     prev->nextInSectionGroup = head;
 }
 
+template <class ELFT> void ObjFile<ELFT>::decodeSectionHeaders() {
+  if (sectionHeadersDecoded)
+    return;
+  sectionHeadersDecoded = true;
+
+  const ELFFile<ELFT> &obj = this->getObj();
+  elfShdrs = CHECK(obj.sections(), this);
+  this->sectionStringTable = CHECK(obj.getSectionStringTable(elfShdrs), this);
+
+  sectionNames.resize(elfShdrs.size());
+  groupSignatures.resize(elfShdrs.size());
+  for (size_t i = 0, e = elfShdrs.size(); i != e; ++i) {
+    const Elf_Shdr &sec = elfShdrs[i];
+    if (Expected<StringRef> name =
+            obj.getSectionName(&sec, this->sectionStringTable))
+      sectionNames[i] = *name;
+    else
+      consumeError(name.takeError());
+
+    // SHF_EXCLUDE'd groups are discarded without being looked at unless -r
+    // is given, in which case they are deduplicated like the others.
+    if (sec.sh_type == SHT_GROUP &&
+        (!(sec.sh_flags & SHF_EXCLUDE) || config->relocatable))
+      groupSignatures[i] = getShtGroupSignature(elfShdrs, sec);
+  }
+}
+
 template <class ELFT>
 void ObjFile<ELFT>::initializeSections(bool ignoreComdats) {
   const ELFFile<ELFT> &obj = this->getObj();
 
-  ArrayRef<Elf_Shdr> objSections = CHECK(obj.sections(), this);
+  decodeSectionHeaders();
+  ArrayRef<Elf_Shdr> objSections = elfShdrs;
   uint64_t size = objSections.size();
   this->sections.resize(size);
-  this->sectionStringTable =
-      CHECK(obj.getSectionStringTable(objSections), this);
 
   std::vector<ArrayRef<Elf_Word>> selectedGroups;
 
@@ -578,7 +612,7 @@ void ObjFile<ELFT>::initializeSections(bool ignoreComdats) {
     switch (sec.sh_type) {
     case SHT_GROUP: {
       // De-duplicate section groups by their signatures.
-      StringRef signature = getShtGroupSignature(objSections, sec);
+      StringRef signature = groupSignatures[i];
       this->sections[i] = &InputSection::discarded;
 
 
@@ -1020,6 +1054,12 @@ InputSectionBase *ObjFile<ELFT>::createInputSection(const Elf_Shdr &sec) {
 
 template <class ELFT>
 StringRef ObjFile<ELFT>::getSectionName(const Elf_Shdr &sec) {
+  if (!sectionNames.empty()) {
+    assert(&sec >= elfShdrs.begin() && &sec < elfShdrs.end());
+    StringRef name = sectionNames[&sec - elfShdrs.begin()];
+    if (name.data())
+      return name;
+  }
   return CHECK(getObj().getSectionName(&sec, sectionStringTable), this);
 }
 
@@ -1141,6 +1181,8 @@ void ArchiveFile::fetch(const Archive::Symbol &sym) {
 
   if (tar && c.getParent()->isThin())
     tar->append(relativeToRoot(CHECK(c.getFullName(), this)), mb.getBuffer());
+  if (c.getParent()->isThin())
+    recordInputFile(CHECK(c.getFullName(), this), mb.getBuffer());
 
   InputFile *file = createObjectFile(
       mb, getName(), c.getParent()->isThin() ? 0 : c.getChildOffset());
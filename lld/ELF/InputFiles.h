@@ -52,6 +52,11 @@ extern std::unique_ptr<llvm::TarWriter> tar;
 // Opens a given file.
 llvm::Optional<MemoryBufferRef> readFile(StringRef path);
 
+// If --skip-if-unchanged is given, the paths and content hashes of all
+// input files are recorded here in the order in which they are read.
+extern std::vector<std::pair<std::string, uint64_t>> inputFileHashes;
+void recordInputFile(StringRef path, StringRef contents);
+
 // Add symbols in File to the symbol table.
 void parseFile(InputFile *file);
 
@@ -205,6 +210,12 @@ public:
 
   void parse(bool ignoreComdats = false);
 
+  // Reads the section header table and decodes section names and SHT_GROUP
+  // signatures. This does not depend on any other file, so the driver calls
+  // it for object files in parallel ahead of parse(). Otherwise parse()
+  // calls it.
+  void decodeSectionHeaders();
+
   StringRef getShtGroupSignature(ArrayRef<Elf_Shdr> sections,
                                  const Elf_Shdr &sec);
 
@@ -278,6 +289,15 @@ private:
   // .shstrtab contents.
   StringRef sectionStringTable;
 
+  // Section headers, and section names and SHT_GROUP signatures indexed by
+  // section index, filled by decodeSectionHeaders(). A name that could not
+  // be decoded has a null data pointer and is re-read (and the error
+  // reported) when it is actually needed.
+  ArrayRef<Elf_Shdr> elfShdrs;
+  std::vector<StringRef> sectionNames;
+  std::vector<StringRef> groupSignatures;
+  bool sectionHeadersDecoded = false;
+
   // Debugging information to retrieve source file and line for error
   // reporting. Linker may find reasonable number of errors in a
   // single object file, so we cache debugging information in order to
@@ -253,6 +253,53 @@ static void fill(uint8_t *buf, size_t size,
   memcpy(buf + i, filler.data(), size - i);
 }
 
+// Compress \p in into a zlib stream. The input is split into fixed-size
+// shards that are deflated and checksummed in parallel; the shards are then
+// concatenated behind a zlib header and followed by the combined Adler-32.
+// The result can be read by any zlib decompressor. Splitting resets the
+// deflate dictionary at every shard boundary, which costs a negligible
+// amount of compression ratio for 1 MiB shards.
+static void compressParallel(ArrayRef<uint8_t> in, int level,
+                             SmallVectorImpl<char> &out) {
+  constexpr size_t shardSize = 1 << 20;
+  const size_t numShards =
+      std::max<size_t>(1, divideCeil(in.size(), shardSize));
+  std::vector<SmallVector<char, 0>> shards(numShards);
+  std::vector<uint32_t> checksums(numShards);
+
+  // Every shard but the last ends with a sync flush rather than a final
+  // block, so that they can be concatenated.
+  parallelForEachN(0, numShards, [&](size_t i) {
+    StringRef shard =
+        toStringRef(in.slice(i * shardSize).take_front(shardSize));
+    if (Error e = zlib::compressRaw(shard, shards[i], level,
+                                    /*Finish=*/i + 1 == numShards))
+      fatal("compress failed: " + llvm::toString(std::move(e)));
+    checksums[i] = zlib::adler32(shard);
+  });
+
+  uint32_t checksum = checksums[0];
+  for (size_t i = 1; i != numShards; ++i)
+    checksum = zlib::adler32Combine(
+        checksum, checksums[i], std::min(shardSize, in.size() - i * shardSize));
+
+  size_t size = 2 + 4;
+  for (const SmallVector<char, 0> &shard : shards)
+    size += shard.size();
+  out.resize(size);
+
+  // zlib header: deflate with a 32 KiB window, no preset dictionary, and the
+  // check bits that make the 16-bit big-endian header a multiple of 31.
+  char *p = out.data();
+  *p++ = 0x78;
+  *p++ = 0x01;
+  for (const SmallVector<char, 0> &shard : shards) {
+    memcpy(p, shard.data(), shard.size());
+    p += shard.size();
+  }
+  write32be(p, checksum);
+}
+
 // Compress section contents if this section contains debug info.
 template <class ELFT> void OutputSection::maybeCompress() {
   using Elf_Chdr = typename ELFT::Chdr;
@@ -276,9 +323,8 @@ template <class ELFT> void OutputSection::maybeCompress() {
   // -O2 is given, we use level 6 to compress debug info more by ~15%. We found
   // that level 7 to 9 doesn't make much difference (~1% more compression) while
   // they take significant amount of time (~2x), so level 6 seems enough.
-  if (Error e = zlib::compress(toStringRef(buf), compressedData,
-                               config->optimize >= 2 ? 6 : 1))
-    fatal("compress failed: " + llvm::toString(std::move(e)));
+  int level = config->optimize >= 2 ? 6 : 1;
+  compressParallel(buf, level, compressedData);
 
   // Update section headers.
   size = sizeof(Elf_Chdr) + compressedData.size();
@@ -52,6 +52,7 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Strings.h"
+#include "lld/Common/Threads.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Demangle/Demangle.h"
 #include "llvm/Support/Endian.h"
@@ -1501,6 +1502,156 @@ template <class ELFT> void scanRelocations(InputSectionBase &s) {
     scanRelocs<ELFT>(s, s.rels<ELFT>());
 }
 
+namespace {
+// A relocation that the parallel pre-scan could not handle by itself. Pos is
+// the size of InputSectionBase::relocations when the relocation was seen, so
+// that the serial pass can keep the relocations in input order.
+struct DeferredReloc {
+  uint32_t index;
+  uint32_t pos;
+};
+} // namespace
+
+// Try to process a relocation without touching any state shared between
+// input sections. This succeeds for the most common kind of relocation: a
+// reference to a non-preemptible, non-TLS, non-ifunc defined symbol whose
+// value is a link-time constant. Such a relocation needs neither a GOT or PLT
+// entry nor a dynamic relocation, and the result is the same as what
+// scanReloc would have computed. Everything else returns false and is left
+// for scanReloc.
+template <class ELFT, class RelTy>
+static bool scanRelocLocally(InputSectionBase &sec, const RelTy &rel,
+                             const RelTy *end) {
+  Symbol &sym =
+      sec.getFile<ELFT>()->getSymbol(rel.getSymbol(config->isMips64EL));
+  if (!sym.isDefined() || sym.isPreemptible || sym.isGnuIFunc() ||
+      sym.isTls())
+    return false;
+
+  // isStaticLinkTimeConstant() may report an error for a PC-relative
+  // reference to an absolute symbol, so keep diagnostics in the serial pass.
+  if (config->isPic && isAbsoluteValue(sym))
+    return false;
+
+  RelType type = rel.getType(config->isMips64EL);
+  const uint8_t *relocatedAddr = sec.data().begin() + rel.r_offset;
+  RelExpr expr = target->getRelExpr(type, sym, relocatedAddr);
+  if (expr == R_NONE)
+    return true;
+
+  int64_t addend = computeAddend<ELFT>(rel, end, sec, expr, sym.isLocal());
+
+  // Same relaxation as in scanReloc for non-preemptible symbols.
+  if (expr == R_GOT_PC && !isAbsoluteValue(sym)) {
+    expr = target->adjustRelaxExpr(type, relocatedAddr, expr);
+  } else {
+    if (config->emachine == EM_PPC && expr == R_PPC32_PLTREL)
+      addend &= ~0x8000;
+    expr = fromPlt(expr);
+  }
+
+  if (needsPlt(expr) || needsGot(expr) ||
+      oneof<R_GOTPLTONLY_PC, R_GOTPLTREL, R_GOTPLT, R_TLSGD_GOTPLT,
+            R_GOTONLY_PC, R_GOTREL, R_PPC64_TOCBASE, R_PPC64_RELAX_TOC>(
+          expr) ||
+      !isStaticLinkTimeConstant(expr, type, sym, sec, rel.r_offset))
+    return false;
+
+  sec.relocations.push_back({expr, type, rel.r_offset, addend, &sym});
+  return true;
+}
+
+template <class ELFT, class RelTy>
+static void prescanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                          std::vector<DeferredReloc> &deferred) {
+  sec.relocations.reserve(rels.size());
+
+  bool deferNext = false;
+  for (size_t i = 0, e = rels.size(); i != e; ++i) {
+    const RelTy &rel = rels[i];
+    if (!deferNext && scanRelocLocally<ELFT>(sec, rel, rels.end()))
+      continue;
+    deferred.push_back({uint32_t(i), uint32_t(sec.relocations.size())});
+
+    // handleTlsRelocation() may consume the relocation following a TLS one
+    // (e.g. the call to __tls_get_addr in a relaxed general-dynamic code
+    // sequence), so that relocation must be seen by the serial pass as well.
+    deferNext =
+        sec.getFile<ELFT>()->getSymbol(rel.getSymbol(config->isMips64EL))
+            .isTls();
+  }
+}
+
+template <class ELFT, class RelTy>
+static void finishScanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                             ArrayRef<DeferredReloc> deferred) {
+  if (deferred.empty())
+    return;
+
+  std::vector<Relocation> local = std::move(sec.relocations);
+  sec.relocations.clear();
+  sec.relocations.reserve(local.size() + deferred.size());
+
+  OffsetGetter getOffset(sec);
+  const RelTy *next = rels.begin();
+  size_t pos = 0;
+  for (const DeferredReloc &d : deferred) {
+    const RelTy *i = rels.begin() + d.index;
+    // Skip relocations consumed by a preceding TLS relocation.
+    if (i < next)
+      continue;
+    sec.relocations.insert(sec.relocations.end(), local.begin() + pos,
+                           local.begin() + d.pos);
+    pos = d.pos;
+    scanReloc<ELFT>(sec, getOffset, i, rels.end());
+    next = i;
+  }
+  sec.relocations.insert(sec.relocations.end(), local.begin() + pos,
+                         local.end());
+}
+
+// Scan relocations of all given sections. Relocations that can be resolved
+// without creating GOT, PLT or copy relocation entries are processed in
+// parallel, one section per task. The remaining ones are then handed to
+// scanReloc serially in the same order as a fully serial scan would visit
+// them, so the contents of the synthetic sections are deterministic and do
+// not depend on the number of threads.
+template <class ELFT>
+void scanRelocations(ArrayRef<InputSectionBase *> sections) {
+  // MIPS and PPC64 have target-specific state updated while scanning (MIPS
+  // GOT, PPC64 TOC), and RISC-V and PPC64 .toc sort Sec.Relocations after
+  // scanning. Use the serial scan for them.
+  if (!threadsEnabled || config->emachine == EM_MIPS ||
+      config->emachine == EM_PPC64 || config->emachine == EM_RISCV) {
+    for (InputSectionBase *sec : sections)
+      scanRelocations<ELFT>(*sec);
+    return;
+  }
+
+  // .eh_frame relocations are translated through section pieces by
+  // OffsetGetter. There are few of them, so they are all scanned serially.
+  std::vector<std::vector<DeferredReloc>> deferred(sections.size());
+  parallelForEachN(0, sections.size(), [&](size_t i) {
+    InputSectionBase &sec = *sections[i];
+    if (!isa<InputSection>(sec))
+      return;
+    if (sec.areRelocsRela)
+      prescanRelocs<ELFT>(sec, sec.relas<ELFT>(), deferred[i]);
+    else
+      prescanRelocs<ELFT>(sec, sec.rels<ELFT>(), deferred[i]);
+  });
+
+  for (size_t i = 0, e = sections.size(); i != e; ++i) {
+    InputSectionBase &sec = *sections[i];
+    if (!isa<InputSection>(sec))
+      scanRelocations<ELFT>(sec);
+    else if (sec.areRelocsRela)
+      finishScanRelocs<ELFT>(sec, sec.relas<ELFT>(), deferred[i]);
+    else
+      finishScanRelocs<ELFT>(sec, sec.rels<ELFT>(), deferred[i]);
+  }
+}
+
 static bool mergeCmp(const InputSection *a, const InputSection *b) {
   // std::merge requires a strict weak ordering.
   if (a->outSecOff < b->outSecOff)
@@ -1979,6 +2130,10 @@ template void scanRelocations<ELF32LE>(InputSectionBase &);
 template void scanRelocations<ELF32BE>(InputSectionBase &);
 template void scanRelocations<ELF64LE>(InputSectionBase &);
 template void scanRelocations<ELF64BE>(InputSectionBase &);
+template void scanRelocations<ELF32LE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF32BE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF64LE>(ArrayRef<InputSectionBase *>);
+template void scanRelocations<ELF64BE>(ArrayRef<InputSectionBase *>);
 template void reportUndefinedSymbols<ELF32LE>();
 template void reportUndefinedSymbols<ELF32BE>();
 template void reportUndefinedSymbols<ELF64LE>();
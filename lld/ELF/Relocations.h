@@ -112,6 +112,10 @@ struct Relocation {
 // the diagnostics.
 template <class ELFT> void scanRelocations(InputSectionBase &);
 
+// Same as above for a list of sections. Relocations that do not need any
+// linker-synthesized entries are scanned in parallel.
+template <class ELFT> void scanRelocations(ArrayRef<InputSectionBase *>);
+
 template <class ELFT> void reportUndefinedSymbols();
 
 class ThunkSection;
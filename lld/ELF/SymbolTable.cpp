@@ -21,6 +21,7 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "lld/Common/Strings.h"
+#include "lld/Common/Threads.h"
 #include "llvm/ADT/STLExtras.h"
 
 using namespace llvm;
@@ -33,9 +34,12 @@ SymbolTable *symtab;
 
 void SymbolTable::wrap(Symbol *sym, Symbol *real, Symbol *wrap) {
   // Swap symbols as instructed by -wrap.
-  int &idx1 = symMap[CachedHashStringRef(sym->getName())];
-  int &idx2 = symMap[CachedHashStringRef(real->getName())];
-  int &idx3 = symMap[CachedHashStringRef(wrap->getName())];
+  CachedHashStringRef name1(sym->getName());
+  CachedHashStringRef name2(real->getName());
+  CachedHashStringRef name3(wrap->getName());
+  int &idx1 = getShard(name1)[name1];
+  int &idx2 = getShard(name2)[name2];
+  int &idx3 = getShard(name3)[name3];
 
   idx2 = idx1;
   idx1 = idx3;
@@ -60,13 +64,18 @@ Symbol *SymbolTable::insert(StringRef name) {
   if (pos != StringRef::npos && pos + 1 < name.size() && name[pos + 1] == '@')
     name = name.take_front(pos);
 
-  auto p = symMap.insert({CachedHashStringRef(name), (int)symVector.size()});
+  CachedHashStringRef key(name);
+  auto p = getShard(key).insert({key, (int)symVector.size()});
   int &symIndex = p.first->second;
   bool isNew = p.second;
 
   if (!isNew)
     return symVector[symIndex];
+  return addPlaceholder(name);
+}
 
+// Create a new symbol and append it to symVector.
+Symbol *SymbolTable::addPlaceholder(StringRef name) {
   Symbol *sym = reinterpret_cast<Symbol *>(make<SymbolUnion>());
   symVector.push_back(sym);
 
@@ -87,6 +96,105 @@ Symbol *SymbolTable::insert(StringRef name) {
   return sym;
 }
 
+template <class ELFT, class SymTy>
+static CachedHashStringRef getGlobalName(ObjFile<ELFT> *file,
+                                         const SymTy &eSym) {
+  // Strip a default version as SymbolTable::insert does.
+  StringRef name = CHECK(eSym.getName(file->getStringTable()), file);
+  size_t pos = name.find('@');
+  if (pos != StringRef::npos && pos + 1 < name.size() && name[pos + 1] == '@')
+    name = name.take_front(pos);
+  return CachedHashStringRef(name);
+}
+
+template <class ELFT>
+void SymbolTable::insertObjSymbols(ArrayRef<ObjFile<ELFT> *> files) {
+  // For each global symbol of each file, its name hash, and then its index
+  // in symVector (if >= 0) or -1 minus its index in the shard's list of
+  // new symbols.
+  struct FileSyms {
+    std::vector<unsigned> hashes;
+    std::vector<int> refs;
+  };
+  std::vector<FileSyms> fileSyms(files.size());
+
+  parallelForEachN(0, files.size(), [&](size_t i) {
+    auto eSyms = files[i]->template getELFSyms<ELFT>();
+    FileSyms &fs = fileSyms[i];
+    fs.hashes.resize(eSyms.size());
+    fs.refs.resize(eSyms.size());
+    for (size_t j = 0, e = eSyms.size(); j != e; ++j)
+      if (eSyms[j].getBinding() != STB_LOCAL)
+        fs.hashes[j] = getGlobalName(files[i], eSyms[j]).hash();
+  });
+
+  // Each shard visits all files in order and records the first occurrence
+  // of each name that is new to the symbol table.
+  struct NewSym {
+    CachedHashStringRef name;
+    uint32_t fileIdx;
+    uint32_t symIdx;
+  };
+  constexpr size_t numShards = 1 << numShardBits;
+  std::vector<NewSym> newSyms[numShards];
+
+  parallelForEachN(0, numShards, [&](size_t shardIdx) {
+    DenseMap<CachedHashStringRef, int> &shard = symMap[shardIdx];
+    for (size_t i = 0, e = files.size(); i != e; ++i) {
+      auto eSyms = files[i]->template getELFSyms<ELFT>();
+      FileSyms &fs = fileSyms[i];
+      for (size_t j = 0, f = eSyms.size(); j != f; ++j) {
+        if (eSyms[j].getBinding() == STB_LOCAL ||
+            getShardIndex(fs.hashes[j]) != shardIdx)
+          continue;
+        CachedHashStringRef name = getGlobalName(files[i], eSyms[j]);
+        auto p = shard.insert({name, -1 - (int)newSyms[shardIdx].size()});
+        if (p.second)
+          newSyms[shardIdx].push_back({name, (uint32_t)i, (uint32_t)j});
+        fs.refs[j] = p.first->second;
+      }
+    }
+  });
+
+  // Create the new symbols in order of first occurrence.
+  std::vector<int> newIndices[numShards];
+  std::vector<std::pair<const NewSym *, int *>> order;
+  for (size_t shardIdx = 0; shardIdx != numShards; ++shardIdx) {
+    newIndices[shardIdx].resize(newSyms[shardIdx].size());
+    for (size_t k = 0, e = newSyms[shardIdx].size(); k != e; ++k)
+      order.push_back({&newSyms[shardIdx][k], &newIndices[shardIdx][k]});
+  }
+  parallelSort(order, [](const std::pair<const NewSym *, int *> &a,
+                         const std::pair<const NewSym *, int *> &b) {
+    return std::make_pair(a.first->fileIdx, a.first->symIdx) <
+           std::make_pair(b.first->fileIdx, b.first->symIdx);
+  });
+  for (const std::pair<const NewSym *, int *> &p : order) {
+    *p.second = symVector.size();
+    addPlaceholder(p.first->name.val());
+  }
+
+  parallelForEachN(0, numShards, [&](size_t shardIdx) {
+    for (size_t k = 0, e = newSyms[shardIdx].size(); k != e; ++k)
+      symMap[shardIdx].find(newSyms[shardIdx][k].name)->second =
+          newIndices[shardIdx][k];
+  });
+
+  parallelForEachN(0, files.size(), [&](size_t i) {
+    auto eSyms = files[i]->template getELFSyms<ELFT>();
+    FileSyms &fs = fileSyms[i];
+    files[i]->symbols.resize(eSyms.size());
+    for (size_t j = 0, e = eSyms.size(); j != e; ++j) {
+      if (eSyms[j].getBinding() == STB_LOCAL)
+        continue;
+      int ref = fs.refs[j];
+      if (ref < 0)
+        ref = newIndices[getShardIndex(fs.hashes[j])][-1 - ref];
+      files[i]->symbols[j] = symVector[ref];
+    }
+  });
+}
+
 Symbol *SymbolTable::addSymbol(const Symbol &newSym) {
   Symbol *sym = symtab->insert(newSym.getName());
   sym->resolve(newSym);
@@ -94,8 +202,9 @@ Symbol *SymbolTable::addSymbol(const Symbol &newSym) {
 }
 
 Symbol *SymbolTable::find(StringRef name) {
-  auto it = symMap.find(CachedHashStringRef(name));
-  if (it == symMap.end())
+  CachedHashStringRef key(name);
+  auto it = getShard(key).find(key);
+  if (it == getShard(key).end())
     return nullptr;
   Symbol *sym = symVector[it->second];
   if (sym->isPlaceholder())
@@ -265,5 +374,14 @@ void SymbolTable::scanVersionScript() {
   handleDynamicList();
 }
 
+template void
+SymbolTable::insertObjSymbols<ELF32LE>(ArrayRef<ObjFile<ELF32LE> *>);
+template void
+SymbolTable::insertObjSymbols<ELF32BE>(ArrayRef<ObjFile<ELF32BE> *>);
+template void
+SymbolTable::insertObjSymbols<ELF64LE>(ArrayRef<ObjFile<ELF64LE> *>);
+template void
+SymbolTable::insertObjSymbols<ELF64BE>(ArrayRef<ObjFile<ELF64BE> *>);
+
 } // namespace elf
 } // namespace lld
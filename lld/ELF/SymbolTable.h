@@ -47,6 +47,12 @@ public:
 
   Symbol *insert(StringRef name);
 
+  // Creates symbol table entries for the global symbols of the given object
+  // files and fills in their symbol vectors. Shards are processed in
+  // parallel, and symbols are created in the same order as if the files'
+  // symbols were inserted one file after another.
+  template <class ELFT> void insertObjSymbols(ArrayRef<ObjFile<ELFT> *> files);
+
   Symbol *addSymbol(const Symbol &newSym);
 
   void scanVersionScript();
@@ -79,9 +85,24 @@ private:
   // but a bit inefficient.
   // FIXME: Experiment with passing in a custom hashing or sorting the symbols
   // once symbol resolution is finished.
-  llvm::DenseMap<llvm::CachedHashStringRef, int> symMap;
+  //
+  // The map is split into shards by the top bits of the name hash (DenseMap
+  // uses the bottom bits) so that insertObjSymbols can update them
+  // concurrently.
+  static constexpr unsigned numShardBits = 5;
+  llvm::DenseMap<llvm::CachedHashStringRef, int> symMap[1 << numShardBits];
   std::vector<Symbol *> symVector;
 
+  static unsigned getShardIndex(unsigned hash) {
+    return hash >> (32 - numShardBits);
+  }
+  llvm::DenseMap<llvm::CachedHashStringRef, int> &
+  getShard(llvm::CachedHashStringRef name) {
+    return symMap[getShardIndex(name.hash())];
+  }
+
+  Symbol *addPlaceholder(StringRef name);
+
   // A map from demangled symbol names to their symbol objects.
   // This mapping is 1:N because two symbols with different versions
   // can have the same name. We use this map to handle "extern C++ {}"
@@ -37,6 +37,7 @@
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/TimeProfiler.h"
+#include <array>
 #include <cstdlib>
 #include <thread>
 
@@ -2728,7 +2729,8 @@ readPubNamesAndTypes(const LLDDwarfObj<ELFT> &obj,
 // Create a list of symbols from a given list of symbol names and types
 // by uniquifying them by name.
 static std::vector<GdbIndexSection::GdbSymbol>
-createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
+createSymbols(MutableArrayRef<std::vector<GdbIndexSection::NameAttrEntry>>
+                  nameAttrs,
               const std::vector<GdbIndexSection::GdbChunk> &chunks) {
   using GdbSymbol = GdbIndexSection::GdbSymbol;
   using NameAttrEntry = GdbIndexSection::NameAttrEntry;
@@ -2743,44 +2745,98 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
 
   // The number of symbols we will handle in this function is of the order
   // of millions for very large executables, so we use multi-threading to
-  // speed it up.
-  size_t numShards = 32;
-  size_t concurrency = 1;
-  if (threadsEnabled)
-    concurrency =
-        std::min<size_t>(PowerOf2Floor(hardware_concurrency()), numShards);
-
-  // A sharded map to uniquify symbols by name.
-  std::vector<DenseMap<CachedHashStringRef, size_t>> map(numShards);
+  // speed it up. Names are distributed to shards by hash value, and each
+  // shard is uniquified independently.
+  const size_t numShards = 32;
   size_t shift = 32 - countTrailingZeros(numShards);
 
-  // Instantiate GdbSymbols while uniqufying them by name.
-  std::vector<std::vector<GdbSymbol>> symbols(numShards);
-  parallelForEachN(0, concurrency, [&](size_t threadId) {
-    uint32_t i = 0;
-    for (ArrayRef<NameAttrEntry> entries : nameAttrs) {
-      for (const NameAttrEntry &ent : entries) {
-        size_t shardId = ent.name.hash() >> shift;
-        if ((shardId & (concurrency - 1)) != threadId)
-          continue;
+  // Group each file's entries by shard with a stable sort, so that a shard
+  // only has to visit its own entries instead of scanning all of them.
+  // shardBegin[i][s] is the index of the first entry of shard s in
+  // nameAttrs[i].
+  auto getShardId = [&](const NameAttrEntry &ent) {
+    return ent.name.hash() >> shift;
+  };
+  std::vector<std::array<uint32_t, numShards + 1>> shardBegin(
+      nameAttrs.size());
+  parallelForEachN(0, nameAttrs.size(), [&](size_t i) {
+    std::vector<NameAttrEntry> &entries = nameAttrs[i];
+    llvm::stable_sort(entries,
+                      [&](const NameAttrEntry &a, const NameAttrEntry &b) {
+                        return getShardId(a) < getShardId(b);
+                      });
+    std::array<uint32_t, numShards + 1> &begin = shardBegin[i];
+    begin.fill(0);
+    for (const NameAttrEntry &ent : entries)
+      ++begin[getShardId(ent) + 1];
+    for (size_t s = 1; s <= numShards; ++s)
+      begin[s] += begin[s - 1];
+  });
 
+  // Instantiate GdbSymbols while uniqufying them by name. Within a shard,
+  // entries are visited in input order, so the output is deterministic.
+  std::vector<std::vector<GdbSymbol>> symbols(numShards);
+  parallelForEachN(0, numShards, [&](size_t shardId) {
+    DenseMap<CachedHashStringRef, size_t> map;
+    std::vector<GdbSymbol> &syms = symbols[shardId];
+    for (size_t i = 0, e = nameAttrs.size(); i != e; ++i) {
+      ArrayRef<NameAttrEntry> entries = nameAttrs[i];
+      for (uint32_t j = shardBegin[i][shardId],
+                    end = shardBegin[i][shardId + 1];
+           j != end; ++j) {
+        const NameAttrEntry &ent = entries[j];
         uint32_t v = ent.cuIndexAndAttrs + cuIdxs[i];
-        size_t &idx = map[shardId][ent.name];
+        size_t &idx = map[ent.name];
         if (idx) {
-          symbols[shardId][idx - 1].cuVector.push_back(v);
+          syms[idx - 1].cuVector.push_back(v);
           continue;
         }
 
-        idx = symbols[shardId].size() + 1;
-        symbols[shardId].push_back({ent.name, {v}, 0, 0});
+        idx = syms.size() + 1;
+        syms.push_back({ent.name, {v}, 0, 0});
       }
-      ++i;
     }
   });
 
+  // The entries are no longer needed. Release them early, as they can be
+  // fairly large in total.
+  for (std::vector<NameAttrEntry> &entries : nameAttrs)
+    std::vector<NameAttrEntry>().swap(entries);
+
+  // CU vectors and symbol names are adjacent in the output file. Compute
+  // where each shard's CU vectors and names start, so that
+  // per-symbol offsets can be assigned in parallel.
+  std::vector<size_t> cuVectorSize(numShards), nameSize(numShards);
+  parallelForEachN(0, numShards, [&](size_t shardId) {
+    for (const GdbSymbol &sym : symbols[shardId]) {
+      cuVectorSize[shardId] += (sym.cuVector.size() + 1) * 4;
+      nameSize[shardId] += sym.name.size() + 1;
+    }
+  });
+
+  std::vector<size_t> cuVectorOff(numShards), nameOff(numShards);
   size_t numSymbols = 0;
-  for (ArrayRef<GdbSymbol> v : symbols)
-    numSymbols += v.size();
+  size_t off = 0;
+  for (size_t s = 0; s != numShards; ++s) {
+    numSymbols += symbols[s].size();
+    cuVectorOff[s] = off;
+    off += cuVectorSize[s];
+  }
+  for (size_t s = 0; s != numShards; ++s) {
+    nameOff[s] = off;
+    off += nameSize[s];
+  }
+
+  parallelForEachN(0, numShards, [&](size_t shardId) {
+    size_t cuOff = cuVectorOff[shardId];
+    size_t strOff = nameOff[shardId];
+    for (GdbSymbol &sym : symbols[shardId]) {
+      sym.cuVectorOff = cuOff;
+      sym.nameOff = strOff;
+      cuOff += (sym.cuVector.size() + 1) * 4;
+      strOff += sym.name.size() + 1;
+    }
+  });
 
   // The return type is a flattened vector, so we'll copy each vector
   // contents to Ret.
@@ -2790,18 +2846,6 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
     for (GdbSymbol &sym : vec)
       ret.push_back(std::move(sym));
 
-  // CU vectors and symbol names are adjacent in the output file.
-  // We can compute their offsets in the output file now.
-  size_t off = 0;
-  for (GdbSymbol &sym : ret) {
-    sym.cuVectorOff = off;
-    off += (sym.cuVector.size() + 1) * 4;
-  }
-  for (GdbSymbol &sym : ret) {
-    sym.nameOff = off;
-    off += sym.name.size() + 1;
-  }
-
   return ret;
 }
 
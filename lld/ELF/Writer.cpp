@@ -60,6 +60,7 @@ private:
   void sortInputSections();
   void finalizeSections();
   void checkExecuteOnly();
+  void printDynamicRelocStats();
   void setReservedSymbolSections();
 
   std::vector<PhdrEntry *> createPhdrs(Partition &part);
@@ -567,6 +568,9 @@ template <class ELFT> void Writer<ELFT>::run() {
   if (errorCount())
     return;
 
+  if (config->printDynamicRelocStats)
+    printDynamicRelocStats();
+
   // If -compressed-debug-sections is specified, we need to compress
   // .debug_* sections. Do it right now because it changes the size of
   // output sections.
@@ -1724,7 +1728,9 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
   // after processSymbolAssignments() because it needs to know whether a
   // linker-script-defined symbol is absolute.
   if (!config->relocatable) {
-    forEachRelSec(scanRelocations<ELFT>);
+    std::vector<InputSectionBase *> relSecs;
+    forEachRelSec([&](InputSectionBase &sec) { relSecs.push_back(&sec); });
+    scanRelocations<ELFT>(relSecs);
     reportUndefinedSymbols<ELFT>();
   }
 
@@ -1924,6 +1930,67 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
     sec->finalize();
 }
 
+// Print the dynamic relocations of the output for --print-dynamic-reloc-stats.
+// Relative and IRELATIVE relocations can be applied without a symbol lookup,
+// so the number of lookups (and of distinct symbols looked up) is the main
+// indicator of how expensive the output is for the dynamic loader. Relative
+// relocations left in .rela.dyn are also reported if they could be packed
+// with --pack-dyn-relocs=relr.
+template <class ELFT> void Writer<ELFT>::printDynamicRelocStats() {
+  std::string str;
+  raw_string_ostream os(str);
+  size_t lookups = 0, lazyLookups = 0, packable = 0;
+  DenseSet<const Symbol *> lookedUp;
+
+  auto print = [&](RelocationBaseSection *sec, bool lazy) {
+    if (!sec || !sec->isNeeded() || !sec->getParent())
+      return;
+    os << sec->name << ": " << sec->relocs.size() << " relocations, "
+       << sec->getSize() << " bytes\n";
+
+    MapVector<RelType, size_t> counts;
+    for (const DynamicReloc &rel : sec->relocs) {
+      ++counts[rel.type];
+      if (rel.type == target->relativeRel) {
+        // Same condition as addRelativeReloc: SHT_RELR cannot encode odd
+        // offsets, which are possible unless the section is 2-byte aligned.
+        if (rel.inputSec && rel.inputSec->alignment >= 2 &&
+            rel.offsetInSec % 2 == 0)
+          ++packable;
+      } else if (rel.sym && !rel.useSymVA && rel.type != target->iRelativeRel) {
+        ++(lazy ? lazyLookups : lookups);
+        lookedUp.insert(rel.sym);
+      }
+    }
+    std::vector<std::pair<RelType, size_t>> v = counts.takeVector();
+    llvm::stable_sort(v, [](const std::pair<RelType, size_t> &a,
+                            const std::pair<RelType, size_t> &b) {
+      return a.second > b.second;
+    });
+    for (const std::pair<RelType, size_t> &p : v)
+      os << "  " << toString(p.first) << ": " << p.second << "\n";
+  };
+
+  for (Partition &part : partitions) {
+    print(part.relaDyn, false);
+    if (part.relrDyn && part.relrDyn->isNeeded() && part.relrDyn->getParent())
+      os << part.relrDyn->name << ": " << part.relrDyn->relocs.size()
+         << " relative relocations, " << part.relrDyn->getSize()
+         << " bytes\n";
+  }
+  print(in.relaIplt, false);
+  print(in.relaPlt, !config->zNow);
+
+  os << "symbol lookups: " << lookups << " at load time";
+  if (lazyLookups)
+    os << ", " << lazyLookups << " lazy";
+  os << " (" << lookedUp.size() << " distinct symbols)\n";
+  if (packable && !config->relrPackDynRelocs)
+    os << "relative relocations packable with --pack-dyn-relocs=relr: "
+       << packable << "\n";
+  message(StringRef(os.str()).rtrim('\n'));
+}
+
 // Ensure data sections are not mixed with executable sections when
 // -execute-only is used. -execute-only is a feature to make pages executable
 // but not readable, and the feature is currently supported only on AArch64.
@@ -2631,6 +2698,15 @@ template <class ELFT> void Writer<ELFT>::writeTrapInstr() {
   }
 }
 
+// With --release-output-pages, tell the output buffer that the given file
+// range is complete so that its pages need not stay resident until commit.
+// This is only a hint: if the range is touched again (e.g. to compute a
+// build-id), the pages are faulted back in with their contents intact.
+static void releaseOutputPages(uint64_t offset, uint64_t size) {
+  if (config->releaseOutputPages && size)
+    errorHandler().outputBuffer->releasePages(offset, size);
+}
+
 // Write section contents to a mmap'ed file.
 template <class ELFT> void Writer<ELFT>::writeSections() {
   // In -r or -emit-relocs mode, write the relocation sections first as in
@@ -2640,9 +2716,13 @@ template <class ELFT> void Writer<ELFT>::writeSections() {
     if (sec->type == SHT_REL || sec->type == SHT_RELA)
       sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
 
-  for (OutputSection *sec : outputSections)
-    if (sec->type != SHT_REL && sec->type != SHT_RELA)
+  for (OutputSection *sec : outputSections) {
+    if (sec->type != SHT_REL && sec->type != SHT_RELA) {
       sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+      if (sec->type != SHT_NOBITS)
+        releaseOutputPages(sec->offset, sec->size);
+    }
+  }
 }
 
 // Split one uint8 array into small pieces of uint8 arrays.
@@ -2672,6 +2752,7 @@ computeHash(llvm::MutableArrayRef<uint8_t> hashBuf,
   // Compute hash values.
   parallelForEachN(0, chunks.size(), [&](size_t i) {
     hashFn(hashes.data() + i * hashBuf.size(), chunks[i]);
+    releaseOutputPages(chunks[i].data() - Out::bufferStart, chunks[i].size());
   });
 
   // Write to the final output buffer.
@@ -2696,7 +2777,7 @@ template <class ELFT> void Writer<ELFT>::writeBuildId() {
   switch (config->buildId) {
   case BuildIdKind::Fast:
     computeHash(buildId, buf, [](uint8_t *dest, ArrayRef<uint8_t> arr) {
-      write64le(dest, xxHash64(arr));
+      write64le(dest, xxh3_64bits(arr));
     });
     break;
   case BuildIdKind::Md5:
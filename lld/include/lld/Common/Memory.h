@@ -36,7 +36,7 @@ void freeArena();
 // These two classes are hack to keep track of all
 // SpecificBumpPtrAllocator instances.
 struct SpecificAllocBase {
-  SpecificAllocBase() { instances.push_back(this); }
+  SpecificAllocBase();
   virtual ~SpecificAllocBase() = default;
   virtual void reset() = 0;
   static std::vector<SpecificAllocBase *> instances;
@@ -49,9 +49,12 @@ template <class T> struct SpecificAlloc : public SpecificAllocBase {
 
 // Use this arena if your object has a destructor.
 // Your destructor will be invoked from freeArena().
+// Each thread allocates from its own arena, so make() can be called from
+// parallel code without locking. The arenas live until the process exits;
+// freeArena() destroys the objects of all of them.
 template <typename T, typename... U> T *make(U &&... args) {
-  static SpecificAlloc<T> alloc;
-  return new (alloc.alloc.Allocate()) T(std::forward<U>(args)...);
+  static thread_local SpecificAlloc<T> *alloc = new SpecificAlloc<T>();
+  return new (alloc->alloc.Allocate()) T(std::forward<U>(args)...);
 }
 
 } // namespace lld
@@ -0,0 +1,90 @@
+//===- CompressDebugSectionsTest.cpp --------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ELFLinkTest.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Object/Decompressor.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/Compression.h"
+
+using namespace llvm;
+using namespace lld;
+
+namespace {
+
+// Returns an object with a .debug_info section holding \p contents.
+std::string getDebugInfoYAML(StringRef contents) {
+  return R"(
+--- !ELF
+FileHeader:
+  Class:   ELFCLASS64
+  Data:    ELFDATA2LSB
+  Type:    ET_REL
+  Machine: EM_X86_64
+Sections:
+  - Name:    .debug_info
+    Type:    SHT_PROGBITS
+    Content: )" +
+         toHex(contents) + "\n";
+}
+
+class CompressDebugSectionsTest : public ELFLinkTest {
+protected:
+  // Links an object whose .debug_info holds \p contents with
+  // --compress-debug-sections=zlib and checks that the section decompresses
+  // back to \p contents.
+  void checkRoundTrip(StringRef contents) {
+    std::string obj = writeObject(getDebugInfoYAML(contents));
+    std::unique_ptr<MemoryBuffer> out =
+        link({"--compress-debug-sections=zlib", obj.c_str()});
+    ASSERT_TRUE(out);
+
+    Expected<std::unique_ptr<object::ObjectFile>> fileOrErr =
+        object::ObjectFile::createObjectFile(out->getMemBufferRef());
+    ASSERT_TRUE(!!fileOrErr) << toString(fileOrErr.takeError());
+
+    for (const object::SectionRef &sec : (*fileOrErr)->sections()) {
+      Expected<StringRef> name = sec.getName();
+      ASSERT_TRUE(!!name) << toString(name.takeError());
+      if (*name != ".debug_info")
+        continue;
+
+      EXPECT_TRUE(object::Decompressor::isCompressed(sec));
+      Expected<StringRef> data = sec.getContents();
+      ASSERT_TRUE(!!data) << toString(data.takeError());
+      Expected<object::Decompressor> dec = object::Decompressor::create(
+          *name, *data, /*IsLE=*/true, /*Is64Bit=*/true);
+      ASSERT_TRUE(!!dec) << toString(dec.takeError());
+      SmallString<0> uncompressed;
+      Error e = dec->resizeAndDecompress(uncompressed);
+      ASSERT_FALSE(e) << toString(std::move(e));
+      EXPECT_EQ(uncompressed.str(), contents);
+      return;
+    }
+    ADD_FAILURE() << ".debug_info not found in the output";
+  }
+};
+
+TEST_F(CompressDebugSectionsTest, SingleShard) {
+  if (!zlib::isAvailable())
+    return;
+  checkRoundTrip("the quick brown fox jumps over the lazy dog");
+}
+
+TEST_F(CompressDebugSectionsTest, MultipleShards) {
+  if (!zlib::isAvailable())
+    return;
+  // Large enough to be split into several shards, the last one partial.
+  std::string contents;
+  contents.reserve(5 << 19);
+  for (size_t i = 0; i != 5 << 19; ++i)
+    contents += 'a' + (i * i) % 26;
+  checkRoundTrip(contents);
+}
+
+} // namespace
@@ -0,0 +1,94 @@
+//===- DynamicRelocStatsTest.cpp ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ELFLinkTest.h"
+#include "gmock/gmock.h"
+
+using namespace llvm;
+using namespace lld;
+using testing::HasSubstr;
+using testing::Not;
+
+namespace {
+
+// Two absolute relocations in a byte-aligned section, one of them at an odd
+// offset, and two in a word-aligned section. All of them become relative
+// relocations in a shared object, but only the word-aligned ones can be
+// packed with SHT_RELR.
+const char *misalignedYAML = R"(
+--- !ELF
+FileHeader:
+  Class:   ELFCLASS64
+  Data:    ELFDATA2LSB
+  Type:    ET_REL
+  Machine: EM_X86_64
+Sections:
+  - Name:         .data.aligned
+    Type:         SHT_PROGBITS
+    Flags:        [ SHF_ALLOC, SHF_WRITE ]
+    AddressAlign: 8
+    Content:      "00000000000000000000000000000000"
+  - Name:         .rela.data.aligned
+    Type:         SHT_RELA
+    Info:         .data.aligned
+    Relocations:
+      - Offset: 0
+        Symbol: target
+        Type:   R_X86_64_64
+      - Offset: 8
+        Symbol: target
+        Type:   R_X86_64_64
+  - Name:         .data.unaligned
+    Type:         SHT_PROGBITS
+    Flags:        [ SHF_ALLOC, SHF_WRITE ]
+    AddressAlign: 1
+    Content:      "0000000000000000000000000000000000"
+  - Name:         .rela.data.unaligned
+    Type:         SHT_RELA
+    Info:         .data.unaligned
+    Relocations:
+      - Offset: 0
+        Symbol: target
+        Type:   R_X86_64_64
+      - Offset: 9
+        Symbol: target
+        Type:   R_X86_64_64
+Symbols:
+  - Name:    target
+    Section: .data.aligned
+)";
+
+class DynamicRelocStatsTest : public ELFLinkTest {};
+
+TEST_F(DynamicRelocStatsTest, MisalignedRelocationsAreNotPackable) {
+  std::string obj = writeObject(misalignedYAML);
+  ASSERT_TRUE(
+      link({"-shared", "--print-dynamic-reloc-stats", obj.c_str()}));
+  EXPECT_THAT(linkMessages, HasSubstr(".rela.dyn: 4 relocations, 96 bytes\n"
+                                      "  R_X86_64_RELATIVE: 4\n"));
+  EXPECT_THAT(linkMessages,
+              HasSubstr("symbol lookups: 0 at load time (0 distinct "
+                        "symbols)\n"));
+  EXPECT_THAT(linkMessages,
+              HasSubstr("relative relocations packable with "
+                        "--pack-dyn-relocs=relr: 2"));
+}
+
+TEST_F(DynamicRelocStatsTest, PackedRelocations) {
+  // The estimate above matches what --pack-dyn-relocs=relr does.
+  std::string obj = writeObject(misalignedYAML);
+  ASSERT_TRUE(link({"-shared", "--pack-dyn-relocs=relr",
+                    "--print-dynamic-reloc-stats", obj.c_str()}));
+  EXPECT_THAT(linkMessages, HasSubstr(".rela.dyn: 2 relocations, 48 bytes\n"
+                                      "  R_X86_64_RELATIVE: 2\n"));
+  EXPECT_THAT(linkMessages,
+              HasSubstr(".relr.dyn: 2 relative relocations, 16 bytes\n"));
+  EXPECT_THAT(linkMessages, Not(HasSubstr("packable")));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,93 @@
+//===- ELFLinkTest.h - Fixture for ELF linker unit tests --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_UNITTESTS_ELFTESTS_ELFLINKTEST_H
+#define LLD_UNITTESTS_ELFTESTS_ELFLINKTEST_H
+
+#include "lld/Common/Driver.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ObjectYAML/yaml2obj.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "gtest/gtest.h"
+
+namespace lld {
+
+// Runs the ELF linker in-process on objects described in YAML.
+class ELFLinkTest : public testing::Test {
+protected:
+  void TearDown() override {
+    for (const std::string &path : tempFiles)
+      llvm::sys::fs::remove(path);
+  }
+
+  // Returns the path of a new temporary file with the given suffix.
+  std::string createTempFile(llvm::StringRef suffix) {
+    llvm::SmallString<128> path;
+    std::error_code ec =
+        llvm::sys::fs::createTemporaryFile("lld-elf-test", suffix, path);
+    EXPECT_FALSE(ec) << ec.message();
+    tempFiles.push_back(path.str().str());
+    return tempFiles.back();
+  }
+
+  // Writes the object described by \p yaml to \p path, or to a new temporary
+  // file if it is empty, and returns its path.
+  std::string writeObject(llvm::StringRef yaml, std::string path = "") {
+    if (path.empty())
+      path = createTempFile("o");
+    std::error_code ec;
+    llvm::raw_fd_ostream os(path, ec);
+    EXPECT_FALSE(ec) << ec.message();
+    std::string errors;
+    llvm::yaml::Input yin(yaml);
+    EXPECT_TRUE(llvm::yaml::convertYAML(
+        yin, os, [&](const llvm::Twine &msg) { errors += msg.str(); }))
+        << errors;
+    return path;
+  }
+
+  // Links with \p args into \p output, or into a new temporary file if it is
+  // empty, and returns the output file, or null if the link failed. The
+  // messages printed by the linker to stdout and stderr are kept in
+  // linkMessages and linkErrors.
+  std::unique_ptr<llvm::MemoryBuffer> link(std::vector<const char *> args,
+                                           std::string output = "") {
+    if (output.empty())
+      output = createTempFile("out");
+    args.insert(args.begin(), "ld.lld");
+    args.push_back("-o");
+    args.push_back(output.c_str());
+
+    linkMessages.clear();
+    linkErrors.clear();
+    llvm::raw_string_ostream outOS(linkMessages);
+    llvm::raw_string_ostream errOS(linkErrors);
+    bool ok = elf::link(args, /*canExitEarly=*/false, outOS, errOS);
+    outOS.flush();
+    errOS.flush();
+    EXPECT_TRUE(ok) << linkErrors;
+    if (!ok)
+      return nullptr;
+
+    auto mbOrErr = llvm::MemoryBuffer::getFile(output);
+    EXPECT_TRUE(!!mbOrErr) << mbOrErr.getError().message();
+    if (!mbOrErr)
+      return nullptr;
+    return std::move(*mbOrErr);
+  }
+
+  std::vector<std::string> tempFiles;
+  std::string linkMessages;
+  std::string linkErrors;
+};
+
+} // namespace lld
+
+#endif
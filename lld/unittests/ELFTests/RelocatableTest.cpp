@@ -0,0 +1,102 @@
+//===- RelocatableTest.cpp ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ELFLinkTest.h"
+#include "llvm/Object/ELFObjectFile.h"
+
+using namespace llvm;
+using namespace lld;
+
+namespace {
+
+// Returns an object with a COMDAT group named \p signature holding a single
+// section \p member.
+std::string getGroupYAML(StringRef signature, StringRef member,
+                         StringRef groupFlags) {
+  return (R"(
+--- !ELF
+FileHeader:
+  Class:   ELFCLASS64
+  Data:    ELFDATA2LSB
+  Type:    ET_REL
+  Machine: EM_X86_64
+Sections:
+  - Name:    .group
+    Type:    SHT_GROUP
+    Flags:   [ )" + groupFlags + R"( ]
+    Link:    .symtab
+    Info:    )" + signature + R"(
+    Members:
+      - SectionOrType: GRP_COMDAT
+      - SectionOrType: )" + member + R"(
+  - Name:    )" + member + R"(
+    Type:    SHT_PROGBITS
+    Flags:   [ SHF_ALLOC, SHF_EXECINSTR, SHF_GROUP ]
+    Content: C3
+Symbols:
+  - Name:    )" + signature + R"(
+    Section: )" + member + R"(
+    Binding: STB_WEAK
+)")
+      .str();
+}
+
+class RelocatableTest : public ELFLinkTest {
+protected:
+  // Returns the names of the sections of \p buf, with the names of SHT_GROUP
+  // sections replaced by "<group>".
+  std::vector<std::string> getSections(const MemoryBuffer &buf) {
+    std::vector<std::string> names;
+    Expected<std::unique_ptr<object::ObjectFile>> fileOrErr =
+        object::ObjectFile::createObjectFile(buf.getMemBufferRef());
+    EXPECT_TRUE(!!fileOrErr) << toString(fileOrErr.takeError());
+    if (!fileOrErr)
+      return names;
+    for (object::ELFSectionRef sec : (*fileOrErr)->sections()) {
+      Expected<StringRef> name = sec.getName();
+      EXPECT_TRUE(!!name) << toString(name.takeError());
+      if (!name)
+        continue;
+      names.push_back(sec.getType() == ELF::SHT_GROUP ? "<group>"
+                                                      : name->str());
+    }
+    return names;
+  }
+};
+
+TEST_F(RelocatableTest, ExcludedGroupsAreDeduplicated) {
+  // Excluded groups are left for the final link to discard, but -r still
+  // keeps only the first group with a given signature.
+  std::string foo1 =
+      writeObject(getGroupYAML("foo", ".text.foo", "SHF_EXCLUDE"));
+  std::string foo2 =
+      writeObject(getGroupYAML("foo", ".text.foo", "SHF_EXCLUDE"));
+  std::string bar =
+      writeObject(getGroupYAML("bar", ".text.bar", "SHF_EXCLUDE"));
+  std::unique_ptr<MemoryBuffer> out =
+      link({"-r", foo1.c_str(), foo2.c_str(), bar.c_str()});
+  ASSERT_TRUE(out);
+
+  std::vector<std::string> sections = getSections(*out);
+  EXPECT_EQ(llvm::count(sections, "<group>"), 2);
+  EXPECT_EQ(llvm::count(sections, ".text.foo"), 1);
+  EXPECT_EQ(llvm::count(sections, ".text.bar"), 1);
+}
+
+TEST_F(RelocatableTest, GroupsAreDeduplicated) {
+  std::string foo1 = writeObject(getGroupYAML("foo", ".text.foo", ""));
+  std::string foo2 = writeObject(getGroupYAML("foo", ".text.foo", ""));
+  std::unique_ptr<MemoryBuffer> out = link({"-r", foo1.c_str(), foo2.c_str()});
+  ASSERT_TRUE(out);
+
+  std::vector<std::string> sections = getSections(*out);
+  EXPECT_EQ(llvm::count(sections, "<group>"), 1);
+  EXPECT_EQ(llvm::count(sections, ".text.foo"), 1);
+}
+
+} // namespace
@@ -0,0 +1,86 @@
+//===- SkipIfUnchangedTest.cpp --------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "ELFLinkTest.h"
+#include "gmock/gmock.h"
+
+using namespace llvm;
+using namespace lld;
+using testing::HasSubstr;
+using testing::Not;
+
+namespace {
+
+// An object file whose .data section holds \p content.
+std::string getDataYAML(StringRef content) {
+  return (R"(
+--- !ELF
+FileHeader:
+  Class:   ELFCLASS64
+  Data:    ELFDATA2LSB
+  Type:    ET_REL
+  Machine: EM_X86_64
+Sections:
+  - Name:    .data
+    Type:    SHT_PROGBITS
+    Flags:   [ SHF_ALLOC, SHF_WRITE ]
+    Content: ")" + content + R"("
+)")
+      .str();
+}
+
+class SkipIfUnchangedTest : public ELFLinkTest {
+protected:
+  // Links obj into out with --skip-if-unchanged and returns whether the link
+  // was skipped.
+  bool linkIsSkipped() {
+    std::string arg = "--skip-if-unchanged=" + state;
+    EXPECT_TRUE(link({"--verbose", arg.c_str(), obj.c_str()}, out));
+    return StringRef(linkErrors).contains("is up to date");
+  }
+
+  void SetUp() override {
+    obj = writeObject(getDataYAML("01020304"));
+    out = createTempFile("out");
+    state = createTempFile("state");
+    sys::fs::remove(state);
+  }
+
+  std::string obj;
+  std::string out;
+  std::string state;
+};
+
+TEST_F(SkipIfUnchangedTest, UnchangedInputs) {
+  EXPECT_FALSE(linkIsSkipped());
+  EXPECT_TRUE(sys::fs::exists(state));
+  EXPECT_TRUE(linkIsSkipped());
+  EXPECT_TRUE(linkIsSkipped());
+}
+
+TEST_F(SkipIfUnchangedTest, ChangedInput) {
+  EXPECT_FALSE(linkIsSkipped());
+  writeObject(getDataYAML("05060708"), obj);
+  EXPECT_FALSE(linkIsSkipped());
+  EXPECT_TRUE(linkIsSkipped());
+}
+
+TEST_F(SkipIfUnchangedTest, ChangedCommandLine) {
+  EXPECT_FALSE(linkIsSkipped());
+  std::string arg = "--skip-if-unchanged=" + state;
+  EXPECT_TRUE(link({"--verbose", "--build-id", arg.c_str(), obj.c_str()}, out));
+  EXPECT_THAT(linkErrors, Not(HasSubstr("is up to date")));
+}
+
+TEST_F(SkipIfUnchangedTest, ChangedOutput) {
+  EXPECT_FALSE(linkIsSkipped());
+  sys::fs::remove(out);
+  EXPECT_FALSE(linkIsSkipped());
+}
+
+} // end anonymous namespace
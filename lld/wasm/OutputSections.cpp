@@ -86,9 +86,13 @@ void CodeSection::finalizeContents() {
   os.flush();
   bodySize = codeSectionHeader.size();
 
+  // Computing the compressed sizes has to evaluate every relocation, but the
+  // functions don't depend on each other's sizes.
+  parallelForEach(functions,
+                  [](InputFunction *func) { func->calculateSize(); });
+
   for (InputFunction *func : functions) {
     func->outputOffset = bodySize;
-    func->calculateSize();
     bodySize += func->getSize();
   }
 
@@ -110,8 +114,8 @@ void CodeSection::writeTo(uint8_t *buf) {
   memcpy(buf, codeSectionHeader.data(), codeSectionHeader.size());
 
   // Write code section bodies
-  for (const InputChunk *chunk : functions)
-    chunk->writeTo(buf);
+  parallelForEach(functions,
+                  [&](const InputChunk *chunk) { chunk->writeTo(buf); });
 }
 
 uint32_t CodeSection::getNumRelocations() const {
@@ -193,8 +197,8 @@ void DataSection::writeTo(uint8_t *buf) {
     memcpy(segStart, segment->header.data(), segment->header.size());
 
     // Write segment data payload
-    for (const InputChunk *chunk : segment->inputSegments)
-      chunk->writeTo(buf);
+    parallelForEach(segment->inputSegments,
+                    [&](const InputChunk *chunk) { chunk->writeTo(buf); });
   }
 }
 
@@ -248,8 +252,8 @@ void CustomSection::writeTo(uint8_t *buf) {
   buf += nameData.size();
 
   // Write custom sections payload
-  for (const InputSection *section : inputSections)
-    section->writeTo(buf);
+  parallelForEach(inputSections,
+                  [&](const InputSection *section) { section->writeTo(buf); });
 }
 
 uint32_t CustomSection::getNumRelocations() const {
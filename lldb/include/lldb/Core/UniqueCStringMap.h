@@ -14,6 +14,7 @@
 
 #include "lldb/Utility/ConstString.h"
 #include "lldb/Utility/RegularExpression.h"
+#include "llvm/Support/Parallel.h"
 
 namespace lldb_private {
 
@@ -161,7 +162,13 @@ public:
   //      my_map.Append (UniqueCStringMap::Entry(GetName(...), GetValue(...)));
   // }
   // my_map.Sort();
-  void Sort() { llvm::sort(m_map.begin(), m_map.end(), Compare()); }
+  //
+  // Large maps are sorted in parallel, unless another llvm::parallel
+  // algorithm is already running, in which case this sorts serially.
+  void Sort() {
+    llvm::parallel::sort(llvm::parallel::par, m_map.begin(), m_map.end(),
+                         Compare());
+  }
 
   // Since we are using a vector to contain our items it will always double its
   // memory consumption as things are added to the vector, so if you intend to
@@ -177,22 +184,22 @@ public:
 
 protected:
   struct Compare {
-    bool operator()(const Entry &lhs, const Entry &rhs) {
+    bool operator()(const Entry &lhs, const Entry &rhs) const {
       return operator()(lhs.cstring, rhs.cstring);
     }
 
-    bool operator()(const Entry &lhs, ConstString rhs) {
+    bool operator()(const Entry &lhs, ConstString rhs) const {
       return operator()(lhs.cstring, rhs);
     }
 
-    bool operator()(ConstString lhs, const Entry &rhs) {
+    bool operator()(ConstString lhs, const Entry &rhs) const {
       return operator()(lhs, rhs.cstring);
     }
 
     // This is only for uniqueness, not lexicographical ordering, so we can
     // just compare pointers. *However*, comparing pointers from different
     // allocations is UB, so we need compare their integral values instead.
-    bool operator()(ConstString lhs, ConstString rhs) {
+    bool operator()(ConstString lhs, ConstString rhs) const {
       return uintptr_t(lhs.GetCString()) < uintptr_t(rhs.GetCString());
     }
   };
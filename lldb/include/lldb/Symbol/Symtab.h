@@ -215,10 +215,19 @@ private:
   void SymbolIndicesToSymbolContextList(std::vector<uint32_t> &symbol_indexes,
                                         SymbolContextList &sc_list);
 
+  /// The pieces of a demangled function name that the name indexes need.
+  struct MangledNameParts {
+    ConstString base_name;
+    ConstString decl_context;
+    bool is_ctor_or_dtor = false;
+  };
+
+  static MangledNameParts GetMangledNameParts(RichManglingContext &rmc);
+
   void RegisterMangledNameEntry(
-      uint32_t value, std::set<const char *> &class_contexts,
-      std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog,
-      RichManglingContext &rmc);
+      uint32_t value, const MangledNameParts &parts,
+      std::set<const char *> &class_contexts,
+      std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog);
 
   void RegisterBacklogEntry(const NameToIndexMap::Entry &entry,
                             const char *decl_context,
@@ -437,6 +437,21 @@ public:
   ///     in memory.
   static size_t StaticMemorySize();
 
+  struct MemoryStats {
+    size_t GetBytesTotal() const { return bytes_total; }
+    size_t GetBytesUsed() const { return bytes_used; }
+    size_t GetBytesUnused() const { return bytes_total - bytes_used; }
+    size_t bytes_total = 0;
+    size_t bytes_used = 0;
+  };
+
+  /// Get the memory usage of the global string pool's allocators.
+  ///
+  /// \return
+  ///     The number of bytes the string pool has allocated from the system
+  ///     and, of those, the number of bytes that hold string pool entries.
+  static MemoryStats GetMemoryStats();
+
 protected:
   template <typename T> friend struct ::llvm::DenseMapInfo;
   /// Only used by DenseMapInfo.
@@ -85,6 +85,12 @@ protected:
           stat);
       i += 1;
     }
+    ConstString::MemoryStats string_stats = ConstString::GetMemoryStats();
+    result.AppendMessageWithFormat(
+        "String pool memory : %" PRIu64 " bytes used, %" PRIu64
+        " bytes allocated\n",
+        (uint64_t)string_stats.GetBytesUsed(),
+        (uint64_t)string_stats.GetBytesTotal());
     result.SetStatus(eReturnStatusSuccessFinishResult);
     return true;
   }
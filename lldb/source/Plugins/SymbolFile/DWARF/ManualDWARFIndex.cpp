@@ -70,21 +70,32 @@ void ManualDWARFIndex::Index() {
 
   TaskMapOverInt(0, units_to_index.size(), parser_fn);
 
-  auto finalize_fn = [this, &sets](NameToDIE(IndexSet::*index)) {
+  NameToDIE IndexSet::*const indexes[] = {
+      &IndexSet::function_basenames,   &IndexSet::function_fullnames,
+      &IndexSet::function_methods,     &IndexSet::function_selectors,
+      &IndexSet::objc_class_selectors, &IndexSet::globals,
+      &IndexSet::types,                &IndexSet::namespaces};
+
+  auto merge_fn = [this, &sets, &indexes](size_t index_idx) {
+    NameToDIE IndexSet::*index = indexes[index_idx];
     NameToDIE &result = m_set.*index;
+    // Size the result up front so appending doesn't keep regrowing it and
+    // Finalize doesn't have to copy it to shrink it.
+    size_t num_entries = 0;
+    for (auto &set : sets)
+      num_entries += (set.*index).GetSize();
+    result.Reserve(num_entries);
     for (auto &set : sets)
       result.Append(set.*index);
-    result.Finalize();
   };
 
-  TaskPool::RunTasks([&]() { finalize_fn(&IndexSet::function_basenames); },
-                     [&]() { finalize_fn(&IndexSet::function_fullnames); },
-                     [&]() { finalize_fn(&IndexSet::function_methods); },
-                     [&]() { finalize_fn(&IndexSet::function_selectors); },
-                     [&]() { finalize_fn(&IndexSet::objc_class_selectors); },
-                     [&]() { finalize_fn(&IndexSet::globals); },
-                     [&]() { finalize_fn(&IndexSet::types); },
-                     [&]() { finalize_fn(&IndexSet::namespaces); });
+  TaskMapOverInt(0, llvm::array_lengthof(indexes), merge_fn);
+
+  // Sort the merged maps one at a time. llvm::parallel only runs one sort in
+  // parallel at a time and does the others serially, so sorting each map on
+  // all threads beats sorting all of them at once.
+  for (NameToDIE IndexSet::*index : indexes)
+    (m_set.*index).Finalize();
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, IndexSet &set) {
@@ -30,6 +30,10 @@ public:
 
   void Append(const NameToDIE &other);
 
+  size_t GetSize() const { return m_map.GetSize(); }
+
+  void Reserve(size_t n) { m_map.Reserve(n); }
+
   void Finalize();
 
   size_t Find(lldb_private::ConstString name,
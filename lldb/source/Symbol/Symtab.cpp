@@ -14,6 +14,7 @@
 #include "lldb/Core/Module.h"
 #include "lldb/Core/RichManglingContext.h"
 #include "lldb/Core/Section.h"
+#include "lldb/Host/TaskPool.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Symbol/Symbol.h"
 #include "lldb/Symbol/SymbolContext.h"
@@ -263,9 +264,37 @@ void Symtab::InitNameIndexes() {
     std::vector<std::pair<NameToIndexMap::Entry, const char *>> backlog;
     backlog.reserve(num_symbols / 2);
 
-    // Instantiation of the demangler is expensive, so better use a single one
-    // for all entries during batch processing.
-    RichManglingContext rmc;
+    // Demangling dominates the cost of building the indexes and only depends
+    // on each symbol itself, so do it up front in parallel batches. The
+    // registration below stays serial, because how methods are classified
+    // depends on the class contexts seen so far.
+    std::vector<MangledNameParts> name_parts(num_symbols);
+    const size_t batch_size = 1024;
+    const size_t num_batches = (num_symbols + batch_size - 1) / batch_size;
+    TaskMapOverInt(0, num_batches, [&](size_t batch) {
+      // Instantiation of the demangler is expensive, so better use a single
+      // one for all entries of a batch.
+      RichManglingContext rmc;
+      const size_t end = std::min(num_symbols, (batch + 1) * batch_size);
+      for (size_t value = batch * batch_size; value < end; ++value) {
+        Symbol &symbol = m_symbols[value];
+        if (symbol.IsTrampoline())
+          continue;
+        Mangled &mangled = symbol.GetMangled();
+        if (!mangled.GetMangledName())
+          continue;
+
+        const SymbolType type = symbol.GetType();
+        if (type == eSymbolTypeCode || type == eSymbolTypeResolver) {
+          if (mangled.DemangleWithRichManglingInfo(rmc, lldb_skip_name))
+            name_parts[value] = GetMangledNameParts(rmc);
+        }
+        // Also cache the demangled name, which the serial pass reads for
+        // every symbol.
+        mangled.GetDemangledName();
+      }
+    });
+
     for (uint32_t value = 0; value < num_symbols; ++value) {
       Symbol *symbol = &m_symbols[value];
 
@@ -290,11 +319,8 @@ void Symtab::InitNameIndexes() {
           m_name_to_index.Append(stripped, value);
         }
 
-        const SymbolType type = symbol->GetType();
-        if (type == eSymbolTypeCode || type == eSymbolTypeResolver) {
-          if (mangled.DemangleWithRichManglingInfo(rmc, lldb_skip_name))
-            RegisterMangledNameEntry(value, class_contexts, backlog, rmc);
-        }
+        RegisterMangledNameEntry(value, name_parts[value], class_contexts,
+                                 backlog);
       }
 
       // Symbol name strings that didn't match a Mangled::ManglingScheme, are
@@ -338,24 +364,34 @@ void Symtab::InitNameIndexes() {
   }
 }
 
-void Symtab::RegisterMangledNameEntry(
-    uint32_t value, std::set<const char *> &class_contexts,
-    std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog,
-    RichManglingContext &rmc) {
+Symtab::MangledNameParts
+Symtab::GetMangledNameParts(RichManglingContext &rmc) {
+  MangledNameParts parts;
   // Only register functions that have a base name.
   rmc.ParseFunctionBaseName();
   llvm::StringRef base_name = rmc.GetBufferRef();
   if (base_name.empty())
+    return parts;
+  parts.base_name = ConstString(base_name);
+
+  rmc.ParseFunctionDeclContextName();
+  parts.decl_context = ConstString(rmc.GetBufferRef());
+  parts.is_ctor_or_dtor = rmc.IsCtorOrDtor();
+  return parts;
+}
+
+void Symtab::RegisterMangledNameEntry(
+    uint32_t value, const MangledNameParts &parts,
+    std::set<const char *> &class_contexts,
+    std::vector<std::pair<NameToIndexMap::Entry, const char *>> &backlog) {
+  if (!parts.base_name)
     return;
 
   // The base name will be our entry's name.
-  NameToIndexMap::Entry entry(ConstString(base_name), value);
-
-  rmc.ParseFunctionDeclContextName();
-  llvm::StringRef decl_context = rmc.GetBufferRef();
+  NameToIndexMap::Entry entry(parts.base_name, value);
 
   // Register functions with no context.
-  if (decl_context.empty()) {
+  if (!parts.decl_context) {
     // This has to be a basename
     m_basename_to_index.Append(entry);
     // If there is no context (no namespaces or class scopes that come before
@@ -366,12 +402,12 @@ void Symtab::RegisterMangledNameEntry(
 
   // Make sure we have a pool-string pointer and see if we already know the
   // context name.
-  const char *decl_context_ccstr = ConstString(decl_context).GetCString();
+  const char *decl_context_ccstr = parts.decl_context.GetCString();
   auto it = class_contexts.find(decl_context_ccstr);
 
   // Register constructors and destructors. They are methods and create
   // declaration contexts.
-  if (rmc.IsCtorOrDtor()) {
+  if (parts.is_ctor_or_dtor) {
     m_method_to_index.Append(entry);
     if (it == class_contexts.end())
       class_contexts.insert(it, decl_context_ccstr);
@@ -137,3 +137,12 @@ TEST(ConstStringTest, CompareStringRef) {
   EXPECT_TRUE(null == static_cast<const char *>(nullptr));
   EXPECT_TRUE(null != "bar");
 }
+
+TEST(ConstStringTest, MemoryStats) {
+  ConstString::MemoryStats before = ConstString::GetMemoryStats();
+  ConstString s("MemoryStats test string that is not in the pool yet");
+  ConstString::MemoryStats after = ConstString::GetMemoryStats();
+
+  EXPECT_GT(after.GetBytesUsed(), before.GetBytesUsed());
+  EXPECT_GE(after.GetBytesTotal(), after.GetBytesUsed());
+}
@@ -0,0 +1,110 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/Twine.h"
+#include <random>
+
+using namespace llvm;
+
+// Keys shaped like the pointers most DenseMaps in the compiler are keyed on:
+// distinct, aligned, and in no particular order.
+static std::vector<uintptr_t> getPointerKeys(size_t N) {
+  std::vector<uintptr_t> Keys(N);
+  for (size_t I = 0; I != N; ++I)
+    Keys[I] = (I + 1) * 64;
+  std::shuffle(Keys.begin(), Keys.end(), std::mt19937(N));
+  return Keys;
+}
+
+static void BM_DenseMapInsert(benchmark::State &State) {
+  std::vector<uintptr_t> Keys = getPointerKeys(State.range(0));
+  for (auto _ : State) {
+    DenseMap<void *, unsigned> Map;
+    for (uintptr_t K : Keys)
+      Map[reinterpret_cast<void *>(K)] = K;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(BM_DenseMapInsert)->Range(1 << 6, 1 << 16);
+
+static void BM_DenseMapLookup(benchmark::State &State) {
+  std::vector<uintptr_t> Keys = getPointerKeys(State.range(0));
+  DenseMap<void *, unsigned> Map;
+  // Only every other key is present, so half of the lookups miss.
+  for (size_t I = 0; I < Keys.size(); I += 2)
+    Map[reinterpret_cast<void *>(Keys[I])] = I;
+  for (auto _ : State) {
+    unsigned Found = 0;
+    for (uintptr_t K : Keys)
+      Found += Map.count(reinterpret_cast<void *>(K));
+    benchmark::DoNotOptimize(Found);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(BM_DenseMapLookup)->Range(1 << 6, 1 << 16);
+
+static void BM_StringMapInsert(benchmark::State &State) {
+  std::vector<std::string> Names;
+  for (int64_t I = 0, E = State.range(0); I != E; ++I)
+    Names.push_back(("_ZN4llvm6detail" + Twine(I) + "EvalEv").str());
+  for (auto _ : State) {
+    StringMap<unsigned> Map;
+    for (const std::string &Name : Names)
+      Map.try_emplace(Name, Name.size());
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Names.size());
+}
+BENCHMARK(BM_StringMapInsert)->Range(1 << 6, 1 << 14);
+
+// Fill a SmallVector past its inline capacity, the way operand and worklist
+// vectors are built up.
+static void BM_SmallVectorPushBack(benchmark::State &State) {
+  int64_t N = State.range(0);
+  for (auto _ : State) {
+    SmallVector<unsigned, 8> Vec;
+    for (int64_t I = 0; I != N; ++I)
+      Vec.push_back(I);
+    benchmark::DoNotOptimize(Vec.data());
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_SmallVectorPushBack)->Range(4, 1 << 12);
+
+static void BM_SmallVectorCopy(benchmark::State &State) {
+  SmallVector<void *, 8> Vec(State.range(0), nullptr);
+  for (auto _ : State) {
+    SmallVector<void *, 8> Copy(Vec);
+    benchmark::DoNotOptimize(Copy.data());
+  }
+}
+BENCHMARK(BM_SmallVectorCopy)->Range(4, 1 << 12);
+
+// Multiply and divide APInts of State.range(0) bits. 64 bits and below take
+// the inline fast path; wider values go through the multi-word routines.
+static void BM_APIntMulDiv(benchmark::State &State) {
+  unsigned BitWidth = State.range(0);
+  std::mt19937_64 Rng(BitWidth);
+  SmallVector<APInt, 64> Values;
+  for (unsigned I = 0; I != 64; ++I) {
+    SmallVector<uint64_t, 4> Words;
+    for (unsigned W = 0; W != (BitWidth + 63) / 64; ++W)
+      Words.push_back(Rng() | 1);
+    Values.emplace_back(BitWidth, Words);
+  }
+  for (auto _ : State) {
+    APInt Acc(BitWidth, 1);
+    for (const APInt &V : Values) {
+      Acc *= V;
+      Acc += Acc.udiv(V.lshr(BitWidth / 2) | 1);
+    }
+    benchmark::DoNotOptimize(Acc.getRawData());
+  }
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_APIntMulDiv)->Arg(32)->Arg(64)->Arg(128)->Arg(256);
+
+BENCHMARK_MAIN();
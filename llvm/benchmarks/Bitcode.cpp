@@ -0,0 +1,54 @@
+#include "GeneratedIR.h"
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+static SmallVector<char, 0> writeGeneratedModule(unsigned NumFunctions) {
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M = generateModule(Ctx, NumFunctions, 32);
+  SmallVector<char, 0> Buffer;
+  raw_svector_ostream OS(Buffer);
+  WriteBitcodeToFile(*M, OS);
+  return Buffer;
+}
+
+// Read and materialize a bitcode file of State.range(0) functions.
+static void BM_ParseBitcode(benchmark::State &State) {
+  SmallVector<char, 0> Buffer = writeGeneratedModule(State.range(0));
+  MemoryBufferRef Ref(StringRef(Buffer.data(), Buffer.size()), "bench.bc");
+  for (auto _ : State) {
+    LLVMContext Ctx;
+    Expected<std::unique_ptr<Module>> M = parseBitcodeFile(Ref, Ctx);
+    if (!M) {
+      consumeError(M.takeError());
+      State.SkipWithError("failed to parse bitcode");
+      break;
+    }
+    benchmark::DoNotOptimize(M->get());
+  }
+  State.SetBytesProcessed(State.iterations() * Buffer.size());
+}
+BENCHMARK(BM_ParseBitcode)->Range(1, 64)->Unit(benchmark::kMillisecond);
+
+static void BM_WriteBitcode(benchmark::State &State) {
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M = generateModule(Ctx, State.range(0), 32);
+  size_t Size = 0;
+  for (auto _ : State) {
+    SmallVector<char, 0> Buffer;
+    raw_svector_ostream OS(Buffer);
+    WriteBitcodeToFile(*M, OS);
+    Size = Buffer.size();
+  }
+  State.SetBytesProcessed(State.iterations() * Size);
+}
+BENCHMARK(BM_WriteBitcode)->Range(1, 64)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+#include "GeneratedIR.h"
+#include "benchmark/benchmark.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+
+using namespace llvm;
+
+static std::unique_ptr<TargetMachine> createHostTargetMachine() {
+  if (InitializeNativeTarget() || InitializeNativeTargetAsmPrinter())
+    return nullptr;
+  std::string TT = sys::getProcessTriple();
+  std::string Error;
+  const Target *T = TargetRegistry::lookupTarget(TT, Error);
+  if (!T)
+    return nullptr;
+  return std::unique_ptr<TargetMachine>(T->createTargetMachine(
+      TT, "generic", "", TargetOptions(), None, None, CodeGenOpt::Default));
+}
+
+// Compile a generated module of State.range(0) functions to an object file
+// for the host. At this optimization level instruction selection goes
+// through SelectionDAG, which dominates the time.
+static void BM_CodeGen(benchmark::State &State) {
+  std::unique_ptr<TargetMachine> TM = createHostTargetMachine();
+  if (!TM) {
+    State.SkipWithError("no code generator for the host");
+    return;
+  }
+
+  LLVMContext Ctx;
+  unsigned NumInstructions = 0;
+  for (auto _ : State) {
+    State.PauseTiming();
+    std::unique_ptr<Module> M = generateModule(Ctx, State.range(0), 32);
+    M->setTargetTriple(TM->getTargetTriple().str());
+    M->setDataLayout(TM->createDataLayout());
+    NumInstructions = M->getInstructionCount();
+    raw_null_ostream OS;
+    legacy::PassManager PM;
+    if (TM->addPassesToEmitFile(PM, OS, nullptr, CGFT_ObjectFile)) {
+      State.SkipWithError("target cannot emit object files");
+      break;
+    }
+    State.ResumeTiming();
+
+    PM.run(*M);
+  }
+  State.SetItemsProcessed(State.iterations() * NumInstructions);
+}
+BENCHMARK(BM_CodeGen)->Range(1, 16)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+//===- GeneratedIR.cpp - Synthetic inputs for the benchmarks --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "GeneratedIR.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+
+using namespace llvm;
+
+static void generateFunction(Module &M, unsigned Idx, unsigned NumBlocks) {
+  LLVMContext &Ctx = M.getContext();
+  Type *I32 = Type::getInt32Ty(Ctx);
+  Type *I64 = Type::getInt64Ty(Ctx);
+  FunctionType *FTy =
+      FunctionType::get(I32, {I32->getPointerTo(), I64}, /*isVarArg=*/false);
+  Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage,
+                                 "f" + Twine(Idx), M);
+  Value *Base = F->getArg(0);
+  Value *N = F->getArg(1);
+
+  BasicBlock *Entry = BasicBlock::Create(Ctx, "entry", F);
+  BasicBlock *Header = BasicBlock::Create(Ctx, "loop", F);
+  BasicBlock *Exit = BasicBlock::Create(Ctx, "exit", F);
+  IRBuilder<> B(Entry);
+  B.CreateBr(Header);
+
+  B.SetInsertPoint(Header);
+  PHINode *IV = B.CreatePHI(I64, 2, "iv");
+  PHINode *Sum = B.CreatePHI(I32, 2, "sum");
+  IV->addIncoming(ConstantInt::get(I64, 0), Entry);
+  Sum->addIncoming(ConstantInt::get(I32, 0), Entry);
+
+  Value *Acc = Sum;
+  for (unsigned Blk = 0; Blk != NumBlocks; ++Blk) {
+    Value *Off = B.CreateAdd(IV, ConstantInt::get(I64, Blk));
+    Value *Ptr = B.CreateGEP(I32, Base, Off);
+    Value *X = B.CreateLoad(I32, Ptr);
+    // Folds to a shift, an xor of an xor, and an add of zero.
+    Value *Y = B.CreateMul(X, ConstantInt::get(I32, 4));
+    Y = B.CreateXor(B.CreateXor(Y, ConstantInt::get(I32, -1)),
+                    ConstantInt::get(I32, -1));
+    Y = B.CreateAdd(Y, ConstantInt::get(I32, 0));
+    Value *Cmp = B.CreateICmpSGT(B.CreateSub(Y, Acc), ConstantInt::get(I32, 0));
+
+    BasicBlock *Then = BasicBlock::Create(Ctx, "then", F);
+    BasicBlock *Else = BasicBlock::Create(Ctx, "else", F);
+    BasicBlock *Join = BasicBlock::Create(Ctx, "join", F);
+    B.CreateCondBr(Cmp, Then, Else);
+
+    B.SetInsertPoint(Then);
+    Value *T = B.CreateAnd(B.CreateAdd(Acc, X), ConstantInt::get(I32, 0xffff));
+    B.CreateStore(T, Ptr);
+    B.CreateBr(Join);
+
+    B.SetInsertPoint(Else);
+    Value *Ext = B.CreateZExt(B.CreateTrunc(Y, Type::getInt8Ty(Ctx)), I32);
+    Value *E = B.CreateSelect(B.CreateICmpEQ(Ext, ConstantInt::get(I32, 0)),
+                              Acc, B.CreateUDiv(Acc, ConstantInt::get(I32, 8)));
+    B.CreateBr(Join);
+
+    B.SetInsertPoint(Join);
+    PHINode *Merged = B.CreatePHI(I32, 2);
+    Merged->addIncoming(T, Then);
+    Merged->addIncoming(E, Else);
+    Acc = Merged;
+  }
+
+  Value *Next = B.CreateAdd(IV, ConstantInt::get(I64, 1));
+  IV->addIncoming(Next, B.GetInsertBlock());
+  Sum->addIncoming(Acc, B.GetInsertBlock());
+  B.CreateCondBr(B.CreateICmpULT(Next, N), Header, Exit);
+
+  B.SetInsertPoint(Exit);
+  B.CreateRet(Acc);
+}
+
+std::unique_ptr<Module> generateModule(LLVMContext &Ctx, unsigned NumFunctions,
+                                       unsigned NumBlocks) {
+  auto M = std::make_unique<Module>("bench", Ctx);
+  for (unsigned Idx = 0; Idx != NumFunctions; ++Idx)
+    generateFunction(*M, Idx, NumBlocks);
+  return M;
+}
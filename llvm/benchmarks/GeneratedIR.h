@@ -0,0 +1,28 @@
+//===- GeneratedIR.h - Synthetic inputs for the benchmarks ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_BENCHMARKS_GENERATEDIR_H
+#define LLVM_BENCHMARKS_GENERATEDIR_H
+
+#include <memory>
+
+namespace llvm {
+class LLVMContext;
+class Module;
+} // end namespace llvm
+
+/// Build a module of \p NumFunctions functions, each a loop over an array
+/// whose body is a chain of \p NumBlocks diamonds of integer arithmetic,
+/// compares, loads and stores. The arithmetic is written the way front ends
+/// emit it before optimization, so InstCombine finds something to fold in
+/// every block.
+std::unique_ptr<llvm::Module> generateModule(llvm::LLVMContext &Ctx,
+                                             unsigned NumFunctions,
+                                             unsigned NumBlocks);
+
+#endif // LLVM_BENCHMARKS_GENERATEDIR_H
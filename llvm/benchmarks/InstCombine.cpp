@@ -0,0 +1,32 @@
+#include "GeneratedIR.h"
+#include "benchmark/benchmark.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Transforms/InstCombine/InstCombine.h"
+
+using namespace llvm;
+
+// Run InstCombine over a freshly generated module of State.range(0)
+// functions. Generating the input is not timed.
+static void BM_InstCombine(benchmark::State &State) {
+  LLVMContext Ctx;
+  unsigned NumInstructions = 0;
+  for (auto _ : State) {
+    State.PauseTiming();
+    std::unique_ptr<Module> M = generateModule(Ctx, State.range(0), 32);
+    NumInstructions = M->getInstructionCount();
+    legacy::FunctionPassManager FPM(M.get());
+    FPM.add(createInstructionCombiningPass());
+    FPM.doInitialization();
+    State.ResumeTiming();
+
+    for (Function &F : *M)
+      FPM.run(F);
+    FPM.doFinalization();
+  }
+  State.SetItemsProcessed(State.iterations() * NumInstructions);
+}
+BENCHMARK(BM_InstCombine)->Range(1, 64)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
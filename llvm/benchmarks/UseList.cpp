@@ -0,0 +1,58 @@
+#include "benchmark/benchmark.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+
+using namespace llvm;
+
+// Build a function whose two arguments are each used by State.range(0) adds,
+// then swap all uses of one argument for the other and back.
+static void BM_ReplaceAllUsesWith(benchmark::State &State) {
+  LLVMContext Ctx;
+  Module M("bench", Ctx);
+  Type *I32 = Type::getInt32Ty(Ctx);
+  FunctionType *FTy = FunctionType::get(I32, {I32, I32}, false);
+  Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage, "f", M);
+  BasicBlock *BB = BasicBlock::Create(Ctx, "entry", F);
+  IRBuilder<> B(BB);
+  Value *A = F->getArg(0);
+  Value *C = F->getArg(1);
+  Value *Acc = ConstantInt::get(I32, 0);
+  for (int64_t I = 0, E = State.range(0); I != E; ++I)
+    Acc = B.CreateAdd(Acc, B.CreateMul(A, C));
+  B.CreateRet(Acc);
+
+  for (auto _ : State) {
+    A->replaceAllUsesWith(C);
+    C->replaceUsesWithIf(A, [](Use &U) { return U.getOperandNo() == 0; });
+  }
+}
+BENCHMARK(BM_ReplaceAllUsesWith)->Range(1 << 10, 1 << 16);
+
+// Walk the users of a value with a long use list.
+static void BM_WalkUsers(benchmark::State &State) {
+  LLVMContext Ctx;
+  Module M("bench", Ctx);
+  Type *I32 = Type::getInt32Ty(Ctx);
+  FunctionType *FTy = FunctionType::get(I32, {I32}, false);
+  Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage, "f", M);
+  BasicBlock *BB = BasicBlock::Create(Ctx, "entry", F);
+  IRBuilder<> B(BB);
+  Value *A = F->getArg(0);
+  Value *Acc = A;
+  for (int64_t I = 0, E = State.range(0); I != E; ++I)
+    Acc = B.CreateAdd(Acc, A);
+  B.CreateRet(Acc);
+
+  for (auto _ : State) {
+    unsigned N = 0;
+    for (User *U : A->users())
+      N += U->getNumOperands();
+    benchmark::DoNotOptimize(N);
+  }
+}
+BENCHMARK(BM_WalkUsers)->Range(1 << 10, 1 << 16);
+
+BENCHMARK_MAIN();
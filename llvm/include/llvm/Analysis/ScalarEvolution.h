@@ -1183,6 +1183,12 @@ private:
   /// predicate by splitting it into a set of independent predicates.
   bool ProvingSplitPredicate = false;
 
+  /// Number of createSCEV calls currently on the stack.
+  unsigned CreateSCEVDepth = 0;
+
+  /// Number of isLoopEntryGuardedByCond walks currently on the stack.
+  unsigned LoopEntryGuardDepth = 0;
+
   /// Memoized values for the GetMinTrailingZeros
   DenseMap<const SCEV *, uint32_t> MinTrailingZerosCache;
 
@@ -16,6 +16,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/ScalarEvolutionNormalization.h"
 #include "llvm/Analysis/TargetFolder.h"
@@ -297,6 +298,10 @@ namespace llvm {
       return InsertedValues.count(I) || InsertedPostIncValues.count(I);
     }
 
+    /// Return all instructions inserted by the code rewriter since the last
+    /// call to clear().
+    SmallVector<Instruction *, 32> getAllInsertedInstructions() const;
+
     void setChainedPhi(PHINode *PN) { ChainedPhis.insert(PN); }
 
     /// Try to find existing LLVM IR value for S available at the point At.
@@ -410,6 +415,25 @@ namespace llvm {
 
     void fixupInsertPoints(Instruction *I);
   };
+
+  /// Removes the instructions inserted by a SCEVExpander when it goes out of
+  /// scope, unless the result of the expansion was marked as used. This lets
+  /// a pass expand code speculatively, e.g. to query alias analysis about an
+  /// expanded pointer, and bail out on any path without leaving dead code.
+  class SCEVExpanderCleaner {
+    SCEVExpander &Expander;
+
+    /// Whether the expanded code is used; if not, it is removed.
+    bool ResultUsed = false;
+
+  public:
+    SCEVExpanderCleaner(SCEVExpander &Expander) : Expander(Expander) {}
+
+    ~SCEVExpanderCleaner();
+
+    /// Keep the expanded code.
+    void markResultUsed() { ResultUsed = true; }
+  };
 }
 
 #endif
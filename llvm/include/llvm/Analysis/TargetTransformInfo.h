@@ -530,6 +530,11 @@ public:
                                    DominatorTree *DT,
                                    const LoopAccessInfo *LAI) const;
 
+  /// Query the target whether the mask of a predicated vector loop should be
+  /// computed with the @llvm.get.active.lane.mask intrinsic, rather than by
+  /// comparing the vector induction variable with the backedge-taken count.
+  bool emitGetActiveLaneMask() const;
+
   /// @}
 
   /// \name Scalar Target Information
@@ -1223,6 +1228,7 @@ public:
                                            TargetLibraryInfo *TLI,
                                            DominatorTree *DT,
                                            const LoopAccessInfo *LAI) = 0;
+  virtual bool emitGetActiveLaneMask() = 0;
   virtual bool isLegalAddImmediate(int64_t Imm) = 0;
   virtual bool isLegalICmpImmediate(int64_t Imm) = 0;
   virtual bool isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
@@ -1499,6 +1505,9 @@ public:
                                    const LoopAccessInfo *LAI) override {
     return Impl.preferPredicateOverEpilogue(L, LI, SE, AC, TLI, DT, LAI);
   }
+  bool emitGetActiveLaneMask() override {
+    return Impl.emitGetActiveLaneMask();
+  }
   bool isLegalAddImmediate(int64_t Imm) override {
     return Impl.isLegalAddImmediate(Imm);
   }
@@ -222,6 +222,8 @@ public:
     return false;
   }
 
+  bool emitGetActiveLaneMask() const { return false; }
+
   void getUnrollingPreferences(Loop *, ScalarEvolution &,
                                TTI::UnrollingPreferences &) {}
 
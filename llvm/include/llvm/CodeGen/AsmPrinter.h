@@ -680,6 +680,15 @@ private:
   /// This method emits the header for the current function.
   virtual void EmitFunctionHeader();
 
+  /// Emit the label marking the end of the current function and its .size
+  /// directive, if the target wants them.
+  void emitFunctionEndLabel();
+
+  /// Close the hot part of a split function before its first cold block \p MBB
+  /// and switch to the section holding the cold part. Returns the symbol that
+  /// starts the cold part.
+  MCSymbol *emitColdSectionStart(const MachineBasicBlock &MBB);
+
   /// Emit a blob of inline asm to the output streamer.
   void
   EmitInlineAsm(StringRef Str, const MCSubtargetInfo &STI,
@@ -269,8 +269,7 @@ class VirtRegMap;
 
     void InsertMachineInstrRangeInMaps(MachineBasicBlock::iterator B,
                                        MachineBasicBlock::iterator E) {
-      for (MachineBasicBlock::iterator I = B; I != E; ++I)
-        Indexes->insertMachineInstrInMaps(*I);
+      Indexes->insertMachineInstrsInMaps(B, E);
     }
 
     void RemoveMachineInstrFromMaps(MachineInstr &MI) {
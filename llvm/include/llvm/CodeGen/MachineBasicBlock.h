@@ -130,6 +130,10 @@ private:
   /// Indicate that this basic block is the entry block of a cleanup funclet.
   bool IsCleanupFuncletEntry = false;
 
+  /// Indicate that this basic block belongs to the cold part of a split
+  /// function, which is emitted into a separate section.
+  bool IsColdSection = false;
+
   /// since getSymbol is a relatively heavy-weight operation, the symbol
   /// is only computed once and is cached.
   mutable MCSymbol *CachedMCSymbol = nullptr;
@@ -409,6 +413,14 @@ public:
   /// Indicates if this is the entry block of a cleanup funclet.
   void setIsCleanupFuncletEntry(bool V = true) { IsCleanupFuncletEntry = V; }
 
+  /// Returns true if this block is placed in the cold section of a split
+  /// function.
+  bool isColdSection() const { return IsColdSection; }
+
+  /// Indicates if this block is placed in the cold section of a split
+  /// function.
+  void setIsColdSection(bool V = true) { IsColdSection = V; }
+
   /// Returns true if it is legal to hoist instructions into this block.
   bool isLegalToHoistInto() const;
 
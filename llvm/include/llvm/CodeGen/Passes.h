@@ -312,6 +312,11 @@ namespace llvm {
   /// This pass lays out funclets contiguously.
   extern char &FuncletLayoutID;
 
+  /// This pass moves the cold blocks of functions with profile data to a
+  /// separate section.
+  extern char &MachineFunctionSplitterID;
+  MachineFunctionPass *createMachineFunctionSplitterPass();
+
   /// This pass inserts the XRay instrumentation sleds if they are supported by
   /// the target platform.
   extern char &XRayInstrumentationID;
@@ -265,6 +265,12 @@ class SelectionDAG {
   /// Pool allocation for machine-opcode SDNode operands.
   BumpPtrAllocator OperandAllocator;
   ArrayRecycler<SDUse> OperandRecycler;
+  /// Memory held by OperandAllocator as of the last clear(), for statistics.
+  size_t OperandPoolBytes = 0;
+
+  /// Pool allocation for shuffle masks. These aren't recycled, so the pool is
+  /// reset whenever the DAG is cleared.
+  BumpPtrAllocator ShuffleMaskAllocator;
 
   /// Pool allocation for misc. objects that are created once per SelectionDAG.
   BumpPtrAllocator Allocator;
@@ -135,13 +135,26 @@ public:
     OPC_CheckChild0Same, OPC_CheckChild1Same,
     OPC_CheckChild2Same, OPC_CheckChild3Same,
     OPC_CheckPatternPredicate,
+    // Space-optimized forms that implicitly encode the predicate number.
+    OPC_CheckPatternPredicate0, OPC_CheckPatternPredicate1,
+    OPC_CheckPatternPredicate2, OPC_CheckPatternPredicate3,
+    OPC_CheckPatternPredicate4, OPC_CheckPatternPredicate5,
+    OPC_CheckPatternPredicate6, OPC_CheckPatternPredicate7,
     OPC_CheckPredicate,
+    // Space-optimized forms that implicitly encode the predicate number.
+    OPC_CheckPredicate0, OPC_CheckPredicate1, OPC_CheckPredicate2,
+    OPC_CheckPredicate3, OPC_CheckPredicate4, OPC_CheckPredicate5,
+    OPC_CheckPredicate6, OPC_CheckPredicate7,
     OPC_CheckPredicateWithOperands,
     OPC_CheckOpcode,
     OPC_SwitchOpcode,
+    // Switch with all of its case opcodes and offsets in one table up front.
+    OPC_SwitchOpcodeTable,
     OPC_CheckType,
     OPC_CheckTypeRes,
     OPC_SwitchType,
+    // Switch with all of its case types and offsets in one table up front.
+    OPC_SwitchTypeTable,
     OPC_CheckChild0Type, OPC_CheckChild1Type, OPC_CheckChild2Type,
     OPC_CheckChild3Type, OPC_CheckChild4Type, OPC_CheckChild5Type,
     OPC_CheckChild6Type, OPC_CheckChild7Type,
@@ -151,6 +164,10 @@ public:
     OPC_CheckCondCode, OPC_CheckChild2CondCode,
     OPC_CheckValueType,
     OPC_CheckComplexPat,
+    // Space-optimized forms that implicitly encode the pattern number.
+    OPC_CheckComplexPat0, OPC_CheckComplexPat1, OPC_CheckComplexPat2,
+    OPC_CheckComplexPat3, OPC_CheckComplexPat4, OPC_CheckComplexPat5,
+    OPC_CheckComplexPat6, OPC_CheckComplexPat7,
     OPC_CheckAndImm, OPC_CheckOrImm,
     OPC_CheckImmAllOnesV,
     OPC_CheckImmAllZerosV,
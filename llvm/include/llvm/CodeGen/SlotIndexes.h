@@ -570,6 +570,13 @@ class raw_ostream;
       return newIndex;
     }
 
+    /// Insert indexes for the instructions (bundles) in [Begin, End), none of
+    /// which may have an index yet. The whole range is numbered at once, so
+    /// the index list is renumbered at most once, where inserting the
+    /// instructions one at a time may have to renumber for each of them.
+    void insertMachineInstrsInMaps(MachineBasicBlock::iterator Begin,
+                                   MachineBasicBlock::iterator End);
+
     /// Removes machine instruction (bundle) \p MI from the mapping.
     /// This should be called before MachineInstr::eraseFromParent() is used to
     /// remove a whole bundle or an unbundled instruction.
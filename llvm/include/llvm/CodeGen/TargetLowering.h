@@ -844,6 +844,14 @@ public:
     return true;
   }
 
+  /// Return true if the @llvm.get.active.lane.mask intrinsic should be
+  /// expanded into generic vector operations. The result type is \p VT and the
+  /// type of the operands is \p OpVT. If this returns false, the intrinsic is
+  /// passed to the target as an INTRINSIC_WO_CHAIN node.
+  virtual bool shouldExpandGetActiveLaneMask(EVT VT, EVT OpVT) const {
+    return true;
+  }
+
   /// Return true if the target has native support for the specified value type.
   /// This means that it has a register that directly holds it without
   /// promotions or expansions.
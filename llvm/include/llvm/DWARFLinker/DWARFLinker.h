@@ -271,6 +271,13 @@ public:
   /// Use specified number of threads for parallel files linking.
   void setNumThreads(unsigned NumThreads) { Options.Threads = NumThreads; }
 
+  /// Limit the number of object files whose DIEs are fully extracted at the
+  /// same time. The unit DIEs of all objects are still loaded up front. 0
+  /// means no limit.
+  void setMaxObjectsInFlight(unsigned Num) {
+    Options.MaxObjectsInFlight = Num;
+  }
+
   /// Set kind of accelerator tables to be generated.
   void setAccelTableKind(AccelTableKind Kind) {
     Options.TheAccelTableKind = Kind;
@@ -766,6 +773,11 @@ private:
     /// Number of threads.
     unsigned Threads = 1;
 
+    /// Maximum number of object files whose DIEs are extracted at the same
+    /// time, i.e. how far analysis may run ahead of cloning. 0 means no
+    /// limit, in which case the DIEs of all objects are extracted up front.
+    unsigned MaxObjectsInFlight = 0;
+
     /// The accelerator table kind
     AccelTableKind TheAccelTableKind = AccelTableKind::Default;
 
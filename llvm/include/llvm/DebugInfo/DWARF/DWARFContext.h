@@ -40,6 +40,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 
 namespace llvm {
 
@@ -55,6 +56,11 @@ enum class ErrorPolicy { Halt, Continue };
 /// DWARFContext
 /// This data structure is the top level entity that deals with dwarf debug
 /// information parsing. The actual data is supplied through DWARFObj.
+///
+/// Most of the tables are created lazily and without synchronization. Once
+/// the units have been created, e.g. by calling compile_units(), the DIEs of
+/// the units and their line tables (getLineTableForUnit) may be extracted
+/// from several threads at once.
 class DWARFContext : public DIContext {
   DWARFUnitVector NormalUnits;
   std::unique_ptr<DWARFUnitIndex> CUIndex;
@@ -64,6 +70,7 @@ class DWARFContext : public DIContext {
   std::unique_ptr<DWARFDebugLoc> Loc;
   std::unique_ptr<DWARFDebugAranges> Aranges;
   std::unique_ptr<DWARFDebugLine> Line;
+  std::once_flag LineOnce;
   std::unique_ptr<DWARFDebugFrame> DebugFrame;
   std::unique_ptr<DWARFDebugFrame> EHFrame;
   std::unique_ptr<DWARFDebugMacro> Macro;
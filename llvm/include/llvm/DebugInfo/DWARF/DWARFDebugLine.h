@@ -21,6 +21,7 @@
 #include "llvm/Support/Path.h"
 #include <cstdint>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -380,6 +381,9 @@ private:
   using LineTableConstIter = LineTableMapTy::const_iterator;
 
   LineTableMapTy LineTableMap;
+  /// Guards LineTableMap, so that the line tables of different units can be
+  /// requested from several threads.
+  mutable std::mutex LineTableMapMutex;
 };
 
 } // end namespace llvm
@@ -26,11 +26,13 @@
 #include "llvm/DebugInfo/DWARF/DWARFUnitIndex.h"
 #include "llvm/Support/DataExtractor.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -228,6 +230,14 @@ class DWARFUnit {
   /// The compile unit debug information entry items.
   std::vector<DWARFDebugInfoEntry> DieArray;
 
+  /// DieArray is only extended with ExtractDIEsMutex held, so that the DIEs
+  /// of a unit can be requested from several threads at once. The flags tell
+  /// whether the unit DIE and all DIEs have been extracted and let the common
+  /// case return without taking the lock.
+  std::mutex ExtractDIEsMutex;
+  std::atomic<bool> CUDieExtracted{false};
+  std::atomic<bool> AllDIEsExtracted{false};
+
   /// Map from range's start address to end address and corresponding DIE.
   /// IntervalMap does not support range removal, as a result, we use the
   /// std::map::upper_bound for address range lookup.
@@ -509,7 +519,10 @@ private:
   }
 
   /// extractDIEsIfNeeded - Parses a compile unit and indexes its DIEs if it
-  /// hasn't already been done
+  /// hasn't already been done. This may be called from several threads for
+  /// the same unit. Note that extracting all DIEs after only the unit DIE has
+  /// been extracted invalidates DWARFDies obtained before; clients sharing a
+  /// unit between threads should extract all of its DIEs up front.
   void extractDIEsIfNeeded(bool CUDieOnly);
 
   /// extractDIEsToVector - Appends all parsed DIEs to a vector.
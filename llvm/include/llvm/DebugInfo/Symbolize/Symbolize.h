@@ -20,6 +20,7 @@
 #include "llvm/Support/Error.h"
 #include <algorithm>
 #include <cstdint>
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
@@ -46,6 +47,10 @@ public:
     std::string FallbackDebugPath;
     std::string DWPName;
     std::vector<std::string> DebugFileDirectory;
+    /// Maximum number of modules whose debug info is kept parsed, 0 for no
+    /// limit. The least recently used module is dropped first; it is parsed
+    /// again if it is queried later.
+    size_t MaxCachedModules = 0;
   };
 
   LLVMSymbolizer() = default;
@@ -94,6 +99,10 @@ private:
                    std::unique_ptr<DIContext> Context,
                    StringRef ModuleName);
 
+  /// Mark \p ModuleName as most recently used and drop the least recently
+  /// used modules if there are more than Opts.MaxCachedModules of them.
+  void recordModuleAccess(StringRef ModuleName);
+
   ObjectFile *lookUpDsymFile(const std::string &Path,
                              const MachOObjectFile *ExeObj,
                              const std::string &ArchName);
@@ -117,6 +126,13 @@ private:
   std::map<std::string, std::unique_ptr<SymbolizableModule>, std::less<>>
       Modules;
 
+  /// Names of the modules in Modules, most recently used first, and the
+  /// position of each name in that list. Only maintained if
+  /// Opts.MaxCachedModules is set.
+  std::list<std::string> ModuleLRU;
+  std::map<std::string, std::list<std::string>::iterator, std::less<>>
+      ModuleLRUPos;
+
   /// Contains cached results of getOrCreateObjectPair().
   std::map<std::pair<std::string, std::string>, ObjectPair>
       ObjectPairForPathArch;
@@ -18,6 +18,9 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Memory.h"
 #include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
 namespace jitlink {
@@ -92,6 +95,57 @@ public:
   allocate(const SegmentsRequestMap &Request) override;
 };
 
+/// A JITLinkMemoryManager that carves in-process memory out of large slabs.
+///
+/// Each protection class gets its own slabs, so segments that end up with the
+/// same permissions sit next to each other and the system can keep them in a
+/// single mapping once their permissions have been changed. This avoids
+/// running out of mappings when linking very large numbers of small objects.
+/// Slabs are requested with a huge page hint to reduce TLB pressure, and the
+/// memory of deallocated objects is reused for later allocations instead of
+/// being returned to the system.
+///
+/// Slabs are only released when the memory manager is destroyed, so it must
+/// outlive all of its allocations.
+class SlabMemoryManager : public JITLinkMemoryManager {
+public:
+  /// Create a memory manager that maps memory in slabs of at least SlabSize
+  /// bytes. Segments larger than a slab get a slab of their own.
+  SlabMemoryManager(size_t SlabSize = 2 * 1024 * 1024) : SlabSize(SlabSize) {}
+  ~SlabMemoryManager();
+
+  Expected<std::unique_ptr<Allocation>>
+  allocate(const SegmentsRequestMap &Request) override;
+
+private:
+  class SlabAllocation;
+  using AllocationMap = DenseMap<unsigned, sys::MemoryBlock>;
+
+  // Recycled memory. Memory that still has the final permissions of the
+  // segment it was deallocated from is only made writable again when it is
+  // reused.
+  struct FreeBlock {
+    char *Base;
+    bool IsProtected;
+  };
+
+  // The slabs and free memory for one protection class.
+  struct Pool {
+    std::vector<sys::MemoryBlock> Slabs;
+    char *Next = nullptr;
+    char *End = nullptr;
+    // Recycled memory, indexed by size for best-fit reuse.
+    std::multimap<size_t, FreeBlock> FreeBlocks;
+  };
+
+  Expected<sys::MemoryBlock> allocateBlock(unsigned Prot, size_t Size);
+  void releaseBlocks(AllocationMap &Blocks);
+
+  size_t SlabSize;
+  std::mutex PoolsMutex;
+  DenseMap<unsigned, Pool> Pools;
+};
+
 } // end namespace jitlink
 } // end namespace llvm
 
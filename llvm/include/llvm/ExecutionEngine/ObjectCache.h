@@ -34,6 +34,10 @@ public:
   /// object which corresponds with Module M, or 0 if an object is not
   /// available.
   virtual std::unique_ptr<MemoryBuffer> getObject(const Module* M) = 0;
+
+  /// Called instead of notifyObjectCompiled when compiling Module M after a
+  /// getObject miss failed, so that no object will be provided for it.
+  virtual void notifyCompileFailed(const Module *M) {}
 };
 
 } // end namespace llvm
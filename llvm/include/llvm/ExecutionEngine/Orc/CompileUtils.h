@@ -17,6 +17,8 @@
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/Layer.h"
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
 
@@ -57,6 +59,7 @@ private:
 
   CompileResult tryToLoadFromObjectCache(const Module &M);
   void notifyObjectCompiled(const Module &M, const MemoryBuffer &ObjBuffer);
+  void notifyCompileFailed(const Module &M);
 
   TargetMachine &TM;
   ObjectCache *ObjCache = nullptr;
@@ -80,20 +83,28 @@ private:
 
 /// A thread-safe version of SimpleCompiler.
 ///
-/// This class creates a new TargetMachine and SimpleCompiler instance for each
-/// compile.
+/// This class creates a SimpleCompiler instance for each compile. Each compile
+/// takes a TargetMachine from a pool, creating a new one only if all existing
+/// TargetMachines are in use by other compiles, so the number of
+/// TargetMachines built stays bounded by the number of concurrent compiles.
 class ConcurrentIRCompiler : public IRCompileLayer::IRCompiler {
 public:
   ConcurrentIRCompiler(JITTargetMachineBuilder JTMB,
                        ObjectCache *ObjCache = nullptr);
+  ~ConcurrentIRCompiler();
 
   void setObjectCache(ObjectCache *ObjCache) { this->ObjCache = ObjCache; }
 
   Expected<std::unique_ptr<MemoryBuffer>> operator()(Module &M) override;
 
 private:
+  Expected<std::unique_ptr<TargetMachine>> acquireTargetMachine();
+  void releaseTargetMachine(std::unique_ptr<TargetMachine> TM);
+
   JITTargetMachineBuilder JTMB;
   ObjectCache *ObjCache = nullptr;
+  std::mutex TMPoolMutex;
+  std::vector<std::unique_ptr<TargetMachine>> TMPool;
 };
 
 } // end namespace orc
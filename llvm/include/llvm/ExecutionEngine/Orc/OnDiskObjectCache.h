@@ -0,0 +1,74 @@
+//===- OnDiskObjectCache.h - Persistent object cache for ORC ----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An ObjectCache that keeps compiled objects in a directory on disk so they
+// can be reused by later processes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_ONDISKOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_ONDISKOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace llvm {
+
+class MemoryBuffer;
+class Module;
+
+namespace orc {
+
+/// An ObjectCache that stores compiled objects as files in a cache directory.
+///
+/// Objects are keyed by a hash of the module's bitcode (which includes its
+/// target triple and data layout) together with a client supplied string, so
+/// a cache directory can be shared by processes with different modules and
+/// targets. Cached objects are memory mapped when they are loaded.
+///
+/// The cache is best-effort: failures to read or write cache entries are
+/// ignored and simply cause the module to be compiled.
+///
+/// This class is thread-safe and can be shared by concurrent compilers, e.g.
+/// a ConcurrentIRCompiler.
+class OnDiskObjectCache : public ObjectCache {
+public:
+  /// Create a cache that stores objects in CacheDir, which is created on
+  /// first use if it doesn't exist. ExtraKey is mixed into every cache key
+  /// and should describe anything that affects code generation but is not
+  /// recorded in the module, e.g. the CPU, features and optimization level of
+  /// the TargetMachine.
+  OnDiskObjectCache(std::string CacheDir, std::string ExtraKey = "");
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+  void notifyCompileFailed(const Module *M) override;
+
+private:
+  std::string computeKey(const Module &M) const;
+  std::string getEntryPath(StringRef Key) const;
+
+  std::string CacheDir;
+  std::string ExtraKey;
+
+  // Code generation modifies the module, so the key computed when the cache
+  // is queried is remembered until the object has been compiled or the
+  // compile has failed.
+  std::mutex PendingKeysMutex;
+  DenseMap<const Module *, std::string> PendingKeys;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_ONDISKOBJECTCACHE_H
@@ -42,6 +42,27 @@ public:
   ResultTy operator()(Function &F);
 };
 
+// Direct calls that profile data marks as executed are extracted, following
+// the call graph of the module up to Horizon calls away from the function.
+// Profile counts come from the module's !prof metadata, i.e. instrumentation
+// or sample profiles applied to the IR before it is handed to the JIT.
+// Functions without profile data fall back to all of their direct calls, and
+// functions the profile shows as never executed contribute none.
+class ProfileGuidedQuery : public SpeculateQuery {
+  void findExecutedCalles(Function &F, FunctionAnalysisManager &FAM,
+                          DenseSet<StringRef> &Calles);
+
+  unsigned Horizon;
+
+public:
+  ProfileGuidedQuery(unsigned Horizon = 2) : Horizon(Horizon) {
+    assert(Horizon > 0 && "Horizon must include the direct callees");
+  }
+
+  // Find likely next executables based on profile counts
+  ResultTy operator()(Function &F);
+};
+
 // This Query generates a sequence of basic blocks which follows the order of
 // execution.
 // A handful of BB with higher block frequencies are taken, then path to entry
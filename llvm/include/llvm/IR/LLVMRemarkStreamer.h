@@ -35,6 +35,8 @@ public:
   LLVMRemarkStreamer(remarks::RemarkStreamer &RS) : RS(RS) {}
   /// Emit a diagnostic through the streamer.
   void emit(const DiagnosticInfoOptimizationBase &Diag);
+  /// Check whether remarks from \p PassName are kept by the pass filter.
+  bool matchesFilter(StringRef PassName) { return RS.matchesFilter(PassName); }
 };
 
 template <typename ThisError>
@@ -33,6 +33,33 @@ using AddBufferFn =
 Expected<NativeObjectCache> localCache(StringRef CacheDirectoryPath,
                                        AddBufferFn AddBuffer);
 
+/// A content-addressed store for native objects that is shared between
+/// machines, such as a remote cache service. Objects are keyed by the same
+/// keys as the local cache (see computeLTOCacheKey()).
+///
+/// Implementations must be thread safe. Errors are not fatal: remoteCache()
+/// treats a failed fetch as a cache miss and ignores a failed store.
+class RemoteCacheStore {
+public:
+  virtual ~RemoteCacheStore() = default;
+
+  /// Look up the object stored under \p Key. Returns a null buffer if there
+  /// is no such object.
+  virtual Expected<std::unique_ptr<MemoryBuffer>> fetch(StringRef Key) = 0;
+
+  /// Store \p Object under \p Key.
+  virtual Error store(StringRef Key, MemoryBufferRef Object) = 0;
+};
+
+/// Create a cache that uses the local cache directory \p CacheDirectoryPath
+/// in front of \p Store. Objects missing from the local cache are fetched
+/// from the store and added to the local cache. Objects that are missing from
+/// both are built by the caller, added to the local cache and uploaded to the
+/// store.
+Expected<NativeObjectCache>
+remoteCache(StringRef CacheDirectoryPath,
+            std::shared_ptr<RemoteCacheStore> Store, AddBufferFn AddBuffer);
+
 } // namespace lto
 } // namespace llvm
 
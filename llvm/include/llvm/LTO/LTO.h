@@ -46,6 +46,9 @@ class raw_pwrite_stream;
 ///
 /// This is done for correctness (if value exported, ensure we always
 /// emit a copy), and compile-time optimization (allow drop of duplicates).
+///
+/// The index is processed in parallel, so \p isPrevailing must be thread
+/// safe. \p recordNewLinkage is called serially, in index order.
 void thinLTOResolvePrevailingInIndex(
     ModuleSummaryIndex &Index,
     function_ref<bool(GlobalValue::GUID, const GlobalValueSummary *)>
@@ -57,6 +60,9 @@ void thinLTOResolvePrevailingInIndex(
 /// Update the linkages in the given \p Index to mark exported values
 /// as external and non-exported values as internal. The ThinLTO backends
 /// must apply the changes to the Module via thinLTOInternalizeModule.
+///
+/// The index is processed in parallel, so \p isExported and \p isPrevailing
+/// must be thread safe.
 void thinLTOInternalizeAndPromoteInIndex(
     ModuleSummaryIndex &Index,
     function_ref<bool(StringRef, ValueInfo)> isExported,
@@ -109,6 +109,11 @@ private:
 
   SectionListType Sections;
 
+  /// The fragments of each section, indexed by section ordinal, whose size
+  /// may change during relaxation. Only these are revisited by each layout
+  /// iteration. Only valid during layout().
+  std::vector<std::vector<MCFragment *>> RelaxableFragments;
+
   SymbolDataListType Symbols;
 
   std::vector<IndirectSymbolData> IndirectSymbols;
@@ -87,6 +87,15 @@ public:
   /// if the Subtarget differs from the current fragment.
   MCDataFragment *getOrCreateDataFragment(const MCSubtargetInfo* STI = nullptr);
 
+  /// Encode \p Inst at the end of \p DF. The code emitter writes straight
+  /// into the fragment's contents and fixups, without an intermediate buffer.
+  /// \returns the fixups that were added for \p Inst, for callers that need
+  /// to inspect them. The fixups are already part of \p DF, so callers that
+  /// don't can ignore the result.
+  MutableArrayRef<MCFixup> encodeInstIntoFragment(MCDataFragment &DF,
+                                                  const MCInst &Inst,
+                                                  const MCSubtargetInfo &STI);
+
 protected:
   bool changeSectionImpl(MCSection *Section, const MCExpr *Subsection);
 
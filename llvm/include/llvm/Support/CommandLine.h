@@ -355,7 +355,9 @@ protected:
 public:
   virtual ~Option() = default;
 
-  // addArgument - Register this argument with the commandline system.
+  // addArgument - Register this argument with the commandline system.  The
+  // option is added to its subcommands lazily, the first time the options are
+  // parsed, printed or looked up.
   //
   void addArgument();
 
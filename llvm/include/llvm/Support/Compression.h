@@ -41,6 +41,22 @@ Error uncompress(StringRef InputBuffer,
 
 uint32_t crc32(StringRef Buffer);
 
+/// Compress \p InputBuffer as a raw deflate stream, without the zlib header
+/// and trailer. Unless \p Finish is true, the stream is ended with a sync
+/// flush instead of a final block, so that independently compressed buffers
+/// can be concatenated into a single deflate stream.
+Error compressRaw(StringRef InputBuffer,
+                  SmallVectorImpl<char> &CompressedBuffer, int Level,
+                  bool Finish);
+
+/// Returns the Adler-32 checksum of \p Buffer, as stored in the trailer of a
+/// zlib stream.
+uint32_t adler32(StringRef Buffer);
+
+/// Returns the Adler-32 checksum of the concatenation of two buffers given the
+/// checksums of both and the length of the second one.
+uint32_t adler32Combine(uint32_t Adler1, uint32_t Adler2, size_t Length2);
+
 }  // End of namespace zlib
 
 } // End of namespace llvm
@@ -78,6 +78,11 @@ public:
   /// but keeps the memory mapping alive.
   virtual void discard() {}
 
+  /// Hint that the given range of the buffer has been completely written and
+  /// will not be accessed again soon. Buffers backed by a memory-mapped file
+  /// may release the underlying pages; the data is still written on commit().
+  virtual void releasePages(size_t Offset, size_t Size) {}
+
 protected:
   FileOutputBuffer(StringRef Path) : FinalPath(Path) {}
 
@@ -1194,6 +1194,12 @@ public:
   /// behavior.
   const char *const_data() const;
 
+  /// Hint that the pages fully contained in [Offset, Offset + Length) will
+  /// not be accessed again soon, so that they can be dropped from the process'
+  /// working set. This is only done for readwrite mappings, whose contents
+  /// are backed by the file and are preserved; for other modes it is a no-op.
+  void dontNeed(size_t Offset, size_t Length);
+
   /// \returns The minimum alignment offset must be.
   static int alignment();
 };
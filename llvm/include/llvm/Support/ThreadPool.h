@@ -25,6 +25,7 @@
 #include <mutex>
 #include <queue>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -54,14 +55,23 @@ public:
   inline std::shared_future<void> async(Function &&F, Args &&... ArgList) {
     auto Task =
         std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...);
-    return asyncImpl(std::move(Task));
+    return asyncImpl(std::move(Task), 0);
   }
 
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   template <typename Function>
   inline std::shared_future<void> async(Function &&F) {
-    return asyncImpl(std::forward<Function>(F));
+    return asyncImpl(std::forward<Function>(F), 0);
+  }
+
+  /// Asynchronous submission of a task that is started before every queued
+  /// task of a lower \p Priority. Tasks of equal priority start in the order
+  /// they were submitted; async() submits with priority 0.
+  template <typename Function>
+  inline std::shared_future<void> asyncWithPriority(unsigned Priority,
+                                                    Function &&F) {
+    return asyncImpl(std::forward<Function>(F), Priority);
   }
 
   /// Blocking wait for all the threads to complete and the queue to be empty.
@@ -71,13 +81,29 @@ public:
 private:
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
-  std::shared_future<void> asyncImpl(TaskTy F);
+  std::shared_future<void> asyncImpl(TaskTy F, unsigned Priority);
+
+  struct QueuedTask {
+    unsigned Priority;
+    uint64_t Order;
+    PackagedTaskTy Task;
+  };
+
+  /// Add a task to Tasks, or take the next task to start from it. The caller
+  /// holds QueueLock.
+  void pushTask(PackagedTaskTy Task, unsigned Priority);
+  PackagedTaskTy popTask();
+
+  /// Heap order of Tasks: true if \p A starts after \p B.
+  static bool startsAfter(const QueuedTask &A, const QueuedTask &B);
 
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// Tasks waiting for execution in the pool, as a heap ordered by priority
+  /// and then by submission order.
+  std::vector<QueuedTask> Tasks;
+  uint64_t NextTaskOrder = 0;
 
   /// Locking and signaling for accessing the Tasks queue.
   std::mutex QueueLock;
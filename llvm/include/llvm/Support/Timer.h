@@ -28,13 +28,20 @@ class TimeRecord {
   double UserTime;       ///< User time elapsed.
   double SystemTime;     ///< System time elapsed.
   ssize_t MemUsed;       ///< Memory allocated (in bytes).
+  uint64_t Instructions; ///< Instructions retired.
+  uint64_t Cycles;       ///< CPU cycles elapsed.
+  uint64_t CacheMisses;  ///< Last level cache misses.
+  uint64_t BranchMisses; ///< Mispredicted branches.
 public:
-  TimeRecord() : WallTime(0), UserTime(0), SystemTime(0), MemUsed(0) {}
-
-  /// Get the current time and memory usage.  If Start is true we get the memory
-  /// usage before the time, otherwise we get time before memory usage.  This
-  /// matters if the time to get the memory usage is significant and shouldn't
-  /// be counted as part of a duration.
+  TimeRecord()
+      : WallTime(0), UserTime(0), SystemTime(0), MemUsed(0), Instructions(0),
+        Cycles(0), CacheMisses(0), BranchMisses(0) {}
+
+  /// Get the current time and memory usage, and the hardware counters of the
+  /// calling thread if -track-perf-counters is given.  If Start is true we get
+  /// the memory usage before the time, otherwise we get time before memory
+  /// usage.  This matters if the time to get the memory usage is significant
+  /// and shouldn't be counted as part of a duration.
   static TimeRecord getCurrentTime(bool Start = true);
 
   double getProcessTime() const { return UserTime + SystemTime; }
@@ -42,6 +49,13 @@ public:
   double getSystemTime() const { return SystemTime; }
   double getWallTime() const { return WallTime; }
   ssize_t getMemUsed() const { return MemUsed; }
+  uint64_t getInstructions() const { return Instructions; }
+  uint64_t getCycles() const { return Cycles; }
+  uint64_t getCacheMisses() const { return CacheMisses; }
+  uint64_t getBranchMisses() const { return BranchMisses; }
+  bool hasPerfCounters() const {
+    return Instructions || Cycles || CacheMisses || BranchMisses;
+  }
 
   bool operator<(const TimeRecord &T) const {
     // Sort by Wall Time elapsed, as it is the only thing really accurate
@@ -53,12 +67,20 @@ public:
     UserTime   += RHS.UserTime;
     SystemTime += RHS.SystemTime;
     MemUsed    += RHS.MemUsed;
+    Instructions += RHS.Instructions;
+    Cycles       += RHS.Cycles;
+    CacheMisses  += RHS.CacheMisses;
+    BranchMisses += RHS.BranchMisses;
   }
   void operator-=(const TimeRecord &RHS) {
     WallTime   -= RHS.WallTime;
     UserTime   -= RHS.UserTime;
     SystemTime -= RHS.SystemTime;
     MemUsed    -= RHS.MemUsed;
+    Instructions -= RHS.Instructions;
+    Cycles       -= RHS.Cycles;
+    CacheMisses  -= RHS.CacheMisses;
+    BranchMisses -= RHS.BranchMisses;
   }
 
   /// Print the current time record to \p OS, with a breakdown showing
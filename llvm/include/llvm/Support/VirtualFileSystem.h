@@ -14,6 +14,7 @@
 #ifndef LLVM_SUPPORT_VIRTUALFILESYSTEM_H
 #define LLVM_SUPPORT_VIRTUALFILESYSTEM_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
@@ -21,10 +22,12 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Chrono.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <ctime>
@@ -38,6 +41,7 @@
 namespace llvm {
 
 class MemoryBuffer;
+class raw_ostream;
 
 namespace vfs {
 
@@ -404,6 +408,64 @@ private:
   virtual void anchor();
 };
 
+/// A file system that answers failing \p status queries from a snapshot of
+/// one or more directory trees stored in a memory-mapped cache file, so that
+/// many compiler instances can share the result of a single walk of large,
+/// rarely-changing trees such as SDKs and toolchain include directories.
+///
+/// Each directory in the cache records its modification time. A lookup of a
+/// name that is missing from a fully listed directory fails without touching
+/// the underlying file system, once that directory has been checked against
+/// the underlying file system; that check costs one \p status call per
+/// directory for the lifetime of this object. This makes probing a long list
+/// of header search paths cheap. Adding or removing a name changes the
+/// modification time of its directory, so such answers do not go stale.
+/// Queries for names that exist, which may have been rewritten in place, and
+/// queries below changed directories are forwarded to the underlying file
+/// system.
+///
+/// The file contents are not cached: \p openFileForRead only uses the cache
+/// to reject paths that are known not to exist.
+class StatCacheFileSystem : public ProxyFileSystem {
+public:
+  /// Create a file system that uses the cache in \p CacheBuffer in front of
+  /// \p FS. Returns an error if the buffer is not a valid cache.
+  static Expected<IntrusiveRefCntPtr<StatCacheFileSystem>>
+  create(std::unique_ptr<MemoryBuffer> CacheBuffer,
+         IntrusiveRefCntPtr<FileSystem> FS);
+
+  /// Walk the trees rooted at \p Roots in \p FS and write a cache describing
+  /// them to \p OS. Symbolic links to directories are recorded but not
+  /// followed.
+  static Error writeStatCache(FileSystem &FS, ArrayRef<std::string> Roots,
+                              raw_ostream &OS);
+
+  llvm::ErrorOr<Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<File>>
+  openFileForRead(const Twine &Path) override;
+
+private:
+  struct Entry;
+
+  StatCacheFileSystem(std::unique_ptr<MemoryBuffer> CacheBuffer,
+                      IntrusiveRefCntPtr<FileSystem> FS, uint32_t NumEntries,
+                      bool CaseInsensitive);
+
+  /// Returns true if the cache shows that \p Path does not exist.
+  bool isKnownMissing(const Twine &Path);
+  Entry getEntry(uint32_t Index) const;
+  StringRef getPath(uint32_t Index) const;
+  Optional<uint32_t> findPath(StringRef Path) const;
+  bool isDirectoryUnchanged(uint32_t Index);
+
+  std::unique_ptr<MemoryBuffer> CacheBuffer;
+  uint32_t NumEntries;
+  /// Whether the cached paths are folded to lower case.
+  bool CaseInsensitive;
+  /// Per-entry validation state for directories; see isDirectoryUnchanged.
+  std::unique_ptr<std::atomic<uint8_t>[]> DirState;
+};
+
 namespace detail {
 
 class InMemoryDirectory;
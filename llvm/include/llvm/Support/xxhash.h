@@ -44,6 +44,14 @@
 namespace llvm {
 uint64_t xxHash64(llvm::StringRef Data);
 uint64_t xxHash64(llvm::ArrayRef<uint8_t> Data);
+
+/// The 64-bit XXH3 hash of \p Data with the default secret and a zero seed,
+/// matching XXH3_64bits() from xxHash 0.8. It is considerably faster than
+/// xxHash64 on inputs longer than a few hundred bytes.
+uint64_t xxh3_64bits(llvm::ArrayRef<uint8_t> Data);
+inline uint64_t xxh3_64bits(llvm::StringRef Data) {
+  return xxh3_64bits(llvm::makeArrayRef(Data.bytes_begin(), Data.size()));
+}
 }
 
 #endif
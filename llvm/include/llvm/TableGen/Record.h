@@ -753,7 +753,7 @@ public:
 
 /// !op (X) - Transform an init.
 ///
-class UnOpInit : public OpInit, public FoldingSetNode {
+class UnOpInit : public OpInit {
 public:
   enum UnaryOp : uint8_t { CAST, HEAD, TAIL, SIZE, EMPTY, GETOP };
 
@@ -773,8 +773,6 @@ public:
 
   static UnOpInit *get(UnaryOp opc, Init *lhs, RecTy *Type);
 
-  void Profile(FoldingSetNodeID &ID) const;
-
   // Clone - Clone this operator, replacing arguments with the new list
   OpInit *clone(ArrayRef<Init *> Operands) const override {
     assert(Operands.size() == 1 &&
@@ -802,7 +800,7 @@ public:
 };
 
 /// !op (X, Y) - Combine two inits.
-class BinOpInit : public OpInit, public FoldingSetNode {
+class BinOpInit : public OpInit {
 public:
   enum BinaryOp : uint8_t { ADD, MUL, AND, OR, SHL, SRA, SRL, LISTCONCAT,
                             LISTSPLAT, STRCONCAT, CONCAT, EQ, NE, LE, LT, GE,
@@ -828,8 +826,6 @@ public:
   static Init *getListConcat(TypedInit *lhs, Init *rhs);
   static Init *getListSplat(TypedInit *lhs, Init *rhs);
 
-  void Profile(FoldingSetNodeID &ID) const;
-
   // Clone - Clone this operator, replacing arguments with the new list
   OpInit *clone(ArrayRef<Init *> Operands) const override {
     assert(Operands.size() == 2 &&
@@ -860,7 +856,7 @@ public:
 };
 
 /// !op (X, Y, Z) - Combine two inits.
-class TernOpInit : public OpInit, public FoldingSetNode {
+class TernOpInit : public OpInit {
 public:
   enum TernaryOp : uint8_t { SUBST, FOREACH, IF, DAG };
 
@@ -883,8 +879,6 @@ public:
                          Init *mhs, Init *rhs,
                          RecTy *Type);
 
-  void Profile(FoldingSetNodeID &ID) const;
-
   // Clone - Clone this operator, replacing arguments with the new list
   OpInit *clone(ArrayRef<Init *> Operands) const override {
     assert(Operands.size() == 3 &&
@@ -206,6 +206,13 @@ public:
   virtual void emitLinkerFlagsForUsed(raw_ostream &OS,
                                       const GlobalValue *GV) const {}
 
+  /// If supported, return the section to place the cold blocks of the split
+  /// function \p F in. Otherwise, return nullptr.
+  virtual MCSection *getSectionForColdCode(const Function &F,
+                                           const TargetMachine &TM) const {
+    return nullptr;
+  }
+
   /// If supported, return the section to use for the llvm.commandline
   /// metadata. Otherwise, return nullptr.
   virtual MCSection *getSectionForCommandLines() const {
@@ -215,6 +215,11 @@ ModulePass *createMergeFunctionsPass();
 /// function(s).
 ModulePass *createHotColdSplittingPass();
 
+//===----------------------------------------------------------------------===//
+/// createFunctionMultiVersioningPass - This pass clones functions with hot
+/// loops for newer ISA levels and dispatches between the clones at run time.
+ModulePass *createFunctionMultiVersioningPass();
+
 //===----------------------------------------------------------------------===//
 /// createPartialInliningPass - This pass inlines parts of functions.
 ///
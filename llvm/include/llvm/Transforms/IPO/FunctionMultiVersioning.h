@@ -0,0 +1,32 @@
+//===- FunctionMultiVersioning.h - Clone hot loops per ISA ------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass clones functions containing hot loops once per x86 ISA level and
+// dispatches between the clones through an ifunc.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_FUNCTIONMULTIVERSIONING_H
+#define LLVM_TRANSFORMS_IPO_FUNCTIONMULTIVERSIONING_H
+
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class Module;
+
+/// Pass to multiversion functions with hot loops.
+class FunctionMultiVersioningPass
+    : public PassInfoMixin<FunctionMultiVersioningPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+};
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_IPO_FUNCTIONMULTIVERSIONING_H
@@ -18,7 +18,6 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/PassManager.h"
-#include <vector>
 
 namespace llvm {
 
@@ -91,7 +90,10 @@ class SROA : public PassInfoMixin<SROA> {
   SetVector<AllocaInst *, SmallVector<AllocaInst *, 16>> PostPromotionWorklist;
 
   /// A collection of alloca instructions we can directly promote.
-  std::vector<AllocaInst *> PromotableAllocas;
+  ///
+  /// This is a SetVector so that deleted allocas can be dropped from it
+  /// without rescanning the whole list after every alloca we rewrite.
+  SetVector<AllocaInst *, SmallVector<AllocaInst *, 16>> PromotableAllocas;
 
   /// A worklist of PHIs to speculate prior to promoting allocas.
   ///
@@ -0,0 +1,64 @@
+//===- CodeLayout.h - Code layout/placement algorithms  ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Declares methods and data structures for code layout algorithms.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_UTILS_CODELAYOUT_H
+#define LLVM_TRANSFORMS_UTILS_CODELAYOUT_H
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+/// A directed jump between two nodes, given by their indices.
+using EdgeT = std::pair<uint64_t, uint64_t>;
+
+/// A jump together with its execution count.
+using EdgeCountT = std::pair<EdgeT, uint64_t>;
+
+/// Find a layout of nodes (basic blocks) of a given CFG optimizing jump
+/// locality and thus processor I-cache utilization. This is achieved via
+/// increasing the number of fall-through jumps and co-locating frequently
+/// executed nodes together. The nodes are assumed to be indexed by integers
+/// from [0, |V|) so that the current order is the identity permutation; node
+/// 0 is the entry and is placed first in the resulting order.
+///
+/// The model is described in "Improved Basic Block Reordering" by A. Newell
+/// and S. Pupyrev, IEEE Transactions on Computers, 2020.
+///
+/// \p NodeSizes     The sizes of the nodes (in bytes).
+/// \p NodeCounts    The execution counts of the nodes in the profile.
+/// \p EdgeCounts    The execution counts of every edge (jump) in the profile.
+/// \returns The best node order found.
+std::vector<uint64_t> applyExtTspLayout(ArrayRef<uint64_t> NodeSizes,
+                                        ArrayRef<uint64_t> NodeCounts,
+                                        ArrayRef<EdgeCountT> EdgeCounts);
+
+/// Estimate the "quality" of a given node order in CFG. The higher the score,
+/// the better the order is. The score is designed to reflect the locality of
+/// the given order, which is anti-correlated with the number of I-cache
+/// misses in a typical execution of the function.
+double calcExtTspScore(ArrayRef<uint64_t> Order, ArrayRef<uint64_t> NodeSizes,
+                       ArrayRef<uint64_t> NodeCounts,
+                       ArrayRef<EdgeCountT> EdgeCounts);
+
+/// Estimate the "quality" of the current node order in CFG.
+double calcExtTspScore(ArrayRef<uint64_t> NodeSizes,
+                       ArrayRef<uint64_t> NodeCounts,
+                       ArrayRef<EdgeCountT> EdgeCounts);
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_UTILS_CODELAYOUT_H
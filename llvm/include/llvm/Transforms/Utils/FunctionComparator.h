@@ -15,6 +15,7 @@
 #define LLVM_TRANSFORMS_UTILS_FUNCTIONCOMPARATOR_H
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/Instructions.h"
@@ -31,6 +32,7 @@ class APFloat;
 class APInt;
 class BasicBlock;
 class Constant;
+class ConstantInt;
 class Function;
 class GlobalValue;
 class InlineAsm;
@@ -68,12 +70,17 @@ class GlobalNumberState {
 public:
   GlobalNumberState() = default;
 
+  /// Return the number of \p Global, assigning the next one if it has none.
+  /// Looking up a global that has been numbered already does not modify the
+  /// state, so once every global of a module has a number, functions of that
+  /// module may be compared concurrently.
   uint64_t getNumber(GlobalValue* Global) {
-    ValueNumberMap::iterator MapIter;
+    ValueNumberMap::iterator MapIter = GlobalNumbers.find(Global);
+    if (MapIter != GlobalNumbers.end())
+      return MapIter->second;
     bool Inserted;
     std::tie(MapIter, Inserted) = GlobalNumbers.insert({Global, NextNumber});
-    if (Inserted)
-      NextNumber++;
+    NextNumber++;
     return MapIter->second;
   }
 
@@ -99,6 +106,24 @@ public:
   /// Test whether the two functions have equivalent behaviour.
   int compare();
 
+  /// An integer constant operand of an instruction in the left function that
+  /// has a different value in the right function.
+  struct ConstantDiff {
+    const Instruction *Inst;
+    unsigned OpNo;
+    ConstantInt *RightValue;
+  };
+
+  /// Test whether the two functions have equivalent behaviour if each integer
+  /// constant that could be replaced by a parameter of the function took the
+  /// value it has in the right function. The constant operands that differ
+  /// are appended to \p Diffs.
+  int compareModuloConstants(SmallVectorImpl<ConstantDiff> &Diffs);
+
+  /// Return true if operand \p OpNo of \p I may be an arbitrary value instead
+  /// of the constant it is, without changing what the instruction means.
+  static bool canParameterizeOperand(const Instruction &I, unsigned OpNo);
+
   /// Hash a function. Equivalent functions will have the same hash, and unequal
   /// functions will have different hashes with high probability.
   using FunctionHash = uint64_t;
@@ -383,6 +408,10 @@ private:
   /// So it's impossible to use dominance properties in general.
   mutable DenseMap<const Value*, int> sn_mapL, sn_mapR;
 
+  /// If set, differing integer constants that could be parameterized compare
+  /// equal and are recorded here.
+  SmallVectorImpl<ConstantDiff> *ConstantDiffs = nullptr;
+
   // The global state we will use
   GlobalNumberState* GlobalNumbers;
 };
@@ -15,6 +15,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/InstructionSimplify.h"
@@ -34,6 +35,7 @@
 #include "llvm/IR/PatternMatch.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/InitializePasses.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/raw_ostream.h"
@@ -47,6 +49,15 @@ using namespace PatternMatch;
 // answer for a given value.
 static const unsigned MaxProcessedPerValue = 500;
 
+STATISTIC(NumCachePrunes, "Number of times the LVI cache was pruned");
+STATISTIC(NumCacheFlushes, "Number of times the LVI cache was flushed");
+
+// This is the number of block-value pairs the cache may hold before it is
+// pruned at the start of the next query.
+static cl::opt<unsigned> MaxCacheEntries(
+    "lvi-max-cache-entries", cl::Hidden, cl::init(500000),
+    cl::desc("Maximum number of block values cached by LazyValueInfo"));
+
 char LazyValueInfoWrapperPass::ID = 0;
 LazyValueInfoWrapperPass::LazyValueInfoWrapperPass() : FunctionPass(ID) {
   initializeLazyValueInfoWrapperPassPass(*PassRegistry::getPassRegistry());
@@ -179,6 +190,9 @@ namespace {
     DenseMap<Value *, std::unique_ptr<ValueCacheEntryTy>> ValueCache;
     OverDefinedCacheTy OverDefinedCache;
 
+    /// The number of block-value pairs held in ValueCache and
+    /// OverDefinedCache together.
+    unsigned NumEntries = 0;
 
   public:
     void insertResult(Value *Val, BasicBlock *BB,
@@ -187,19 +201,27 @@ namespace {
 
       // Insert over-defined values into their own cache to reduce memory
       // overhead.
-      if (Result.isOverdefined())
-        OverDefinedCache[BB].insert(Val);
-      else {
+      if (Result.isOverdefined()) {
+        if (OverDefinedCache[BB].insert(Val).second)
+          ++NumEntries;
+      } else {
         auto It = ValueCache.find_as(Val);
         if (It == ValueCache.end()) {
           ValueCache[Val] = std::make_unique<ValueCacheEntryTy>(Val, this);
           It = ValueCache.find_as(Val);
           assert(It != ValueCache.end() && "Val was just added to the map!");
         }
-        It->second->BlockVals[BB] = Result;
+        auto Inserted = It->second->BlockVals.try_emplace(BB, Result);
+        if (Inserted.second)
+          ++NumEntries;
+        else
+          Inserted.first->second = Result;
       }
     }
 
+    /// Return the number of block-value pairs in the cache.
+    unsigned size() const { return NumEntries; }
+
     bool isOverdefined(Value *V, BasicBlock *BB) const {
       auto ODI = OverDefinedCache.find(BB);
 
@@ -238,8 +260,12 @@ namespace {
       SeenBlocks.clear();
       ValueCache.clear();
       OverDefinedCache.clear();
+      NumEntries = 0;
     }
 
+    /// Drop every cached value except those at the end of the blocks in Keep.
+    void pruneToBlocks(const SmallPtrSetImpl<BasicBlock *> &Keep);
+
     /// Inform the cache that a given value has been deleted.
     void eraseValue(Value *V);
 
@@ -262,12 +288,17 @@ void LazyValueInfoCache::eraseValue(Value *V) {
     // ourselves.
     auto Iter = I++;
     SmallPtrSetImpl<Value *> &ValueSet = Iter->second;
-    ValueSet.erase(V);
+    if (ValueSet.erase(V))
+      --NumEntries;
     if (ValueSet.empty())
       OverDefinedCache.erase(Iter);
   }
 
-  ValueCache.erase(V);
+  auto I = ValueCache.find(V);
+  if (I == ValueCache.end())
+    return;
+  NumEntries -= I->second->BlockVals.size();
+  ValueCache.erase(I);
 }
 
 void LVIValueHandle::deleted() {
@@ -284,11 +315,45 @@ void LazyValueInfoCache::eraseBlock(BasicBlock *BB) {
   SeenBlocks.erase(I);
 
   auto ODI = OverDefinedCache.find(BB);
-  if (ODI != OverDefinedCache.end())
+  if (ODI != OverDefinedCache.end()) {
+    NumEntries -= ODI->second.size();
     OverDefinedCache.erase(ODI);
+  }
 
   for (auto &I : ValueCache)
-    I.second->BlockVals.erase(BB);
+    if (I.second->BlockVals.erase(BB))
+      --NumEntries;
+}
+
+void LazyValueInfoCache::pruneToBlocks(
+    const SmallPtrSetImpl<BasicBlock *> &Keep) {
+  for (auto I = SeenBlocks.begin(), E = SeenBlocks.end(); I != E;) {
+    auto Iter = I++;
+    if (!Keep.count(*Iter))
+      SeenBlocks.erase(Iter);
+  }
+
+  for (auto I = OverDefinedCache.begin(), E = OverDefinedCache.end(); I != E;) {
+    auto Iter = I++;
+    if (Keep.count(Iter->first))
+      continue;
+    NumEntries -= Iter->second.size();
+    OverDefinedCache.erase(Iter);
+  }
+
+  for (auto I = ValueCache.begin(), E = ValueCache.end(); I != E;) {
+    auto Iter = I++;
+    auto &BlockVals = Iter->second->BlockVals;
+    for (auto BI = BlockVals.begin(), BE = BlockVals.end(); BI != BE;) {
+      auto BIter = BI++;
+      if (Keep.count(BIter->first))
+        continue;
+      --NumEntries;
+      BlockVals.erase(BIter);
+    }
+    if (BlockVals.empty())
+      ValueCache.erase(Iter);
+  }
 }
 
 void LazyValueInfoCache::threadEdgeImpl(BasicBlock *OldSucc,
@@ -332,6 +397,7 @@ void LazyValueInfoCache::threadEdgeImpl(BasicBlock *OldSucc,
     for (Value *V : ValsToClear) {
       if (!ValueSet.erase(V))
         continue;
+      --NumEntries;
 
       // If we removed anything, then we potentially need to update
       // blocks successors too.
@@ -402,6 +468,28 @@ namespace {
       return true;
     }
 
+    /// The predecessor walks of work items that had to wait for the value of
+    /// a predecessor, keyed like BlockValueStack. Each records the index of
+    /// the first edge not yet merged and the value merged so far, so that
+    /// revisiting the item resumes its walk instead of merging every earlier
+    /// edge again.
+    DenseMap<std::pair<BasicBlock *, Value *>,
+             std::pair<unsigned, ValueLatticeElement>>
+        PredWalks;
+
+    /// Restore the predecessor walk of BV into Result, if it had to wait for
+    /// a predecessor, and return the index of the edge to continue from.
+    unsigned resumePredWalk(const std::pair<BasicBlock *, Value *> &BV,
+                            ValueLatticeElement &Result) {
+      auto It = PredWalks.find(BV);
+      if (It == PredWalks.end())
+        return 0;
+      unsigned FirstEdge = It->second.first;
+      Result = It->second.second;
+      PredWalks.erase(It);
+      return FirstEdge;
+    }
+
     AssumptionCache *AC;  ///< A pointer to the cache of @llvm.assume calls.
     const DataLayout &DL; ///< A mandatory DataLayout
     DominatorTree *DT;    ///< An optional DT pointer.
@@ -448,6 +536,10 @@ namespace {
 
   void solve();
 
+  /// Shrink the cache if it outgrew MaxCacheEntries, keeping the values at
+  /// the end of the dominators of BB when the dominator tree is available.
+  void pruneCache(BasicBlock *BB);
+
   public:
     /// This is the query interface to determine the lattice
     /// value for the specified Value* at the end of the specified block.
@@ -537,6 +629,7 @@ void LazyValueInfoImpl::solve() {
       }
       BlockValueSet.clear();
       BlockValueStack.clear();
+      PredWalks.clear();
       return;
     }
     std::pair<BasicBlock *, Value *> e = BlockValueStack.back();
@@ -561,6 +654,30 @@ void LazyValueInfoImpl::solve() {
   }
 }
 
+void LazyValueInfoImpl::pruneCache(BasicBlock *BB) {
+  if (TheCache.size() <= MaxCacheEntries)
+    return;
+
+  // Queries from JumpThreading and CorrelatedValuePropagation move through
+  // the function roughly in order, and the next ones mostly reuse what is
+  // known at the end of the blocks dominating the current one. Keep those
+  // unless they alone use up most of the budget.
+  if (DomTreeNode *Node = DT ? DT->getNode(BB) : nullptr) {
+    SmallPtrSet<BasicBlock *, 32> Keep;
+    for (; Node; Node = Node->getIDom())
+      Keep.insert(Node->getBlock());
+    TheCache.pruneToBlocks(Keep);
+    ++NumCachePrunes;
+    if (TheCache.size() <= MaxCacheEntries / 2)
+      return;
+  }
+
+  LLVM_DEBUG(dbgs() << "LVI flushing cache of " << TheCache.size()
+                    << " entries\n");
+  TheCache.clear();
+  ++NumCacheFlushes;
+}
+
 bool LazyValueInfoImpl::hasBlockValue(Value *Val, BasicBlock *BB) {
   // If already a constant, there is nothing to compute.
   if (isa<Constant>(Val))
@@ -749,11 +866,17 @@ bool LazyValueInfoImpl::solveBlockValueNonLocal(ValueLatticeElement &BBLV,
   // find a path to function entry.  TODO: We should consider explicitly
   // canonicalizing to make this true rather than relying on this happy
   // accident.
-  for (pred_iterator PI = pred_begin(BB), E = pred_end(BB); PI != E; ++PI) {
+  unsigned FirstEdge = resumePredWalk({BB, Val}, Result);
+  unsigned EdgeIdx = 0;
+  for (BasicBlock *Pred : predecessors(BB)) {
+    if (EdgeIdx++ < FirstEdge)
+      continue;
     ValueLatticeElement EdgeResult;
-    if (!getEdgeValue(Val, *PI, BB, EdgeResult))
+    if (!getEdgeValue(Val, Pred, BB, EdgeResult)) {
       // Explore that input, then return here
+      PredWalks[{BB, Val}] = {EdgeIdx - 1, Result};
       return false;
+    }
 
     Result.mergeIn(EdgeResult, DL);
 
@@ -788,16 +911,20 @@ bool LazyValueInfoImpl::solveBlockValuePHINode(ValueLatticeElement &BBLV,
   // Loop over all of our predecessors, merging what we know from them into
   // result.  See the comment about the chosen traversal order in
   // solveBlockValueNonLocal; the same reasoning applies here.
-  for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i) {
+  for (unsigned i = resumePredWalk({BB, PN}, Result),
+                e = PN->getNumIncomingValues();
+       i != e; ++i) {
     BasicBlock *PhiBB = PN->getIncomingBlock(i);
     Value *PhiVal = PN->getIncomingValue(i);
     ValueLatticeElement EdgeResult;
     // Note that we can provide PN as the context value to getEdgeValue, even
     // though the results will be cached, because PN is the value being used as
     // the cache key in the caller.
-    if (!getEdgeValue(PhiVal, PhiBB, BB, EdgeResult, PN))
+    if (!getEdgeValue(PhiVal, PhiBB, BB, EdgeResult, PN)) {
       // Explore that input, then return here
+      PredWalks[{BB, PN}] = {i, Result};
       return false;
+    }
 
     Result.mergeIn(EdgeResult, DL);
 
@@ -1558,6 +1685,7 @@ ValueLatticeElement LazyValueInfoImpl::getValueInBlock(Value *V, BasicBlock *BB,
                     << BB->getName() << "'\n");
 
   assert(BlockValueStack.empty() && BlockValueSet.empty());
+  pruneCache(BB);
   if (!hasBlockValue(V, BB)) {
     pushBlockValue(std::make_pair(BB, V));
     solve();
@@ -1592,6 +1720,7 @@ getValueOnEdge(Value *V, BasicBlock *FromBB, BasicBlock *ToBB,
                     << FromBB->getName() << "' to '" << ToBB->getName()
                     << "'\n");
 
+  pruneCache(FromBB);
   ValueLatticeElement Result;
   if (!getEdgeValue(V, FromBB, ToBB, Result, CxtI)) {
     solve();
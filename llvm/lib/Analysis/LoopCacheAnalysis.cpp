@@ -596,6 +596,9 @@ CacheCost::computeLoopCacheCost(const Loop &L,
   CacheCostTy LoopCost = 0;
   for (const ReferenceGroupTy &RG : RefGroups) {
     CacheCostTy RefGroupCost = computeRefGroupCacheCost(RG, L);
+    // A reference whose cost is unknown makes the cost of the loop unknown.
+    if (RefGroupCost == InvalidCost)
+      return InvalidCost;
     LoopCost += RefGroupCost * TripCountsProduct;
   }
 
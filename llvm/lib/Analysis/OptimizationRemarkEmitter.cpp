@@ -18,6 +18,7 @@
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LLVMRemarkStreamer.h"
 #include "llvm/InitializePasses.h"
 
 using namespace llvm;
@@ -84,6 +85,16 @@ void OptimizationRemarkEmitter::emit(
   F->getContext().diagnose(OptDiag);
 }
 
+bool OptimizationRemarkEmitter::allowExtraAnalysis(StringRef PassName) const {
+  // Remarks from passes rejected by the remark file's pass filter are dropped
+  // anyway, so don't let them pay for the extra analysis.
+  LLVMContext &Ctx = F->getContext();
+  if (LLVMRemarkStreamer *RS = Ctx.getLLVMRemarkStreamer())
+    if (RS->matchesFilter(PassName))
+      return true;
+  return Ctx.getDiagHandlerPtr()->isAnyRemarkEnabled(PassName);
+}
+
 OptimizationRemarkEmitterWrapperPass::OptimizationRemarkEmitterWrapperPass()
     : FunctionPass(ID) {
   initializeOptimizationRemarkEmitterWrapperPassPass(
@@ -146,6 +146,13 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumCreateSCEVDepthLimited,
+          "Number of values left unanalyzed due to the SCEV creation depth "
+          "limit");
+STATISTIC(NumImpliedCondBudgetExhausted,
+          "Number of implication queries cut short by the condition budget");
+STATISTIC(NumLoopEntryGuardDepthLimited,
+          "Number of loop entry guard walks skipped due to the nesting limit");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -221,6 +228,23 @@ static cl::opt<unsigned>
                   cl::desc("Size of the expression which is considered huge"),
                   cl::init(4096));
 
+static cl::opt<unsigned> MaxCreateSCEVDepth(
+    "scalar-evolution-max-create-depth", cl::Hidden,
+    cl::desc("Maximum depth of recursive SCEV creation for nested values"),
+    cl::init(512));
+
+static cl::opt<unsigned> MaxImpliedCondOperands(
+    "scalar-evolution-max-implied-cond-operands", cl::Hidden,
+    cl::desc("Maximum number of and/or operands of a condition to inspect "
+             "when proving an implication"),
+    cl::init(128));
+
+static cl::opt<unsigned> MaxLoopEntryGuardDepth(
+    "scalar-evolution-max-loop-entry-guard-depth", cl::Hidden,
+    cl::desc("Maximum number of nested walks over conditions guarding a loop "
+             "entry"),
+    cl::init(2));
+
 static cl::opt<bool>
 ClassifyExpressions("scalar-evolution-classify-expressions",
     cl::Hidden, cl::init(true),
@@ -3904,6 +3928,15 @@ const SCEV *ScalarEvolution::getSCEV(Value *V) {
 
   const SCEV *S = getExistingSCEV(V);
   if (S == nullptr) {
+    // Long chains of dependent instructions would otherwise recurse once per
+    // instruction. Past the limit, treat the value as opaque for this query
+    // only; it is not cached, so V is still analyzed when it is queried from
+    // a shallower depth.
+    if (CreateSCEVDepth >= MaxCreateSCEVDepth) {
+      ++NumCreateSCEVDepthLimited;
+      return getUnknown(V);
+    }
+    SaveAndRestore<unsigned> Depth(CreateSCEVDepth, CreateSCEVDepth + 1);
     S = createSCEV(V);
     // During PHI resolution, it is possible to create two SCEVs for the same
     // V, so it is needed to double check whether V->S is inserted into
@@ -9692,6 +9725,16 @@ ScalarEvolution::isLoopEntryGuardedByCond(const Loop *L,
     return false;
   };
 
+  // Proving an implication can ask about the entry of the same loop again.
+  // Every nested walk multiplies the work by the number of guards, so only a
+  // few are allowed on the stack at once.
+  if (LoopEntryGuardDepth >= MaxLoopEntryGuardDepth) {
+    ++NumLoopEntryGuardDepthLimited;
+    return false;
+  }
+  SaveAndRestore<unsigned> GuardDepth(LoopEntryGuardDepth,
+                                      LoopEntryGuardDepth + 1);
+
   // Starting at the loop predecessor, climb up the predecessor chain, as long
   // as there are predecessors that can be found that have unique successors
   // leading to the original header.
@@ -9736,37 +9779,62 @@ bool ScalarEvolution::isImpliedCond(ICmpInst::Predicate Pred,
   if (!PendingLoopPredicates.insert(FoundCondValue).second)
     return false;
 
-  auto ClearOnExit =
-      make_scope_exit([&]() { PendingLoopPredicates.erase(FoundCondValue); });
+  // Look through And and Or conditions. Each operand is inspected once, so
+  // that a condition built by reusing the same subexpression many times does
+  // not make this exponential.
+  SmallPtrSet<Value *, 8> Visited;
+  SmallVector<Value *, 8> Worklist;
+  auto ClearOnExit = make_scope_exit(
+      [&]() { PendingLoopPredicates.erase(FoundCondValue); });
 
-  // Recursively handle And and Or conditions.
-  if (BinaryOperator *BO = dyn_cast<BinaryOperator>(FoundCondValue)) {
-    if (BO->getOpcode() == Instruction::And) {
-      if (!Inverse)
-        return isImpliedCond(Pred, LHS, RHS, BO->getOperand(0), Inverse) ||
-               isImpliedCond(Pred, LHS, RHS, BO->getOperand(1), Inverse);
-    } else if (BO->getOpcode() == Instruction::Or) {
-      if (Inverse)
-        return isImpliedCond(Pred, LHS, RHS, BO->getOperand(0), Inverse) ||
-               isImpliedCond(Pred, LHS, RHS, BO->getOperand(1), Inverse);
+  Worklist.push_back(FoundCondValue);
+  unsigned Budget = MaxImpliedCondOperands;
+  while (!Worklist.empty()) {
+    Value *Cond = Worklist.pop_back_val();
+    if (!Visited.insert(Cond).second)
+      continue;
+    if (Budget-- == 0) {
+      ++NumImpliedCondBudgetExhausted;
+      return false;
+    }
+
+    if (BinaryOperator *BO = dyn_cast<BinaryOperator>(Cond)) {
+      if ((BO->getOpcode() == Instruction::And && !Inverse) ||
+          (BO->getOpcode() == Instruction::Or && Inverse)) {
+        Worklist.push_back(BO->getOperand(1));
+        Worklist.push_back(BO->getOperand(0));
+        continue;
+      }
     }
-  }
 
-  ICmpInst *ICI = dyn_cast<ICmpInst>(FoundCondValue);
-  if (!ICI) return false;
+    ICmpInst *ICI = dyn_cast<ICmpInst>(Cond);
+    if (!ICI)
+      continue;
 
-  // Now that we found a conditional branch that dominates the loop or controls
-  // the loop latch. Check to see if it is the comparison we are looking for.
-  ICmpInst::Predicate FoundPred;
-  if (Inverse)
-    FoundPred = ICI->getInversePredicate();
-  else
-    FoundPred = ICI->getPredicate();
+    // Only the compare being checked is pending; the nested queries below may
+    // still use its siblings, including the ones inspected before it.
+    if (Cond != FoundCondValue && !PendingLoopPredicates.insert(Cond).second)
+      continue;
 
-  const SCEV *FoundLHS = getSCEV(ICI->getOperand(0));
-  const SCEV *FoundRHS = getSCEV(ICI->getOperand(1));
+    // Now that we found a conditional branch that dominates the loop or
+    // controls the loop latch. Check to see if it is the comparison we are
+    // looking for.
+    ICmpInst::Predicate FoundPred;
+    if (Inverse)
+      FoundPred = ICI->getInversePredicate();
+    else
+      FoundPred = ICI->getPredicate();
+
+    const SCEV *FoundLHS = getSCEV(ICI->getOperand(0));
+    const SCEV *FoundRHS = getSCEV(ICI->getOperand(1));
 
-  return isImpliedCond(Pred, LHS, RHS, FoundPred, FoundLHS, FoundRHS);
+    bool Implied = isImpliedCond(Pred, LHS, RHS, FoundPred, FoundLHS, FoundRHS);
+    if (Cond != FoundCondValue)
+      PendingLoopPredicates.erase(Cond);
+    if (Implied)
+      return true;
+  }
+  return false;
 }
 
 bool ScalarEvolution::isImpliedCond(ICmpInst::Predicate Pred, const SCEV *LHS,
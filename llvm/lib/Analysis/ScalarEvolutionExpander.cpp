@@ -1887,17 +1887,22 @@ Value *SCEVExpander::expand(const SCEV *S) {
         ConstantInt *Idx =
             ConstantInt::getSigned(VO.second->getType(), -(Offset * 8) / ESize);
         V = Builder.CreateGEP(Ety, V, Idx, "scevgep");
+        rememberInstruction(V);
       } else {
         ConstantInt *Idx =
             ConstantInt::getSigned(VO.second->getType(), -Offset);
         unsigned AS = Vty->getAddressSpace();
         V = Builder.CreateBitCast(V, Type::getInt8PtrTy(SE.getContext(), AS));
+        rememberInstruction(V);
         V = Builder.CreateGEP(Type::getInt8Ty(SE.getContext()), V, Idx,
                               "uglygep");
+        rememberInstruction(V);
         V = Builder.CreateBitCast(V, Vty);
+        rememberInstruction(V);
       }
     } else {
       V = Builder.CreateSub(V, VO.second);
+      rememberInstruction(V);
     }
   }
   // Remember the expanded value for this SCEV at this location.
@@ -1917,6 +1922,18 @@ void SCEVExpander::rememberInstruction(Value *I) {
     InsertedValues.insert(I);
 }
 
+SmallVector<Instruction *, 32>
+SCEVExpander::getAllInsertedInstructions() const {
+  SmallVector<Instruction *, 32> Result;
+  for (Value *V : InsertedValues)
+    if (auto *I = dyn_cast<Instruction>(V))
+      Result.push_back(I);
+  for (Value *V : InsertedPostIncValues)
+    if (auto *I = dyn_cast<Instruction>(V))
+      Result.push_back(I);
+  return Result;
+}
+
 /// getOrInsertCanonicalInductionVariable - This method returns the
 /// canonical induction variable of the specified type for the specified
 /// loop (inserting one if there is none).  A canonical induction variable
@@ -2420,6 +2437,31 @@ struct SCEVFindUnsafe {
 };
 }
 
+SCEVExpanderCleaner::~SCEVExpanderCleaner() {
+  if (ResultUsed)
+    return;
+
+  SmallVector<Instruction *, 32> Inserted =
+      Expander.getAllInsertedInstructions();
+  // The expander holds asserting handles on the inserted instructions.
+  Expander.clear();
+
+  // Erase the expanded code from its users up to its operands. The expander
+  // may also have reused existing instructions, e.g. a matching IV, so only
+  // erase what is left without users once the other expanded code is gone.
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (Instruction *&I : Inserted) {
+      if (!I || !I->use_empty())
+        continue;
+      I->eraseFromParent();
+      I = nullptr;
+      Changed = true;
+    }
+  }
+}
+
 namespace llvm {
 bool isSafeToExpand(const SCEV *S, ScalarEvolution &SE) {
   SCEVFindUnsafe Search(SE);
@@ -70,6 +70,7 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -92,12 +93,43 @@ static cl::opt<bool> PrintSummaryGUIDs(
     cl::desc(
         "Print the global id for each value when reading the module summary"));
 
+static cl::opt<bool> ParallelFunctionDecode(
+    "bitcode-parallel-function-decode", cl::init(false), cl::Hidden,
+    cl::desc("Decode the records of function blocks on multiple threads "
+             "before building their IR when materializing a whole module"));
+
+static cl::opt<unsigned> FunctionDecodeBatchSize(
+    "bitcode-function-decode-batch", cl::init(256), cl::Hidden,
+    cl::desc("Maximum number of function blocks decoded ahead of time by "
+             "-bitcode-parallel-function-decode"));
+
 namespace {
 
 enum {
   SWITCH_INST_MAGIC = 0x4B5 // May 2012 => 1205 => Hex
 };
 
+/// The top-level contents of a function block, decoded from the bitstream
+/// without touching any IR. Records are stored as their code and operands;
+/// nested blocks are only located, and are parsed from the stream when the
+/// function body is built.
+struct DecodedFunctionBody {
+  struct Entry {
+    /// The record code, or the block ID of a nested block.
+    unsigned Code;
+    bool IsSubBlock;
+    /// For a record, the index of its first operand in Ops. For a nested
+    /// block, the bit just past its block ID.
+    uint64_t Offset;
+    unsigned NumOps;
+  };
+
+  std::vector<Entry> Entries;
+  std::vector<uint64_t> Ops;
+  /// The bit just past the END_BLOCK of the function block.
+  uint64_t EndBit = 0;
+};
+
 } // end anonymous namespace
 
 static Error error(const Twine &Message) {
@@ -537,6 +569,11 @@ class BitcodeReader : public BitcodeReaderBase, public GVMaterializer {
   /// where to find deferred function body in the stream.
   DenseMap<Function*, uint64_t> DeferredFunctionInfo;
 
+  /// Function bodies whose records have already been decoded, see
+  /// decodeFunctionBodies.
+  DenseMap<Function *, std::unique_ptr<DecodedFunctionBody>>
+      DecodedFunctionBodies;
+
   /// When Metadata block is initially scanned when parsing the module, we may
   /// choose to defer parsing of the metadata. This vector contains info about
   /// which Metadata blocks are deferred.
@@ -752,6 +789,7 @@ private:
   Error rememberAndSkipMetadata();
   Error typeCheckLoadStoreInst(Type *ValType, Type *PtrType);
   Error parseFunctionBody(Function *F);
+  void decodeFunctionBodies(Module::iterator I, Module::iterator E);
   Error globalCleanup();
   Error resolveGlobalAndIndirectSymbolInits();
   Error parseUseLists();
@@ -3732,14 +3770,44 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
 
   std::vector<OperandBundleDef> OperandBundles;
 
+  // If the records of this block were decoded ahead of time, replay them
+  // instead of reading them from the stream.
+  DecodedFunctionBody *Decoded = nullptr;
+  auto DecodedIt = DecodedFunctionBodies.find(F);
+  if (DecodedIt != DecodedFunctionBodies.end())
+    Decoded = DecodedIt->second.get();
+  size_t NextDecodedEntry = 0;
+
   // Read all the records.
   SmallVector<uint64_t, 64> Record;
 
   while (true) {
-    Expected<llvm::BitstreamEntry> MaybeEntry = Stream.advance();
-    if (!MaybeEntry)
-      return MaybeEntry.takeError();
-    llvm::BitstreamEntry Entry = MaybeEntry.get();
+    llvm::BitstreamEntry Entry;
+    const DecodedFunctionBody::Entry *DecodedEntry = nullptr;
+    if (Decoded) {
+      if (NextDecodedEntry == Decoded->Entries.size()) {
+        // Leave the stream past the end of the block, as advance() would.
+        if (Error JumpFailed = Stream.JumpToBit(Decoded->EndBit))
+          return JumpFailed;
+        if (Stream.ReadBlockEnd())
+          return error("Malformed block");
+        goto OutOfRecordLoop;
+      }
+      DecodedEntry = &Decoded->Entries[NextDecodedEntry++];
+      if (DecodedEntry->IsSubBlock) {
+        // Nested blocks are parsed from the stream as usual.
+        if (Error JumpFailed = Stream.JumpToBit(DecodedEntry->Offset))
+          return JumpFailed;
+        Entry = BitstreamEntry::getSubBlock(DecodedEntry->Code);
+      } else {
+        Entry = BitstreamEntry::getRecord(0);
+      }
+    } else {
+      Expected<llvm::BitstreamEntry> MaybeEntry = Stream.advance();
+      if (!MaybeEntry)
+        return MaybeEntry.takeError();
+      Entry = MaybeEntry.get();
+    }
 
     switch (Entry.Kind) {
     case BitstreamEntry::Error:
@@ -3788,10 +3856,18 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
     Record.clear();
     Instruction *I = nullptr;
     Type *FullTy = nullptr;
-    Expected<unsigned> MaybeBitCode = Stream.readRecord(Entry.ID, Record);
-    if (!MaybeBitCode)
-      return MaybeBitCode.takeError();
-    switch (unsigned BitCode = MaybeBitCode.get()) {
+    unsigned BitCode;
+    if (DecodedEntry) {
+      BitCode = DecodedEntry->Code;
+      auto Ops = Decoded->Ops.begin() + DecodedEntry->Offset;
+      Record.append(Ops, Ops + DecodedEntry->NumOps);
+    } else {
+      Expected<unsigned> MaybeBitCode = Stream.readRecord(Entry.ID, Record);
+      if (!MaybeBitCode)
+        return MaybeBitCode.takeError();
+      BitCode = MaybeBitCode.get();
+    }
+    switch (BitCode) {
     default: // Default behavior: reject
       return error("Invalid value");
     case bitc::FUNC_CODE_DECLAREBLOCKS: {   // DECLAREBLOCKS: [nblocks]
@@ -5207,6 +5283,80 @@ OutOfRecordLoop:
   return Error::success();
 }
 
+/// Decode the top-level records of the function block starting at \p Bit.
+/// This only reads the bitstream, so it can run concurrently with other
+/// decodes that use their own cursor.
+static Error decodeFunctionBody(BitstreamCursor Cursor, uint64_t Bit,
+                                DecodedFunctionBody &Body) {
+  if (Error JumpFailed = Cursor.JumpToBit(Bit))
+    return JumpFailed;
+  if (Error Err = Cursor.EnterSubBlock(bitc::FUNCTION_BLOCK_ID))
+    return Err;
+
+  SmallVector<uint64_t, 64> Record;
+  while (true) {
+    Expected<BitstreamEntry> MaybeEntry = Cursor.advance();
+    if (!MaybeEntry)
+      return MaybeEntry.takeError();
+    BitstreamEntry Entry = MaybeEntry.get();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      return error("Malformed block");
+    case BitstreamEntry::EndBlock:
+      Body.EndBit = Cursor.GetCurrentBitNo();
+      return Error::success();
+    case BitstreamEntry::SubBlock:
+      Body.Entries.push_back({Entry.ID, true, Cursor.GetCurrentBitNo(), 0});
+      if (Error Err = Cursor.SkipBlock())
+        return Err;
+      continue;
+    case BitstreamEntry::Record:
+      break;
+    }
+
+    Record.clear();
+    Expected<unsigned> MaybeBitCode = Cursor.readRecord(Entry.ID, Record);
+    if (!MaybeBitCode)
+      return MaybeBitCode.takeError();
+    Body.Entries.push_back({MaybeBitCode.get(), false, Body.Ops.size(),
+                            static_cast<unsigned>(Record.size())});
+    Body.Ops.insert(Body.Ops.end(), Record.begin(), Record.end());
+  }
+}
+
+/// Decode, in parallel, the blocks of the next functions in [I, E) whose
+/// position in the stream is known. parseFunctionBody then only has to turn
+/// the decoded records into IR. A function whose block fails to decode is
+/// left to parseFunctionBody, which reports the error.
+void BitcodeReader::decodeFunctionBodies(Module::iterator I,
+                                         Module::iterator E) {
+  DecodedFunctionBodies.clear();
+
+  std::vector<std::pair<Function *, uint64_t>> Work;
+  for (; I != E && Work.size() < FunctionDecodeBatchSize; ++I) {
+    if (!I->isMaterializable())
+      continue;
+    auto DFII = DeferredFunctionInfo.find(&*I);
+    if (DFII == DeferredFunctionInfo.end() || DFII->second == 0)
+      continue;
+    Work.emplace_back(&*I, DFII->second);
+  }
+
+  std::vector<std::unique_ptr<DecodedFunctionBody>> Bodies(Work.size());
+  parallel::for_each_n(parallel::par, size_t(0), Work.size(), [&](size_t N) {
+    auto Body = std::make_unique<DecodedFunctionBody>();
+    if (Error Err = decodeFunctionBody(Stream, Work[N].second, *Body))
+      consumeError(std::move(Err));
+    else
+      Bodies[N] = std::move(Body);
+  });
+
+  for (size_t N = 0, NE = Work.size(); N != NE; ++N)
+    if (Bodies[N])
+      DecodedFunctionBodies[Work[N].first] = std::move(Bodies[N]);
+}
+
 /// Find the function body in the bitcode stream
 Error BitcodeReader::findFunctionInStream(
     Function *F,
@@ -5258,7 +5408,9 @@ Error BitcodeReader::materialize(GlobalValue *GV) {
   // Move the bit stream to the saved position of the deferred function body.
   if (Error JumpFailed = Stream.JumpToBit(DFII->second))
     return JumpFailed;
-  if (Error Err = parseFunctionBody(F))
+  Error Err = parseFunctionBody(F);
+  DecodedFunctionBodies.erase(F);
+  if (Err)
     return Err;
   F->setIsMaterializable(false);
 
@@ -5313,9 +5465,13 @@ Error BitcodeReader::materializeModule() {
   // Iterate over the module, deserializing any functions that are still on
   // disk.
   for (Function &F : *TheModule) {
+    if (ParallelFunctionDecode && F.isMaterializable() &&
+        DeferredFunctionInfo.lookup(&F) && !DecodedFunctionBodies.count(&F))
+      decodeFunctionBodies(F.getIterator(), TheModule->end());
     if (Error Err = materialize(&F))
       return Err;
   }
+  DecodedFunctionBodies.clear();
   // At this point, if there are any function bodies, parse the rest of
   // the bits in the module past the last function block we have recorded
   // through either lazy scanning or the VST.
@@ -5657,8 +5813,17 @@ std::vector<FunctionSummary::EdgeTy>
 ModuleSummaryIndexBitcodeReader::makeCallList(ArrayRef<uint64_t> Record,
                                               bool IsOldProfileFormat,
                                               bool HasProfile, bool HasRelBF) {
+  // Each edge takes one record entry for the callee plus, depending on the
+  // format, one or two for profile information. Reserve exactly the number
+  // of edges: call lists are a large part of the memory footprint of the
+  // combined index, and over-reserving would double it for profiled builds.
+  unsigned EntriesPerEdge = 1;
+  if (IsOldProfileFormat)
+    EntriesPerEdge += HasProfile ? 2 : 1;
+  else if (HasProfile || HasRelBF)
+    EntriesPerEdge += 1;
   std::vector<FunctionSummary::EdgeTy> Ret;
-  Ret.reserve(Record.size());
+  Ret.reserve(Record.size() / EntriesPerEdge);
   for (unsigned I = 0, E = Record.size(); I != E; ++I) {
     CalleeInfo::HotnessType Hotness = CalleeInfo::HotnessType::Unknown;
     uint64_t RelBF = 0;
@@ -25,6 +25,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
@@ -1095,7 +1096,14 @@ void AsmPrinter::EmitFunctionBody() {
   // Print out code for the function.
   bool HasAnyRealCode = false;
   int NumInstsInFunction = 0;
+  MCSection *FnSection = OutStreamer->getCurrentSectionOnly();
+  MCSymbol *ColdFnSym = nullptr;
   for (auto &MBB : *MF) {
+    // The cold blocks of a split function come last and go to a section of
+    // their own.
+    if (MBB.isColdSection() && !ColdFnSym)
+      ColdFnSym = emitColdSectionStart(MBB);
+
     // Print a label for the basic block.
     EmitBasicBlockStart(MBB);
     for (auto &MI : MBB) {
@@ -1222,22 +1230,16 @@ void AsmPrinter::EmitFunctionBody() {
   // Emit target-specific gunk after the function body.
   EmitFunctionBodyEnd();
 
-  if (needFuncLabelsForEHOrDebugInfo(*MF, MMI) ||
-      MAI->hasDotTypeDotSizeDirective()) {
-    // Create a symbol for the end of function.
-    CurrentFnEnd = createTempSymbol("func_end");
-    OutStreamer->EmitLabel(CurrentFnEnd);
-  }
-
-  // If the target wants a .size directive for the size of the function, emit
-  // it.
-  if (MAI->hasDotTypeDotSizeDirective()) {
-    // We can get the size as difference between the function label and the
-    // temp label.
+  if (!ColdFnSym) {
+    emitFunctionEndLabel();
+  } else if (MAI->hasDotTypeDotSizeDirective()) {
+    // The hot part has been closed already; give the cold part a size too.
+    MCSymbol *ColdFnEnd = createTempSymbol("cold_end");
+    OutStreamer->EmitLabel(ColdFnEnd);
     const MCExpr *SizeExp = MCBinaryExpr::createSub(
-        MCSymbolRefExpr::create(CurrentFnEnd, OutContext),
-        MCSymbolRefExpr::create(CurrentFnSymForSize, OutContext), OutContext);
-    OutStreamer->emitELFSize(CurrentFnSym, SizeExp);
+        MCSymbolRefExpr::create(ColdFnEnd, OutContext),
+        MCSymbolRefExpr::create(ColdFnSym, OutContext), OutContext);
+    OutStreamer->emitELFSize(ColdFnSym, SizeExp);
   }
 
   for (const HandlerInfo &HI : Handlers) {
@@ -1256,6 +1258,11 @@ void AsmPrinter::EmitFunctionBody() {
     HI.Handler->endFunction(MF);
   }
 
+  // The frame of the cold part has been closed in its own section above;
+  // whatever follows the function refers to the section it started in.
+  if (ColdFnSym)
+    OutStreamer->SwitchSection(FnSection);
+
   // Emit section containing stack size metadata.
   emitStackSizeSection(*MF);
 
@@ -1267,6 +1274,70 @@ void AsmPrinter::EmitFunctionBody() {
   OutStreamer->AddBlankLine();
 }
 
+void AsmPrinter::emitFunctionEndLabel() {
+  if (needFuncLabelsForEHOrDebugInfo(*MF, MMI) ||
+      MAI->hasDotTypeDotSizeDirective()) {
+    // Create a symbol for the end of function.
+    CurrentFnEnd = createTempSymbol("func_end");
+    OutStreamer->EmitLabel(CurrentFnEnd);
+  }
+
+  // If the target wants a .size directive for the size of the function, emit
+  // it.
+  if (MAI->hasDotTypeDotSizeDirective()) {
+    // We can get the size as difference between the function label and the
+    // temp label.
+    const MCExpr *SizeExp = MCBinaryExpr::createSub(
+        MCSymbolRefExpr::create(CurrentFnEnd, OutContext),
+        MCSymbolRefExpr::create(CurrentFnSymForSize, OutContext), OutContext);
+    OutStreamer->emitELFSize(CurrentFnSym, SizeExp);
+  }
+}
+
+MCSymbol *AsmPrinter::emitColdSectionStart(const MachineBasicBlock &MBB) {
+  // The hot part ends with the function symbol's size and its own frame
+  // description.
+  emitFunctionEndLabel();
+  for (const HandlerInfo &HI : Handlers) {
+    NamedRegionTimer T(HI.TimerName, HI.TimerDescription, HI.TimerGroupName,
+                       HI.TimerGroupDescription, TimePassesIsEnabled);
+    HI.Handler->endFragment();
+  }
+
+  const Function &F = MF->getFunction();
+  MCSection *ColdSection = getObjFileLowering().getSectionForColdCode(F, TM);
+  assert(ColdSection && "Split function without a cold section");
+  OutStreamer->SwitchSection(ColdSection);
+  EmitAlignment(MF->getAlignment(), &F);
+
+  // Name the cold part <name>.cold, or <name>.cold.<N> if that name is taken
+  // already, e.g. by a function of the same name.
+  SmallString<128> ColdName(CurrentFnSym->getName());
+  ColdName += ".cold";
+  size_t ColdNameLen = ColdName.size();
+  for (unsigned Suffix = 1; OutContext.lookupSymbol(ColdName) ||
+                            F.getParent()->getNamedValue(ColdName);
+       ++Suffix) {
+    ColdName.resize(ColdNameLen);
+    ColdName += '.';
+    ColdName += utostr(Suffix);
+  }
+  MCSymbol *ColdFnSym = OutContext.getOrCreateSymbol(ColdName);
+  if (MAI->hasDotTypeDotSizeDirective())
+    OutStreamer->EmitSymbolAttribute(ColdFnSym, MCSA_ELF_TypeFunction);
+  OutStreamer->EmitLabel(ColdFnSym);
+
+  // Split functions have no landing pads, so the cold part never needs an
+  // LSDA of its own.
+  for (const HandlerInfo &HI : Handlers) {
+    NamedRegionTimer T(HI.TimerName, HI.TimerDescription, HI.TimerGroupName,
+                       HI.TimerGroupDescription, TimePassesIsEnabled);
+    HI.Handler->beginFragment(
+        &MBB, [](AsmPrinter *Asm) { return Asm->getCurExceptionSym(); });
+  }
+  return ColdFnSym;
+}
+
 /// Compute the number of Global Variables that uses a Constant.
 static unsigned getNumGlobalVariableUses(const Constant *C) {
   if (!C)
@@ -3080,6 +3151,10 @@ isBlockOnlyReachableByFallthrough(const MachineBasicBlock *MBB) const {
   if (!Pred->isLayoutSuccessor(MBB))
     return false;
 
+  // Nothing falls through from one section into another.
+  if (Pred->isColdSection() != MBB->isColdSection())
+    return false;
+
   // If the block is completely empty, then it definitely does fall through.
   if (Pred->empty())
     return true;
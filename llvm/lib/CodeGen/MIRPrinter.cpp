@@ -629,6 +629,11 @@ void MIPrinter::print(const MachineBasicBlock &MBB) {
     OS << "landing-pad";
     HasAttributes = true;
   }
+  if (MBB.isColdSection()) {
+    OS << (HasAttributes ? ", " : " (");
+    OS << "cold-section";
+    HasAttributes = true;
+  }
   if (MBB.getAlignment() != Align(1)) {
     OS << (HasAttributes ? ", " : " (");
     OS << "align " << MBB.getAlignment().value();
@@ -326,6 +326,11 @@ void MachineBasicBlock::print(raw_ostream &OS, ModuleSlotTracker &MST,
     OS << "landing-pad";
     HasAttributes = true;
   }
+  if (isColdSection()) {
+    OS << (HasAttributes ? ", " : " (");
+    OS << "cold-section";
+    HasAttributes = true;
+  }
   if (getAlignment() != Align(1)) {
     OS << (HasAttributes ? ", " : " (");
     OS << "align " << Log2(getAlignment());
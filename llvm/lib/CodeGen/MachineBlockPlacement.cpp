@@ -61,6 +61,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/CodeLayout.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
@@ -185,6 +186,24 @@ static cl::opt<unsigned> TriangleChainCount(
     cl::init(2),
     cl::Hidden);
 
+// Use the ext-TSP model to lay out blocks of functions with profile data.
+static cl::opt<bool> EnableExtTspBlockPlacement(
+    "enable-ext-tsp-block-placement", cl::Hidden, cl::init(false),
+    cl::desc("Enable machine block placement based on the ext-tsp model, "
+             "optimizing I-cache utilization."));
+
+static cl::opt<bool> ApplyExtTspWithoutProfile(
+    "ext-tsp-apply-without-profile", cl::Hidden, cl::init(false),
+    cl::desc("Apply the ext-tsp block placement to functions without "
+             "profile data, using statically estimated frequencies."));
+
+// The ext-TSP layout is superlinear in the number of blocks; keep it from
+// dominating compile time on huge functions.
+static cl::opt<unsigned> ExtTspBlockPlacementMaxBlocks(
+    "ext-tsp-block-placement-max-blocks", cl::Hidden, cl::init(1000),
+    cl::desc("Maximum number of basic blocks in a function to run the "
+             "ext-tsp block placement on."));
+
 extern cl::opt<unsigned> StaticLikelyProb;
 extern cl::opt<unsigned> ProfileLikelyProb;
 
@@ -483,6 +502,9 @@ class MachineBlockPlacement : public MachineFunctionPass {
       BlockChain &LoopChain, const MachineLoop &L,
       const BlockFilterSet &LoopBlockSet);
   void buildCFGChains();
+  void spliceFunctionChain(BlockChain &FunctionChain);
+  bool shouldApplyExtTsp() const;
+  void applyExtTsp();
   void optimizeBranches();
   void alignBlocks();
   /// Returns true if a block should be tail-duplicated to increase fallthrough
@@ -2689,6 +2711,17 @@ void MachineBlockPlacement::buildCFGChains() {
     assert(!BadFunc && "Detected problems with the block placement.");
   });
 
+  spliceFunctionChain(FunctionChain);
+
+  BlockWorkList.clear();
+  EHPadWorkList.clear();
+}
+
+/// Move the blocks of the function into the order of \p FunctionChain and
+/// fix up their terminators for the new layout.
+void MachineBlockPlacement::spliceFunctionChain(BlockChain &FunctionChain) {
+  SmallVector<MachineOperand, 4> Cond; // For analyzeBranch.
+
   // Splice the blocks into place.
   MachineFunction::iterator InsertPos = F->begin();
   LLVM_DEBUG(dbgs() << "[MBP] Function: " << F->getName() << "\n");
@@ -2755,9 +2788,95 @@ void MachineBlockPlacement::buildCFGChains() {
   MachineBasicBlock *TBB = nullptr, *FBB = nullptr; // For analyzeBranch.
   if (!TII->analyzeBranch(F->back(), TBB, FBB, Cond))
     F->back().updateTerminator();
+}
 
-  BlockWorkList.clear();
-  EHPadWorkList.clear();
+bool MachineBlockPlacement::shouldApplyExtTsp() const {
+  if (!EnableExtTspBlockPlacement)
+    return false;
+  // There is nothing to reorder in tiny functions.
+  if (F->size() < 3 || F->size() > ExtTspBlockPlacementMaxBlocks)
+    return false;
+  return ApplyExtTspWithoutProfile || F->getFunction().hasProfileData();
+}
+
+/// Re-order the blocks of the function to maximize the ext-TSP score of the
+/// layout, which rewards fallthroughs and short jumps weighted by their
+/// frequency. The blocks are numbered in their current order and the result
+/// of the chain-based placement serves as the starting point.
+void MachineBlockPlacement::applyExtTsp() {
+  // A block whose fallthrough cannot be analyzed must stay in front of its
+  // layout successor, so such runs of blocks are laid out as a single node.
+  SmallVector<SmallVector<MachineBasicBlock *, 4>, 16> Nodes;
+  DenseMap<const MachineBasicBlock *, uint64_t> NodeIndex;
+  SmallVector<MachineOperand, 4> Cond; // For analyzeBranch.
+  bool FallsThroughUnanalyzed = false;
+  for (MachineBasicBlock &MBB : *F) {
+    if (Nodes.empty() || !FallsThroughUnanalyzed)
+      Nodes.emplace_back();
+    Nodes.back().push_back(&MBB);
+    NodeIndex[&MBB] = Nodes.size() - 1;
+
+    Cond.clear();
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr; // For analyzeBranch.
+    FallsThroughUnanalyzed =
+        TII->analyzeBranch(MBB, TBB, FBB, Cond) && MBB.canFallThrough();
+#ifndef NDEBUG
+    if (FallsThroughUnanalyzed)
+      BlocksWithUnanalyzableExits.insert(&MBB);
+#endif
+  }
+
+  std::vector<uint64_t> NodeSizes(Nodes.size());
+  std::vector<uint64_t> NodeCounts(Nodes.size());
+  std::vector<EdgeCountT> EdgeCounts;
+  for (MachineBasicBlock &MBB : *F) {
+    uint64_t Node = NodeIndex[&MBB];
+    BlockFrequency BlockFreq = MBFI->getBlockFreq(&MBB);
+    // Control enters a node through its first block.
+    if (&MBB == Nodes[Node].front())
+      NodeCounts[Node] = BlockFreq.getFrequency();
+    // Approximate the size of an instruction by 4 bytes and ignore debug
+    // instructions; the exact encoding size is not known at this point.
+    for (const MachineInstr &MI : MBB.instrs())
+      if (!MI.isDebugInstr())
+        NodeSizes[Node] += 4;
+    for (MachineBasicBlock *Succ : MBB.successors()) {
+      uint64_t SuccNode = NodeIndex[Succ];
+      // Edges into the middle of a node are taken by the fallthrough anyway.
+      if (Succ != Nodes[SuccNode].front())
+        continue;
+      BlockFrequency EdgeFreq =
+          BlockFreq * MBPI->getEdgeProbability(&MBB, Succ);
+      EdgeCounts.push_back(
+          std::make_pair(std::make_pair(Node, SuccNode),
+                         EdgeFreq.getFrequency()));
+    }
+  }
+
+  LLVM_DEBUG(dbgs() << "Applying ext-tsp layout to " << F->getName()
+                    << " with " << Nodes.size() << " nodes, original score "
+                    << calcExtTspScore(NodeSizes, NodeCounts, EdgeCounts)
+                    << "\n");
+  std::vector<uint64_t> NewOrder =
+      applyExtTspLayout(NodeSizes, NodeCounts, EdgeCounts);
+  LLVM_DEBUG(dbgs() << "  optimized score "
+                    << calcExtTspScore(NewOrder, NodeSizes, NodeCounts,
+                                       EdgeCounts)
+                    << "\n");
+
+  // Replace the chains of the regular placement by one chain in the new
+  // order, which is also what optimizeBranches and alignBlocks walk.
+  BlockToChain.clear();
+  ComputedEdges.clear();
+  ChainAllocator.DestroyAll();
+  BlockChain *FunctionChain =
+      new (ChainAllocator.Allocate()) BlockChain(BlockToChain, &F->front());
+  for (uint64_t Node : NewOrder)
+    for (MachineBasicBlock *MBB : Nodes[Node])
+      if (MBB != &F->front())
+        FunctionChain->merge(MBB, nullptr);
+
+  spliceFunctionChain(*FunctionChain);
 }
 
 void MachineBlockPlacement::optimizeBranches() {
@@ -3121,6 +3240,9 @@ bool MachineBlockPlacement::runOnMachineFunction(MachineFunction &MF) {
     }
   }
 
+  if (shouldApplyExtTsp())
+    applyExtTsp();
+
   optimizeBranches();
   alignBlocks();
 
@@ -0,0 +1,337 @@
+//===-- MachineFunctionSplitter.cpp - Split cold code out of functions ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// \file
+// Uses profile information to split out the cold blocks of a machine function.
+// The blocks the profile says never (or hardly ever) execute are moved to the
+// end of the function and marked so that the AsmPrinter emits them into a
+// separate section, keeping the hot part of the function dense in the I-cache
+// and iTLB.
+//
+// Once moved, the cold part is covered by a frame description of its own. The
+// pass restates the call frame information that holds at the boundary at the
+// start of the cold part, so that unwinding through it stays correct.
+//
+// Functions with landing pads, jump tables or debug information are left
+// alone, as are functions whose frame information cannot be restated.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/CodeGen/TargetFrameLowering.h"
+#include "llvm/CodeGen/TargetInstrInfo.h"
+#include "llvm/CodeGen/TargetSubtargetInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/MC/MCDwarf.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "machine-function-splitter"
+
+STATISTIC(NumFunctionsSplit, "Number of functions split");
+STATISTIC(NumColdBlocks, "Number of blocks moved to a cold section");
+
+static cl::opt<unsigned> MFSMinColdBlocks(
+    "mfs-min-cold-blocks",
+    cl::desc("Minimum number of cold blocks a function needs to be split"),
+    cl::init(1), cl::Hidden);
+
+namespace {
+
+/// The call frame information rules that are in effect at some point of a
+/// function.
+struct CFIState {
+  unsigned CFARegister;
+  /// Positive offset from CFARegister to the CFA.
+  int CFAOffset;
+  /// The CFI instruction (as an index into the frame instructions) that last
+  /// set the rule of each register.
+  MapVector<unsigned, unsigned> RegisterRules;
+
+  bool operator==(const CFIState &Other) const {
+    return CFARegister == Other.CFARegister && CFAOffset == Other.CFAOffset &&
+           RegisterRules.size() == Other.RegisterRules.size() &&
+           std::equal(RegisterRules.begin(), RegisterRules.end(),
+                      Other.RegisterRules.begin());
+  }
+  bool operator!=(const CFIState &Other) const { return !(*this == Other); }
+};
+
+class MachineFunctionSplitter : public MachineFunctionPass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  MachineFunctionSplitter() : MachineFunctionPass(ID) {
+    initializeMachineFunctionSplitterPass(*PassRegistry::getPassRegistry());
+  }
+
+  StringRef getPassName() const override {
+    return "Machine Function Splitter";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().set(
+        MachineFunctionProperties::Property::NoVRegs);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+private:
+  bool canSplit(const MachineFunction &MF) const;
+  bool computeCFIState(MachineFunction &MF, const MachineBasicBlock &Target,
+                       CFIState &State) const;
+};
+
+} // end anonymous namespace
+
+char MachineFunctionSplitter::ID = 0;
+char &llvm::MachineFunctionSplitterID = MachineFunctionSplitter::ID;
+
+INITIALIZE_PASS_BEGIN(MachineFunctionSplitter, DEBUG_TYPE,
+                      "Split machine functions using profile information",
+                      false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(MachineFunctionSplitter, DEBUG_TYPE,
+                    "Split machine functions using profile information", false,
+                    false)
+
+MachineFunctionPass *llvm::createMachineFunctionSplitterPass() {
+  return new MachineFunctionSplitter();
+}
+
+/// Return true if the AsmPrinter knows how to emit \p MF in two parts.
+bool MachineFunctionSplitter::canSplit(const MachineFunction &MF) const {
+  const Triple &TT = MF.getTarget().getTargetTriple();
+  if (TT.getArch() != Triple::x86_64 || !TT.isOSBinFormatELF())
+    return false;
+
+  const Function &F = MF.getFunction();
+  // The user decided where the function goes; don't second-guess it. Functions
+  // that are cold as a whole are placed in .text.unlikely already.
+  if (F.hasSection() || F.hasFnAttribute("implicit-section-name"))
+    return false;
+  if (Optional<StringRef> Prefix = F.getSectionPrefix())
+    if (*Prefix == ".unlikely")
+      return false;
+
+  // The exception table, the jump tables and the debug ranges of a function
+  // all assume it is contiguous.
+  if (F.hasPersonalityFn() || !MF.getLandingPads().empty())
+    return false;
+  if (const MachineJumpTableInfo *JTI = MF.getJumpTableInfo())
+    if (!JTI->isEmpty())
+      return false;
+  if (F.getSubprogram())
+    return false;
+
+  // computeCFIState only understands the instructions a regular prologue and
+  // epilogue is made of.
+  for (const MCCFIInstruction &CFI : MF.getFrameInstructions()) {
+    switch (CFI.getOperation()) {
+    case MCCFIInstruction::OpDefCfa:
+    case MCCFIInstruction::OpDefCfaOffset:
+    case MCCFIInstruction::OpDefCfaRegister:
+    case MCCFIInstruction::OpAdjustCfaOffset:
+    case MCCFIInstruction::OpOffset:
+    case MCCFIInstruction::OpRegister:
+    case MCCFIInstruction::OpRestore:
+    case MCCFIInstruction::OpUndefined:
+    case MCCFIInstruction::OpSameValue:
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Compute the call frame information rules in effect on entry to \p Target.
+/// Return false if the rules differ between paths reaching it.
+bool MachineFunctionSplitter::computeCFIState(MachineFunction &MF,
+                                              const MachineBasicBlock &Target,
+                                              CFIState &State) const {
+  const TargetFrameLowering *TFL = MF.getSubtarget().getFrameLowering();
+  const std::vector<MCCFIInstruction> &Instrs = MF.getFrameInstructions();
+
+  SmallVector<Optional<CFIState>, 32> Incoming(MF.getNumBlockIDs());
+  SmallVector<MachineBasicBlock *, 32> Worklist;
+  Incoming[MF.front().getNumber()] =
+      CFIState{TFL->getInitialCFARegister(MF), TFL->getInitialCFAOffset(MF),
+               MapVector<unsigned, unsigned>()};
+  Worklist.push_back(&MF.front());
+
+  while (!Worklist.empty()) {
+    MachineBasicBlock *MBB = Worklist.pop_back_val();
+    CFIState Out = *Incoming[MBB->getNumber()];
+    for (const MachineInstr &MI : *MBB) {
+      if (!MI.isCFIInstruction())
+        continue;
+      unsigned CFIIndex = MI.getOperand(0).getCFIIndex();
+      const MCCFIInstruction &CFI = Instrs[CFIIndex];
+      switch (CFI.getOperation()) {
+      case MCCFIInstruction::OpDefCfa:
+        Out.CFARegister = CFI.getRegister();
+        Out.CFAOffset = CFI.getOffset();
+        break;
+      case MCCFIInstruction::OpDefCfaOffset:
+        Out.CFAOffset = CFI.getOffset();
+        break;
+      case MCCFIInstruction::OpDefCfaRegister:
+        Out.CFARegister = CFI.getRegister();
+        break;
+      case MCCFIInstruction::OpAdjustCfaOffset:
+        Out.CFAOffset += CFI.getOffset();
+        break;
+      case MCCFIInstruction::OpRestore:
+        Out.RegisterRules.erase(CFI.getRegister());
+        break;
+      default:
+        Out.RegisterRules[CFI.getRegister()] = CFIIndex;
+        break;
+      }
+    }
+
+    for (MachineBasicBlock *Succ : MBB->successors()) {
+      Optional<CFIState> &In = Incoming[Succ->getNumber()];
+      if (!In) {
+        In = Out;
+        Worklist.push_back(Succ);
+        continue;
+      }
+      if (*In != Out)
+        return false;
+    }
+  }
+
+  if (!Incoming[Target.getNumber()])
+    return false;
+  State = std::move(*Incoming[Target.getNumber()]);
+  return true;
+}
+
+bool MachineFunctionSplitter::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()) || !MF.getFunction().hasProfileData())
+    return false;
+  if (!canSplit(MF))
+    return false;
+
+  const MachineBlockFrequencyInfo &MBFI =
+      getAnalysis<MachineBlockFrequencyInfo>();
+  ProfileSummaryInfo *PSI =
+      &getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
+  if (!PSI->hasProfileSummary())
+    return false;
+
+  auto IsCold = [&](const MachineBasicBlock &MBB) {
+    if (&MBB == &MF.front() || MBB.isEHPad())
+      return false;
+    Optional<uint64_t> Count = MBFI.getBlockProfileCount(&MBB);
+    return Count && PSI->isColdCount(*Count);
+  };
+
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+  unsigned NumCold = 0;
+  for (MachineBasicBlock &MBB : MF) {
+    bool Cold = IsCold(MBB);
+    MBB.setIsColdSection(Cold);
+    NumCold += Cold;
+  }
+  auto ClearMarks = [&]() {
+    for (MachineBasicBlock &MBB : MF)
+      MBB.setIsColdSection(false);
+    return false;
+  };
+  if (NumCold < MFSMinColdBlocks)
+    return ClearMarks();
+
+  // A block that falls through in a way analyzeBranch cannot describe has to
+  // stay in front of its layout successor.
+  for (MachineBasicBlock &MBB : MF) {
+    MachineBasicBlock *Next = MBB.getNextNode();
+    if (!Next || MBB.isColdSection() == Next->isColdSection() ||
+        !MBB.canFallThrough())
+      continue;
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    if (TII->analyzeBranch(MBB, TBB, FBB, Cond))
+      return ClearMarks();
+  }
+
+  // The cold part starts with the first cold block in the current order.
+  MachineBasicBlock *FirstCold = nullptr;
+  for (MachineBasicBlock &MBB : MF) {
+    if (MBB.isColdSection()) {
+      FirstCold = &MBB;
+      break;
+    }
+  }
+  CFIState State;
+  if (!computeCFIState(MF, *FirstCold, State)) {
+    LLVM_DEBUG(dbgs() << "Inconsistent frame information in " << MF.getName()
+                      << ", not splitting\n");
+    return ClearMarks();
+  }
+
+  // Move the cold blocks to the end, keeping the relative order within each
+  // part, and repair the branches broken by the move.
+  MF.sort([](MachineBasicBlock &X, MachineBasicBlock &Y) {
+    return !X.isColdSection() && Y.isColdSection();
+  });
+  for (MachineBasicBlock &MBB : MF) {
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    if (!TII->analyzeBranch(MBB, TBB, FBB, Cond))
+      MBB.updateTerminator();
+  }
+
+  // The hot part may not fall through into the cold one; the two end up in
+  // different sections.
+  MachineBasicBlock *LastHot = FirstCold->getPrevNode();
+  if (LastHot->canFallThrough() && LastHot->isSuccessor(FirstCold))
+    TII->insertUnconditionalBranch(*LastHot, FirstCold, DebugLoc());
+
+  // The cold part gets a frame description of its own, which starts out with
+  // the rules of the CIE. Restate the rules in effect at the boundary.
+  MachineBasicBlock::iterator InsertPt = FirstCold->begin();
+  unsigned CFIIndex = MF.addFrameInst(MCCFIInstruction::createDefCfa(
+      nullptr, State.CFARegister, -State.CFAOffset));
+  BuildMI(*FirstCold, InsertPt, DebugLoc(),
+          TII->get(TargetOpcode::CFI_INSTRUCTION))
+      .addCFIIndex(CFIIndex);
+  for (const auto &Rule : State.RegisterRules)
+    BuildMI(*FirstCold, InsertPt, DebugLoc(),
+            TII->get(TargetOpcode::CFI_INSTRUCTION))
+        .addCFIIndex(Rule.second);
+
+  ++NumFunctionsSplit;
+  NumColdBlocks += NumCold;
+  return true;
+}
@@ -17,6 +17,7 @@
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LLVMRemarkStreamer.h"
 #include "llvm/InitializePasses.h"
 
 using namespace llvm;
@@ -62,6 +63,16 @@ void MachineOptimizationRemarkEmitter::emit(
   Ctx.diagnose(OptDiag);
 }
 
+bool MachineOptimizationRemarkEmitter::allowExtraAnalysis(
+    StringRef PassName) const {
+  // Same as OptimizationRemarkEmitter::allowExtraAnalysis.
+  LLVMContext &Ctx = MF.getFunction().getContext();
+  if (LLVMRemarkStreamer *RS = Ctx.getLLVMRemarkStreamer())
+    if (RS->matchesFilter(PassName))
+      return true;
+  return Ctx.getDiagHandlerPtr()->isAnyRemarkEnabled(PassName);
+}
+
 MachineOptimizationRemarkEmitterPass::MachineOptimizationRemarkEmitterPass()
     : MachineFunctionPass(ID) {
   initializeMachineOptimizationRemarkEmitterPassPass(
@@ -12,7 +12,9 @@
 /// This works by placing every instruction from every basic block in a
 /// suffix tree, and repeatedly querying that tree for repeated sequences of
 /// instructions. If a sequence of instructions appears often, then it ought
-/// to be beneficial to pull out into a function.
+/// to be beneficial to pull out into a function. With
+/// -outliner-use-suffix-array, a suffix array and its LCP array are used in
+/// place of the suffix tree; they find the same sequences using less memory.
 ///
 /// The MachineOutliner communicates with a given target using hooks defined in
 /// TargetInstrInfo.h. The target supplies the outliner with information on how
@@ -57,6 +59,7 @@
 #include "llvm/CodeGen/MachineOutliner.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
@@ -72,6 +75,8 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 #include <tuple>
@@ -96,6 +101,42 @@ static cl::opt<bool> EnableLinkOnceODROutlining(
     cl::desc("Enable the machine outliner on linkonceodr functions"),
     cl::init(false));
 
+// Name outlined functions after a hash of their contents and give them
+// linkonce_odr linkage. Each ThinLTO backend outlines on its own, but when
+// two backends outline the same sequence this way, the linker keeps only one
+// copy of the outlined function.
+static cl::opt<bool> OutlinerLinkOnceODRFunctions(
+    "outliner-linkonceodr-functions", cl::Hidden,
+    cl::desc("Give outlined functions content-based names and linkonce_odr "
+             "linkage so that identical ones are merged at link time"),
+    cl::init(false));
+
+// Find repeated sequences with a suffix array and an LCP array instead of a
+// suffix tree. Both find the same sequences, but the suffix array needs a
+// small, fixed number of words per instruction, which matters on very large
+// modules.
+static cl::opt<bool> OutlinerUseSuffixArray(
+    "outliner-use-suffix-array", cl::Hidden,
+    cl::desc("Use a suffix array to find repeated instruction sequences"),
+    cl::init(false));
+
+// Evaluate the target cost model for the repeated sequences on several
+// threads. getOutliningCandidateInfo only inspects the candidates it is
+// given, so sequences can be evaluated independently; the results are
+// merged in discovery order, so the output doesn't depend on the thread
+// schedule.
+static cl::opt<bool> OutlinerParallelBenefit(
+    "outliner-parallel-benefit", cl::Hidden,
+    cl::desc("Compute the benefit of outlining candidates in parallel"),
+    cl::init(false));
+
+// Run the outliner again on the result of the previous round. Later rounds
+// can outline from (and across) the calls the previous round inserted.
+static cl::opt<unsigned> OutlinerReruns(
+    "machine-outliner-reruns", cl::init(0), cl::Hidden,
+    cl::desc(
+        "Number of times to rerun the outliner after the initial outline"));
+
 namespace {
 
 /// Represents an undefined index in the suffix tree.
@@ -605,6 +646,210 @@ public:
   iterator end() { return iterator(nullptr); }
 };
 
+/// Compute the suffix array of \p Str, whose elements are all in
+/// [0, \p Upper], using the SA-IS algorithm by Nong, Zhang and Chan, "Linear
+/// Suffix Array Construction by Almost Pure Induced-Sorting".
+static std::vector<int> buildSuffixArray(ArrayRef<int> Str, int Upper) {
+  int N = Str.size();
+  if (N == 0)
+    return {};
+  if (N == 1)
+    return {0};
+  if (N == 2)
+    return Str[0] < Str[1] ? std::vector<int>{0, 1} : std::vector<int>{1, 0};
+
+  // Classify each suffix as S-type (smaller than the next suffix) or L-type.
+  std::vector<int> SA(N);
+  std::vector<bool> IsS(N);
+  for (int I = N - 2; I >= 0; --I)
+    IsS[I] = Str[I] == Str[I + 1] ? IsS[I + 1] : Str[I] < Str[I + 1];
+
+  // Bucket boundaries: LStart[C] is where the L-type suffixes starting with C
+  // begin, SStart[C] is where the S-type ones do.
+  std::vector<int> LStart(Upper + 1), SStart(Upper + 1);
+  for (int I = 0; I < N; ++I) {
+    if (!IsS[I])
+      SStart[Str[I]]++;
+    else
+      LStart[Str[I] + 1]++;
+  }
+  for (int C = 0; C <= Upper; ++C) {
+    SStart[C] += LStart[C];
+    if (C < Upper)
+      LStart[C + 1] += SStart[C];
+  }
+
+  // Sort all suffixes from the sorted (or approximately sorted) LMS-suffixes.
+  auto Induce = [&](ArrayRef<int> LMS) {
+    std::fill(SA.begin(), SA.end(), -1);
+    std::vector<int> Buf(SStart);
+    for (int D : LMS)
+      if (D != N)
+        SA[Buf[Str[D]]++] = D;
+    Buf = LStart;
+    SA[Buf[Str[N - 1]]++] = N - 1;
+    for (int I = 0; I < N; ++I) {
+      int V = SA[I];
+      if (V >= 1 && !IsS[V - 1])
+        SA[Buf[Str[V - 1]]++] = V - 1;
+    }
+    Buf = LStart;
+    for (int I = N - 1; I >= 0; --I) {
+      int V = SA[I];
+      if (V >= 1 && IsS[V - 1])
+        SA[--Buf[Str[V - 1] + 1]] = V - 1;
+    }
+  };
+
+  // Find the LMS-suffixes: S-type suffixes preceded by an L-type one.
+  std::vector<int> LMSMap(N + 1, -1);
+  std::vector<int> LMS;
+  for (int I = 1; I < N; ++I) {
+    if (!IsS[I - 1] && IsS[I]) {
+      LMSMap[I] = LMS.size();
+      LMS.push_back(I);
+    }
+  }
+  int M = LMS.size();
+
+  Induce(LMS);
+  if (M == 0)
+    return SA;
+
+  // Name the LMS-substrings in sorted order. If two of them get the same
+  // name, sort the LMS-suffixes recursively on the string of names.
+  std::vector<int> SortedLMS;
+  SortedLMS.reserve(M);
+  for (int V : SA)
+    if (LMSMap[V] != -1)
+      SortedLMS.push_back(V);
+
+  std::vector<int> Names(M);
+  int NameUpper = 0;
+  Names[LMSMap[SortedLMS[0]]] = 0;
+  for (int I = 1; I < M; ++I) {
+    int L = SortedLMS[I - 1], R = SortedLMS[I];
+    int EndL = LMSMap[L] + 1 < M ? LMS[LMSMap[L] + 1] : N;
+    int EndR = LMSMap[R] + 1 < M ? LMS[LMSMap[R] + 1] : N;
+    bool Same = true;
+    if (EndL - L != EndR - R) {
+      Same = false;
+    } else {
+      while (L < EndL && Str[L] == Str[R]) {
+        ++L;
+        ++R;
+      }
+      if (L == N || Str[L] != Str[R])
+        Same = false;
+    }
+    if (!Same)
+      ++NameUpper;
+    Names[LMSMap[SortedLMS[I]]] = NameUpper;
+  }
+
+  std::vector<int> NamesSA = buildSuffixArray(Names, NameUpper);
+  for (int I = 0; I < M; ++I)
+    SortedLMS[I] = LMS[NamesSA[I]];
+  Induce(SortedLMS);
+  return SA;
+}
+
+/// Find the same repeated substrings of \p Str that a \p SuffixTree over
+/// \p Str would find, using a suffix array and its LCP array.
+///
+/// Every internal node of the suffix tree corresponds to an LCP interval of
+/// the suffix array, and its leaf children are the suffixes inside the
+/// interval which aren't inside one of its child intervals. The intervals are
+/// enumerated bottom-up with a stack, so apart from the result this only
+/// needs a few words per element of \p Str.
+static std::vector<SuffixTree::RepeatedSubstring>
+findRepeatedSubstrings(ArrayRef<unsigned> Str, unsigned MinLength) {
+  std::vector<SuffixTree::RepeatedSubstring> Result;
+  int N = Str.size();
+  if (N < 2)
+    return Result;
+
+  // Rename the elements to a dense alphabet [0, Upper] for SA-IS. The
+  // illegal instruction numbers are unique, so the alphabet can be as large
+  // as the string.
+  std::vector<unsigned> Alphabet(Str.begin(), Str.end());
+  llvm::sort(Alphabet);
+  Alphabet.erase(std::unique(Alphabet.begin(), Alphabet.end()),
+                 Alphabet.end());
+  std::vector<int> Dense(N);
+  for (int I = 0; I < N; ++I)
+    Dense[I] =
+        std::lower_bound(Alphabet.begin(), Alphabet.end(), Str[I]) -
+        Alphabet.begin();
+  int Upper = Alphabet.size() - 1;
+  std::vector<unsigned>().swap(Alphabet);
+
+  std::vector<int> SA = buildSuffixArray(Dense, Upper);
+
+  // Kasai's algorithm: LCP[I] is the length of the longest common prefix of
+  // the suffixes at SA[I - 1] and SA[I], and LCP[0] is 0. LCP[N] is a
+  // sentinel which closes every open interval.
+  std::vector<int> LCP(N + 1);
+  {
+    std::vector<int> Rank(N);
+    for (int I = 0; I < N; ++I)
+      Rank[SA[I]] = I;
+    for (int I = 0, H = 0; I < N; ++I) {
+      if (Rank[I] == 0) {
+        H = 0;
+        continue;
+      }
+      int J = SA[Rank[I] - 1];
+      while (I + H < N && J + H < N && Dense[I + H] == Dense[J + H])
+        ++H;
+      LCP[Rank[I]] = H;
+      if (H > 0)
+        --H;
+    }
+  }
+  std::vector<int>().swap(Dense);
+
+  // An open LCP interval. Its leaves are the entries of Leaves from
+  // FirstLeaf on; the leaves of its child intervals were removed from there
+  // when those were closed.
+  struct Interval {
+    int Length;
+    unsigned FirstLeaf;
+  };
+  std::vector<Interval> Stack = {{0, 0}};
+  std::vector<int> Leaves;
+
+  for (int K = 0; K < N; ++K) {
+    // On entry, the top of the stack is the interval of length LCP[K] which
+    // holds suffix K - 1 and suffix K. The leaf belongs to the deeper of the
+    // intervals it shares with its neighbours.
+    if (LCP[K + 1] > LCP[K])
+      Stack.push_back({LCP[K + 1], static_cast<unsigned>(Leaves.size())});
+    Leaves.push_back(K);
+
+    while (Stack.back().Length > LCP[K + 1]) {
+      Interval I = Stack.back();
+      Stack.pop_back();
+      if (static_cast<unsigned>(I.Length) >= MinLength &&
+          Leaves.size() - I.FirstLeaf >= 2) {
+        SuffixTree::RepeatedSubstring RS;
+        RS.Length = I.Length;
+        for (unsigned L = I.FirstLeaf, E = Leaves.size(); L != E; ++L)
+          RS.StartIndices.push_back(SA[Leaves[L]]);
+        Result.push_back(std::move(RS));
+      }
+      Leaves.resize(I.FirstLeaf);
+
+      // The closed interval is a child of an interval of length LCP[K + 1]
+      // which may not have been opened yet.
+      if (Stack.back().Length < LCP[K + 1])
+        Stack.push_back({LCP[K + 1], static_cast<unsigned>(Leaves.size())});
+    }
+  }
+
+  return Result;
+}
+
 /// Maps \p MachineInstrs to unsigned integers and stores the mappings.
 struct InstructionMapper {
 
@@ -847,6 +1092,10 @@ struct MachineOutliner : public ModulePass {
   /// Set when the pass is constructed in TargetPassConfig.
   bool RunOnAllFunctions = true;
 
+  /// The current outlining round; 0 for the initial one. Used to keep the
+  /// names of functions created in later rounds unique.
+  unsigned OutlineRepeatedNum = 0;
+
   StringRef getPassName() const override { return "Machine Outliner"; }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
@@ -1012,14 +1261,56 @@ void MachineOutliner::emitOutlinedFunctionRemark(OutlinedFunction &OF) {
 void MachineOutliner::findCandidates(
     InstructionMapper &Mapper, std::vector<OutlinedFunction> &FunctionList) {
   FunctionList.clear();
-  SuffixTree ST(Mapper.UnsignedVec);
-
-  // First, find all of the repeated substrings in the tree of minimum length
-  // 2.
-  std::vector<Candidate> CandidatesForRepeatedSeq;
-  for (auto It = ST.begin(), Et = ST.end(); It != Et; ++It) {
-    CandidatesForRepeatedSeq.clear();
-    SuffixTree::RepeatedSubstring RS = *It;
+
+  // Candidate sets whose cost hasn't been computed yet. When the cost model
+  // runs in parallel, sets are collected in batches so that only a bounded
+  // number of them is alive at any time.
+  const size_t BatchSize = OutlinerParallelBenefit ? 1024 : 1;
+  std::vector<std::vector<Candidate>> PendingCandidates;
+  std::vector<unsigned> PendingLengths;
+
+  auto EvaluatePending = [&]() {
+    std::vector<OutlinedFunction> Results(PendingCandidates.size());
+    auto GetCandidateInfo = [&](size_t I) {
+      // Arbitrarily choose a TII from the first candidate.
+      // FIXME: Should getOutliningCandidateInfo move to TargetMachine?
+      const TargetInstrInfo *TII =
+          PendingCandidates[I][0].getMF()->getSubtarget().getInstrInfo();
+      Results[I] = TII->getOutliningCandidateInfo(PendingCandidates[I]);
+    };
+    if (PendingCandidates.size() > 1)
+      parallel::for_each_n(parallel::par, size_t(0), PendingCandidates.size(),
+                           GetCandidateInfo);
+    else if (!PendingCandidates.empty())
+      GetCandidateInfo(0);
+
+    for (size_t I = 0, E = Results.size(); I != E; ++I) {
+      OutlinedFunction &OF = Results[I];
+
+      // If we deleted too many candidates, then there's nothing worth
+      // outlining.
+      // FIXME: This should take target-specified instruction sizes into
+      // account.
+      if (OF.Candidates.size() < 2)
+        continue;
+
+      // Is it better to outline this candidate than not?
+      if (OF.getBenefit() < 1) {
+        emitNotOutliningCheaperRemark(PendingLengths[I], PendingCandidates[I],
+                                      OF);
+        continue;
+      }
+
+      for (Candidate &C : OF.Candidates)
+        C.FunctionIdx = FunctionList.size();
+      FunctionList.push_back(std::move(OF));
+    }
+    PendingCandidates.clear();
+    PendingLengths.clear();
+  };
+
+  auto AddRepeatedSubstring = [&](const SuffixTree::RepeatedSubstring &RS) {
+    std::vector<Candidate> CandidatesForRepeatedSeq;
     unsigned StringLen = RS.Length;
     for (const unsigned &StartIdx : RS.StartIndices) {
       unsigned EndIdx = StartIdx + StringLen - 1;
@@ -1063,33 +1354,86 @@ void MachineOutliner::findCandidates(
       }
     }
 
-    // We've found something we might want to outline.
-    // Create an OutlinedFunction to store it and check if it'd be beneficial
-    // to outline.
+    // We've found something we might want to outline. Queue it up to check if
+    // it'd be beneficial to outline.
     if (CandidatesForRepeatedSeq.size() < 2)
-      continue;
-
-    // Arbitrarily choose a TII from the first candidate.
-    // FIXME: Should getOutliningCandidateInfo move to TargetMachine?
-    const TargetInstrInfo *TII =
-        CandidatesForRepeatedSeq[0].getMF()->getSubtarget().getInstrInfo();
+      return;
 
-    OutlinedFunction OF =
-        TII->getOutliningCandidateInfo(CandidatesForRepeatedSeq);
+    PendingCandidates.push_back(std::move(CandidatesForRepeatedSeq));
+    PendingLengths.push_back(StringLen);
+    if (PendingCandidates.size() >= BatchSize)
+      EvaluatePending();
+  };
 
-    // If we deleted too many candidates, then there's nothing worth outlining.
-    // FIXME: This should take target-specified instruction sizes into account.
-    if (OF.Candidates.size() < 2)
-      continue;
+  // First, find all of the repeated substrings of minimum length 2.
+  const unsigned MinLength = 2;
+  if (OutlinerUseSuffixArray) {
+    for (const SuffixTree::RepeatedSubstring &RS :
+         findRepeatedSubstrings(Mapper.UnsignedVec, MinLength))
+      AddRepeatedSubstring(RS);
+  } else {
+    SuffixTree ST(Mapper.UnsignedVec);
+    for (auto It = ST.begin(), Et = ST.end(); It != Et; ++It)
+      AddRepeatedSubstring(*It);
+  }
+  EvaluatePending();
+}
 
-    // Is it better to outline this candidate than not?
-    if (OF.getBenefit() < 1) {
-      emitNotOutliningCheaperRemark(StringLen, CandidatesForRepeatedSeq, OF);
-      continue;
+/// Compute a name for the outlined function \p MF from its contents, so that
+/// functions outlined to the same code in different modules get the same
+/// name. Returns false if the contents refer to anything local to the module
+/// or function, in which case equal names wouldn't mean equal functions.
+static bool getContentBasedName(const MachineFunction &MF,
+                                SmallString<64> &Name) {
+  const Function &F = MF.getFunction();
+  std::string Contents;
+  raw_string_ostream OS(Contents);
+  OS << F.getParent()->getTargetTriple() << '\n';
+  for (StringRef Attr : {"target-cpu", "target-features"})
+    if (F.hasFnAttribute(Attr))
+      OS << F.getFnAttribute(Attr).getValueAsString() << '\n';
+
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+  const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
+  for (const MachineBasicBlock &MBB : MF) {
+    for (const MachineInstr &MI : MBB) {
+      for (const MachineOperand &MO : MI.operands()) {
+        switch (MO.getType()) {
+        case MachineOperand::MO_GlobalAddress:
+          if (MO.getGlobal()->hasLocalLinkage())
+            return false;
+          break;
+        case MachineOperand::MO_MachineBasicBlock:
+        case MachineOperand::MO_FrameIndex:
+        case MachineOperand::MO_ConstantPoolIndex:
+        case MachineOperand::MO_TargetIndex:
+        case MachineOperand::MO_JumpTableIndex:
+        case MachineOperand::MO_BlockAddress:
+        case MachineOperand::MO_MCSymbol:
+          return false;
+        default:
+          break;
+        }
+      }
+      // Print the instruction without its memory operands. They only refer
+      // to the IR values the access came from, whose names can differ
+      // between modules that have the same code.
+      OS << TII->getName(MI.getOpcode()) << ' ' << MI.getFlags();
+      for (const MachineOperand &MO : MI.operands()) {
+        OS << ' ';
+        MO.print(OS, TRI);
+      }
+      OS << '\n';
     }
-
-    FunctionList.push_back(OF);
   }
+
+  MD5 Hash;
+  Hash.update(OS.str());
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  Name = "OUTLINED_FUNCTION_";
+  Name += Result.digest();
+  return true;
 }
 
 MachineFunction *MachineOutliner::createOutlinedFunction(
@@ -1098,7 +1442,10 @@ MachineFunction *MachineOutliner::createOutlinedFunction(
   // Create the function name. This should be unique.
   // FIXME: We should have a better naming scheme. This should be stable,
   // regardless of changes to the outliner's cost model/traversal order.
-  std::string FunctionName = ("OUTLINED_FUNCTION_" + Twine(Name)).str();
+  std::string FunctionName = "OUTLINED_FUNCTION_";
+  if (OutlineRepeatedNum > 0)
+    FunctionName += std::to_string(OutlineRepeatedNum + 1) + "_";
+  FunctionName += std::to_string(Name);
 
   // Create the function using an IR-level function.
   LLVMContext &C = M.getContext();
@@ -1156,6 +1503,19 @@ MachineFunction *MachineOutliner::createOutlinedFunction(
   MF.getProperties().reset(MachineFunctionProperties::Property::TracksLiveness);
   MF.getRegInfo().freezeReservedRegs(MF);
 
+  // If asked to, make the function mergeable with identical functions
+  // outlined in other modules. If this module already has one with the same
+  // contents, Function::setName gives this one a unique name, which is
+  // harmless.
+  SmallString<64> ContentName;
+  if (OutlinerLinkOnceODRFunctions && getContentBasedName(MF, ContentName)) {
+    F->setName(ContentName);
+    F->setLinkage(GlobalValue::LinkOnceODRLinkage);
+    F->setVisibility(GlobalValue::HiddenVisibility);
+    if (Triple(M.getTargetTriple()).supportsCOMDAT())
+      F->setComdat(M.getOrInsertComdat(F->getName()));
+  }
+
   // If there's a DISubprogram associated with this outlined function, then
   // emit debug info for the outlined function.
   if (DISubprogram *SP = getSubprogramOrNull(OF)) {
@@ -1424,8 +1784,20 @@ bool MachineOutliner::runOnModule(Module &M) {
   // Number to append to the current outlined function.
   unsigned OutlinedFunctionNum = 0;
 
+  OutlineRepeatedNum = 0;
   if (!doOutline(M, OutlinedFunctionNum))
     return false;
+
+  for (unsigned I = 0; I < OutlinerReruns; ++I) {
+    OutlinedFunctionNum = 0;
+    OutlineRepeatedNum++;
+    if (!doOutline(M, OutlinedFunctionNum)) {
+      LLVM_DEBUG(dbgs() << "Did not outline on iteration " << I + 2
+                        << " out of " << OutlinerReruns + 1 << "\n");
+      break;
+    }
+  }
+
   return true;
 }
 
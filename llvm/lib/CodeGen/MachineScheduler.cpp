@@ -29,6 +29,7 @@
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineOperand.h"
+#include "llvm/CodeGen/MachineOptimizationRemarkEmitter.h"
 #include "llvm/CodeGen/MachinePassRegistry.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/Passes.h"
@@ -120,6 +121,20 @@ static cl::opt<unsigned> ReadyListLimit("misched-limit", cl::Hidden,
 static cl::opt<bool> EnableRegPressure("misched-regpressure", cl::Hidden,
   cl::desc("Enable register pressure scheduling."), cl::init(true));
 
+// Building the DAG for a region is superlinear in its size and so is
+// scheduling it with register pressure tracking. These two limits trade
+// schedule quality for compile time on very large regions: above the first,
+// the region isn't tracking pressure; above the second, it isn't scheduled
+// at all and keeps its original order. A limit of 0 means no limit.
+static cl::opt<unsigned> PressureRegionLimit("misched-pressure-region-limit",
+  cl::Hidden, cl::init(0),
+  cl::desc("Don't track register pressure in regions with more than N "
+           "instructions"));
+
+static cl::opt<unsigned> HugeRegionLimit("misched-huge-region-limit",
+  cl::Hidden, cl::init(0),
+  cl::desc("Don't schedule regions with more than N instructions"));
+
 static cl::opt<bool> EnableCyclicPath("misched-cyclicpath", cl::Hidden,
   cl::desc("Enable cyclic critical path analysis."), cl::init(true));
 
@@ -561,6 +576,25 @@ void MachineSchedulerBase::scheduleRegions(ScheduleDAGInstrs &Scheduler,
         Scheduler.exitRegion();
         continue;
       }
+
+      // Leave huge regions in their original order.
+      if (HugeRegionLimit && NumRegionInstrs > HugeRegionLimit) {
+        LLVM_DEBUG(dbgs() << "Not scheduling " << printMBBReference(*MBB)
+                          << " region of " << NumRegionInstrs
+                          << " instructions\n");
+        MachineOptimizationRemarkEmitter MORE(*MF, nullptr);
+        MORE.emit([&]() {
+          MachineOptimizationRemarkAnalysis R(DEBUG_TYPE, "HugeRegion",
+                                              I->getDebugLoc(), &*MBB);
+          R << "not scheduling a region of "
+            << ore::NV("NumRegionInstrs", NumRegionInstrs)
+            << " instructions, which exceeds -misched-huge-region-limit="
+            << ore::NV("Limit", HugeRegionLimit.getValue());
+          return R;
+        });
+        Scheduler.exitRegion();
+        continue;
+      }
       LLVM_DEBUG(dbgs() << "********** MI Scheduling **********\n");
       LLVM_DEBUG(dbgs() << MF->getName() << ":" << printMBBReference(*MBB)
                         << " " << MBB->getName() << "\n  From: " << *I
@@ -2787,6 +2821,23 @@ void GenericScheduler::initPolicy(MachineBasicBlock::iterator Begin,
     RegionPolicy.ShouldTrackLaneMasks = false;
   }
 
+  if (RegionPolicy.ShouldTrackPressure && PressureRegionLimit &&
+      NumRegionInstrs > PressureRegionLimit) {
+    RegionPolicy.ShouldTrackPressure = false;
+    RegionPolicy.ShouldTrackLaneMasks = false;
+    MachineOptimizationRemarkEmitter MORE(*Begin->getMF(), nullptr);
+    MORE.emit([&]() {
+      MachineOptimizationRemarkAnalysis R(DEBUG_TYPE, "PressureRegionLimit",
+                                          Begin->getDebugLoc(),
+                                          Begin->getParent());
+      R << "not tracking register pressure in a region of "
+        << ore::NV("NumRegionInstrs", NumRegionInstrs)
+        << " instructions, which exceeds -misched-pressure-region-limit="
+        << ore::NV("Limit", PressureRegionLimit.getValue());
+      return R;
+    });
+  }
+
   // Check -misched-topdown/bottomup can force or unforce scheduling direction.
   // e.g. -misched-bottomup=false allows scheduling in both directions.
   assert((!ForceTopDown || !ForceBottomUp) &&
@@ -84,6 +84,14 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumRegionSplitWork,
+          "Blocks visited while evaluating region split candidates");
+STATISTIC(NumRegionSplitBudgetExceeded,
+          "Number of functions that exceeded the region split budget");
+STATISTIC(NumRegionSplitsSkipped,
+          "Number of region splits skipped because of the budget");
+STATISTIC(NumRegionSplitCandsSkipped,
+          "Number of region split candidates skipped because of the budget");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -136,6 +144,14 @@ static cl::opt<bool> ConsiderLocalIntervalCost(
              "candidate when choosing the best split candidate."),
     cl::init(false));
 
+static cl::opt<unsigned> RegionSplitBudget(
+    "regalloc-region-split-budget", cl::Hidden,
+    cl::desc("Limit the work region splitting may do in a function, counted "
+             "in basic blocks visited while evaluating split candidates. "
+             "Once the budget is used up, live ranges are split around "
+             "individual blocks instead (0 = unlimited)"),
+    cl::init(0));
+
 static RegisterRegAlloc greedyRegAlloc("greedy", "greedy register allocator",
                                        createGreedyRegisterAllocator);
 
@@ -385,6 +401,10 @@ class RAGreedy : public MachineFunctionPass,
   /// class.
   SmallVector<GlobalSplitCandidate, 32> GlobalCand;
 
+  /// Work done by region splitting in the current function, in basic blocks
+  /// visited while evaluating split candidates.
+  uint64_t RegionSplitWork;
+
   enum : unsigned { NoCand = ~0u };
 
   /// Candidate map. Each edge bundle is assigned to a GlobalCand entry, or to
@@ -444,6 +464,10 @@ private:
   bool addSplitConstraints(InterferenceCache::Cursor, BlockFrequency&);
   bool addThroughConstraints(InterferenceCache::Cursor, ArrayRef<unsigned>);
   bool growRegion(GlobalSplitCandidate &Cand);
+  void chargeRegionSplitWork(uint64_t Work);
+  bool isRegionSplitBudgetExceeded() const {
+    return RegionSplitBudget && RegionSplitWork > RegionSplitBudget;
+  }
   bool splitCanCauseEvictionChain(unsigned Evictee, GlobalSplitCandidate &Cand,
                                   unsigned BBNumber,
                                   const AllocationOrder &Order);
@@ -1338,6 +1362,7 @@ bool RAGreedy::growRegion(GlobalSplitCandidate &Cand) {
     // Compute through constraints from the interference, or assume that all
     // through blocks prefer spilling when forming compact regions.
     auto NewBlocks = makeArrayRef(ActiveBlocks).slice(AddedTo);
+    chargeRegionSplitWork(NewBlocks.size());
     if (Cand.PhysReg) {
       if (!addThroughConstraints(Cand.Intf, NewBlocks))
         return false;
@@ -1354,6 +1379,19 @@ bool RAGreedy::growRegion(GlobalSplitCandidate &Cand) {
   return true;
 }
 
+/// chargeRegionSplitWork - Account for work done evaluating region split
+/// candidates in the current function.
+void RAGreedy::chargeRegionSplitWork(uint64_t Work) {
+  bool WasExceeded = isRegionSplitBudgetExceeded();
+  RegionSplitWork += Work;
+  NumRegionSplitWork += Work;
+  if (!WasExceeded && isRegionSplitBudgetExceeded()) {
+    ++NumRegionSplitBudgetExceeded;
+    LLVM_DEBUG(dbgs() << "Region split budget of " << RegionSplitBudget
+                      << " exceeded in " << MF->getName() << '\n');
+  }
+}
+
 /// calcCompactRegion - Compute the set of edge bundles that should be live
 /// when splitting the current live range into compact regions.  Compact
 /// regions can be computed without looking at interference.  They are the
@@ -1812,6 +1850,11 @@ unsigned RAGreedy::tryRegionSplit(LiveInterval &VirtReg, AllocationOrder &Order,
                                   SmallVectorImpl<unsigned> &NewVRegs) {
   if (!TRI->shouldRegionSplitForVirtReg(*MF, VirtReg))
     return 0;
+  // Once the budget is used up, leave it to the cheaper per-block splitting.
+  if (isRegionSplitBudgetExceeded()) {
+    ++NumRegionSplitsSkipped;
+    return 0;
+  }
   unsigned NumCands = 0;
   BlockFrequency SpillCost = calcSpillCost();
   BlockFrequency BestCost;
@@ -1862,6 +1905,12 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
     if (IgnoreCSR && isUnusedCalleeSavedReg(PhysReg))
       continue;
 
+    // Keep the best candidate found so far when the budget runs out.
+    if (isRegionSplitBudgetExceeded()) {
+      ++NumRegionSplitCandsSkipped;
+      continue;
+    }
+
     // Discard bad candidates before we run out of interference cache cursors.
     // This will only affect register classes with a lot of registers (>32).
     if (NumCands == IntfCache.getMaxCursors()) {
@@ -1888,6 +1937,7 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
     Cand.reset(IntfCache, PhysReg);
 
     SpillPlacer->prepare(Cand.LiveBundles);
+    chargeRegionSplitWork(SA->getUseBlocks().size());
     BlockFrequency Cost;
     if (!addSplitConstraints(Cand.Intf, Cost)) {
       LLVM_DEBUG(dbgs() << printReg(PhysReg, TRI) << "\tno positive bundles\n");
@@ -3242,6 +3292,7 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   NextCascade = 1;
   IntfCache.init(MF, Matrix->getLiveUnions(), Indexes, LIS, TRI);
   GlobalCand.resize(32);  // This will grow as needed.
+  RegionSplitWork = 0;
   SetOfBrokenHints.clear();
   LastEvicted.clear();
 
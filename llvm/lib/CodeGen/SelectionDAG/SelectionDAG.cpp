@@ -22,6 +22,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Analysis/BlockFrequencyInfo.h"
@@ -95,6 +96,11 @@ void SelectionDAG::DAGNodeDeletedListener::anchor() {}
 
 #define DEBUG_TYPE "selectiondag"
 
+STATISTIC(NumSDNodes, "Number of SelectionDAG nodes created");
+STATISTIC(NumSDNodeOperandLists, "Number of SDNode operand lists created");
+STATISTIC(NumSDNodeOperandPoolBytes,
+          "Bytes reserved for the SDNode operand pool");
+
 static cl::opt<bool> EnableMemCpyDAGOpt("enable-memcpy-dag-opt",
        cl::Hidden, cl::init(true),
        cl::desc("Gang up loads and stores generated by inlining of memcpy"));
@@ -847,6 +853,8 @@ static void VerifySDNode(SDNode *N) {
 /// verification and other common operations when a new node is allocated.
 void SelectionDAG::InsertNode(SDNode *N) {
   AllNodes.push_back(N);
+  if (N != &EntryNode)
+    ++NumSDNodes;
 #ifndef NDEBUG
   N->PersistentId = NextPersistentId++;
   VerifySDNode(N);
@@ -1099,8 +1107,16 @@ SDNode *SelectionDAG::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
 
 void SelectionDAG::clear() {
   allnodes_clear();
-  OperandRecycler.clear(OperandAllocator);
-  OperandAllocator.Reset();
+  // All operand lists are back in the recycler now. Keep them there, and keep
+  // the allocator's slabs, so that the next block (or function) reuses the
+  // memory instead of allocating it again. The node allocator recycles nodes
+  // the same way, and clearing the CSE map keeps its bucket array.
+  if (OperandAllocator.getTotalMemory() > OperandPoolBytes) {
+    NumSDNodeOperandPoolBytes +=
+        OperandAllocator.getTotalMemory() - OperandPoolBytes;
+    OperandPoolBytes = OperandAllocator.getTotalMemory();
+  }
+  ShuffleMaskAllocator.Reset();
   CSEMap.clear();
 
   ExtendedValueTypeNodes.clear();
@@ -1769,7 +1785,7 @@ SDValue SelectionDAG::getVectorShuffle(EVT VT, const SDLoc &dl, SDValue N1,
   // Allocate the mask array for the node out of the BumpPtrAllocator, since
   // SDNode doesn't have access to it.  This memory will be "leaked" when
   // the node is deallocated, but recovered when the NodeAllocator is released.
-  int *MaskAlloc = OperandAllocator.Allocate<int>(NElts);
+  int *MaskAlloc = ShuffleMaskAllocator.Allocate<int>(NElts);
   llvm::copy(MaskVec, MaskAlloc);
 
   auto *N = newSDNode<ShuffleVectorSDNode>(VT, dl.getIROrder(),
@@ -9709,6 +9725,7 @@ void SelectionDAG::createOperands(SDNode *Node, ArrayRef<SDValue> Vals) {
          "too many operands to fit into SDNode");
   SDUse *Ops = OperandRecycler.allocate(
       ArrayRecycler<SDUse>::Capacity::get(Vals.size()), OperandAllocator);
+  ++NumSDNodeOperandLists;
 
   bool IsDivergent = false;
   for (unsigned I = 0; I != Vals.size(); ++I) {
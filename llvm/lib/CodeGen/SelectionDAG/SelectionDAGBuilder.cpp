@@ -6976,6 +6976,42 @@ void SelectionDAGBuilder::visitIntrinsicCall(const CallInst &I,
                              DAG.getZExtOrTrunc(Const, getCurSDLoc(), DestVT)));
     return;
   }
+  case Intrinsic::get_active_lane_mask: {
+    EVT CCVT = TLI.getValueType(DAG.getDataLayout(), I.getType());
+    SDValue Index = getValue(I.getOperand(0));
+    EVT ElementVT = Index.getValueType();
+
+    if (!TLI.shouldExpandGetActiveLaneMask(CCVT, ElementVT)) {
+      visitTargetIntrinsic(I, Intrinsic);
+      return;
+    }
+
+    if (CCVT.isScalableVector())
+      report_fatal_error("Cannot expand llvm.get.active.lane.mask with a "
+                         "scalable result type");
+
+    // Lane i is active if Index + i does not wrap and is ule the backedge-taken
+    // count, that is if Index ule BTC and i ule BTC - Index. A saturating add
+    // of the lane indices would keep the wrapped lanes active when the count
+    // is the largest unsigned value.
+    SDValue BTC = getValue(I.getOperand(1));
+    unsigned NumElts = CCVT.getVectorNumElements();
+    EVT VecTy = EVT::getVectorVT(*Context, ElementVT, NumElts);
+    SmallVector<SDValue, 16> Steps;
+    for (unsigned i = 0; i != NumElts; ++i)
+      Steps.push_back(DAG.getConstant(i, sdl, ElementVT));
+    SDValue VectorStep = DAG.getBuildVector(VecTy, sdl, Steps);
+    SDValue VectorIndex = DAG.getSplatBuildVector(VecTy, sdl, Index);
+    SDValue VectorBTC = DAG.getSplatBuildVector(VecTy, sdl, BTC);
+    SDValue Remaining = DAG.getNode(ISD::SUB, sdl, ElementVT, BTC, Index);
+    SDValue VectorRemaining = DAG.getSplatBuildVector(VecTy, sdl, Remaining);
+    SDValue InRange =
+        DAG.getSetCC(sdl, CCVT, VectorIndex, VectorBTC, ISD::SETULE);
+    SDValue StepInRange =
+        DAG.getSetCC(sdl, CCVT, VectorStep, VectorRemaining, ISD::SETULE);
+    setValue(&I, DAG.getNode(ISD::AND, sdl, CCVT, InRange, StepInRange));
+    return;
+  }
   }
 }
 
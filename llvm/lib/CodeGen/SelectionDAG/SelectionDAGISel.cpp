@@ -2505,18 +2505,28 @@ CheckChildSame(const unsigned char *MatcherTable, unsigned &MatcherIndex,
                      RecordedNodes);
 }
 
-/// CheckPatternPredicate - Implements OP_CheckPatternPredicate.
+/// CheckPatternPredicate - Implements OP_CheckPatternPredicate and its
+/// space-optimized forms OP_CheckPatternPredicate0...7.
 LLVM_ATTRIBUTE_ALWAYS_INLINE static inline bool
-CheckPatternPredicate(const unsigned char *MatcherTable, unsigned &MatcherIndex,
-                      const SelectionDAGISel &SDISel) {
-  return SDISel.CheckPatternPredicate(MatcherTable[MatcherIndex++]);
+CheckPatternPredicate(unsigned Opcode, const unsigned char *MatcherTable,
+                      unsigned &MatcherIndex, const SelectionDAGISel &SDISel) {
+  unsigned PredNo =
+      Opcode == SelectionDAGISel::OPC_CheckPatternPredicate
+          ? MatcherTable[MatcherIndex++]
+          : Opcode - SelectionDAGISel::OPC_CheckPatternPredicate0;
+  return SDISel.CheckPatternPredicate(PredNo);
 }
 
-/// CheckNodePredicate - Implements OP_CheckNodePredicate.
+/// CheckNodePredicate - Implements OP_CheckNodePredicate and its
+/// space-optimized forms OP_CheckPredicate0...7.
 LLVM_ATTRIBUTE_ALWAYS_INLINE static inline bool
-CheckNodePredicate(const unsigned char *MatcherTable, unsigned &MatcherIndex,
-                   const SelectionDAGISel &SDISel, SDNode *N) {
-  return SDISel.CheckNodePredicate(N, MatcherTable[MatcherIndex++]);
+CheckNodePredicate(unsigned Opcode, const unsigned char *MatcherTable,
+                   unsigned &MatcherIndex, const SelectionDAGISel &SDISel,
+                   SDNode *N) {
+  unsigned PredNo = Opcode == SelectionDAGISel::OPC_CheckPredicate
+                        ? MatcherTable[MatcherIndex++]
+                        : Opcode - SelectionDAGISel::OPC_CheckPredicate0;
+  return SDISel.CheckNodePredicate(N, PredNo);
 }
 
 LLVM_ATTRIBUTE_ALWAYS_INLINE static inline bool
@@ -2629,7 +2639,8 @@ static unsigned IsPredicateKnownToFail(const unsigned char *Table,
                                        bool &Result,
                                        const SelectionDAGISel &SDISel,
                   SmallVectorImpl<std::pair<SDValue, SDNode*>> &RecordedNodes) {
-  switch (Table[Index++]) {
+  unsigned Opcode = Table[Index++];
+  switch (Opcode) {
   default:
     Result = false;
     return Index-1;  // Could not evaluate this predicate.
@@ -2644,10 +2655,26 @@ static unsigned IsPredicateKnownToFail(const unsigned char *Table,
                         Table[Index-1] - SelectionDAGISel::OPC_CheckChild0Same);
     return Index;
   case SelectionDAGISel::OPC_CheckPatternPredicate:
-    Result = !::CheckPatternPredicate(Table, Index, SDISel);
+  case SelectionDAGISel::OPC_CheckPatternPredicate0:
+  case SelectionDAGISel::OPC_CheckPatternPredicate1:
+  case SelectionDAGISel::OPC_CheckPatternPredicate2:
+  case SelectionDAGISel::OPC_CheckPatternPredicate3:
+  case SelectionDAGISel::OPC_CheckPatternPredicate4:
+  case SelectionDAGISel::OPC_CheckPatternPredicate5:
+  case SelectionDAGISel::OPC_CheckPatternPredicate6:
+  case SelectionDAGISel::OPC_CheckPatternPredicate7:
+    Result = !::CheckPatternPredicate(Opcode, Table, Index, SDISel);
     return Index;
   case SelectionDAGISel::OPC_CheckPredicate:
-    Result = !::CheckNodePredicate(Table, Index, SDISel, N.getNode());
+  case SelectionDAGISel::OPC_CheckPredicate0:
+  case SelectionDAGISel::OPC_CheckPredicate1:
+  case SelectionDAGISel::OPC_CheckPredicate2:
+  case SelectionDAGISel::OPC_CheckPredicate3:
+  case SelectionDAGISel::OPC_CheckPredicate4:
+  case SelectionDAGISel::OPC_CheckPredicate5:
+  case SelectionDAGISel::OPC_CheckPredicate6:
+  case SelectionDAGISel::OPC_CheckPredicate7:
+    Result = !::CheckNodePredicate(Opcode, Table, Index, SDISel, N.getNode());
     return Index;
   case SelectionDAGISel::OPC_CheckOpcode:
     Result = !::CheckOpcode(Table, Index, N.getNode());
@@ -3038,10 +3065,19 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
       continue;
 
     case OPC_CheckPatternPredicate:
-      if (!::CheckPatternPredicate(MatcherTable, MatcherIndex, *this)) break;
+    case OPC_CheckPatternPredicate0: case OPC_CheckPatternPredicate1:
+    case OPC_CheckPatternPredicate2: case OPC_CheckPatternPredicate3:
+    case OPC_CheckPatternPredicate4: case OPC_CheckPatternPredicate5:
+    case OPC_CheckPatternPredicate6: case OPC_CheckPatternPredicate7:
+      if (!::CheckPatternPredicate(Opcode, MatcherTable, MatcherIndex, *this))
+        break;
       continue;
     case OPC_CheckPredicate:
-      if (!::CheckNodePredicate(MatcherTable, MatcherIndex, *this,
+    case OPC_CheckPredicate0: case OPC_CheckPredicate1:
+    case OPC_CheckPredicate2: case OPC_CheckPredicate3:
+    case OPC_CheckPredicate4: case OPC_CheckPredicate5:
+    case OPC_CheckPredicate6: case OPC_CheckPredicate7:
+      if (!::CheckNodePredicate(Opcode, MatcherTable, MatcherIndex, *this,
                                 N.getNode()))
         break;
       continue;
@@ -3057,8 +3093,14 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
         break;
       continue;
     }
-    case OPC_CheckComplexPat: {
-      unsigned CPNum = MatcherTable[MatcherIndex++];
+    case OPC_CheckComplexPat:
+    case OPC_CheckComplexPat0: case OPC_CheckComplexPat1:
+    case OPC_CheckComplexPat2: case OPC_CheckComplexPat3:
+    case OPC_CheckComplexPat4: case OPC_CheckComplexPat5:
+    case OPC_CheckComplexPat6: case OPC_CheckComplexPat7: {
+      unsigned CPNum = Opcode == OPC_CheckComplexPat
+                           ? MatcherTable[MatcherIndex++]
+                           : Opcode - OPC_CheckComplexPat0;
       unsigned RecNo = MatcherTable[MatcherIndex++];
       assert(RecNo < RecordedNodes.size() && "Invalid CheckComplexPat");
 
@@ -3124,6 +3166,34 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
       continue;
     }
 
+    case OPC_SwitchOpcodeTable: {
+      // The case opcodes are packed together ahead of the case bodies, each
+      // followed by the 16-bit offset of its body from the end of the table.
+      unsigned CurNodeOpcode = N.getOpcode();
+      unsigned SwitchStart = MatcherIndex-1; (void)SwitchStart;
+      unsigned NumCases = MatcherTable[MatcherIndex++];
+      if (NumCases & 128)
+        NumCases = GetVBR(NumCases, MatcherTable, MatcherIndex);
+
+      unsigned CaseIdx = MatcherIndex, TableEnd = MatcherIndex + NumCases*4;
+      for (; CaseIdx != TableEnd; CaseIdx += 4) {
+        uint16_t Opc = MatcherTable[CaseIdx];
+        Opc |= (unsigned short)MatcherTable[CaseIdx+1] << 8;
+        if (CurNodeOpcode == Opc)
+          break;
+      }
+
+      // If no cases matched, bail out.
+      if (CaseIdx == TableEnd) break;
+
+      unsigned Offset = MatcherTable[CaseIdx+2];
+      Offset |= (unsigned)MatcherTable[CaseIdx+3] << 8;
+      MatcherIndex = TableEnd + Offset;
+      LLVM_DEBUG(dbgs() << "  OpcodeSwitch from " << SwitchStart << " to "
+                        << MatcherIndex << "\n");
+      continue;
+    }
+
     case OPC_SwitchType: {
       MVT CurNodeVT = N.getSimpleValueType();
       unsigned SwitchStart = MatcherIndex-1; (void)SwitchStart;
@@ -3156,6 +3226,33 @@ void SelectionDAGISel::SelectCodeCommon(SDNode *NodeToMatch,
                         << '\n');
       continue;
     }
+
+    case OPC_SwitchTypeTable: {
+      // Like OPC_SwitchOpcodeTable, with one-byte types as the case values.
+      // TableGen never forms a type switch with an iPTR case, so the types
+      // can be compared directly.
+      MVT::SimpleValueType CurNodeVT = N.getSimpleValueType().SimpleTy;
+      unsigned SwitchStart = MatcherIndex-1; (void)SwitchStart;
+      unsigned NumCases = MatcherTable[MatcherIndex++];
+      if (NumCases & 128)
+        NumCases = GetVBR(NumCases, MatcherTable, MatcherIndex);
+
+      unsigned CaseIdx = MatcherIndex, TableEnd = MatcherIndex + NumCases*3;
+      for (; CaseIdx != TableEnd; CaseIdx += 3)
+        if (CurNodeVT == (MVT::SimpleValueType)MatcherTable[CaseIdx])
+          break;
+
+      // If no cases matched, bail out.
+      if (CaseIdx == TableEnd) break;
+
+      unsigned Offset = MatcherTable[CaseIdx+1];
+      Offset |= (unsigned)MatcherTable[CaseIdx+2] << 8;
+      MatcherIndex = TableEnd + Offset;
+      LLVM_DEBUG(dbgs() << "  TypeSwitch[" << EVT(CurNodeVT).getEVTString()
+                        << "] from " << SwitchStart << " to " << MatcherIndex
+                        << '\n');
+      continue;
+    }
     case OPC_CheckChild0Type: case OPC_CheckChild1Type:
     case OPC_CheckChild2Type: case OPC_CheckChild3Type:
     case OPC_CheckChild4Type: case OPC_CheckChild5Type:
@@ -174,6 +174,45 @@ void SlotIndexes::renumberIndexes(IndexList::iterator curItr) {
   ++NumLocalRenum;
 }
 
+void SlotIndexes::insertMachineInstrsInMaps(MachineBasicBlock::iterator Begin,
+                                            MachineBasicBlock::iterator End) {
+  if (Begin == End)
+    return;
+
+  // The new entries all go between the last indexed instruction before the
+  // range and the entry that follows it.
+  IndexList::iterator prevItr =
+      getIndexBefore(*Begin).listEntry()->getIterator();
+  IndexList::iterator nextItr = std::next(prevItr);
+
+  // Number the new entries the way inserting them one at a time would, but
+  // once the gap is used up give the remaining ones the same number and
+  // renumber just once at the end.
+  IndexList::iterator renumberItr = indexList.end();
+  unsigned newNumber = prevItr->getIndex();
+  for (MachineInstr &MI : make_range(Begin, End)) {
+    assert(!MI.isInsideBundle() &&
+           "Instructions inside bundles should use bundle start's slot.");
+    assert(mi2iMap.find(&MI) == mi2iMap.end() && "Instr already indexed.");
+    assert(!MI.isDebugInstr() && "Cannot number debug instructions.");
+
+    unsigned dist = 0;
+    if (renumberItr == indexList.end())
+      dist = ((nextItr->getIndex() - newNumber) / 2) & ~3u;
+    newNumber += dist;
+
+    IndexList::iterator newItr =
+        indexList.insert(nextItr, createEntry(&MI, newNumber));
+    if (dist == 0 && renumberItr == indexList.end())
+      renumberItr = newItr;
+    mi2iMap.insert(
+        std::make_pair(&MI, SlotIndex(&*newItr, SlotIndex::Slot_Block)));
+  }
+
+  if (renumberItr != indexList.end())
+    renumberIndexes(renumberItr);
+}
+
 // Repair indexes after adding and removing instructions.
 void SlotIndexes::repairIndexesInRange(MachineBasicBlock *MBB,
                                        MachineBasicBlock::iterator Begin,
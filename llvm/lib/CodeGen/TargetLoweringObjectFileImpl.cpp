@@ -731,6 +731,32 @@ bool TargetLoweringObjectFileELF::shouldPutJumpTableInFunctionSection(
   return false;
 }
 
+MCSection *TargetLoweringObjectFileELF::getSectionForColdCode(
+    const Function &F, const TargetMachine &TM) const {
+  unsigned Flags = ELF::SHF_ALLOC | ELF::SHF_EXECINSTR;
+  StringRef Group = "";
+  if (const Comdat *C = getELFComdat(&F)) {
+    Flags |= ELF::SHF_GROUP;
+    Group = C->getName();
+  }
+
+  // The cold parts of all functions share one section unless the function
+  // gets a section of its own, in which case the cold part follows suit so
+  // that the two can be discarded together.
+  SmallString<128> Name(".text.split");
+  unsigned UniqueID = MCContext::GenericSectionID;
+  if (TM.getFunctionSections() || !Group.empty()) {
+    if (TM.getUniqueSectionNames()) {
+      Name += '.';
+      TM.getNameWithPrefix(Name, &F, getMangler(),
+                           /*MayAlwaysUsePrivate=*/true);
+    } else
+      UniqueID = NextUniqueID++;
+  }
+  return getContext().getELFSection(Name, ELF::SHT_PROGBITS, Flags,
+                                    /*EntrySize=*/0, Group, UniqueID);
+}
+
 /// Given a mergeable constant with the specified size and relocation
 /// information, return a section that it should be placed in.
 MCSection *TargetLoweringObjectFileELF::getSectionForConstant(
@@ -124,6 +124,10 @@ static cl::opt<RunOutliner> EnableMachineOutliner(
                clEnumValN(NeverOutline, "never", "Disable all outlining"),
                // Sentinel value for unspecified option.
                clEnumValN(AlwaysOutline, "", "")));
+static cl::opt<bool> EnableMachineFunctionSplitter(
+    "split-machine-functions", cl::Hidden, cl::init(false),
+    cl::desc("Split out cold basic blocks from machine functions based on "
+             "profile information"));
 // Enable or disable FastISel. Both options are needed, because
 // FastISel is enabled by default with -fast, and we wish to be
 // able to enable or disable fast-isel independently from -O0.
@@ -983,6 +987,9 @@ void TargetPassConfig::addMachinePasses() {
       addPass(createMachineOutlinerPass(RunOnAllFunctions));
   }
 
+  if (EnableMachineFunctionSplitter && getOptLevel() != CodeGenOpt::None)
+    addPass(createMachineFunctionSplitterPass());
+
   // Add passes that directly emit MI after all other MI passes.
   addPreEmitPass2();
 
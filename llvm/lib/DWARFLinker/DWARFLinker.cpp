@@ -2221,6 +2221,28 @@ bool DWARFLinker::link() {
       Options.TheAccelTableKind = AccelTableKind::Apple;
   }
 
+  // Extracting the DIEs of every compile unit is the most expensive part of
+  // the serial module registration loop below, and it only touches the
+  // object's own DWARFContext. Do it for all objects in parallel first, so
+  // that the loop finds the DIEs already extracted. With a limit on the
+  // number of loaded objects, only the unit DIEs are extracted at this point
+  // and the rest is extracted as each object is analyzed.
+  if (Options.Threads > 1 && !Options.MaxObjectsInFlight) {
+    ThreadPool Pool(Options.Threads);
+    for (LinkContext &OptContext : ObjectContexts) {
+      if (!OptContext.ObjectFile.ObjFile || !OptContext.DwarfContext)
+        continue;
+      if (LLVM_LIKELY(!Options.Update) &&
+          !OptContext.ObjectFile.Addresses->hasValidRelocs())
+        continue;
+      Pool.async([&OptContext]() {
+        for (const auto &CU : OptContext.DwarfContext->compile_units())
+          CU->getUnitDIE(/*ExtractUnitDIEOnly=*/false);
+      });
+    }
+    Pool.wait();
+  }
+
   for (LinkContext &OptContext : ObjectContexts) {
     if (Options.Verbose) {
       if (DwarfLinkerClientID == DwarfLinkerClient::Dsymutil)
@@ -2260,7 +2282,8 @@ bool DWARFLinker::link() {
 
     for (const auto &CU : OptContext.DwarfContext->compile_units()) {
       updateDwarfVersion(CU->getVersion());
-      auto CUDie = CU->getUnitDIE(false);
+      auto CUDie = CU->getUnitDIE(
+          /*ExtractUnitDIEOnly=*/Options.MaxObjectsInFlight != 0);
       if (Options.Verbose) {
         outs() << "Input compilation unit:";
         DIDumpOptions DumpOpts;
@@ -2293,6 +2316,9 @@ bool DWARFLinker::link() {
   std::mutex ProcessedFilesMutex;
   std::condition_variable ProcessedFilesConditionVariable;
   BitVector ProcessedFiles(NumObjects, false);
+  // The number of objects that have been cloned and released so far. Used to
+  // keep analysis from running more than MaxObjectsInFlight objects ahead.
+  unsigned NumClonedFiles = 0;
 
   //  Analyzing the context info is particularly expensive so it is executed in
   //  parallel with emitting the previous compile unit.
@@ -2410,11 +2436,18 @@ bool DWARFLinker::link() {
 
   auto AnalyzeAll = [&]() {
     for (unsigned I = 0, E = NumObjects; I != E; ++I) {
+      if (Options.MaxObjectsInFlight) {
+        std::unique_lock<std::mutex> LockGuard(ProcessedFilesMutex);
+        ProcessedFilesConditionVariable.wait(LockGuard, [&]() {
+          return I < NumClonedFiles + Options.MaxObjectsInFlight;
+        });
+      }
+
       AnalyzeLambda(I);
 
       std::unique_lock<std::mutex> LockGuard(ProcessedFilesMutex);
       ProcessedFiles.set(I);
-      ProcessedFilesConditionVariable.notify_one();
+      ProcessedFilesConditionVariable.notify_all();
     }
   };
 
@@ -2429,6 +2462,10 @@ bool DWARFLinker::link() {
       }
 
       CloneLambda(I);
+
+      std::unique_lock<std::mutex> LockGuard(ProcessedFilesMutex);
+      ++NumClonedFiles;
+      ProcessedFilesConditionVariable.notify_all();
     }
     EmitLambda();
   };
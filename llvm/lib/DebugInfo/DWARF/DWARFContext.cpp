@@ -880,8 +880,7 @@ DWARFContext::getLineTableForUnit(DWARFUnit *U) {
 
 Expected<const DWARFDebugLine::LineTable *> DWARFContext::getLineTableForUnit(
     DWARFUnit *U, function_ref<void(Error)> RecoverableErrorCallback) {
-  if (!Line)
-    Line.reset(new DWARFDebugLine);
+  std::call_once(LineOnce, [this] { Line.reset(new DWARFDebugLine); });
 
   auto UnitDIE = U->getUnitDIE();
   if (!UnitDIE)
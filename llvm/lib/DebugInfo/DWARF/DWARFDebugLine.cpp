@@ -502,6 +502,7 @@ void DWARFDebugLine::ParsingState::appendRowToMatrix() {
 
 const DWARFDebugLine::LineTable *
 DWARFDebugLine::getLineTable(uint64_t Offset) const {
+  std::lock_guard<std::mutex> Lock(LineTableMapMutex);
   LineTableConstIter Pos = LineTableMap.find(Offset);
   if (Pos != LineTableMap.end())
     return &Pos->second;
@@ -516,16 +517,31 @@ Expected<const DWARFDebugLine::LineTable *> DWARFDebugLine::getOrParseLineTable(
                        " is not a valid debug line section offset",
                        Offset);
 
-  std::pair<LineTableIter, bool> Pos =
-      LineTableMap.insert(LineTableMapTy::value_type(Offset, LineTable()));
-  LineTable *LT = &Pos.first->second;
-  if (Pos.second) {
-    if (Error Err =
-            LT->parse(DebugLineData, &Offset, Ctx, U, RecoverableErrorCallback))
-      return std::move(Err);
-    return LT;
+  {
+    std::lock_guard<std::mutex> Lock(LineTableMapMutex);
+    LineTableIter Pos = LineTableMap.find(Offset);
+    if (Pos != LineTableMap.end())
+      return &Pos->second;
   }
-  return LT;
+
+  // Parse without holding the lock, so that different tables can be parsed in
+  // parallel. If another thread has parsed the same table in the meantime,
+  // its copy is kept and this one dropped. As before, a table is cached even
+  // if parsing it failed, and only the first request reports the error.
+  LineTable NewLT;
+  uint64_t TableOffset = Offset;
+  Error Err = NewLT.parse(DebugLineData, &TableOffset, Ctx, U,
+                          RecoverableErrorCallback);
+  std::lock_guard<std::mutex> Lock(LineTableMapMutex);
+  std::pair<LineTableIter, bool> Pos = LineTableMap.insert(
+      LineTableMapTy::value_type(Offset, std::move(NewLT)));
+  if (!Pos.second) {
+    consumeError(std::move(Err));
+    return &Pos.first->second;
+  }
+  if (Err)
+    return std::move(Err);
+  return &Pos.first->second;
 }
 
 Error DWARFDebugLine::LineTable::parse(
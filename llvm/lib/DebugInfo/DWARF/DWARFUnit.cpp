@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/DebugInfo/DWARF/DWARFUnit.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/DebugInfo/DWARF/DWARFAbbreviationDeclaration.h"
@@ -438,9 +439,14 @@ void DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
 }
 
 Error DWARFUnit::tryExtractDIEsIfNeeded(bool CUDieOnly) {
+  if (AllDIEsExtracted.load(std::memory_order_acquire) ||
+      (CUDieOnly && CUDieExtracted.load(std::memory_order_acquire)))
+    return Error::success(); // Already parsed.
+
+  std::lock_guard<std::mutex> Lock(ExtractDIEsMutex);
   if ((CUDieOnly && !DieArray.empty()) ||
       DieArray.size() > 1)
-    return Error::success(); // Already parsed.
+    return Error::success(); // Parsed by another thread in the meantime.
 
   bool HasCUDie = !DieArray.empty();
   extractDIEsToVector(!HasCUDie, !CUDieOnly, DieArray);
@@ -448,6 +454,15 @@ Error DWARFUnit::tryExtractDIEsIfNeeded(bool CUDieOnly) {
   if (DieArray.empty())
     return Error::success();
 
+  // Publish the result only once the unit DIE attributes below have been
+  // processed, and also if that fails: like a repeated call on a single
+  // thread, later calls just return the DIEs extracted so far.
+  auto SetExtracted = make_scope_exit([&] {
+    CUDieExtracted.store(true, std::memory_order_release);
+    if (!CUDieOnly)
+      AllDIEsExtracted.store(true, std::memory_order_release);
+  });
+
   // If CU DIE was just parsed, copy several attribute values from it.
   if (HasCUDie)
     return Error::success();
@@ -610,6 +625,10 @@ bool DWARFUnit::parseDWO() {
 }
 
 void DWARFUnit::clearDIEs(bool KeepCUDie) {
+  std::lock_guard<std::mutex> Lock(ExtractDIEsMutex);
+  AllDIEsExtracted.store(false, std::memory_order_relaxed);
+  if (!KeepCUDie)
+    CUDieExtracted.store(false, std::memory_order_relaxed);
   if (DieArray.size() > (unsigned)KeepCUDie) {
     DieArray.resize((unsigned)KeepCUDie);
     DieArray.shrink_to_fit();
@@ -63,8 +63,10 @@ LLVMSymbolizer::symbolizeCode(const ObjectFile &Obj,
                               object::SectionedAddress ModuleOffset) {
   StringRef ModuleName = Obj.getFileName();
   auto I = Modules.find(ModuleName);
-  if (I != Modules.end())
+  if (I != Modules.end()) {
+    recordModuleAccess(ModuleName);
     return symbolizeCodeCommon(I->second.get(), ModuleOffset);
+  }
 
   std::unique_ptr<DIContext> Context =
         DWARFContext::create(Obj, nullptr, DWARFContext::defaultErrorHandler);
@@ -168,6 +170,31 @@ void LLVMSymbolizer::flush() {
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
   Modules.clear();
+  ModuleLRU.clear();
+  ModuleLRUPos.clear();
+}
+
+void LLVMSymbolizer::recordModuleAccess(StringRef ModuleName) {
+  if (!Opts.MaxCachedModules)
+    return;
+
+  auto I = ModuleLRUPos.find(ModuleName);
+  if (I != ModuleLRUPos.end()) {
+    ModuleLRU.splice(ModuleLRU.begin(), ModuleLRU, I->second);
+    return;
+  }
+  ModuleLRU.emplace_front(ModuleName);
+  ModuleLRUPos.emplace(ModuleLRU.front(), ModuleLRU.begin());
+
+  // Only the parsed debug info is dropped. The object files stay mapped and
+  // cached in ObjectPairForPathArch, so reloading a module skips the search
+  // for its debug object.
+  while (ModuleLRU.size() > Opts.MaxCachedModules) {
+    const std::string &Victim = ModuleLRU.back();
+    Modules.erase(Victim);
+    ModuleLRUPos.erase(Victim);
+    ModuleLRU.pop_back();
+  }
 }
 
 namespace {
@@ -514,6 +541,7 @@ LLVMSymbolizer::createModuleInfo(const ObjectFile *Obj,
   auto InsertResult = Modules.insert(
       std::make_pair(std::string(ModuleName), std::move(SymMod)));
   assert(InsertResult.second);
+  recordModuleAccess(ModuleName);
   if (std::error_code EC = InfoOrErr.getError())
     return errorCodeToError(EC);
   return InsertResult.first->second.get();
@@ -522,8 +550,10 @@ LLVMSymbolizer::createModuleInfo(const ObjectFile *Obj,
 Expected<SymbolizableModule *>
 LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   auto I = Modules.find(ModuleName);
-  if (I != Modules.end())
+  if (I != Modules.end()) {
+    recordModuleAccess(ModuleName);
     return I->second.get();
+  }
 
   std::string BinaryName = ModuleName;
   std::string ArchName = Opts.DefaultArch;
@@ -540,9 +570,17 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   if (!ObjectsOrErr) {
     // Failed to find valid object file.
     Modules.emplace(ModuleName, std::unique_ptr<SymbolizableModule>());
+    recordModuleAccess(ModuleName);
     return ObjectsOrErr.takeError();
   }
   ObjectPair Objects = ObjectsOrErr.get();
+  if (!Objects.first) {
+    // The object failed to load for an earlier module, e.g. one evicted from
+    // the cache, and the error has already been reported.
+    Modules.emplace(ModuleName, std::unique_ptr<SymbolizableModule>());
+    recordModuleAccess(ModuleName);
+    return nullptr;
+  }
 
   std::unique_ptr<DIContext> Context;
   // If this is a COFF object containing PDB info, use a PDBContext to
@@ -557,6 +595,7 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
       if (auto Err = loadDataForEXE(PDB_ReaderType::DIA,
                                     Objects.first->getFileName(), Session)) {
         Modules.emplace(ModuleName, std::unique_ptr<SymbolizableModule>());
+        recordModuleAccess(ModuleName);
         // Return along the PDB filename to provide more context
         return createFileError(PDBFileName, std::move(Err));
       }
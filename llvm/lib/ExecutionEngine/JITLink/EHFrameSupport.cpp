@@ -17,6 +17,31 @@
 namespace llvm {
 namespace jitlink {
 
+// Returns the size of a pointer field with the given DW_EH_PE encoding, or
+// zero if the encoding is not supported. Only absolute and pc-relative
+// pointers are supported.
+static unsigned getPointerEncodingDataSize(uint8_t PointerEncoding,
+                                           unsigned PointerSize) {
+  using namespace dwarf;
+
+  uint8_t Application = PointerEncoding & 0x70;
+  if (Application != DW_EH_PE_absptr && Application != DW_EH_PE_pcrel)
+    return 0;
+
+  switch (PointerEncoding & 0x0f) {
+  case DW_EH_PE_absptr:
+    return PointerSize;
+  case DW_EH_PE_udata4:
+  case DW_EH_PE_sdata4:
+    return 4;
+  case DW_EH_PE_udata8:
+  case DW_EH_PE_sdata8:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
 EHFrameSplitter::EHFrameSplitter(StringRef EHFrameSectionName)
     : EHFrameSectionName(EHFrameSectionName) {}
 
@@ -118,9 +143,9 @@ Error EHFrameSplitter::processBlock(LinkGraph &G, Block &B,
 
 EHFrameEdgeFixer::EHFrameEdgeFixer(StringRef EHFrameSectionName,
                                    Edge::Kind FDEToCIE, Edge::Kind FDEToPCBegin,
-                                   Edge::Kind FDEToLSDA)
+                                   Edge::Kind FDEToLSDA, Edge::Kind Delta32)
     : EHFrameSectionName(EHFrameSectionName), FDEToCIE(FDEToCIE),
-      FDEToPCBegin(FDEToPCBegin), FDEToLSDA(FDEToLSDA) {}
+      FDEToPCBegin(FDEToPCBegin), FDEToLSDA(FDEToLSDA), Delta32(Delta32) {}
 
 Error EHFrameEdgeFixer::operator()(LinkGraph &G) {
   auto *EHFrame = G.findSectionByName(EHFrameSectionName);
@@ -328,26 +353,30 @@ Error EHFrameEdgeFixer::processCIE(ParseContext &PC, Block &B,
       uint8_t LSDAPointerEncoding;
       if (auto Err = RecordReader.readInteger(LSDAPointerEncoding))
         return Err;
-      if (LSDAPointerEncoding != (DW_EH_PE_pcrel | DW_EH_PE_absptr))
+      if (!getPointerEncodingDataSize(LSDAPointerEncoding,
+                                      PC.G.getPointerSize()))
         return make_error<JITLinkError>(
             "Unsupported LSDA pointer encoding " +
             formatv("{0:x2}", LSDAPointerEncoding) + " in CIE at " +
             formatv("{0:x16}", CIESymbol.getAddress()));
+      CIEInfo.LSDAPointerEncoding = LSDAPointerEncoding;
       break;
     }
     case 'P': {
+      // The personality pointer is fixed up by its relocation: just skip it.
       uint8_t PersonalityPointerEncoding = 0;
       if (auto Err = RecordReader.readInteger(PersonalityPointerEncoding))
         return Err;
-      if (PersonalityPointerEncoding !=
-          (DW_EH_PE_indirect | DW_EH_PE_pcrel | DW_EH_PE_sdata4))
+      unsigned PersonalityPointerSize = getPointerEncodingDataSize(
+          PersonalityPointerEncoding & ~DW_EH_PE_indirect,
+          PC.G.getPointerSize());
+      if (!PersonalityPointerSize)
         return make_error<JITLinkError>(
             "Unspported personality pointer "
             "encoding " +
             formatv("{0:x2}", PersonalityPointerEncoding) + " in CIE at " +
             formatv("{0:x16}", CIESymbol.getAddress()));
-      uint32_t PersonalityPointerAddress;
-      if (auto Err = RecordReader.readInteger(PersonalityPointerAddress))
+      if (auto Err = RecordReader.skip(PersonalityPointerSize))
         return Err;
       break;
     }
@@ -355,12 +384,14 @@ Error EHFrameEdgeFixer::processCIE(ParseContext &PC, Block &B,
       uint8_t FDEPointerEncoding;
       if (auto Err = RecordReader.readInteger(FDEPointerEncoding))
         return Err;
-      if (FDEPointerEncoding != (DW_EH_PE_pcrel | DW_EH_PE_absptr))
+      if (!getPointerEncodingDataSize(FDEPointerEncoding,
+                                      PC.G.getPointerSize()))
         return make_error<JITLinkError>(
             "Unsupported FDE address pointer "
             "encoding " +
             formatv("{0:x2}", FDEPointerEncoding) + " in CIE at " +
             formatv("{0:x16}", CIESymbol.getAddress()));
+      CIEInfo.FDEPointerEncoding = FDEPointerEncoding;
       break;
     }
     default:
@@ -438,13 +469,17 @@ Error EHFrameEdgeFixer::processFDE(ParseContext &PC, Block &B,
     }
   }
 
+  unsigned FDEPointerSize = getPointerEncodingDataSize(
+      CIEInfo->FDEPointerEncoding, PC.G.getPointerSize());
+
   {
     // Process the PC-Begin field.
     Block *PCBeginBlock = nullptr;
     JITTargetAddress PCBeginFieldOffset = RecordReader.getOffset();
     auto PCEdgeItr = BlockEdges.find(RecordOffset + PCBeginFieldOffset);
     if (PCEdgeItr == BlockEdges.end()) {
-      auto PCBeginDelta = readAbsolutePointer(PC.G, RecordReader);
+      auto PCBeginDelta =
+          readPCRelPointer(PC.G, RecordReader, CIEInfo->FDEPointerEncoding);
       if (!PCBeginDelta)
         return PCBeginDelta.takeError();
       JITTargetAddress PCBegin =
@@ -457,8 +492,8 @@ Error EHFrameEdgeFixer::processFDE(ParseContext &PC, Block &B,
       auto PCBeginSym = getOrCreateSymbol(PC, PCBegin);
       if (!PCBeginSym)
         return PCBeginSym.takeError();
-      B.addEdge(FDEToPCBegin, RecordOffset + PCBeginFieldOffset, *PCBeginSym,
-                0);
+      B.addEdge(getPCRelEdgeKind(CIEInfo->FDEPointerEncoding, FDEToPCBegin),
+                RecordOffset + PCBeginFieldOffset, *PCBeginSym, 0);
       PCBeginBlock = &PCBeginSym->getBlock();
     } else {
       auto &EI = PCEdgeItr->second;
@@ -479,7 +514,7 @@ Error EHFrameEdgeFixer::processFDE(ParseContext &PC, Block &B,
                                         " points at external block");
       }
       PCBeginBlock = &EI.Target->getBlock();
-      if (auto Err = RecordReader.skip(PC.G.getPointerSize()))
+      if (auto Err = RecordReader.skip(FDEPointerSize))
         return Err;
     }
 
@@ -489,25 +524,28 @@ Error EHFrameEdgeFixer::processFDE(ParseContext &PC, Block &B,
     PCBeginBlock->addEdge(Edge::KeepAlive, 0, FDESymbol, 0);
   }
 
-  // Skip over the PC range size field.
-  if (auto Err = RecordReader.skip(PC.G.getPointerSize()))
+  // Skip over the PC range size field, which has the same size as the
+  // PC-begin field.
+  if (auto Err = RecordReader.skip(FDEPointerSize))
     return Err;
 
   if (CIEInfo->FDEsHaveLSDAField) {
+    unsigned LSDAPointerSize = getPointerEncodingDataSize(
+        CIEInfo->LSDAPointerEncoding, PC.G.getPointerSize());
     uint64_t AugmentationDataSize;
     if (auto Err = RecordReader.readULEB128(AugmentationDataSize))
       return Err;
-    if (AugmentationDataSize != PC.G.getPointerSize())
+    if (AugmentationDataSize != LSDAPointerSize)
       return make_error<JITLinkError>(
           "Unexpected FDE augmentation data size (expected " +
-          Twine(PC.G.getPointerSize()) + ", got " +
-          Twine(AugmentationDataSize) + ") for FDE at " +
-          formatv("{0:x16}", RecordAddress));
+          Twine(LSDAPointerSize) + ", got " + Twine(AugmentationDataSize) +
+          ") for FDE at " + formatv("{0:x16}", RecordAddress));
 
     JITTargetAddress LSDAFieldOffset = RecordReader.getOffset();
     auto LSDAEdgeItr = BlockEdges.find(RecordOffset + LSDAFieldOffset);
     if (LSDAEdgeItr == BlockEdges.end()) {
-      auto LSDADelta = readAbsolutePointer(PC.G, RecordReader);
+      auto LSDADelta =
+          readPCRelPointer(PC.G, RecordReader, CIEInfo->LSDAPointerEncoding);
       if (!LSDADelta)
         return LSDADelta.takeError();
       JITTargetAddress LSDA = RecordAddress + LSDAFieldOffset + *LSDADelta;
@@ -519,7 +557,8 @@ Error EHFrameEdgeFixer::processFDE(ParseContext &PC, Block &B,
                << formatv("{0:x16}", RecordAddress + LSDAFieldOffset)
                << " to LSDA at " << formatv("{0:x16}", LSDA) << "\n";
       });
-      B.addEdge(FDEToLSDA, RecordOffset + LSDAFieldOffset, *LSDASym, 0);
+      B.addEdge(getPCRelEdgeKind(CIEInfo->LSDAPointerEncoding, FDEToLSDA),
+                RecordOffset + LSDAFieldOffset, *LSDASym, 0);
     } else {
       LLVM_DEBUG({
         auto &EI = LSDAEdgeItr->second;
@@ -530,7 +569,7 @@ Error EHFrameEdgeFixer::processFDE(ParseContext &PC, Block &B,
           dbgs() << " + " << formatv("{0:x16}", EI.Addend);
         dbgs() << "\n";
       });
-      if (auto Err = RecordReader.skip(PC.G.getPointerSize()))
+      if (auto Err = RecordReader.skip(LSDAPointerSize))
         return Err;
     }
   } else {
@@ -600,6 +639,35 @@ EHFrameEdgeFixer::readAbsolutePointer(LinkGraph &G,
   return Addr;
 }
 
+Expected<JITTargetAddress>
+EHFrameEdgeFixer::readPCRelPointer(LinkGraph &G,
+                                   BinaryStreamReader &RecordReader,
+                                   uint8_t PointerEncoding) {
+  using namespace dwarf;
+
+  // Without a relocation only pc-relative pointers can be followed.
+  if (PointerEncoding == (DW_EH_PE_pcrel | DW_EH_PE_absptr))
+    return readAbsolutePointer(G, RecordReader);
+
+  if (PointerEncoding == (DW_EH_PE_pcrel | DW_EH_PE_sdata4) &&
+      Delta32 != Edge::Invalid) {
+    int32_t Delta;
+    if (auto Err = RecordReader.readInteger(Delta))
+      return std::move(Err);
+    return static_cast<JITTargetAddress>(static_cast<int64_t>(Delta));
+  }
+
+  return make_error<JITLinkError>(
+      "Unsupported pointer encoding " + formatv("{0:x2}", PointerEncoding) +
+      " for a field without a relocation in " + EHFrameSectionName);
+}
+
+Edge::Kind EHFrameEdgeFixer::getPCRelEdgeKind(uint8_t PointerEncoding,
+                                              Edge::Kind PtrKind) {
+  return (PointerEncoding & 0x0f) == dwarf::DW_EH_PE_absptr ? PtrKind
+                                                             : Delta32;
+}
+
 Expected<Symbol &> EHFrameEdgeFixer::getOrCreateSymbol(ParseContext &PC,
                                                        JITTargetAddress Addr) {
   Symbol *CanonicalSym = nullptr;
@@ -629,6 +697,32 @@ Expected<Symbol &> EHFrameEdgeFixer::getOrCreateSymbol(ParseContext &PC,
   return PC.G.addAnonymousSymbol(*B, Addr - B->getAddress(), 0, false, false);
 }
 
+char EHFrameNullTerminator::NullTerminatorBlockContent[4] = {0, 0, 0, 0};
+
+EHFrameNullTerminator::EHFrameNullTerminator(StringRef EHFrameSectionName)
+    : EHFrameSectionName(EHFrameSectionName) {}
+
+Error EHFrameNullTerminator::operator()(LinkGraph &G) {
+  auto *EHFrame = G.findSectionByName(EHFrameSectionName);
+
+  if (!EHFrame)
+    return Error::success();
+
+  LLVM_DEBUG({
+    dbgs() << "EHFrameNullTerminator adding null terminator to "
+           << EHFrameSectionName << "\n";
+  });
+
+  // Blocks are laid out in address order within a section, so give the
+  // terminator the highest address to place it after every record. It is
+  // kept alive by a live symbol, as nothing refers to it.
+  auto &NullTerminatorBlock = G.createContentBlock(
+      *EHFrame, StringRef(NullTerminatorBlockContent, 4),
+      0xfffffffffffffffc, 1, 0);
+  G.addAnonymousSymbol(NullTerminatorBlock, 0, 4, false, true);
+  return Error::success();
+}
+
 // Determine whether we can register EH tables.
 #if (defined(__GNUC__) && !defined(__ARM_EABI__) && !defined(__ia64__) &&      \
      !(defined(_AIX) && defined(__ibmxl__)) && !defined(__SEH__) &&            \
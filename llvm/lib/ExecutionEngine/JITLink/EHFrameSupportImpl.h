@@ -15,6 +15,7 @@
 
 #include "llvm/ExecutionEngine/JITLink/EHFrameSupport.h"
 
+#include "llvm/BinaryFormat/Dwarf.h"
 #include "llvm/ExecutionEngine/JITLink/JITLink.h"
 #include "llvm/Support/BinaryStreamReader.h"
 
@@ -38,10 +39,15 @@ private:
 
 /// A LinkGraph pass that adds missing FDE-to-CIE, FDE-to-PC and FDE-to-LSDA
 /// edges.
+///
+/// FDEToPCBegin and FDEToLSDA are used for pointer-sized pc-relative fields.
+/// Formats that encode these fields as 32-bit pc-relative values (ELF) must
+/// pass a Delta32 kind to fix them up when they have no relocation.
 class EHFrameEdgeFixer {
 public:
   EHFrameEdgeFixer(StringRef EHFrameSectionName, Edge::Kind FDEToCIE,
-                   Edge::Kind FDEToPCBegin, Edge::Kind FDEToLSDA);
+                   Edge::Kind FDEToPCBegin, Edge::Kind FDEToLSDA,
+                   Edge::Kind Delta32 = Edge::Invalid);
   Error operator()(LinkGraph &G);
 
 private:
@@ -57,6 +63,10 @@ private:
     CIEInformation(Symbol &CIESymbol) : CIESymbol(&CIESymbol) {}
     Symbol *CIESymbol = nullptr;
     bool FDEsHaveLSDAField = false;
+    uint8_t FDEPointerEncoding =
+        dwarf::DW_EH_PE_pcrel | dwarf::DW_EH_PE_absptr;
+    uint8_t LSDAPointerEncoding =
+        dwarf::DW_EH_PE_pcrel | dwarf::DW_EH_PE_absptr;
   };
 
   struct EdgeTarget {
@@ -98,12 +108,30 @@ private:
   parseAugmentationString(BinaryStreamReader &RecordReader);
   Expected<JITTargetAddress>
   readAbsolutePointer(LinkGraph &G, BinaryStreamReader &RecordReader);
+  Expected<JITTargetAddress> readPCRelPointer(LinkGraph &G,
+                                              BinaryStreamReader &RecordReader,
+                                              uint8_t PointerEncoding);
+  Edge::Kind getPCRelEdgeKind(uint8_t PointerEncoding, Edge::Kind PtrKind);
   Expected<Symbol &> getOrCreateSymbol(ParseContext &PC, JITTargetAddress Addr);
 
   StringRef EHFrameSectionName;
   Edge::Kind FDEToCIE;
   Edge::Kind FDEToPCBegin;
   Edge::Kind FDEToLSDA;
+  Edge::Kind Delta32;
+};
+
+/// A LinkGraph pass that adds a null terminator to an eh-frame section, for
+/// registration functions that find the end of the section by looking for
+/// one (e.g. libgcc's __register_frame).
+class EHFrameNullTerminator {
+public:
+  EHFrameNullTerminator(StringRef EHFrameSectionName);
+  Error operator()(LinkGraph &G);
+
+private:
+  static char NullTerminatorBlockContent[4];
+  StringRef EHFrameSectionName;
 };
 
 } // end namespace jitlink
@@ -0,0 +1,600 @@
+//===----- ELF_x86_64.cpp - JIT linker implementation for ELF/x86-64 ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// ELF/x86-64 jit-link implementation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+
+#include "BasicGOTAndStubsBuilder.h"
+#include "EHFrameSupportImpl.h"
+#include "JITLinkGeneric.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Object/ELF.h"
+#include "llvm/Support/FormatVariadic.h"
+
+#define DEBUG_TYPE "jitlink"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+using namespace llvm::jitlink::ELF_x86_64_Edges;
+
+namespace {
+
+class ELFLinkGraphBuilder_x86_64 {
+  using ELFT = object::ELF64LE;
+  using Elf_Shdr = typename ELFT::Shdr;
+  using Elf_Sym = typename ELFT::Sym;
+  using Elf_Rela = typename ELFT::Rela;
+
+public:
+  ELFLinkGraphBuilder_x86_64(StringRef FileName,
+                             const object::ELFFile<ELFT> &Obj)
+      : Obj(Obj), G(std::make_unique<LinkGraph>(FileName.str(), 8,
+                                                support::little)) {}
+
+  Expected<std::unique_ptr<LinkGraph>> buildGraph() {
+    if (auto SectionsOrErr = Obj.sections())
+      Sections = *SectionsOrErr;
+    else
+      return SectionsOrErr.takeError();
+
+    if (auto Err = graphifySections())
+      return std::move(Err);
+
+    if (auto Err = graphifySymbols())
+      return std::move(Err);
+
+    if (auto Err = addRelocations())
+      return std::move(Err);
+
+    return std::move(G);
+  }
+
+private:
+  static Expected<ELFX86RelocationKind> getRelocationKind(uint32_t Type) {
+    switch (Type) {
+    case ELF::R_X86_64_PLT32:
+      return Branch32;
+    case ELF::R_X86_64_32:
+      return Pointer32;
+    case ELF::R_X86_64_32S:
+      return Pointer32Signed;
+    case ELF::R_X86_64_64:
+      return Pointer64;
+    case ELF::R_X86_64_PC32:
+      return PCRel32;
+    case ELF::R_X86_64_GOTPCREL:
+    case ELF::R_X86_64_GOTPCRELX:
+    case ELF::R_X86_64_REX_GOTPCRELX:
+      return PCRel32GOTLoad;
+    case ELF::R_X86_64_PC64:
+      return Delta64;
+    }
+
+    return make_error<JITLinkError>(
+        "Unsupported x86-64 relocation: " +
+        object::getELFRelocationTypeName(ELF::EM_X86_64, Type) +
+        " (type=" + formatv("{0:d}", Type) + ")");
+  }
+
+  static uint64_t getFixupSize(ELFX86RelocationKind Kind) {
+    return (Kind == Pointer64 || Kind == Delta64) ? 8 : 4;
+  }
+
+  Section &getCommonSection() {
+    if (!CommonSection) {
+      auto Prot = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+      CommonSection = &G->createSection("<common>", Prot);
+    }
+    return *CommonSection;
+  }
+
+  // Relocatable objects give every section an address of zero, so lay the
+  // loaded sections out at distinct (but otherwise arbitrary) addresses. The
+  // JITLinker assigns the real addresses once the graph has been pruned.
+  JITTargetAddress allocateAddress(uint64_t Size, uint64_t Alignment) {
+    NextAddress = alignTo(NextAddress, Alignment);
+    JITTargetAddress Address = NextAddress;
+    NextAddress += Size;
+    return Address;
+  }
+
+  // Creates one block for each allocated section. Sections with the same name
+  // are grouped into a single graph section.
+  Error graphifySections() {
+    SectionBlocks.resize(Sections.size(), nullptr);
+    SectionStartSymbols.resize(Sections.size(), nullptr);
+
+    for (unsigned SecIndex = 0; SecIndex != Sections.size(); ++SecIndex) {
+      const Elf_Shdr &Sec = Sections[SecIndex];
+
+      // Sections that are not loaded (debug info, symbol and string tables,
+      // relocations, ...) do not take part in the link.
+      if (!(Sec.sh_flags & ELF::SHF_ALLOC))
+        continue;
+
+      auto NameOrErr = Obj.getSectionName(&Sec);
+      if (!NameOrErr)
+        return NameOrErr.takeError();
+
+      if (Sec.sh_flags & ELF::SHF_TLS)
+        return make_error<JITLinkError>("Thread-local section " + *NameOrErr +
+                                        " is not supported");
+
+      unsigned Prot = sys::Memory::MF_READ;
+      if (Sec.sh_flags & ELF::SHF_WRITE)
+        Prot |= sys::Memory::MF_WRITE;
+      if (Sec.sh_flags & ELF::SHF_EXECINSTR)
+        Prot |= sys::Memory::MF_EXEC;
+
+      Section *GraphSec = G->findSectionByName(*NameOrErr);
+      if (!GraphSec)
+        GraphSec = &G->createSection(
+            *NameOrErr, static_cast<sys::Memory::ProtectionFlags>(Prot));
+
+      uint64_t Alignment = std::max<uint64_t>(Sec.sh_addralign, 1);
+      JITTargetAddress Address = allocateAddress(Sec.sh_size, Alignment);
+
+      LLVM_DEBUG({
+        dbgs() << "  Adding section " << SecIndex << " \"" << *NameOrErr
+               << "\" at " << formatv("{0:x16}", Address) << ", size "
+               << formatv("{0:x}", Sec.sh_size) << "\n";
+      });
+
+      if (Sec.sh_type == ELF::SHT_NOBITS) {
+        SectionBlocks[SecIndex] = &G->createZeroFillBlock(
+            *GraphSec, Sec.sh_size, Address, Alignment, 0);
+        continue;
+      }
+
+      auto ContentOrErr = Obj.getSectionContents(&Sec);
+      if (!ContentOrErr)
+        return ContentOrErr.takeError();
+      StringRef Content(reinterpret_cast<const char *>(ContentOrErr->data()),
+                        ContentOrErr->size());
+      SectionBlocks[SecIndex] =
+          &G->createContentBlock(*GraphSec, Content, Address, Alignment, 0);
+    }
+
+    return Error::success();
+  }
+
+  Error graphifySymbols() {
+    const Elf_Shdr *SymTabSec = nullptr;
+    for (auto &Sec : Sections)
+      if (Sec.sh_type == ELF::SHT_SYMTAB) {
+        SymTabSec = &Sec;
+        break;
+      }
+
+    // An object without a symbol table can't have any relocations either.
+    if (!SymTabSec)
+      return Error::success();
+
+    if (auto SymbolsOrErr = Obj.symbols(SymTabSec))
+      Symbols = *SymbolsOrErr;
+    else
+      return SymbolsOrErr.takeError();
+
+    auto StrTabOrErr = Obj.getStringTableForSymtab(*SymTabSec);
+    if (!StrTabOrErr)
+      return StrTabOrErr.takeError();
+
+    GraphSymbols.resize(Symbols.size(), nullptr);
+
+    // Symbol zero is the reserved null symbol.
+    for (unsigned SymIndex = 1; SymIndex != Symbols.size(); ++SymIndex) {
+      const Elf_Sym &Sym = Symbols[SymIndex];
+
+      // File symbols carry no address, and section symbols are resolved to
+      // the start of their section when a relocation refers to them.
+      if (Sym.getType() == ELF::STT_FILE || Sym.getType() == ELF::STT_SECTION)
+        continue;
+
+      auto NameOrErr = Sym.getName(*StrTabOrErr);
+      if (!NameOrErr)
+        return NameOrErr.takeError();
+      StringRef Name = *NameOrErr;
+
+      if (Sym.getType() == ELF::STT_TLS || Sym.getType() == ELF::STT_GNU_IFUNC)
+        return make_error<JITLinkError>("Symbol " + Name +
+                                        " has unsupported type " +
+                                        formatv("{0:d}", Sym.getType()));
+
+      Linkage L = Sym.getBinding() == ELF::STB_WEAK ? Linkage::Weak
+                                                    : Linkage::Strong;
+      Scope S = Scope::Default;
+      if (Sym.getBinding() == ELF::STB_LOCAL)
+        S = Scope::Local;
+      else if (Sym.getVisibility() == ELF::STV_HIDDEN ||
+               Sym.getVisibility() == ELF::STV_INTERNAL)
+        S = Scope::Hidden;
+
+      if (Sym.isUndefined()) {
+        if (Name.empty())
+          return make_error<JITLinkError>("Undefined symbol " +
+                                          formatv("{0:d}", SymIndex) +
+                                          " has no name");
+        GraphSymbols[SymIndex] = &G->addExternalSymbol(Name, Sym.st_size, L);
+        continue;
+      }
+
+      if (Sym.isAbsolute()) {
+        GraphSymbols[SymIndex] = &G->addAbsoluteSymbol(
+            Name, Sym.st_value, Sym.st_size, L, S, false);
+        continue;
+      }
+
+      if (Sym.isCommon()) {
+        // For common symbols st_value holds the alignment.
+        uint64_t Alignment = std::max<uint64_t>(Sym.st_value, 1);
+        GraphSymbols[SymIndex] = &G->addCommonSymbol(
+            Name, S, getCommonSection(),
+            allocateAddress(Sym.st_size, Alignment), Sym.st_size, Alignment,
+            false);
+        continue;
+      }
+
+      if (Sym.st_shndx >= ELF::SHN_LORESERVE)
+        return make_error<JITLinkError>("Symbol " + Name +
+                                        " has unsupported section index " +
+                                        formatv("{0:x4}", Sym.st_shndx));
+
+      if (Sym.st_shndx >= SectionBlocks.size())
+        return make_error<JITLinkError>("Symbol " + Name +
+                                        " has invalid section index " +
+                                        formatv("{0:d}", Sym.st_shndx));
+
+      // Symbols in sections that are not loaded can't be referenced from the
+      // sections that are, so they can be dropped.
+      Block *B = SectionBlocks[Sym.st_shndx];
+      if (!B)
+        continue;
+
+      if (Sym.st_value + Sym.st_size > B->getSize())
+        return make_error<JITLinkError>("Symbol " + Name +
+                                        " extends past end of its section");
+
+      bool IsCallable = Sym.getType() == ELF::STT_FUNC;
+      if (Name.empty())
+        GraphSymbols[SymIndex] = &G->addAnonymousSymbol(
+            *B, Sym.st_value, Sym.st_size, IsCallable, false);
+      else
+        GraphSymbols[SymIndex] = &G->addDefinedSymbol(
+            *B, Sym.st_value, Name, Sym.st_size, L, S, IsCallable, false);
+    }
+
+    return Error::success();
+  }
+
+  Expected<Symbol &> getSectionStartSymbol(unsigned SecIndex) {
+    if (SecIndex >= SectionBlocks.size() || !SectionBlocks[SecIndex])
+      return make_error<JITLinkError>("Section symbol refers to section " +
+                                      formatv("{0:d}", SecIndex) +
+                                      " which is not loaded");
+
+    if (!SectionStartSymbols[SecIndex]) {
+      Block &B = *SectionBlocks[SecIndex];
+      SectionStartSymbols[SecIndex] =
+          &G->addAnonymousSymbol(B, 0, B.getSize(), false, false);
+    }
+    return *SectionStartSymbols[SecIndex];
+  }
+
+  Expected<Symbol &> getRelocationTarget(uint32_t SymIndex) {
+    if (SymIndex >= Symbols.size())
+      return make_error<JITLinkError>("Relocation refers to invalid symbol " +
+                                      formatv("{0:d}", SymIndex));
+
+    const Elf_Sym &Sym = Symbols[SymIndex];
+    if (Sym.getType() == ELF::STT_SECTION)
+      return getSectionStartSymbol(Sym.st_shndx);
+
+    if (!GraphSymbols[SymIndex])
+      return make_error<JITLinkError>("Relocation refers to symbol " +
+                                      formatv("{0:d}", SymIndex) +
+                                      " which is not loaded");
+    return *GraphSymbols[SymIndex];
+  }
+
+  Error addRelocations() {
+    for (auto &Sec : Sections) {
+      if (Sec.sh_type != ELF::SHT_RELA && Sec.sh_type != ELF::SHT_REL)
+        continue;
+
+      // Skip relocations for sections that are not loaded.
+      if (Sec.sh_info >= SectionBlocks.size() || !SectionBlocks[Sec.sh_info])
+        continue;
+      Block &BlockToFix = *SectionBlocks[Sec.sh_info];
+
+      if (Sec.sh_type == ELF::SHT_REL)
+        return make_error<JITLinkError>("REL relocations are not supported "
+                                        "on x86-64");
+
+      auto RelasOrErr = Obj.relas(&Sec);
+      if (!RelasOrErr)
+        return RelasOrErr.takeError();
+
+      for (const Elf_Rela &Rela : *RelasOrErr) {
+        uint32_t Type = Rela.getType(false);
+        if (Type == ELF::R_X86_64_NONE)
+          continue;
+
+        auto Kind = getRelocationKind(Type);
+        if (!Kind)
+          return Kind.takeError();
+
+        if (Rela.r_offset + getFixupSize(*Kind) > BlockToFix.getSize())
+          return make_error<JITLinkError>(
+              "Relocation extends past end of fixup block");
+
+        auto TargetOrErr = getRelocationTarget(Rela.getSymbol(false));
+        if (!TargetOrErr)
+          return TargetOrErr.takeError();
+
+        LLVM_DEBUG({
+          Edge GE(*Kind, Rela.r_offset, *TargetOrErr, Rela.r_addend);
+          printEdge(dbgs(), BlockToFix, GE,
+                    getELFX86RelocationKindName(*Kind));
+          dbgs() << "\n";
+        });
+        BlockToFix.addEdge(*Kind, Rela.r_offset, *TargetOrErr, Rela.r_addend);
+      }
+    }
+    return Error::success();
+  }
+
+  const object::ELFFile<ELFT> &Obj;
+  std::unique_ptr<LinkGraph> G;
+  ArrayRef<Elf_Shdr> Sections;
+  ArrayRef<Elf_Sym> Symbols;
+  std::vector<Block *> SectionBlocks;
+  std::vector<Symbol *> SectionStartSymbols;
+  std::vector<Symbol *> GraphSymbols;
+  Section *CommonSection = nullptr;
+  JITTargetAddress NextAddress = 0;
+};
+
+class ELF_x86_64_GOTAndStubsBuilder
+    : public BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder> {
+public:
+  ELF_x86_64_GOTAndStubsBuilder(LinkGraph &G)
+      : BasicGOTAndStubsBuilder<ELF_x86_64_GOTAndStubsBuilder>(G) {}
+
+  bool isGOTEdge(Edge &E) const { return E.getKind() == PCRel32GOTLoad; }
+
+  Symbol &createGOTEntry(Symbol &Target) {
+    auto &GOTEntryBlock = G.createContentBlock(
+        getGOTSection(), getGOTEntryBlockContent(), 0, 8, 0);
+    GOTEntryBlock.addEdge(Pointer64, 0, Target, 0);
+    return G.addAnonymousSymbol(GOTEntryBlock, 0, 8, false, false);
+  }
+
+  void fixGOTEdge(Edge &E, Symbol &GOTEntry) {
+    assert(E.getKind() == PCRel32GOTLoad && "Not a GOT edge?");
+    E.setKind(PCRel32);
+    E.setTarget(GOTEntry);
+    // Leave the edge addend as-is.
+  }
+
+  bool isExternalBranchEdge(Edge &E) {
+    return E.getKind() == Branch32 && !E.getTarget().isDefined();
+  }
+
+  Symbol &createStub(Symbol &Target) {
+    auto &StubContentBlock =
+        G.createContentBlock(getStubsSection(), getStubBlockContent(), 0, 1, 0);
+    // Re-use GOT entries for stub targets. The displacement is relative to the
+    // end of the jmp instruction, which is 4 bytes past the fixup.
+    auto &GOTEntrySymbol = getGOTEntrySymbol(Target);
+    StubContentBlock.addEdge(PCRel32, 2, GOTEntrySymbol, -4);
+    return G.addAnonymousSymbol(StubContentBlock, 0, 6, true, false);
+  }
+
+  void fixExternalBranchEdge(Edge &E, Symbol &Stub) {
+    assert(E.getKind() == Branch32 && "Not a Branch32 edge?");
+    // Leave the edge addend as-is.
+    E.setTarget(Stub);
+  }
+
+private:
+  Section &getGOTSection() {
+    if (!GOTSection)
+      GOTSection = &G.createSection("$__GOT", sys::Memory::MF_READ);
+    return *GOTSection;
+  }
+
+  Section &getStubsSection() {
+    if (!StubsSection) {
+      auto StubsProt = static_cast<sys::Memory::ProtectionFlags>(
+          sys::Memory::MF_READ | sys::Memory::MF_EXEC);
+      StubsSection = &G.createSection("$__STUBS", StubsProt);
+    }
+    return *StubsSection;
+  }
+
+  StringRef getGOTEntryBlockContent() {
+    return StringRef(reinterpret_cast<const char *>(NullGOTEntryContent),
+                     sizeof(NullGOTEntryContent));
+  }
+
+  StringRef getStubBlockContent() {
+    return StringRef(reinterpret_cast<const char *>(StubContent),
+                     sizeof(StubContent));
+  }
+
+  static const uint8_t NullGOTEntryContent[8];
+  static const uint8_t StubContent[6];
+  Section *GOTSection = nullptr;
+  Section *StubsSection = nullptr;
+};
+
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::NullGOTEntryContent[8] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+const uint8_t ELF_x86_64_GOTAndStubsBuilder::StubContent[6] = {
+    0xFF, 0x25, 0x00, 0x00, 0x00, 0x00};
+} // namespace
+
+namespace llvm {
+namespace jitlink {
+
+class ELFJITLinker_x86_64 : public JITLinker<ELFJITLinker_x86_64> {
+  friend class JITLinker<ELFJITLinker_x86_64>;
+
+public:
+  ELFJITLinker_x86_64(std::unique_ptr<JITLinkContext> Ctx,
+                      PassConfiguration PassConfig)
+      : JITLinker(std::move(Ctx), std::move(PassConfig)) {}
+
+private:
+  StringRef getEdgeKindName(Edge::Kind R) const override {
+    return getELFX86RelocationKindName(R);
+  }
+
+  Expected<std::unique_ptr<LinkGraph>>
+  buildGraph(MemoryBufferRef ObjBuffer) override {
+    auto ELFObj = object::ELFFile<object::ELF64LE>::create(ObjBuffer.getBuffer());
+    if (!ELFObj)
+      return ELFObj.takeError();
+    return ELFLinkGraphBuilder_x86_64(ObjBuffer.getBufferIdentifier(), *ELFObj)
+        .buildGraph();
+  }
+
+  static Error targetOutOfRangeError(const Block &B, const Edge &E) {
+    std::string ErrMsg;
+    {
+      raw_string_ostream ErrStream(ErrMsg);
+      ErrStream << "Relocation target out of range: ";
+      printEdge(ErrStream, B, E, getELFX86RelocationKindName(E.getKind()));
+      ErrStream << "\n";
+    }
+    return make_error<JITLinkError>(std::move(ErrMsg));
+  }
+
+  Error applyFixup(Block &B, const Edge &E, char *BlockWorkingMem) const {
+
+    using namespace support;
+
+    char *FixupPtr = BlockWorkingMem + E.getOffset();
+    JITTargetAddress FixupAddress = B.getAddress() + E.getOffset();
+
+    switch (E.getKind()) {
+    case Branch32:
+    case PCRel32: {
+      int64_t Value =
+          E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      if (Value < std::numeric_limits<int32_t>::min() ||
+          Value > std::numeric_limits<int32_t>::max())
+        return targetOutOfRangeError(B, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case NegDelta32: {
+      int64_t Value =
+          FixupAddress - (E.getTarget().getAddress() + E.getAddend());
+      if (Value < std::numeric_limits<int32_t>::min() ||
+          Value > std::numeric_limits<int32_t>::max())
+        return targetOutOfRangeError(B, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    case Delta64: {
+      int64_t Value =
+          E.getTarget().getAddress() + E.getAddend() - FixupAddress;
+      *(little64_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer64: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      *(ulittle64_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32: {
+      uint64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (Value > std::numeric_limits<uint32_t>::max())
+        return targetOutOfRangeError(B, E);
+      *(ulittle32_t *)FixupPtr = Value;
+      break;
+    }
+    case Pointer32Signed: {
+      int64_t Value = E.getTarget().getAddress() + E.getAddend();
+      if (Value < std::numeric_limits<int32_t>::min() ||
+          Value > std::numeric_limits<int32_t>::max())
+        return targetOutOfRangeError(B, E);
+      *(little32_t *)FixupPtr = Value;
+      break;
+    }
+    default:
+      llvm_unreachable("Unrecognized edge kind");
+    }
+
+    return Error::success();
+  }
+};
+
+void jitLink_ELF_x86_64(std::unique_ptr<JITLinkContext> Ctx) {
+  PassConfiguration Config;
+  Triple TT("x86_64-unknown-linux");
+
+  if (Ctx->shouldAddDefaultTargetPasses(TT)) {
+    // Add eh-frame passes. Splitting .eh_frame into records and adding
+    // keep-alive edges from functions to their FDEs keeps the unwind info of
+    // live functions from being dead-stripped.
+    Config.PrePrunePasses.push_back(EHFrameSplitter(".eh_frame"));
+    Config.PrePrunePasses.push_back(EHFrameEdgeFixer(
+        ".eh_frame", NegDelta32, Delta64, Delta64, PCRel32));
+    Config.PrePrunePasses.push_back(EHFrameNullTerminator(".eh_frame"));
+
+    // Add a mark-live pass.
+    if (auto MarkLive = Ctx->getMarkLivePass(TT))
+      Config.PrePrunePasses.push_back(std::move(MarkLive));
+    else
+      Config.PrePrunePasses.push_back(markAllSymbolsLive);
+
+    // Add an in-place GOT/Stubs pass.
+    Config.PostPrunePasses.push_back([](LinkGraph &G) -> Error {
+      ELF_x86_64_GOTAndStubsBuilder(G).run();
+      return Error::success();
+    });
+  }
+
+  if (auto Err = Ctx->modifyPassConfig(TT, Config))
+    return Ctx->notifyFailed(std::move(Err));
+
+  // Construct a JITLinker and run the link function.
+  ELFJITLinker_x86_64::link(std::move(Ctx), std::move(Config));
+}
+
+StringRef getELFX86RelocationKindName(Edge::Kind R) {
+  switch (R) {
+  case Branch32:
+    return "Branch32";
+  case Pointer32:
+    return "Pointer32";
+  case Pointer32Signed:
+    return "Pointer32Signed";
+  case Pointer64:
+    return "Pointer64";
+  case PCRel32:
+    return "PCRel32";
+  case PCRel32GOTLoad:
+    return "PCRel32GOTLoad";
+  case Delta64:
+    return "Delta64";
+  case NegDelta32:
+    return "NegDelta32";
+  default:
+    return getGenericEdgeKindName(static_cast<Edge::Kind>(R));
+  }
+}
+
+} // end namespace jitlink
+} // end namespace llvm
@@ -128,5 +128,178 @@ InProcessMemoryManager::allocate(const SegmentsRequestMap &Request) {
       new IPMMAlloc(std::move(Blocks)));
 }
 
+static const sys::Memory::ProtectionFlags SlabReadWrite =
+    static_cast<sys::Memory::ProtectionFlags>(sys::Memory::MF_READ |
+                                              sys::Memory::MF_WRITE);
+
+class SlabMemoryManager::SlabAllocation : public Allocation {
+public:
+  SlabAllocation(SlabMemoryManager &MemMgr, AllocationMap SegBlocks)
+      : MemMgr(MemMgr), SegBlocks(std::move(SegBlocks)) {}
+  MutableArrayRef<char> getWorkingMemory(ProtectionFlags Seg) override {
+    assert(SegBlocks.count(Seg) && "No allocation for segment");
+    return {static_cast<char *>(SegBlocks[Seg].base()),
+            SegBlocks[Seg].allocatedSize()};
+  }
+  JITTargetAddress getTargetMemory(ProtectionFlags Seg) override {
+    assert(SegBlocks.count(Seg) && "No allocation for segment");
+    return reinterpret_cast<JITTargetAddress>(SegBlocks[Seg].base());
+  }
+  void finalizeAsync(FinalizeContinuation OnFinalize) override {
+    OnFinalize(applyProtections());
+  }
+  Error deallocate() override {
+    MemMgr.releaseBlocks(SegBlocks);
+    return Error::success();
+  }
+
+private:
+  Error applyProtections() {
+    for (auto &KV : SegBlocks) {
+      auto Prot = static_cast<sys::Memory::ProtectionFlags>(KV.first);
+      auto &Block = KV.second;
+      // Segment memory is handed out read-write, so read-write segments
+      // don't need a permission change.
+      if (Prot != SlabReadWrite)
+        if (auto EC = sys::Memory::protectMappedMemory(Block, Prot))
+          return errorCodeToError(EC);
+      if (Prot & sys::Memory::MF_EXEC)
+        sys::Memory::InvalidateInstructionCache(Block.base(),
+                                                Block.allocatedSize());
+    }
+    return Error::success();
+  }
+
+  SlabMemoryManager &MemMgr;
+  AllocationMap SegBlocks;
+};
+
+SlabMemoryManager::~SlabMemoryManager() {
+  for (auto &KV : Pools)
+    for (auto &Slab : KV.second.Slabs)
+      sys::Memory::releaseMappedMemory(Slab);
+}
+
+Expected<sys::MemoryBlock> SlabMemoryManager::allocateBlock(unsigned Prot,
+                                                            size_t Size) {
+  auto &P = Pools[Prot];
+
+  // Reuse the smallest recycled block that is large enough. Only the part
+  // that is handed out is made writable again.
+  auto FreeI = P.FreeBlocks.lower_bound(Size);
+  if (FreeI != P.FreeBlocks.end()) {
+    size_t FreeSize = FreeI->first;
+    FreeBlock Free = FreeI->second;
+    sys::MemoryBlock Block(Free.Base, Size);
+    if (Free.IsProtected)
+      if (auto EC = sys::Memory::protectMappedMemory(Block, SlabReadWrite))
+        return errorCodeToError(EC);
+    P.FreeBlocks.erase(FreeI);
+    if (FreeSize > Size)
+      P.FreeBlocks.insert(std::make_pair(
+          FreeSize - Size, FreeBlock{Free.Base + Size, Free.IsProtected}));
+    return Block;
+  }
+
+  if (static_cast<size_t>(P.End - P.Next) < Size) {
+    // Ask for the new slab to be placed after the previous one so that the
+    // system has a chance to merge their mappings.
+    auto Flags = static_cast<sys::Memory::ProtectionFlags>(
+        SlabReadWrite | sys::Memory::MF_HUGE_HINT);
+    const sys::MemoryBlock *Near = P.Slabs.empty() ? nullptr : &P.Slabs.back();
+    std::error_code EC;
+    auto Slab = sys::Memory::allocateMappedMemory(std::max(Size, SlabSize),
+                                                  Near, Flags, EC);
+    if (EC)
+      return errorCodeToError(EC);
+    P.Slabs.push_back(Slab);
+
+    // A segment that needs a whole slab of its own leaves the current slab
+    // alone.
+    char *SlabStart = static_cast<char *>(Slab.base());
+    if (Size >= SlabSize) {
+      if (Slab.allocatedSize() > Size)
+        P.FreeBlocks.insert(std::make_pair(
+            Slab.allocatedSize() - Size, FreeBlock{SlabStart + Size, false}));
+      return sys::MemoryBlock(SlabStart, Size);
+    }
+
+    // Keep the tail of the previous slab around for smaller segments.
+    if (P.Next != P.End)
+      P.FreeBlocks.insert(
+          std::make_pair(P.End - P.Next, FreeBlock{P.Next, false}));
+    P.Next = SlabStart;
+    P.End = SlabStart + Slab.allocatedSize();
+  }
+
+  sys::MemoryBlock Block(P.Next, Size);
+  P.Next += Size;
+  return Block;
+}
+
+void SlabMemoryManager::releaseBlocks(AllocationMap &Blocks) {
+  std::lock_guard<std::mutex> Lock(PoolsMutex);
+  for (auto &KV : Blocks) {
+    auto &Block = KV.second;
+    // The permissions are left alone until the memory is reused, so that
+    // deallocating doesn't cost a system call per segment, and memory that is
+    // never reused doesn't need one at all.
+    Pools[KV.first].FreeBlocks.insert(std::make_pair(
+        Block.allocatedSize(),
+        FreeBlock{static_cast<char *>(Block.base()),
+                  KV.first != SlabReadWrite}));
+  }
+  Blocks.clear();
+}
+
+Expected<std::unique_ptr<JITLinkMemoryManager::Allocation>>
+SlabMemoryManager::allocate(const SegmentsRequestMap &Request) {
+  const size_t PageSize = sys::Process::getPageSizeEstimate();
+  if (!isPowerOf2_64((uint64_t)PageSize))
+    return make_error<StringError>("Page size is not a power of 2",
+                                   inconvertibleErrorCode());
+
+  for (auto &KV : Request)
+    if (KV.second.getAlignment() > PageSize)
+      return make_error<StringError>("Cannot request higher than page "
+                                     "alignment",
+                                     inconvertibleErrorCode());
+
+  AllocationMap Blocks;
+  {
+    std::lock_guard<std::mutex> Lock(PoolsMutex);
+    for (auto &KV : Request) {
+      const auto &Seg = KV.second;
+
+      // Every segment gets at least one page so that each has a distinct
+      // address.
+      uint64_t SegmentSize =
+          std::max<uint64_t>(alignTo(Seg.getContentSize() +
+                                         Seg.getZeroFillSize(),
+                                     PageSize),
+                             PageSize);
+
+      auto SegMem = allocateBlock(KV.first, SegmentSize);
+      if (!SegMem) {
+        for (auto &BlockKV : Blocks)
+          Pools[BlockKV.first].FreeBlocks.insert(std::make_pair(
+              BlockKV.second.allocatedSize(),
+              FreeBlock{static_cast<char *>(BlockKV.second.base()), false}));
+        return SegMem.takeError();
+      }
+
+      // Zero out the zero-fill memory. Recycled memory may hold stale data.
+      memset(static_cast<char *>(SegMem->base()) + Seg.getContentSize(), 0,
+             Seg.getZeroFillSize());
+
+      // Record the block for this segment.
+      Blocks[KV.first] = std::move(*SegMem);
+    }
+  }
+
+  return std::unique_ptr<JITLinkMemoryManager::Allocation>(
+      new SlabAllocation(*this, std::move(Blocks)));
+}
+
 } // end namespace jitlink
 } // end namespace llvm
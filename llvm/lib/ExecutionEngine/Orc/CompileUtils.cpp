@@ -46,9 +46,11 @@ Expected<SimpleCompiler::CompileResult> SimpleCompiler::operator()(Module &M) {
 
     legacy::PassManager PM;
     MCContext *Ctx;
-    if (TM.addPassesToEmitMC(PM, Ctx, ObjStream))
+    if (TM.addPassesToEmitMC(PM, Ctx, ObjStream)) {
+      notifyCompileFailed(M);
       return make_error<StringError>("Target does not support MC emission",
                                      inconvertibleErrorCode());
+    }
     PM.run(M);
   }
 
@@ -57,8 +59,10 @@ Expected<SimpleCompiler::CompileResult> SimpleCompiler::operator()(Module &M) {
 
   auto Obj = object::ObjectFile::createObjectFile(ObjBuffer->getMemBufferRef());
 
-  if (!Obj)
+  if (!Obj) {
+    notifyCompileFailed(M);
     return Obj.takeError();
+  }
 
   notifyObjectCompiled(M, *ObjBuffer);
   return std::move(ObjBuffer);
@@ -78,16 +82,46 @@ void SimpleCompiler::notifyObjectCompiled(const Module &M,
     ObjCache->notifyObjectCompiled(&M, ObjBuffer.getMemBufferRef());
 }
 
+void SimpleCompiler::notifyCompileFailed(const Module &M) {
+  if (ObjCache)
+    ObjCache->notifyCompileFailed(&M);
+}
+
 ConcurrentIRCompiler::ConcurrentIRCompiler(JITTargetMachineBuilder JTMB,
                                            ObjectCache *ObjCache)
     : IRCompiler(irManglingOptionsFromTargetOptions(JTMB.getOptions())),
       JTMB(std::move(JTMB)), ObjCache(ObjCache) {}
 
+ConcurrentIRCompiler::~ConcurrentIRCompiler() {}
+
 Expected<std::unique_ptr<MemoryBuffer>>
 ConcurrentIRCompiler::operator()(Module &M) {
-  auto TM = cantFail(JTMB.createTargetMachine());
-  SimpleCompiler C(*TM, ObjCache);
-  return C(M);
+  auto TM = acquireTargetMachine();
+  if (!TM)
+    return TM.takeError();
+  auto Result = SimpleCompiler(**TM, ObjCache)(M);
+  releaseTargetMachine(std::move(*TM));
+  return Result;
+}
+
+Expected<std::unique_ptr<TargetMachine>>
+ConcurrentIRCompiler::acquireTargetMachine() {
+  {
+    std::lock_guard<std::mutex> Lock(TMPoolMutex);
+    if (!TMPool.empty()) {
+      auto TM = std::move(TMPool.back());
+      TMPool.pop_back();
+      return std::move(TM);
+    }
+  }
+  // Building a TargetMachine is comparatively slow, so do it outside the lock.
+  return JTMB.createTargetMachine();
+}
+
+void ConcurrentIRCompiler::releaseTargetMachine(
+    std::unique_ptr<TargetMachine> TM) {
+  std::lock_guard<std::mutex> Lock(TMPoolMutex);
+  TMPool.push_back(std::move(TM));
 }
 
 } // end namespace orc
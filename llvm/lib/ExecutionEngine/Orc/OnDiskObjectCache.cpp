@@ -0,0 +1,121 @@
+//===------ OnDiskObjectCache.cpp - Persistent object cache for ORC -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/OnDiskObjectCache.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "orc"
+
+namespace llvm {
+namespace orc {
+
+OnDiskObjectCache::OnDiskObjectCache(std::string CacheDir,
+                                     std::string ExtraKey)
+    : CacheDir(std::move(CacheDir)), ExtraKey(std::move(ExtraKey)) {}
+
+std::string OnDiskObjectCache::computeKey(const Module &M) const {
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream BitcodeStream(Bitcode);
+    WriteBitcodeToFile(M, BitcodeStream);
+  }
+
+  SHA1 Hasher;
+  Hasher.update(StringRef(Bitcode.data(), Bitcode.size()));
+  Hasher.update(ExtraKey);
+  return toHex(Hasher.result());
+}
+
+std::string OnDiskObjectCache::getEntryPath(StringRef Key) const {
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, "llvmorc-" + Key + ".o");
+  return std::string(Path.str());
+}
+
+std::unique_ptr<MemoryBuffer> OnDiskObjectCache::getObject(const Module *M) {
+  std::string Key = computeKey(*M);
+
+  auto ObjOrErr = MemoryBuffer::getFile(getEntryPath(Key), /*FileSize=*/-1,
+                                        /*RequiresNullTerminator=*/false);
+  if (ObjOrErr) {
+    LLVM_DEBUG(dbgs() << "Object for " << M->getModuleIdentifier()
+                      << " loaded from cache entry " << Key << "\n");
+    return std::move(*ObjOrErr);
+  }
+
+  LLVM_DEBUG(dbgs() << "No cache entry " << Key << " for "
+                    << M->getModuleIdentifier() << "\n");
+  std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+  PendingKeys[M] = std::move(Key);
+  return nullptr;
+}
+
+void OnDiskObjectCache::notifyObjectCompiled(const Module *M,
+                                             MemoryBufferRef Obj) {
+  std::string Key;
+  {
+    std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+    auto I = PendingKeys.find(M);
+    // Without the key computed before code generation there's no way to tell
+    // which module this object came from.
+    if (I == PendingKeys.end())
+      return;
+    Key = std::move(I->second);
+    PendingKeys.erase(I);
+  }
+
+  if (sys::fs::create_directories(CacheDir))
+    return;
+
+  // Write to a temporary file and rename it into place, so that concurrent
+  // readers never observe a partially written entry.
+  auto Temp = sys::fs::TempFile::create(CacheDir + "/llvmorc-" + Key +
+                                        "-%%%%%%.tmp.o");
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+
+  bool WriteFailed;
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Obj.getBuffer();
+    OS.flush();
+    WriteFailed = OS.has_error();
+    OS.clear_error();
+  }
+
+  if (WriteFailed) {
+    consumeError(Temp->discard());
+    return;
+  }
+
+  if (auto Err = Temp->keep(getEntryPath(Key))) {
+    consumeError(std::move(Err));
+    consumeError(Temp->discard());
+  }
+}
+
+void OnDiskObjectCache::notifyCompileFailed(const Module *M) {
+  // Forget the key, so that it is neither leaked nor used for an object of
+  // another module that is later allocated at the same address.
+  std::lock_guard<std::mutex> Lock(PendingKeysMutex);
+  PendingKeys.erase(M);
+}
+
+} // end namespace orc
+} // end namespace llvm
@@ -125,6 +125,75 @@ BlockFreqQuery::ResultTy BlockFreqQuery::operator()(Function &F) {
   return CallerAndCalles;
 }
 
+// ProfileGuidedQuery Implementations
+
+void ProfileGuidedQuery::findExecutedCalles(Function &F,
+                                            FunctionAnalysisManager &FAM,
+                                            DenseSet<StringRef> &Calles) {
+  auto IBBs = findBBwithCalls(F);
+  if (IBBs.empty())
+    return;
+
+  auto EntryCount = F.getEntryCount();
+  if (!EntryCount.hasValue()) {
+    for (const auto *BB : IBBs)
+      findCalles(BB, Calles);
+    return;
+  }
+
+  // The profile says this function never runs.
+  if (EntryCount.getCount() == 0)
+    return;
+
+  auto &BFI = FAM.getResult<BlockFrequencyAnalysis>(F);
+  for (const auto *BB : IBBs) {
+    auto Count = BFI.getBlockProfileCount(BB);
+    if (Count && *Count > 0)
+      findCalles(BB, Calles);
+  }
+}
+
+ProfileGuidedQuery::ResultTy ProfileGuidedQuery::operator()(Function &F) {
+  DenseMap<StringRef, DenseSet<StringRef>> CallerAndCalles;
+  DenseSet<StringRef> Calles;
+
+  PassBuilder PB;
+  FunctionAnalysisManager FAM;
+  PB.registerFunctionAnalyses(FAM);
+
+  findExecutedCalles(F, FAM, Calles);
+
+  // Walk further down the call graph, one level of callees at a time. Only
+  // callees defined in this module can be looked into.
+  SmallVector<StringRef, 8> Worklist(Calles.begin(), Calles.end());
+  DenseSet<StringRef> Visited = Calles;
+  Visited.insert(F.getName());
+  for (unsigned Depth = 1; Depth < Horizon && !Worklist.empty(); ++Depth) {
+    SmallVector<StringRef, 8> NextWorklist;
+    for (StringRef Name : Worklist) {
+      auto *Callee = F.getParent()->getFunction(Name);
+      if (!Callee || Callee->isDeclaration())
+        continue;
+
+      DenseSet<StringRef> CalleeCalles;
+      findExecutedCalles(*Callee, FAM, CalleeCalles);
+      for (StringRef Next : CalleeCalles)
+        if (Visited.insert(Next).second) {
+          Calles.insert(Next);
+          NextWorklist.push_back(Next);
+        }
+    }
+    Worklist = std::move(NextWorklist);
+  }
+
+  if (Calles.empty())
+    return None;
+
+  CallerAndCalles.insert({F.getName(), std::move(Calles)});
+
+  return CallerAndCalles;
+}
+
 // SequenceBBQuery Implementation
 std::size_t SequenceBBQuery::getHottestBlocks(std::size_t TotalBlocks) {
   if (TotalBlocks == 1)
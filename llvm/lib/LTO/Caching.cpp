@@ -148,3 +148,47 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
     };
   };
 }
+
+Expected<NativeObjectCache>
+lto::remoteCache(StringRef CacheDirectoryPath,
+                 std::shared_ptr<RemoteCacheStore> Store,
+                 AddBufferFn AddBuffer) {
+  Expected<NativeObjectCache> LocalOrErr =
+      localCache(CacheDirectoryPath, AddBuffer);
+  if (!LocalOrErr)
+    return LocalOrErr.takeError();
+  NativeObjectCache Local = std::move(*LocalOrErr);
+
+  return [=](unsigned Task, StringRef Key) -> AddStreamFn {
+    // A local hit is added to the link by the local cache.
+    AddStreamFn AddStream = Local(Task, Key);
+    if (!AddStream)
+      return AddStreamFn();
+
+    // On a remote hit, copy the object into the local cache. This also adds
+    // it to the link.
+    Expected<std::unique_ptr<MemoryBuffer>> MBOrErr = Store->fetch(Key);
+    if (!MBOrErr)
+      consumeError(MBOrErr.takeError());
+    else if (*MBOrErr) {
+      AddStream(Task)->OS->write((*MBOrErr)->getBufferStart(),
+                                 (*MBOrErr)->getBufferSize());
+      return AddStreamFn();
+    }
+
+    // Miss everywhere: the caller builds the object. Write it through a local
+    // cache whose buffer callback also uploads it to the store.
+    std::string KeyStr = Key.str();
+    Expected<NativeObjectCache> UploadingOrErr = localCache(
+        CacheDirectoryPath,
+        [=](unsigned Task, std::unique_ptr<MemoryBuffer> MB) {
+          consumeError(Store->store(KeyStr, MB->getMemBufferRef()));
+          AddBuffer(Task, std::move(MB));
+        });
+    if (!UploadingOrErr) {
+      consumeError(UploadingOrErr.takeError());
+      return AddStream;
+    }
+    return (*UploadingOrErr)(Task, Key);
+  };
+}
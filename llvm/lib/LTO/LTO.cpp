@@ -34,6 +34,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/SourceMgr.h"
@@ -373,10 +374,32 @@ void llvm::thinLTOResolvePrevailingInIndex(
       if (auto AS = dyn_cast<AliasSummary>(S.get()))
         GlobalInvolvedWithAlias.insert(&AS->getAliasee());
 
+  // Each GUID only updates its own summaries, so they can be resolved in
+  // parallel. The linkage changes are buffered per GUID and reported in index
+  // order afterwards, because recordNewLinkage need not be thread safe.
+  struct NewLinkage {
+    StringRef ModulePath;
+    GlobalValue::LinkageTypes Linkage;
+  };
+  std::vector<ValueInfo> VIs;
+  VIs.reserve(Index.size());
   for (auto &I : Index)
-    thinLTOResolvePrevailingGUID(Index.getValueInfo(I), GlobalInvolvedWithAlias,
-                                 isPrevailing, recordNewLinkage,
-                                 GUIDPreservedSymbols);
+    VIs.push_back(Index.getValueInfo(I));
+  std::vector<SmallVector<NewLinkage, 1>> NewLinkages(VIs.size());
+
+  parallel::for_each_n(parallel::par, size_t(0), VIs.size(), [&](size_t I) {
+    thinLTOResolvePrevailingGUID(
+        VIs[I], GlobalInvolvedWithAlias, isPrevailing,
+        [&](StringRef ModulePath, GlobalValue::GUID,
+            GlobalValue::LinkageTypes Linkage) {
+          NewLinkages[I].push_back({ModulePath, Linkage});
+        },
+        GUIDPreservedSymbols);
+  });
+
+  for (size_t I = 0, E = VIs.size(); I != E; ++I)
+    for (const NewLinkage &L : NewLinkages[I])
+      recordNewLinkage(L.ModulePath, VIs[I].getGUID(), L.Linkage);
 }
 
 static bool isWeakObjectWithRWAccess(GlobalValueSummary *GVS) {
@@ -422,9 +445,34 @@ void llvm::thinLTOInternalizeAndPromoteInIndex(
     function_ref<bool(StringRef, ValueInfo)> isExported,
     function_ref<bool(GlobalValue::GUID, const GlobalValueSummary *)>
         isPrevailing) {
+  // Each GUID only updates its own summaries, except that
+  // isWeakObjectWithRWAccess() looks through aliases at the linkage of their
+  // aliasees. GUIDs involved with aliases are therefore handled serially in
+  // index order after the others have been processed in parallel, which gives
+  // the same result as processing everything serially.
+  DenseSet<const GlobalValueSummary *> Aliasees;
   for (auto &I : Index)
-    thinLTOInternalizeAndPromoteGUID(Index.getValueInfo(I), isExported,
-                                     isPrevailing);
+    for (auto &S : I.second.SummaryList)
+      if (auto *AS = dyn_cast<AliasSummary>(S.get()))
+        Aliasees.insert(&AS->getAliasee());
+
+  std::vector<ValueInfo> Independent, InvolvedWithAlias;
+  Independent.reserve(Index.size());
+  for (auto &I : Index) {
+    ValueInfo VI = Index.getValueInfo(I);
+    bool Involved = llvm::any_of(VI.getSummaryList(), [&](const auto &S) {
+      return isa<AliasSummary>(S.get()) || Aliasees.count(S.get());
+    });
+    (Involved ? InvolvedWithAlias : Independent).push_back(VI);
+  }
+
+  parallel::for_each(parallel::par, Independent.begin(), Independent.end(),
+                     [&](ValueInfo VI) {
+                       thinLTOInternalizeAndPromoteGUID(VI, isExported,
+                                                        isPrevailing);
+                     });
+  for (ValueInfo VI : InvolvedWithAlias)
+    thinLTOInternalizeAndPromoteGUID(VI, isExported, isPrevailing);
 }
 
 // Requires a destructor for std::vector<InputModule>.
@@ -1384,7 +1432,7 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
 
   auto isPrevailing = [&](GlobalValue::GUID GUID,
                           const GlobalValueSummary *S) {
-    return ThinLTO.PrevailingModuleForGUID[GUID] == S->modulePath();
+    return ThinLTO.PrevailingModuleForGUID.lookup(GUID) == S->modulePath();
   };
   thinLTOInternalizeAndPromoteInIndex(ThinLTO.CombinedIndex, isExported,
                                       isPrevailing);
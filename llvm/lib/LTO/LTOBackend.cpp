@@ -412,7 +412,7 @@ void splitCodeGen(const Config &C, TargetMachine *TM, AddStreamFn AddStream,
             // copied into the thread's context.
             std::move(BC), ThreadCount++);
       },
-      false);
+      /*PreserveLocals=*/false);
 
   // Because the inner lambda (which runs in a worker thread) captures our local
   // variables, we need to wait for the worker threads to terminate before we
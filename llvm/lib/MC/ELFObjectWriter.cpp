@@ -39,6 +39,7 @@
 #include "llvm/Support/Alignment.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
@@ -46,6 +47,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/SwapByteOrder.h"
@@ -65,6 +67,14 @@ using namespace llvm;
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "reloc-info"
 
+// Compressing debug sections and encoding relocations only depend on the
+// finished layout and symbol table, so with this option they are done for all
+// sections up front on several threads. The results are still written out in
+// section order, so the object file doesn't change.
+static cl::opt<bool> ParallelWrite(
+    "elf-parallel-write", cl::Hidden, cl::init(false),
+    cl::desc("Compress debug sections and encode relocations in parallel"));
+
 namespace {
 
 using SectionIndexMapTy = DenseMap<const MCSectionELF *, uint32_t>;
@@ -162,6 +172,24 @@ struct ELFWriter {
                              SmallVectorImpl<char> &CompressedContents,
                              bool ZLibStyle, unsigned Alignment);
 
+  /// The contents of a debug section, compressed ahead of time by
+  /// compressDebugSections.
+  struct CompressedSectionData {
+    SmallVector<char, 0> Uncompressed;
+    SmallVector<char, 0> Compressed;
+    bool CompressionFailed = false;
+  };
+  DenseMap<const MCSectionELF *, CompressedSectionData> CompressedSections;
+
+  bool shouldCompressSection(const MCAssembler &Asm,
+                             const MCSectionELF &Section) const;
+  bool shouldWriteSection(const MCSectionELF &Section) const;
+  void compressDebugSections(const MCAssembler &Asm,
+                             const MCAsmLayout &Layout);
+  void writeCompressedSectionData(MCContext &MC, MCSectionELF &Section,
+                                  SmallVectorImpl<char> &UncompressedData,
+                                  SmallVectorImpl<char> *CompressedContents);
+
 public:
   ELFWriter(ELFObjectWriter &OWriter, raw_pwrite_stream &OS,
             bool IsLittleEndian, DwoMode Mode)
@@ -220,7 +248,8 @@ public:
                         uint32_t Link, uint32_t Info, uint64_t Alignment,
                         uint64_t EntrySize);
 
-  void writeRelocations(const MCAssembler &Asm, const MCSectionELF &Sec);
+  void writeRelocations(const MCAssembler &Asm, const MCSectionELF &Sec,
+                        support::endian::Writer &RW);
 
   uint64_t writeObject(MCAssembler &Asm, const MCAsmLayout &Layout);
   void writeSection(const SectionIndexMapTy &SectionIndexMap,
@@ -840,28 +869,76 @@ bool ELFWriter::maybeWriteCompression(
   return true;
 }
 
+bool ELFWriter::shouldCompressSection(const MCAssembler &Asm,
+                                      const MCSectionELF &Section) const {
+  // Compressing debug_frame requires handling alignment fragments which is
+  // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
+  // for writing to arbitrary buffers) for little benefit.
+  StringRef SectionName = Section.getSectionName();
+  const MCAsmInfo *MAI = Asm.getContext().getAsmInfo();
+  return MAI->compressDebugSections() != DebugCompressionType::None &&
+         SectionName.startswith(".debug_") && SectionName != ".debug_frame";
+}
+
+bool ELFWriter::shouldWriteSection(const MCSectionELF &Section) const {
+  if (Mode == NonDwoOnly && isDwoSection(Section))
+    return false;
+  if (Mode == DwoOnly && !isDwoSection(Section))
+    return false;
+  return true;
+}
+
+void ELFWriter::compressDebugSections(const MCAssembler &Asm,
+                                      const MCAsmLayout &Layout) {
+  std::vector<const MCSectionELF *> Sections;
+  for (const MCSection &Sec : Asm) {
+    const MCSectionELF &Section = static_cast<const MCSectionELF &>(Sec);
+    if (shouldWriteSection(Section) && shouldCompressSection(Asm, Section))
+      Sections.push_back(&Section);
+  }
+  if (Sections.empty())
+    return;
+
+  // Writing out the fragments uses the assembler, so do it serially, and
+  // only compress in parallel.
+  for (const MCSectionELF *Section : Sections) {
+    CompressedSectionData &Data = CompressedSections[Section];
+    raw_svector_ostream VecOS(Data.Uncompressed);
+    Asm.writeSectionData(VecOS, Section, Layout);
+  }
+
+  parallel::for_each_n(parallel::par, size_t(0), Sections.size(),
+                       [&](size_t I) {
+                         CompressedSectionData &Data =
+                             CompressedSections.find(Sections[I])->second;
+                         StringRef Uncompressed(Data.Uncompressed.data(),
+                                                Data.Uncompressed.size());
+                         if (Error E = zlib::compress(Uncompressed,
+                                                      Data.Compressed)) {
+                           consumeError(std::move(E));
+                           Data.CompressionFailed = true;
+                         }
+                       });
+}
+
 void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
                                  const MCAsmLayout &Layout) {
   MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
-  StringRef SectionName = Section.getSectionName();
+  MCContext &MC = Asm.getContext();
 
-  auto &MC = Asm.getContext();
-  const auto &MAI = MC.getAsmInfo();
-
-  // Compressing debug_frame requires handling alignment fragments which is
-  // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
-  // for writing to arbitrary buffers) for little benefit.
-  bool CompressionEnabled =
-      MAI->compressDebugSections() != DebugCompressionType::None;
-  if (!CompressionEnabled || !SectionName.startswith(".debug_") ||
-      SectionName == ".debug_frame") {
+  if (!shouldCompressSection(Asm, Section)) {
     Asm.writeSectionData(W.OS, &Section, Layout);
     return;
   }
 
-  assert((MAI->compressDebugSections() == DebugCompressionType::Z ||
-          MAI->compressDebugSections() == DebugCompressionType::GNU) &&
-         "expected zlib or zlib-gnu style compression");
+  auto It = CompressedSections.find(&Section);
+  if (It != CompressedSections.end()) {
+    CompressedSectionData &Data = It->second;
+    writeCompressedSectionData(
+        MC, Section, Data.Uncompressed,
+        Data.CompressionFailed ? nullptr : &Data.Compressed);
+    return;
+  }
 
   SmallVector<char, 128> UncompressedData;
   raw_svector_ostream VecOS(UncompressedData);
@@ -872,13 +949,33 @@ void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
           StringRef(UncompressedData.data(), UncompressedData.size()),
           CompressedContents)) {
     consumeError(std::move(E));
+    writeCompressedSectionData(MC, Section, UncompressedData, nullptr);
+    return;
+  }
+  writeCompressedSectionData(MC, Section, UncompressedData,
+                             &CompressedContents);
+}
+
+/// Write the compressed contents of \p Section, or its uncompressed contents
+/// if compression failed (\p CompressedContents is null) or didn't make the
+/// section smaller.
+void ELFWriter::writeCompressedSectionData(
+    MCContext &MC, MCSectionELF &Section,
+    SmallVectorImpl<char> &UncompressedData,
+    SmallVectorImpl<char> *CompressedContents) {
+  const auto &MAI = MC.getAsmInfo();
+  assert((MAI->compressDebugSections() == DebugCompressionType::Z ||
+          MAI->compressDebugSections() == DebugCompressionType::GNU) &&
+         "expected zlib or zlib-gnu style compression");
+
+  if (!CompressedContents) {
     W.OS << UncompressedData;
     return;
   }
 
   bool ZlibStyle = MAI->compressDebugSections() == DebugCompressionType::Z;
-  if (!maybeWriteCompression(UncompressedData.size(), CompressedContents,
-                             ZlibStyle, Sec.getAlignment())) {
+  if (!maybeWriteCompression(UncompressedData.size(), *CompressedContents,
+                             ZlibStyle, Section.getAlignment())) {
     W.OS << UncompressedData;
     return;
   }
@@ -891,9 +988,10 @@ void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
     Section.setAlignment(is64Bit() ? Align(8) : Align(4));
   } else {
     // Add "z" prefix to section name. This is zlib-gnu style.
-    MC.renameELFSection(&Section, (".z" + SectionName.drop_front(1)).str());
+    MC.renameELFSection(&Section,
+                        (".z" + Section.getSectionName().drop_front(1)).str());
   }
-  W.OS << CompressedContents;
+  W.OS << *CompressedContents;
 }
 
 void ELFWriter::WriteSecHdrEntry(uint32_t Name, uint32_t Type, uint64_t Flags,
@@ -913,7 +1011,8 @@ void ELFWriter::WriteSecHdrEntry(uint32_t Name, uint32_t Type, uint64_t Flags,
 }
 
 void ELFWriter::writeRelocations(const MCAssembler &Asm,
-                                       const MCSectionELF &Sec) {
+                                 const MCSectionELF &Sec,
+                                 support::endian::Writer &RW) {
   std::vector<ELFRelocationEntry> &Relocs = OWriter.Relocations[&Sec];
 
   // We record relocations by pushing to the end of a vector. Reverse the vector
@@ -930,47 +1029,47 @@ void ELFWriter::writeRelocations(const MCAssembler &Asm,
     unsigned Index = Entry.Symbol ? Entry.Symbol->getIndex() : 0;
 
     if (is64Bit()) {
-      write(Entry.Offset);
+      RW.write(Entry.Offset);
       if (OWriter.TargetObjectWriter->getEMachine() == ELF::EM_MIPS) {
-        write(uint32_t(Index));
+        RW.write(uint32_t(Index));
 
-        write(OWriter.TargetObjectWriter->getRSsym(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType3(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType2(Entry.Type));
-        write(OWriter.TargetObjectWriter->getRType(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRSsym(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType3(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType2(Entry.Type));
+        RW.write(OWriter.TargetObjectWriter->getRType(Entry.Type));
       } else {
         struct ELF::Elf64_Rela ERE64;
         ERE64.setSymbolAndType(Index, Entry.Type);
-        write(ERE64.r_info);
+        RW.write(ERE64.r_info);
       }
       if (hasRelocationAddend())
-        write(Entry.Addend);
+        RW.write(Entry.Addend);
     } else {
-      write(uint32_t(Entry.Offset));
+      RW.write(uint32_t(Entry.Offset));
 
       struct ELF::Elf32_Rela ERE32;
       ERE32.setSymbolAndType(Index, Entry.Type);
-      write(ERE32.r_info);
+      RW.write(ERE32.r_info);
 
       if (hasRelocationAddend())
-        write(uint32_t(Entry.Addend));
+        RW.write(uint32_t(Entry.Addend));
 
       if (OWriter.TargetObjectWriter->getEMachine() == ELF::EM_MIPS) {
         if (uint32_t RType =
                 OWriter.TargetObjectWriter->getRType2(Entry.Type)) {
-          write(uint32_t(Entry.Offset));
+          RW.write(uint32_t(Entry.Offset));
 
           ERE32.setSymbolAndType(0, RType);
-          write(ERE32.r_info);
-          write(uint32_t(0));
+          RW.write(ERE32.r_info);
+          RW.write(uint32_t(0));
         }
         if (uint32_t RType =
                 OWriter.TargetObjectWriter->getRType3(Entry.Type)) {
-          write(uint32_t(Entry.Offset));
+          RW.write(uint32_t(Entry.Offset));
 
           ERE32.setSymbolAndType(0, RType);
-          write(ERE32.r_info);
-          write(uint32_t(0));
+          RW.write(ERE32.r_info);
+          RW.write(uint32_t(0));
         }
       }
     }
@@ -1083,14 +1182,14 @@ uint64_t ELFWriter::writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) {
   writeHeader(Asm);
 
   // ... then the sections ...
+  if (ParallelWrite)
+    compressDebugSections(Asm, Layout);
   SectionOffsetsTy SectionOffsets;
   std::vector<MCSectionELF *> Groups;
   std::vector<MCSectionELF *> Relocations;
   for (MCSection &Sec : Asm) {
     MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
-    if (Mode == NonDwoOnly && isDwoSection(Section))
-      continue;
-    if (Mode == DwoOnly && !isDwoSection(Section))
+    if (!shouldWriteSection(Section))
       continue;
 
     align(Section.getAlignment());
@@ -1173,14 +1272,33 @@ uint64_t ELFWriter::writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) {
     computeSymbolTable(Asm, Layout, SectionIndexMap, RevGroupMap,
                        SectionOffsets);
 
-    for (MCSectionELF *RelSection : Relocations) {
+    // With -elf-parallel-write, encode the relocations of every section into
+    // its own buffer first.
+    std::vector<SmallVector<char, 0>> EncodedRelocations;
+    if (ParallelWrite) {
+      EncodedRelocations.resize(Relocations.size());
+      parallel::for_each_n(
+          parallel::par, size_t(0), Relocations.size(), [&](size_t I) {
+            raw_svector_ostream OS(EncodedRelocations[I]);
+            support::endian::Writer RW(OS, W.Endian);
+            writeRelocations(
+                Asm, cast<MCSectionELF>(*Relocations[I]->getLinkedToSection()),
+                RW);
+          });
+    }
+
+    for (size_t I = 0, E = Relocations.size(); I != E; ++I) {
+      MCSectionELF *RelSection = Relocations[I];
       align(RelSection->getAlignment());
 
       // Remember the offset into the file for this section.
       uint64_t SecStart = W.OS.tell();
 
-      writeRelocations(Asm,
-                       cast<MCSectionELF>(*RelSection->getLinkedToSection()));
+      if (ParallelWrite)
+        W.OS << EncodedRelocations[I];
+      else
+        writeRelocations(
+            Asm, cast<MCSectionELF>(*RelSection->getLinkedToSection()), W);
 
       uint64_t SecEnd = W.OS.tell();
       SectionOffsets[RelSection] = std::make_pair(SecStart, SecEnd);
@@ -755,6 +755,22 @@ MCAssembler::handleFixup(const MCAsmLayout &Layout, MCFragment &F,
   return std::make_tuple(Target, FixedValue, IsResolved);
 }
 
+/// Return true if \p F is of a kind that layoutSectionOnce may relax.
+static bool isRelaxableFragment(const MCFragment &F) {
+  switch (F.getKind()) {
+  case MCFragment::FT_Relaxable:
+  case MCFragment::FT_Dwarf:
+  case MCFragment::FT_DwarfFrame:
+  case MCFragment::FT_LEB:
+  case MCFragment::FT_BoundaryAlign:
+  case MCFragment::FT_CVInlineLines:
+  case MCFragment::FT_CVDefRange:
+    return true;
+  default:
+    return false;
+  }
+}
+
 void MCAssembler::layout(MCAsmLayout &Layout) {
   assert(getBackendPtr() && "Expected assembler backend");
   DEBUG_WITH_TYPE("mc-dump", {
@@ -782,10 +798,22 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
       Frag.setLayoutOrder(FragmentIndex++);
   }
 
+  // Collect the fragments which relaxation may change. Everything else has a
+  // size that is either fixed or recomputed by the layout itself, so there's
+  // no need to walk it on every iteration.
+  RelaxableFragments.assign(Sections.size(), {});
+  for (MCSection &Sec : *this)
+    for (MCFragment &Frag : Sec)
+      if (isRelaxableFragment(Frag))
+        RelaxableFragments[Sec.getOrdinal()].push_back(&Frag);
+
   // Layout until everything fits.
   while (layoutOnce(Layout))
-    if (getContext().hadError())
+    if (getContext().hadError()) {
+      RelaxableFragments.clear();
       return;
+    }
+  RelaxableFragments.clear();
 
   DEBUG_WITH_TYPE("mc-dump", {
       errs() << "assembler backend - post-relaxation\n--\n";
@@ -1113,44 +1141,43 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = nullptr;
 
-  // Attempt to relax all the fragments in the section.
-  for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
-    // Check if this is a fragment that needs relaxation.
+  // Attempt to relax all the fragments in the section which may need it.
+  for (MCFragment *F : RelaxableFragments[Sec.getOrdinal()]) {
     bool RelaxedFrag = false;
-    switch(I->getKind()) {
+    switch(F->getKind()) {
     default:
       break;
     case MCFragment::FT_Relaxable:
       assert(!getRelaxAll() &&
              "Did not expect a MCRelaxableFragment in RelaxAll mode");
-      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(I));
+      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(F));
       break;
     case MCFragment::FT_Dwarf:
       RelaxedFrag = relaxDwarfLineAddr(Layout,
-                                       *cast<MCDwarfLineAddrFragment>(I));
+                                       *cast<MCDwarfLineAddrFragment>(F));
       break;
     case MCFragment::FT_DwarfFrame:
       RelaxedFrag =
         relaxDwarfCallFrameFragment(Layout,
-                                    *cast<MCDwarfCallFrameFragment>(I));
+                                    *cast<MCDwarfCallFrameFragment>(F));
       break;
     case MCFragment::FT_LEB:
-      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
+      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(F));
       break;
     case MCFragment::FT_BoundaryAlign:
       RelaxedFrag =
-          relaxBoundaryAlign(Layout, *cast<MCBoundaryAlignFragment>(I));
+          relaxBoundaryAlign(Layout, *cast<MCBoundaryAlignFragment>(F));
       break;
     case MCFragment::FT_CVInlineLines:
       RelaxedFrag =
-          relaxCVInlineLineTable(Layout, *cast<MCCVInlineLineTableFragment>(I));
+          relaxCVInlineLineTable(Layout, *cast<MCCVInlineLineTableFragment>(F));
       break;
     case MCFragment::FT_CVDefRange:
-      RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(I));
+      RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(F));
       break;
     }
     if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+      FirstRelaxedFragment = F;
   }
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
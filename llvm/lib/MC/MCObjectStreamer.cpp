@@ -215,6 +215,27 @@ MCObjectStreamer::getOrCreateDataFragment(const MCSubtargetInfo *STI) {
   return F;
 }
 
+MutableArrayRef<MCFixup>
+MCObjectStreamer::encodeInstIntoFragment(MCDataFragment &DF,
+                                         const MCInst &Inst,
+                                         const MCSubtargetInfo &STI) {
+  SmallVectorImpl<MCFixup> &Fixups = DF.getFixups();
+  size_t CodeOffset = DF.getContents().size();
+  size_t FirstFixup = Fixups.size();
+
+  // Code emitters report fixup offsets relative to the start of the
+  // instruction, so rebase the new ones onto the fragment.
+  raw_svector_ostream VecOS(DF.getContents());
+  getAssembler().getEmitter().encodeInstruction(Inst, VecOS, Fixups, STI);
+  MutableArrayRef<MCFixup> NewFixups =
+      MutableArrayRef<MCFixup>(Fixups).drop_front(FirstFixup);
+  for (MCFixup &Fixup : NewFixups)
+    Fixup.setOffset(Fixup.getOffset() + CodeOffset);
+
+  DF.setHasInstructions(STI);
+  return NewFixups;
+}
+
 void MCObjectStreamer::visitUsedSymbol(const MCSymbol &Sym) {
   Assembler->registerSymbol(Sym);
 }
@@ -419,11 +440,9 @@ void MCObjectStreamer::EmitInstToFragment(const MCInst &Inst,
   MCRelaxableFragment *IF = new MCRelaxableFragment(Inst, STI);
   insert(IF);
 
-  SmallString<128> Code;
-  raw_svector_ostream VecOS(Code);
+  raw_svector_ostream VecOS(IF->getContents());
   getAssembler().getEmitter().encodeInstruction(Inst, VecOS, IF->getFixups(),
                                                 STI);
-  IF->getContents().append(Code.begin(), Code.end());
 }
 
 #ifndef NDEBUG
@@ -12,6 +12,8 @@
 
 #include "llvm/Object/ArchiveWriter.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/BinaryFormat/Magic.h"
 #include "llvm/IR/LLVMContext.h"
@@ -24,6 +26,7 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
@@ -385,10 +388,19 @@ getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
   return Ret;
 }
 
+// ld64 expects the members to be 8-byte aligned for 64-bit content and at
+// least 4-byte aligned for 32-bit content.  Opt for the larger encoding
+// uniformly.  This matches the behaviour with cctools and ensures that ld64
+// is happy with archives that we generate.
+static unsigned getMemberPadding(object::Archive::Kind Kind,
+                                 uint64_t DataSize) {
+  return isDarwin(Kind) ? offsetToAlignment(DataSize, Align(8)) : 0;
+}
+
 static Expected<std::vector<MemberData>>
 computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                   object::Archive::Kind Kind, bool Thin, bool Deterministic,
-                  ArrayRef<NewArchiveMember> NewMembers) {
+                  bool NeedSymbols, ArrayRef<NewArchiveMember> NewMembers) {
   static char PaddingData[8] = {'\n', '\n', '\n', '\n', '\n', '\n', '\n', '\n'};
 
   // This ignores the symbol table, but we only need the value mod 8 and the
@@ -453,19 +465,48 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
       Entry.second = Entry.second > 1 ? 1 : 0;
   }
 
+  // Reject oversized members up front, before any time is spent reading their
+  // symbols.
   for (const NewArchiveMember &M : NewMembers) {
+    MemoryBufferRef Buf = M.Buf->getMemBufferRef();
+    uint64_t DataSize = Thin ? 0 : Buf.getBufferSize();
+    if (Buf.getBufferSize() + getMemberPadding(Kind, DataSize) >
+        object::Archive::MaxMemberSize) {
+      std::string StringMsg =
+          "File " + M.MemberName.str() + " exceeds size limit";
+      return make_error<object::GenericBinaryError>(
+          std::move(StringMsg), object::object_error::parse_failed);
+    }
+  }
+
+  // Reading the symbols of a member means parsing it as an object or bitcode
+  // file, which dominates the time spent on archives with many members. Do it
+  // for all members in parallel, with each member's names going to a buffer
+  // of its own. The buffers are appended to SymNames in member order below,
+  // so the symbol table does not depend on scheduling.
+  std::vector<Optional<Expected<std::vector<unsigned>>>> MemberSymbols(
+      NewMembers.size());
+  std::vector<SmallString<0>> MemberSymNames(NewMembers.size());
+  std::vector<char> MemberHasObject(NewMembers.size());
+  if (NeedSymbols)
+    parallel::for_each_n(
+        parallel::par, size_t(0), NewMembers.size(), [&](size_t I) {
+          raw_svector_ostream Names(MemberSymNames[I]);
+          bool HasObj = false;
+          MemberSymbols[I].emplace(
+              getSymbols(NewMembers[I].Buf->getMemBufferRef(), Names, HasObj));
+          MemberHasObject[I] = HasObj;
+        });
+
+  for (size_t I = 0, E = NewMembers.size(); I != E; ++I) {
+    const NewArchiveMember &M = NewMembers[I];
     std::string Header;
     raw_string_ostream Out(Header);
 
     MemoryBufferRef Buf = M.Buf->getMemBufferRef();
     StringRef Data = Thin ? "" : Buf.getBuffer();
 
-    // ld64 expects the members to be 8-byte aligned for 64-bit content and at
-    // least 4-byte aligned for 32-bit content.  Opt for the larger encoding
-    // uniformly.  This matches the behaviour with cctools and ensures that ld64
-    // is happy with archives that we generate.
-    unsigned MemberPadding =
-        isDarwin(Kind) ? offsetToAlignment(Data.size(), Align(8)) : 0;
+    unsigned MemberPadding = getMemberPadding(Kind, Data.size());
     unsigned TailPadding =
         offsetToAlignment(Data.size() + MemberPadding, Align(2));
     StringRef Padding = StringRef(PaddingData, MemberPadding + TailPadding);
@@ -478,24 +519,30 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
       ModTime = M.ModTime;
 
     uint64_t Size = Buf.getBufferSize() + MemberPadding;
-    if (Size > object::Archive::MaxMemberSize) {
-      std::string StringMsg =
-          "File " + M.MemberName.str() + " exceeds size limit";
-      return make_error<object::GenericBinaryError>(
-          std::move(StringMsg), object::object_error::parse_failed);
-    }
-
     printMemberHeader(Out, Pos, StringTable, MemberNames, Kind, Thin, M,
                       ModTime, Size);
     Out.flush();
 
-    Expected<std::vector<unsigned>> Symbols =
-        getSymbols(Buf, SymNames, HasObject);
-    if (auto E = Symbols.takeError())
-      return std::move(E);
+    std::vector<unsigned> Symbols;
+    if (NeedSymbols) {
+      Expected<std::vector<unsigned>> &SymbolsOrErr = *MemberSymbols[I];
+      if (!SymbolsOrErr) {
+        for (size_t J = I + 1; J != E; ++J)
+          if (!*MemberSymbols[J])
+            consumeError(MemberSymbols[J]->takeError());
+        return SymbolsOrErr.takeError();
+      }
+      // Rebase the member's name offsets onto the combined name table.
+      uint64_t NamesBase = SymNames.tell();
+      Symbols = std::move(*SymbolsOrErr);
+      for (unsigned &Offset : Symbols)
+        Offset += NamesBase;
+      SymNames << MemberSymNames[I];
+      HasObject |= MemberHasObject[I];
+    }
 
     Pos += Header.size() + Data.size() + Padding.size();
-    Ret.push_back({std::move(*Symbols), std::move(Header), Data, Padding});
+    Ret.push_back({std::move(Symbols), std::move(Header), Data, Padding});
   }
   // If there are no symbols, emit an empty symbol table, to satisfy Solaris
   // tools, older versions of which expect a symbol table in a non-empty
@@ -559,8 +606,9 @@ Error writeArchive(StringRef ArcName, ArrayRef<NewArchiveMember> NewMembers,
   SmallString<0> StringTableBuf;
   raw_svector_ostream StringTable(StringTableBuf);
 
-  Expected<std::vector<MemberData>> DataOrErr = computeMemberData(
-      StringTable, SymNames, Kind, Thin, Deterministic, NewMembers);
+  Expected<std::vector<MemberData>> DataOrErr =
+      computeMemberData(StringTable, SymNames, Kind, Thin, Deterministic,
+                        WriteSymtab, NewMembers);
   if (Error E = DataOrErr.takeError())
     return E;
   std::vector<MemberData> &Data = *DataOrErr;
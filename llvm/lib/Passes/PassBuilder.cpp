@@ -78,6 +78,7 @@
 #include "llvm/Transforms/IPO/ForceFunctionAttrs.h"
 #include "llvm/Transforms/IPO/FunctionAttrs.h"
 #include "llvm/Transforms/IPO/FunctionImport.h"
+#include "llvm/Transforms/IPO/FunctionMultiVersioning.h"
 #include "llvm/Transforms/IPO/GlobalDCE.h"
 #include "llvm/Transforms/IPO/GlobalOpt.h"
 #include "llvm/Transforms/IPO/GlobalSplit.h"
@@ -243,6 +244,7 @@ PipelineTuningOptions::PipelineTuningOptions() {
 }
 
 extern cl::opt<bool> EnableHotColdSplit;
+extern cl::opt<bool> EnableMultiVersioning;
 extern cl::opt<bool> EnableOrderFileInstrumentation;
 
 extern cl::opt<bool> FlattenedProfileUsed;
@@ -915,6 +917,12 @@ ModulePassManager PassBuilder::buildModuleOptimizationPipeline(
                         PGOOpt->ProfileRemappingFile);
   }
 
+  // Clone functions with hot loops for newer ISA levels, so that the
+  // vectorizers below can optimize each clone for its extensions. Leave this
+  // to the post-link pipeline when preparing for (Thin)LTO.
+  if (EnableMultiVersioning && !LTOPreLink)
+    MPM.addPass(FunctionMultiVersioningPass());
+
   // Re-require GloblasAA here prior to function passes. This is particularly
   // useful as the above will have inlined, DCE'ed, and function-attr
   // propagated everything. We should at this point have a reasonably minimal
@@ -1326,6 +1334,13 @@ PassBuilder::buildLTODefaultPipeline(OptimizationLevel Level, bool DebugLogging,
               PostOrderFunctionAttrsPass()));
   // FIXME: here we run IP alias analysis in the legacy PM.
 
+  // Clone functions with hot loops for newer ISA levels now that the whole
+  // program has been inlined, so that each clone is optimized and code
+  // generated for its extensions. This is done at the same point in the old
+  // pass manager (\ref addLTOOptimizationPasses).
+  if (EnableMultiVersioning)
+    MPM.addPass(FunctionMultiVersioningPass());
+
   FunctionPassManager MainFPM;
 
   // FIXME: once we fix LoopPass Manager, add LICM here.
@@ -27,6 +27,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -312,27 +313,45 @@ CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
     return std::move(E);
   auto ProfileReader = std::move(ProfileReaderOrErr.get());
 
-  SmallVector<std::unique_ptr<CoverageMappingReader>, 4> Readers;
-  SmallVector<std::unique_ptr<MemoryBuffer>, 4> Buffers;
-  for (const auto &File : llvm::enumerate(ObjectFilenames)) {
-    auto CovMappingBufOrErr = MemoryBuffer::getFileOrSTDIN(File.value());
+  // Reading the objects and setting up their coverage readers is independent
+  // per object, so do it in parallel and stitch the results back together in
+  // the order the objects were given.
+  struct ObjectCoverage {
+    std::unique_ptr<MemoryBuffer> Buffer;
+    SmallVector<std::unique_ptr<MemoryBuffer>, 4> ArchiveBuffers;
+    std::vector<std::unique_ptr<BinaryCoverageReader>> Readers;
+    // Set once the object has been read. Only constructed then, as assigning
+    // over an unchecked Error::success() asserts.
+    Optional<Error> Err;
+  };
+  auto LoadObject = [&](size_t I, ObjectCoverage &Obj) -> Error {
+    auto CovMappingBufOrErr = MemoryBuffer::getFileOrSTDIN(ObjectFilenames[I]);
     if (std::error_code EC = CovMappingBufOrErr.getError())
       return errorCodeToError(EC);
-    StringRef Arch = Arches.empty() ? StringRef() : Arches[File.index()];
-    MemoryBufferRef CovMappingBufRef =
-        CovMappingBufOrErr.get()->getMemBufferRef();
-    auto CoverageReadersOrErr =
-        BinaryCoverageReader::create(CovMappingBufRef, Arch, Buffers);
-    if (Error E = CoverageReadersOrErr.takeError()) {
-      E = handleMaybeNoDataFoundError(std::move(E));
-      if (E)
-        return std::move(E);
-      // E == success (originally a no_data_found error).
-      continue;
+    Obj.Buffer = std::move(CovMappingBufOrErr.get());
+    StringRef Arch = Arches.empty() ? StringRef() : Arches[I];
+    auto CoverageReadersOrErr = BinaryCoverageReader::create(
+        Obj.Buffer->getMemBufferRef(), Arch, Obj.ArchiveBuffers);
+    // A no_data_found error leaves the object without readers.
+    if (Error E = CoverageReadersOrErr.takeError())
+      return handleMaybeNoDataFoundError(std::move(E));
+    Obj.Readers = std::move(CoverageReadersOrErr.get());
+    return Error::success();
+  };
+  std::vector<ObjectCoverage> Objects(ObjectFilenames.size());
+  parallel::for_each_n(
+      parallel::par, size_t(0), ObjectFilenames.size(),
+      [&](size_t I) { Objects[I].Err = LoadObject(I, Objects[I]); });
+
+  SmallVector<std::unique_ptr<CoverageMappingReader>, 4> Readers;
+  for (ObjectCoverage &Obj : Objects) {
+    if (Error E = std::move(*Obj.Err)) {
+      for (ObjectCoverage &Rest : Objects)
+        consumeError(std::move(*Rest.Err));
+      return std::move(E);
     }
-    for (auto &Reader : CoverageReadersOrErr.get())
+    for (auto &Reader : Obj.Readers)
       Readers.push_back(std::move(Reader));
-    Buffers.push_back(std::move(CovMappingBufOrErr.get()));
   }
   // If no readers were created, either no objects were provided or none of them
   // had coverage data. Return an error in the latter case.
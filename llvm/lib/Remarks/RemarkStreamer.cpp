@@ -36,14 +36,18 @@ Error RemarkStreamer::setFilter(StringRef Filter) {
     return createStringError(std::make_error_code(std::errc::invalid_argument),
                              RegexError.data());
   PassFilter = std::move(R);
+  FilterCache.clear();
   return Error::success();
 }
 
 bool RemarkStreamer::matchesFilter(StringRef Str) {
-  if (PassFilter)
-    return PassFilter->match(Str);
   // No filter means all strings pass.
-  return true;
+  if (!PassFilter)
+    return true;
+  auto It = FilterCache.try_emplace(Str, false);
+  if (It.second)
+    It.first->second = PassFilter->match(Str);
+  return It.first->second;
 }
 
 bool RemarkStreamer::needsSection() const {
@@ -158,6 +158,13 @@ public:
   // ParseCommandLineOptions actually runs.
   SmallVector<Option*, 4> DefaultOptions;
 
+  // This collects Options whose construction has finished but which have not
+  // been added to their SubCommands yet. Most options are static globals, and
+  // inserting all of them into the OptionsMaps while the process starts up is
+  // wasted work for tools that exit before looking at the command line. They
+  // are added, in construction order, the first time anything needs them.
+  std::vector<Option *> PendingOptions;
+
   // This collects the different option categories that have been registered.
   SmallPtrSet<OptionCategory *, 16> RegisteredOptionCategories;
 
@@ -251,6 +258,19 @@ public:
     }
   }
 
+  void addPendingOption(Option *O) { PendingOptions.push_back(O); }
+
+  void registerPendingOptions() {
+    if (PendingOptions.empty())
+      return;
+    // Adding an option can't register more options, but take the list first
+    // anyway so that nothing here depends on that.
+    std::vector<Option *> Options;
+    Options.swap(PendingOptions);
+    for (Option *O : Options)
+      addOption(O);
+  }
+
   void addOption(Option *O, bool ProcessDefaultOption = false) {
     if (!ProcessDefaultOption && O->isDefaultOption()) {
       DefaultOptions.push_back(O);
@@ -299,6 +319,14 @@ public:
   }
 
   void removeOption(Option *O) {
+    // Options that are still pending only need to be forgotten. Look from the
+    // back, since short-lived options are the ones usually removed.
+    auto I = std::find(PendingOptions.rbegin(), PendingOptions.rend(), O);
+    if (I != PendingOptions.rend()) {
+      PendingOptions.erase(std::next(I).base());
+      return;
+    }
+
     if (O->Subs.empty())
       removeOption(O, &*TopLevelSubCommand);
     else {
@@ -338,6 +366,7 @@ public:
   }
 
   void updateArgStr(Option *O, StringRef NewName) {
+    registerPendingOptions();
     if (O->Subs.empty())
       updateArgStr(O, NewName, &*TopLevelSubCommand);
     else {
@@ -397,6 +426,7 @@ public:
   }
 
   void reset() {
+    registerPendingOptions();
     ActiveSubCommand = nullptr;
     ProgramName.clear();
     ProgramOverview = StringRef();
@@ -442,7 +472,7 @@ extrahelp::extrahelp(StringRef Help) : morehelp(Help) {
 }
 
 void Option::addArgument() {
-  GlobalParser->addOption(this);
+  GlobalParser->addPendingOption(this);
   FullyInitialized = true;
 }
 
@@ -526,6 +556,10 @@ Option *CommandLineParser::LookupOption(SubCommand &Sub, StringRef &Arg,
     return nullptr;
   assert(&Sub != &*AllSubCommands);
 
+  // Earlier arguments may have loaded a plugin, which registers its options
+  // while the command line is being parsed.
+  registerPendingOptions();
+
   size_t EqualPos = Arg.find('=');
 
   // If we have an equals sign, remember the value.
@@ -1299,6 +1333,7 @@ bool cl::ParseCommandLineOptions(int argc, const char *const *argv,
 void CommandLineParser::ResetAllOptionOccurrences() {
   // So that we can parse different command lines multiple times in succession
   // we reset all option values to look like they have never been seen before.
+  registerPendingOptions();
   for (auto SC : RegisteredSubCommands) {
     for (auto &O : SC->OptionsMap)
       O.second->reset();
@@ -1310,6 +1345,7 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
                                                 StringRef Overview,
                                                 raw_ostream *Errs,
                                                 bool LongOptionsUseDoubleDash) {
+  registerPendingOptions();
   assert(hasOptions() && "No options specified!");
 
   // Expand response files.
@@ -2161,6 +2197,7 @@ public:
   }
 
   void printHelp() {
+    GlobalParser->registerPendingOptions();
     SubCommand *Sub = GlobalParser->getActiveSubCommand();
     auto &OptionsMap = Sub->OptionsMap;
     auto &PositionalOpts = Sub->PositionalOpts;
@@ -2420,6 +2457,8 @@ void CommandLineParser::printOptionValues() {
   if (!PrintOptions && !PrintAllOptions)
     return;
 
+  registerPendingOptions();
+
   SmallVector<std::pair<const char *, Option *>, 128> Opts;
   sortOpts(ActiveSubCommand->OptionsMap, Opts, /*ShowHidden*/ true);
 
@@ -2550,6 +2589,7 @@ StringMap<Option *> &cl::getRegisteredOptions(SubCommand &Sub) {
   auto &Subs = GlobalParser->RegisteredSubCommands;
   (void)Subs;
   assert(is_contained(Subs, &Sub));
+  GlobalParser->registerPendingOptions();
   return Sub.OptionsMap;
 }
 
@@ -2559,6 +2599,7 @@ cl::getRegisteredSubcommands() {
 }
 
 void cl::HideUnrelatedOptions(cl::OptionCategory &Category, SubCommand &Sub) {
+  GlobalParser->registerPendingOptions();
   for (auto &I : Sub.OptionsMap) {
     for (auto &Cat : I.second->Categories) {
       if (Cat != &Category &&
@@ -2570,6 +2611,7 @@ void cl::HideUnrelatedOptions(cl::OptionCategory &Category, SubCommand &Sub) {
 
 void cl::HideUnrelatedOptions(ArrayRef<const cl::OptionCategory *> Categories,
                               SubCommand &Sub) {
+  GlobalParser->registerPendingOptions();
   for (auto &I : Sub.OptionsMap) {
     for (auto &Cat : I.second->Categories) {
       if (find(Categories, Cat) == Categories.end() && Cat != &GenericCategory)
@@ -85,6 +85,48 @@ uint32_t zlib::crc32(StringRef Buffer) {
   return ::crc32(0, (const Bytef *)Buffer.data(), Buffer.size());
 }
 
+Error zlib::compressRaw(StringRef InputBuffer,
+                        SmallVectorImpl<char> &CompressedBuffer, int Level,
+                        bool Finish) {
+  // A negative window size selects a raw deflate stream; 15 and 8 are the
+  // defaults used by compress2().
+  z_stream Stream = {};
+  int Res =
+      deflateInit2(&Stream, Level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+  if (Res != Z_OK)
+    return createError(convertZlibCodeToString(Res));
+
+  // deflateBound() does not account for the sync flush marker, which is at
+  // most 5 bytes plus an empty block.
+  size_t Start = CompressedBuffer.size();
+  CompressedBuffer.resize(Start + deflateBound(&Stream, InputBuffer.size()) +
+                          16);
+  Stream.next_in = (Bytef *)InputBuffer.data();
+  Stream.avail_in = InputBuffer.size();
+  Stream.next_out = (Bytef *)CompressedBuffer.data() + Start;
+  Stream.avail_out = CompressedBuffer.size() - Start;
+  Res = deflate(&Stream, Finish ? Z_FINISH : Z_SYNC_FLUSH);
+  size_t CompressedSize = Stream.total_out;
+  deflateEnd(&Stream);
+  // Tell MemorySanitizer that zlib output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented ZLib.
+  __msan_unpoison(CompressedBuffer.data() + Start, CompressedSize);
+  CompressedBuffer.resize(Start + CompressedSize);
+  if (Res != (Finish ? Z_STREAM_END : Z_OK))
+    return createError(convertZlibCodeToString(Res == Z_OK ? Z_BUF_ERROR
+                                                           : Res));
+  return Error::success();
+}
+
+uint32_t zlib::adler32(StringRef Buffer) {
+  return ::adler32(1, (const Bytef *)Buffer.data(), Buffer.size());
+}
+
+uint32_t zlib::adler32Combine(uint32_t Adler1, uint32_t Adler2,
+                              size_t Length2) {
+  return ::adler32_combine(Adler1, Adler2, Length2);
+}
+
 #else
 bool zlib::isAvailable() { return false; }
 Error zlib::compress(StringRef InputBuffer,
@@ -103,4 +145,16 @@ Error zlib::uncompress(StringRef InputBuffer,
 uint32_t zlib::crc32(StringRef Buffer) {
   llvm_unreachable("zlib::crc32 is unavailable");
 }
+Error zlib::compressRaw(StringRef InputBuffer,
+                        SmallVectorImpl<char> &CompressedBuffer, int Level,
+                        bool Finish) {
+  llvm_unreachable("zlib::compressRaw is unavailable");
+}
+uint32_t zlib::adler32(StringRef Buffer) {
+  llvm_unreachable("zlib::adler32 is unavailable");
+}
+uint32_t zlib::adler32Combine(uint32_t Adler1, uint32_t Adler2,
+                              size_t Length2) {
+  llvm_unreachable("zlib::adler32Combine is unavailable");
+}
 #endif
@@ -66,6 +66,10 @@ public:
     consumeError(Temp.discard());
   }
 
+  void releasePages(size_t Offset, size_t Size) override {
+    Buffer->dontNeed(Offset, Size);
+  }
+
 private:
   std::unique_ptr<fs::mapped_file_region> Buffer;
   fs::TempFile Temp;
@@ -14,9 +14,11 @@
 
 #include "llvm/Support/Threading.h"
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
 #include <future>
-#include <stack>
+#include <memory>
 #include <thread>
 #include <vector>
 
@@ -35,11 +37,20 @@ public:
   static Executor *getDefaultExecutor();
 };
 
-/// An implementation of an Executor that runs closures on a thread pool
-///   in filo order.
+/// An implementation of an Executor that runs closures on a thread pool.
+///
+/// Every worker thread has its own queue. Closures added by a worker go to
+/// its own queue and are run in filo order, which keeps nested work on the
+/// thread that produced it. Closures added from outside the pool are spread
+/// over the queues round-robin. A worker whose queue is empty steals the
+/// oldest closure of another queue, so threads only contend on a lock when
+/// they touch the same queue.
 class ThreadPoolExecutor : public Executor {
 public:
   explicit ThreadPoolExecutor(unsigned ThreadCount = hardware_concurrency()) {
+    ThreadCount = std::max(ThreadCount, 1U);
+    for (unsigned I = 0; I < ThreadCount; ++I)
+      Queues.push_back(std::make_unique<WorkQueue>());
     // Spawn all but one of the threads in another thread as spawning threads
     // can take a while.
     Threads.reserve(ThreadCount);
@@ -47,12 +58,12 @@ public:
     std::lock_guard<std::mutex> Lock(Mutex);
     Threads[0] = std::thread([&, ThreadCount] {
       for (unsigned i = 1; i < ThreadCount; ++i) {
-        Threads.emplace_back([=] { work(); });
+        Threads.emplace_back([=] { work(i); });
         if (Stop)
           break;
       }
       ThreadsCreated.set_value();
-      work();
+      work(0);
     });
   }
 
@@ -82,35 +93,84 @@ public:
   };
 
   void add(std::function<void()> F) override {
+    unsigned Index = WorkerIndex >= 0 ? WorkerIndex
+                                      : NextQueue++ % Queues.size();
+    {
+      WorkQueue &Q = *Queues[Index];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      Q.Tasks.push_back(std::move(F));
+    }
     {
       std::lock_guard<std::mutex> Lock(Mutex);
-      WorkStack.push(F);
+      ++Pending;
     }
     Cond.notify_one();
   }
 
 private:
-  void work() {
+  struct WorkQueue {
+    std::mutex Mutex;
+    std::deque<std::function<void()>> Tasks;
+  };
+
+  /// Take the newest closure of queue \p Index, or else the oldest closure
+  /// of any other queue.
+  bool takeTask(unsigned Index, std::function<void()> &Task) {
+    {
+      WorkQueue &Q = *Queues[Index];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      if (!Q.Tasks.empty()) {
+        Task = std::move(Q.Tasks.back());
+        Q.Tasks.pop_back();
+        return true;
+      }
+    }
+    for (size_t I = 1, E = Queues.size(); I < E; ++I) {
+      WorkQueue &Q = *Queues[(Index + I) % E];
+      std::lock_guard<std::mutex> Lock(Q.Mutex);
+      if (!Q.Tasks.empty()) {
+        Task = std::move(Q.Tasks.front());
+        Q.Tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(unsigned Index) {
+    WorkerIndex = Index;
+    std::function<void()> Task;
     while (true) {
+      if (takeTask(Index, Task)) {
+        --Pending;
+        Task();
+        Task = nullptr;
+        continue;
+      }
       std::unique_lock<std::mutex> Lock(Mutex);
-      Cond.wait(Lock, [&] { return Stop || !WorkStack.empty(); });
+      Cond.wait(Lock, [&] { return Stop || Pending != 0; });
       if (Stop)
         break;
-      auto Task = WorkStack.top();
-      WorkStack.pop();
-      Lock.unlock();
-      Task();
     }
   }
 
+  /// The index of the queue owned by the current thread, or -1 if the
+  /// current thread is not a worker.
+  static thread_local int WorkerIndex;
+
   std::atomic<bool> Stop{false};
-  std::stack<std::function<void()>> WorkStack;
+  /// The number of closures queued but not yet taken by a worker.
+  std::atomic<size_t> Pending{0};
+  std::atomic<unsigned> NextQueue{0};
+  std::vector<std::unique_ptr<WorkQueue>> Queues;
   std::mutex Mutex;
   std::condition_variable Cond;
   std::promise<void> ThreadsCreated;
   std::vector<std::thread> Threads;
 };
 
+thread_local int ThreadPoolExecutor::WorkerIndex = -1;
+
 Executor *Executor::getDefaultExecutor() {
   // The ManagedStatic enables the ThreadPoolExecutor to be stopped via
   // llvm_shutdown() which allows a "clean" fast exit, e.g. via _exit(). This
@@ -16,13 +16,25 @@
 
 #include "llvm/Support/SHA1.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Host.h"
 using namespace llvm;
 
 #include <stdint.h>
 #include <string.h>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) &&        \
+    !defined(_MSC_VER)
+#define SHA1_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) &&                                                  \
+    (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+#define SHA1_ARM
+#include <arm_neon.h>
+#endif
+
 #if defined(BYTE_ORDER) && defined(BIG_ENDIAN) && BYTE_ORDER == BIG_ENDIAN
 #define SHA_BIG_ENDIAN
 #endif
@@ -82,6 +94,121 @@ static inline void r4(uint32_t &A, uint32_t &B, uint32_t &C, uint32_t &D,
 #define SEED_3 0x10325476
 #define SEED_4 0xc3d2e1f0
 
+// The SHA extensions on x86 and the cryptographic extension of ARMv8 both
+// implement the SHA-1 rounds and message schedule. When the host has them,
+// whole blocks are hashed with hashBlocksAccelerated() instead of hashBlock().
+// On x86 the extensions are detected at run time; on AArch64 they are used
+// when the compiler targets them.
+#if defined(SHA1_X86)
+static bool hasAcceleratedSHA1() {
+  static const bool Supported = [] {
+    StringMap<bool> Features;
+    return sys::getHostCPUFeatures(Features) && Features.lookup("sha") &&
+           Features.lookup("sse4.1");
+  }();
+  return Supported;
+}
+
+/// Hash \p NumBlocks 64-byte blocks of big-endian message words into State.
+__attribute__((target("sha,sse4.1"))) static void
+hashBlocksAccelerated(uint32_t *State, const uint8_t *Data, size_t NumBlocks) {
+  // Reverses the bytes of the register, which both converts the message words
+  // from big-endian and puts the first of them in the highest lane.
+  const __m128i Mask =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i ABCD = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(State)), 0x1B);
+  __m128i E0 = _mm_set_epi32(State[4], 0, 0, 0);
+
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    const __m128i ABCDSave = ABCD;
+    const __m128i E0Save = E0;
+    __m128i W[4];
+    for (int I = 0; I < 4; ++I)
+      W[I] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(Data + 16 * I)),
+          Mask);
+
+    // Each iteration does four rounds. W[I % 4] holds the message words for
+    // the current rounds and the three following groups.
+    __m128i E = _mm_add_epi32(E0, W[0]);
+    __m128i Prev;
+    for (int I = 0; I < 20; ++I) {
+      if (I > 0)
+        E = _mm_sha1nexte_epu32(Prev, W[I % 4]);
+      Prev = ABCD;
+      switch (I / 5) {
+      case 0: ABCD = _mm_sha1rnds4_epu32(ABCD, E, 0); break;
+      case 1: ABCD = _mm_sha1rnds4_epu32(ABCD, E, 1); break;
+      case 2: ABCD = _mm_sha1rnds4_epu32(ABCD, E, 2); break;
+      default: ABCD = _mm_sha1rnds4_epu32(ABCD, E, 3); break;
+      }
+      if (I < 16)
+        W[I % 4] = _mm_sha1msg2_epu32(
+            _mm_xor_si128(_mm_sha1msg1_epu32(W[I % 4], W[(I + 1) % 4]),
+                          W[(I + 2) % 4]),
+            W[(I + 3) % 4]);
+    }
+
+    E0 = _mm_sha1nexte_epu32(Prev, E0Save);
+    ABCD = _mm_add_epi32(ABCD, ABCDSave);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(State),
+                   _mm_shuffle_epi32(ABCD, 0x1B));
+  State[4] = _mm_extract_epi32(E0, 3);
+}
+#elif defined(SHA1_ARM)
+static bool hasAcceleratedSHA1() { return true; }
+
+/// Hash \p NumBlocks 64-byte blocks of big-endian message words into State.
+static void hashBlocksAccelerated(uint32_t *State, const uint8_t *Data,
+                                  size_t NumBlocks) {
+  static const uint32_t K[4] = {SHA1_K0, SHA1_K20, SHA1_K40, SHA1_K60};
+  uint32x4_t ABCD = vld1q_u32(State);
+  uint32_t E0 = State[4];
+
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    const uint32x4_t ABCDSave = ABCD;
+    const uint32_t E0Save = E0;
+    uint32x4_t W[4];
+    for (int I = 0; I < 4; ++I)
+      W[I] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(Data + 16 * I)));
+
+    // Each iteration does four rounds. W[I % 4] holds the message words for
+    // the current rounds and the three following groups.
+    uint32_t E = E0;
+    for (int I = 0; I < 20; ++I) {
+      uint32x4_t WK = vaddq_u32(W[I % 4], vdupq_n_u32(K[I / 5]));
+      uint32_t NextE = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+      if (I < 5)
+        ABCD = vsha1cq_u32(ABCD, E, WK);
+      else if (I < 10 || I >= 15)
+        ABCD = vsha1pq_u32(ABCD, E, WK);
+      else
+        ABCD = vsha1mq_u32(ABCD, E, WK);
+      E = NextE;
+      if (I < 16)
+        W[I % 4] = vsha1su1q_u32(
+            vsha1su0q_u32(W[I % 4], W[(I + 1) % 4], W[(I + 2) % 4]),
+            W[(I + 3) % 4]);
+    }
+
+    ABCD = vaddq_u32(ABCD, ABCDSave);
+    E0 = E + E0Save;
+  }
+
+  vst1q_u32(State, ABCD);
+  State[4] = E0;
+}
+#else
+static bool hasAcceleratedSHA1() { return false; }
+
+static void hashBlocksAccelerated(uint32_t *, const uint8_t *, size_t) {
+  llvm_unreachable("no accelerated SHA-1 on this host");
+}
+#endif
+
 void SHA1::init() {
   InternalState.State[0] = SEED_0;
   InternalState.State[1] = SEED_1;
@@ -93,6 +220,14 @@ void SHA1::init() {
 }
 
 void SHA1::hashBlock() {
+  if (hasAcceleratedSHA1()) {
+    uint8_t Block[BLOCK_LENGTH];
+    for (size_t I = 0; I < BLOCK_LENGTH / 4; ++I)
+      support::endian::write32be(Block + I * 4, InternalState.Buffer.L[I]);
+    hashBlocksAccelerated(InternalState.State, Block, 1);
+    return;
+  }
+
   uint32_t A = InternalState.State[0];
   uint32_t B = InternalState.State[1];
   uint32_t C = InternalState.State[2];
@@ -222,6 +357,13 @@ void SHA1::update(ArrayRef<uint8_t> Data) {
     Data = Data.drop_front(Remainder);
   }
 
+  // Hash whole blocks straight from the input when we can.
+  if (Data.size() >= BLOCK_LENGTH && hasAcceleratedSHA1()) {
+    size_t NumBlocks = Data.size() / BLOCK_LENGTH;
+    hashBlocksAccelerated(InternalState.State, Data.data(), NumBlocks);
+    Data = Data.drop_front(NumBlocks * BLOCK_LENGTH);
+  }
+
   // Fast buffer filling for large inputs.
   while (Data.size() >= BLOCK_LENGTH) {
     assert(InternalState.BufferOffset == 0);
@@ -0,0 +1,300 @@
+//===- SHA256.cpp - SHA256 implementation ---------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The portable rounds follow FIPS 180-4. On hosts with the x86 SHA extensions
+// or the ARMv8 cryptographic extension, whole blocks are hashed with those
+// instead, in the same way as SHA1.cpp.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/SHA256.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Host.h"
+using namespace llvm;
+
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) &&        \
+    !defined(_MSC_VER)
+#define SHA256_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) &&                                                  \
+    (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+#define SHA256_ARM
+#include <arm_neon.h>
+#endif
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static inline uint32_t rotr(uint32_t Number, int Bits) {
+  return (Number >> Bits) | (Number << (32 - Bits));
+}
+
+/// Hash \p NumBlocks 64-byte blocks into State with the portable rounds.
+static void hashBlocks(uint32_t *State, const uint8_t *Data,
+                       size_t NumBlocks) {
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    uint32_t W[64];
+    for (int I = 0; I < 16; ++I)
+      W[I] = support::endian::read32be(Data + I * 4);
+    for (int I = 16; I < 64; ++I) {
+      uint32_t S0 = rotr(W[I - 15], 7) ^ rotr(W[I - 15], 18) ^ (W[I - 15] >> 3);
+      uint32_t S1 = rotr(W[I - 2], 17) ^ rotr(W[I - 2], 19) ^ (W[I - 2] >> 10);
+      W[I] = W[I - 16] + S0 + W[I - 7] + S1;
+    }
+
+    uint32_t A = State[0], B = State[1], C = State[2], D = State[3];
+    uint32_t E = State[4], F = State[5], G = State[6], H = State[7];
+    for (int I = 0; I < 64; ++I) {
+      uint32_t S1 = rotr(E, 6) ^ rotr(E, 11) ^ rotr(E, 25);
+      uint32_t Ch = (E & F) ^ (~E & G);
+      uint32_t T1 = H + S1 + Ch + K[I] + W[I];
+      uint32_t S0 = rotr(A, 2) ^ rotr(A, 13) ^ rotr(A, 22);
+      uint32_t Maj = (A & B) ^ (A & C) ^ (B & C);
+      uint32_t T2 = S0 + Maj;
+      H = G;
+      G = F;
+      F = E;
+      E = D + T1;
+      D = C;
+      C = B;
+      B = A;
+      A = T1 + T2;
+    }
+
+    State[0] += A;
+    State[1] += B;
+    State[2] += C;
+    State[3] += D;
+    State[4] += E;
+    State[5] += F;
+    State[6] += G;
+    State[7] += H;
+  }
+}
+
+#if defined(SHA256_X86)
+static bool hasAcceleratedSHA256() {
+  static const bool Supported = [] {
+    StringMap<bool> Features;
+    return sys::getHostCPUFeatures(Features) && Features.lookup("sha") &&
+           Features.lookup("sse4.1");
+  }();
+  return Supported;
+}
+
+/// Hash \p NumBlocks 64-byte blocks into State with the SHA extensions.
+__attribute__((target("sha,sse4.1"))) static void
+hashBlocksAccelerated(uint32_t *State, const uint8_t *Data, size_t NumBlocks) {
+  // Converts the message words from big-endian.
+  const __m128i Mask =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  // sha256rnds2 wants the state as {A, B, E, F} and {C, D, G, H}.
+  __m128i Tmp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(State));
+  __m128i State1 =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(State + 4));
+  Tmp = _mm_shuffle_epi32(Tmp, 0xB1);       // CDAB
+  State1 = _mm_shuffle_epi32(State1, 0x1B); // EFGH
+  __m128i State0 = _mm_alignr_epi8(Tmp, State1, 8); // ABEF
+  State1 = _mm_blend_epi16(State1, Tmp, 0xF0);      // CDGH
+
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    const __m128i State0Save = State0;
+    const __m128i State1Save = State1;
+    __m128i W[4];
+    for (int I = 0; I < 4; ++I)
+      W[I] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(Data + 16 * I)),
+          Mask);
+
+    // Each iteration does four rounds. W[I % 4] holds the message words for
+    // the current rounds and the three following groups.
+    for (int I = 0; I < 16; ++I) {
+      __m128i WK = _mm_add_epi32(
+          W[I % 4],
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(K + 4 * I)));
+      State1 = _mm_sha256rnds2_epu32(State1, State0, WK);
+      WK = _mm_shuffle_epi32(WK, 0x0E);
+      State0 = _mm_sha256rnds2_epu32(State0, State1, WK);
+      if (I < 12)
+        W[I % 4] = _mm_sha256msg2_epu32(
+            _mm_add_epi32(_mm_sha256msg1_epu32(W[I % 4], W[(I + 1) % 4]),
+                          _mm_alignr_epi8(W[(I + 3) % 4], W[(I + 2) % 4], 4)),
+            W[(I + 3) % 4]);
+    }
+
+    State0 = _mm_add_epi32(State0, State0Save);
+    State1 = _mm_add_epi32(State1, State1Save);
+  }
+
+  Tmp = _mm_shuffle_epi32(State0, 0x1B);       // FEBA
+  State1 = _mm_shuffle_epi32(State1, 0xB1);    // DCHG
+  State0 = _mm_blend_epi16(Tmp, State1, 0xF0); // DCBA
+  State1 = _mm_alignr_epi8(State1, Tmp, 8);    // ABEF
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(State), State0);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(State + 4), State1);
+}
+#elif defined(SHA256_ARM)
+static bool hasAcceleratedSHA256() { return true; }
+
+/// Hash \p NumBlocks 64-byte blocks into State with the ARMv8 SHA-256
+/// instructions.
+static void hashBlocksAccelerated(uint32_t *State, const uint8_t *Data,
+                                  size_t NumBlocks) {
+  uint32x4_t State0 = vld1q_u32(State);
+  uint32x4_t State1 = vld1q_u32(State + 4);
+
+  for (; NumBlocks; --NumBlocks, Data += 64) {
+    const uint32x4_t State0Save = State0;
+    const uint32x4_t State1Save = State1;
+    uint32x4_t W[4];
+    for (int I = 0; I < 4; ++I)
+      W[I] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(Data + 16 * I)));
+
+    // Each iteration does four rounds. W[I % 4] holds the message words for
+    // the current rounds and the three following groups.
+    for (int I = 0; I < 16; ++I) {
+      uint32x4_t WK = vaddq_u32(W[I % 4], vld1q_u32(K + 4 * I));
+      uint32x4_t Prev = State0;
+      State0 = vsha256hq_u32(State0, State1, WK);
+      State1 = vsha256h2q_u32(State1, Prev, WK);
+      if (I < 12)
+        W[I % 4] = vsha256su1q_u32(vsha256su0q_u32(W[I % 4], W[(I + 1) % 4]),
+                                   W[(I + 2) % 4], W[(I + 3) % 4]);
+    }
+
+    State0 = vaddq_u32(State0, State0Save);
+    State1 = vaddq_u32(State1, State1Save);
+  }
+
+  vst1q_u32(State, State0);
+  vst1q_u32(State + 4, State1);
+}
+#else
+static bool hasAcceleratedSHA256() { return false; }
+
+static void hashBlocksAccelerated(uint32_t *, const uint8_t *, size_t) {
+  llvm_unreachable("no accelerated SHA-256 on this host");
+}
+#endif
+
+static void hashBlocksFast(uint32_t *State, const uint8_t *Data,
+                           size_t NumBlocks) {
+  if (hasAcceleratedSHA256())
+    hashBlocksAccelerated(State, Data, NumBlocks);
+  else
+    hashBlocks(State, Data, NumBlocks);
+}
+
+void SHA256::init() {
+  InternalState.State[0] = 0x6a09e667;
+  InternalState.State[1] = 0xbb67ae85;
+  InternalState.State[2] = 0x3c6ef372;
+  InternalState.State[3] = 0xa54ff53a;
+  InternalState.State[4] = 0x510e527f;
+  InternalState.State[5] = 0x9b05688c;
+  InternalState.State[6] = 0x1f83d9ab;
+  InternalState.State[7] = 0x5be0cd19;
+  InternalState.ByteCount = 0;
+  InternalState.BufferOffset = 0;
+}
+
+void SHA256::addUncounted(uint8_t Data) {
+  InternalState.Buffer[InternalState.BufferOffset++] = Data;
+  if (InternalState.BufferOffset == BLOCK_LENGTH) {
+    hashBlocksFast(InternalState.State, InternalState.Buffer, 1);
+    InternalState.BufferOffset = 0;
+  }
+}
+
+void SHA256::update(ArrayRef<uint8_t> Data) {
+  InternalState.ByteCount += Data.size();
+
+  // Finish the current block.
+  if (InternalState.BufferOffset > 0) {
+    const size_t Remainder = std::min<size_t>(
+        Data.size(), BLOCK_LENGTH - InternalState.BufferOffset);
+    for (size_t I = 0; I < Remainder; ++I)
+      addUncounted(Data[I]);
+    Data = Data.drop_front(Remainder);
+  }
+
+  // Hash whole blocks straight from the input.
+  if (Data.size() >= BLOCK_LENGTH) {
+    size_t NumBlocks = Data.size() / BLOCK_LENGTH;
+    hashBlocksFast(InternalState.State, Data.data(), NumBlocks);
+    Data = Data.drop_front(NumBlocks * BLOCK_LENGTH);
+  }
+
+  // Finish the remainder.
+  for (uint8_t C : Data)
+    addUncounted(C);
+}
+
+void SHA256::pad() {
+  // Implement SHA-256 padding (fips180-4 5.1.1)
+
+  // Pad with 0x80 followed by 0x00 until the end of the block
+  uint64_t BitCount = InternalState.ByteCount * 8;
+  addUncounted(0x80);
+  while (InternalState.BufferOffset != 56)
+    addUncounted(0x00);
+
+  // Append the length in bits as a 64-bit big-endian number.
+  for (int Shift = 56; Shift >= 0; Shift -= 8)
+    addUncounted(BitCount >> Shift);
+}
+
+StringRef SHA256::final() {
+  // Pad to complete the last block
+  pad();
+
+  for (int I = 0; I < HASH_LENGTH / 4; ++I)
+    support::endian::write32be(HashResult + I * 4, InternalState.State[I]);
+
+  // Return pointer to hash (32 characters)
+  return StringRef((char *)HashResult, HASH_LENGTH);
+}
+
+StringRef SHA256::result() {
+  auto StateToRestore = InternalState;
+
+  auto Hash = final();
+
+  // Restore the state
+  InternalState = StateToRestore;
+
+  // Return pointer to hash (32 characters)
+  return Hash;
+}
+
+std::array<uint8_t, 32> SHA256::hash(ArrayRef<uint8_t> Data) {
+  SHA256 Hash;
+  Hash.update(Data);
+  StringRef S = Hash.final();
+
+  std::array<uint8_t, 32> Arr;
+  memcpy(Arr.data(), S.data(), S.size());
+  return Arr;
+}
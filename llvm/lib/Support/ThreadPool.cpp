@@ -15,9 +15,28 @@
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 using namespace llvm;
 
+bool ThreadPool::startsAfter(const QueuedTask &A, const QueuedTask &B) {
+  if (A.Priority != B.Priority)
+    return A.Priority < B.Priority;
+  return A.Order > B.Order;
+}
+
+void ThreadPool::pushTask(PackagedTaskTy Task, unsigned Priority) {
+  Tasks.push_back({Priority, NextTaskOrder++, std::move(Task)});
+  std::push_heap(Tasks.begin(), Tasks.end(), startsAfter);
+}
+
+ThreadPool::PackagedTaskTy ThreadPool::popTask() {
+  std::pop_heap(Tasks.begin(), Tasks.end(), startsAfter);
+  PackagedTaskTy Task = std::move(Tasks.back().Task);
+  Tasks.pop_back();
+  return Task;
+}
+
 #if LLVM_ENABLE_THREADS
 
 // Default to hardware_concurrency
@@ -49,8 +68,7 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
             std::unique_lock<std::mutex> LockGuard(CompletionLock);
             ++ActiveThreads;
           }
-          Task = std::move(Tasks.front());
-          Tasks.pop();
+          Task = popTask();
         }
         // Run the task we just grabbed
         Task();
@@ -78,7 +96,8 @@ void ThreadPool::wait() {
                            [&] { return !ActiveThreads && Tasks.empty(); });
 }
 
-std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
+std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task,
+                                               unsigned Priority) {
   /// Wrap the Task in a packaged_task to return a future object.
   PackagedTaskTy PackagedTask(std::move(Task));
   auto Future = PackagedTask.get_future();
@@ -89,7 +108,7 @@ std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
     // Don't allow enqueueing after disabling the pool
     assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
 
-    Tasks.push(std::move(PackagedTask));
+    pushTask(std::move(PackagedTask), Priority);
   }
   QueueCondition.notify_one();
   return Future.share();
@@ -122,19 +141,19 @@ ThreadPool::ThreadPool(unsigned ThreadCount)
 void ThreadPool::wait() {
   // Sequential implementation running the tasks
   while (!Tasks.empty()) {
-    auto Task = std::move(Tasks.front());
-    Tasks.pop();
+    auto Task = popTask();
     Task();
   }
 }
 
-std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
+std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task,
+                                               unsigned Priority) {
   // Get a Future with launch::deferred execution using std::async
   auto Future = std::async(std::launch::deferred, std::move(Task)).share();
   // Wrap the future so that both ThreadPool::wait() can operate and the
   // returned future can be sync'ed on.
   PackagedTaskTy PackagedTask([Future]() { Future.get(); });
-  Tasks.push(std::move(PackagedTask));
+  pushTask(std::move(PackagedTask), Priority);
   return Future;
 }
 
@@ -48,10 +48,10 @@ typedef std::pair<std::string, CountAndDurationType>
     NameAndCountAndDurationType;
 
 struct Entry {
-  const TimePointType Start;
+  TimePointType Start;
   TimePointType End;
-  const std::string Name;
-  const std::string Detail;
+  std::string Name;
+  std::string Detail;
 
   Entry(TimePointType &&S, TimePointType &&E, std::string &&N, std::string &&Dt)
       : Start(std::move(S)), End(std::move(E)), Name(std::move(N)),
@@ -98,10 +98,6 @@ struct TimeTraceProfiler {
     // Calculate duration at full precision for overall counts.
     DurationType Duration = E.End - E.Start;
 
-    // Only include sections longer or equal to TimeTraceGranularity msec.
-    if (duration_cast<microseconds>(Duration).count() >= TimeTraceGranularity)
-      Entries.emplace_back(E);
-
     // Track total time taken by each "name", but only the topmost levels of
     // them; e.g. if there's a template instantiation that instantiates other
     // templates from within, we only want to add the topmost one. "topmost"
@@ -115,6 +111,12 @@ struct TimeTraceProfiler {
       CountAndTotal.second += Duration;
     }
 
+    // Only include sections longer or equal to TimeTraceGranularity msec. The
+    // entry is dropped from the stack anyway, so move it instead of copying
+    // its strings.
+    if (duration_cast<microseconds>(Duration).count() >= TimeTraceGranularity)
+      Entries.emplace_back(std::move(E));
+
     Stack.pop_back();
   }
 
@@ -24,6 +24,12 @@
 #include "llvm/Support/raw_ostream.h"
 #include <limits>
 
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace llvm;
 
 // This ugly hack is brought to you courtesy of constructor/destructor ordering
@@ -49,6 +55,13 @@ namespace {
                                       "tracking (this may be slow)"),
              cl::Hidden);
 
+  static cl::opt<bool>
+  TrackPerfCounters("track-perf-counters",
+                    cl::desc("Enable -time-passes hardware performance "
+                             "counters (instructions, cycles, last level "
+                             "cache misses and branch misses)"),
+                    cl::Hidden);
+
   static cl::opt<std::string, true>
   InfoOutputFilename("info-output-file", cl::value_desc("filename"),
                      cl::desc("File to append -stats and -timer output to"),
@@ -115,6 +128,65 @@ static inline size_t getMemUsage() {
   return sys::Process::GetMallocUsage();
 }
 
+namespace {
+/// The hardware counters of the calling thread, opened on first use. Counters
+/// the kernel or the hardware does not provide read as zero.
+class PerfCounters {
+public:
+  enum { Instructions, Cycles, CacheMisses, BranchMisses, NumCounters };
+
+  PerfCounters() {
+#ifdef __linux__
+    static const uint64_t Configs[NumCounters] = {
+        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (unsigned I = 0; I != NumCounters; ++I) {
+      perf_event_attr Attr = {};
+      Attr.size = sizeof(Attr);
+      Attr.type = PERF_TYPE_HARDWARE;
+      Attr.config = Configs[I];
+      Attr.exclude_kernel = 1;
+      Attr.exclude_hv = 1;
+      // Count the calling thread on any CPU.
+      FDs[I] = syscall(__NR_perf_event_open, &Attr, 0, -1, -1, 0);
+    }
+#endif
+  }
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int FD : FDs)
+      if (FD >= 0)
+        close(FD);
+#endif
+  }
+
+  uint64_t read(unsigned Counter) const {
+    uint64_t Value = 0;
+#ifdef __linux__
+    if (FDs[Counter] < 0 ||
+        ::read(FDs[Counter], &Value, sizeof(Value)) != sizeof(Value))
+      return 0;
+#endif
+    return Value;
+  }
+
+private:
+  int FDs[NumCounters] = {-1, -1, -1, -1};
+};
+} // namespace
+
+static void readPerfCounters(uint64_t &Instructions, uint64_t &Cycles,
+                             uint64_t &CacheMisses, uint64_t &BranchMisses) {
+  if (!TrackPerfCounters)
+    return;
+  static thread_local PerfCounters Counters;
+  Instructions = Counters.read(PerfCounters::Instructions);
+  Cycles = Counters.read(PerfCounters::Cycles);
+  CacheMisses = Counters.read(PerfCounters::CacheMisses);
+  BranchMisses = Counters.read(PerfCounters::BranchMisses);
+}
+
 TimeRecord TimeRecord::getCurrentTime(bool Start) {
   using Seconds = std::chrono::duration<double, std::ratio<1>>;
   TimeRecord Result;
@@ -123,9 +195,13 @@ TimeRecord TimeRecord::getCurrentTime(bool Start) {
 
   if (Start) {
     Result.MemUsed = getMemUsage();
+    readPerfCounters(Result.Instructions, Result.Cycles, Result.CacheMisses,
+                     Result.BranchMisses);
     sys::Process::GetTimeUsage(now, user, sys);
   } else {
     sys::Process::GetTimeUsage(now, user, sys);
+    readPerfCounters(Result.Instructions, Result.Cycles, Result.CacheMisses,
+                     Result.BranchMisses);
     Result.MemUsed = getMemUsage();
   }
 
@@ -175,6 +251,10 @@ void TimeRecord::print(const TimeRecord &Total, raw_ostream &OS) const {
 
   if (Total.getMemUsed())
     OS << format("%9" PRId64 "  ", (int64_t)getMemUsed());
+  if (Total.hasPerfCounters())
+    OS << format("%14" PRIu64 "%14" PRIu64 "%14" PRIu64 "%14" PRIu64 "  ",
+                 getInstructions(), getCycles(), getCacheMisses(),
+                 getBranchMisses());
 }
 
 
@@ -333,6 +413,8 @@ void TimerGroup::PrintQueuedTimers(raw_ostream &OS) {
   OS << "   ---Wall Time---";
   if (Total.getMemUsed())
     OS << "  ---Mem---";
+  if (Total.hasPerfCounters())
+    OS << "    Instructions        Cycles    LLC Misses Branch Misses";
   OS << "  --- Name ---\n";
 
   // Loop through all of the timing data, printing it out.
@@ -427,6 +509,16 @@ const char *TimerGroup::printJSONValues(raw_ostream &OS, const char *delim) {
       OS << delim;
       printJSONValue(OS, R, ".mem", T.getMemUsed());
     }
+    if (T.hasPerfCounters()) {
+      OS << delim;
+      printJSONValue(OS, R, ".instructions", T.getInstructions());
+      OS << delim;
+      printJSONValue(OS, R, ".cycles", T.getCycles());
+      OS << delim;
+      printJSONValue(OS, R, ".llc-misses", T.getCacheMisses());
+      OS << delim;
+      printJSONValue(OS, R, ".branch-misses", T.getBranchMisses());
+    }
   }
   TimersToPrint.clear();
   return delim;
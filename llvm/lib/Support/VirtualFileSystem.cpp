@@ -19,6 +19,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
@@ -28,6 +29,7 @@
 #include "llvm/Support/Chrono.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
@@ -520,6 +522,326 @@ directory_iterator OverlayFileSystem::dir_begin(const Twine &Dir,
 
 void ProxyFileSystem::anchor() {}
 
+//===-----------------------------------------------------------------------===/
+// StatCacheFileSystem implementation
+//===-----------------------------------------------------------------------===/
+
+// The cache file consists of a header, a table of fixed-size entries sorted
+// by path, and the path strings. All integers are little-endian.
+//
+//   Header: "LLVMSTC1" uint32 NumEntries uint32 Flags
+//   Entry:  uint32 PathOffset uint32 PathLength uint32 ParentIndex
+//           uint8 Type uint8 Flags uint16 Reserved uint32 Permissions
+//           uint32 User uint32 Group uint32 Reserved uint64 Device
+//           uint64 File uint64 Size int64 MTime (nanoseconds since the epoch)
+//
+// PathOffset is relative to the start of the string table that follows the
+// entries. ParentIndex is the index of the entry for the parent directory,
+// or NoParent for the roots of the walk. If the header has
+// SCH_CaseInsensitive set, the walked file system ignores case and the paths
+// are stored in lower case.
+static const char StatCacheMagic[] = {'L', 'L', 'V', 'M', 'S', 'T', 'C', '1'};
+static const size_t StatCacheHeaderSize = 16;
+static const size_t StatCacheEntrySize = 64;
+static const uint32_t NoParent = ~0U;
+
+namespace {
+enum StatCacheHeaderFlags : uint32_t {
+  /// The file system the cache was written for ignores case in names.
+  SCH_CaseInsensitive = 1,
+};
+
+enum StatCacheEntryFlags : uint8_t {
+  /// The entry is a directory whose children have all been recorded.
+  SCF_Complete = 1,
+};
+
+enum StatCacheDirState : uint8_t { SCD_Unknown, SCD_Unchanged, SCD_Changed };
+} // namespace
+
+struct StatCacheFileSystem::Entry {
+  uint32_t ParentIndex;
+  uint8_t Flags;
+  Status S;
+};
+
+StatCacheFileSystem::StatCacheFileSystem(
+    std::unique_ptr<MemoryBuffer> CacheBuffer,
+    IntrusiveRefCntPtr<FileSystem> FS, uint32_t NumEntries,
+    bool CaseInsensitive)
+    : ProxyFileSystem(std::move(FS)), CacheBuffer(std::move(CacheBuffer)),
+      NumEntries(NumEntries), CaseInsensitive(CaseInsensitive),
+      DirState(new std::atomic<uint8_t>[NumEntries]) {
+  for (uint32_t I = 0; I != NumEntries; ++I)
+    DirState[I].store(SCD_Unknown, std::memory_order_relaxed);
+}
+
+Expected<IntrusiveRefCntPtr<StatCacheFileSystem>>
+StatCacheFileSystem::create(std::unique_ptr<MemoryBuffer> CacheBuffer,
+                            IntrusiveRefCntPtr<FileSystem> FS) {
+  StringRef Data = CacheBuffer->getBuffer();
+  auto Invalid = [&](const Twine &Msg) {
+    return createStringError(std::make_error_code(std::errc::invalid_argument),
+                             "invalid stat cache '%s': %s",
+                             CacheBuffer->getBufferIdentifier().str().c_str(),
+                             Msg.str().c_str());
+  };
+  if (Data.size() < StatCacheHeaderSize ||
+      !Data.startswith(StringRef(StatCacheMagic, sizeof(StatCacheMagic))))
+    return Invalid("bad header");
+
+  uint32_t NumEntries = support::endian::read32le(Data.data() + 8);
+  uint32_t Flags = support::endian::read32le(Data.data() + 12);
+  uint64_t StringsStart =
+      StatCacheHeaderSize + uint64_t(NumEntries) * StatCacheEntrySize;
+  if (StringsStart > Data.size())
+    return Invalid("truncated entry table");
+
+  // Check every entry once up front so that lookups can trust the table.
+  StringRef Strings = Data.drop_front(StringsStart);
+  StringRef Prev;
+  for (uint32_t I = 0; I != NumEntries; ++I) {
+    const char *P = Data.data() + StatCacheHeaderSize + I * StatCacheEntrySize;
+    uint32_t Offset = support::endian::read32le(P);
+    uint32_t Length = support::endian::read32le(P + 4);
+    uint32_t Parent = support::endian::read32le(P + 8);
+    if (uint64_t(Offset) + Length > Strings.size())
+      return Invalid("path out of range");
+    StringRef Path = Strings.substr(Offset, Length);
+    if (I != 0 && Prev.compare(Path) >= 0)
+      return Invalid("entries are not sorted");
+    if (Parent != NoParent && Parent >= NumEntries)
+      return Invalid("parent out of range");
+    Prev = Path;
+  }
+
+  return IntrusiveRefCntPtr<StatCacheFileSystem>(
+      new StatCacheFileSystem(std::move(CacheBuffer), std::move(FS),
+                              NumEntries, Flags & SCH_CaseInsensitive));
+}
+
+StringRef StatCacheFileSystem::getPath(uint32_t Index) const {
+  StringRef Data = CacheBuffer->getBuffer();
+  const char *P =
+      Data.data() + StatCacheHeaderSize + Index * StatCacheEntrySize;
+  size_t StringsStart =
+      StatCacheHeaderSize + size_t(NumEntries) * StatCacheEntrySize;
+  return Data.substr(StringsStart + support::endian::read32le(P),
+                     support::endian::read32le(P + 4));
+}
+
+StatCacheFileSystem::Entry
+StatCacheFileSystem::getEntry(uint32_t Index) const {
+  const char *P = CacheBuffer->getBufferStart() + StatCacheHeaderSize +
+                  Index * StatCacheEntrySize;
+  using namespace support::endian;
+  sys::TimePoint<> MTime(std::chrono::duration_cast<sys::TimePoint<>::duration>(
+      std::chrono::nanoseconds(int64_t(read64le(P + 56)))));
+  Status S(getPath(Index),
+           sys::fs::UniqueID(read64le(P + 32), read64le(P + 40)), MTime,
+           read32le(P + 20), read32le(P + 24), read64le(P + 48),
+           static_cast<sys::fs::file_type>(P[12]),
+           static_cast<sys::fs::perms>(read32le(P + 16)));
+  return Entry{read32le(P + 8), static_cast<uint8_t>(P[13]), std::move(S)};
+}
+
+Optional<uint32_t> StatCacheFileSystem::findPath(StringRef Path) const {
+  uint32_t Lo = 0, Hi = NumEntries;
+  while (Lo < Hi) {
+    uint32_t Mid = Lo + (Hi - Lo) / 2;
+    int Cmp = getPath(Mid).compare(Path);
+    if (Cmp == 0)
+      return Mid;
+    if (Cmp < 0)
+      Lo = Mid + 1;
+    else
+      Hi = Mid;
+  }
+  return None;
+}
+
+bool StatCacheFileSystem::isDirectoryUnchanged(uint32_t Index) {
+  uint8_t State = DirState[Index].load(std::memory_order_relaxed);
+  if (State != SCD_Unknown)
+    return State == SCD_Unchanged;
+
+  // Racing threads may both stat the directory; they reach the same answer.
+  Entry E = getEntry(Index);
+  ErrorOr<Status> Real = getUnderlyingFS().status(E.S.getName());
+  bool Unchanged = Real && Real->isDirectory() &&
+                   Real->getLastModificationTime() ==
+                       E.S.getLastModificationTime();
+  DirState[Index].store(Unchanged ? SCD_Unchanged : SCD_Changed,
+                        std::memory_order_relaxed);
+  return Unchanged;
+}
+
+bool StatCacheFileSystem::isKnownMissing(const Twine &Path) {
+  SmallString<256> Absolute;
+  Path.toVector(Absolute);
+  if (makeAbsolute(Absolute))
+    return false;
+  sys::path::remove_dots(Absolute, /*remove_dot_dot=*/false);
+  // Resolving ".." needs to know about symlinks; leave it to the real FS.
+  for (StringRef Component : llvm::make_range(sys::path::begin(Absolute),
+                                              sys::path::end(Absolute)))
+    if (Component == "..")
+      return false;
+  if (CaseInsensitive) {
+    // Only ASCII letters are folded, both here and when writing the cache.
+    if (!isASCII(Absolute.str()))
+      return false;
+    Absolute = StringRef(Absolute).lower();
+  }
+
+  // Files may be rewritten in place without changing their directory, so
+  // only the real FS can give an up-to-date status for a cached path.
+  if (findPath(Absolute))
+    return false;
+
+  // The path is not in the cache. If its closest cached ancestor is a fully
+  // listed directory that has not changed, the path does not exist.
+  StringRef Ancestor = Absolute;
+  while (true) {
+    StringRef Parent = sys::path::parent_path(Ancestor);
+    if (Parent.empty() || Parent == Ancestor)
+      return false;
+    Ancestor = Parent;
+    if (Optional<uint32_t> Index = findPath(Ancestor)) {
+      Entry E = getEntry(*Index);
+      return (E.Flags & SCF_Complete) && isDirectoryUnchanged(*Index);
+    }
+  }
+}
+
+ErrorOr<Status> StatCacheFileSystem::status(const Twine &Path) {
+  if (isKnownMissing(Path))
+    return make_error_code(llvm::errc::no_such_file_or_directory);
+  return ProxyFileSystem::status(Path);
+}
+
+ErrorOr<std::unique_ptr<File>>
+StatCacheFileSystem::openFileForRead(const Twine &Path) {
+  if (isKnownMissing(Path))
+    return make_error_code(llvm::errc::no_such_file_or_directory);
+  return ProxyFileSystem::openFileForRead(Path);
+}
+
+Error StatCacheFileSystem::writeStatCache(FileSystem &FS,
+                                          ArrayRef<std::string> Roots,
+                                          raw_ostream &OS) {
+  struct Record {
+    Status S;
+    uint8_t Flags;
+  };
+  std::map<std::string, Record> Records;
+
+  std::vector<std::string> Worklist;
+  for (const std::string &Root : Roots) {
+    SmallString<256> Path(Root);
+    if (std::error_code EC = FS.makeAbsolute(Path))
+      return createFileError(Root, EC);
+    sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+    ErrorOr<Status> S = FS.status(Path);
+    if (!S)
+      return createFileError(Path, S.getError());
+    auto Inserted = Records.insert({std::string(Path), Record{*S, 0}});
+    if (Inserted.second && S->isDirectory())
+      Worklist.push_back(std::string(Path));
+  }
+
+  while (!Worklist.empty()) {
+    std::string Dir = Worklist.back();
+    Worklist.pop_back();
+
+    std::error_code EC;
+    bool Complete = true;
+    for (directory_iterator I = FS.dir_begin(Dir, EC), E; I != E;
+         I.increment(EC)) {
+      if (EC)
+        break;
+      ErrorOr<Status> S = FS.status(I->path());
+      if (!S) {
+        // Dangling symlinks and entries that vanished during the walk are
+        // left out, so the directory cannot answer negative lookups.
+        Complete = false;
+        continue;
+      }
+      // Directories shared between overlapping roots are only walked once.
+      auto Inserted = Records.insert({std::string(I->path()), Record{*S, 0}});
+      if (Inserted.second && S->isDirectory() &&
+          I->type() != sys::fs::file_type::symlink_file)
+        Worklist.push_back(std::string(I->path()));
+    }
+    if (!EC && Complete)
+      Records[Dir].Flags |= SCF_Complete;
+  }
+
+  // Negative answers must agree with the file system on what a name is, so
+  // find out whether it ignores case by looking up a walked name with the
+  // case of its letters swapped. If it does, store the paths in lower case.
+  uint32_t HeaderFlags = 0;
+  for (const auto &R : Records) {
+    StringRef Name = sys::path::filename(R.first);
+    if (llvm::none_of(Name, [](char C) { return isAlpha(C); }))
+      continue;
+    std::string Swapped = R.first.substr(0, R.first.size() - Name.size());
+    for (char C : Name)
+      Swapped.push_back(toLower(C) != C ? toLower(C) : toUpper(C));
+    ErrorOr<Status> S = FS.status(Swapped);
+    if (S && S->getUniqueID() == R.second.S.getUniqueID())
+      HeaderFlags |= SCH_CaseInsensitive;
+    break;
+  }
+  if (HeaderFlags & SCH_CaseInsensitive) {
+    std::map<std::string, Record> Folded;
+    for (auto &R : Records)
+      Folded.insert({StringRef(R.first).lower(), std::move(R.second)});
+    Records = std::move(Folded);
+  }
+
+  DenseMap<StringRef, uint32_t> Indices;
+  uint32_t NextIndex = 0;
+  for (const auto &R : Records)
+    Indices[R.first] = NextIndex++;
+
+  using namespace support;
+  endian::Writer W(OS, little);
+  OS.write(StatCacheMagic, sizeof(StatCacheMagic));
+  W.write<uint32_t>(Records.size());
+  W.write<uint32_t>(HeaderFlags);
+
+  uint32_t Offset = 0;
+  for (const auto &R : Records) {
+    const Status &S = R.second.S;
+    uint32_t Parent = NoParent;
+    auto It = Indices.find(sys::path::parent_path(R.first));
+    if (It != Indices.end())
+      Parent = It->second;
+
+    W.write<uint32_t>(Offset);
+    W.write<uint32_t>(R.first.size());
+    W.write<uint32_t>(Parent);
+    W.write<uint8_t>(static_cast<uint8_t>(S.getType()));
+    W.write<uint8_t>(R.second.Flags);
+    W.write<uint16_t>(0);
+    W.write<uint32_t>(S.getPermissions());
+    W.write<uint32_t>(S.getUser());
+    W.write<uint32_t>(S.getGroup());
+    W.write<uint32_t>(0);
+    W.write<uint64_t>(S.getUniqueID().getDevice());
+    W.write<uint64_t>(S.getUniqueID().getFile());
+    W.write<uint64_t>(S.getSize());
+    W.write<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         S.getLastModificationTime().time_since_epoch())
+                         .count());
+    Offset += R.first.size();
+  }
+  for (const auto &R : Records)
+    OS << R.first;
+  return Error::success();
+}
+
 namespace llvm {
 namespace vfs {
 
@@ -33,7 +33,10 @@
 */
 
 /* based on revision d2df04efcbef7d7f6886d345861e5dfda4edacc1 Removed
- * everything but a simple interface for computing XXh64. */
+ * everything but a simple interface for computing XXh64.
+ *
+ * xxh3_64bits is based on xxHash 0.8, with everything but the default secret
+ * and a zero seed removed. */
 
 #include "llvm/Support/xxhash.h"
 #include "llvm/Support/Endian.h"
@@ -41,6 +44,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace llvm;
 using namespace support;
 
@@ -136,3 +143,267 @@ uint64_t llvm::xxHash64(StringRef Data) {
 uint64_t llvm::xxHash64(ArrayRef<uint8_t> Data) {
   return xxHash64({(const char *)Data.data(), Data.size()});
 }
+
+static const uint32_t PRIME32_1 = 0x9E3779B1U;
+static const uint32_t PRIME32_2 = 0x85EBCA77U;
+static const uint32_t PRIME32_3 = 0xC2B2AE3DU;
+
+static const uint64_t PRIME_MX1 = 0x165667919E3779F9ULL;
+static const uint64_t PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+// The default secret, which is taken from FARSH.
+constexpr size_t SECRET_SIZE = 192;
+static const uint8_t Secret[SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// Calculates a 64-bit to 128-bit multiply, then XOR folds it.
+static uint64_t XXH3_mul128_fold64(uint64_t LHS, uint64_t RHS) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t Product = (__uint128_t)LHS * (__uint128_t)RHS;
+  return uint64_t(Product) ^ uint64_t(Product >> 64);
+#else
+  // First calculate all of the cross products.
+  uint64_t LoLo = (LHS & 0xFFFFFFFF) * (RHS & 0xFFFFFFFF);
+  uint64_t HiLo = (LHS >> 32) * (RHS & 0xFFFFFFFF);
+  uint64_t LoHi = (LHS & 0xFFFFFFFF) * (RHS >> 32);
+  uint64_t HiHi = (LHS >> 32) * (RHS >> 32);
+
+  // Now add the products together. These will never overflow.
+  uint64_t Cross = (LoLo >> 32) + (HiLo & 0xFFFFFFFF) + LoHi;
+  uint64_t Upper = (HiLo >> 32) + (Cross >> 32) + HiHi;
+  uint64_t Lower = (Cross << 32) | (LoLo & 0xFFFFFFFF);
+  return Upper ^ Lower;
+#endif
+}
+
+static uint64_t XXH64_avalanche(uint64_t Hash) {
+  Hash ^= Hash >> 33;
+  Hash *= PRIME64_2;
+  Hash ^= Hash >> 29;
+  Hash *= PRIME64_3;
+  Hash ^= Hash >> 32;
+  return Hash;
+}
+
+static uint64_t XXH3_avalanche(uint64_t Hash) {
+  Hash ^= Hash >> 37;
+  Hash *= PRIME_MX1;
+  Hash ^= Hash >> 32;
+  return Hash;
+}
+
+static uint64_t XXH3_len_1to3_64b(const uint8_t *Input, size_t Len) {
+  const uint8_t C1 = Input[0];
+  const uint8_t C2 = Input[Len >> 1];
+  const uint8_t C3 = Input[Len - 1];
+  uint32_t Combined = ((uint32_t)C1 << 16) | ((uint32_t)C2 << 24) |
+                      ((uint32_t)C3 << 0) | ((uint32_t)Len << 8);
+  uint64_t Bitflip =
+      (uint64_t)(endian::read32le(Secret) ^ endian::read32le(Secret + 4));
+  return XXH64_avalanche(uint64_t(Combined) ^ Bitflip);
+}
+
+static uint64_t XXH3_len_4to8_64b(const uint8_t *Input, size_t Len) {
+  const uint32_t Input1 = endian::read32le(Input);
+  const uint32_t Input2 = endian::read32le(Input + Len - 4);
+  uint64_t Acc = endian::read64le(Secret + 8) ^ endian::read64le(Secret + 16);
+  const uint64_t Input64 = (uint64_t)Input2 | ((uint64_t)Input1 << 32);
+  Acc ^= Input64;
+  // XXH3_rrmxmx(Acc, Len)
+  Acc ^= rotl64(Acc, 49) ^ rotl64(Acc, 24);
+  Acc *= PRIME_MX2;
+  Acc ^= (Acc >> 35) + (uint64_t)Len;
+  Acc *= PRIME_MX2;
+  return Acc ^ (Acc >> 28);
+}
+
+static uint64_t XXH3_len_9to16_64b(const uint8_t *Input, size_t Len) {
+  uint64_t InputLo =
+      endian::read64le(Input) ^
+      (endian::read64le(Secret + 24) ^ endian::read64le(Secret + 32));
+  uint64_t InputHi =
+      endian::read64le(Input + Len - 8) ^
+      (endian::read64le(Secret + 40) ^ endian::read64le(Secret + 48));
+  uint64_t Acc = uint64_t(Len) + sys::getSwappedBytes(InputLo) + InputHi +
+                 XXH3_mul128_fold64(InputLo, InputHi);
+  return XXH3_avalanche(Acc);
+}
+
+static uint64_t XXH3_len_0to16_64b(const uint8_t *Input, size_t Len) {
+  if (Len > 8)
+    return XXH3_len_9to16_64b(Input, Len);
+  if (Len >= 4)
+    return XXH3_len_4to8_64b(Input, Len);
+  if (Len != 0)
+    return XXH3_len_1to3_64b(Input, Len);
+  return XXH64_avalanche(endian::read64le(Secret + 56) ^
+                         endian::read64le(Secret + 64));
+}
+
+static uint64_t XXH3_mix16B(const uint8_t *Input, const uint8_t *Secret) {
+  uint64_t Lhs = endian::read64le(Input) ^ endian::read64le(Secret);
+  uint64_t Rhs = endian::read64le(Input + 8) ^ endian::read64le(Secret + 8);
+  return XXH3_mul128_fold64(Lhs, Rhs);
+}
+
+// For mid range keys, XXH3 uses a Mum-hash variant.
+static uint64_t XXH3_len_17to128_64b(const uint8_t *Input, size_t Len) {
+  uint64_t Acc = Len * PRIME64_1;
+  if (Len > 32) {
+    if (Len > 64) {
+      if (Len > 96) {
+        Acc += XXH3_mix16B(Input + 48, Secret + 96);
+        Acc += XXH3_mix16B(Input + Len - 64, Secret + 112);
+      }
+      Acc += XXH3_mix16B(Input + 32, Secret + 64);
+      Acc += XXH3_mix16B(Input + Len - 48, Secret + 80);
+    }
+    Acc += XXH3_mix16B(Input + 16, Secret + 32);
+    Acc += XXH3_mix16B(Input + Len - 32, Secret + 48);
+  }
+  Acc += XXH3_mix16B(Input + 0, Secret + 0);
+  Acc += XXH3_mix16B(Input + Len - 16, Secret + 16);
+  return XXH3_avalanche(Acc);
+}
+
+constexpr size_t XXH3_MIDSIZE_MAX = 240;
+constexpr size_t XXH3_SECRETSIZE_MIN = 136;
+
+static uint64_t XXH3_len_129to240_64b(const uint8_t *Input, size_t Len) {
+  constexpr size_t XXH3_MIDSIZE_STARTOFFSET = 3;
+  constexpr size_t XXH3_MIDSIZE_LASTOFFSET = 17;
+  uint64_t Acc = (uint64_t)Len * PRIME64_1;
+  const unsigned NbRounds = Len / 16;
+  for (unsigned I = 0; I < 8; ++I)
+    Acc += XXH3_mix16B(Input + 16 * I, Secret + 16 * I);
+  Acc = XXH3_avalanche(Acc);
+
+  for (unsigned I = 8; I < NbRounds; ++I)
+    Acc += XXH3_mix16B(Input + 16 * I,
+                       Secret + 16 * (I - 8) + XXH3_MIDSIZE_STARTOFFSET);
+  // Last bytes
+  Acc += XXH3_mix16B(Input + Len - 16,
+                     Secret + XXH3_SECRETSIZE_MIN - XXH3_MIDSIZE_LASTOFFSET);
+  return XXH3_avalanche(Acc);
+}
+
+constexpr size_t XXH_STRIPE_LEN = 64;
+constexpr size_t XXH_SECRET_CONSUME_RATE = 8;
+constexpr size_t XXH_ACC_NB = XXH_STRIPE_LEN / sizeof(uint64_t);
+
+// Mix one 64-byte stripe into the accumulators. The eight lanes are
+// independent, so with SSE2 they are processed two at a time; elsewhere the
+// loop is simple enough for the compiler to vectorize.
+static void XXH3_accumulate_512(uint64_t *Acc, const uint8_t *Input,
+                                const uint8_t *Secret) {
+#ifdef __SSE2__
+  __m128i *XAcc = reinterpret_cast<__m128i *>(Acc);
+  for (size_t I = 0; I < XXH_STRIPE_LEN / sizeof(__m128i); ++I) {
+    __m128i Data =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Input) + I);
+    __m128i Key =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Secret) + I);
+    __m128i DataKey = _mm_xor_si128(Data, Key);
+    // Multiply the low and high 32 bits of each lane of DataKey.
+    __m128i Product = _mm_mul_epu32(
+        DataKey, _mm_shuffle_epi32(DataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+    // Add the input to the neighbouring lane.
+    __m128i Swapped = _mm_shuffle_epi32(Data, _MM_SHUFFLE(1, 0, 3, 2));
+    XAcc[I] = _mm_add_epi64(Product, _mm_add_epi64(XAcc[I], Swapped));
+  }
+#else
+  for (size_t I = 0; I < XXH_ACC_NB; ++I) {
+    uint64_t DataVal = endian::read64le(Input + 8 * I);
+    uint64_t DataKey = DataVal ^ endian::read64le(Secret + 8 * I);
+    Acc[I ^ 1] += DataVal;
+    Acc[I] += uint32_t(DataKey) * (DataKey >> 32);
+  }
+#endif
+}
+
+static void XXH3_accumulate(uint64_t *Acc, const uint8_t *Input,
+                            const uint8_t *Secret, size_t NbStripes) {
+  for (size_t N = 0; N < NbStripes; ++N)
+    XXH3_accumulate_512(Acc, Input + N * XXH_STRIPE_LEN,
+                        Secret + N * XXH_SECRET_CONSUME_RATE);
+}
+
+static void XXH3_scrambleAcc(uint64_t *Acc, const uint8_t *Secret) {
+  for (size_t I = 0; I < XXH_ACC_NB; ++I) {
+    Acc[I] ^= Acc[I] >> 47;
+    Acc[I] ^= endian::read64le(Secret + 8 * I);
+    Acc[I] *= PRIME32_1;
+  }
+}
+
+static uint64_t XXH3_mix2Accs(const uint64_t *Acc, const uint8_t *Secret) {
+  return XXH3_mul128_fold64(Acc[0] ^ endian::read64le(Secret),
+                            Acc[1] ^ endian::read64le(Secret + 8));
+}
+
+static uint64_t XXH3_mergeAccs(const uint64_t *Acc, const uint8_t *Secret,
+                               uint64_t Start) {
+  uint64_t Result64 = Start;
+  for (size_t I = 0; I < 4; ++I)
+    Result64 += XXH3_mix2Accs(Acc + 2 * I, Secret + 16 * I);
+  return XXH3_avalanche(Result64);
+}
+
+static uint64_t XXH3_hashLong_64b(const uint8_t *Input, size_t Len) {
+  const size_t NbStripesPerBlock =
+      (SECRET_SIZE - XXH_STRIPE_LEN) / XXH_SECRET_CONSUME_RATE;
+  const size_t BlockLen = XXH_STRIPE_LEN * NbStripesPerBlock;
+  const size_t NbBlocks = (Len - 1) / BlockLen;
+  alignas(16) uint64_t Acc[XXH_ACC_NB] = {
+      PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+      PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1,
+  };
+  for (size_t N = 0; N < NbBlocks; ++N) {
+    XXH3_accumulate(Acc, Input + N * BlockLen, Secret, NbStripesPerBlock);
+    XXH3_scrambleAcc(Acc, Secret + SECRET_SIZE - XXH_STRIPE_LEN);
+  }
+
+  // Last partial block
+  const size_t NbStripes = (Len - 1 - (BlockLen * NbBlocks)) / XXH_STRIPE_LEN;
+  assert(NbStripes <= SECRET_SIZE / XXH_SECRET_CONSUME_RATE);
+  XXH3_accumulate(Acc, Input + NbBlocks * BlockLen, Secret, NbStripes);
+
+  // Last stripe
+  constexpr size_t XXH_SECRET_LASTACC_START = 7;
+  XXH3_accumulate_512(Acc, Input + Len - XXH_STRIPE_LEN,
+                      Secret + SECRET_SIZE - XXH_STRIPE_LEN -
+                          XXH_SECRET_LASTACC_START);
+
+  // Converge into final hash
+  constexpr size_t XXH_SECRET_MERGEACCS_START = 11;
+  return XXH3_mergeAccs(Acc, Secret + XXH_SECRET_MERGEACCS_START,
+                        (uint64_t)Len * PRIME64_1);
+}
+
+uint64_t llvm::xxh3_64bits(ArrayRef<uint8_t> Data) {
+  auto *In = Data.data();
+  size_t Len = Data.size();
+  if (Len <= 16)
+    return XXH3_len_0to16_64b(In, Len);
+  if (Len <= 128)
+    return XXH3_len_17to128_64b(In, Len);
+  if (Len <= XXH3_MIDSIZE_MAX)
+    return XXH3_len_129to240_64b(In, Len);
+  return XXH3_hashLong_64b(In, Len);
+}
@@ -2986,6 +2986,16 @@ SDValue AArch64TargetLowering::LowerINTRINSIC_WO_CHAIN(SDValue Op,
     return DAG.getNode(ISD::UMIN, dl, Op.getValueType(),
                        Op.getOperand(1), Op.getOperand(2));
 
+  case Intrinsic::get_active_lane_mask:
+    // Lanes are active while the induction is lower than or the same as the
+    // backedge-taken count, which is exactly what WHILELS computes. Only
+    // scalable predicates get here (see shouldExpandGetActiveLaneMask), so
+    // this is not reached from LoopVectorize until it supports scalable VFs.
+    return DAG.getNode(
+        ISD::INTRINSIC_WO_CHAIN, dl, Op.getValueType(),
+        DAG.getConstant(Intrinsic::aarch64_sve_whilels, dl, MVT::i64),
+        Op.getOperand(1), Op.getOperand(2));
+
   case Intrinsic::aarch64_sve_sunpkhi:
     return DAG.getNode(AArch64ISD::SUNPKHI, dl, Op.getValueType(),
                        Op.getOperand(1));
@@ -13444,6 +13454,21 @@ bool AArch64TargetLowering::shouldExpandShift(SelectionDAG &DAG,
   return true;
 }
 
+bool AArch64TargetLowering::shouldExpandGetActiveLaneMask(EVT VT,
+                                                          EVT OpVT) const {
+  // Only SVE has a lane-mask instruction.
+  if (!Subtarget->hasSVE())
+    return true;
+
+  // The operands are passed in GPRs.
+  if (OpVT != MVT::i32 && OpVT != MVT::i64)
+    return true;
+
+  // The result must be a full predicate register.
+  return VT != MVT::nxv16i1 && VT != MVT::nxv8i1 && VT != MVT::nxv4i1 &&
+         VT != MVT::nxv2i1;
+}
+
 void AArch64TargetLowering::initializeSplitCSR(MachineBasicBlock *Entry) const {
   // Update IsSplitCSR in AArch64unctionInfo.
   AArch64FunctionInfo *AFI = Entry->getParent()->getInfo<AArch64FunctionInfo>();
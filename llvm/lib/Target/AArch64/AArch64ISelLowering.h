@@ -562,6 +562,8 @@ public:
 
   bool shouldExpandShift(SelectionDAG &DAG, SDNode *N) const override;
 
+  bool shouldExpandGetActiveLaneMask(EVT VT, EVT OpVT) const override;
+
   bool shouldTransformSignedTruncationCheck(EVT XVT,
                                             unsigned KeptBits) const override {
     // For vectors, we don't have a preference..
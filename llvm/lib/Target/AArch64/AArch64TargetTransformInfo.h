@@ -172,6 +172,12 @@ public:
     return isLegalMaskedLoadStore(DataType, Alignment);
   }
 
+  // SVE computes loop predicates with WHILELS. Note that LoopVectorize only
+  // creates fixed-width masks for now, which are expanded generically; WHILELS
+  // is only selected for scalable masks, so it cannot be reached from the
+  // vectorizer until it supports scalable VFs.
+  bool emitGetActiveLaneMask() const { return ST->hasSVE(); }
+
   bool isLegalNTStore(Type *DataType, Align Alignment) {
     // NOTE: The logic below is mostly geared towards LV, which calls it with
     //       vectors with 2 elements. We might want to improve that, if other
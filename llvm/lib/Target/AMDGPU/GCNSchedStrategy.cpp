@@ -17,13 +17,31 @@
 #include "SIMachineFunctionInfo.h"
 #include "SIRegisterInfo.h"
 #include "Utils/AMDGPUBaseInfo.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/RegisterClassInfo.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Timer.h"
 
 #define DEBUG_TYPE "machine-scheduler"
 
 using namespace llvm;
 
+STATISTIC(NumRegionsRescheduled,
+          "Number of regions rescheduled after the initial schedule");
+STATISTIC(NumRegionsOverBudget,
+          "Number of regions not rescheduled for lack of budget");
+
+static cl::opt<unsigned> RescheduleBudget(
+    "amdgpu-reschedule-budget", cl::Hidden, cl::init(0),
+    cl::desc("Maximum number of instructions per function that the GCN "
+             "scheduler reschedules after the initial schedule "
+             "(0 = unlimited)"));
+
+static const char TimerGroupName[] = "amdgpu-sched";
+static const char TimerGroupDescription[] = "AMDGPU Scheduling Stages";
+
 GCNMaxOccupancySchedStrategy::GCNMaxOccupancySchedStrategy(
     const MachineSchedContext *C) :
     GenericScheduler(C), TargetOccupancy(0), MF(nullptr) { }
@@ -549,10 +567,22 @@ void GCNScheduleDAGMILive::finalizeSchedule() {
 
   std::vector<std::unique_ptr<ScheduleDAGMutation>> SavedMutations;
 
+  // Number of instructions sent to the rescheduling stages so far.
+  unsigned NumRescheduled = 0;
+
+  static const char *const StageNames[][2] = {
+      {"collect", "Collect Regions"},
+      {"initial", "Initial Schedule"},
+      {"unclustered", "Unclustered Reschedule"},
+      {"clustered-low-occupancy", "Clustered Low Occupancy Reschedule"}};
+
   do {
     Stage++;
     RegionIdx = 0;
     MachineBasicBlock *MBB = nullptr;
+    NamedRegionTimer T(StageNames[Stage][0], StageNames[Stage][1],
+                       TimerGroupName, TimerGroupDescription,
+                       TimePassesIsEnabled);
 
     if (Stage > InitialSchedule) {
       if (!LIS)
@@ -587,12 +617,31 @@ void GCNScheduleDAGMILive::finalizeSchedule() {
       SavedMutations.swap(Mutations);
 
     for (auto Region : Regions) {
-      if (Stage == UnclusteredReschedule && !RescheduleRegions[RegionIdx])
+      if (Stage == UnclusteredReschedule && !RescheduleRegions[RegionIdx]) {
+        ++RegionIdx;
         continue;
+      }
 
       RegionBegin = Region.first;
       RegionEnd = Region.second;
 
+      // Rescheduling only improves on a schedule that is already valid, so
+      // once the budget is spent the remaining regions keep the one they
+      // have.
+      if (Stage > InitialSchedule) {
+        unsigned NumRegionInstrs = std::distance(begin(), end());
+        if (RescheduleBudget &&
+            NumRescheduled + NumRegionInstrs > RescheduleBudget) {
+          LLVM_DEBUG(dbgs() << "Reschedule budget exhausted, skipping region "
+                            << RegionIdx << ".\n");
+          ++NumRegionsOverBudget;
+          ++RegionIdx;
+          continue;
+        }
+        NumRescheduled += NumRegionInstrs;
+        ++NumRegionsRescheduled;
+      }
+
       if (RegionBegin->getParent() != MBB) {
         if (MBB) finishBlock();
         MBB = RegionBegin->getParent();
@@ -607,6 +656,7 @@ void GCNScheduleDAGMILive::finalizeSchedule() {
       // Skip empty scheduling regions (0 or 1 schedulable instructions).
       if (begin() == end() || begin() == std::prev(end())) {
         exitRegion();
+        ++RegionIdx;
         continue;
       }
 
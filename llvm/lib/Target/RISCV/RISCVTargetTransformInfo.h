@@ -42,9 +42,33 @@ public:
         TLI(ST->getTargetLowering()) {}
 
   int getIntImmCost(const APInt &Imm, Type *Ty);
-  int getIntImmCostInst(unsigned Opcode, unsigned Idx, const APInt &Imm, Type *Ty);
+  int getIntImmCostInst(unsigned Opcode, unsigned Idx, const APInt &Imm,
+                        Type *Ty);
   int getIntImmCostIntrin(Intrinsic::ID IID, unsigned Idx, const APInt &Imm,
                           Type *Ty);
+
+  /// \name Vector TTI Implementations
+  /// @{
+
+  unsigned getNumberOfRegisters(unsigned ClassID) const {
+    // There is no instruction selection for the V extension yet, so vector
+    // IR is scalarized by type legalization. Report no vector registers to
+    // keep the loop and SLP vectorizers from producing it.
+    bool Vector = (ClassID == 1);
+    if (Vector)
+      return 0;
+
+    // x1-x31; x0 is hardwired to zero.
+    return 31;
+  }
+
+  unsigned getRegisterBitWidth(bool Vector) const {
+    if (Vector)
+      return 0;
+    return ST->getXLen();
+  }
+
+  /// @}
 };
 
 } // end namespace llvm
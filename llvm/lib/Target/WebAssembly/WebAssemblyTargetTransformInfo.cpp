@@ -82,3 +82,63 @@ unsigned WebAssemblyTTIImpl::getVectorInstrCost(unsigned Opcode, Type *Val,
 
   return Cost;
 }
+
+int WebAssemblyTTIImpl::getShuffleCost(TTI::ShuffleKind Kind, Type *Tp,
+                                       int Index, Type *SubTp) {
+  // v8x16.shuffle takes its lanes from any of the bytes of two vectors, so
+  // every permutation of 128-bit vectors is a single instruction. Subvector
+  // inserts and extracts are not, they depend on how the types get split.
+  if (getST()->hasSIMD128() && Kind != TTI::SK_ExtractSubvector &&
+      Kind != TTI::SK_InsertSubvector) {
+    std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, Tp);
+    if (LT.second.is128BitVector()) {
+      // Type legalization splits the shuffle into one per part of the result,
+      // which is a single v8x16.shuffle if the part draws from at most two
+      // parts of the sources. Broadcasts, selects, reverses and transposes
+      // always do. A part of an arbitrary permutation may draw from more, and
+      // is then built lane by lane, with an extract_lane and a replace_lane
+      // per lane.
+      int NumSrcParts = Kind == TTI::SK_PermuteTwoSrc ? 2 * LT.first : LT.first;
+      if ((Kind == TTI::SK_PermuteSingleSrc ||
+           Kind == TTI::SK_PermuteTwoSrc) &&
+          NumSrcParts > 2)
+        return LT.first * 2 * LT.second.getVectorNumElements();
+      return LT.first;
+    }
+  }
+
+  return BaseT::getShuffleCost(Kind, Tp, Index, SubTp);
+}
+
+int WebAssemblyTTIImpl::getInterleavedMemoryOpCost(
+    unsigned Opcode, Type *VecTy, unsigned Factor, ArrayRef<unsigned> Indices,
+    unsigned Alignment, unsigned AddressSpace, bool UseMaskForCond,
+    bool UseMaskForGaps) {
+  assert(Factor >= 2 && "Invalid interleave factor");
+  assert(isa<VectorType>(VecTy) && "Expect a vector type");
+
+  // With a factor of two, each 128-bit part of a member comes from two parts
+  // of the wide vector, which is one v8x16.shuffle. The same holds for each
+  // part of the wide vector when storing. Larger factors draw from more than
+  // two parts, and type legalization builds those lane by lane.
+  unsigned NumElts = VecTy->getVectorNumElements();
+  if (getST()->hasSIMD128() && !UseMaskForCond && !UseMaskForGaps &&
+      Factor == 2 && NumElts % Factor == 0) {
+    auto *SubVecTy = VectorType::get(VecTy->getScalarType(), NumElts / Factor);
+    std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, SubVecTy);
+    if (LT.second.is128BitVector() &&
+        LT.second.getVectorNumElements() == SubVecTy->getVectorNumElements() /
+                                                LT.first) {
+      unsigned NumMembers =
+          Opcode == Instruction::Load && !Indices.empty() ? Indices.size()
+                                                          : Factor;
+      int MemCost = getMemoryOpCost(Opcode, VecTy, MaybeAlign(Alignment),
+                                    AddressSpace);
+      return MemCost + NumMembers * LT.first;
+    }
+  }
+
+  return BaseT::getInterleavedMemoryOpCost(Opcode, VecTy, Factor, Indices,
+                                           Alignment, AddressSpace,
+                                           UseMaskForCond, UseMaskForGaps);
+}
@@ -152,6 +152,11 @@ static cl::opt<unsigned>
     MaxFixpointIterations("attributor-max-iterations", cl::Hidden,
                           cl::desc("Maximal number of fixpoint iterations."),
                           cl::init(32));
+static cl::opt<unsigned> MaxFixpointUpdates(
+    "attributor-max-updates", cl::Hidden,
+    cl::desc("Maximal number of abstract attribute updates per run, checked "
+             "after each fixpoint iteration (0 = no limit)."),
+    cl::init(0));
 static cl::opt<bool> VerifyMaxFixpointIterations(
     "attributor-max-iterations-verify", cl::Hidden,
     cl::desc("Verify that max-iterations is a tight bound for a fixpoint"),
@@ -6731,6 +6736,7 @@ ChangeStatus Attributor::run() {
   // the abstract analysis.
 
   unsigned IterationCounter = 1;
+  unsigned UpdateCounter = 0;
 
   SmallVector<AbstractAttribute *, 64> ChangedAAs;
   SetVector<AbstractAttribute *> Worklist, InvalidAAs;
@@ -6803,6 +6809,7 @@ ChangeStatus Attributor::run() {
     for (AbstractAttribute *AA : Worklist)
       if (!AA->getState().isAtFixpoint() && !isAssumedDead(*AA, nullptr)) {
         QueriedNonFixAA = false;
+        ++UpdateCounter;
         if (AA->update(*this) == ChangeStatus::CHANGED) {
           ChangedAAs.push_back(AA);
           if (!AA->getState().isValidState())
@@ -6828,8 +6835,12 @@ ChangeStatus Attributor::run() {
     Worklist.clear();
     Worklist.insert(ChangedAAs.begin(), ChangedAAs.end());
 
-  } while (!Worklist.empty() && (IterationCounter++ < MaxFixpointIterations ||
-                                 VerifyMaxFixpointIterations));
+    // Stopping here once the update budget is spent is as sound as running
+    // out of iterations: the unsettled attributes are reverted below.
+  } while (!Worklist.empty() &&
+           ((IterationCounter++ < MaxFixpointIterations &&
+             (!MaxFixpointUpdates || UpdateCounter < MaxFixpointUpdates)) ||
+            VerifyMaxFixpointIterations));
 
   LLVM_DEBUG(dbgs() << "\n[Attributor] Fixpoint iteration done after: "
                     << IterationCounter << "/" << MaxFixpointIterations
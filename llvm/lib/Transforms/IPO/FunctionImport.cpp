@@ -1157,9 +1157,16 @@ Expected<bool> FunctionImporter::importFunctions(
       return std::move(Err);
 
     auto &ImportGUIDs = FunctionsToImportPerModule->second;
-    // Find the globals to import
+    // Find the globals to import. Only the bodies of the selected functions
+    // are materialized from the lazily loaded source module. The import list
+    // is usually tiny compared to the source module, so stop scanning once
+    // every requested GUID has been found.
     SetVector<GlobalValue *> GlobalsToImport;
+    size_t NumFound = 0;
+    auto FoundAll = [&]() { return NumFound >= ImportGUIDs.size(); };
     for (Function &F : *SrcModule) {
+      if (FoundAll())
+        break;
       if (!F.hasName())
         continue;
       auto GUID = F.getGUID();
@@ -1168,6 +1175,7 @@ Expected<bool> FunctionImporter::importFunctions(
                         << GUID << " " << F.getName() << " from "
                         << SrcModule->getSourceFileName() << "\n");
       if (Import) {
+        ++NumFound;
         if (Error Err = F.materialize())
           return std::move(Err);
         if (EnableImportMetadata) {
@@ -1182,6 +1190,8 @@ Expected<bool> FunctionImporter::importFunctions(
       }
     }
     for (GlobalVariable &GV : SrcModule->globals()) {
+      if (FoundAll())
+        break;
       if (!GV.hasName())
         continue;
       auto GUID = GV.getGUID();
@@ -1190,12 +1200,15 @@ Expected<bool> FunctionImporter::importFunctions(
                         << GUID << " " << GV.getName() << " from "
                         << SrcModule->getSourceFileName() << "\n");
       if (Import) {
+        ++NumFound;
         if (Error Err = GV.materialize())
           return std::move(Err);
         ImportedGVCount += GlobalsToImport.insert(&GV);
       }
     }
     for (GlobalAlias &GA : SrcModule->aliases()) {
+      if (FoundAll())
+        break;
       if (!GA.hasName())
         continue;
       auto GUID = GA.getGUID();
@@ -1204,6 +1217,7 @@ Expected<bool> FunctionImporter::importFunctions(
                         << GUID << " " << GA.getName() << " from "
                         << SrcModule->getSourceFileName() << "\n");
       if (Import) {
+        ++NumFound;
         if (Error Err = GA.materialize())
           return std::move(Err);
         // Import alias as a copy of its aliasee.
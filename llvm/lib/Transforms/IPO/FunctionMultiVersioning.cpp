@@ -0,0 +1,473 @@
+//===- FunctionMultiVersioning.cpp - Clone hot loops per ISA --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This pass lets a binary built for a baseline x86-64 target use newer ISA
+/// extensions in its hot code on the machines that have them.
+///
+/// Every function with a loop that the profile marks as hot is cloned once
+/// for each requested ISA level, and the clone gets the target features of
+/// that level. The vectorizers and the backend then optimize each clone for
+/// its extensions. The original function stays in place as the default
+/// version, and its symbol becomes an ifunc. The ifunc resolver checks the
+/// CPU features that __cpu_indicator_init (from libgcc or compiler-rt)
+/// reports, and returns the most capable version the running CPU supports.
+/// This is the same dispatch clang emits for target_clones.
+///
+/// The pass must run after inlining and before the vectorizers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/FunctionMultiVersioning.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/CFG.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalIFunc.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Module.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "multiversioning"
+
+STATISTIC(NumMultiVersioned, "Number of functions multiversioned");
+STATISTIC(NumVersions, "Number of function versions created");
+
+static cl::list<std::string> MultiVersioningTargets(
+    "multiversioning-targets", cl::CommaSeparated, cl::Hidden,
+    cl::desc("ISA levels (x86-64-v2, x86-64-v3, x86-64-v4) or '+'-separated "
+             "lists of CPU features to clone functions with hot loops for "
+             "(default: x86-64-v3,x86-64-v4)"));
+
+static cl::opt<unsigned> MultiVersioningSizeLimit(
+    "multiversioning-size-limit", cl::init(5000), cl::Hidden,
+    cl::desc("Do not multiversion functions with more instructions than this"));
+
+// The x86-64 micro-architecture levels, restricted to the features that the
+// runtime's CPU model reports. The resolver can't check for the others, so the
+// versions must not rely on them.
+static const struct {
+  const char *Name;
+  const char *Features;
+} ISALevels[] = {
+    {"x86-64-v2", "cmov+popcnt+sse3+ssse3+sse4.1+sse4.2"},
+    {"x86-64-v3", "cmov+popcnt+sse3+ssse3+sse4.1+sse4.2+avx+avx2+bmi+bmi2+fma"},
+    {"x86-64-v4", "cmov+popcnt+sse3+ssse3+sse4.1+sse4.2+avx+avx2+bmi+bmi2+fma+"
+                  "avx512f+avx512bw+avx512cd+avx512dq+avx512vl"},
+};
+
+namespace {
+
+/// A version to clone functions for.
+struct VersionTarget {
+  /// The suffix of the version's symbol.
+  std::string Name;
+  /// The subtarget features the version is compiled with.
+  SmallVector<StringRef, 16> Features;
+  /// The same features, as bits of __cpu_model and __cpu_features2.
+  uint64_t FeatureMask = 0;
+};
+
+class FunctionMultiVersioning {
+public:
+  FunctionMultiVersioning(
+      ProfileSummaryInfo *PSI,
+      function_ref<BlockFrequencyInfo *(Function &)> GetBFI,
+      function_ref<OptimizationRemarkEmitter &(Function &)> GetORE)
+      : PSI(PSI), GetBFI(GetBFI), GetORE(GetORE) {}
+
+  bool run(Module &M);
+
+private:
+  void parseTargets();
+  bool hasHotLoop(Function &F);
+  void getVersions(Function &F,
+                   SmallVectorImpl<const VersionTarget *> &Versions);
+  void multiVersion(Function &F, ArrayRef<const VersionTarget *> Versions);
+  void emitResolverBody(Function &Resolver, Function &Default,
+                        ArrayRef<Function *> Clones,
+                        ArrayRef<const VersionTarget *> Versions);
+
+  ProfileSummaryInfo *PSI;
+  function_ref<BlockFrequencyInfo *(Function &)> GetBFI;
+  function_ref<OptimizationRemarkEmitter &(Function &)> GetORE;
+
+  /// The versions to create, most capable first.
+  SmallVector<VersionTarget, 4> Targets;
+
+  /// Functions that are already dispatched through an ifunc, along with the
+  /// resolvers.
+  SmallPtrSet<const Function *, 16> Dispatched;
+};
+
+class FunctionMultiVersioningLegacyPass : public ModulePass {
+public:
+  static char ID;
+  FunctionMultiVersioningLegacyPass() : ModulePass(ID) {
+    initializeFunctionMultiVersioningLegacyPassPass(
+        *PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+  }
+
+  bool runOnModule(Module &M) override;
+};
+
+} // end anonymous namespace
+
+/// Return the bit that __cpu_model and __cpu_features2 use for \p Feature, or
+/// ~0U if the runtime doesn't report it.
+static unsigned getCPUFeatureBit(StringRef Feature) {
+  return StringSwitch<unsigned>(Feature)
+#define X86_FEATURE_COMPAT(VAL, ENUM, STR) .Case(STR, VAL)
+#include "llvm/Support/X86TargetParser.def"
+      .Default(~0U);
+}
+
+void FunctionMultiVersioning::parseTargets() {
+  SmallVector<StringRef, 4> Specs(MultiVersioningTargets.begin(),
+                                  MultiVersioningTargets.end());
+  if (Specs.empty())
+    Specs = {"x86-64-v3", "x86-64-v4"};
+
+  for (StringRef Spec : Specs) {
+    VersionTarget T;
+    StringRef FeatureList = Spec;
+    for (const auto &Level : ISALevels)
+      if (Spec == Level.Name)
+        FeatureList = Level.Features;
+
+    FeatureList.split(T.Features, '+', -1, /*KeepEmpty=*/false);
+    for (StringRef Feature : T.Features) {
+      unsigned Bit = getCPUFeatureBit(Feature);
+      if (Bit == ~0U)
+        report_fatal_error("unknown CPU feature '" + Feature +
+                           "' in -multiversioning-targets");
+      T.FeatureMask |= 1ULL << Bit;
+    }
+
+    // '+' and '.' are both valid in symbol names, but they would need quotes
+    // in assembly.
+    for (char C : Spec)
+      T.Name += (C == '+' || C == '.') ? '_' : C;
+    Targets.push_back(std::move(T));
+  }
+
+  // The resolver picks the first version the CPU supports, so make sure that
+  // each version comes before the ones whose features are a subset of its own.
+  llvm::stable_sort(Targets, [](const VersionTarget &A,
+                                const VersionTarget &B) {
+    return countPopulation(A.FeatureMask) > countPopulation(B.FeatureMask);
+  });
+}
+
+/// Check whether \p F has a loop whose header is hot.
+bool FunctionMultiVersioning::hasHotLoop(Function &F) {
+  SmallVector<std::pair<const BasicBlock *, const BasicBlock *>, 8> BackEdges;
+  FindFunctionBackedges(F, BackEdges);
+  if (BackEdges.empty())
+    return false;
+
+  BlockFrequencyInfo *BFI = GetBFI(F);
+  return any_of(BackEdges, [&](const std::pair<const BasicBlock *,
+                                               const BasicBlock *> &Edge) {
+    return PSI->isHotBlock(Edge.second, BFI);
+  });
+}
+
+/// Collect the versions \p F should be cloned for into \p Versions. This is
+/// empty if \p F should not be multiversioned at all.
+void FunctionMultiVersioning::getVersions(
+    Function &F, SmallVectorImpl<const VersionTarget *> &Versions) {
+  if (F.isDeclaration() || !F.hasName() || Dispatched.count(&F))
+    return;
+
+  // The ifunc takes over the symbol, so it must be defined here once and for
+  // all: it can't be preempted, or merged with definitions in other modules.
+  if (!(F.hasExternalLinkage() || F.hasLocalLinkage()) || F.hasComdat())
+    return;
+
+  if (F.hasOptNone() || F.hasFnAttribute(Attribute::Naked))
+    return;
+
+  // A blockaddress must refer to a function, not to an ifunc.
+  if (any_of(F, [](const BasicBlock &BB) { return BB.hasAddressTaken(); }))
+    return;
+
+  if (F.getInstructionCount() > MultiVersioningSizeLimit)
+    return;
+
+  // Skip the versions whose features the function already enables
+  // explicitly.
+  SmallVector<StringRef, 16> Enabled;
+  F.getFnAttribute("target-features").getValueAsString().split(Enabled, ',');
+  for (const VersionTarget &T : Targets) {
+    bool HasAll = all_of(T.Features, [&](StringRef Feature) {
+      return any_of(Enabled, [&](StringRef E) {
+        return E.consume_front("+") && E == Feature;
+      });
+    });
+    if (!HasAll)
+      Versions.push_back(&T);
+  }
+  if (Versions.empty())
+    return;
+
+  if (!hasHotLoop(F))
+    Versions.clear();
+}
+
+/// Append \p Features to the target features of \p F.
+static void addTargetFeatures(Function &F, ArrayRef<StringRef> Features) {
+  std::string FS = F.getFnAttribute("target-features").getValueAsString().str();
+  for (StringRef Feature : Features) {
+    if (!FS.empty())
+      FS += ',';
+    FS += '+';
+    FS += Feature;
+  }
+  F.addFnAttr("target-features", FS);
+}
+
+void FunctionMultiVersioning::multiVersion(
+    Function &F, ArrayRef<const VersionTarget *> Versions) {
+  Module &M = *F.getParent();
+  std::string Name = F.getName().str();
+  GlobalValue::LinkageTypes Linkage = F.getLinkage();
+  GlobalValue::VisibilityTypes Visibility = F.getVisibility();
+
+  OptimizationRemarkEmitter &ORE = GetORE(F);
+  ORE.emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "MultiVersioned", &F)
+           << "multiversioned " << ore::NV("Function", &F) << " for "
+           << ore::NV("NumVersions", unsigned(Versions.size()))
+           << " ISA levels";
+  });
+
+  SmallVector<Function *, 4> Clones;
+  for (const VersionTarget *T : Versions) {
+    ValueToValueMapTy VMap;
+    Function *Clone = CloneFunction(&F, VMap);
+    Clone->setName(Name + "." + T->Name);
+    Clone->setLinkage(GlobalValue::InternalLinkage);
+    addTargetFeatures(*Clone, T->Features);
+    Clones.push_back(Clone);
+  }
+
+  // Hand the symbol over to the ifunc. The original body becomes the default
+  // version.
+  F.setName(Name + ".default");
+  F.setLinkage(GlobalValue::InternalLinkage);
+
+  FunctionType *ResolverTy = FunctionType::get(F.getType(), false);
+  Function *Resolver = Function::Create(
+      ResolverTy, GlobalValue::InternalLinkage, Name + ".resolver", &M);
+  GlobalIFunc *IFunc =
+      GlobalIFunc::create(F.getFunctionType(), F.getAddressSpace(), Linkage,
+                          Name, Resolver, &M);
+  IFunc->setVisibility(Visibility);
+  F.replaceAllUsesWith(IFunc);
+
+  // There is no need to dispatch recursive calls again: each version calls
+  // itself directly.
+  auto UseIn = [](const Function *Fn) {
+    return [Fn](Use &U) {
+      auto *I = dyn_cast<Instruction>(U.getUser());
+      return I && I->getFunction() == Fn;
+    };
+  };
+  IFunc->replaceUsesWithIf(&F, UseIn(&F));
+  for (Function *Clone : Clones)
+    IFunc->replaceUsesWithIf(Clone, UseIn(Clone));
+
+  emitResolverBody(*Resolver, F, Clones, Versions);
+
+  Dispatched.insert(&F);
+  Dispatched.insert(Resolver);
+  Dispatched.insert(Clones.begin(), Clones.end());
+  ++NumMultiVersioned;
+  NumVersions += Clones.size();
+  LLVM_DEBUG(dbgs() << "Multiversioned " << Name << " into " << Clones.size()
+                    << " versions\n");
+}
+
+void FunctionMultiVersioning::emitResolverBody(
+    Function &Resolver, Function &Default, ArrayRef<Function *> Clones,
+    ArrayRef<const VersionTarget *> Versions) {
+  Module &M = *Resolver.getParent();
+  IRBuilder<> Builder(BasicBlock::Create(M.getContext(), "resolver_entry",
+                                         &Resolver));
+  Type *Int32Ty = Builder.getInt32Ty();
+
+  // Resolvers may run before the constructor that initializes the CPU model.
+  FunctionCallee Init =
+      M.getOrInsertFunction("__cpu_indicator_init", Builder.getVoidTy());
+  if (auto *InitFn = dyn_cast<Function>(Init.getCallee()))
+    InitFn->setDSOLocal(true);
+  Builder.CreateCall(Init);
+
+  // Load the feature words that any of the versions needs.
+  uint64_t AllFeatures = 0;
+  for (const VersionTarget *T : Versions)
+    AllFeatures |= T->FeatureMask;
+
+  Value *Features1 = nullptr;
+  if (Lo_32(AllFeatures)) {
+    // Matching the struct layout from the compiler-rt/libgcc structure that is
+    // filled in:
+    // unsigned int __cpu_vendor;
+    // unsigned int __cpu_type;
+    // unsigned int __cpu_subtype;
+    // unsigned int __cpu_features[1];
+    StructType *STy = StructType::get(Int32Ty, Int32Ty, Int32Ty,
+                                      ArrayType::get(Int32Ty, 1));
+    Constant *CpuModel = M.getOrInsertGlobal("__cpu_model", STy);
+    if (auto *GV = dyn_cast<GlobalValue>(CpuModel))
+      GV->setDSOLocal(true);
+    Value *Idxs[] = {Builder.getInt32(0), Builder.getInt32(3),
+                     Builder.getInt32(0)};
+    Value *CpuFeatures = Builder.CreateInBoundsGEP(STy, CpuModel, Idxs);
+    Features1 = Builder.CreateAlignedLoad(Int32Ty, CpuFeatures, Align(4));
+  }
+
+  Value *Features2 = nullptr;
+  if (Hi_32(AllFeatures)) {
+    Constant *CpuFeatures2 = M.getOrInsertGlobal("__cpu_features2", Int32Ty);
+    if (auto *GV = dyn_cast<GlobalValue>(CpuFeatures2))
+      GV->setDSOLocal(true);
+    Features2 = Builder.CreateAlignedLoad(Int32Ty, CpuFeatures2, Align(4));
+  }
+
+  auto EmitCheck = [&](Value *Features, uint32_t Mask, Value *Result) {
+    if (!Mask)
+      return Result;
+    Value *MaskV = Builder.getInt32(Mask);
+    return Builder.CreateAnd(
+        Result, Builder.CreateICmpEQ(Builder.CreateAnd(Features, MaskV), MaskV));
+  };
+
+  // Select from the least to the most capable version, so that the most
+  // capable version the CPU supports wins.
+  Value *Result = &Default;
+  for (unsigned I = Versions.size(); I--;) {
+    uint64_t Mask = Versions[I]->FeatureMask;
+    Value *Supported = Builder.getTrue();
+    Supported = EmitCheck(Features1, Lo_32(Mask), Supported);
+    Supported = EmitCheck(Features2, Hi_32(Mask), Supported);
+    Result = Builder.CreateSelect(Supported, Clones[I], Result);
+  }
+  Builder.CreateRet(Result);
+}
+
+bool FunctionMultiVersioning::run(Module &M) {
+  // Dispatching through an ifunc needs the ELF dynamic loader, and the ISA
+  // levels only exist for x86-64.
+  Triple TT(M.getTargetTriple());
+  if (TT.getArch() != Triple::x86_64 || !TT.isOSBinFormatELF())
+    return false;
+
+  if (!PSI || !PSI->hasProfileSummary())
+    return false;
+
+  parseTargets();
+
+  // Leave alone what is already dispatched, e.g. by target_clones.
+  for (GlobalIFunc &GI : M.ifuncs()) {
+    auto *Resolver = dyn_cast<Function>(GI.getResolver()->stripPointerCasts());
+    if (!Resolver)
+      continue;
+    Dispatched.insert(Resolver);
+    for (Instruction &I : instructions(Resolver))
+      for (Value *Op : I.operands())
+        if (auto *Fn = dyn_cast<Function>(Op->stripPointerCasts()))
+          Dispatched.insert(Fn);
+  }
+
+  SmallVector<std::pair<Function *, SmallVector<const VersionTarget *, 4>>, 8>
+      Worklist;
+  for (Function &F : M) {
+    SmallVector<const VersionTarget *, 4> Versions;
+    getVersions(F, Versions);
+    if (!Versions.empty())
+      Worklist.emplace_back(&F, std::move(Versions));
+  }
+
+  for (auto &Item : Worklist)
+    multiVersion(*Item.first, Item.second);
+  return !Worklist.empty();
+}
+
+bool FunctionMultiVersioningLegacyPass::runOnModule(Module &M) {
+  if (skipModule(M))
+    return false;
+  ProfileSummaryInfo *PSI =
+      &getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
+  auto GBFI = [this](Function &F) {
+    return &this->getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+  };
+  std::unique_ptr<OptimizationRemarkEmitter> ORE;
+  auto GetORE = [&ORE](Function &F) -> OptimizationRemarkEmitter & {
+    ORE.reset(new OptimizationRemarkEmitter(&F));
+    return *ORE.get();
+  };
+
+  return FunctionMultiVersioning(PSI, GBFI, GetORE).run(M);
+}
+
+PreservedAnalyses FunctionMultiVersioningPass::run(Module &M,
+                                                   ModuleAnalysisManager &AM) {
+  auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+
+  auto GBFI = [&FAM](Function &F) {
+    return &FAM.getResult<BlockFrequencyAnalysis>(F);
+  };
+
+  std::unique_ptr<OptimizationRemarkEmitter> ORE;
+  auto GetORE = [&ORE](Function &F) -> OptimizationRemarkEmitter & {
+    ORE.reset(new OptimizationRemarkEmitter(&F));
+    return *ORE.get();
+  };
+
+  ProfileSummaryInfo *PSI = &AM.getResult<ProfileSummaryAnalysis>(M);
+
+  if (FunctionMultiVersioning(PSI, GBFI, GetORE).run(M))
+    return PreservedAnalyses::none();
+  return PreservedAnalyses::all();
+}
+
+char FunctionMultiVersioningLegacyPass::ID = 0;
+INITIALIZE_PASS_BEGIN(FunctionMultiVersioningLegacyPass, "multiversioning",
+                      "Multiversion functions with hot loops", false, false)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(FunctionMultiVersioningLegacyPass, "multiversioning",
+                    "Multiversion functions with hot loops", false, false)
+
+ModulePass *llvm::createFunctionMultiVersioningPass() {
+  return new FunctionMultiVersioningLegacyPass();
+}
@@ -89,6 +89,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
@@ -104,6 +105,7 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
@@ -120,9 +122,11 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/MergeFunctions.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/FunctionComparator.h"
 #include <algorithm>
 #include <cassert>
@@ -139,6 +143,7 @@ STATISTIC(NumFunctionsMerged, "Number of functions merged");
 STATISTIC(NumThunksWritten, "Number of thunks generated");
 STATISTIC(NumAliasesWritten, "Number of aliases generated");
 STATISTIC(NumDoubleWeak, "Number of new functions created");
+STATISTIC(NumParameterized, "Number of functions merged modulo constants");
 
 static cl::opt<unsigned> NumFunctionsForSanityCheck(
     "mergefunc-sanity",
@@ -172,6 +177,19 @@ static cl::opt<bool>
                           cl::init(false),
                           cl::desc("Allow mergefunc to create aliases"));
 
+// Under option -mergefunc-parameterize-constants, functions that are equal
+// except for some integer constants are merged too: the constants become
+// extra parameters of a shared internal implementation, and each original
+// function becomes a thunk passing its own values.
+static cl::opt<bool> MergeFunctionsParameterize(
+    "mergefunc-parameterize-constants", cl::Hidden, cl::init(false),
+    cl::desc("Merge functions that differ only in integer constants"));
+
+static cl::opt<unsigned> MergeFunctionsMaxParams(
+    "mergefunc-max-parameterized-constants", cl::Hidden, cl::init(4),
+    cl::desc("Maximum number of constants turned into parameters when "
+             "merging functions that differ in constants"));
+
 namespace {
 
 class FunctionNode {
@@ -235,6 +253,11 @@ private:
   bool doSanityCheck(std::vector<WeakTrackingVH> &Worklist);
 #endif
 
+  /// Number every global of \p M and compute the data layout information
+  /// FunctionComparator queries for \p Fns, so that the comparisons of these
+  /// functions have no side effects and may run concurrently.
+  void prepareConcurrentCompare(Module &M, ArrayRef<Function *> Fns);
+
   /// Insert a ComparableFunction into the FnTree, or merge it away if it's
   /// equal to one that's already present.
   bool insert(Function *NewFunction);
@@ -283,6 +306,16 @@ private:
   /// Replace function F with function G in the function tree.
   void replaceFunctionInTree(const FunctionNode &FN, Function *G);
 
+  /// Merge the functions of \p M that are equal except for some integer
+  /// constants into shared implementations taking the constants as extra
+  /// parameters.
+  bool mergeModuloConstants(Module &M);
+
+  /// Replace G with a tail call to F, passing G's arguments followed by
+  /// \p ExtraArgs.
+  void writeParameterizedThunk(Function *F, Function *G,
+                               ArrayRef<Constant *> ExtraArgs);
+
   /// The set of all distinct functions. Use the insert() and remove() methods
   /// to modify it. The map allows efficient lookup and deferring of Functions.
   FnTreeType FnTree;
@@ -408,30 +441,75 @@ static bool isEligibleForMerging(Function &F) {
   return !F.isDeclaration() && !F.hasAvailableExternallyLinkage();
 }
 
+void MergeFunctions::prepareConcurrentCompare(Module &M,
+                                              ArrayRef<Function *> Fns) {
+  // FunctionComparator numbers globals on first sight; do it up front.
+  for (GlobalValue &GV : M.global_values())
+    GlobalNumbers.getNumber(&GV);
+
+  // The DataLayout caches struct layouts and integer types when asked for
+  // them. Ask for everything cmpTypes() and cmpGEPs() will need now.
+  const DataLayout &DL = M.getDataLayout();
+  DL.getIntPtrType(M.getContext());
+  for (Function *F : Fns)
+    for (Instruction &I : instructions(F))
+      if (auto *GEP = dyn_cast<GEPOperator>(&I)) {
+        APInt Offset(DL.getPointerSizeInBits(GEP->getPointerAddressSpace()),
+                     0);
+        GEP->accumulateConstantOffset(DL, Offset);
+      }
+}
+
 bool MergeFunctions::runOnModule(Module &M) {
   bool Changed = false;
 
   // All functions in the module, ordered by hash. Functions with a unique
   // hash value are easily eliminated.
-  std::vector<std::pair<FunctionComparator::FunctionHash, Function *>>
-    HashedFuncs;
+  using HashedFunc = std::pair<FunctionComparator::FunctionHash, Function *>;
+  std::vector<HashedFunc> HashedFuncs;
   for (Function &Func : M) {
     if (isEligibleForMerging(Func)) {
-      HashedFuncs.push_back({FunctionComparator::functionHash(Func), &Func});
+      HashedFuncs.push_back({0, &Func});
     }
   }
+  parallel::for_each_n(parallel::par, size_t(0), HashedFuncs.size(),
+                       [&](size_t I) {
+    HashedFuncs[I].first =
+        FunctionComparator::functionHash(*HashedFuncs[I].second);
+  });
 
   llvm::stable_sort(HashedFuncs, less_first());
 
-  auto S = HashedFuncs.begin();
-  for (auto I = HashedFuncs.begin(), IE = HashedFuncs.end(); I != IE; ++I) {
-    // If the hash value matches the previous value or the next one, we must
-    // consider merging it. Otherwise it is dropped and never considered again.
-    if ((I != S && std::prev(I)->first == I->first) ||
-        (std::next(I) != IE && std::next(I)->first == I->first) ) {
-      Deferred.push_back(WeakTrackingVH(I->second));
+  // Functions sharing a hash value have to be compared. Sort each group of
+  // them in the order of the FnTree, concurrently; inserting them in that
+  // order below then takes a single comparison per function.
+  std::vector<std::pair<size_t, size_t>> Buckets;
+  std::vector<Function *> BucketFuncs;
+  for (size_t I = 0, E = HashedFuncs.size(); I != E;) {
+    size_t J = I + 1;
+    while (J != E && HashedFuncs[J].first == HashedFuncs[I].first)
+      ++J;
+    if (J - I > 1) {
+      Buckets.push_back({I, J});
+      for (size_t K = I; K != J; ++K)
+        BucketFuncs.push_back(HashedFuncs[K].second);
     }
+    I = J;
   }
+  prepareConcurrentCompare(M, BucketFuncs);
+  auto FnLess = [&](const HashedFunc &L, const HashedFunc &R) {
+    return FunctionComparator(L.second, R.second, &GlobalNumbers).compare() ==
+           -1;
+  };
+  parallel::for_each_n(parallel::par, size_t(0), Buckets.size(),
+                       [&](size_t I) {
+    std::stable_sort(HashedFuncs.begin() + Buckets[I].first,
+                     HashedFuncs.begin() + Buckets[I].second, FnLess);
+  });
+
+  for (const std::pair<size_t, size_t> &Bucket : Buckets)
+    for (size_t I = Bucket.first; I != Bucket.second; ++I)
+      Deferred.push_back(WeakTrackingVH(HashedFuncs[I].second));
 
   do {
     std::vector<WeakTrackingVH> Worklist;
@@ -456,6 +534,10 @@ bool MergeFunctions::runOnModule(Module &M) {
 
   FnTree.clear();
   FNodesInTree.clear();
+
+  if (MergeFunctionsParameterize)
+    Changed |= mergeModuloConstants(M);
+
   GlobalNumbers.clear();
 
   return Changed;
@@ -861,6 +943,200 @@ void MergeFunctions::mergeTwoFunctions(Function *F, Function *G) {
   }
 }
 
+// Replace G with a tail call to F that passes G's arguments followed by the
+// constants G used where F's body now refers to the extra parameters.
+void MergeFunctions::writeParameterizedThunk(Function *F, Function *G,
+                                             ArrayRef<Constant *> ExtraArgs) {
+  Function *NewG = Function::Create(G->getFunctionType(), G->getLinkage(),
+                                    G->getAddressSpace(), "", G->getParent());
+  NewG->setComdat(G->getComdat());
+  BasicBlock *BB = BasicBlock::Create(F->getContext(), "", NewG);
+  IRBuilder<> Builder(BB);
+
+  SmallVector<Value *, 16> Args;
+  for (Argument &AI : NewG->args())
+    Args.push_back(&AI);
+  Args.append(ExtraArgs.begin(), ExtraArgs.end());
+
+  CallInst *CI = Builder.CreateCall(F, Args);
+  CI->setTailCall();
+  CI->setCallingConv(F->getCallingConv());
+  CI->setAttributes(F->getAttributes());
+  if (NewG->getReturnType()->isVoidTy())
+    Builder.CreateRetVoid();
+  else
+    Builder.CreateRet(CI);
+
+  NewG->copyAttributesFrom(G);
+  NewG->takeName(G);
+  G->replaceAllUsesWith(NewG);
+  G->eraseFromParent();
+
+  LLVM_DEBUG(dbgs() << "writeParameterizedThunk: " << NewG->getName() << '\n');
+  ++NumThunksWritten;
+}
+
+/// Whether the constants of \p F may be turned into parameters.
+static bool canParameterize(Function &F) {
+  // The thunks cannot forward variable arguments, a musttail call in the
+  // shared body would no longer match its caller, and the cloned body would
+  // share the debug info of the original.
+  if (!isEligibleForMerging(F) || F.isVarArg() || F.getSubprogram() ||
+      !canCreateThunkFor(&F))
+    return false;
+  for (Instruction &I : instructions(F)) {
+    if (auto *CI = dyn_cast<CallInst>(&I))
+      if (CI->isMustTailCall())
+        return false;
+    // FunctionComparator considers references to the function itself equal,
+    // but a recursive call in the shared body would go to the first member
+    // with that member's constants.
+    for (Value *Op : I.operands())
+      if (Op->stripPointerCasts() == &F)
+        return false;
+  }
+  return true;
+}
+
+bool MergeFunctions::mergeModuloConstants(Module &M) {
+  // Functions equal modulo constants have equal hashes, because the hash does
+  // not look at the values of operands.
+  using HashedFunc = std::pair<FunctionComparator::FunctionHash, Function *>;
+  std::vector<HashedFunc> HashedFuncs;
+  for (Function &Func : M)
+    if (canParameterize(Func))
+      HashedFuncs.push_back({FunctionComparator::functionHash(Func), &Func});
+  llvm::stable_sort(HashedFuncs, less_first());
+
+  std::vector<std::pair<size_t, size_t>> Buckets;
+  std::vector<Function *> BucketFuncs;
+  for (size_t I = 0, E = HashedFuncs.size(); I != E;) {
+    size_t J = I + 1;
+    while (J != E && HashedFuncs[J].first == HashedFuncs[I].first)
+      ++J;
+    if (J - I > 1) {
+      Buckets.push_back({I, J});
+      for (size_t K = I; K != J; ++K)
+        BucketFuncs.push_back(HashedFuncs[K].second);
+    }
+    I = J;
+  }
+  if (Buckets.empty())
+    return false;
+
+  // A group of functions sharing one implementation: the body of the first
+  // member, with the constant operands listed in Params replaced by extra
+  // parameters. Values holds each member's constants for these parameters.
+  struct ParamGroup {
+    SmallVector<Function *, 4> Members;
+    SmallSetVector<std::pair<const Instruction *, unsigned>, 4> Params;
+    SmallVector<SmallVector<FunctionComparator::ConstantDiff, 4>, 4> Diffs;
+  };
+  std::vector<std::vector<ParamGroup>> BucketGroups(Buckets.size());
+
+  // Form the groups of each bucket concurrently. Only the IR is changed
+  // afterwards, serially.
+  prepareConcurrentCompare(M, BucketFuncs);
+  parallel::for_each_n(parallel::par, size_t(0), Buckets.size(),
+                       [&](size_t B) {
+    std::vector<Function *> Pending;
+    for (size_t I = Buckets[B].first; I != Buckets[B].second; ++I)
+      Pending.push_back(HashedFuncs[I].second);
+
+    while (Pending.size() > 1) {
+      ParamGroup Group;
+      Function *Rep = Pending.front();
+      Group.Members.push_back(Rep);
+      Group.Diffs.emplace_back();
+      std::vector<Function *> Rest;
+      for (Function *G : makeArrayRef(Pending).drop_front()) {
+        SmallVector<FunctionComparator::ConstantDiff, 4> Diffs;
+        FunctionComparator FCmp(Rep, G, &GlobalNumbers);
+        if (FCmp.compareModuloConstants(Diffs) != 0 || Diffs.empty()) {
+          Rest.push_back(G);
+          continue;
+        }
+        auto NewParams = Group.Params;
+        for (const FunctionComparator::ConstantDiff &D : Diffs)
+          NewParams.insert({D.Inst, D.OpNo});
+        if (NewParams.size() > MergeFunctionsMaxParams) {
+          Rest.push_back(G);
+          continue;
+        }
+        Group.Params = std::move(NewParams);
+        Group.Members.push_back(G);
+        Group.Diffs.push_back(std::move(Diffs));
+      }
+      // The thunks have to be smaller than the code they replace.
+      if (Group.Members.size() > 1 &&
+          Rep->getInstructionCount() > Group.Params.size() + 2)
+        BucketGroups[B].push_back(std::move(Group));
+      Pending = std::move(Rest);
+    }
+  });
+
+  bool Changed = false;
+  for (std::vector<ParamGroup> &Groups : BucketGroups) {
+    for (ParamGroup &Group : Groups) {
+      Function *Rep = Group.Members.front();
+      FunctionType *RepTy = Rep->getFunctionType();
+      SmallVector<Type *, 8> ParamTys(RepTy->param_begin(),
+                                      RepTy->param_end());
+      for (const auto &P : Group.Params)
+        ParamTys.push_back(P.first->getOperand(P.second)->getType());
+      FunctionType *FTy =
+          FunctionType::get(RepTy->getReturnType(), ParamTys, false);
+
+      // Clone the first member into the shared implementation.
+      Function *Shared =
+          Function::Create(FTy, GlobalValue::InternalLinkage,
+                           Rep->getAddressSpace(), Rep->getName() + ".merged",
+                           &M);
+      ValueToValueMapTy VMap;
+      Function::arg_iterator SharedArg = Shared->arg_begin();
+      for (Argument &Arg : Rep->args()) {
+        SharedArg->setName(Arg.getName());
+        VMap[&Arg] = &*SharedArg++;
+      }
+      SmallVector<ReturnInst *, 8> Returns;
+      CloneFunctionInto(Shared, Rep, VMap, /*ModuleLevelChanges=*/false,
+                        Returns);
+      Shared->setLinkage(GlobalValue::InternalLinkage);
+      Shared->setVisibility(GlobalValue::DefaultVisibility);
+      Shared->setDLLStorageClass(GlobalValue::DefaultStorageClass);
+      Shared->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+      Shared->setComdat(nullptr);
+      for (const auto &P : Group.Params) {
+        auto *NewInst = cast<Instruction>(VMap[P.first]);
+        NewInst->setOperand(P.second, &*SharedArg++);
+      }
+
+      // Each member passes the constants it uses. A member that agrees with
+      // the first one on an operand has no diff recorded for it. Collect all
+      // of them before the first member's body goes away.
+      SmallVector<SmallVector<Constant *, 4>, 4> Values;
+      for (unsigned I = 0, E = Group.Members.size(); I != E; ++I) {
+        Values.emplace_back();
+        for (const auto &P : Group.Params) {
+          Constant *V = cast<Constant>(P.first->getOperand(P.second));
+          for (const FunctionComparator::ConstantDiff &D : Group.Diffs[I])
+            if (D.Inst == P.first && D.OpNo == P.second)
+              V = D.RightValue;
+          Values.back().push_back(V);
+        }
+      }
+      for (unsigned I = 0, E = Group.Members.size(); I != E; ++I) {
+        LLVM_DEBUG(dbgs() << "  " << Shared->getName() << " <- "
+                          << Group.Members[I]->getName() << '\n');
+        writeParameterizedThunk(Shared, Group.Members[I], Values[I]);
+        ++NumParameterized;
+      }
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
 /// Replace function F by function G.
 void MergeFunctions::replaceFunctionInTree(const FunctionNode &FN,
                                            Function *G) {
@@ -902,23 +1178,41 @@ static bool isFuncOrderCorrect(const Function *F, const Function *G) {
 // Insert a ComparableFunction into the FnTree, or merge it away if equal to one
 // that was already inserted.
 bool MergeFunctions::insert(Function *NewFunction) {
-  std::pair<FnTreeType::iterator, bool> Result =
-      FnTree.insert(FunctionNode(NewFunction));
+  FnTreeType::iterator Result = FnTree.end();
+  bool Inserted = false;
+  {
+    // The functions of the first sweep arrive in the order of the FnTree, so
+    // they are either equal to the last node or belong after it. The node
+    // must be gone by the time NewFunction may be merged away.
+    FunctionNode NewNode(NewFunction);
+    if (!FnTree.empty()) {
+      FnTreeType::iterator Last = std::prev(FnTree.end());
+      if (Last->getHash() == NewNode.getHash() &&
+          FunctionComparator(Last->getFunc(), NewFunction, &GlobalNumbers)
+                  .compare() == 0)
+        Result = Last;
+    }
+    if (Result == FnTree.end()) {
+      size_t OldSize = FnTree.size();
+      Result = FnTree.insert(FnTree.end(), NewNode);
+      Inserted = FnTree.size() != OldSize;
+    }
+  }
 
-  if (Result.second) {
+  if (Inserted) {
     assert(FNodesInTree.count(NewFunction) == 0);
-    FNodesInTree.insert({NewFunction, Result.first});
+    FNodesInTree.insert({NewFunction, Result});
     LLVM_DEBUG(dbgs() << "Inserting as unique: " << NewFunction->getName()
                       << '\n');
     return false;
   }
 
-  const FunctionNode &OldF = *Result.first;
+  const FunctionNode &OldF = *Result;
 
   if (!isFuncOrderCorrect(OldF.getFunc(), NewFunction)) {
     // Swap the two functions.
     Function *F = OldF.getFunc();
-    replaceFunctionInTree(*Result.first, NewFunction);
+    replaceFunctionInTree(*Result, NewFunction);
     NewFunction = F;
     assert(OldF.getFunc() != F && "Must have swapped the functions.");
   }
@@ -9,17 +9,20 @@
 // OpenMP specific optimizations:
 //
 // - Deduplication of runtime calls, e.g., omp_get_thread_num.
+// - Hoisting of loop invariant runtime calls into the function entry.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/IPO/OpenMPOpt.h"
 
 #include "llvm/ADT/EnumeratedArray.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
 #include "llvm/Frontend/OpenMP/OMPConstants.h"
 #include "llvm/Frontend/OpenMP/OMPIRBuilder.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/InitializePasses.h"
 #include "llvm/Support/CommandLine.h"
@@ -39,6 +42,8 @@ static cl::opt<bool> DisableOpenMPOptimizations(
 
 STATISTIC(NumOpenMPRuntimeCallsDeduplicated,
           "Number of OpenMP runtime calls deduplicated");
+STATISTIC(NumOpenMPRuntimeCallsHoisted,
+          "Number of OpenMP runtime calls hoisted out of loops");
 STATISTIC(NumOpenMPRuntimeFunctionsIdentified,
           "Number of OpenMP runtime functions identified");
 STATISTIC(NumOpenMPRuntimeFunctionUsesIdentified,
@@ -184,7 +189,7 @@ private:
 
     for (Function *F : SCC) {
       for (auto DeduplicableRuntimeCallID : DeduplicableRuntimeCallIDs)
-        deduplicateRuntimeCalls(*F, RFIs[DeduplicableRuntimeCallID]);
+        Changed |= deduplicateRuntimeCalls(*F, RFIs[DeduplicableRuntimeCallID]);
 
       // __kmpc_global_thread_num is special as we can replace it with an
       // argument in enough cases to make it worth trying.
@@ -206,8 +211,10 @@ private:
   bool deduplicateRuntimeCalls(Function &F, RuntimeFunctionInfo &RFI,
                                Value *ReplVal = nullptr) {
     auto &Uses = RFI.UsesMap[&F];
-    if (Uses.size() + (ReplVal != nullptr) < 2)
+    if (Uses.empty())
       return false;
+    if (Uses.size() + (ReplVal != nullptr) < 2)
+      return hoistRuntimeCall(F, RFI, **Uses.begin());
 
     LLVM_DEBUG(dbgs() << TAG << "Deduplicate " << Uses.size() << " uses of "
                       << RFI.Name
@@ -216,11 +223,15 @@ private:
     assert((!ReplVal || (isa<Argument>(ReplVal) &&
                          cast<Argument>(ReplVal)->getParent() == &F)) &&
            "Unexpected replacement value!");
+    // The first call that can be hoisted replaces the others. It is only
+    // moved to the entry once one of them has been replaced.
+    CallInst *HoistedCI = nullptr;
     if (!ReplVal) {
       for (Use *U : Uses)
         if (CallInst *CI = getCallIfRegularCall(*U, &RFI)) {
-          CI->moveBefore(&*F.getEntryBlock().getFirstInsertionPt());
-          ReplVal = CI;
+          if (!canBeHoisted(*CI))
+            continue;
+          ReplVal = HoistedCI = CI;
           break;
         }
       if (!ReplVal)
@@ -233,6 +244,8 @@ private:
       if (!CI || CI == ReplVal || &F != &Caller)
         return false;
       assert(CI->getCaller() == &F && "Unexpected call!");
+      if (!isEquivalentCall(*CI, ReplVal, RFI))
+        return false;
       CGUpdater.removeCallSite(*CI);
       CI->replaceAllUsesWith(ReplVal);
       CI->eraseFromParent();
@@ -242,9 +255,63 @@ private:
     };
     RFI.foreachUse(ReplaceAndDeleteCB);
 
+    if (Changed && HoistedCI)
+      HoistedCI->moveBefore(&*F.getEntryBlock().getFirstInsertionPt());
     return Changed;
   }
 
+  /// Return true if \p CI can be moved to the entry of its function, that is
+  /// all arguments are available there.
+  static bool canBeHoisted(CallInst &CI) {
+    return llvm::all_of(CI.arg_operands(), [](Value *Op) {
+      return isa<Constant>(Op) || isa<Argument>(Op);
+    });
+  }
+
+  /// Return true if \p CI computes the same value as \p ReplVal, a hoisted
+  /// call of \p RFI or a global thread id argument.
+  static bool isEquivalentCall(CallInst &CI, Value *ReplVal,
+                               RuntimeFunctionInfo &RFI) {
+    // The ident argument of __kmpc_global_thread_num only carries source
+    // location information.
+    if (RFI.Kind == OMPRTL___kmpc_global_thread_num)
+      return true;
+    auto *ReplCI = dyn_cast<CallInst>(ReplVal);
+    if (!ReplCI || ReplCI->getNumArgOperands() != CI.getNumArgOperands())
+      return false;
+    return std::equal(CI.arg_begin(), CI.arg_end(), ReplCI->arg_begin());
+  }
+
+  /// Move the only call of \p RFI in \p F, given by its use \p U, into the
+  /// entry block if it is executed in a loop. The deduplicable runtime calls
+  /// are getters without side effects, so executing one once on every path is
+  /// fine and avoids repeated calls into the runtime.
+  bool hoistRuntimeCall(Function &F, RuntimeFunctionInfo &RFI, Use &U) {
+    CallInst *CI = getCallIfRegularCall(U, &RFI);
+    if (!CI || CI->getCaller() != &F || !canBeHoisted(*CI))
+      return false;
+
+    BasicBlock *BB = CI->getParent();
+    if (BB == &F.getEntryBlock())
+      return false;
+
+    // A block is in a loop if it is part of a cyclic SCC of the CFG.
+    bool InCycle = false;
+    for (scc_iterator<Function *> It = scc_begin(&F); !It.isAtEnd(); ++It)
+      if (is_contained(*It, BB)) {
+        InCycle = It.hasLoop();
+        break;
+      }
+    if (!InCycle)
+      return false;
+
+    LLVM_DEBUG(dbgs() << TAG << "Hoist " << RFI.Name << " out of a loop in "
+                      << F.getName() << "\n");
+    CI->moveBefore(&*F.getEntryBlock().getFirstInsertionPt());
+    ++NumOpenMPRuntimeCallsHoisted;
+    return true;
+  }
+
   /// Collect arguments that represent the global thread id in \p GTIdArgs.
   void collectGlobalThreadIdArguments(SmallSetVector<Value *, 16> &GTIdArgs) {
     // TODO: Below we basically perform a fixpoint iteration with a pessimistic
@@ -103,6 +103,10 @@ static cl::opt<bool>
 cl::opt<bool> EnableHotColdSplit("hot-cold-split", cl::init(false), cl::Hidden,
     cl::desc("Enable hot-cold splitting pass"));
 
+cl::opt<bool> EnableMultiVersioning(
+    "enable-multiversioning", cl::init(false), cl::Hidden,
+    cl::desc("Enable multiversioning of functions with hot loops"));
+
 static cl::opt<bool> UseLoopVersioningLICM(
     "enable-loop-versioning-licm", cl::init(false), cl::Hidden,
     cl::desc("Enable the experimental Loop Versioning LICM pass"));
@@ -687,6 +691,12 @@ void PassManagerBuilder::populateModulePassManager(
     MPM.add(createLICMPass(LicmMssaOptCap, LicmMssaNoAccForPromotionCap));
   }
 
+  // Clone functions with hot loops for newer ISA levels, so that the
+  // vectorizers below can optimize each clone for its extensions. Leave this
+  // to the post-link pipeline when preparing for (Thin)LTO.
+  if (EnableMultiVersioning && !(PrepareForLTO || PrepareForThinLTO))
+    MPM.add(createFunctionMultiVersioningPass());
+
   // We add a fresh GlobalsModRef run at this point. This is particularly
   // useful as the above will have inlined, DCE'ed, and function-attr
   // propagated everything. We should at this point have a reasonably minimal
@@ -985,6 +995,12 @@ void PassManagerBuilder::addLTOOptimizationPasses(legacy::PassManagerBase &PM) {
   // Nuke dead stores.
   PM.add(createDeadStoreEliminationPass());
 
+  // Clone functions with hot loops for newer ISA levels now that the whole
+  // program has been inlined, so that the vectorizer below can optimize each
+  // clone for its extensions.
+  if (EnableMultiVersioning)
+    PM.add(createFunctionMultiVersioningPass());
+
   // More loops are countable; try to optimize them.
   PM.add(createIndVarSimplifyPass());
   PM.add(createLoopDeletionPass());
@@ -350,6 +350,11 @@ static cl::opt<bool> ClOptStack(
     "asan-opt-stack", cl::desc("Don't instrument scalar stack variables"),
     cl::Hidden, cl::init(false));
 
+static cl::opt<bool> ClOptCoalesce(
+    "asan-opt-coalesce",
+    cl::desc("Check pairs of adjacent accesses in a block with one check"),
+    cl::Hidden, cl::init(false));
+
 static cl::opt<bool> ClDynamicAllocaStack(
     "asan-stack-dynamic-alloca",
     cl::desc("Use dynamic alloca to represent stack variables"), cl::Hidden,
@@ -406,6 +411,8 @@ STATISTIC(NumOptimizedAccessesToGlobalVar,
           "Number of optimized accesses to global vars");
 STATISTIC(NumOptimizedAccessesToStackVar,
           "Number of optimized accesses to stack vars");
+STATISTIC(NumCoalescedAccesses,
+          "Number of accesses checked together with an adjacent access");
 
 namespace {
 
@@ -622,7 +629,8 @@ struct AddressSanitizer {
                                    Value **MaybeMask = nullptr);
 
   void instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis, Instruction *I,
-                     bool UseCalls, const DataLayout &DL);
+                     bool UseCalls, const DataLayout &DL,
+                     Instruction *CoalescedWith = nullptr);
   void instrumentPointerComparisonOrSubtraction(Instruction *I);
   void instrumentAddress(Instruction *OrigIns, Instruction *InsertBefore,
                          Value *Addr, uint32_t TypeSize, bool IsWrite,
@@ -1547,7 +1555,8 @@ static void instrumentMaskedLoadOrStore(AddressSanitizer *Pass,
 
 void AddressSanitizer::instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis,
                                      Instruction *I, bool UseCalls,
-                                     const DataLayout &DL) {
+                                     const DataLayout &DL,
+                                     Instruction *CoalescedWith) {
   bool IsWrite = false;
   unsigned Alignment = 0;
   uint64_t TypeSize = 0;
@@ -1556,6 +1565,20 @@ void AddressSanitizer::instrumentMop(ObjectSizeOffsetVisitor &ObjSizeVis,
       isInterestingMemoryAccess(I, &IsWrite, &TypeSize, &Alignment, &MaybeMask);
   assert(Addr);
 
+  // An access of the same size that immediately follows this one in memory is
+  // checked together with it, as one access of twice the size.
+  if (CoalescedWith) {
+    bool OtherIsWrite = false;
+    unsigned OtherAlignment = 0;
+    uint64_t OtherTypeSize = 0;
+    isInterestingMemoryAccess(CoalescedWith, &OtherIsWrite, &OtherTypeSize,
+                              &OtherAlignment);
+    assert(OtherTypeSize == TypeSize && "coalesced accesses differ in size");
+    TypeSize *= 2;
+    IsWrite |= OtherIsWrite;
+    NumCoalescedAccesses++;
+  }
+
   // Optimization experiments.
   // The experiments can be used to evaluate potential optimizations that remove
   // instrumentation (assess false negatives). Instead of completely removing
@@ -2643,6 +2666,14 @@ bool AddressSanitizer::instrumentFunction(Function &F,
   // We want to instrument every address only once per basic block (unless there
   // are calls between uses).
   SmallPtrSet<Value *, 16> TempsToInstrument;
+  // With -asan-opt-coalesce, accesses that may still be checked together with
+  // a later access, keyed by their base pointer and the offset they end at.
+  // Like TempsToInstrument, this is reset at calls, which may change the
+  // shadow.
+  SmallDenseMap<std::pair<Value *, int64_t>, Instruction *, 16>
+      CoalesceCandidates;
+  // Accesses that are checked together with a later adjacent access.
+  DenseMap<Instruction *, Instruction *> CoalescedWith;
   SmallVector<Instruction *, 16> ToInstrument;
   SmallVector<Instruction *, 8> NoReturnCalls;
   SmallVector<BasicBlock *, 16> AllBlocks;
@@ -2653,9 +2684,12 @@ bool AddressSanitizer::instrumentFunction(Function &F,
   uint64_t TypeSize;
 
   // Fill the set of memory operations to instrument.
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  unsigned Granularity = 1 << Mapping.Scale;
   for (auto &BB : F) {
     AllBlocks.push_back(&BB);
     TempsToInstrument.clear();
+    CoalesceCandidates.clear();
     int NumInsnsPerBB = 0;
     for (auto &Inst : BB) {
       if (LooksLikeCodeInBug11395(&Inst)) return false;
@@ -2674,6 +2708,34 @@ bool AddressSanitizer::instrumentFunction(Function &F,
               continue; // We've seen this temp in the current BB.
           }
         }
+        // A plain load or store of 1 to 8 bytes that ends where an earlier
+        // access of the same size in this block starts is checked with the
+        // earlier one. The earlier access must be aligned to the combined
+        // size, or to the shadow granularity, so that the combined check is
+        // a single, exact shadow check. No call separates the two, so the
+        // second access runs whenever the first does.
+        if (ClOpt && ClOptCoalesce && !MaybeMask &&
+            (isa<LoadInst>(Inst) || isa<StoreInst>(Inst)) &&
+            (TypeSize == 8 || TypeSize == 16 || TypeSize == 32 ||
+             TypeSize == 64)) {
+          int64_t Offset = 0;
+          Value *Base = GetPointerBaseWithConstantOffset(Addr, Offset, DL);
+          auto It = CoalesceCandidates.find({Base, Offset});
+          if (It != CoalesceCandidates.end()) {
+            bool OtherIsWrite;
+            unsigned OtherAlignment;
+            uint64_t OtherTypeSize;
+            isInterestingMemoryAccess(It->second, &OtherIsWrite,
+                                      &OtherTypeSize, &OtherAlignment);
+            if (OtherTypeSize == TypeSize) {
+              CoalescedWith[It->second] = &Inst;
+              CoalesceCandidates.erase(It);
+              continue;
+            }
+          }
+          if (Alignment >= Granularity || Alignment >= TypeSize / 4)
+            CoalesceCandidates[{Base, Offset + (int64_t)TypeSize / 8}] = &Inst;
+        }
       } else if (((ClInvalidPointerPairs || ClInvalidPointerCmp) &&
                   isInterestingPointerComparison(&Inst)) ||
                  ((ClInvalidPointerPairs || ClInvalidPointerSub) &&
@@ -2688,6 +2750,7 @@ bool AddressSanitizer::instrumentFunction(Function &F,
         if (CS) {
           // A call inside BB.
           TempsToInstrument.clear();
+          CoalesceCandidates.clear();
           if (CS.doesNotReturn() && !CS->hasMetadata("nosanitize"))
             NoReturnCalls.push_back(CS.getInstruction());
         }
@@ -2704,7 +2767,6 @@ bool AddressSanitizer::instrumentFunction(Function &F,
   bool UseCalls =
       (ClInstrumentationWithCallsThreshold >= 0 &&
        ToInstrument.size() > (unsigned)ClInstrumentationWithCallsThreshold);
-  const DataLayout &DL = F.getParent()->getDataLayout();
   ObjectSizeOpts ObjSizeOpts;
   ObjSizeOpts.RoundToAlign = true;
   ObjectSizeOffsetVisitor ObjSizeVis(DL, TLI, F.getContext(), ObjSizeOpts);
@@ -2715,8 +2777,8 @@ bool AddressSanitizer::instrumentFunction(Function &F,
     if (ClDebugMin < 0 || ClDebugMax < 0 ||
         (NumInstrumented >= ClDebugMin && NumInstrumented <= ClDebugMax)) {
       if (isInterestingMemoryAccess(Inst, &IsWrite, &TypeSize, &Alignment))
-        instrumentMop(ObjSizeVis, Inst, UseCalls,
-                      F.getParent()->getDataLayout());
+        instrumentMop(ObjSizeVis, Inst, UseCalls, DL,
+                      CoalescedWith.lookup(Inst));
       else
         instrumentMemIntrinsic(cast<MemIntrinsic>(Inst));
     }
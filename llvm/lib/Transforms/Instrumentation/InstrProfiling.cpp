@@ -108,6 +108,13 @@ cl::opt<bool> AtomicCounterUpdateAll(
     cl::desc("Make all profile counter updates atomic (for testing only)"),
     cl::init(false));
 
+cl::opt<unsigned> CounterAlignment(
+    "instrprof-counter-alignment", cl::ZeroOrMore,
+    cl::desc("Align the counters of each function to this many bytes, e.g. "
+             "the cache line size, so that threads updating the counters of "
+             "different functions do not share cache lines"),
+    cl::init(8));
+
 cl::opt<bool> AtomicCounterUpdatePromoted(
     "atomic-counter-update-promoted", cl::ZeroOrMore,
     cl::desc("Do counter update using atomic fetch add "
@@ -843,7 +850,8 @@ InstrProfiling::getOrCreateRegionCounters(InstrProfIncrementInst *Inc) {
   CounterPtr->setVisibility(Visibility);
   CounterPtr->setSection(
       getInstrProfSectionName(IPSK_cnts, TT.getObjectFormat()));
-  CounterPtr->setAlignment(Align(8));
+  CounterPtr->setAlignment(
+      Align(PowerOf2Ceil(std::max(CounterAlignment.getValue(), 8U))));
   MaybeSetComdat(CounterPtr);
   CounterPtr->setLinkage(Linkage);
 
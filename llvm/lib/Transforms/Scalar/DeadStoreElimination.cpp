@@ -1455,6 +1455,9 @@ struct DSEState {
   // Keep track of all of the objects that are invisible to the caller until the
   // function returns.
   SmallPtrSet<const Value *, 16> InvisibleToCaller;
+  // Keep track of all of the objects that are invisible to the caller after
+  // the function returns.
+  SmallPtrSet<const Value *, 16> InvisibleToCallerAfterRet;
   // Keep track of blocks with throwing instructions not modeled in MemorySSA.
   SmallPtrSet<BasicBlock *, 16> ThrowingBlocks;
 
@@ -1481,15 +1484,24 @@ struct DSEState {
       // visible to the caller during function execution. Alloca objects are
       // invalid in the caller, for alloca-like objects we ensure that they are
       // not captured throughout the function.
-      if (isa<AllocaInst>(&I) ||
-          (isAllocLikeFn(&I, &TLI) && !PointerMayBeCaptured(&I, false, true)))
+      if (isa<AllocaInst>(&I)) {
         State.InvisibleToCaller.insert(&I);
+        State.InvisibleToCallerAfterRet.insert(&I);
+      } else if (isAllocLikeFn(&I, &TLI) &&
+                 !PointerMayBeCaptured(&I, false, true)) {
+        State.InvisibleToCaller.insert(&I);
+        // Returning the object makes it visible after the function returns.
+        if (!PointerMayBeCaptured(&I, true, false))
+          State.InvisibleToCallerAfterRet.insert(&I);
+      }
     }
     // Treat byval or inalloca arguments the same as Allocas, stores to them are
     // dead at the end of the function.
     for (Argument &AI : F.args())
-      if (AI.hasByValOrInAllocaAttr())
+      if (AI.hasByValOrInAllocaAttr()) {
         State.InvisibleToCaller.insert(&AI);
+        State.InvisibleToCallerAfterRet.insert(&AI);
+      }
     return State;
   }
 
@@ -1699,6 +1711,67 @@ struct DSEState {
     }
   }
 
+  /// Returns true if the memory written by \p Def is not read before the
+  /// function returns. Reads reached through a MemoryPhi are not followed, so
+  /// the walk gives up when it meets one.
+  bool isWriteAtEndOfFunction(MemoryDef *Def) const {
+    Optional<MemoryLocation> DefLoc = getLocForWriteEx(Def->getMemoryInst());
+    if (!DefLoc)
+      return false;
+
+    SmallSetVector<MemoryAccess *, 32> WorkList;
+    auto PushMemUses = [&WorkList](MemoryAccess *Acc) {
+      for (Use &U : Acc->uses())
+        WorkList.insert(cast<MemoryAccess>(U.getUser()));
+    };
+    PushMemUses(Def);
+
+    for (unsigned I = 0; I < WorkList.size(); I++) {
+      if (WorkList.size() >= MemorySSAScanLimit)
+        return false;
+      MemoryAccess *UseAccess = WorkList[I];
+      // A read in a later iteration of a loop would be missed by only looking
+      // at the users of a MemoryPhi.
+      if (isa<MemoryPhi>(UseAccess))
+        return false;
+      Instruction *UseInst = cast<MemoryUseOrDef>(UseAccess)->getMemoryInst();
+      if (isReadClobber(*DefLoc, UseInst))
+        return false;
+      if (MemoryDef *UseDef = dyn_cast<MemoryDef>(UseAccess))
+        PushMemUses(UseDef);
+    }
+    return true;
+  }
+
+  /// Delete writes to objects that are invisible to the caller after the
+  /// function returns and that are never read before it returns, in any
+  /// block.
+  bool eliminateDeadWritesAtEndOfFunction() {
+    const DataLayout &DL = F.getParent()->getDataLayout();
+    bool MadeChange = false;
+    for (int I = MemDefs.size() - 1; I >= 0; I--) {
+      MemoryDef *Def = MemDefs[I];
+      if (SkipStores.count(Def))
+        continue;
+      Instruction *DefI = Def->getMemoryInst();
+      Optional<MemoryLocation> DefLoc = getLocForWriteEx(DefI);
+      if (!DefLoc)
+        continue;
+      const Value *UO = GetUnderlyingObject(DefLoc->Ptr, DL);
+      if (!UO || !InvisibleToCallerAfterRet.count(UO))
+        continue;
+      if (isWriteAtEndOfFunction(Def)) {
+        LLVM_DEBUG(dbgs() << "DSE: Remove Dead Store at end of function:\n  "
+                             "DEAD: "
+                          << *DefI << '\n');
+        deleteDeadInstruction(DefI);
+        ++NumFastStores;
+        MadeChange = true;
+      }
+    }
+    return MadeChange;
+  }
+
   // Check for any extra throws between SI and NI that block DSE.  This only
   // checks extra maythrows (those that aren't MemoryDef's). MemoryDef that may
   // throw are handled during the walk from one def to the next.
@@ -1819,6 +1892,7 @@ bool eliminateDeadStoresMemorySSA(Function &F, AliasAnalysis &AA,
     }
   }
 
+  MadeChange |= State.eliminateDeadWritesAtEndOfFunction();
   return MadeChange;
 }
 } // end anonymous namespace
@@ -17,11 +17,13 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopCacheAnalysis.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/LoopPass.h"
 #include "llvm/Analysis/OptimizationRemarkEmitter.h"
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DiagnosticInfo.h"
@@ -58,6 +60,11 @@ static cl::opt<int> LoopInterchangeCostThreshold(
     "loop-interchange-threshold", cl::init(0), cl::Hidden,
     cl::desc("Interchange if you gain more than this number"));
 
+static cl::opt<bool> UseCacheCostModel(
+    "loop-interchange-cache-cost", cl::init(true), cl::Hidden,
+    cl::desc("Use the loop cache analysis to decide whether interchanging "
+             "loops improves locality"));
+
 namespace {
 
 using LoopVector = SmallVector<Loop *, 8>;
@@ -373,8 +380,9 @@ private:
 class LoopInterchangeProfitability {
 public:
   LoopInterchangeProfitability(Loop *Outer, Loop *Inner, ScalarEvolution *SE,
-                               OptimizationRemarkEmitter *ORE)
-      : OuterLoop(Outer), InnerLoop(Inner), SE(SE), ORE(ORE) {}
+                               OptimizationRemarkEmitter *ORE,
+                               const CacheCost *CC)
+      : OuterLoop(Outer), InnerLoop(Inner), SE(SE), ORE(ORE), CC(CC) {}
 
   /// Check if the loop interchange is profitable.
   bool isProfitable(unsigned InnerLoopId, unsigned OuterLoopId,
@@ -383,6 +391,10 @@ public:
 private:
   int getInstrOrderCost();
 
+  /// Return whether the cache cost model says that interchanging the loops
+  /// improves locality, or None if it cannot tell the loops apart.
+  Optional<bool> isProfitableForCacheCost();
+
   Loop *OuterLoop;
   Loop *InnerLoop;
 
@@ -391,6 +403,9 @@ private:
 
   /// Interface to emit optimization remarks.
   OptimizationRemarkEmitter *ORE;
+
+  /// Cache costs of the loops in the nest, if they could be computed.
+  const CacheCost *CC;
 };
 
 /// LoopInterchangeTransform interchanges the loop.
@@ -435,6 +450,8 @@ struct LoopInterchange : public LoopPass {
   LoopInfo *LI = nullptr;
   DependenceInfo *DI = nullptr;
   DominatorTree *DT = nullptr;
+  TargetTransformInfo *TTI = nullptr;
+  AAResults *AA = nullptr;
 
   /// Interface to emit optimization remarks.
   OptimizationRemarkEmitter *ORE;
@@ -446,6 +463,7 @@ struct LoopInterchange : public LoopPass {
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<DependenceAnalysisWrapperPass>();
     AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addRequired<TargetTransformInfoWrapperPass>();
 
     getLoopAnalysisUsage(AU);
   }
@@ -459,6 +477,9 @@ struct LoopInterchange : public LoopPass {
     DI = &getAnalysis<DependenceAnalysisWrapperPass>().getDI();
     DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
     ORE = &getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
+    TTI = &getAnalysis<TargetTransformInfoWrapperPass>().getTTI(
+        *L->getHeader()->getParent());
+    AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
 
     return processLoopList(populateWorklist(*L));
   }
@@ -527,11 +548,17 @@ struct LoopInterchange : public LoopPass {
       return false;
     }
 
+    // The cache cost of a loop is its cost as the innermost loop of the nest,
+    // so it stays valid while the loops are interchanged.
+    std::unique_ptr<CacheCost> CC;
+    if (UseCacheCostModel)
+      CC = std::make_unique<CacheCost>(LoopList, *LI, *SE, *TTI, *AA, *DI);
+
     unsigned SelecLoopId = selectLoopForInterchange(LoopList);
     // Move the selected loop outwards to the best possible position.
     for (unsigned i = SelecLoopId; i > 0; i--) {
-      bool Interchanged =
-          processLoop(LoopList, i, i - 1, LoopNestExit, DependencyMatrix);
+      bool Interchanged = processLoop(LoopList, i, i - 1, LoopNestExit,
+                                      DependencyMatrix, CC.get());
       if (!Interchanged)
         return Changed;
       // Loops interchanged reflect the same in LoopList
@@ -550,7 +577,8 @@ struct LoopInterchange : public LoopPass {
 
   bool processLoop(LoopVector LoopList, unsigned InnerLoopId,
                    unsigned OuterLoopId, BasicBlock *LoopNestExit,
-                   std::vector<std::vector<char>> &DependencyMatrix) {
+                   std::vector<std::vector<char>> &DependencyMatrix,
+                   const CacheCost *CC) {
     LLVM_DEBUG(dbgs() << "Processing Inner Loop Id = " << InnerLoopId
                       << " and OuterLoopId = " << OuterLoopId << "\n");
     Loop *InnerLoop = LoopList[InnerLoopId];
@@ -562,7 +590,7 @@ struct LoopInterchange : public LoopPass {
       return false;
     }
     LLVM_DEBUG(dbgs() << "Loops are legal to interchange\n");
-    LoopInterchangeProfitability LIP(OuterLoop, InnerLoop, SE, ORE);
+    LoopInterchangeProfitability LIP(OuterLoop, InnerLoop, SE, ORE, CC);
     if (!LIP.isProfitable(InnerLoopId, OuterLoopId, DependencyMatrix)) {
       LLVM_DEBUG(dbgs() << "Interchanging loops not profitable.\n");
       return false;
@@ -1099,6 +1127,23 @@ static bool isProfitableForVectorization(unsigned InnerLoopId,
   return !DepMatrix.empty();
 }
 
+Optional<bool> LoopInterchangeProfitability::isProfitableForCacheCost() {
+  if (!CC)
+    return None;
+
+  // The cost of a loop is the number of cache lines the nest touches when
+  // the loop is innermost, so the loop with the higher cost should be
+  // outside.
+  CacheCostTy InnerCost = CC->getLoopCost(*InnerLoop);
+  CacheCostTy OuterCost = CC->getLoopCost(*OuterLoop);
+  LLVM_DEBUG(dbgs() << "Cache cost: inner loop = " << InnerCost
+                    << ", outer loop = " << OuterCost << "\n");
+  if (InnerCost == CacheCost::InvalidCost ||
+      OuterCost == CacheCost::InvalidCost || InnerCost == OuterCost)
+    return None;
+  return InnerCost > OuterCost;
+}
+
 bool LoopInterchangeProfitability::isProfitable(unsigned InnerLoopId,
                                                 unsigned OuterLoopId,
                                                 CharMatrix &DepMatrix) {
@@ -1107,19 +1152,43 @@ bool LoopInterchangeProfitability::isProfitable(unsigned InnerLoopId,
   // 1) Construct dependency matrix and move the one with no loop carried dep
   //    inside to enable vectorization.
 
-  // This is rough cost estimation algorithm. It counts the good and bad order
-  // of induction variables in the instruction and allows reordering if number
-  // of bad orders is more than good.
-  int Cost = getInstrOrderCost();
-  LLVM_DEBUG(dbgs() << "Cost = " << Cost << "\n");
-  if (Cost < -LoopInterchangeCostThreshold)
+  // Prefer the cache cost model. It understands strides and delinearized
+  // accesses, but cannot always compare the loops.
+  Optional<bool> ImprovesLocality = isProfitableForCacheCost();
+  if (ImprovesLocality && *ImprovesLocality)
     return true;
 
+  // Otherwise use a rough cost estimation algorithm. It counts the good and
+  // bad order of induction variables in the instruction and allows reordering
+  // if number of bad orders is more than good.
+  int Cost = 0;
+  if (!ImprovesLocality) {
+    Cost = getInstrOrderCost();
+    LLVM_DEBUG(dbgs() << "Cost = " << Cost << "\n");
+    if (Cost < -LoopInterchangeCostThreshold)
+      return true;
+  }
+
   // It is not profitable as per current cache profitability model. But check if
   // we can move this loop outside to improve parallelism.
   if (isProfitableForVectorization(InnerLoopId, OuterLoopId, DepMatrix))
     return true;
 
+  if (ImprovesLocality) {
+    ORE->emit([&]() {
+      return OptimizationRemarkMissed(DEBUG_TYPE, "InterchangeNotProfitable",
+                                      InnerLoop->getStartLoc(),
+                                      InnerLoop->getHeader())
+             << "Interchanging loops does not improve cache locality "
+                "(inner loop cache cost="
+             << ore::NV("InnerCacheCost", CC->getLoopCost(*InnerLoop))
+             << ", outer loop cache cost="
+             << ore::NV("OuterCacheCost", CC->getLoopCost(*OuterLoop))
+             << ") and it does not improve parallelism.";
+    });
+    return false;
+  }
+
   ORE->emit([&]() {
     return OptimizationRemarkMissed(DEBUG_TYPE, "InterchangeNotProfitable",
                                     InnerLoop->getStartLoc(),
@@ -1612,6 +1681,7 @@ INITIALIZE_PASS_BEGIN(LoopInterchange, "loop-interchange",
 INITIALIZE_PASS_DEPENDENCY(LoopPass)
 INITIALIZE_PASS_DEPENDENCY(DependenceAnalysisWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
 
 INITIALIZE_PASS_END(LoopInterchange, "loop-interchange",
                     "Interchanges loops for cache reuse", false, false)
@@ -64,6 +64,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Analysis/IVUsers.h"
 #include "llvm/Analysis/LoopAnalysisManager.h"
@@ -71,6 +72,7 @@
 #include "llvm/Analysis/LoopPass.h"
 #include "llvm/Analysis/MemorySSA.h"
 #include "llvm/Analysis/MemorySSAUpdater.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Analysis/ScalarEvolutionExpander.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
@@ -126,6 +128,9 @@ using namespace llvm;
 
 #define DEBUG_TYPE "loop-reduce"
 
+STATISTIC(NumSolverBudgetExhausted,
+          "Number of loops where the LSR solver ran out of budget");
+
 /// MaxIVUsers is an arbitrary threshold that provides an early opportunity for
 /// bail out. This threshold is far beyond the number of users that LSR can
 /// conceivably solve, so it should not affect generated code, but catches the
@@ -167,6 +172,11 @@ static cl::opt<unsigned> ComplexityLimit(
   cl::init(std::numeric_limits<uint16_t>::max()),
   cl::desc("LSR search space complexity limit"));
 
+static cl::opt<unsigned> SolverBudget(
+    "lsr-solver-budget", cl::Hidden, cl::init(250000),
+    cl::desc("Number of formulae the LSR solver rates before it stops "
+             "exploring alternatives and completes the solution greedily"));
+
 static cl::opt<unsigned> SetupCostDepthLimit(
     "lsr-setupcost-depth-limit", cl::Hidden, cl::init(7),
     cl::desc("The limit on recursion depth for LSRs setup cost"));
@@ -1014,6 +1024,8 @@ public:
 
   void Lose();
 
+  const TargetTransformInfo::LSRCost &getLSRCost() const { return C; }
+
 #ifndef NDEBUG
   // Once any of the metrics loses, they must all remain losers.
   bool isValid() {
@@ -1892,6 +1904,7 @@ class LSRInstance {
   const TargetTransformInfo &TTI;
   Loop *const L;
   MemorySSAUpdater *MSSAU;
+  OptimizationRemarkEmitter &ORE;
   bool FavorBackedgeIndex = false;
   bool Changed = false;
 
@@ -2003,7 +2016,8 @@ class LSRInstance {
                     SmallVectorImpl<const Formula *> &Workspace,
                     const Cost &CurCost,
                     const SmallPtrSet<const SCEV *, 16> &CurRegs,
-                    DenseSet<const SCEV *> &VisitedRegs) const;
+                    DenseSet<const SCEV *> &VisitedRegs,
+                    unsigned &Budget) const;
   void Solve(SmallVectorImpl<const Formula *> &Solution) const;
 
   BasicBlock::iterator
@@ -2029,7 +2043,8 @@ class LSRInstance {
 public:
   LSRInstance(Loop *L, IVUsers &IU, ScalarEvolution &SE, DominatorTree &DT,
               LoopInfo &LI, const TargetTransformInfo &TTI, AssumptionCache &AC,
-              TargetLibraryInfo &TLI, MemorySSAUpdater *MSSAU);
+              TargetLibraryInfo &TLI, MemorySSAUpdater *MSSAU,
+              OptimizationRemarkEmitter &ORE);
 
   bool getChanged() const { return Changed; }
 
@@ -4872,7 +4887,8 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
                                SmallVectorImpl<const Formula *> &Workspace,
                                const Cost &CurCost,
                                const SmallPtrSet<const SCEV *, 16> &CurRegs,
-                               DenseSet<const SCEV *> &VisitedRegs) const {
+                               DenseSet<const SCEV *> &VisitedRegs,
+                               unsigned &Budget) const {
   // Some ideas:
   //  - prune more:
   //    - use more aggressive filtering
@@ -4894,12 +4910,10 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
     if (LU.Regs.count(S))
       ReqRegs.insert(S);
 
-  SmallPtrSet<const SCEV *, 16> NewRegs;
-  Cost NewCost(L, SE, TTI);
-  for (const Formula &F : LU.Formulae) {
-    // Ignore formulae which may not be ideal in terms of register reuse of
-    // ReqRegs.  The formula should use all required registers before
-    // introducing new ones.
+  // Ignore formulae which may not be ideal in terms of register reuse of
+  // ReqRegs.  The formula should use all required registers before
+  // introducing new ones.
+  auto UsesReqRegs = [&](const Formula &F) {
     int NumReqRegsToFind = std::min(F.getNumRegs(), ReqRegs.size());
     for (const SCEV *Reg : ReqRegs) {
       if ((F.ScaledReg && F.ScaledReg == Reg) ||
@@ -4909,14 +4923,60 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
           break;
       }
     }
-    if (NumReqRegsToFind != 0) {
-      // If none of the formulae satisfied the required registers, then we could
-      // clear ReqRegs and try again. Currently, we simply give up in this case.
-      continue;
+    // If none of the formulae satisfied the required registers, then we could
+    // clear ReqRegs and try again. Currently, we simply give up in this case.
+    return NumReqRegsToFind == 0;
+  };
+
+  SmallPtrSet<const SCEV *, 16> NewRegs;
+  Cost NewCost(L, SE, TTI);
+
+  // Once the budget is spent, stop branching: extend the partial solution
+  // with the cheapest formula for this use and move on to the next one.
+  if (Budget == 0) {
+    const Formula *Best = nullptr;
+    Cost BestCost(L, SE, TTI);
+    BestCost.Lose();
+    SmallPtrSet<const SCEV *, 16> BestRegs;
+    for (const Formula &F : LU.Formulae) {
+      if (!UsesReqRegs(F))
+        continue;
+      NewCost = CurCost;
+      NewRegs = CurRegs;
+      NewCost.RateFormula(F, NewRegs, VisitedRegs, LU);
+      if (NewCost.isLess(BestCost)) {
+        Best = &F;
+        BestCost = NewCost;
+        BestRegs = NewRegs;
+      }
+    }
+    if (!Best || !BestCost.isLess(SolutionCost))
+      return;
+    Workspace.push_back(Best);
+    if (Workspace.size() != Uses.size()) {
+      SolveRecurse(Solution, SolutionCost, Workspace, BestCost, BestRegs,
+                   VisitedRegs, Budget);
+    } else {
+      SolutionCost = BestCost;
+      Solution = Workspace;
     }
+    Workspace.pop_back();
+    return;
+  }
+
+  for (const Formula &F : LU.Formulae) {
+    // Out of budget: keep the best complete solution found so far. Without
+    // one, keep trying the alternatives here, completing each greedily.
+    if (Budget == 0 && !Solution.empty())
+      return;
+
+    if (!UsesReqRegs(F))
+      continue;
 
     // Evaluate the cost of the current formula. If it's already worse than
     // the current best, prune the search at that point.
+    if (Budget != 0)
+      --Budget;
     NewCost = CurCost;
     NewRegs = CurRegs;
     NewCost.RateFormula(F, NewRegs, VisitedRegs, LU);
@@ -4924,7 +4984,7 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
       Workspace.push_back(&F);
       if (Workspace.size() != Uses.size()) {
         SolveRecurse(Solution, SolutionCost, Workspace, NewCost,
-                     NewRegs, VisitedRegs);
+                     NewRegs, VisitedRegs, Budget);
         if (F.getNumRegs() == 1 && Workspace.size() == 1)
           VisitedRegs.insert(F.ScaledReg ? F.ScaledReg : F.BaseRegs[0]);
       } else {
@@ -4952,15 +5012,38 @@ void LSRInstance::Solve(SmallVectorImpl<const Formula *> &Solution) const {
   SmallPtrSet<const SCEV *, 16> CurRegs;
   DenseSet<const SCEV *> VisitedRegs;
   Workspace.reserve(Uses.size());
+  unsigned Budget = SolverBudget;
 
   // SolveRecurse does all the work.
   SolveRecurse(Solution, SolutionCost, Workspace, CurCost,
-               CurRegs, VisitedRegs);
+               CurRegs, VisitedRegs, Budget);
+  if (Budget == 0) {
+    ++NumSolverBudgetExhausted;
+    LLVM_DEBUG(dbgs() << "\nSolver budget exhausted\n");
+    ORE.emit([&]() {
+      return OptimizationRemarkAnalysis(DEBUG_TYPE, "SolverBudgetExhausted",
+                                        L->getStartLoc(), L->getHeader())
+             << "stopped searching for induction variable formulae after "
+                "rating "
+             << ore::NV("Budget", SolverBudget.getValue()) << " of them";
+    });
+  }
   if (Solution.empty()) {
     LLVM_DEBUG(dbgs() << "\nNo Satisfactory Solution\n");
     return;
   }
 
+  ORE.emit([&]() {
+    const TargetTransformInfo::LSRCost &C = SolutionCost.getLSRCost();
+    return OptimizationRemarkAnalysis(DEBUG_TYPE, "Solution", L->getStartLoc(),
+                                      L->getHeader())
+           << "chose formulae for " << ore::NV("NumUses", Uses.size())
+           << " induction variable uses requiring "
+           << ore::NV("NumRegs", C.NumRegs) << " registers, "
+           << ore::NV("NumIVMuls", C.NumIVMuls) << " multiplies and "
+           << ore::NV("NumBaseAdds", C.NumBaseAdds) << " base adds";
+  });
+
   // Ok, we've now made all our decisions.
   LLVM_DEBUG(dbgs() << "\n"
                        "The chosen solution requires ";
@@ -5476,10 +5559,12 @@ void LSRInstance::ImplementSolution(
 LSRInstance::LSRInstance(Loop *L, IVUsers &IU, ScalarEvolution &SE,
                          DominatorTree &DT, LoopInfo &LI,
                          const TargetTransformInfo &TTI, AssumptionCache &AC,
-                         TargetLibraryInfo &TLI, MemorySSAUpdater *MSSAU)
+                         TargetLibraryInfo &TLI, MemorySSAUpdater *MSSAU,
+                         OptimizationRemarkEmitter &ORE)
     : IU(IU), SE(SE), DT(DT), LI(LI), AC(AC), TLI(TLI), TTI(TTI), L(L),
-      MSSAU(MSSAU), FavorBackedgeIndex(EnableBackedgeIndexing &&
-                                       TTI.shouldFavorBackedgeIndex(L)) {
+      MSSAU(MSSAU), ORE(ORE),
+      FavorBackedgeIndex(EnableBackedgeIndexing &&
+                         TTI.shouldFavorBackedgeIndex(L)) {
   // If LoopSimplify form is not available, stay out of trouble.
   if (!L->isLoopSimplifyForm())
     return;
@@ -5697,8 +5782,9 @@ static bool ReduceLoopStrength(Loop *L, IVUsers &IU, ScalarEvolution &SE,
     MSSAU = std::make_unique<MemorySSAUpdater>(MSSA);
 
   // Run the main LSR transformation.
-  Changed |=
-      LSRInstance(L, IU, SE, DT, LI, TTI, AC, TLI, MSSAU.get()).getChanged();
+  OptimizationRemarkEmitter ORE(L->getHeader()->getParent());
+  Changed |= LSRInstance(L, IU, SE, DT, LI, TTI, AC, TLI, MSSAU.get(), ORE)
+                 .getChanged();
 
   // Remove any extra phis created by processing inner loops.
   Changed |= DeleteDeadPHIs(L->getHeader(), &TLI, MSSAU.get());
@@ -19,6 +19,7 @@
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/OptimizationRemarkEmitter.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
@@ -45,6 +46,21 @@ static cl::opt<bool> EnableShapePropagation(
     cl::desc("Enable/disable shape propagation from matrix intrinsics to other "
              "instructions."));
 
+static cl::opt<bool> FuseMatrix(
+    "fuse-matrix", cl::init(true), cl::Hidden,
+    cl::desc("Enable/disable tiling of matrix multiplies whose operands are "
+             "loaded from and whose result is stored to memory."));
+
+static cl::opt<unsigned> TileSize(
+    "fuse-matrix-tile-size", cl::init(4), cl::Hidden,
+    cl::desc("Number of rows and columns of the tiles used when tiling matrix "
+             "multiplies."));
+
+static cl::opt<bool> ForceFusion(
+    "force-fuse-matrix", cl::init(false), cl::Hidden,
+    cl::desc("Tile matrix multiplies even if the operands fit in vector "
+             "registers."));
+
 static cl::opt<bool> AllowContractEnabled(
     "matrix-allow-contract", cl::init(false), cl::Hidden,
     cl::desc("Allow the use of FMAs if available and profitable. This may "
@@ -139,6 +155,7 @@ class LowerMatrixIntrinsics {
   Function &Func;
   const DataLayout &DL;
   const TargetTransformInfo &TTI;
+  AAResults *AA;
   OptimizationRemarkEmitter &ORE;
 
   /// Contains estimates of the number of operations (loads, stores, compute) required to lower a matrix operation.
@@ -266,9 +283,10 @@ class LowerMatrixIntrinsics {
   MapVector<Value *, ColumnMatrixTy> Inst2ColumnMatrix;
 
 public:
-  LowerMatrixIntrinsics(Function &F, TargetTransformInfo &TTI,
+  LowerMatrixIntrinsics(Function &F, TargetTransformInfo &TTI, AAResults *AA,
                         OptimizationRemarkEmitter &ORE)
-      : Func(F), DL(F.getParent()->getDataLayout()), TTI(TTI), ORE(ORE) {}
+      : Func(F), DL(F.getParent()->getDataLayout()), TTI(TTI), AA(AA),
+        ORE(ORE) {}
 
   unsigned getNumOps(Type *VT) {
     assert(isa<VectorType>(VT) && "Expected vector type");
@@ -556,6 +574,17 @@ public:
 
     ReversePostOrderTraversal<Function *> RPOT(&Func);
     bool Changed = false;
+
+    // Tile multiplies of loaded matrices that are stored right away. This
+    // removes them before the remaining instructions are lowered.
+    SmallVector<CallInst *, 8> MatMuls;
+    for (auto *BB : RPOT)
+      for (Instruction &Inst : *BB)
+        if (match(&Inst, m_Intrinsic<Intrinsic::matrix_multiply>()))
+          MatMuls.push_back(cast<CallInst>(&Inst));
+    for (CallInst *MatMul : MatMuls)
+      Changed |= LowerMatrixMultiplyFused(MatMul);
+
     for (auto *BB : RPOT) {
       for (Instruction &Inst : make_early_inc_range(*BB)) {
         IRBuilder<> Builder(&Inst);
@@ -777,6 +806,51 @@ public:
     }
   }
 
+  /// Compute \p Result += \p A * \p B, or \p Result = \p A * \p B if
+  /// \p Accumulate is false. The columns of \p Result must have the type of
+  /// the result columns. Returns the number of compute operations emitted.
+  unsigned emitMatrixMultiply(ColumnMatrixTy &Result, const ColumnMatrixTy &A,
+                              const ColumnMatrixTy &B, bool AllowContract,
+                              bool Accumulate, IRBuilder<> &Builder) {
+    auto *EltType = cast<VectorType>(A.getColumn(0)->getType())
+                        ->getElementType();
+    const unsigned R = Result.getNumRows();
+    const unsigned M = A.getNumColumns();
+    const unsigned C = Result.getNumColumns();
+    assert(M == B.getNumRows() && C == B.getNumColumns() &&
+           R == A.getNumRows() && "Matrix shapes do not match");
+
+    const unsigned VF = std::max(TTI.getRegisterBitWidth(true) /
+                                     EltType->getPrimitiveSizeInBits(),
+                                 uint64_t(1));
+
+    unsigned NumComputeOps = 0;
+    // Multiply columns from the first operand with scalars from the second
+    // operand.  Then move along the K axes and accumulate the columns.  With
+    // this the adds can be vectorized without reassociation.
+    for (unsigned J = 0; J < C; ++J) {
+      unsigned BlockSize = VF;
+      for (unsigned I = 0; I < R; I += BlockSize) {
+        // Gradually lower the vectorization factor to cover the remainder.
+        while (I + BlockSize > R)
+          BlockSize /= 2;
+
+        Value *Sum =
+            Accumulate ? extractVector(Result, I, J, BlockSize, Builder)
+                       : nullptr;
+        for (unsigned K = 0; K < M; ++K) {
+          Value *L = extractVector(A, I, K, BlockSize, Builder);
+          Value *RH = Builder.CreateExtractElement(B.getColumn(J), K);
+          Value *Splat = Builder.CreateVectorSplat(BlockSize, RH, "splat");
+          Sum = createMulAdd(Sum, L, Splat, EltType->isFloatingPointTy(),
+                             Builder, AllowContract, NumComputeOps);
+        }
+        Result.setColumn(J, insertVector(Result.getColumn(J), I, Sum, Builder));
+      }
+    }
+    return NumComputeOps;
+  }
+
   /// Lowers llvm.matrix.multiply.
   void LowerMultiply(CallInst *MatMul) {
     IRBuilder<> Builder(MatMul);
@@ -790,45 +864,174 @@ public:
         getMatrix(MatMul->getArgOperand(1), RShape, Builder);
 
     const unsigned R = LShape.NumRows;
-    const unsigned M = LShape.NumColumns;
     const unsigned C = RShape.NumColumns;
-    assert(M == RShape.NumRows);
+    assert(LShape.NumColumns == RShape.NumRows);
 
     // Initialize the output
     ColumnMatrixTy Result;
     for (unsigned J = 0; J < C; ++J)
       Result.addColumn(UndefValue::get(VectorType::get(EltType, R)));
 
-    const unsigned VF = std::max(TTI.getRegisterBitWidth(true) /
-                                     EltType->getPrimitiveSizeInBits(),
-                                 uint64_t(1));
+    bool AllowContract = AllowContractEnabled || (isa<FPMathOperator>(MatMul) &&
+                                                  MatMul->hasAllowContract());
+    unsigned NumComputeOps = emitMatrixMultiply(
+        Result, Lhs, Rhs, AllowContract, /*Accumulate=*/false, Builder);
+    Result.addNumComputeOps(NumComputeOps);
+    finalizeLowering(MatMul, Result, Builder);
+  }
+
+  /// Return whether tiling \p MatMul is expected to beat lowering it in one
+  /// piece, because its operands do not fit in the vector registers.
+  bool isFusionProfitable(CallInst *MatMul) {
+    if (ForceFusion)
+      return true;
+
+    ShapeInfo LShape(MatMul->getArgOperand(2), MatMul->getArgOperand(3));
+    ShapeInfo RShape(MatMul->getArgOperand(3), MatMul->getArgOperand(4));
+    const unsigned R = LShape.NumRows;
+    const unsigned M = LShape.NumColumns;
+    const unsigned C = RShape.NumColumns;
+    auto *EltType = cast<VectorType>(MatMul->getType())->getElementType();
+    const unsigned VF = std::max<unsigned>(
+        TTI.getRegisterBitWidth(true) / EltType->getPrimitiveSizeInBits(), 1U);
 
+    // Tiles are vectorized along the rows, so a single column of at most one
+    // vector gains nothing from tiling.
+    if (R <= VF && C == 1)
+      return false;
+
+    // Otherwise tile if the operands take more registers than there are.
+    unsigned Op0Regs = (R + VF - 1) / VF * M;
+    unsigned Op1Regs = (M + VF - 1) / VF * C;
+    return Op0Regs + Op1Regs >
+           TTI.getNumberOfRegisters(TTI.getRegisterClassForType(true));
+  }
+
+  /// Load the \p TileRows x \p TileColumns sub-matrix at row \p I and column
+  /// \p J of the column-major matrix with \p Stride rows at \p EltPtr.
+  ColumnMatrixTy loadTile(Value *EltPtr, unsigned Stride, unsigned I,
+                          unsigned J, unsigned TileRows, unsigned TileColumns,
+                          Type *EltType, IRBuilder<> &Builder) {
+    Value *TileStart = Builder.CreateGEP(
+        EltType, EltPtr, Builder.getInt32(J * Stride + I), "tile.start");
+    ColumnMatrixTy Tile;
+    for (unsigned C = 0; C < TileColumns; ++C) {
+      Value *GEP = computeColumnAddr(TileStart, Builder.getInt32(C),
+                                     Builder.getInt32(Stride), TileRows,
+                                     EltType, Builder);
+      Tile.addColumn(createColumnLoad(GEP, EltType, Builder));
+    }
+    return Tile;
+  }
+
+  /// Store \p Tile at row \p I and column \p J of the column-major matrix
+  /// with \p Stride rows at \p EltPtr.
+  void storeTile(const ColumnMatrixTy &Tile, Value *EltPtr, unsigned Stride,
+                 unsigned I, unsigned J, Type *EltType, IRBuilder<> &Builder) {
+    Value *TileStart = Builder.CreateGEP(
+        EltType, EltPtr, Builder.getInt32(J * Stride + I), "tile.start");
+    for (unsigned C = 0, E = Tile.getNumColumns(); C < E; ++C) {
+      Value *GEP = computeColumnAddr(TileStart, Builder.getInt32(C),
+                                     Builder.getInt32(Stride),
+                                     Tile.getNumRows(), EltType, Builder);
+      createColumnStore(Tile.getColumn(C), GEP, EltType, Builder);
+    }
+  }
+
+  /// Return whether an instruction after \p From and before \p To may write
+  /// to memory. Both must be in the same block.
+  static bool mayWriteBetween(Instruction *From, Instruction *To) {
+    for (Instruction *I = From->getNextNode(); I != To; I = I->getNextNode())
+      if (I->mayWriteToMemory())
+        return true;
+    return false;
+  }
+
+  /// Try to lower \p MatMul together with the loads of its operands and the
+  /// store of its result, one tile of the result at a time. Only the tiles
+  /// of the operands needed for the current result tile are loaded, so
+  /// multiplies too large for the vector registers do not spill whole
+  /// matrices. Returns true if \p MatMul was lowered.
+  bool LowerMatrixMultiplyFused(CallInst *MatMul) {
+    if (!FuseMatrix || !AA || TileSize == 0 || !MatMul->hasOneUse())
+      return false;
+
+    auto *LoadOp0 = dyn_cast<LoadInst>(MatMul->getArgOperand(0));
+    auto *LoadOp1 = dyn_cast<LoadInst>(MatMul->getArgOperand(1));
+    auto *Store = dyn_cast<StoreInst>(MatMul->user_back());
+    if (!LoadOp0 || !LoadOp1 || !Store ||
+        Store->getValueOperand() != MatMul || !LoadOp0->isSimple() ||
+        !LoadOp1->isSimple() || !Store->isSimple())
+      return false;
+
+    // The operands are loaded tile by tile just before the store. This is
+    // only correct if nothing writes to them in between, including the
+    // stores of the result tiles.
+    BasicBlock *BB = MatMul->getParent();
+    if (LoadOp0->getParent() != BB || LoadOp1->getParent() != BB ||
+        Store->getParent() != BB || mayWriteBetween(LoadOp0, Store) ||
+        mayWriteBetween(LoadOp1, Store))
+      return false;
+    if (!AA->isNoAlias(MemoryLocation::get(Store),
+                       MemoryLocation::get(LoadOp0)) ||
+        !AA->isNoAlias(MemoryLocation::get(Store),
+                       MemoryLocation::get(LoadOp1)))
+      return false;
+
+    if (!isFusionProfitable(MatMul))
+      return false;
+
+    ShapeInfo LShape(MatMul->getArgOperand(2), MatMul->getArgOperand(3));
+    ShapeInfo RShape(MatMul->getArgOperand(3), MatMul->getArgOperand(4));
+    const unsigned R = LShape.NumRows;
+    const unsigned M = LShape.NumColumns;
+    const unsigned C = RShape.NumColumns;
+    auto *EltType = cast<VectorType>(MatMul->getType())->getElementType();
     bool AllowContract = AllowContractEnabled || (isa<FPMathOperator>(MatMul) &&
                                                   MatMul->hasAllowContract());
-    unsigned NumComputeOps = 0;
-    // Multiply columns from the first operand with scalars from the second
-    // operand.  Then move along the K axes and accumulate the columns.  With
-    // this the adds can be vectorized without reassociation.
-    for (unsigned J = 0; J < C; ++J) {
-      unsigned BlockSize = VF;
-      for (unsigned I = 0; I < R; I += BlockSize) {
-        // Gradually lower the vectorization factor to cover the remainder.
-        while (I + BlockSize > R)
-          BlockSize /= 2;
 
-        Value *Sum = nullptr;
-        for (unsigned K = 0; K < M; ++K) {
-          Value *L = extractVector(Lhs, I, K, BlockSize, Builder);
-          Value *RH = Builder.CreateExtractElement(Rhs.getColumn(J), K);
-          Value *Splat = Builder.CreateVectorSplat(BlockSize, RH, "splat");
-          Sum = createMulAdd(Sum, L, Splat, EltType->isFloatingPointTy(),
-                             Builder, AllowContract, NumComputeOps);
+    IRBuilder<> Builder(Store);
+    Value *APtr = createElementPtr(LoadOp0->getPointerOperand(), EltType,
+                                   Builder);
+    Value *BPtr = createElementPtr(LoadOp1->getPointerOperand(), EltType,
+                                   Builder);
+    Value *CPtr = createElementPtr(Store->getPointerOperand(), EltType,
+                                   Builder);
+
+    // Each element of the result sums its products in the same order as the
+    // untiled lowering, so the results are the same.
+    for (unsigned J = 0; J < C; J += TileSize)
+      for (unsigned I = 0; I < R; I += TileSize) {
+        const unsigned TileR = std::min(R - I, unsigned(TileSize));
+        const unsigned TileC = std::min(C - J, unsigned(TileSize));
+        ColumnMatrixTy Res;
+        for (unsigned Col = 0; Col < TileC; ++Col)
+          Res.addColumn(UndefValue::get(VectorType::get(EltType, TileR)));
+
+        for (unsigned K = 0; K < M; K += TileSize) {
+          const unsigned TileM = std::min(M - K, unsigned(TileSize));
+          ColumnMatrixTy A =
+              loadTile(APtr, R, I, K, TileR, TileM, EltType, Builder);
+          ColumnMatrixTy B =
+              loadTile(BPtr, M, K, J, TileM, TileC, EltType, Builder);
+          emitMatrixMultiply(Res, A, B, AllowContract, /*Accumulate=*/K != 0,
+                             Builder);
         }
-        Result.setColumn(J, insertVector(Result.getColumn(J), I, Sum, Builder));
+        storeTile(Res, CPtr, R, I, J, EltType, Builder);
       }
+
+    // The shape map must not find the erased instructions again.
+    for (Instruction *Inst : {cast<Instruction>(Store),
+                              cast<Instruction>(MatMul)}) {
+      ShapeMap.erase(Inst);
+      Inst->eraseFromParent();
     }
-    Result.addNumComputeOps(NumComputeOps);
-    finalizeLowering(MatMul, Result, Builder);
+    for (LoadInst *Load : {LoadOp0, LoadOp1})
+      if (Load->use_empty()) {
+        ShapeMap.erase(Load);
+        Load->eraseFromParent();
+      }
+    return true;
   }
 
   /// Lowers llvm.matrix.transpose.
@@ -1325,8 +1528,9 @@ public:
 PreservedAnalyses LowerMatrixIntrinsicsPass::run(Function &F,
                                                  FunctionAnalysisManager &AM) {
   auto &TTI = AM.getResult<TargetIRAnalysis>(F);
+  auto &AA = AM.getResult<AAManager>(F);
   auto &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
-  LowerMatrixIntrinsics LMT(F, TTI, ORE);
+  LowerMatrixIntrinsics LMT(F, TTI, &AA, ORE);
   if (LMT.Visit()) {
     PreservedAnalyses PA;
     PA.preserveSet<CFGAnalyses>();
@@ -1348,14 +1552,16 @@ public:
 
   bool runOnFunction(Function &F) override {
     auto &TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F);
+    auto &AA = getAnalysis<AAResultsWrapperPass>().getAAResults();
     auto &ORE = getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
-    LowerMatrixIntrinsics LMT(F, TTI, ORE);
+    LowerMatrixIntrinsics LMT(F, TTI, &AA, ORE);
     bool C = LMT.Visit();
     return C;
   }
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<TargetTransformInfoWrapperPass>();
+    AU.addRequired<AAResultsWrapperPass>();
     AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
     AU.setPreservesCFG();
   }
@@ -1366,6 +1572,8 @@ static const char pass_name[] = "Lower the matrix intrinsics";
 char LowerMatrixIntrinsicsLegacyPass::ID = 0;
 INITIALIZE_PASS_BEGIN(LowerMatrixIntrinsicsLegacyPass, DEBUG_TYPE, pass_name,
                       false, false)
+INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
 INITIALIZE_PASS_END(LowerMatrixIntrinsicsLegacyPass, DEBUG_TYPE, pass_name,
                     false, false)
@@ -114,6 +114,10 @@ STATISTIC(NumPromoted, "Number of allocas promoted to SSA values");
 STATISTIC(NumLoadsSpeculated, "Number of loads speculated to allow promotion");
 STATISTIC(NumDeleted, "Number of instructions deleted");
 STATISTIC(NumVectorized, "Number of vectorized aggregates");
+STATISTIC(MaxSlicesPerAlloca, "Maximum number of slices per alloca");
+STATISTIC(NumSplitTails, "Number of split slice tails rewritten");
+STATISTIC(NumAllocasTooCostlyToSplit,
+          "Number of allocas not split because of too many split slice tails");
 
 /// Hidden option to enable randomly shuffling the slices to help uncover
 /// instability in their order.
@@ -125,6 +129,16 @@ static cl::opt<bool> SROARandomShuffleSlices("sroa-random-shuffle-slices",
 static cl::opt<bool> SROAStrictInbounds("sroa-strict-inbounds", cl::init(false),
                                         cl::Hidden);
 
+/// Splittable slices, such as memcpys of the whole aggregate, are rewritten
+/// once for every partition they overlap. Limit how many such split tails an
+/// alloca may have, relative to its number of slices, so that many
+/// overlapping memcpys of a large aggregate don't produce a quadratic amount
+/// of code.
+static cl::opt<unsigned> SROAMaxSplitTailsPerSlice(
+    "sroa-max-split-tails-per-slice", cl::init(32), cl::Hidden,
+    cl::desc("Maximum average number of split slice tails per slice of an "
+             "alloca for SROA to split it"));
+
 namespace {
 
 /// A custom IRBuilder inserter which prefixes all names, but only in
@@ -4090,11 +4104,8 @@ bool SROA::presplitLoadsAndStores(AllocaInst &AI, AllocaSlices &AS) {
 
   // Finally, don't try to promote any allocas that new require re-splitting.
   // They have already been added to the worklist above.
-  PromotableAllocas.erase(
-      llvm::remove_if(
-          PromotableAllocas,
-          [&](AllocaInst *AI) { return ResplitPromotableAllocas.count(AI); }),
-      PromotableAllocas.end());
+  for (AllocaInst *ResplitAI : ResplitPromotableAllocas)
+    PromotableAllocas.remove(ResplitAI);
 
   return true;
 }
@@ -4219,7 +4230,7 @@ AllocaInst *SROA::rewritePartition(AllocaInst &AI, AllocaSlices &AS,
   if (Promotable) {
     if (PHIUsers.empty() && SelectUsers.empty()) {
       // Promote the alloca.
-      PromotableAllocas.push_back(NewAI);
+      PromotableAllocas.insert(NewAI);
     } else {
       // If we have either PHIs or Selects to speculate, add them to those
       // worklists and re-queue the new alloca so that we promote in on the
@@ -4317,6 +4328,22 @@ bool SROA::splitAlloca(AllocaInst &AI, AllocaSlices &AS) {
   if (!IsSorted)
     llvm::sort(AS);
 
+  // Every split tail becomes a separate use of a new alloca. When many
+  // splittable slices overlap many partitions that is quadratic in the size
+  // of the alloca, so leave such allocas alone.
+  uint64_t MaxSplitTails =
+      uint64_t(SROAMaxSplitTailsPerSlice) * (AS.end() - AS.begin());
+  uint64_t SplitTails = 0;
+  for (auto &P : AS.partitions()) {
+    SplitTails += P.splitSliceTails().size();
+    if (SplitTails > MaxSplitTails) {
+      LLVM_DEBUG(dbgs() << "  Too many split slice tails to split alloca\n");
+      ++NumAllocasTooCostlyToSplit;
+      return Changed;
+    }
+  }
+  NumSplitTails += SplitTails;
+
   /// Describes the allocas introduced by rewritePartition in order to migrate
   /// the debug info.
   struct Fragment {
@@ -4480,6 +4507,7 @@ bool SROA::runOnAlloca(AllocaInst &AI) {
   // No slices to split. Leave the dead alloca for a later pass to clean up.
   if (AS.begin() == AS.end())
     return Changed;
+  MaxSlicesPerAlloca.updateMax(AS.end() - AS.begin());
 
   Changed |= splitAlloca(AI, AS);
 
@@ -4548,7 +4576,7 @@ bool SROA::promoteAllocas(Function &F) {
   NumPromoted += PromotableAllocas.size();
 
   LLVM_DEBUG(dbgs() << "Promoting allocas with mem2reg...\n");
-  PromoteMemToReg(PromotableAllocas, *DT, AC);
+  PromoteMemToReg(PromotableAllocas.getArrayRef(), *DT, AC);
   PromotableAllocas.clear();
   return true;
 }
@@ -4578,15 +4606,14 @@ PreservedAnalyses SROA::runImpl(Function &F, DominatorTree &RunDT,
       Changed |= deleteDeadInstructions(DeletedAllocas);
 
       // Remove the deleted allocas from various lists so that we don't try to
-      // continue processing them.
-      if (!DeletedAllocas.empty()) {
-        auto IsInSet = [&](AllocaInst *AI) { return DeletedAllocas.count(AI); };
-        Worklist.remove_if(IsInSet);
-        PostPromotionWorklist.remove_if(IsInSet);
-        PromotableAllocas.erase(llvm::remove_if(PromotableAllocas, IsInSet),
-                                PromotableAllocas.end());
-        DeletedAllocas.clear();
+      // continue processing them. Look each of them up rather than scanning
+      // the lists, which would be quadratic in functions with many allocas.
+      for (AllocaInst *AI : DeletedAllocas) {
+        Worklist.remove(AI);
+        PostPromotionWorklist.remove(AI);
+        PromotableAllocas.remove(AI);
       }
+      DeletedAllocas.clear();
     }
 
     Changed |= promoteAllocas(F);
@@ -0,0 +1,707 @@
+//===- CodeLayout.cpp - Implementation of code layout algorithms ----------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// ExtTSP - layout of basic blocks with i-cache optimization.
+//
+// The algorithm tries to find a layout of nodes (basic blocks) of a given CFG
+// optimizing jump locality and thus processor I-cache utilization. This is
+// achieved via increasing the number of fall-through jumps and co-locating
+// frequently executed nodes together. The name follows the underlying
+// optimization problem, Extended-TSP, which is a generalization of classical
+// (maximum) Traveling Salesmen Problem.
+//
+// The algorithm is a greedy heuristic that works with chains (ordered lists)
+// of basic blocks. Initially all chains are isolated basic blocks. On every
+// iteration, we pick a pair of chains whose merging yields the biggest
+// increase in the ExtTSP score, which models how i-cache "friendly" a
+// specific layout is. The pair of chains giving the maximum gain is merged
+// into a new chain. The procedure stops when there is only one chain left, or
+// when merging does not increase ExtTSP. In the latter case, the remaining
+// chains are sorted by density in decreasing order.
+//
+// An important aspect is the way two chains are merged. Unlike earlier
+// algorithms (e.g., based on the approach of Pettis-Hansen), two chains, X and
+// Y, are first split into three, X1, X2, and Y. Then we consider all possible
+// ways of gluing the three chains (e.g., X1YX2, X1X2Y, X2X1Y, X2YX1, YX1X2,
+// YX2X1) and choose the one producing the largest score. This improves the
+// quality of the final result (the search space is larger) while keeping the
+// implementation sufficiently fast.
+//
+// Reference:
+//   * A. Newell and S. Pupyrev, Improved Basic Block Reordering,
+//     IEEE Transactions on Computers, 2020
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/CodeLayout.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+
+using namespace llvm;
+
+// Algorithm-specific constants. The values are tuned for the best performance
+// of large-scale front-end bound binaries.
+static cl::opt<double>
+    ForwardWeight("ext-tsp-forward-weight", cl::Hidden, cl::init(0.1),
+                  cl::desc("The weight of forward jumps for ExtTSP value"));
+
+static cl::opt<double>
+    BackwardWeight("ext-tsp-backward-weight", cl::Hidden, cl::init(0.1),
+                   cl::desc("The weight of backward jumps for ExtTSP value"));
+
+static cl::opt<unsigned> ForwardDistance(
+    "ext-tsp-forward-distance", cl::Hidden, cl::init(1024),
+    cl::desc("The maximum distance (in bytes) of a forward jump for ExtTSP"));
+
+static cl::opt<unsigned> BackwardDistance(
+    "ext-tsp-backward-distance", cl::Hidden, cl::init(640),
+    cl::desc("The maximum distance (in bytes) of a backward jump for ExtTSP"));
+
+// The maximum size of a chain for splitting. Larger values of the threshold
+// may yield better quality at the cost of worsen run-time.
+static cl::opt<unsigned> ChainSplitThreshold(
+    "ext-tsp-chain-split-threshold", cl::Hidden, cl::init(128),
+    cl::desc("The maximum size of a chain to apply splitting"));
+
+namespace {
+
+// Epsilon for comparison of scores.
+constexpr double EPS = 1e-8;
+
+// Compute the Ext-TSP score for a jump between a given pair of blocks,
+// using their sizes, (estimated) addresses and the jump execution count.
+double extTSPScore(uint64_t SrcAddr, uint64_t SrcSize, uint64_t DstAddr,
+                   uint64_t Count) {
+  // Fallthrough
+  if (SrcAddr + SrcSize == DstAddr) {
+    // The weight of a fallthrough jump is normalized to 1.0.
+    return static_cast<double>(Count);
+  }
+  // Forward
+  if (SrcAddr + SrcSize < DstAddr) {
+    const uint64_t Dist = DstAddr - (SrcAddr + SrcSize);
+    if (Dist <= ForwardDistance) {
+      double Prob = 1.0 - static_cast<double>(Dist) / ForwardDistance;
+      return ForwardWeight * Prob * Count;
+    }
+    return 0;
+  }
+  // Backward
+  const uint64_t Dist = SrcAddr + SrcSize - DstAddr;
+  if (Dist <= BackwardDistance) {
+    double Prob = 1.0 - static_cast<double>(Dist) / BackwardDistance;
+    return BackwardWeight * Prob * Count;
+  }
+  return 0;
+}
+
+/// A type of merging two chains, X and Y. The former chain is split into
+/// X1 and X2 and then concatenated with Y in the order specified by the type.
+enum class MergeTypeTy : int { X_Y, X1_Y_X2, Y_X2_X1, X2_X1_Y };
+
+/// The gain of merging two chains, that is, the Ext-TSP score of the merge
+/// together with the corresponding merge 'type' and 'offset'.
+struct MergeGainTy {
+  double Score = -1.0;
+  size_t MergeOffset = 0;
+  MergeTypeTy MergeType = MergeTypeTy::X_Y;
+
+  MergeGainTy() = default;
+  MergeGainTy(double Score, size_t MergeOffset, MergeTypeTy MergeType)
+      : Score(Score), MergeOffset(MergeOffset), MergeType(MergeType) {}
+
+  bool operator<(const MergeGainTy &Other) const {
+    return (Other.Score > EPS && Other.Score > Score + EPS);
+  }
+};
+
+struct Jump;
+struct Chain;
+struct ChainEdge;
+
+/// A node in the graph, typically corresponding to a basic block in CFG.
+struct Block {
+  /// The index of the block in the original order.
+  uint64_t Index;
+  /// The size of the block in the binary.
+  uint64_t Size;
+  /// The execution count of the block in the profile data.
+  uint64_t ExecutionCount;
+  /// The current chain of the block.
+  Chain *CurChain = nullptr;
+  /// An offset of the block in the chain; set while evaluating a merge.
+  mutable uint64_t EstimatedAddr = 0;
+
+  Block(uint64_t Index, uint64_t Size, uint64_t ExecutionCount)
+      : Index(Index), Size(Size), ExecutionCount(ExecutionCount) {}
+
+  bool isEntry() const { return Index == 0; }
+};
+
+/// An arc in the graph, typically corresponding to a jump between two blocks.
+struct Jump {
+  Block *Source;
+  Block *Target;
+  uint64_t ExecutionCount;
+
+  Jump(Block *Source, Block *Target, uint64_t ExecutionCount)
+      : Source(Source), Target(Target), ExecutionCount(ExecutionCount) {}
+};
+
+/// A chain (ordered sequence) of blocks.
+struct Chain {
+  uint64_t Id;
+  /// Cached Ext-TSP score for the chain.
+  double Score = 0;
+  /// Blocks of the chain.
+  std::vector<Block *> Blocks;
+  /// Adjacent chains and the corresponding edges (lists of jumps). The edge
+  /// to the chain itself holds the jumps within the chain.
+  std::vector<std::pair<Chain *, ChainEdge *>> Edges;
+  uint64_t ExecutionCount;
+  uint64_t Size;
+
+  Chain(uint64_t Id, Block *B)
+      : Id(Id), Blocks(1, B), ExecutionCount(B->ExecutionCount),
+        Size(B->Size) {}
+
+  bool isEntry() const { return Blocks[0]->isEntry(); }
+
+  double density() const {
+    return static_cast<double>(ExecutionCount) / Size;
+  }
+
+  ChainEdge *getEdge(Chain *Other) const {
+    for (const auto &It : Edges)
+      if (It.first == Other)
+        return It.second;
+    return nullptr;
+  }
+
+  void removeEdge(Chain *Other) {
+    for (auto It = Edges.begin(), E = Edges.end(); It != E; ++It) {
+      if (It->first == Other) {
+        Edges.erase(It);
+        return;
+      }
+    }
+  }
+
+  void addEdge(Chain *Other, ChainEdge *Edge) {
+    Edges.push_back(std::make_pair(Other, Edge));
+  }
+
+  void merge(Chain *Other, std::vector<Block *> MergedBlocks) {
+    Blocks = std::move(MergedBlocks);
+    for (Block *B : Other->Blocks)
+      B->CurChain = this;
+    ExecutionCount += Other->ExecutionCount;
+    Size += Other->Size;
+  }
+
+  void clear() {
+    Blocks.clear();
+    Blocks.shrink_to_fit();
+    Edges.clear();
+    Edges.shrink_to_fit();
+  }
+};
+
+/// An edge in CFG representing jumps between two chains. When blocks are
+/// merged into chains, the edges are combined too so that there is always at
+/// most one edge between a pair of chains.
+struct ChainEdge {
+  Chain *SrcChain;
+  Chain *DstChain;
+  /// Original jumps in the binary with corresponding execution counts.
+  std::vector<Jump *> Jumps;
+
+  ChainEdge(Jump *J)
+      : SrcChain(J->Source->CurChain), DstChain(J->Target->CurChain),
+        Jumps(1, J) {}
+
+  void changeEndpoint(Chain *From, Chain *To) {
+    if (From == SrcChain)
+      SrcChain = To;
+    if (From == DstChain)
+      DstChain = To;
+  }
+
+  void appendJump(Jump *J) { Jumps.push_back(J); }
+
+  void moveJumps(ChainEdge *Other) {
+    Jumps.insert(Jumps.end(), Other->Jumps.begin(), Other->Jumps.end());
+    Other->Jumps.clear();
+    Other->Jumps.shrink_to_fit();
+  }
+
+  bool hasCachedMergeGain(Chain *Src, Chain *Dst) const {
+    return Src == SrcChain ? CacheValidForward : CacheValidBackward;
+  }
+
+  MergeGainTy getCachedMergeGain(Chain *Src, Chain *Dst) const {
+    return Src == SrcChain ? CachedGainForward : CachedGainBackward;
+  }
+
+  void setCachedMergeGain(Chain *Src, Chain *Dst, MergeGainTy MergeGain) {
+    if (Src == SrcChain) {
+      CachedGainForward = MergeGain;
+      CacheValidForward = true;
+    } else {
+      CachedGainBackward = MergeGain;
+      CacheValidBackward = true;
+    }
+  }
+
+  void invalidateCache() {
+    CacheValidForward = false;
+    CacheValidBackward = false;
+  }
+
+private:
+  /// Cached gain values for merging the pair of chains, in both directions.
+  MergeGainTy CachedGainForward;
+  MergeGainTy CachedGainBackward;
+  bool CacheValidForward = false;
+  bool CacheValidBackward = false;
+};
+
+/// A wrapper around three chains of blocks; it is used to avoid extra
+/// instantiation of the vectors.
+class MergedChain {
+public:
+  using BlockIter = std::vector<Block *>::const_iterator;
+
+  MergedChain(BlockIter Begin1, BlockIter End1, BlockIter Begin2 = BlockIter(),
+              BlockIter End2 = BlockIter(), BlockIter Begin3 = BlockIter(),
+              BlockIter End3 = BlockIter())
+      : Begin1(Begin1), End1(End1), Begin2(Begin2), End2(End2), Begin3(Begin3),
+        End3(End3) {}
+
+  template <typename F> void forEach(const F &Func) const {
+    for (auto It = Begin1; It != End1; ++It)
+      Func(*It);
+    for (auto It = Begin2; It != End2; ++It)
+      Func(*It);
+    for (auto It = Begin3; It != End3; ++It)
+      Func(*It);
+  }
+
+  std::vector<Block *> getBlocks() const {
+    std::vector<Block *> Result;
+    Result.reserve(std::distance(Begin1, End1) + std::distance(Begin2, End2) +
+                   std::distance(Begin3, End3));
+    forEach([&](Block *B) { Result.push_back(B); });
+    return Result;
+  }
+
+  const Block *getFirstBlock() const { return *Begin1; }
+
+private:
+  BlockIter Begin1;
+  BlockIter End1;
+  BlockIter Begin2;
+  BlockIter End2;
+  BlockIter Begin3;
+  BlockIter End3;
+};
+
+/// The implementation of the ExtTSP algorithm.
+class ExtTSPImpl {
+public:
+  ExtTSPImpl(ArrayRef<uint64_t> NodeSizes, ArrayRef<uint64_t> NodeCounts,
+             ArrayRef<EdgeCountT> EdgeCounts) {
+    initialize(NodeSizes, NodeCounts, EdgeCounts);
+  }
+
+  /// Run the algorithm and return an optimized ordering of blocks.
+  std::vector<uint64_t> run() {
+    // Merge pairs of chains while improving the ExtTSP objective.
+    mergeChainPairs();
+
+    // Collect blocks from all chains.
+    return concatChains();
+  }
+
+private:
+  /// Initialize the algorithm's data structures.
+  void initialize(ArrayRef<uint64_t> NodeSizes, ArrayRef<uint64_t> NodeCounts,
+                  ArrayRef<EdgeCountT> EdgeCounts) {
+    assert(NodeSizes.size() == NodeCounts.size() &&
+           "Node sizes and counts do not match");
+    // Initialize blocks. Every block needs a positive size so that its
+    // address differs from the one of its layout successor.
+    AllBlocks.reserve(NodeSizes.size());
+    for (uint64_t Node = 0, E = NodeSizes.size(); Node != E; ++Node)
+      AllBlocks.emplace_back(Node, std::max<uint64_t>(NodeSizes[Node], 1),
+                             NodeCounts[Node]);
+
+    // Initialize jumps between blocks.
+    AllJumps.reserve(EdgeCounts.size());
+    for (const EdgeCountT &It : EdgeCounts) {
+      uint64_t Pred = It.first.first;
+      uint64_t Succ = It.first.second;
+      assert(Pred < AllBlocks.size() && Succ < AllBlocks.size() &&
+             "Jump between unknown nodes");
+      // Ignore jumps that never execute; they do not contribute to the score.
+      if (It.second == 0)
+        continue;
+      AllJumps.emplace_back(&AllBlocks[Pred], &AllBlocks[Succ], It.second);
+    }
+
+    // Initialize chains: every block starts in a chain of its own.
+    AllChains.reserve(AllBlocks.size());
+    HotChains.reserve(AllBlocks.size());
+    for (Block &B : AllBlocks) {
+      AllChains.emplace_back(B.Index, &B);
+      B.CurChain = &AllChains.back();
+      HotChains.push_back(&AllChains.back());
+    }
+
+    // Initialize chain edges.
+    AllEdges.reserve(AllJumps.size());
+    for (Jump &J : AllJumps) {
+      Chain *SrcChain = J.Source->CurChain;
+      Chain *DstChain = J.Target->CurChain;
+      if (ChainEdge *CurEdge = SrcChain->getEdge(DstChain)) {
+        CurEdge->appendJump(&J);
+        continue;
+      }
+      AllEdges.emplace_back(&J);
+      ChainEdge *Edge = &AllEdges.back();
+      SrcChain->addEdge(DstChain, Edge);
+      if (SrcChain != DstChain)
+        DstChain->addEdge(SrcChain, Edge);
+    }
+
+    // Self-loops are the only jumps within the initial chains.
+    for (Chain &C : AllChains)
+      if (ChainEdge *Edge = C.getEdge(&C))
+        C.Score = score(MergedChain(C.Blocks.begin(), C.Blocks.end()),
+                        Edge->Jumps);
+  }
+
+  /// Merge pairs of chains while improving the ExtTSP objective.
+  void mergeChainPairs() {
+    while (HotChains.size() > 1) {
+      Chain *BestChainPred = nullptr;
+      Chain *BestChainSucc = nullptr;
+      MergeGainTy BestGain;
+      // Iterate over all pairs of chains
+      for (Chain *ChainPred : HotChains) {
+        // Get candidates for merging with the current chain
+        for (const auto &EdgeIt : ChainPred->Edges) {
+          Chain *ChainSucc = EdgeIt.first;
+          ChainEdge *Edge = EdgeIt.second;
+          // Ignore loop edges
+          if (ChainPred == ChainSucc)
+            continue;
+
+          // Compute the gain of merging the two chains
+          MergeGainTy CurGain = getBestMergeGain(ChainPred, ChainSucc, Edge);
+          if (CurGain.Score <= EPS)
+            continue;
+
+          if (BestGain < CurGain ||
+              (std::abs(CurGain.Score - BestGain.Score) < EPS &&
+               compareChainPairs(ChainPred, ChainSucc, BestChainPred,
+                                 BestChainSucc))) {
+            BestGain = CurGain;
+            BestChainPred = ChainPred;
+            BestChainSucc = ChainSucc;
+          }
+        }
+      }
+
+      // Stop merging when there is no improvement
+      if (BestGain.Score <= EPS)
+        break;
+
+      // Merge the best pair of chains
+      mergeChains(BestChainPred, BestChainSucc, BestGain.MergeOffset,
+                  BestGain.MergeType);
+    }
+  }
+
+  /// Deterministically compare pairs of chains with equal gains.
+  bool compareChainPairs(const Chain *A1, const Chain *B1, const Chain *A2,
+                         const Chain *B2) const {
+    if (!A2 || !B2)
+      return true;
+    if (A1 != A2)
+      return A1->Id < A2->Id;
+    return B1->Id < B2->Id;
+  }
+
+  /// Compute the Ext-TSP score for a given block order and a list of jumps.
+  double score(const MergedChain &MergedBlocks,
+               const std::vector<Jump *> &Jumps) const {
+    if (Jumps.empty())
+      return 0.0;
+    uint64_t CurAddr = 0;
+    MergedBlocks.forEach([&](const Block *B) {
+      B->EstimatedAddr = CurAddr;
+      CurAddr += B->Size;
+    });
+
+    double Score = 0;
+    for (const Jump *J : Jumps)
+      Score += extTSPScore(J->Source->EstimatedAddr, J->Source->Size,
+                           J->Target->EstimatedAddr, J->ExecutionCount);
+    return Score;
+  }
+
+  /// Compute the gain of merging two chains.
+  ///
+  /// The function considers all possible ways of merging two chains and
+  /// computes the one having the largest increase in ExtTSP objective. The
+  /// result is a pair with the first element being the gain and the second
+  /// element being the corresponding merging type.
+  MergeGainTy getBestMergeGain(Chain *ChainPred, Chain *ChainSucc,
+                               ChainEdge *Edge) const {
+    if (Edge->hasCachedMergeGain(ChainPred, ChainSucc))
+      return Edge->getCachedMergeGain(ChainPred, ChainSucc);
+
+    // Precompute jumps between ChainPred and ChainSucc
+    std::vector<Jump *> Jumps = Edge->Jumps;
+    if (ChainEdge *EdgePP = ChainPred->getEdge(ChainPred))
+      Jumps.insert(Jumps.end(), EdgePP->Jumps.begin(), EdgePP->Jumps.end());
+    if (ChainEdge *EdgeSS = ChainSucc->getEdge(ChainSucc))
+      Jumps.insert(Jumps.end(), EdgeSS->Jumps.begin(), EdgeSS->Jumps.end());
+    assert(!Jumps.empty() && "trying to merge chains w/o jumps");
+
+    MergeGainTy Gain;
+    // Try to concatenate two chains w/o splitting
+    Gain = std::max(Gain, computeMergeGain(ChainPred, ChainSucc, Jumps, 0,
+                                           MergeTypeTy::X_Y));
+
+    // Try to break ChainPred in various ways and concatenate with ChainSucc
+    if (ChainPred->Blocks.size() <= ChainSplitThreshold) {
+      for (size_t Offset = 1; Offset < ChainPred->Blocks.size(); ++Offset) {
+        // Try to split the chain in different ways. In practice, applying
+        // X2_Y_X1 merging does not improve the quality, so it is omitted.
+        Gain = std::max(Gain, computeMergeGain(ChainPred, ChainSucc, Jumps,
+                                               Offset, MergeTypeTy::X1_Y_X2));
+        Gain = std::max(Gain, computeMergeGain(ChainPred, ChainSucc, Jumps,
+                                               Offset, MergeTypeTy::Y_X2_X1));
+        Gain = std::max(Gain, computeMergeGain(ChainPred, ChainSucc, Jumps,
+                                               Offset, MergeTypeTy::X2_X1_Y));
+      }
+    }
+
+    Edge->setCachedMergeGain(ChainPred, ChainSucc, Gain);
+    return Gain;
+  }
+
+  /// Compute the score gain of merging two chains, respecting a given
+  /// merge 'type' and 'offset'.
+  ///
+  /// The two chains are not modified in the method.
+  MergeGainTy computeMergeGain(const Chain *ChainPred, const Chain *ChainSucc,
+                               const std::vector<Jump *> &Jumps,
+                               size_t MergeOffset,
+                               MergeTypeTy MergeType) const {
+    MergedChain MergedBlocks = mergeBlocks(ChainPred->Blocks, ChainSucc->Blocks,
+                                           MergeOffset, MergeType);
+
+    // Do not allow a merge that does not preserve the original entry block
+    if ((ChainPred->isEntry() || ChainSucc->isEntry()) &&
+        !MergedBlocks.getFirstBlock()->isEntry())
+      return MergeGainTy();
+
+    // The gain for the new chain
+    double NewGainScore = score(MergedBlocks, Jumps) - ChainPred->Score;
+    return MergeGainTy(NewGainScore - ChainSucc->Score, MergeOffset,
+                       MergeType);
+  }
+
+  /// Merge two chains of blocks respecting a given merge 'type' and 'offset'.
+  ///
+  /// If MergeType == X_Y, then the result is a concatenation of two chains.
+  /// Otherwise, the first chain is cut into two sub-chains at the offset,
+  /// and merged using all possible ways of concatenating three chains.
+  MergedChain mergeBlocks(const std::vector<Block *> &X,
+                          const std::vector<Block *> &Y, size_t MergeOffset,
+                          MergeTypeTy MergeType) const {
+    // Split the first chain, X, into X1 and X2
+    MergedChain::BlockIter BeginX1 = X.begin();
+    MergedChain::BlockIter EndX1 = X.begin() + MergeOffset;
+    MergedChain::BlockIter BeginX2 = X.begin() + MergeOffset;
+    MergedChain::BlockIter EndX2 = X.end();
+    MergedChain::BlockIter BeginY = Y.begin();
+    MergedChain::BlockIter EndY = Y.end();
+
+    // Construct a new chain from the three existing ones
+    switch (MergeType) {
+    case MergeTypeTy::X_Y:
+      return MergedChain(BeginX1, EndX2, BeginY, EndY);
+    case MergeTypeTy::X1_Y_X2:
+      return MergedChain(BeginX1, EndX1, BeginY, EndY, BeginX2, EndX2);
+    case MergeTypeTy::Y_X2_X1:
+      return MergedChain(BeginY, EndY, BeginX2, EndX2, BeginX1, EndX1);
+    case MergeTypeTy::X2_X1_Y:
+      return MergedChain(BeginX2, EndX2, BeginX1, EndX1, BeginY, EndY);
+    }
+    llvm_unreachable("unexpected chain merge type");
+  }
+
+  /// Merge chain From into chain Into, update the list of active chains,
+  /// adjacency information, and the corresponding cached values.
+  void mergeChains(Chain *Into, Chain *From, size_t MergeOffset,
+                   MergeTypeTy MergeType) {
+    assert(Into != From && "a chain cannot be merged with itself");
+
+    // Merge the blocks
+    MergedChain MergedBlocks =
+        mergeBlocks(Into->Blocks, From->Blocks, MergeOffset, MergeType);
+    Into->merge(From, MergedBlocks.getBlocks());
+    mergeEdges(Into, From);
+    From->clear();
+
+    // Update cached ext-tsp score for the new chain
+    if (ChainEdge *SelfEdge = Into->getEdge(Into))
+      Into->Score = score(MergedChain(Into->Blocks.begin(), Into->Blocks.end()),
+                          SelfEdge->Jumps);
+    else
+      Into->Score = 0;
+
+    // Remove chain From from the list of active chains
+    HotChains.erase(std::remove(HotChains.begin(), HotChains.end(), From),
+                    HotChains.end());
+
+    // Invalidate caches
+    for (const auto &EdgeIt : Into->Edges)
+      EdgeIt.second->invalidateCache();
+  }
+
+  /// Merge the edges of chain From into the edges of chain Into.
+  void mergeEdges(Chain *Into, Chain *From) {
+    for (const auto &EdgeIt : From->Edges) {
+      Chain *Other = EdgeIt.first;
+      ChainEdge *Edge = EdgeIt.second;
+      // The jumps within From and between From and Into become jumps within
+      // Into.
+      Chain *Target = Other == From ? Into : Other;
+      if (Other != From)
+        Other->removeEdge(From);
+
+      if (ChainEdge *CurEdge = Into->getEdge(Target)) {
+        CurEdge->moveJumps(Edge);
+        continue;
+      }
+      Edge->changeEndpoint(From, Into);
+      Into->addEdge(Target, Edge);
+      if (Target != Into)
+        Target->addEdge(Into, Edge);
+    }
+  }
+
+  /// Concatenate all chains into a final order of blocks.
+  std::vector<uint64_t> concatChains() {
+    // Collect chains and calculate some stats for their sorting
+    std::vector<const Chain *> SortedChains;
+    for (const Chain &C : AllChains)
+      if (!C.Blocks.empty())
+        SortedChains.push_back(&C);
+
+    // Sorting chains by density in the decreasing order; the entry chain comes
+    // first, and chains without samples keep their original relative order
+    // at the end of the function.
+    std::stable_sort(SortedChains.begin(), SortedChains.end(),
+                     [](const Chain *C1, const Chain *C2) {
+                       // Make sure the original entry block is at the
+                       // beginning of the order
+                       if (C1->isEntry() != C2->isEntry())
+                         return C1->isEntry();
+
+                       const double D1 = C1->density();
+                       const double D2 = C2->density();
+                       // Compare by density and break ties by chain
+                       // identifiers
+                       return D1 > D2 || (D1 == D2 && C1->Id < C2->Id);
+                     });
+
+    // Collect the blocks in the order specified by their chains
+    std::vector<uint64_t> Order;
+    Order.reserve(AllBlocks.size());
+    for (const Chain *C : SortedChains)
+      for (const Block *B : C->Blocks)
+        Order.push_back(B->Index);
+    return Order;
+  }
+
+  /// All CFG nodes.
+  std::vector<Block> AllBlocks;
+
+  /// All CFG jumps.
+  std::vector<Jump> AllJumps;
+
+  /// All chains of blocks.
+  std::vector<Chain> AllChains;
+
+  /// All edges between chains.
+  std::vector<ChainEdge> AllEdges;
+
+  /// Active chains. The vector gets updated at runtime when chains are merged.
+  std::vector<Chain *> HotChains;
+};
+
+} // end anonymous namespace
+
+std::vector<uint64_t> llvm::applyExtTspLayout(ArrayRef<uint64_t> NodeSizes,
+                                              ArrayRef<uint64_t> NodeCounts,
+                                              ArrayRef<EdgeCountT> EdgeCounts) {
+  size_t NumNodes = NodeSizes.size();
+
+  // Verify correctness of the input data.
+  assert(NodeCounts.size() == NodeSizes.size() && "Incorrect input");
+  if (NumNodes == 0)
+    return {};
+
+  // Apply the reordering algorithm.
+  ExtTSPImpl Alg(NodeSizes, NodeCounts, EdgeCounts);
+  std::vector<uint64_t> Result = Alg.run();
+
+  // Verify correctness of the output.
+  assert(Result.front() == 0 && "Original entry point is not preserved");
+  assert(Result.size() == NumNodes && "Incorrect size of reordered layout");
+  (void)NumNodes;
+  return Result;
+}
+
+double llvm::calcExtTspScore(ArrayRef<uint64_t> Order,
+                             ArrayRef<uint64_t> NodeSizes,
+                             ArrayRef<uint64_t> NodeCounts,
+                             ArrayRef<EdgeCountT> EdgeCounts) {
+  // Estimate addresses of the blocks in memory
+  std::vector<uint64_t> Addr(NodeSizes.size(), 0);
+  for (size_t Idx = 1; Idx < Order.size(); ++Idx)
+    Addr[Order[Idx]] = Addr[Order[Idx - 1]] + NodeSizes[Order[Idx - 1]];
+
+  // Increase the score for each jump
+  double Score = 0;
+  for (const EdgeCountT &It : EdgeCounts) {
+    uint64_t Pred = It.first.first;
+    uint64_t Succ = It.first.second;
+    Score += extTSPScore(Addr[Pred], NodeSizes[Pred], Addr[Succ], It.second);
+  }
+  return Score;
+}
+
+double llvm::calcExtTspScore(ArrayRef<uint64_t> NodeSizes,
+                             ArrayRef<uint64_t> NodeCounts,
+                             ArrayRef<EdgeCountT> EdgeCounts) {
+  std::vector<uint64_t> Order(NodeSizes.size());
+  for (size_t Idx = 0; Idx < NodeSizes.size(); ++Idx)
+    Order[Idx] = Idx;
+  return calcExtTspScore(Order, NodeSizes, NodeCounts, EdgeCounts);
+}
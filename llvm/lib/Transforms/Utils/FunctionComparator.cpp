@@ -31,6 +31,7 @@
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
@@ -774,6 +775,12 @@ int FunctionComparator::cmpBasicBlocks(const BasicBlock *BBL,
       for (unsigned i = 0, e = InstL->getNumOperands(); i != e; ++i) {
         Value *OpL = InstL->getOperand(i);
         Value *OpR = InstR->getOperand(i);
+        if (ConstantDiffs && OpL != OpR && isa<ConstantInt>(OpL) &&
+            isa<ConstantInt>(OpR) && OpL->getType() == OpR->getType() &&
+            canParameterizeOperand(*InstL, i)) {
+          ConstantDiffs->push_back({&*InstL, i, cast<ConstantInt>(OpR)});
+          continue;
+        }
         if (int Res = cmpValues(OpL, OpR))
           return Res;
         // cmpValues should ensure this is true.
@@ -881,6 +888,37 @@ int FunctionComparator::compare() {
   return 0;
 }
 
+int FunctionComparator::compareModuloConstants(
+    SmallVectorImpl<ConstantDiff> &Diffs) {
+  size_t OldSize = Diffs.size();
+  ConstantDiffs = &Diffs;
+  int Res = compare();
+  ConstantDiffs = nullptr;
+  if (Res)
+    Diffs.resize(OldSize);
+  return Res;
+}
+
+bool FunctionComparator::canParameterizeOperand(const Instruction &I,
+                                                unsigned OpNo) {
+  // Binary operators, comparisons and selects take any value of the right
+  // type, and so do the stored value and the returned value.
+  if (isa<BinaryOperator>(I) || isa<ICmpInst>(I) || isa<SelectInst>(I) ||
+      isa<ReturnInst>(I))
+    return true;
+  if (isa<StoreInst>(I))
+    return OpNo == 0;
+
+  // Arguments of calls, unless the callee requires an immediate. Intrinsics
+  // often do without saying so.
+  if (const auto *Call = dyn_cast<CallInst>(&I)) {
+    if (isa<IntrinsicInst>(Call) || OpNo >= Call->getNumArgOperands())
+      return false;
+    return !Call->paramHasAttr(OpNo, Attribute::ImmArg);
+  }
+  return false;
+}
+
 namespace {
 
 // Accumulate the hash of a sequence of 64-bit integers. This is similar to a
@@ -907,20 +945,49 @@ public:
 
 } // end anonymous namespace
 
-// A function hash is calculated by considering only the number of arguments and
-// whether a function is varargs, the order of basic blocks (given by the
-// successors of each basic block in depth first order), and the order of
-// opcodes of each instruction within each of these basic blocks. This mirrors
-// the strategy compare() uses to compare functions by walking the BBs in depth
-// first order and comparing each instruction in sequence. Because this hash
-// does not look at the operands, it is insensitive to things such as the
-// target of calls and the constants used in the function, which makes it useful
-// when possibly merging functions which are the same modulo constants and call
-// targets.
+// Hash the parts of a type that cmpTypes() looks at first. Pointers in address
+// space 0 compare equal to integers of the same width, so they hash that way.
+static void hashType(HashAccumulator64 &H, Type *Ty, const DataLayout &DL) {
+  if (auto *PTy = dyn_cast<PointerType>(Ty)) {
+    if (PTy->getAddressSpace() == 0) {
+      H.add(Type::IntegerTyID);
+      H.add(DL.getPointerSizeInBits(0));
+      return;
+    }
+    H.add(Type::PointerTyID);
+    H.add(PTy->getAddressSpace());
+    return;
+  }
+  H.add(Ty->getTypeID());
+  if (auto *ITy = dyn_cast<IntegerType>(Ty))
+    H.add(ITy->getBitWidth());
+  else if (auto *STy = dyn_cast<StructType>(Ty))
+    H.add(STy->getNumElements());
+  else if (auto *ATy = dyn_cast<ArrayType>(Ty))
+    H.add(ATy->getNumElements());
+  else if (auto *VTy = dyn_cast<VectorType>(Ty))
+    H.add(VTy->getNumElements());
+}
+
+// A function hash is calculated by considering the signature of the function,
+// the order of basic blocks (given by the successors of each basic block in
+// depth first order), and, for each instruction within each of these basic
+// blocks, its opcode, its type, the number and types of its operands and the
+// flags compare() checks. This mirrors the strategy compare() uses to compare
+// functions by walking the BBs in depth first order and comparing each
+// instruction in sequence. Because this hash does not look at the values of
+// the operands, it is insensitive to things such as the target of calls and
+// the constants used in the function, which makes it useful when possibly
+// merging functions which are the same modulo constants and call targets.
 FunctionComparator::FunctionHash FunctionComparator::functionHash(Function &F) {
+  const DataLayout &DL = F.getParent()->getDataLayout();
   HashAccumulator64 H;
   H.add(F.isVarArg());
   H.add(F.arg_size());
+  H.add(F.getCallingConv());
+  hashType(H, F.getReturnType(), DL);
+  for (const Argument &Arg : F.args())
+    hashType(H, Arg.getType(), DL);
 
   SmallVector<const BasicBlock *, 8> BBs;
   SmallPtrSet<const BasicBlock *, 16> VisitedBBs;
@@ -936,6 +1003,18 @@ FunctionComparator::FunctionHash FunctionComparator::functionHash(Function &F) {
     H.add(45798);
     for (auto &Inst : *BB) {
       H.add(Inst.getOpcode());
+      // GEPs are compared by the offset they compute, whatever the indices.
+      if (const auto *GEP = dyn_cast<GetElementPtrInst>(&Inst)) {
+        H.add(GEP->getPointerAddressSpace());
+        continue;
+      }
+      H.add(Inst.getNumOperands());
+      H.add(Inst.getRawSubclassOptionalData());
+      hashType(H, Inst.getType(), DL);
+      for (const Value *Op : Inst.operands())
+        hashType(H, Op->getType(), DL);
+      if (const auto *Cmp = dyn_cast<CmpInst>(&Inst))
+        H.add(Cmp->getPredicate());
     }
     const Instruction *Term = BB->getTerminator();
     for (unsigned i = 0, e = Term->getNumSuccessors(); i != e; ++i) {
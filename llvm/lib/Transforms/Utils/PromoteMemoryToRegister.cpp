@@ -290,7 +290,8 @@ private:
 
   void ComputeLiveInBlocks(AllocaInst *AI, AllocaInfo &Info,
                            const SmallPtrSetImpl<BasicBlock *> &DefBlocks,
-                           SmallPtrSetImpl<BasicBlock *> &LiveInBlocks);
+                           SmallPtrSetImpl<BasicBlock *> &LiveInBlocks,
+                           LargeBlockInfo &LBI);
   void RenamePass(BasicBlock *BB, BasicBlock *Pred,
                   RenamePassData::ValVector &IncVals,
                   RenamePassData::LocationVector &IncLocs,
@@ -607,7 +608,7 @@ void PromoteMem2Reg::run() {
     // Determine which blocks the value is live in.  These are blocks which lead
     // to uses.
     SmallPtrSet<BasicBlock *, 32> LiveInBlocks;
-    ComputeLiveInBlocks(AI, Info, DefBlocks, LiveInBlocks);
+    ComputeLiveInBlocks(AI, Info, DefBlocks, LiveInBlocks, LBI);
 
     // At this point, we're committed to promoting the alloca using IDF's, and
     // the standard SSA construction algorithm.  Determine which blocks need phi
@@ -773,13 +774,30 @@ void PromoteMem2Reg::run() {
 void PromoteMem2Reg::ComputeLiveInBlocks(
     AllocaInst *AI, AllocaInfo &Info,
     const SmallPtrSetImpl<BasicBlock *> &DefBlocks,
-    SmallPtrSetImpl<BasicBlock *> &LiveInBlocks) {
+    SmallPtrSetImpl<BasicBlock *> &LiveInBlocks, LargeBlockInfo &LBI) {
   // To determine liveness, we must iterate through the predecessors of blocks
   // where the def is live.  Blocks are added to the worklist if we need to
   // check their predecessors.  Start with all the using blocks.
   SmallVector<BasicBlock *, 64> LiveInBlockWorklist(Info.UsingBlocks.begin(),
                                                     Info.UsingBlocks.end());
 
+  // Find the first reference to the alloca in each definition block. Bucket
+  // the users by block once rather than scanning a block, or the users, for
+  // every block, which is quadratic when many allocas are used in one large
+  // block or one alloca is referenced from many blocks.
+  SmallDenseMap<BasicBlock *, std::pair<unsigned, Instruction *>, 32>
+      FirstRefInBlock;
+  for (User *U : AI->users()) {
+    Instruction *I = cast<Instruction>(U);
+    BasicBlock *BB = I->getParent();
+    if (!DefBlocks.count(BB))
+      continue;
+    unsigned Index = LBI.getInstructionIndex(I);
+    auto It = FirstRefInBlock.try_emplace(BB, Index, I).first;
+    if (Index < It->second.first)
+      It->second = {Index, I};
+  }
+
   // If any of the using blocks is also a definition block, check to see if the
   // definition occurs before or after the use.  If it happens before the use,
   // the value isn't really live-in.
@@ -790,25 +808,13 @@ void PromoteMem2Reg::ComputeLiveInBlocks(
 
     // Okay, this is a block that both uses and defines the value.  If the first
     // reference to the alloca is a def (store), then we know it isn't live-in.
-    for (BasicBlock::iterator I = BB->begin();; ++I) {
-      if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
-        if (SI->getOperand(1) != AI)
-          continue;
-
-        // We found a store to the alloca before a load.  The alloca is not
-        // actually live-in here.
-        LiveInBlockWorklist[i] = LiveInBlockWorklist.back();
-        LiveInBlockWorklist.pop_back();
-        --i;
-        --e;
-        break;
-      }
-
-      if (LoadInst *LI = dyn_cast<LoadInst>(I))
-        // Okay, we found a load before a store to the alloca.  It is actually
-        // live into this block.
-        if (LI->getOperand(0) == AI)
-          break;
+    if (isa<StoreInst>(FirstRefInBlock.lookup(BB).second)) {
+      // We found a store to the alloca before a load.  The alloca is not
+      // actually live-in here.
+      LiveInBlockWorklist[i] = LiveInBlockWorklist.back();
+      LiveInBlockWorklist.pop_back();
+      --i;
+      --e;
     }
   }
 
@@ -91,6 +91,15 @@ static void addAllGlobalValueUsers(ClusterMapType &GVtoClusterMap,
   }
 }
 
+// Returns the estimated cost of code generation for GV. Functions are
+// weighted by their instruction count, and everything else counts as a single
+// instruction.
+static uint64_t getCodeGenCost(const GlobalValue *GV) {
+  if (const auto *F = dyn_cast<Function>(GV))
+    return std::max<uint64_t>(F->getInstructionCount(), 1);
+  return 1;
+}
+
 // Find partitions for module in the way that no locals need to be
 // globalized.
 // Try to balance pack those partitions into N files since this roughly equals
@@ -112,10 +121,12 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
     if (!GV.hasName())
       GV.setName("__llvmsplit_unnamed");
 
-    // Comdat groups must not be partitioned. For comdat groups that contain
-    // locals, record all their members here so we can keep them together.
-    // Comdat groups that only contain external globals are already handled by
-    // the MD5-based partitioning.
+    // Every definition takes part in the balancing below, not only those that
+    // have to be kept together with others.
+    GVtoClusterMap.insert(&GV);
+
+    // Comdat groups must not be partitioned. Record all their members here so
+    // we can keep them together.
     if (const Comdat *C = GV.getComdat()) {
       auto &Member = ComdatMembers[C];
       if (Member)
@@ -148,37 +159,41 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   llvm::for_each(M->globals(), recordGVSet);
   llvm::for_each(M->aliases(), recordGVSet);
 
-  // Assigned all GVs to merged clusters while balancing number of objects in
-  // each.
-  auto CompareClusters = [](const std::pair<unsigned, unsigned> &a,
-                            const std::pair<unsigned, unsigned> &b) {
-    if (a.second || b.second)
+  // Assign all GVs to merged clusters while balancing the estimated codegen
+  // cost of each partition. Clusters are handed out largest first, each to
+  // the partition with the lowest cost so far.
+  auto CompareClusters = [](const std::pair<unsigned, uint64_t> &a,
+                            const std::pair<unsigned, uint64_t> &b) {
+    if (a.second != b.second)
       return a.second > b.second;
-    else
-      return a.first > b.first;
+    return a.first > b.first;
   };
 
-  std::priority_queue<std::pair<unsigned, unsigned>,
-                      std::vector<std::pair<unsigned, unsigned>>,
+  std::priority_queue<std::pair<unsigned, uint64_t>,
+                      std::vector<std::pair<unsigned, uint64_t>>,
                       decltype(CompareClusters)>
       BalancinQueue(CompareClusters);
   // Pre-populate priority queue with N slot blanks.
   for (unsigned i = 0; i < N; ++i)
     BalancinQueue.push(std::make_pair(i, 0));
 
-  using SortType = std::pair<unsigned, ClusterMapType::iterator>;
+  using SortType = std::pair<uint64_t, ClusterMapType::iterator>;
 
   SmallVector<SortType, 64> Sets;
   SmallPtrSet<const GlobalValue *, 32> Visited;
 
-  // To guarantee determinism, we have to sort SCC according to size.
-  // When size is the same, use leader's name.
+  // To guarantee determinism, we have to sort SCC according to cost.
+  // When cost is the same, use leader's name.
   for (ClusterMapType::iterator I = GVtoClusterMap.begin(),
-                                E = GVtoClusterMap.end(); I != E; ++I)
-    if (I->isLeader())
-      Sets.push_back(
-          std::make_pair(std::distance(GVtoClusterMap.member_begin(I),
-                                       GVtoClusterMap.member_end()), I));
+                                E = GVtoClusterMap.end(); I != E; ++I) {
+    if (!I->isLeader())
+      continue;
+    uint64_t Cost = 0;
+    for (ClusterMapType::member_iterator MI = GVtoClusterMap.member_begin(I);
+         MI != GVtoClusterMap.member_end(); ++MI)
+      Cost += getCodeGenCost(*MI);
+    Sets.push_back(std::make_pair(Cost, I));
+  }
 
   llvm::sort(Sets, [](const SortType &a, const SortType &b) {
     if (a.first == b.first)
@@ -189,10 +204,10 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
 
   for (auto &I : Sets) {
     unsigned CurrentClusterID = BalancinQueue.top().first;
-    unsigned CurrentClusterSize = BalancinQueue.top().second;
+    uint64_t CurrentClusterCost = BalancinQueue.top().second;
     BalancinQueue.pop();
 
-    LLVM_DEBUG(dbgs() << "Root[" << CurrentClusterID << "] cluster_size("
+    LLVM_DEBUG(dbgs() << "Root[" << CurrentClusterID << "] cluster_cost("
                       << I.first << ") ----> " << I.second->getData()->getName()
                       << "\n");
 
@@ -205,10 +220,10 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
                         << ((*MI)->hasLocalLinkage() ? " l " : " e ") << "\n");
       Visited.insert(*MI);
       ClusterIDMap[*MI] = CurrentClusterID;
-      CurrentClusterSize++;
+      CurrentClusterCost += getCodeGenCost(*MI);
     }
-    // Add this set size to the number of entries in this cluster.
-    BalancinQueue.push(std::make_pair(CurrentClusterID, CurrentClusterSize));
+    // Add this set's cost to the cost of this partition.
+    BalancinQueue.push(std::make_pair(CurrentClusterID, CurrentClusterCost));
   }
 }
 
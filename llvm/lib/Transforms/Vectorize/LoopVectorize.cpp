@@ -4985,10 +4985,23 @@ Optional<unsigned> LoopVectorizationCostModel::computeMaxVF() {
     return MaxVF;
   }
 
+  // Unless predication was asked for, prefer a smaller VF that leaves no tail
+  // over masking every vector iteration.
+  if (TC > 0 &&
+      ScalarEpilogueStatus != CM_ScalarEpilogueNotNeededUsePredicate) {
+    unsigned VF = MaxVF;
+    while (VF > 1 && TC % VF != 0)
+      VF /= 2;
+    if (VF > 1) {
+      LLVM_DEBUG(dbgs() << "LV: No tail will remain for VF " << VF
+                        << " or lower.\n");
+      return VF;
+    }
+  }
+
   // If we don't know the precise trip count, or if the trip count that we
   // found modulo the vectorization factor is not zero, try to fold the tail
   // by masking.
-  // FIXME: look for a smaller MaxVF that does divide TC rather than masking.
   if (Legal->prepareToFoldTailByMasking()) {
     FoldTailByMasking = true;
     return MaxVF;
@@ -6455,11 +6468,14 @@ void LoopVectorizationCostModel::collectValuesToIgnore() {
 // `buildVPlans(VF, VF)`. We cannot do it because VPLAN at the moment
 // doesn't have a cost model that can choose which plan to execute if
 // more than one is generated.
+//
+// Returns 1 if a vector register cannot hold two elements of the widest type.
 static unsigned determineVPlanVF(const unsigned WidestVectorRegBits,
                                  LoopVectorizationCostModel &CM) {
   unsigned WidestType;
   std::tie(std::ignore, WidestType) = CM.getSmallestAndWidestTypes();
-  return WidestVectorRegBits / WidestType;
+  unsigned VF = PowerOf2Floor(WidestVectorRegBits / WidestType);
+  return std::max(VF, 1u);
 }
 
 VectorizationFactor
@@ -6482,6 +6498,12 @@ LoopVectorizationPlanner::planInVPlanNativePath(unsigned UserVF) {
                           << "overriding computed VF.\n");
         VF = 4;
       }
+
+      if (VF < 2) {
+        LLVM_DEBUG(dbgs() << "LV: Not vectorizing: vector registers cannot "
+                             "hold two elements of the widest type.\n");
+        return VectorizationFactor::Disabled();
+      }
     }
     assert(EnableVPlanNativePath && "VPlan-native path is not enabled.");
     assert(isPowerOf2_32(VF) && "VF needs to be a power of two");
@@ -6760,10 +6782,14 @@ VPValue *VPRecipeBuilder::createBlockInMask(BasicBlock *BB, VPlanPtr &Plan) {
       return BlockMaskCache[BB] = BlockMask; // Loop incoming mask is all-one.
 
     // Introduce the early-exit compare IV <= BTC to form header block mask.
-    // This is used instead of IV < TC because TC may wrap, unlike BTC.
+    // This is used instead of IV < TC because TC may wrap, unlike BTC. Targets
+    // with a lane-mask instruction get the compare as one intrinsic call.
     VPValue *IV = Plan->getVPValue(Legal->getPrimaryInduction());
     VPValue *BTC = Plan->getOrCreateBackedgeTakenCount();
-    BlockMask = Builder.createNaryOp(VPInstruction::ICmpULE, {IV, BTC});
+    if (CM.TTI.emitGetActiveLaneMask())
+      BlockMask = Builder.createNaryOp(VPInstruction::ActiveLaneMask, {IV, BTC});
+    else
+      BlockMask = Builder.createNaryOp(VPInstruction::ICmpULE, {IV, BTC});
     return BlockMaskCache[BB] = BlockMask;
   }
 
@@ -333,6 +333,19 @@ void VPInstruction::generateInstruction(VPTransformState &State,
     State.set(this, V, Part);
     break;
   }
+  case VPInstruction::ActiveLaneMask: {
+    // Get first lane of vector induction variable.
+    Value *VIVElem0 = State.get(getOperand(0), {Part, 0});
+    // Get the backedge-taken count, which is a scalar.
+    Value *ScalarBTC = State.get(getOperand(1), {Part, 0});
+
+    auto *PredTy = VectorType::get(Builder.getInt1Ty(), State.VF);
+    Instruction *Call = Builder.CreateIntrinsic(
+        Intrinsic::get_active_lane_mask, {PredTy, ScalarBTC->getType()},
+        {VIVElem0, ScalarBTC}, nullptr, "active.lane.mask");
+    State.set(this, Call, Part);
+    break;
+  }
   case Instruction::Select: {
     Value *Cond = State.get(getOperand(0), Part);
     Value *Op1 = State.get(getOperand(1), Part);
@@ -372,6 +385,9 @@ void VPInstruction::print(raw_ostream &O) const {
   case VPInstruction::SLPLoad:
     O << "combined load";
     break;
+  case VPInstruction::ActiveLaneMask:
+    O << "active lane mask";
+    break;
   case VPInstruction::SLPStore:
     O << "combined store";
     break;
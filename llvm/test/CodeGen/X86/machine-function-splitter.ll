@@ -0,0 +1,101 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -split-machine-functions \
+; RUN:     | FileCheck %s --check-prefixes=CHECK,SHARED
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -split-machine-functions \
+; RUN:     -function-sections | FileCheck %s --check-prefixes=CHECK,UNIQUE
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu \
+; RUN:     | FileCheck %s --check-prefix=NOSPLIT
+
+; The cold block of @foo goes to a section of its own, and starts a local
+; @foo.cold symbol with a frame description of its own.
+
+; CHECK-LABEL: foo:
+; CHECK: .cfi_startproc
+; CHECK: pushq %rax
+; CHECK: .cfi_def_cfa_offset 16
+; CHECK: callq bar
+; CHECK: retq
+; CHECK-NOT: callq baz
+; CHECK: .Lfunc_end0:
+; CHECK-NEXT: .size foo, .Lfunc_end0-foo
+; CHECK-NEXT: .cfi_endproc
+; SHARED-NEXT: .section .text.split,"ax",@progbits
+; UNIQUE-NEXT: .section .text.split.foo,"ax",@progbits
+; CHECK: .type foo.cold,@function
+; CHECK-NEXT: foo.cold:
+; CHECK-NEXT: .cfi_startproc
+; CHECK-NEXT: .LBB0_{{[0-9]+}}:
+; CHECK-NEXT: .cfi_def_cfa %rsp, 16
+; CHECK: callq baz
+; CHECK: [[COLD_END:.Lcold_end[0-9]+]]:
+; CHECK-NEXT: .size foo.cold, [[COLD_END]]-foo.cold
+; CHECK-NEXT: .cfi_endproc
+
+; Functions that follow go back to the section they were in.
+; SHARED: .text{{$}}
+; UNIQUE: .section .text.qux,"ax",@progbits
+
+; NOSPLIT-NOT: .text.split
+; NOSPLIT-NOT: foo.cold
+
+define void @foo(i1 %c) !prof !14 {
+entry:
+  br i1 %c, label %cold, label %hot, !prof !15
+
+hot:
+  notail call void @bar()
+  ret void
+
+cold:
+  notail call void @baz()
+  ret void
+}
+
+; The name of a cold part doesn't clash with an existing symbol.
+
+; CHECK-LABEL: qux:
+; CHECK: .section .text.split
+; CHECK: .type qux.cold.1,@function
+; CHECK-NEXT: qux.cold.1:
+; CHECK: callq baz
+; CHECK: .size qux.cold.1,
+
+define void @qux(i1 %c) !prof !14 {
+entry:
+  br i1 %c, label %cold, label %hot, !prof !15
+
+hot:
+  notail call void @bar()
+  ret void
+
+cold:
+  notail call void @baz()
+  ret void
+}
+
+; CHECK-LABEL: qux.cold:
+; CHECK-NOT: .text.split
+define void @qux.cold() {
+  ret void
+}
+
+declare void @bar()
+declare void @baz()
+
+!llvm.module.flags = !{!0}
+
+!0 = !{i32 1, !"ProfileSummary", !1}
+!1 = !{!2, !3, !4, !5, !6, !7, !8, !9}
+!2 = !{!"ProfileFormat", !"InstrProf"}
+!3 = !{!"TotalCount", i64 10000}
+!4 = !{!"MaxCount", i64 1000}
+!5 = !{!"MaxInternalCount", i64 1}
+!6 = !{!"MaxFunctionCount", i64 1000}
+!7 = !{!"NumCounts", i64 3}
+!8 = !{!"NumFunctions", i64 3}
+!9 = !{!"DetailedSummary", !10}
+!10 = !{!11, !12, !13}
+!11 = !{i32 10000, i64 100, i32 1}
+!12 = !{i32 999000, i64 100, i32 1}
+!13 = !{i32 999999, i64 1, i32 2}
+!14 = !{!"function_entry_count", i64 1000}
+!15 = !{!"branch_weights", i32 0, i32 1000}
@@ -0,0 +1,108 @@
+; Test that -asan-opt-coalesce checks adjacent accesses of the same size with
+; one shadow check.
+; RUN: opt < %s -asan -asan-module -asan-opt-coalesce -S | FileCheck %s
+; RUN: opt < %s -asan -asan-module -S | FileCheck %s --check-prefix=NOCOALESCE
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Two 4-byte stores to the same aligned 8 bytes are one 8-byte check.
+define void @store_pair(i32* %p) sanitize_address {
+entry:
+  %q = getelementptr inbounds i32, i32* %p, i64 1
+  store i32 1, i32* %p, align 8
+  store i32 2, i32* %q, align 4
+  ret void
+}
+; CHECK-LABEL: @store_pair
+; CHECK: __asan_report_store8
+; CHECK-NOT: __asan_report
+; CHECK: store i32 1
+; CHECK-NOT: __asan_report
+; CHECK: ret void
+; NOCOALESCE-LABEL: @store_pair
+; NOCOALESCE: __asan_report_store4
+; NOCOALESCE: __asan_report_store4
+
+; Two 8-byte loads are one 16-byte check, which covers both granules.
+define i64 @load_pair(i64* %p) sanitize_address {
+entry:
+  %a = load i64, i64* %p, align 8
+  %q = getelementptr inbounds i64, i64* %p, i64 1
+  %b = load i64, i64* %q, align 8
+  %s = add i64 %a, %b
+  ret i64 %s
+}
+; CHECK-LABEL: @load_pair
+; CHECK: load i16, i16*
+; CHECK: __asan_report_load16
+; CHECK-NOT: __asan_report
+; CHECK: ret i64
+
+; A load and a store are checked as a store.
+define void @load_store(i32* %p) sanitize_address {
+entry:
+  %a = load i32, i32* %p, align 8
+  %q = getelementptr inbounds i32, i32* %p, i64 1
+  store i32 %a, i32* %q, align 4
+  ret void
+}
+; CHECK-LABEL: @load_store
+; CHECK: __asan_report_store8
+; CHECK-NOT: __asan_report
+; CHECK: ret void
+
+; The first access is not aligned to the combined size.
+define void @underaligned(i32* %p) sanitize_address {
+entry:
+  %q = getelementptr inbounds i32, i32* %p, i64 1
+  store i32 1, i32* %p, align 4
+  store i32 2, i32* %q, align 4
+  ret void
+}
+; CHECK-LABEL: @underaligned
+; CHECK: __asan_report_store4
+; CHECK: __asan_report_store4
+; CHECK: ret void
+
+; Only an access that follows the lower one in program order is coalesced.
+define void @descending(i32* %p) sanitize_address {
+entry:
+  %q = getelementptr inbounds i32, i32* %p, i64 1
+  store i32 2, i32* %q, align 4
+  store i32 1, i32* %p, align 8
+  ret void
+}
+; CHECK-LABEL: @descending
+; CHECK: __asan_report_store4
+; CHECK: __asan_report_store4
+; CHECK: ret void
+
+; A call may change the shadow between the two accesses.
+declare void @f()
+define void @call_between(i32* %p) sanitize_address {
+entry:
+  %q = getelementptr inbounds i32, i32* %p, i64 1
+  store i32 1, i32* %p, align 8
+  call void @f()
+  store i32 2, i32* %q, align 4
+  ret void
+}
+; CHECK-LABEL: @call_between
+; CHECK: __asan_report_store4
+; CHECK: __asan_report_store4
+; CHECK: ret void
+
+; Accesses of different sizes are not coalesced.
+define void @different_sizes(i32* %p) sanitize_address {
+entry:
+  %q = getelementptr inbounds i32, i32* %p, i64 1
+  %q16 = bitcast i32* %q to i16*
+  store i32 1, i32* %p, align 8
+  store i16 2, i16* %q16, align 4
+  ret void
+}
+; CHECK-LABEL: @different_sizes
+; CHECK: __asan_report_store4
+; CHECK: __asan_report_store2
+; CHECK: ret void
@@ -0,0 +1,31 @@
+;; Check that -instrprof-counter-alignment aligns the counters of each
+;; function, so that counters of different functions never share a cache line.
+
+; RUN: opt < %s -instrprof -S | FileCheck %s --check-prefix=DEFAULT
+; RUN: opt < %s -instrprof -instrprof-counter-alignment=64 -S | FileCheck %s --check-prefix=ALIGN64
+;; Alignments below 8 bytes and alignments that are not a power of two are
+;; rounded up.
+; RUN: opt < %s -instrprof -instrprof-counter-alignment=4 -S | FileCheck %s --check-prefix=DEFAULT
+; RUN: opt < %s -instrprof -instrprof-counter-alignment=48 -S | FileCheck %s --check-prefix=ALIGN64
+
+target triple = "x86_64-unknown-linux-gnu"
+
+@__profn_foo = private constant [3 x i8] c"foo"
+@__profn_bar = private constant [3 x i8] c"bar"
+
+; DEFAULT: @__profc_foo = private global [1 x i64] zeroinitializer, section "__llvm_prf_cnts", align 8
+; DEFAULT: @__profc_bar = private global [2 x i64] zeroinitializer, section "__llvm_prf_cnts", align 8
+; ALIGN64: @__profc_foo = private global [1 x i64] zeroinitializer, section "__llvm_prf_cnts", align 64
+; ALIGN64: @__profc_bar = private global [2 x i64] zeroinitializer, section "__llvm_prf_cnts", align 64
+
+define void @foo() {
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_foo, i32 0, i32 0), i64 0, i32 1, i32 0)
+  ret void
+}
+
+define void @bar() {
+  call void @llvm.instrprof.increment(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @__profn_bar, i32 0, i32 0), i64 0, i32 2, i32 0)
+  ret void
+}
+
+declare void @llvm.instrprof.increment(i8*, i64, i32, i32)
@@ -0,0 +1,37 @@
+; Check that multiversioning runs once, in the link-time pipeline, when
+; compiling for (Thin)LTO.
+
+; RUN: opt -disable-verify -debug-pass-manager -enable-multiversioning \
+; RUN:     -passes='lto<O2>' -S %s 2>&1 | FileCheck %s --check-prefix=FMV
+; RUN: opt -disable-verify -debug-pass-manager -enable-multiversioning \
+; RUN:     -passes='thinlto<O2>' -S %s 2>&1 | FileCheck %s --check-prefix=FMV
+; RUN: opt -disable-verify -debug-pass-manager -enable-multiversioning \
+; RUN:     -passes='lto-pre-link<O2>' -S %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=NOFMV
+; RUN: opt -disable-verify -debug-pass-manager -enable-multiversioning \
+; RUN:     -passes='thinlto-pre-link<O2>' -S %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=NOFMV
+; RUN: opt -disable-verify -debug-pass-manager -passes='lto<O2>' -S %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=NOFMV
+
+; RUN: opt -disable-verify -debug-pass=Structure -enable-multiversioning \
+; RUN:     -std-link-opts -S %s 2>&1 | FileCheck %s --check-prefix=LEGACY-FMV
+; RUN: opt -disable-verify -debug-pass=Structure -std-link-opts -S %s 2>&1 \
+; RUN:     | FileCheck %s --check-prefix=LEGACY-NOFMV
+
+; FMV: Running pass: PostOrderFunctionAttrsPass
+; FMV: Running pass: FunctionMultiVersioningPass
+; FMV-NOT: Running pass: FunctionMultiVersioningPass
+
+; NOFMV-NOT: Running pass: FunctionMultiVersioningPass
+
+; LEGACY-FMV: Dead Store Elimination
+; LEGACY-FMV: Multiversion functions with hot loops
+; LEGACY-FMV: Induction Variable Simplification
+; LEGACY-FMV-NOT: Multiversion functions with hot loops
+
+; LEGACY-NOFMV-NOT: Multiversion functions with hot loops
+
+define void @foo() {
+  ret void
+}
@@ -0,0 +1,90 @@
+; RUN: opt < %s -multiversioning -S | FileCheck %s
+; RUN: opt < %s -passes=multiversioning -S | FileCheck %s
+
+; Functions with a hot loop are cloned for each ISA level and dispatched
+; through an ifunc. Functions without one are left alone.
+
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: @hot = ifunc void (i32*, i64), void (i32*, i64)* ()* @hot.resolver
+; CHECK-NOT: ifunc
+
+; CHECK-LABEL: define internal void @hot.default(
+; CHECK-NOT: "target-features"
+define void @hot(i32* %p, i64 %n) !prof !14 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %gep = getelementptr inbounds i32, i32* %p, i64 %i
+  store i32 0, i32* %gep
+  %i.next = add nuw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop, !prof !15
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: define void @cold(
+define void @cold(i32* %p, i64 %n) !prof !16 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %gep = getelementptr inbounds i32, i32* %p, i64 %i
+  store i32 0, i32* %gep
+  %i.next = add nuw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop, !prof !17
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: define void @caller(
+; CHECK: call void @hot(
+define void @caller(i32* %p) {
+  call void @hot(i32* %p, i64 16)
+  ret void
+}
+
+; CHECK-LABEL: define internal void @hot.x86-64-v4(
+; CHECK-SAME: #[[V4:[0-9]+]]
+; CHECK-LABEL: define internal void @hot.x86-64-v3(
+; CHECK-SAME: #[[V3:[0-9]+]]
+
+; CHECK-LABEL: define internal void (i32*, i64)* @hot.resolver()
+; CHECK: call void @__cpu_indicator_init()
+; CHECK: load i32, i32* getelementptr inbounds ({ i32, i32, i32, [1 x i32] }, { i32, i32, i32, [1 x i32] }* @__cpu_model, i32 0, i32 3, i32 0)
+; CHECK-NOT: @__cpu_features2
+; CHECK: select i1 %{{.*}}, void (i32*, i64)* @hot.x86-64-v3, void (i32*, i64)* @hot.default
+; CHECK: select i1 %{{.*}}, void (i32*, i64)* @hot.x86-64-v4, void (i32*, i64)* %
+; CHECK: ret void (i32*, i64)* %
+
+; CHECK: attributes #[[V4]] = { "target-features"="+cmov,+popcnt,+sse3,+ssse3,+sse4.1,+sse4.2,+avx,+avx2,+bmi,+bmi2,+fma,+avx512f,+avx512bw,+avx512cd,+avx512dq,+avx512vl" }
+; CHECK: attributes #[[V3]] = { "target-features"="+cmov,+popcnt,+sse3,+ssse3,+sse4.1,+sse4.2,+avx,+avx2,+bmi,+bmi2,+fma" }
+
+!llvm.module.flags = !{!0}
+
+!0 = !{i32 1, !"ProfileSummary", !1}
+!1 = !{!2, !3, !4, !5, !6, !7, !8, !9}
+!2 = !{!"ProfileFormat", !"InstrProf"}
+!3 = !{!"TotalCount", i64 10000}
+!4 = !{!"MaxCount", i64 1000}
+!5 = !{!"MaxInternalCount", i64 1}
+!6 = !{!"MaxFunctionCount", i64 1000}
+!7 = !{!"NumCounts", i64 3}
+!8 = !{!"NumFunctions", i64 3}
+!9 = !{!"DetailedSummary", !10}
+!10 = !{!11, !12, !13}
+!11 = !{i32 10000, i64 100, i32 1}
+!12 = !{i32 999000, i64 100, i32 1}
+!13 = !{i32 999999, i64 1, i32 2}
+!14 = !{!"function_entry_count", i64 100}
+!15 = !{!"branch_weights", i32 1, i32 1000}
+!16 = !{!"function_entry_count", i64 1}
+!17 = !{!"branch_weights", i32 1, i32 1}
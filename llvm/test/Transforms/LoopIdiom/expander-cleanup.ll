@@ -0,0 +1,30 @@
+; RUN: opt < %s -loop-idiom -S | FileCheck %s
+
+; The base pointers and the size of the copy are expanded in the preheader
+; before loop-idiom finds out that the under-aligned atomics cannot become an
+; element-wise atomic memcpy. The expanded code is removed again.
+
+; CHECK-LABEL: @underaligned_atomic(
+; CHECK-NEXT:  entry:
+; CHECK-NEXT:    br label %for.body
+; CHECK-NOT:     memcpy
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+define void @underaligned_atomic(i32* noalias %dst, i32* noalias %src, i64 %n) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %i.off = add nuw nsw i64 %i, 1
+  %src.addr = getelementptr inbounds i32, i32* %src, i64 %i.off
+  %dst.addr = getelementptr inbounds i32, i32* %dst, i64 %i.off
+  %val = load atomic i32, i32* %src.addr unordered, align 2
+  store atomic i32 %val, i32* %dst.addr unordered, align 2
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, %n
+  br i1 %exitcond, label %exit, label %for.body
+
+exit:
+  ret void
+}
@@ -0,0 +1,62 @@
+; RUN: opt < %s -loop-interchange -cache-line-size=64 -S | FileCheck %s
+; RUN: opt < %s -loop-interchange -cache-line-size=64 \
+; RUN:     -loop-interchange-cache-cost=false -S \
+; RUN:   | FileCheck %s --check-prefix=NOCACHECOST
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+;; for (j = 0; j < n; j++)
+;;   for (i = 0; i < n; i++)
+;;     A[i * n + j] += 1;
+;;
+;; The access is only strided once it is delinearized, which the cache cost
+;; model does and the instruction order cost does not.
+
+; CHECK-LABEL: @interchange_delinearized(
+; CHECK:         br i1 %cmp, label %for.i.header.preheader, label %exit
+; CHECK:       for.i.header:
+; CHECK-NEXT:    %i = phi i64 [ %0, %for.i.header.split ], [ 0, %for.i.header.preheader ]
+; CHECK-NEXT:    br label %for.j.preheader
+; CHECK:       for.j.latch:
+; CHECK:         br i1 %exitcond.j, label %for.i.header.split, label %for.j.header
+
+; NOCACHECOST-LABEL: @interchange_delinearized(
+; NOCACHECOST:       for.j.header:
+; NOCACHECOST-NEXT:    %j = phi i64 [ %j.next, %for.j.latch ], [ 0, %for.j.preheader ]
+; NOCACHECOST-NEXT:    br label %for.i.header
+
+define void @interchange_delinearized(i32* noalias %A, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.j.preheader, label %exit
+
+for.j.preheader:
+  br label %for.j.header
+
+for.j.header:
+  %j = phi i64 [ %j.next, %for.j.latch ], [ 0, %for.j.preheader ]
+  br label %for.i.header
+
+for.i.header:
+  %i = phi i64 [ 0, %for.j.header ], [ %i.next, %for.i.header ]
+  %mul = mul nsw i64 %i, %n
+  %idx = add nsw i64 %mul, %j
+  %arrayidx = getelementptr inbounds i32, i32* %A, i64 %idx
+  %val = load i32, i32* %arrayidx
+  %add = add nsw i32 %val, 1
+  store i32 %add, i32* %arrayidx
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond.i = icmp eq i64 %i.next, %n
+  br i1 %exitcond.i, label %for.j.latch, label %for.i.header
+
+for.j.latch:
+  %j.next = add nuw nsw i64 %j, 1
+  %exitcond.j = icmp eq i64 %j.next, %n
+  br i1 %exitcond.j, label %exit.loopexit, label %for.j.header
+
+exit.loopexit:
+  br label %exit
+
+exit:
+  ret void
+}
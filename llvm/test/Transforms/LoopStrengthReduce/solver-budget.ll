@@ -0,0 +1,49 @@
+; RUN: opt < %s -loop-reduce -S | FileCheck %s
+; RUN: opt < %s -loop-reduce -lsr-solver-budget=1 -S | FileCheck %s
+; RUN: opt < %s -loop-reduce -pass-remarks-analysis=loop-reduce \
+; RUN:     -disable-output 2>&1 | FileCheck %s --check-prefix=REMARK
+; RUN: opt < %s -loop-reduce -lsr-solver-budget=1 \
+; RUN:     -pass-remarks-analysis=loop-reduce -disable-output 2>&1 \
+; RUN:     | FileCheck %s --check-prefixes=BUDGET,REMARK
+
+; Once the solver has rated as many formulae as its budget allows, it
+; completes the solution greedily. Here that still finds the best solution:
+; one pointer induction variable per access and a count down to zero.
+
+target datalayout = "e-m:e-i64:64-n32:64"
+
+; BUDGET: remark: <unknown>:0:0: stopped searching for induction variable formulae after rating 1 of them
+; REMARK-NOT: stopped searching
+; REMARK: remark: <unknown>:0:0: chose formulae for 3 induction variable uses requiring 3 registers, 0 multiplies and 0 base adds
+
+; CHECK-LABEL: define void @f(
+; CHECK: loop:
+; CHECK-NEXT: %lsr.iv2 = phi i32* [ %scevgep3, %loop ], [ %a, %entry ]
+; CHECK-NEXT: %lsr.iv1 = phi i32* [ %scevgep, %loop ], [ %b, %entry ]
+; CHECK-NEXT: %lsr.iv = phi i64 [ %lsr.iv.next, %loop ], [ %n, %entry ]
+; CHECK-NEXT: %va = load i32, i32* %lsr.iv2
+; CHECK-NEXT: store i32 %va, i32* %lsr.iv1
+; CHECK-NEXT: %lsr.iv.next = add i64 %lsr.iv, -1
+; CHECK-NEXT: %scevgep = getelementptr i32, i32* %lsr.iv1, i64 3
+; CHECK-NEXT: %scevgep3 = getelementptr i32, i32* %lsr.iv2, i64 2
+; CHECK-NEXT: %done = icmp eq i64 %lsr.iv.next, 0
+; CHECK-NEXT: br i1 %done, label %exit, label %loop
+define void @f(i32* %a, i32* %b, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %i2 = shl i64 %i, 1
+  %i3 = mul i64 %i, 3
+  %pa = getelementptr inbounds i32, i32* %a, i64 %i2
+  %pb = getelementptr inbounds i32, i32* %b, i64 %i3
+  %va = load i32, i32* %pa
+  store i32 %va, i32* %pb
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
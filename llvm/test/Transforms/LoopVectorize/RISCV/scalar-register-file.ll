@@ -0,0 +1,31 @@
+; RUN: opt < %s -loop-vectorize -mtriple=riscv32 -S | FileCheck %s
+; RUN: opt < %s -loop-vectorize -mtriple=riscv64 -S | FileCheck %s
+
+; There are no vector registers without the V extension, so the loop stays
+; scalar instead of being vectorized and scalarized again by type
+; legalization.
+
+; CHECK-LABEL: @add_i8(
+; CHECK-NOT: <{{[0-9]+}} x i8>
+; CHECK: add i8
+; CHECK-NOT: <{{[0-9]+}} x i8>
+; CHECK: ret void
+define void @add_i8(i8* noalias %a, i8* noalias %b, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = getelementptr inbounds i8, i8* %a, i64 %i
+  %pb = getelementptr inbounds i8, i8* %b, i64 %i
+  %va = load i8, i8* %pa, align 1
+  %vb = load i8, i8* %pb, align 1
+  %sum = add i8 %va, %vb
+  store i8 %sum, i8* %pa, align 1
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
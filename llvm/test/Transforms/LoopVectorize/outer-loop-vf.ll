@@ -0,0 +1,79 @@
+; RUN: opt < %s -loop-vectorize -enable-vplan-native-path -S | FileCheck %s
+
+; Without a target, vector registers are 32 bits wide and cannot hold two
+; i64 elements, so the VPlan-native path must not pick a VF for the outer
+; loop on its own. A VF given by the user is still used.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; CHECK-LABEL: @no_vector_registers(
+; CHECK-NOT:     <{{[0-9]+}} x i64>
+; CHECK:         ret void
+
+define void @no_vector_registers(i64* noalias %a, i64* noalias %b, i64 %n) {
+entry:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %a.i = getelementptr inbounds i64, i64* %a, i64 %i
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer.header ], [ %j.next, %inner ]
+  %b.j = getelementptr inbounds i64, i64* %b, i64 %j
+  %v = load i64, i64* %b.j
+  %acc = load i64, i64* %a.i
+  %sum = add i64 %acc, %v
+  store i64 %sum, i64* %a.i
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.done = icmp eq i64 %j.next, 8
+  br i1 %inner.done, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.done = icmp eq i64 %i.next, %n
+  br i1 %outer.done, label %exit, label %outer.header, !llvm.loop !0
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: @user_vf(
+; CHECK:       vector.body:
+; CHECK:         %[[PTRS:.*]] = getelementptr inbounds i64, i64* %a, <4 x i64>
+; CHECK:         call <4 x i64> @llvm.masked.gather.v4i64.v4p0i64(<4 x i64*> %[[PTRS]]
+
+define void @user_vf(i64* noalias %a, i64* noalias %b, i64 %n) {
+entry:
+  br label %outer.header
+
+outer.header:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %a.i = getelementptr inbounds i64, i64* %a, i64 %i
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer.header ], [ %j.next, %inner ]
+  %b.j = getelementptr inbounds i64, i64* %b, i64 %j
+  %v = load i64, i64* %b.j
+  %acc = load i64, i64* %a.i
+  %sum = add i64 %acc, %v
+  store i64 %sum, i64* %a.i
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.done = icmp eq i64 %j.next, 8
+  br i1 %inner.done, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.done = icmp eq i64 %i.next, %n
+  br i1 %outer.done, label %exit, label %outer.header, !llvm.loop !2
+
+exit:
+  ret void
+}
+
+!0 = distinct !{!0, !1}
+!1 = !{!"llvm.loop.vectorize.enable", i1 true}
+!2 = distinct !{!2, !1, !3}
+!3 = !{!"llvm.loop.vectorize.width", i32 4}
@@ -0,0 +1,58 @@
+; RUN: opt < %s -loop-vectorize -S | FileCheck %s
+
+; Loops with a tiny trip count are only vectorized if no scalar iterations
+; remain. Without a target, vector registers hold four i8 elements. A trip
+; count of 6 is vectorized with a VF of 2, which leaves no tail, instead of
+; masking a VF of 4.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; CHECK-LABEL: @tc6(
+; CHECK:       vector.body:
+; CHECK:         %wide.load = load <2 x i8>
+; CHECK:         %[[ADD:.*]] = add <2 x i8> %wide.load, <i8 1, i8 1>
+; CHECK:         store <2 x i8> %[[ADD]]
+; CHECK:         icmp eq i64 %index.next, 6
+
+define void @tc6(i8* noalias %a, i8* noalias %b) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %b.i = getelementptr inbounds i8, i8* %b, i64 %i
+  %v = load i8, i8* %b.i
+  %add = add i8 %v, 1
+  %a.i = getelementptr inbounds i8, i8* %a, i64 %i
+  store i8 %add, i8* %a.i
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, 6
+  br i1 %done, label %exit, label %for.body
+
+exit:
+  ret void
+}
+
+; A trip count of 5 has no such VF.
+; CHECK-LABEL: @tc5(
+; CHECK-NOT:     vector.body:
+; CHECK:         ret void
+
+define void @tc5(i8* noalias %a, i8* noalias %b) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %b.i = getelementptr inbounds i8, i8* %b, i64 %i
+  %v = load i8, i8* %b.i
+  %add = add i8 %v, 1
+  %a.i = getelementptr inbounds i8, i8* %a, i64 %i
+  store i8 %add, i8* %a.i
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, 5
+  br i1 %done, label %exit, label %for.body
+
+exit:
+  ret void
+}
@@ -0,0 +1,91 @@
+; RUN: opt -lower-matrix-intrinsics -force-fuse-matrix -fuse-matrix-tile-size=2 -S < %s | FileCheck %s
+
+; A multiply of loaded matrices whose result is stored is lowered one 2 x 2
+; tile of the result at a time. Each tile only loads the tiles of the
+; operands it needs and accumulates across them.
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+define void @multiply(<8 x double>* noalias %A, <8 x double>* noalias %B, <4 x double>* noalias %C) {
+; CHECK-LABEL: @multiply(
+; CHECK-NEXT:  entry:
+; CHECK-NEXT:    [[A:%.*]] = bitcast <8 x double>* %A to double*
+; CHECK-NEXT:    [[B:%.*]] = bitcast <8 x double>* %B to double*
+; CHECK-NEXT:    [[C:%.*]] = bitcast <4 x double>* %C to double*
+
+; The tile of %A in rows 0-1 and columns 0-1 and the tile of %B in rows 0-1
+; and columns 0-1.
+; CHECK-NEXT:    [[A_TILE0:%.*]] = getelementptr double, double* [[A]], i32 0
+; CHECK-NEXT:    [[CAST:%.*]] = bitcast double* [[A_TILE0]] to <2 x double>*
+; CHECK-NEXT:    load <2 x double>, <2 x double>* [[CAST]], align 8
+; CHECK-NEXT:    [[GEP:%.*]] = getelementptr double, double* [[A_TILE0]], i32 2
+; CHECK-NEXT:    [[CAST:%.*]] = bitcast double* [[GEP]] to <2 x double>*
+; CHECK-NEXT:    load <2 x double>, <2 x double>* [[CAST]], align 8
+; CHECK-NEXT:    [[B_TILE0:%.*]] = getelementptr double, double* [[B]], i32 0
+; CHECK-NEXT:    [[CAST:%.*]] = bitcast double* [[B_TILE0]] to <2 x double>*
+; CHECK-NEXT:    load <2 x double>, <2 x double>* [[CAST]], align 8
+; CHECK-NEXT:    [[GEP:%.*]] = getelementptr double, double* [[B_TILE0]], i32 4
+; CHECK-NEXT:    [[CAST:%.*]] = bitcast double* [[GEP]] to <2 x double>*
+; CHECK-NEXT:    load <2 x double>, <2 x double>* [[CAST]], align 8
+; CHECK:         [[RES0_COL1:%.*]] = shufflevector <2 x double> {{.*}}, <2 x double> {{.*}}, <2 x i32> <i32 0, i32 2>
+
+; The tile of %A in columns 2-3 and the tile of %B in rows 2-3. The products
+; are added to the result of the first tile.
+; CHECK:         [[A_TILE1:%.*]] = getelementptr double, double* [[A]], i32 4
+; CHECK:         [[B_TILE1:%.*]] = getelementptr double, double* [[B]], i32 2
+; CHECK:         [[GEP:%.*]] = getelementptr double, double* [[B_TILE1]], i32 4
+; CHECK-NEXT:    [[CAST:%.*]] = bitcast double* [[GEP]] to <2 x double>*
+; CHECK-NEXT:    load <2 x double>, <2 x double>* [[CAST]], align 8
+; CHECK-NEXT:    shufflevector <2 x double> {{%.*}}, <2 x double> undef, <1 x i32> zeroinitializer
+; CHECK:         [[RES1_COL0:%.*]] = shufflevector <2 x double> {{.*}}, <2 x double> {{.*}}, <2 x i32> <i32 0, i32 2>
+; CHECK:         [[RES1_COL1:%.*]] = shufflevector <2 x double> {{.*}}, <2 x double> {{.*}}, <2 x i32> <i32 0, i32 2>
+
+; The result tile is stored to %C.
+; CHECK-NEXT:    [[C_TILE:%.*]] = getelementptr double, double* [[C]], i32 0
+; CHECK-NEXT:    [[CAST:%.*]] = bitcast double* [[C_TILE]] to <2 x double>*
+; CHECK-NEXT:    store <2 x double> [[RES1_COL0]], <2 x double>* [[CAST]], align 8
+; CHECK-NEXT:    [[GEP:%.*]] = getelementptr double, double* [[C_TILE]], i32 2
+; CHECK-NEXT:    [[CAST:%.*]] = bitcast double* [[GEP]] to <2 x double>*
+; CHECK-NEXT:    store <2 x double> [[RES1_COL1]], <2 x double>* [[CAST]], align 8
+; CHECK-NEXT:    ret void
+;
+entry:
+  %a = load <8 x double>, <8 x double>* %A, align 8
+  %b = load <8 x double>, <8 x double>* %B, align 8
+  %c = call <4 x double> @llvm.matrix.multiply.v4f64.v8f64.v8f64(<8 x double> %a, <8 x double> %b, i32 2, i32 4, i32 2)
+  store <4 x double> %c, <4 x double>* %C, align 8
+  ret void
+}
+
+; The result may overwrite the operands while tiles are stored, so the
+; multiply is lowered in one piece.
+define void @may_alias(<8 x double>* %A, <8 x double>* %B, <4 x double>* %C) {
+; CHECK-LABEL: @may_alias(
+; CHECK-NOT:     tile.start
+; CHECK:         ret void
+;
+entry:
+  %a = load <8 x double>, <8 x double>* %A, align 8
+  %b = load <8 x double>, <8 x double>* %B, align 8
+  %c = call <4 x double> @llvm.matrix.multiply.v4f64.v8f64.v8f64(<8 x double> %a, <8 x double> %b, i32 2, i32 4, i32 2)
+  store <4 x double> %c, <4 x double>* %C, align 8
+  ret void
+}
+
+; %A is written after it is loaded, so its tiles cannot be loaded at the
+; store of the result.
+define void @clobbered_operand(<8 x double>* noalias %A, <8 x double>* noalias %B, <4 x double>* noalias %C) {
+; CHECK-LABEL: @clobbered_operand(
+; CHECK-NOT:     tile.start
+; CHECK:         ret void
+;
+entry:
+  %a = load <8 x double>, <8 x double>* %A, align 8
+  %b = load <8 x double>, <8 x double>* %B, align 8
+  store <8 x double> zeroinitializer, <8 x double>* %A, align 8
+  %c = call <4 x double> @llvm.matrix.multiply.v4f64.v8f64.v8f64(<8 x double> %a, <8 x double> %b, i32 2, i32 4, i32 2)
+  store <4 x double> %c, <4 x double>* %C, align 8
+  ret void
+}
+
+declare <4 x double> @llvm.matrix.multiply.v4f64.v8f64.v8f64(<8 x double>, <8 x double>, i32, i32, i32)
@@ -0,0 +1,50 @@
+; RUN: opt -S -mergefunc -mergefunc-parameterize-constants < %s | FileCheck %s
+; RUN: opt -S -mergefunc < %s | FileCheck %s --check-prefix=NOPARAM
+
+; @a and @b only differ in the multiplier. They share one body that takes the
+; multiplier as an extra parameter, and become thunks passing their own. The
+; callers keep calling the thunks.
+
+; CHECK-LABEL: define i32 @caller(
+; CHECK-NEXT: %a = call i32 @a(i32 %x, i32 1)
+; CHECK-NEXT: %b = call i32 @b(i32 %x, i32 2)
+
+; CHECK-LABEL: define internal i32 @a.merged(i32 %x, i32 %y, i32 %0) unnamed_addr
+; CHECK-NEXT: %m = mul i32 %x, %0
+; CHECK-NEXT: %s = add i32 %m, %y
+; CHECK-NEXT: %t = xor i32 %s, 255
+; CHECK-NEXT: %r = sub i32 %t, %x
+; CHECK-NEXT: ret i32 %r
+
+; CHECK-LABEL: define i32 @a(i32 %0, i32 %1)
+; CHECK-NEXT: %3 = tail call i32 @a.merged(i32 %0, i32 %1, i32 3)
+; CHECK-NEXT: ret i32 %3
+
+; CHECK-LABEL: define i32 @b(i32 %0, i32 %1)
+; CHECK-NEXT: %3 = tail call i32 @a.merged(i32 %0, i32 %1, i32 5)
+; CHECK-NEXT: ret i32 %3
+
+; NOPARAM-NOT: .merged
+
+define i32 @a(i32 %x, i32 %y) {
+  %m = mul i32 %x, 3
+  %s = add i32 %m, %y
+  %t = xor i32 %s, 255
+  %r = sub i32 %t, %x
+  ret i32 %r
+}
+
+define i32 @b(i32 %x, i32 %y) {
+  %m = mul i32 %x, 5
+  %s = add i32 %m, %y
+  %t = xor i32 %s, 255
+  %r = sub i32 %t, %x
+  ret i32 %r
+}
+
+define i32 @caller(i32 %x) {
+  %a = call i32 @a(i32 %x, i32 1)
+  %b = call i32 @b(i32 %x, i32 2)
+  %r = add i32 %a, %b
+  ret i32 %r
+}
@@ -0,0 +1,107 @@
+; RUN: opt -openmpopt -S < %s | FileCheck %s
+; RUN: opt -passes=openmpopt -S < %s | FileCheck %s
+;
+; Runtime calls are only moved to the function entry when that removes a
+; duplicate or takes a call out of a loop.
+
+declare i32 @omp_get_level()
+declare i32 @omp_get_team_size(i32)
+declare void @use(i32)
+
+; Two calls with the same arguments: the first is hoisted and replaces the
+; second.
+define void @dedup(i1 %c) {
+; CHECK-LABEL: define void @dedup(
+; CHECK-NEXT:  entry:
+; CHECK-NEXT:    [[LEVEL:%.*]] = call i32 @omp_get_level()
+; CHECK-NEXT:    br i1 %c, label %then, label %exit
+; CHECK:       then:
+; CHECK-NEXT:    call void @use(i32 [[LEVEL]])
+; CHECK-NEXT:    br label %exit
+; CHECK:       exit:
+; CHECK-NEXT:    call void @use(i32 [[LEVEL]])
+; CHECK-NEXT:    ret void
+entry:
+  br i1 %c, label %then, label %exit
+
+then:
+  %l0 = call i32 @omp_get_level()
+  call void @use(i32 %l0)
+  br label %exit
+
+exit:
+  %l1 = call i32 @omp_get_level()
+  call void @use(i32 %l1)
+  ret void
+}
+
+; Two calls with different arguments are not duplicates, so neither is moved.
+define void @no_duplicate(i1 %c) {
+; CHECK-LABEL: define void @no_duplicate(
+; CHECK-NEXT:  entry:
+; CHECK-NEXT:    br i1 %c, label %then, label %exit
+; CHECK:       then:
+; CHECK-NEXT:    [[S1:%.*]] = call i32 @omp_get_team_size(i32 1)
+; CHECK-NEXT:    call void @use(i32 [[S1]])
+; CHECK-NEXT:    [[S2:%.*]] = call i32 @omp_get_team_size(i32 2)
+; CHECK-NEXT:    call void @use(i32 [[S2]])
+; CHECK-NEXT:    br label %exit
+; CHECK:       exit:
+; CHECK-NEXT:    ret void
+entry:
+  br i1 %c, label %then, label %exit
+
+then:
+  %s1 = call i32 @omp_get_team_size(i32 1)
+  call void @use(i32 %s1)
+  %s2 = call i32 @omp_get_team_size(i32 2)
+  call void @use(i32 %s2)
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A single call outside of a loop stays where it is.
+define void @single_call(i1 %c) {
+; CHECK-LABEL: define void @single_call(
+; CHECK-NEXT:  entry:
+; CHECK-NEXT:    br i1 %c, label %then, label %exit
+; CHECK:       then:
+; CHECK-NEXT:    [[LEVEL:%.*]] = call i32 @omp_get_level()
+; CHECK-NEXT:    call void @use(i32 [[LEVEL]])
+entry:
+  br i1 %c, label %then, label %exit
+
+then:
+  %l = call i32 @omp_get_level()
+  call void @use(i32 %l)
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A single call in a loop is hoisted out of it.
+define void @single_call_in_loop(i32 %n) {
+; CHECK-LABEL: define void @single_call_in_loop(
+; CHECK-NEXT:  entry:
+; CHECK-NEXT:    [[LEVEL:%.*]] = call i32 @omp_get_level()
+; CHECK-NEXT:    br label %loop
+; CHECK:       loop:
+; CHECK-NEXT:    %i = phi i32
+; CHECK-NEXT:    call void @use(i32 [[LEVEL]])
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %l = call i32 @omp_get_level()
+  call void @use(i32 %l)
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,37 @@
+; RUN: opt < %s -slp-vectorizer -mtriple=riscv32 -S | FileCheck %s
+; RUN: opt < %s -slp-vectorizer -mtriple=riscv64 -S | FileCheck %s
+
+; There are no vector registers without the V extension, so the adjacent
+; adds stay scalar.
+
+; CHECK-LABEL: @add_i16x4(
+; CHECK-NOT: <{{[0-9]+}} x i16>
+; CHECK-COUNT-4: add i16
+; CHECK-NOT: <{{[0-9]+}} x i16>
+; CHECK: ret void
+define void @add_i16x4(i16* noalias %a, i16* noalias %b) {
+entry:
+  %a1 = getelementptr inbounds i16, i16* %a, i64 1
+  %a2 = getelementptr inbounds i16, i16* %a, i64 2
+  %a3 = getelementptr inbounds i16, i16* %a, i64 3
+  %b1 = getelementptr inbounds i16, i16* %b, i64 1
+  %b2 = getelementptr inbounds i16, i16* %b, i64 2
+  %b3 = getelementptr inbounds i16, i16* %b, i64 3
+  %va0 = load i16, i16* %a, align 2
+  %va1 = load i16, i16* %a1, align 2
+  %va2 = load i16, i16* %a2, align 2
+  %va3 = load i16, i16* %a3, align 2
+  %vb0 = load i16, i16* %b, align 2
+  %vb1 = load i16, i16* %b1, align 2
+  %vb2 = load i16, i16* %b2, align 2
+  %vb3 = load i16, i16* %b3, align 2
+  %s0 = add i16 %va0, %vb0
+  %s1 = add i16 %va1, %vb1
+  %s2 = add i16 %va2, %vb2
+  %s3 = add i16 %va3, %vb3
+  store i16 %s0, i16* %a, align 2
+  store i16 %s1, i16* %a1, align 2
+  store i16 %s2, i16* %a2, align 2
+  store i16 %s3, i16* %a3, align 2
+  ret void
+}
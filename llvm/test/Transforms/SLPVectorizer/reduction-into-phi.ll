@@ -0,0 +1,73 @@
+; RUN: opt < %s -slp-vectorizer -S | FileCheck %s
+
+; The reduction is only used by a PHI in another block. It is found by
+; starting from the incoming values of the PHI.
+
+; CHECK-LABEL: @reduction_into_phi(
+; CHECK:       sum:
+; CHECK:         %[[VEC:.*]] = load <4 x i32>
+; CHECK:         %bin.rdx = add <4 x i32> %[[VEC]], %rdx.shuf
+; CHECK:         %[[RDX:.*]] = extractelement <4 x i32> %bin.rdx2, i32 0
+; CHECK-NEXT:    br label %exit
+; CHECK:       exit:
+; CHECK-NEXT:    %r = phi i32 [ %[[RDX]], %sum ], [ 0, %entry ]
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+define i32 @reduction_into_phi(i32* %p, i1 %c) {
+entry:
+  br i1 %c, label %sum, label %exit
+
+sum:
+  %p1 = getelementptr inbounds i32, i32* %p, i64 1
+  %p2 = getelementptr inbounds i32, i32* %p, i64 2
+  %p3 = getelementptr inbounds i32, i32* %p, i64 3
+  %l0 = load i32, i32* %p, align 4
+  %l1 = load i32, i32* %p1, align 4
+  %l2 = load i32, i32* %p2, align 4
+  %l3 = load i32, i32* %p3, align 4
+  %a0 = add i32 %l1, %l0
+  %a1 = add i32 %a0, %l2
+  %a2 = add i32 %a1, %l3
+  br label %exit
+
+exit:
+  %r = phi i32 [ %a2, %sum ], [ 0, %entry ]
+  ret i32 %r
+}
+
+; PHIs with more than two incoming values used to end the search in their
+; block.
+; CHECK-LABEL: @reduction_into_phi3(
+; CHECK:       sum:
+; CHECK:         load <4 x i32>
+; CHECK:       exit:
+; CHECK-NEXT:    %r = phi i32 [ %{{.*}}, %sum ], [ 0, %entry ], [ 1, %other ]
+
+define i32 @reduction_into_phi3(i32* %p, i32 %k) {
+entry:
+  switch i32 %k, label %exit [
+    i32 0, label %sum
+    i32 1, label %other
+  ]
+
+other:
+  br label %exit
+
+sum:
+  %p1 = getelementptr inbounds i32, i32* %p, i64 1
+  %p2 = getelementptr inbounds i32, i32* %p, i64 2
+  %p3 = getelementptr inbounds i32, i32* %p, i64 3
+  %l0 = load i32, i32* %p, align 4
+  %l1 = load i32, i32* %p1, align 4
+  %l2 = load i32, i32* %p2, align 4
+  %l3 = load i32, i32* %p3, align 4
+  %a0 = add i32 %l1, %l0
+  %a1 = add i32 %a0, %l2
+  %a2 = add i32 %a1, %l3
+  br label %exit
+
+exit:
+  %r = phi i32 [ %a2, %sum ], [ 0, %entry ], [ 1, %other ]
+  ret i32 %r
+}
@@ -48,6 +48,9 @@ struct LinkOptions {
   /// Number of threads.
   unsigned Threads = 1;
 
+  /// Maximum number of object files whose DIEs are extracted at once.
+  unsigned MaxObjectsInFlight = 0;
+
   // Output file type.
   OutputFileType FileType = OutputFileType::Object;
 
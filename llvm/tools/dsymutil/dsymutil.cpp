@@ -263,6 +263,9 @@ static Expected<DsymutilOptions> getOptions(opt::InputArgList &Args) {
   if (Options.DumpDebugMap || Options.LinkOpts.Verbose)
     Options.LinkOpts.Threads = 1;
 
+  if (opt::Arg *MaxObjects = Args.getLastArg(OPT_max_objects_in_flight))
+    Options.LinkOpts.MaxObjectsInFlight = atoi(MaxObjects->getValue());
+
   if (getenv("RC_DEBUG_OPTIONS"))
     Options.PaperTrailWarnings = true;
 
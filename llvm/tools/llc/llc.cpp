@@ -21,6 +21,7 @@
 #include "llvm/CodeGen/MIRParser/MIRParser.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/AutoUpgrade.h"
@@ -78,6 +79,13 @@ TimeCompilations("time-compilations", cl::Hidden, cl::init(1u),
                  cl::value_desc("N"),
                  cl::desc("Repeat compilation N times for timing"));
 
+static cl::opt<unsigned> CodeGenPartitions(
+    "codegen-partitions", cl::init(1u), cl::value_desc("N"),
+    cl::desc("Split the module into N partitions and generate code for them "
+             "in parallel. Partition I > 0 is written to <output>.I, and "
+             "linking all of the outputs together is equivalent to linking "
+             "the single output of a normal compile"));
+
 static cl::opt<bool>
 NoIntegratedAssembler("no-integrated-as", cl::Hidden,
                       cl::desc("Disable integrated assembler"));
@@ -538,6 +546,61 @@ static int compileModule(char **argv, LLVMContext &Context) {
     WithColor::warning(errs(), argv[0])
         << ": warning: ignoring -mc-relax-all because filetype != obj";
 
+  if (CodeGenPartitions > 1) {
+    if (MIR || !RunPassNames->empty() || CompileTwice || DwoOut ||
+        FileType == CGFT_Null) {
+      WithColor::error(errs(), argv[0])
+          << "-codegen-partitions cannot be used with MIR input, -run-pass, "
+             "-compile-twice, -split-dwarf-output or -filetype=null\n";
+      return 1;
+    }
+    if (OutputFilename == "-") {
+      WithColor::error(errs(), argv[0])
+          << "-codegen-partitions requires an output file\n";
+      return 1;
+    }
+
+    std::vector<std::unique_ptr<ToolOutputFile>> PartitionOuts;
+    SmallVector<raw_pwrite_stream *, 8> OSs;
+    OSs.push_back(&Out->os());
+    for (unsigned I = 1; I != CodeGenPartitions; ++I) {
+      std::error_code EC;
+      PartitionOuts.push_back(std::make_unique<ToolOutputFile>(
+          OutputFilename + "." + std::to_string(I), EC,
+          FileType == CGFT_AssemblyFile ? sys::fs::OF_Text : sys::fs::OF_None));
+      if (EC) {
+        WithColor::error(errs(), argv[0]) << EC.message() << '\n';
+        return 1;
+      }
+      OSs.push_back(&PartitionOuts.back()->os());
+    }
+
+    // Before executing passes, print the final values of the LLVM options.
+    cl::PrintOptionValues();
+
+    // Local symbols are kept local, so that linking the outputs is equivalent
+    // to linking a single output, and partitions are balanced by their
+    // estimated code generation cost.
+    splitCodeGen(
+        std::move(M), OSs, {},
+        [&]() {
+          return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+              TheTriple.getTriple(), CPUStr, FeaturesStr, Options, RM,
+              getCodeModel(), OLvl));
+        },
+        FileType, /*PreserveLocals=*/true);
+
+    auto HasError =
+        ((const LLCDiagnosticHandler *)(Context.getDiagHandlerPtr()))->HasError;
+    if (*HasError)
+      return 1;
+
+    Out->keep();
+    for (auto &PartitionOut : PartitionOuts)
+      PartitionOut->keep();
+    return 0;
+  }
+
   {
     raw_pwrite_stream *OS = &Out->os();
 
@@ -4,6 +4,8 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/MC/MCSection.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
 #include <cassert>
 
 namespace llvm {
@@ -35,20 +37,29 @@ class DWPStringPool {
   DenseMap<const char *, uint32_t, CStrDenseMapInfo> Pool;
   uint32_t Offset = 0;
 
+  // The pool keeps its own copy of every distinct string, so the input
+  // string sections do not have to outlive the call to getOffset().
+  BumpPtrAllocator Alloc;
+  StringSaver Saver{Alloc};
+
 public:
   DWPStringPool(MCStreamer &Out, MCSection *Sec) : Out(Out), Sec(Sec) {}
 
   uint32_t getOffset(const char *Str, unsigned Length) {
     assert(strlen(Str) + 1 == Length && "Ensure length hint is correct");
 
-    auto Pair = Pool.insert(std::make_pair(Str, Offset));
-    if (Pair.second) {
-      Out.SwitchSection(Sec);
-      Out.EmitBytes(StringRef(Str, Length));
-      Offset += Length;
-    }
+    auto It = Pool.find(Str);
+    if (It != Pool.end())
+      return It->second;
 
-    return Pair.first->second;
+    // StringSaver adds the terminating null itself.
+    const char *Copy = Saver.save(StringRef(Str, Length - 1)).data();
+    Pool.insert(std::make_pair(Copy, Offset));
+    Out.SwitchSection(Sec);
+    Out.EmitBytes(StringRef(Copy, Length));
+    uint32_t StrOffset = Offset;
+    Offset += Length;
+    return StrOffset;
   }
 };
 }
@@ -39,6 +39,8 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
@@ -61,6 +63,12 @@ static cl::opt<std::string> OutputFilename(cl::Required, "o",
                                            cl::value_desc("filename"),
                                            cl::cat(DwpCategory));
 
+static cl::opt<unsigned>
+    NumThreads("j", cl::init(0),
+               cl::desc("Number of threads used to read and decompress input "
+                        "files (0 = hardware concurrency)"),
+               cl::value_desc("N"), cl::cat(DwpCategory));
+
 static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
                                    MCSection *StrOffsetSection,
                                    StringRef CurStrSection,
@@ -389,38 +397,68 @@ handleCompressedSection(std::deque<SmallString<32>> &UncompressedSections,
   return Error::success();
 }
 
-static Error handleSection(
-    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
-    const MCSection *StrSection, const MCSection *StrOffsetSection,
-    const MCSection *TypesSection, const MCSection *CUIndexSection,
-    const MCSection *TUIndexSection, const SectionRef &Section, MCStreamer &Out,
-    std::deque<SmallString<32>> &UncompressedSections,
-    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
-    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
-    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
-    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
-    StringRef &CurTUIndexSection) {
-  if (Section.isBSS())
-    return Error::success();
+namespace {
+/// An input file with the (decompressed) contents of its sections. Inputs are
+/// loaded in parallel ahead of the merge, which itself is sequential.
+struct InputObject {
+  OwningBinary<ObjectFile> Binary;
+  std::deque<SmallString<32>> UncompressedSections;
+  /// Name and contents of every section that has file contents, with the
+  /// leading "." or "_" of the name dropped.
+  std::vector<std::pair<StringRef, StringRef>> Sections;
+  /// The result of loading the file, set once the load task has run. This is
+  /// only constructed then: assigning over an unchecked Error::success()
+  /// would trip the checks in asserts builds.
+  Optional<Error> Err;
+};
+} // end anonymous namespace
 
-  if (Section.isVirtual())
-    return Error::success();
+static Error loadSections(InputObject &In, const ObjectFile &Obj) {
+  for (const SectionRef &Section : Obj.sections()) {
+    if (Section.isBSS() || Section.isVirtual())
+      continue;
 
-  Expected<StringRef> NameOrErr = Section.getName();
-  if (!NameOrErr)
-    return NameOrErr.takeError();
-  StringRef Name = *NameOrErr;
+    Expected<StringRef> NameOrErr = Section.getName();
+    if (!NameOrErr)
+      return NameOrErr.takeError();
+    StringRef Name = *NameOrErr;
 
-  Expected<StringRef> ContentsOrErr = Section.getContents();
-  if (!ContentsOrErr)
-    return ContentsOrErr.takeError();
-  StringRef Contents = *ContentsOrErr;
+    Expected<StringRef> ContentsOrErr = Section.getContents();
+    if (!ContentsOrErr)
+      return ContentsOrErr.takeError();
+    StringRef Contents = *ContentsOrErr;
 
-  if (auto Err = handleCompressedSection(UncompressedSections, Name, Contents))
-    return Err;
+    if (auto Err =
+            handleCompressedSection(In.UncompressedSections, Name, Contents))
+      return Err;
+
+    Name = Name.substr(Name.find_first_not_of("._"));
+    In.Sections.emplace_back(Name, Contents);
+  }
+  return Error::success();
+}
 
-  Name = Name.substr(Name.find_first_not_of("._"));
+/// Open \p Input and read its sections into \p In. The caller stores the
+/// result in In.Err, to be reported when the input is merged so that errors
+/// appear in input order.
+static Error loadInput(StringRef Input, InputObject &In) {
+  auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
+  if (!ErrOrObj)
+    return ErrOrObj.takeError();
+  In.Binary = std::move(*ErrOrObj);
+  return loadSections(In, *In.Binary.getBinary());
+}
 
+static Error handleSection(
+    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
+    const MCSection *StrSection, const MCSection *StrOffsetSection,
+    const MCSection *TypesSection, const MCSection *CUIndexSection,
+    const MCSection *TUIndexSection, StringRef Name, StringRef Contents,
+    MCStreamer &Out, uint32_t (&ContributionOffsets)[8],
+    UnitIndexEntry &CurEntry, StringRef &CurStrSection,
+    StringRef &CurStrOffsetSection, std::vector<StringRef> &CurTypesSection,
+    StringRef &InfoSection, StringRef &AbbrevSection,
+    StringRef &CurCUIndexSection, StringRef &CurTUIndexSection) {
   auto SectionPair = KnownSections.find(Name);
   if (SectionPair == KnownSections.end())
     return Error::success();
@@ -527,19 +565,11 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   DWPStringPool Strings(Out, StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
-
-  std::deque<SmallString<32>> UncompressedSections;
-
-  for (const auto &Input : Inputs) {
-    auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
-    if (!ErrOrObj)
-      return ErrOrObj.takeError();
-
-    auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
-
+  // Merges one loaded input into the output. The strings, index entries and
+  // section contents it needs are copied, so the input can be released
+  // afterwards.
+  auto MergeInput = [&](StringRef Input, InputObject &In) -> Error {
+    const ObjectFile &Obj = *In.Binary.getBinary();
     UnitIndexEntry CurEntry = {};
 
     StringRef CurStrSection;
@@ -550,17 +580,17 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
     StringRef CurCUIndexSection;
     StringRef CurTUIndexSection;
 
-    for (const auto &Section : Obj.sections())
+    for (const auto &Section : In.Sections)
       if (auto Err = handleSection(
               KnownSections, StrSection, StrOffsetSection, TypesSection,
-              CUIndexSection, TUIndexSection, Section, Out,
-              UncompressedSections, ContributionOffsets, CurEntry,
-              CurStrSection, CurStrOffsetSection, CurTypesSection, InfoSection,
-              AbbrevSection, CurCUIndexSection, CurTUIndexSection))
+              CUIndexSection, TUIndexSection, Section.first, Section.second,
+              Out, ContributionOffsets, CurEntry, CurStrSection,
+              CurStrOffsetSection, CurTypesSection, InfoSection, AbbrevSection,
+              CurCUIndexSection, CurTUIndexSection))
         return Err;
 
     if (InfoSection.empty())
-      continue;
+      return Error::success();
 
     writeStringsAndOffsets(Out, Strings, StrOffsetSection, CurStrSection,
                            CurStrOffsetSection);
@@ -578,7 +608,7 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
       P.first->second.DWOName = ID.DWOName;
       addAllTypes(Out, TypeIndexEntries, TypesSection, CurTypesSection,
                   CurEntry, ContributionOffsets[DW_SECT_TYPES - DW_SECT_INFO]);
-      continue;
+      return Error::success();
     }
 
     DWARFUnitIndex CUIndex(DW_SECT_INFO);
@@ -624,6 +654,34 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
                          CurTypesSection.front(), CurEntry,
                          ContributionOffsets[DW_SECT_TYPES - DW_SECT_INFO]);
     }
+    return Error::success();
+  };
+
+  // Reading and decompressing the inputs dominates for large packages, so it
+  // is done on a thread pool, a batch of inputs at a time. Only one batch is
+  // kept in memory: each input is released as soon as it has been merged.
+  const unsigned ThreadCount = NumThreads ? NumThreads : hardware_concurrency();
+  ThreadPool Pool(ThreadCount);
+  const size_t BatchSize = 4 * ThreadCount;
+  for (size_t Begin = 0; Begin < Inputs.size(); Begin += BatchSize) {
+    ArrayRef<std::string> BatchInputs =
+        Inputs.slice(Begin).take_front(BatchSize);
+    std::vector<InputObject> Batch(BatchInputs.size());
+    for (size_t I = 0; I != Batch.size(); ++I)
+      Pool.async(
+          [&, I] { Batch[I].Err = loadInput(BatchInputs[I], Batch[I]); });
+    Pool.wait();
+
+    for (size_t I = 0; I != Batch.size(); ++I) {
+      Error Err = std::move(*Batch[I].Err);
+      if (!Err)
+        Err = MergeInput(BatchInputs[I], Batch[I]);
+      if (Err) {
+        for (size_t J = I + 1; J != Batch.size(); ++J)
+          consumeError(std::move(*Batch[J].Err));
+        return Err;
+      }
+    }
   }
 
   // Lie about there being no info contributions so the TU index only includes
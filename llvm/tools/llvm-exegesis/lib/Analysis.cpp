@@ -9,10 +9,14 @@
 #include "Analysis.h"
 #include "BenchmarkResult.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCTargetOptions.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FormatVariadic.h"
+#include <cmath>
 #include <limits>
+#include <map>
 #include <unordered_set>
 #include <vector>
 
@@ -599,5 +603,139 @@ Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   return Error::success();
 }
 
+namespace {
+// Measurements of one opcode, aggregated over all its non-noise points.
+struct OpcodeMeasurements {
+  // Minimum measured latency, negative if not measured.
+  double Latency = -1.0;
+  // Sum of NumMicroOps and of per-port pressure over uops points.
+  double NumMicroOps = 0.0;
+  std::map<std::string, double> PortPressure;
+  unsigned NumUopsPoints = 0;
+};
+} // namespace
+
+// Returns the index of the ProcResGroup whose units are exactly the resources
+// in `Ports`, or 0 if the model has no such group.
+static unsigned findProcResGroup(const MCSchedModel &SM,
+                                 const std::vector<unsigned> &Ports) {
+  for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I < E; ++I) {
+    const MCProcResourceDesc &Desc = *SM.getProcResource(I);
+    if (!Desc.SubUnitsIdxBegin || Desc.NumUnits != Ports.size())
+      continue;
+    if (std::is_permutation(Ports.begin(), Ports.end(), Desc.SubUnitsIdxBegin))
+      return I;
+  }
+  return 0;
+}
+
+template <>
+Error Analysis::run<Analysis::PrintSchedModelOverrides>(raw_ostream &OS) const {
+  if (Clustering_.getPoints().empty())
+    return Error::success();
+
+  // Ports with less pressure than this are considered measurement noise.
+  static constexpr double kMinPortPressure = 0.1;
+
+  const auto &Points = Clustering_.getPoints();
+  std::map<unsigned, OpcodeMeasurements> PerOpcode;
+  for (size_t PointId = 0, E = Points.size(); PointId < E; ++PointId) {
+    const InstructionBenchmark &Point = Points[PointId];
+    if (!Point.Error.empty() ||
+        !Clustering_.getClusterIdForPoint(PointId).isValid())
+      continue;
+    OpcodeMeasurements &M = PerOpcode[Point.keyInstruction().getOpcode()];
+    if (Point.Mode == InstructionBenchmark::Latency) {
+      for (const BenchmarkMeasure &Measure : Point.Measurements)
+        if (Measure.Key == "latency" &&
+            (M.Latency < 0 || Measure.PerInstructionValue < M.Latency))
+          M.Latency = Measure.PerInstructionValue;
+    } else if (Point.Mode == InstructionBenchmark::Uops) {
+      ++M.NumUopsPoints;
+      for (const BenchmarkMeasure &Measure : Point.Measurements) {
+        if (Measure.Key == "NumMicroOps")
+          M.NumMicroOps += Measure.PerInstructionValue;
+        else
+          M.PortPressure[Measure.Key] += Measure.PerInstructionValue;
+      }
+    }
+  }
+
+  const MCSchedModel &SM = SubtargetInfo_->getSchedModel();
+  StringMap<unsigned> ProcResIdx;
+  for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I < E; ++I)
+    ProcResIdx[SM.getProcResource(I)->Name] = I;
+
+  const auto &FirstPoint = Points.front();
+  OS << "// Scheduling overrides for " << FirstPoint.CpuName << " ("
+     << FirstPoint.LLVMTriple << ") fitted by llvm-exegesis from "
+     << Points.size() << " benchmark points.\n";
+
+  for (const auto &Entry : PerOpcode) {
+    const OpcodeMeasurements &M = Entry.second;
+    const StringRef Name = InstrInfo_->getName(Entry.first);
+
+    // Resources and cycles, in the order they are printed.
+    std::vector<std::pair<std::string, long>> Resources;
+    std::vector<std::pair<std::string, double>> Used;
+    if (M.NumUopsPoints) {
+      for (const auto &Port : M.PortPressure) {
+        const double Pressure = Port.second / M.NumUopsPoints;
+        if (Pressure >= kMinPortPressure)
+          Used.emplace_back(Port.first, Pressure);
+      }
+      // A uop that can issue on any of N ports shows up as roughly equal
+      // fractional pressure on each of them: model it as a use of the group
+      // of these ports if the model has one.
+      std::vector<unsigned> UsedIdx;
+      double Total = 0.0;
+      bool AllFractional = !Used.empty();
+      for (const auto &U : Used) {
+        Total += U.second;
+        AllFractional &= U.second < 1.0;
+        auto It = ProcResIdx.find(U.first);
+        if (It != ProcResIdx.end())
+          UsedIdx.push_back(It->second);
+      }
+      unsigned GroupIdx = 0;
+      if (AllFractional && Used.size() > 1 && UsedIdx.size() == Used.size())
+        GroupIdx = findProcResGroup(SM, UsedIdx);
+      if (GroupIdx)
+        Resources.emplace_back(SM.getProcResource(GroupIdx)->Name,
+                               std::max(1L, std::lround(Total)));
+      else
+        for (const auto &U : Used)
+          Resources.emplace_back(U.first, std::max(1L, std::lround(U.second)));
+    }
+    if (M.Latency < 0 && Resources.empty() && !M.NumUopsPoints)
+      continue;
+
+    OS << "\n// " << Name << ":";
+    for (const auto &U : Used)
+      OS << " " << U.first << "=" << format("%.2f", U.second);
+    OS << "\n";
+    OS << "def ExegesisWrite_" << Name << " : SchedWriteRes<[";
+    for (size_t I = 0, E = Resources.size(); I < E; ++I)
+      OS << (I ? ", " : "") << Resources[I].first;
+    OS << "]> {\n";
+    if (M.Latency >= 0)
+      OS << "  let Latency = " << std::lround(std::ceil(M.Latency)) << ";\n";
+    if (M.NumUopsPoints)
+      OS << "  let NumMicroOps = "
+         << std::max(1L, std::lround(M.NumMicroOps / M.NumUopsPoints))
+         << ";\n";
+    if (!Resources.empty()) {
+      OS << "  let ResourceCycles = [";
+      for (size_t I = 0, E = Resources.size(); I < E; ++I)
+        OS << (I ? ", " : "") << Resources[I].second;
+      OS << "];\n";
+    }
+    OS << "}\n";
+    OS << "def : InstRW<[ExegesisWrite_" << Name << "], (instrs " << Name
+       << ")>;\n";
+  }
+  return Error::success();
+}
+
 } // namespace exegesis
 } // namespace llvm
@@ -45,6 +45,8 @@ public:
   struct PrintClusters {};
   // Find potential errors in the scheduling information given measurements.
   struct PrintSchedClassInconsistencies {};
+  // Emits TableGen SchedWriteRes/InstRW overrides fitted to the measurements.
+  struct PrintSchedModelOverrides {};
 
   template <typename Pass> Error run(raw_ostream &OS) const;
 
@@ -22,7 +22,9 @@
 #include "lib/SnippetRepetitor.h"
 #include "lib/Target.h"
 #include "lib/TargetSelect.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/MC/MCInstBuilder.h"
 #include "llvm/MC/MCObjectFileInfo.h"
@@ -32,6 +34,7 @@
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
@@ -101,6 +104,13 @@ static cl::opt<unsigned> MaxConfigsPerOpcode(
         "allow to snippet generator to generate at most that many configs"),
     cl::cat(BenchmarkOptions), cl::init(1));
 
+static cl::opt<bool> Resume(
+    "resume",
+    cl::desc("append to --benchmarks-file and skip the configurations it "
+             "already holds results for, e.g. to continue an interrupted "
+             "--opcode-index=-1 run"),
+    cl::cat(BenchmarkOptions), cl::init(false));
+
 static cl::opt<bool> IgnoreInvalidSchedClass(
     "ignore-invalid-sched-class",
     cl::desc("ignore instructions that do not define a sched class"),
@@ -139,6 +149,11 @@ static cl::opt<std::string>
     AnalysisInconsistenciesOutputFile("analysis-inconsistencies-output-file",
                                       cl::desc(""), cl::cat(AnalysisOptions),
                                       cl::init(""));
+static cl::opt<std::string> AnalysisSchedModelOutputFile(
+    "analysis-sched-model-output-file",
+    cl::desc("write TableGen SchedWriteRes/InstRW overrides fitted to the "
+             "measured latencies and port pressures to this file"),
+    cl::cat(AnalysisOptions), cl::init(""));
 
 static cl::opt<bool> AnalysisDisplayUnstableOpcodes(
     "analysis-display-unstable-clusters",
@@ -224,6 +239,29 @@ static std::vector<unsigned> getOpcodesOrDie(const MCInstrInfo &MCInstrInfo) {
   return Result;
 }
 
+// Returns a string that identifies the configuration `Key`, used to match
+// configurations against results of a previous run.
+static std::string getConfigurationId(const InstructionBenchmarkKey &Key) {
+  std::string Id;
+  raw_string_ostream OS(Id);
+  for (const MCInst &Inst : Key.Instructions) {
+    OS << Inst.getOpcode();
+    for (const MCOperand &Op : Inst) {
+      if (Op.isReg())
+        OS << " r" << Op.getReg();
+      else if (Op.isImm())
+        OS << " i" << Op.getImm();
+      else if (Op.isFPImm())
+        OS << " f" << Op.getFPImm();
+    }
+    OS << ';';
+  }
+  for (const RegisterValue &RV : Key.RegisterInitialValues)
+    OS << RV.Register << '=' << RV.Value << ';';
+  OS << Key.Config;
+  return OS.str();
+}
+
 // Generates code snippets for opcode `Opcode`.
 static Expected<std::vector<BenchmarkCode>>
 generateSnippets(const LLVMState &State, unsigned Opcode,
@@ -308,10 +346,42 @@ void benchmarkMain() {
   if (BenchmarkFile.empty())
     BenchmarkFile = "-";
 
+  if (Resume && BenchmarkFile == "-")
+    ExitWithError("--resume requires --benchmarks-file");
+
+  // Configurations that already have results, when resuming.
+  StringSet<> Done;
+  if (Resume && sys::fs::exists(BenchmarkFile)) {
+    for (const InstructionBenchmark &IB :
+         ExitOnFileError(BenchmarkFile,
+                         InstructionBenchmark::readYamls(State, BenchmarkFile)))
+      Done.insert(getConfigurationId(IB.Key));
+    errs() << "Resuming: " << Done.size() << " configurations done\n";
+  }
+
+  // Open the output file once so that results accumulate, instead of each
+  // one replacing the previous. writeYamlTo() flushes after every result, so
+  // an interrupted run keeps everything measured so far.
+  Optional<raw_fd_ostream> FileOstr;
+  if (BenchmarkFile != "-") {
+    int ResultFD = 0;
+    ExitOnFileError(BenchmarkFile,
+                    errorCodeToError(openFileForWrite(
+                        BenchmarkFile, ResultFD,
+                        Resume ? sys::fs::CD_OpenAlways
+                               : sys::fs::CD_CreateAlways,
+                        Resume ? sys::fs::OF_Text | sys::fs::OF_Append
+                               : sys::fs::OF_Text)));
+    FileOstr.emplace(ResultFD, true /*shouldClose*/);
+  }
+  raw_ostream &Ostr = FileOstr ? *FileOstr : outs();
+
   for (const BenchmarkCode &Conf : Configurations) {
+    if (!Done.empty() && Done.count(getConfigurationId(Conf.Key)))
+      continue;
     InstructionBenchmark Result = ExitOnErr(Runner->runConfiguration(
         Conf, NumRepetitions, *Repetitor, DumpObjectToDisk));
-    ExitOnFileError(BenchmarkFile, Result.writeYaml(State, BenchmarkFile));
+    ExitOnFileError(BenchmarkFile, Result.writeYamlTo(State, Ostr));
   }
   exegesis::pfm::pfmTerminate();
 }
@@ -342,10 +412,12 @@ static void analysisMain() {
     ExitWithError("--benchmarks-file must be set");
 
   if (AnalysisClustersOutputFile.empty() &&
-      AnalysisInconsistenciesOutputFile.empty()) {
+      AnalysisInconsistenciesOutputFile.empty() &&
+      AnalysisSchedModelOutputFile.empty()) {
     ExitWithError(
-        "for --mode=analysis: At least one of --analysis-clusters-output-file"
-        "and --analysis-inconsistencies-output-file must be specified");
+        "for --mode=analysis: At least one of --analysis-clusters-output-file,"
+        " --analysis-inconsistencies-output-file and "
+        "--analysis-sched-model-output-file must be specified");
   }
 
   InitializeNativeTarget();
@@ -388,6 +460,8 @@ static void analysisMain() {
   maybeRunAnalysis<Analysis::PrintSchedClassInconsistencies>(
       Analyzer, "sched class consistency analysis",
       AnalysisInconsistenciesOutputFile);
+  maybeRunAnalysis<Analysis::PrintSchedModelOverrides>(
+      Analyzer, "sched model overrides", AnalysisSchedModelOutputFile);
 }
 
 } // namespace exegesis
@@ -33,6 +33,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/Memory.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -316,19 +317,29 @@ static bool isCompressable(const SectionBase &Sec) {
 static void replaceDebugSections(
     Object &Obj, SectionPred &RemovePred,
     function_ref<bool(const SectionBase &)> shouldReplace,
-    function_ref<SectionBase *(const SectionBase *)> addSection) {
+    function_ref<std::unique_ptr<SectionBase>(const SectionBase *)>
+        makeSection) {
   // Build a list of the debug sections we are going to replace.
-  // We can't call `addSection` while iterating over sections,
+  // We can't add sections while iterating over sections,
   // because it would mutate the sections array.
   SmallVector<SectionBase *, 13> ToReplace;
   for (auto &Sec : Obj.sections())
     if (shouldReplace(Sec))
       ToReplace.push_back(&Sec);
 
+  // Creating a replacement may (de)compress its contents, which is
+  // independent for every section, so do it in parallel and only add the
+  // results to the object afterwards.
+  std::vector<std::unique_ptr<SectionBase>> Replacements(ToReplace.size());
+  parallel::for_each_n(parallel::par, size_t(0), ToReplace.size(),
+                       [&](size_t I) {
+                         Replacements[I] = makeSection(ToReplace[I]);
+                       });
+
   // Build a mapping from original section to a new one.
   DenseMap<SectionBase *, SectionBase *> FromTo;
-  for (SectionBase *S : ToReplace)
-    FromTo[S] = addSection(S);
+  for (size_t I = 0, E = ToReplace.size(); I != E; ++I)
+    FromTo[ToReplace[I]] = &Obj.addSection(std::move(Replacements[I]));
 
   // Now we want to update the target sections of relocation
   // sections. Also we will update the relocations themselves
@@ -575,18 +586,18 @@ static Error replaceAndRemoveSections(const CopyConfig &Config, Object &Obj) {
   }
 
   if (Config.CompressionType != DebugCompressionType::None)
-    replaceDebugSections(Obj, RemovePred, isCompressable, 
-                         [&Config, &Obj](const SectionBase *S) {
-                           return &Obj.addSection<CompressedSection>(
-                                *S, Config.CompressionType);
-                        });
+    replaceDebugSections(Obj, RemovePred, isCompressable,
+                         [&Config](const SectionBase *S) {
+                           return std::make_unique<CompressedSection>(
+                               *S, Config.CompressionType);
+                         });
   else if (Config.DecompressDebugSections)
     replaceDebugSections(
         Obj, RemovePred,
         [](const SectionBase &S) { return isa<CompressedSection>(&S); },
-        [&Obj](const SectionBase *S) {
+        [](const SectionBase *S) {
           auto CS = cast<CompressedSection>(S);
-          return &Obj.addSection<DecompressedSection>(*CS);
+          return std::make_unique<DecompressedSection>(*CS);
         });
 
   return Obj.removeSections(Config.AllowBrokenLinks, RemovePred);
@@ -20,6 +20,7 @@
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include <algorithm>
 #include <cstddef>
@@ -430,13 +431,12 @@ void ELFSectionWriter<ELFT>::visit(const DecompressedSection &Sec) {
       reinterpret_cast<const char *>(Sec.OriginalData.data()) + DataOffset,
       Sec.OriginalData.size() - DataOffset);
 
-  SmallVector<char, 128> DecompressedContent;
-  if (Error E = zlib::uncompress(CompressedContent, DecompressedContent,
-                                 static_cast<size_t>(Sec.Size)))
+  // Inflate straight into the output buffer, which already has room for the
+  // decompressed size.
+  char *Buf = reinterpret_cast<char *>(Out.getBufferStart() + Sec.Offset);
+  size_t DecompressedSize = static_cast<size_t>(Sec.Size);
+  if (Error E = zlib::uncompress(CompressedContent, Buf, DecompressedSize))
     reportError(Sec.Name, std::move(E));
-
-  uint8_t *Buf = Out.getBufferStart() + Sec.Offset;
-  std::copy(DecompressedContent.begin(), DecompressedContent.end(), Buf);
 }
 
 void BinarySectionWriter::visit(const DecompressedSection &Sec) {
@@ -1787,12 +1787,18 @@ template <class ELFT> void ELFWriter<ELFT>::writeShdrs() {
 }
 
 template <class ELFT> void ELFWriter<ELFT>::writeSectionData() {
-  for (SectionBase &Sec : Obj.sections())
-    // Segments are responsible for writing their contents, so only write the
-    // section data if the section is not in a segment. Note that this renders
-    // sections in segments effectively immutable.
+  // Segments are responsible for writing their contents, so only write the
+  // section data if the section is not in a segment. Note that this renders
+  // sections in segments effectively immutable.
+  std::vector<const SectionBase *> ToWrite;
+  for (const SectionBase &Sec : Obj.sections())
     if (Sec.ParentSegment == nullptr)
-      Sec.accept(*SecWriter);
+      ToWrite.push_back(&Sec);
+
+  // Every section writes a disjoint range of the output buffer and the writer
+  // keeps no state of its own, so the sections can be written concurrently.
+  parallel::for_each_n(parallel::par, size_t(0), ToWrite.size(),
+                       [&](size_t I) { ToWrite[I]->accept(*SecWriter); });
 }
 
 template <class ELFT> void ELFWriter<ELFT>::writeSegmentData() {
@@ -1059,7 +1059,10 @@ public:
                        std::function<bool(const SectionBase &)> ToRemove);
   Error removeSymbols(function_ref<bool(const Symbol &)> ToRemove);
   template <class T, class... Ts> T &addSection(Ts &&... Args) {
-    auto Sec = std::make_unique<T>(std::forward<Ts>(Args)...);
+    return static_cast<T &>(
+        addSection(std::make_unique<T>(std::forward<Ts>(Args)...)));
+  }
+  SectionBase &addSection(std::unique_ptr<SectionBase> Sec) {
     auto Ptr = Sec.get();
     MustBeRelocatable |= isa<RelocationSection>(*Ptr);
     Sections.emplace_back(std::move(Sec));
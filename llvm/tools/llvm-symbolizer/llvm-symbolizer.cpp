@@ -157,6 +157,11 @@ static cl::list<std::string>
                          cl::desc("Path to directory where to look for debug "
                                   "files."));
 
+static cl::opt<unsigned> ClMaxCachedModules(
+    "max-cached-modules", cl::init(0), cl::value_desc("N"),
+    cl::desc("Keep the debug info of at most N modules parsed, dropping the "
+             "least recently used one first (0 = no limit)"));
+
 static cl::opt<DIPrinter::OutputStyle>
     ClOutputStyle("output-style", cl::init(DIPrinter::OutputStyle::LLVM),
                   cl::desc("Specify print style"),
@@ -309,6 +314,7 @@ int main(int argc, char **argv) {
   Opts.FallbackDebugPath = ClFallbackDebugPath;
   Opts.DWPName = ClDwpName;
   Opts.DebugFileDirectory = ClDebugFileDirectory;
+  Opts.MaxCachedModules = ClMaxCachedModules;
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
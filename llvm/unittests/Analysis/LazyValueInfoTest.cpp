@@ -0,0 +1,125 @@
+//===- LazyValueInfoTest.cpp - LazyValueInfo unit tests -------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/LazyValueInfo.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/ConstantRange.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// A small state machine: the state is only known on the switch edges, so
+// every query below has to walk through the predecessors of %join.
+const char *StateMachineIR =
+    "define i32 @f(i32 %x) {\n"
+    "entry:\n"
+    "  switch i32 %x, label %exit [\n"
+    "    i32 0, label %a\n"
+    "    i32 1, label %b\n"
+    "    i32 2, label %c\n"
+    "    i32 3, label %d\n"
+    "  ]\n"
+    "a:\n"
+    "  br label %join\n"
+    "b:\n"
+    "  br label %join\n"
+    "c:\n"
+    "  br label %join\n"
+    "d:\n"
+    "  br label %join\n"
+    "join:\n"
+    "  %p = phi i32 [ %x, %a ], [ %x, %b ], [ %x, %c ], [ 2, %d ]\n"
+    "  ret i32 %p\n"
+    "exit:\n"
+    "  ret i32 0\n"
+    "}\n";
+
+class LazyValueInfoTest : public testing::Test {
+protected:
+  LazyValueInfoTest() : TLI(TLII) {}
+
+  void parseAssembly(const char *Assembly) {
+    SMDiagnostic Error;
+    M = parseAssemblyString(Assembly, Error, Context);
+    ASSERT_TRUE(M) << Error.getMessage();
+    F = M->getFunction("f");
+    ASSERT_TRUE(F);
+  }
+
+  BasicBlock *getBlock(StringRef Name) {
+    for (BasicBlock &BB : *F)
+      if (BB.getName() == Name)
+        return &BB;
+    return nullptr;
+  }
+
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  Function *F = nullptr;
+  TargetLibraryInfoImpl TLII;
+  TargetLibraryInfo TLI;
+};
+
+TEST_F(LazyValueInfoTest, MergesAllPredecessors) {
+  parseAssembly(StateMachineIR);
+  DominatorTree DT(*F);
+  AssumptionCache AC(*F);
+  LazyValueInfo LVI(&AC, &M->getDataLayout(), &TLI, &DT);
+
+  Value *X = F->getArg(0);
+  BasicBlock *Join = getBlock("join");
+  Instruction *P = &Join->front();
+
+  EXPECT_EQ(LVI.getConstantRange(X, Join),
+            ConstantRange(APInt(32, 0), APInt(32, 4)));
+  EXPECT_EQ(LVI.getConstantRange(P, Join),
+            ConstantRange(APInt(32, 0), APInt(32, 3)));
+}
+
+TEST_F(LazyValueInfoTest, CacheLimit) {
+  parseAssembly(StateMachineIR);
+  DominatorTree DT(*F);
+  AssumptionCache AC(*F);
+
+  auto &Opts = cl::getRegisteredOptions();
+  auto *MaxCacheEntries =
+      static_cast<cl::opt<unsigned> *>(Opts["lvi-max-cache-entries"]);
+  ASSERT_TRUE(MaxCacheEntries);
+  unsigned OldMaxCacheEntries = *MaxCacheEntries;
+  MaxCacheEntries->setValue(2);
+
+  // Answers must not depend on what was dropped from the cache, with or
+  // without the dominator tree to guide the pruning.
+  for (DominatorTree *MaybeDT : {&DT, (DominatorTree *)nullptr}) {
+    LazyValueInfo LVI(&AC, &M->getDataLayout(), &TLI, MaybeDT);
+    Value *X = F->getArg(0);
+    BasicBlock *Join = getBlock("join");
+    Instruction *P = &Join->front();
+    for (unsigned Round = 0; Round != 2; ++Round) {
+      EXPECT_EQ(LVI.getConstantRange(X, Join),
+                ConstantRange(APInt(32, 0), APInt(32, 4)));
+      EXPECT_EQ(LVI.getConstantRange(X, getBlock("c")),
+                ConstantRange(APInt(32, 2)));
+      EXPECT_EQ(LVI.getConstantRange(P, Join),
+                ConstantRange(APInt(32, 0), APInt(32, 3)));
+    }
+  }
+
+  MaxCacheEntries->setValue(OldMaxCacheEntries);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,89 @@
+//===- OptimizationRemarkEmitterTest.cpp - ORE unit tests -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LLVMRemarkStreamer.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Remarks/RemarkStreamer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class OptimizationRemarkEmitterTest : public testing::Test {
+protected:
+  OptimizationRemarkEmitterTest() : M("ORETest", C), OS(Buffer) {
+    F = Function::Create(FunctionType::get(Type::getVoidTy(C), false),
+                         Function::ExternalLinkage, "f", M);
+  }
+
+  // Streams remarks to Buffer, keeping only those of passes matching
+  // \p Filter.
+  void setRemarkFile(StringRef Filter) {
+    Expected<std::unique_ptr<remarks::RemarkSerializer>> Serializer =
+        remarks::createRemarkSerializer(remarks::Format::YAML,
+                                        remarks::SerializerMode::Separate, OS);
+    ASSERT_TRUE((bool)Serializer) << toString(Serializer.takeError());
+    auto RS = std::make_unique<remarks::RemarkStreamer>(std::move(*Serializer));
+    if (!Filter.empty())
+      ASSERT_FALSE((bool)RS->setFilter(Filter));
+    C.setMainRemarkStreamer(std::move(RS));
+    C.setLLVMRemarkStreamer(
+        std::make_unique<LLVMRemarkStreamer>(*C.getMainRemarkStreamer()));
+  }
+
+  void emitMissed(OptimizationRemarkEmitter &ORE, const char *PassName) {
+    ORE.emit([&]() {
+      return OptimizationRemarkMissed(PassName, "Missed", DebugLoc(),
+                                      &F->getEntryBlock());
+    });
+  }
+
+  LLVMContext C;
+  Module M;
+  Function *F;
+  std::string Buffer;
+  raw_string_ostream OS;
+};
+
+TEST_F(OptimizationRemarkEmitterTest, NoRemarkFile) {
+  OptimizationRemarkEmitter ORE(F);
+  EXPECT_FALSE(ORE.allowExtraAnalysis("pass"));
+}
+
+TEST_F(OptimizationRemarkEmitterTest, UnfilteredRemarkFile) {
+  setRemarkFile("");
+  OptimizationRemarkEmitter ORE(F);
+  EXPECT_TRUE(ORE.allowExtraAnalysis("pass"));
+  EXPECT_TRUE(ORE.allowExtraAnalysis("other"));
+}
+
+TEST_F(OptimizationRemarkEmitterTest, FilteredRemarkFile) {
+  setRemarkFile("^pass$");
+  OptimizationRemarkEmitter ORE(F);
+  // Each answer is the same when it comes from the filter cache.
+  for (int I = 0; I < 2; ++I) {
+    EXPECT_TRUE(ORE.allowExtraAnalysis("pass"));
+    EXPECT_FALSE(ORE.allowExtraAnalysis("other"));
+    EXPECT_FALSE(ORE.allowExtraAnalysis("passes"));
+  }
+
+  // The extra analysis is allowed exactly for the remarks that are kept.
+  BasicBlock::Create(C, "entry", F);
+  emitMissed(ORE, "pass");
+  emitMissed(ORE, "other");
+  OS.flush();
+  EXPECT_NE(Buffer.find("Pass:            pass\n"), std::string::npos);
+  EXPECT_EQ(Buffer.find("other"), std::string::npos);
+}
+
+} // end anonymous namespace
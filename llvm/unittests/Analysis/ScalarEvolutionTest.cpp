@@ -22,6 +22,7 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
 
@@ -468,6 +469,53 @@ TEST_F(ScalarEvolutionsTest, SCEVAddExpr) {
   EXPECT_NE(nullptr, SE.getSCEV(Mul1));
 }
 
+TEST_F(ScalarEvolutionsTest, SCEVCreationDepthLimit) {
+  Type *Ty = Type::getInt64Ty(Context);
+  FunctionType *FTy =
+      FunctionType::get(Type::getVoidTy(Context), {Ty, Ty}, false);
+  Function *F = Function::Create(FTy, Function::ExternalLinkage, "f", M);
+  Argument *A = &*F->arg_begin();
+  Argument *B = &*std::next(F->arg_begin());
+  BasicBlock *EntryBB = BasicBlock::Create(Context, "entry", F);
+
+  // A chain of dependent divisions that is much deeper than the creation
+  // depth limit. Unlike adds, these are not flattened while creating the SCEV.
+  SmallVector<Instruction *, 2048> Chain;
+  Value *Prev = A;
+  for (int i = 0; i < 2000; i++) {
+    Chain.push_back(BinaryOperator::CreateUDiv(Prev, B, "", EntryBB));
+    Prev = Chain.back();
+  }
+  ReturnInst::Create(Context, nullptr, EntryBB);
+
+  ScalarEvolution SE = buildSE(*F);
+  // The chain is cut short by an opaque instruction instead of recursing once
+  // per instruction.
+  const SCEV *S = SE.getSCEV(Chain.back());
+  unsigned Depth = 0;
+  while (auto *UDiv = dyn_cast<SCEVUDivExpr>(S)) {
+    S = UDiv->getLHS();
+    ++Depth;
+  }
+  EXPECT_LT(Depth, 2000u);
+  auto *U = dyn_cast<SCEVUnknown>(S);
+  ASSERT_NE(nullptr, U);
+  EXPECT_TRUE(isa<Instruction>(U->getValue()));
+
+  // The value at the cut is not cached as opaque.
+  EXPECT_TRUE(isa<SCEVUDivExpr>(SE.getSCEV(U->getValue())));
+
+  // Values that were not reached are still fully analyzed when queried.
+  S = SE.getSCEV(Chain[99]);
+  Depth = 0;
+  while (auto *UDiv = dyn_cast<SCEVUDivExpr>(S)) {
+    S = UDiv->getLHS();
+    ++Depth;
+  }
+  EXPECT_EQ(100u, Depth);
+  EXPECT_EQ(SE.getSCEV(A), S);
+}
+
 static Instruction &GetInstByName(Function &F, StringRef Name) {
   for (auto &I : instructions(F))
     if (I.getName() == Name)
@@ -1683,6 +1731,54 @@ TEST_F(ScalarEvolutionsTest, SCEVExpanderShlNSW) {
                "} ");
 }
 
+TEST_F(ScalarEvolutionsTest, SCEVExpanderCleaner) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define void @f(i64 %a, i64 %b, i64* %p) { "
+      "entry: "
+      "  %x = add i64 %a, %b "
+      "  store i64 %x, i64* %p "
+      "  ret void "
+      "} ",
+      Err, C);
+
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  runWithSE(*M, "f", [&](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    BasicBlock &Entry = F.getEntryBlock();
+    Instruction *X = &Entry.front();
+    Instruction *Ret = Entry.getTerminator();
+    size_t OrigSize = Entry.size();
+
+    // (%a + %b) * %a reuses %x and inserts a multiplication.
+    const SCEV *S = SE.getMulExpr(SE.getSCEV(X), SE.getSCEV(F.getArg(0)));
+
+    // Without a use of the result, the expanded code is removed.
+    {
+      SCEVExpander Exp(SE, M->getDataLayout(), "expander");
+      SCEVExpanderCleaner Cleaner(Exp);
+      Value *V = Exp.expandCodeFor(S, nullptr, Ret);
+      EXPECT_TRUE(Exp.isInsertedInstruction(cast<Instruction>(V)));
+      EXPECT_GT(Entry.size(), OrigSize);
+    }
+    EXPECT_EQ(Entry.size(), OrigSize);
+    EXPECT_EQ(&Entry.front(), X);
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+
+    // Marking the result used keeps it.
+    {
+      SCEVExpander Exp(SE, M->getDataLayout(), "expander");
+      SCEVExpanderCleaner Cleaner(Exp);
+      Exp.expandCodeFor(S, nullptr, Ret);
+      Cleaner.markResultUsed();
+    }
+    EXPECT_GT(Entry.size(), OrigSize);
+    EXPECT_FALSE(verifyFunction(F, &errs()));
+  });
+}
+
 TEST_F(ScalarEvolutionsTest, SCEVLoopDecIntrinsic) {
   LLVMContext C;
   SMDiagnostic Err;
@@ -1773,6 +1869,120 @@ TEST_F(ScalarEvolutionsTest, SCEVComputeConstantDifference) {
   });
 }
 
+TEST_F(ScalarEvolutionsTest, SCEVImpliedCondOperandBudget) {
+  // The loop is guarded by (((c0 & c1) & c2) & ... & c7) & %pos. The and/or
+  // operands are walked depth first, so %pos is inspected last.
+  std::string IR = "define void @f(i32 %n, i32 %a) { "
+                   "entry: "
+                   "  %pos = icmp sgt i32 %n, 0 "
+                   "  %c0 = icmp ult i32 %a, 100 "
+                   "  %g0 = and i1 %c0, %c0 ";
+  for (int i = 1; i != 8; ++i) {
+    std::string C = "%c" + std::to_string(i);
+    IR += "  " + C + " = icmp ult i32 %a, " + std::to_string(100 + i) + " ";
+    IR += "  %g" + std::to_string(i) + " = and i1 %g" + std::to_string(i - 1) +
+          ", " + C + " ";
+  }
+  // Reusing a subexpression on both sides does not repeat the walk.
+  IR += "  %d0 = and i1 %g7, %pos ";
+  for (int i = 1; i != 40; ++i)
+    IR += "  %d" + std::to_string(i) + " = and i1 %d" + std::to_string(i - 1) +
+          ", %d" + std::to_string(i - 1) + " ";
+  IR += "  br i1 %d39, label %loop, label %exit "
+        "loop: "
+        "  %iv = phi i32 [ 0, %entry ], [ %iv.next, %loop ] "
+        "  %iv.next = add i32 %iv, 1 "
+        "  %cond = icmp slt i32 %iv.next, %n "
+        "  br i1 %cond, label %loop, label %exit "
+        "exit: "
+        "  ret void "
+        "} ";
+
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(IR, Err, Context);
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  auto &Opts = cl::getRegisteredOptions();
+  auto *MaxOperands = static_cast<cl::opt<unsigned> *>(
+      Opts["scalar-evolution-max-implied-cond-operands"]);
+  ASSERT_TRUE(MaxOperands);
+  unsigned OldMaxOperands = *MaxOperands;
+
+  runWithSE(*M, "f", [&](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    Loop *L = LI.getLoopFor(getInstructionByName(F, "iv")->getParent());
+    ASSERT_NE(L, nullptr);
+    const SCEV *N = SE.getSCEV(F.getArg(0));
+    const SCEV *Zero = SE.getZero(N->getType());
+
+    EXPECT_TRUE(
+        SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_SGT, N, Zero));
+
+    // The budget runs out among the unrelated compares.
+    MaxOperands->setValue(8);
+    EXPECT_FALSE(
+        SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_SGT, N, Zero));
+
+    // Every and/or node and compare is inspected once: 40 + 8 ands and
+    // 9 compares.
+    MaxOperands->setValue(57);
+    EXPECT_TRUE(
+        SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_SGT, N, Zero));
+    MaxOperands->setValue(56);
+    EXPECT_FALSE(
+        SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_SGT, N, Zero));
+  });
+
+  MaxOperands->setValue(OldMaxOperands);
+}
+
+TEST_F(ScalarEvolutionsTest, SCEVLoopEntryGuardDepthLimit) {
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define void @f(i32 %n) { "
+      "entry: "
+      "  %pos = icmp sgt i32 %n, 0 "
+      "  br i1 %pos, label %loop, label %exit "
+      "loop: "
+      "  %iv = phi i32 [ 0, %entry ], [ %iv.next, %loop ] "
+      "  %iv.next = add i32 %iv, 1 "
+      "  %cond = icmp slt i32 %iv.next, %n "
+      "  br i1 %cond, label %loop, label %exit "
+      "exit: "
+      "  ret void "
+      "} ",
+      Err, Context);
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  auto &Opts = cl::getRegisteredOptions();
+  auto *MaxDepth = static_cast<cl::opt<unsigned> *>(
+      Opts["scalar-evolution-max-loop-entry-guard-depth"]);
+  ASSERT_TRUE(MaxDepth);
+  unsigned OldMaxDepth = *MaxDepth;
+
+  runWithSE(*M, "f", [&](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    Loop *L = LI.getLoopFor(getInstructionByName(F, "iv")->getParent());
+    ASSERT_NE(L, nullptr);
+    const SCEV *N = SE.getSCEV(F.getArg(0));
+    const SCEV *Zero = SE.getZero(N->getType());
+
+    EXPECT_TRUE(
+        SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_SGT, N, Zero));
+
+    // A limit of zero does not even allow the outermost walk.
+    MaxDepth->setValue(0);
+    EXPECT_FALSE(
+        SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_SGT, N, Zero));
+
+    MaxDepth->setValue(1);
+    EXPECT_TRUE(
+        SE.isLoopEntryGuardedByCond(L, ICmpInst::ICMP_SGT, N, Zero));
+  });
+
+  MaxDepth->setValue(OldMaxDepth);
+}
+
 // Test expansion of nested addrecs in CanonicalMode.
 // Expanding nested addrecs in canonical mode requiers a canonical IV of a
 // type wider than the type of the addrec itself. Currently, SCEVExpander
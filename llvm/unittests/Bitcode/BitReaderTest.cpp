@@ -14,6 +14,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -190,4 +191,91 @@ TEST(BitReaderTest, MaterializeFunctionsForBlockAddrInFunctionAfter) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+// Reads Mem with -bitcode-parallel-function-decode set to Parallel and
+// returns the printed module.
+static std::string readAndPrintModule(SmallString<1024> &Mem, bool Parallel) {
+  auto &Opts = cl::getRegisteredOptions();
+  auto *ParallelDecode =
+      static_cast<cl::opt<bool> *>(Opts["bitcode-parallel-function-decode"]);
+  auto *BatchSize =
+      static_cast<cl::opt<unsigned> *>(Opts["bitcode-function-decode-batch"]);
+  EXPECT_TRUE(ParallelDecode && BatchSize);
+  if (!ParallelDecode || !BatchSize)
+    return "";
+
+  // Use small batches so that several of them are needed.
+  unsigned OldBatchSize = *BatchSize;
+  ParallelDecode->setValue(Parallel);
+  BatchSize->setValue(2);
+
+  LLVMContext Context;
+  Expected<std::unique_ptr<Module>> ModuleOrErr =
+      parseBitcodeFile(MemoryBufferRef(Mem.str(), "test"), Context);
+  ParallelDecode->setValue(false);
+  BatchSize->setValue(OldBatchSize);
+  EXPECT_TRUE(!!ModuleOrErr);
+  if (!ModuleOrErr) {
+    consumeError(ModuleOrErr.takeError());
+    return "";
+  }
+  EXPECT_FALSE(verifyModule(**ModuleOrErr, &dbgs()));
+
+  std::string Str;
+  raw_string_ostream OS(Str);
+  (*ModuleOrErr)->print(OS, nullptr);
+  return OS.str();
+}
+
+TEST(BitReaderTest, ParallelFunctionDecode) {
+  SmallString<1024> Mem;
+  {
+    LLVMContext Context;
+    writeModuleToBuffer(
+        parseAssembly(Context,
+                      "@g = global i32 0\n"
+                      "define i32 @f(i32 %x) {\n"
+                      "entry:\n"
+                      "  switch i32 %x, label %exit [ i32 1, label %one\n"
+                      "                              i32 2, label %two ]\n"
+                      "one:\n"
+                      "  br label %exit\n"
+                      "two:\n"
+                      "  store i32 %x, i32* @g, !nontemporal !0\n"
+                      "  br label %exit\n"
+                      "exit:\n"
+                      "  %r = phi i32 [ 0, %entry ], [ 1, %one ], [ 7, %two ]\n"
+                      "  ret i32 %r\n"
+                      "}\n"
+                      "define float @h(float %y) {\n"
+                      "  %c = fadd float %y, 1.500000e+00\n"
+                      "  %v = insertelement <2 x float>\n"
+                      "      <float 0.0, float 2.0>, float %c, i32 0\n"
+                      "  %e = extractelement <2 x float> %v, i32 1\n"
+                      "  ret float %e\n"
+                      "}\n"
+                      "define i8* @addr() {\n"
+                      "  ret i8* blockaddress(@target, %bb)\n"
+                      "}\n"
+                      "define void @target() {\n"
+                      "  unreachable\n"
+                      "bb:\n"
+                      "  unreachable\n"
+                      "}\n"
+                      "define i32 @caller() {\n"
+                      "  %a = call i32 @f(i32 2)\n"
+                      "  %b = load i32, i32* @g\n"
+                      "  %s = add nsw i32 %a, %b\n"
+                      "  ret i32 %s\n"
+                      "}\n"
+                      "!0 = !{i32 1}\n"),
+        Mem);
+  }
+
+  // Decoding the function blocks ahead of time doesn't change the module
+  // that is read.
+  std::string Serial = readAndPrintModule(Mem, /*Parallel=*/false);
+  EXPECT_FALSE(Serial.empty());
+  EXPECT_EQ(readAndPrintModule(Mem, /*Parallel=*/true), Serial);
+}
+
 } // end namespace
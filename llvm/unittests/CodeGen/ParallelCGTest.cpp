@@ -0,0 +1,142 @@
+//===- ParallelCGTest.cpp - splitCodeGen unit tests -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetMachine.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// A module with four external entry points, each the only user of an
+// internal helper.
+const char *InternalCalleesIR = R"(
+  define internal i32 @helper0(i32 %x) {
+    %r = add i32 %x, 1
+    ret i32 %r
+  }
+
+  define i32 @f0(i32 %x) {
+    %r = call i32 @helper0(i32 %x)
+    ret i32 %r
+  }
+
+  define internal i32 @helper1(i32 %x) {
+    %r = mul i32 %x, %x
+    ret i32 %r
+  }
+
+  define i32 @f1(i32 %x) {
+    %r = call i32 @helper1(i32 %x)
+    ret i32 %r
+  }
+
+  define internal i32 @helper2(i32 %x) {
+    %r = sub i32 %x, 3
+    ret i32 %r
+  }
+
+  define i32 @f2(i32 %x) {
+    %r = call i32 @helper2(i32 %x)
+    ret i32 %r
+  }
+
+  define internal i32 @helper3(i32 %x) {
+    %r = xor i32 %x, 5
+    ret i32 %r
+  }
+
+  define i32 @f3(i32 %x) {
+    %r = call i32 @helper3(i32 %x)
+    ret i32 %r
+  }
+)";
+
+TEST(ParallelCGTest, PartitionsInternalFunctions) {
+  InitializeAllTargets();
+  InitializeAllTargetMCs();
+  InitializeAllAsmPrinters();
+
+  // Any target will do, but one has to be built.
+  std::string TripleName = sys::getDefaultTargetTriple();
+  std::string Error;
+  const Target *T = TargetRegistry::lookupTarget(TripleName, Error);
+  if (!T)
+    return;
+
+  LLVMContext Context;
+  SMDiagnostic SMError;
+  std::unique_ptr<Module> M =
+      parseAssemblyString(InternalCalleesIR, SMError, Context);
+  ASSERT_TRUE(M) << SMError.getMessage();
+  M->setTargetTriple(TripleName);
+
+  const unsigned NumPartitions = 4;
+  SmallVector<SmallString<0>, 4> Objs(NumPartitions), BCs(NumPartitions);
+  std::vector<std::unique_ptr<raw_svector_ostream>> Streams;
+  SmallVector<raw_pwrite_stream *, 4> OSs, BCOSs;
+  for (unsigned I = 0; I != NumPartitions; ++I) {
+    Streams.push_back(std::make_unique<raw_svector_ostream>(Objs[I]));
+    OSs.push_back(Streams.back().get());
+    Streams.push_back(std::make_unique<raw_svector_ostream>(BCs[I]));
+    BCOSs.push_back(Streams.back().get());
+  }
+
+  // Split the way llc -codegen-partitions does.
+  splitCodeGen(
+      std::move(M), OSs, BCOSs,
+      [&]() {
+        TargetOptions Options;
+        return std::unique_ptr<TargetMachine>(T->createTargetMachine(
+            TripleName, "", "", Options, None, None));
+      },
+      CGFT_AssemblyFile, /*PreserveLocals=*/true);
+
+  // Locals stay local, so each helper is placed in the partition of its
+  // caller, and the four independent pairs are spread over the partitions.
+  unsigned NumDefs = 0;
+  for (unsigned I = 0; I != NumPartitions; ++I) {
+    EXPECT_FALSE(Objs[I].empty());
+
+    LLVMContext PartContext;
+    Expected<std::unique_ptr<Module>> MPart = parseBitcodeFile(
+        MemoryBufferRef(StringRef(BCs[I].data(), BCs[I].size()), "partition"),
+        PartContext);
+    ASSERT_TRUE(!!MPart) << toString(MPart.takeError());
+
+    unsigned PartDefs = 0;
+    for (Function &F : **MPart) {
+      if (F.isDeclaration())
+        continue;
+      ++PartDefs;
+      if (!F.getName().startswith("helper")) {
+        EXPECT_FALSE(F.hasLocalLinkage()) << F.getName().str();
+        continue;
+      }
+      EXPECT_TRUE(F.hasLocalLinkage()) << F.getName().str();
+      Function *Caller =
+          (*MPart)->getFunction(("f" + F.getName().drop_front(6)).str());
+      ASSERT_TRUE(Caller) << F.getName().str();
+      EXPECT_FALSE(Caller->isDeclaration()) << F.getName().str();
+    }
+    EXPECT_EQ(PartDefs, 2u);
+    NumDefs += PartDefs;
+  }
+  EXPECT_EQ(NumDefs, 8u);
+}
+
+} // end anonymous namespace
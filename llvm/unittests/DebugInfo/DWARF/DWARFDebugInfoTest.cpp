@@ -15,6 +15,7 @@
 #include "llvm/ADT/Triple.h"
 #include "llvm/BinaryFormat/Dwarf.h"
 #include "llvm/CodeGen/AsmPrinter.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFDie.h"
@@ -32,6 +33,7 @@
 #include "llvm/Testing/Support/Error.h"
 #include "gtest/gtest.h"
 #include <string>
+#include <thread>
 
 using namespace llvm;
 using namespace dwarf;
@@ -3200,4 +3202,67 @@ TEST(DWARFDebugInfo, TestDWARF64UnitLength) {
   });
 }
 
+#if LLVM_ENABLE_THREADS
+TEST(DWARFDebugInfo, TestConcurrentDIEExtraction) {
+  // Several threads asking for the DIEs of the same unit must all see the
+  // fully extracted unit.
+  const char *yamldata = R"(
+    debug_str:
+      - ''
+      - /tmp/main.c
+      - main
+      - helper
+    debug_abbrev:
+      - Code:            0x00000001
+        Tag:             DW_TAG_compile_unit
+        Children:        DW_CHILDREN_yes
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+      - Code:            0x00000002
+        Tag:             DW_TAG_subprogram
+        Children:        DW_CHILDREN_no
+        Attributes:
+          - Attribute:       DW_AT_name
+            Form:            DW_FORM_strp
+    debug_info:
+      - Length:
+          TotalLength:     23
+        Version:         4
+        AbbrOffset:      0
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x0000000000000012
+          - AbbrCode:        0x00000000
+            Values:
+  )";
+  auto ErrOrSections = DWARFYAML::EmitDebugSections(StringRef(yamldata));
+  ASSERT_TRUE((bool)ErrOrSections);
+  std::unique_ptr<DWARFContext> DwarfContext =
+      DWARFContext::create(*ErrOrSections, 8);
+  ASSERT_EQ(1u, DwarfContext->getNumCompileUnits());
+  DWARFUnit *U = DwarfContext->getUnitAtIndex(0);
+
+  std::vector<unsigned> NumDIEs(8);
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I != NumDIEs.size(); ++I)
+    Threads.emplace_back([&, I] { NumDIEs[I] = U->getNumDIEs(); });
+  for (std::thread &T : Threads)
+    T.join();
+
+  for (unsigned N : NumDIEs)
+    EXPECT_EQ(4u, N);
+  EXPECT_STREQ("main", U->getDIEAtIndex(1).getName(DINameKind::ShortName));
+  EXPECT_STREQ("helper", U->getDIEAtIndex(2).getName(DINameKind::ShortName));
+}
+#endif
+
 } // end anonymous namespace
@@ -0,0 +1,157 @@
+//===- SymbolizerTest.cpp - Unit tests for LLVMSymbolizer -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/DebugInfo/Symbolize/Symbolize.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/ObjectYAML/yaml2obj.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::symbolize;
+
+namespace {
+
+// Modules are cached by name. Symbolizing an object with the name of a cached
+// module uses the cached module, even if the object has changed, so the
+// function found for an address tells whether the module was cached.
+class SymbolizerCacheTest : public testing::Test {
+protected:
+  // Symbolizes address 0x1000 in an object called \p Name whose only
+  // function, at that address, is called \p Function. Returns the function
+  // name found, which is the one of an earlier object if \p Name was cached.
+  std::string lookUp(LLVMSymbolizer &Symbolizer, StringRef Name,
+                     StringRef Function) {
+    std::string Yaml = (R"(
+--- !ELF
+FileHeader:
+  Class:   ELFCLASS64
+  Data:    ELFDATA2LSB
+  Type:    ET_EXEC
+  Machine: EM_X86_64
+Sections:
+  - Name:    .text
+    Type:    SHT_PROGBITS
+    Flags:   [ SHF_ALLOC, SHF_EXECINSTR ]
+    Address: 0x1000
+    Size:    16
+Symbols:
+  - Name:    )" + Function + R"(
+    Type:    STT_FUNC
+    Section: .text
+    Value:   0x1000
+    Size:    16
+    Binding: STB_GLOBAL
+)")
+                           .str();
+
+    // The symbolizer keeps pointers to the objects of cached modules, so
+    // they live as long as the test.
+    Storage.emplace_back(new SmallString<0>());
+    raw_svector_ostream OS(*Storage.back());
+    yaml::Input YIn(Yaml);
+    EXPECT_TRUE(yaml::convertYAML(YIn, OS, [](const Twine &Msg) {
+      ADD_FAILURE() << Msg.str();
+    }));
+    Expected<std::unique_ptr<object::ObjectFile>> ObjOrErr =
+        object::ObjectFile::createObjectFile(
+            MemoryBufferRef(Storage.back()->str(), Name));
+    EXPECT_THAT_EXPECTED(ObjOrErr, Succeeded());
+    if (!ObjOrErr)
+      return "";
+    Objects.push_back(std::move(*ObjOrErr));
+
+    Expected<DILineInfo> Info = Symbolizer.symbolizeCode(
+        *Objects.back(), {0x1000, object::SectionedAddress::UndefSection});
+    EXPECT_THAT_EXPECTED(Info, Succeeded());
+    if (!Info)
+      return "";
+    return Info->FunctionName;
+  }
+
+  std::vector<std::unique_ptr<SmallString<0>>> Storage;
+  std::vector<std::unique_ptr<object::ObjectFile>> Objects;
+};
+
+TEST_F(SymbolizerCacheTest, Unbounded) {
+  LLVMSymbolizer Symbolizer;
+  for (StringRef Name : {"a", "b", "c", "d"})
+    EXPECT_EQ(lookUp(Symbolizer, Name, "old"), "old");
+  for (StringRef Name : {"a", "b", "c", "d"})
+    EXPECT_EQ(lookUp(Symbolizer, Name, "new"), "old");
+}
+
+TEST_F(SymbolizerCacheTest, EvictsLeastRecentlyUsed) {
+  LLVMSymbolizer::Options Opts;
+  Opts.MaxCachedModules = 2;
+  LLVMSymbolizer Symbolizer(Opts);
+
+  EXPECT_EQ(lookUp(Symbolizer, "a", "a1"), "a1");
+  EXPECT_EQ(lookUp(Symbolizer, "b", "b1"), "b1");
+  // Using "a" makes "b" the least recently used module.
+  EXPECT_EQ(lookUp(Symbolizer, "a", "a2"), "a1");
+
+  // Loading a third module evicts "b" and keeps "a".
+  EXPECT_EQ(lookUp(Symbolizer, "c", "c1"), "c1");
+  EXPECT_EQ(lookUp(Symbolizer, "a", "a3"), "a1");
+  EXPECT_EQ(lookUp(Symbolizer, "b", "b2"), "b2");
+
+  // Loading "b" again evicted "c", the least recently used module.
+  EXPECT_EQ(lookUp(Symbolizer, "a", "a4"), "a1");
+  EXPECT_EQ(lookUp(Symbolizer, "b", "b3"), "b2");
+  EXPECT_EQ(lookUp(Symbolizer, "c", "c2"), "c2");
+}
+
+TEST_F(SymbolizerCacheTest, SingleModule) {
+  LLVMSymbolizer::Options Opts;
+  Opts.MaxCachedModules = 1;
+  LLVMSymbolizer Symbolizer(Opts);
+
+  EXPECT_EQ(lookUp(Symbolizer, "a", "a1"), "a1");
+  EXPECT_EQ(lookUp(Symbolizer, "a", "a2"), "a1");
+  EXPECT_EQ(lookUp(Symbolizer, "b", "b1"), "b1");
+  EXPECT_EQ(lookUp(Symbolizer, "a", "a3"), "a3");
+
+  // Flushing empties the cache and the LRU list with it.
+  Symbolizer.flush();
+  EXPECT_EQ(lookUp(Symbolizer, "b", "b2"), "b2");
+  EXPECT_EQ(lookUp(Symbolizer, "b", "b3"), "b2");
+}
+
+TEST_F(SymbolizerCacheTest, EvictedMissingModule) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("SymbolizerCacheTest", Dir));
+  SmallString<128> Missing(Dir);
+  sys::path::append(Missing, "missing");
+
+  LLVMSymbolizer::Options Opts;
+  Opts.MaxCachedModules = 1;
+  LLVMSymbolizer Symbolizer(Opts);
+
+  // The error for a file that doesn't exist is reported once.
+  object::SectionedAddress Addr = {0, object::SectionedAddress::UndefSection};
+  EXPECT_THAT_EXPECTED(Symbolizer.symbolizeCode(Missing.str().str(), Addr),
+                       Failed());
+  EXPECT_THAT_EXPECTED(Symbolizer.symbolizeCode(Missing.str().str(), Addr),
+                       Succeeded());
+
+  // After the module is evicted, the file is still known to be missing.
+  EXPECT_EQ(lookUp(Symbolizer, "a", "a1"), "a1");
+  Expected<DILineInfo> Info =
+      Symbolizer.symbolizeCode(Missing.str().str(), Addr);
+  ASSERT_THAT_EXPECTED(Info, Succeeded());
+  EXPECT_EQ(Info->FunctionName, DILineInfo().FunctionName);
+
+  EXPECT_FALSE(sys::fs::remove_directories(Dir));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,196 @@
+//===---- ELF_x86_64Tests.cpp - Unit tests for the ELF/x86-64 JIT linker --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/ELF_x86_64.h"
+#include "llvm/ExecutionEngine/JITLink/JITLink.h"
+#include "llvm/ExecutionEngine/JITLink/JITLinkMemoryManager.h"
+#include "llvm/ObjectYAML/yaml2obj.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+
+namespace {
+
+// Two functions in their own sections, each with an FDE, as produced by the
+// assembler for:
+//
+//   .section .text.foo,"ax",@progbits
+//   .globl foo
+//   foo: .cfi_startproc; movl $42, %eax; retq; .cfi_endproc
+//   .section .text.bar,"ax",@progbits
+//   bar: .cfi_startproc; pushq %rbp; .cfi_def_cfa_offset 16; popq %rbp
+//        .cfi_def_cfa_offset 8; retq; .cfi_endproc
+//
+// The CIE uses DW_EH_PE_pcrel | DW_EH_PE_sdata4 for the FDE pointers.
+const char *TwoFunctionsYAML = R"(
+--- !ELF
+FileHeader:
+  Class:   ELFCLASS64
+  Data:    ELFDATA2LSB
+  Type:    ET_REL
+  Machine: EM_X86_64
+Sections:
+  - Name:         .text.foo
+    Type:         SHT_PROGBITS
+    Flags:        [ SHF_ALLOC, SHF_EXECINSTR ]
+    AddressAlign: 0x1
+    Content:      B82A000000C3
+  - Name:         .text.bar
+    Type:         SHT_PROGBITS
+    Flags:        [ SHF_ALLOC, SHF_EXECINSTR ]
+    AddressAlign: 0x1
+    Content:      555DC3
+  - Name:         .eh_frame
+    Type:         SHT_PROGBITS
+    Flags:        [ SHF_ALLOC ]
+    AddressAlign: 0x8
+    Content:      1400000000000000017A5200017810011B0C070890010000100000001C0000000000000006000000000000001800000030000000000000000300000000410E10410E080000000000
+  - Name:         .rela.eh_frame
+    Type:         SHT_RELA
+    Link:         .symtab
+    Info:         .eh_frame
+    Relocations:
+      - Offset: 0x20
+        Symbol: .text.foo
+        Type:   R_X86_64_PC32
+      - Offset: 0x34
+        Symbol: .text.bar
+        Type:   R_X86_64_PC32
+Symbols:
+  - Name:    .text.foo
+    Type:    STT_SECTION
+    Section: .text.foo
+  - Name:    .text.bar
+    Type:    STT_SECTION
+    Section: .text.bar
+  - Name:    bar
+    Type:    STT_FUNC
+    Section: .text.bar
+    Size:    0x3
+  - Name:    foo
+    Type:    STT_FUNC
+    Section: .text.foo
+    Binding: STB_GLOBAL
+    Size:    0x6
+)";
+
+// Links an object in-process, marking only the symbol named LiveSymbol live,
+// and runs CheckGraph on the graph once it has been fixed up.
+class TestJITLinkContext : public JITLinkContext {
+public:
+  TestJITLinkContext(MemoryBufferRef Obj, StringRef LiveSymbol,
+                     LinkGraphPassFunction CheckGraph)
+      : Obj(Obj), LiveSymbol(LiveSymbol), CheckGraph(std::move(CheckGraph)) {}
+
+  JITLinkMemoryManager &getMemoryManager() override { return MemMgr; }
+
+  MemoryBufferRef getObjectBuffer() const override { return Obj; }
+
+  void notifyFailed(Error Err) override {
+    ADD_FAILURE() << "link failed: " << toString(std::move(Err));
+  }
+
+  void lookup(const LookupMap &Symbols,
+              std::unique_ptr<JITLinkAsyncLookupContinuation> LC) override {
+    EXPECT_TRUE(Symbols.empty()) << "test objects have no external symbols";
+    LC->run(AsyncLookupResult());
+  }
+
+  void notifyResolved(LinkGraph &G) override {}
+
+  void notifyFinalized(
+      std::unique_ptr<JITLinkMemoryManager::Allocation> A) override {
+    Alloc = std::move(A);
+  }
+
+  LinkGraphPassFunction getMarkLivePass(const Triple &TT) const override {
+    std::string Name = LiveSymbol.str();
+    return [Name](LinkGraph &G) -> Error {
+      for (auto *Sym : G.defined_symbols())
+        if (Sym->hasName() && Sym->getName() == Name)
+          Sym->setLive(true);
+      return Error::success();
+    };
+  }
+
+  Error modifyPassConfig(const Triple &TT, PassConfiguration &Config) override {
+    Config.PostFixupPasses.push_back(std::move(CheckGraph));
+    return Error::success();
+  }
+
+private:
+  MemoryBufferRef Obj;
+  StringRef LiveSymbol;
+  LinkGraphPassFunction CheckGraph;
+  InProcessMemoryManager MemMgr;
+  std::unique_ptr<JITLinkMemoryManager::Allocation> Alloc;
+};
+
+TEST(ELFx86_64Test, EHFrameKeptForLiveFunctions) {
+  SmallString<0> Storage;
+  std::string Errors;
+  yaml::Input YIn(TwoFunctionsYAML);
+  raw_svector_ostream OS(Storage);
+  ASSERT_TRUE(yaml::convertYAML(YIn, OS, [&](const Twine &Msg) {
+    Errors += Msg.str();
+  })) << Errors;
+
+  bool Checked = false;
+  auto CheckGraph = [&](LinkGraph &G) -> Error {
+    Checked = true;
+
+    Symbol *Foo = nullptr;
+    for (auto *Sym : G.defined_symbols()) {
+      if (Sym->hasName() && Sym->getName() == "foo")
+        Foo = Sym;
+      EXPECT_NE(Sym->getName(), "bar") << "bar should have been dead-stripped";
+    }
+    EXPECT_TRUE(Foo);
+
+    Section *EHFrame = G.findSectionByName(".eh_frame");
+    EXPECT_TRUE(EHFrame) << ".eh_frame was dead-stripped";
+    if (!Foo || !EHFrame)
+      return Error::success();
+
+    // Expect the CIE, foo's FDE and the null terminator, in address order.
+    std::vector<Block *> Blocks(EHFrame->blocks().begin(),
+                                EHFrame->blocks().end());
+    llvm::sort(Blocks, [](const Block *LHS, const Block *RHS) {
+      return LHS->getAddress() < RHS->getAddress();
+    });
+    EXPECT_EQ(Blocks.size(), 3U);
+    if (Blocks.size() != 3)
+      return Error::success();
+    Block &CIE = *Blocks[0], &FDE = *Blocks[1], &Terminator = *Blocks[2];
+    EXPECT_EQ(CIE.getSize(), 0x18U);
+    EXPECT_EQ(FDE.getSize(), 0x14U);
+    EXPECT_EQ(Terminator.getContent(), StringRef("\0\0\0\0", 4));
+    EXPECT_EQ(Terminator.getAddress(), FDE.getAddress() + FDE.getSize());
+
+    // The FDE's CIE pointer and PC-begin fields were fixed up for the final
+    // addresses.
+    const char *FDEContent = FDE.getContent().data();
+    EXPECT_EQ(support::endian::read32le(FDEContent + 4),
+              FDE.getAddress() + 4 - CIE.getAddress());
+    EXPECT_EQ(static_cast<int32_t>(support::endian::read32le(FDEContent + 8)),
+              static_cast<int64_t>(Foo->getAddress() -
+                                   (FDE.getAddress() + 8)));
+    return Error::success();
+  };
+
+  auto Ctx = std::make_unique<TestJITLinkContext>(
+      MemoryBufferRef(StringRef(Storage.data(), Storage.size()), "test.o"),
+      "foo", std::move(CheckGraph));
+  jitLink(std::move(Ctx));
+  EXPECT_TRUE(Checked);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,161 @@
+//===- JITLinkMemoryManagerTests.cpp - Unit tests for JIT memory managers -===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/JITLinkMemoryManager.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+using namespace llvm::jitlink;
+
+namespace {
+
+const unsigned RW = sys::Memory::MF_READ | sys::Memory::MF_WRITE;
+const unsigned RX = sys::Memory::MF_READ | sys::Memory::MF_EXEC;
+
+// Allocates a segment for each of the given protections, with ContentSize
+// bytes of content followed by ZeroFillSize bytes of zero-fill, and
+// finalizes the allocation.
+std::unique_ptr<JITLinkMemoryManager::Allocation>
+allocateAndFinalize(JITLinkMemoryManager &MemMgr, ArrayRef<unsigned> Prots,
+                    size_t ContentSize, uint64_t ZeroFillSize = 0) {
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  for (unsigned Prot : Prots)
+    Request[Prot] = JITLinkMemoryManager::SegmentRequest(8, ContentSize,
+                                                         ZeroFillSize);
+  auto Alloc = MemMgr.allocate(Request);
+  EXPECT_THAT_EXPECTED(Alloc, Succeeded());
+  if (!Alloc)
+    return nullptr;
+
+  for (unsigned Prot : Prots) {
+    auto WorkingMem = (*Alloc)->getWorkingMemory(
+        static_cast<sys::Memory::ProtectionFlags>(Prot));
+    std::memset(WorkingMem.data(), 0xC3, ContentSize);
+  }
+
+  bool Finalized = false;
+  (*Alloc)->finalizeAsync([&](Error Err) {
+    EXPECT_THAT_ERROR(std::move(Err), Succeeded());
+    Finalized = true;
+  });
+  EXPECT_TRUE(Finalized);
+  return std::move(*Alloc);
+}
+
+JITTargetAddress getAddress(JITLinkMemoryManager::Allocation &Alloc,
+                            unsigned Prot) {
+  return Alloc.getTargetMemory(static_cast<sys::Memory::ProtectionFlags>(Prot));
+}
+
+TEST(SlabMemoryManagerTest, SegmentsShareSlabs) {
+  const uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  SlabMemoryManager MemMgr;
+
+  auto A = allocateAndFinalize(MemMgr, {RW, RX}, 16);
+  auto B = allocateAndFinalize(MemMgr, {RW, RX}, 16);
+  ASSERT_TRUE(A && B);
+
+  // Segments with the same permissions are bump-allocated from the same
+  // slab, one page each.
+  EXPECT_EQ(getAddress(*B, RX), getAddress(*A, RX) + PageSize);
+  EXPECT_EQ(getAddress(*B, RW), getAddress(*A, RW) + PageSize);
+  EXPECT_EQ(getAddress(*A, RX) % PageSize, 0U);
+
+  // The content is readable through the target address after finalization.
+  EXPECT_EQ(*jitTargetAddressToPointer<const unsigned char *>(
+                getAddress(*B, RX)),
+            0xC3);
+
+  EXPECT_THAT_ERROR(A->deallocate(), Succeeded());
+  EXPECT_THAT_ERROR(B->deallocate(), Succeeded());
+}
+
+TEST(SlabMemoryManagerTest, DeallocatedMemoryIsReused) {
+  SlabMemoryManager MemMgr;
+
+  auto A = allocateAndFinalize(MemMgr, {RX}, 16);
+  ASSERT_TRUE(A);
+  JITTargetAddress Addr = getAddress(*A, RX);
+  EXPECT_THAT_ERROR(A->deallocate(), Succeeded());
+
+  // The recycled block is writable again and is handed out before any fresh
+  // slab memory.
+  auto B = allocateAndFinalize(MemMgr, {RX}, 16);
+  ASSERT_TRUE(B);
+  EXPECT_EQ(getAddress(*B, RX), Addr);
+  EXPECT_THAT_ERROR(B->deallocate(), Succeeded());
+}
+
+TEST(SlabMemoryManagerTest, SplitRecycledMemoryIsWritable) {
+  const uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  SlabMemoryManager MemMgr;
+
+  // The deallocated segment keeps its permissions until it is reused. Each
+  // part of it is made writable as it is handed out.
+  auto A = allocateAndFinalize(MemMgr, {RX}, 2 * PageSize);
+  ASSERT_TRUE(A);
+  JITTargetAddress Addr = getAddress(*A, RX);
+  EXPECT_THAT_ERROR(A->deallocate(), Succeeded());
+
+  auto B = allocateAndFinalize(MemMgr, {RX}, 16);
+  auto C = allocateAndFinalize(MemMgr, {RX}, 16);
+  ASSERT_TRUE(B && C);
+  EXPECT_EQ(getAddress(*B, RX), Addr);
+  EXPECT_EQ(getAddress(*C, RX), Addr + PageSize);
+  EXPECT_EQ(*jitTargetAddressToPointer<const unsigned char *>(
+                getAddress(*C, RX)),
+            0xC3);
+  EXPECT_THAT_ERROR(B->deallocate(), Succeeded());
+  EXPECT_THAT_ERROR(C->deallocate(), Succeeded());
+}
+
+TEST(SlabMemoryManagerTest, RecycledZeroFillIsCleared) {
+  const uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  SlabMemoryManager MemMgr;
+
+  // Dirty a whole page, then ask for the same page back as zero-fill.
+  auto A = allocateAndFinalize(MemMgr, {RW}, PageSize);
+  ASSERT_TRUE(A);
+  JITTargetAddress Addr = getAddress(*A, RW);
+  EXPECT_THAT_ERROR(A->deallocate(), Succeeded());
+
+  auto B = allocateAndFinalize(MemMgr, {RW}, 0, PageSize);
+  ASSERT_TRUE(B);
+  EXPECT_EQ(getAddress(*B, RW), Addr);
+  const char *Mem = jitTargetAddressToPointer<const char *>(Addr);
+  EXPECT_TRUE(std::all_of(Mem, Mem + PageSize, [](char C) { return C == 0; }));
+  EXPECT_THAT_ERROR(B->deallocate(), Succeeded());
+}
+
+TEST(SlabMemoryManagerTest, SegmentsLargerThanASlab) {
+  const uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  SlabMemoryManager MemMgr(2 * PageSize);
+
+  auto Small = allocateAndFinalize(MemMgr, {RX}, 16);
+  auto Large = allocateAndFinalize(MemMgr, {RX}, 4 * PageSize);
+  auto Next = allocateAndFinalize(MemMgr, {RX}, 16);
+  ASSERT_TRUE(Small && Large && Next);
+
+  // The large segment gets a slab of its own and does not disturb the slab
+  // that the small segments come from.
+  EXPECT_EQ(getAddress(*Next, RX), getAddress(*Small, RX) + PageSize);
+  const unsigned char *Mem =
+      jitTargetAddressToPointer<const unsigned char *>(getAddress(*Large, RX));
+  EXPECT_EQ(Mem[4 * PageSize - 1], 0xC3);
+
+  EXPECT_THAT_ERROR(Small->deallocate(), Succeeded());
+  EXPECT_THAT_ERROR(Large->deallocate(), Succeeded());
+  EXPECT_THAT_ERROR(Next->deallocate(), Succeeded());
+}
+
+} // end anonymous namespace
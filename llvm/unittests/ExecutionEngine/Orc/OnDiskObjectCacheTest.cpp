@@ -0,0 +1,120 @@
+//===- OnDiskObjectCacheTest.cpp - Unit tests for OnDiskObjectCache -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/OnDiskObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class OnDiskObjectCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("OnDiskObjectCacheTest",
+                                                TestDirectory));
+    // Let the cache create its directory on first use.
+    CacheDir = (TestDirectory + "/cache").str();
+  }
+
+  void TearDown() override {
+    EXPECT_FALSE(sys::fs::remove_directories(TestDirectory));
+  }
+
+  std::unique_ptr<Module> createModule(StringRef FunctionName) {
+    auto M = std::make_unique<Module>("test", Context);
+    M->setTargetTriple("x86_64-unknown-linux-gnu");
+    Function::Create(FunctionType::get(Type::getVoidTy(Context), false),
+                     GlobalValue::ExternalLinkage, FunctionName, M.get());
+    return M;
+  }
+
+  // Stores Obj for M the way a compiler does: it queries the cache, which
+  // misses, and then reports the object it compiled.
+  void compile(OnDiskObjectCache &Cache, const Module &M, StringRef Obj) {
+    EXPECT_FALSE(Cache.getObject(&M));
+    Cache.notifyObjectCompiled(&M, MemoryBufferRef(Obj, "obj"));
+  }
+
+  LLVMContext Context;
+  SmallString<128> TestDirectory;
+  std::string CacheDir;
+};
+
+TEST_F(OnDiskObjectCacheTest, ObjectsPersistAcrossInstances) {
+  auto M = createModule("f");
+  {
+    OnDiskObjectCache Cache(CacheDir, "x86-64");
+    compile(Cache, *M, "object for f");
+  }
+
+  // A fresh cache for the same directory, as a later process would create,
+  // finds the object.
+  OnDiskObjectCache Cache(CacheDir, "x86-64");
+  std::unique_ptr<MemoryBuffer> Obj = Cache.getObject(M.get());
+  ASSERT_TRUE(Obj);
+  EXPECT_EQ(Obj->getBuffer(), "object for f");
+
+  // Different modules and different extra keys miss.
+  EXPECT_FALSE(Cache.getObject(createModule("g").get()));
+  EXPECT_FALSE(OnDiskObjectCache(CacheDir, "skylake").getObject(M.get()));
+}
+
+TEST_F(OnDiskObjectCacheTest, KeyIsComputedBeforeCodeGen) {
+  OnDiskObjectCache Cache(CacheDir);
+  auto M = createModule("f");
+  EXPECT_FALSE(Cache.getObject(M.get()));
+
+  // Code generation may change the module before the object is reported.
+  // The object is still stored under the key of the original module.
+  M->getFunction("f")->addFnAttr(Attribute::NoUnwind);
+  Cache.notifyObjectCompiled(M.get(), MemoryBufferRef("object", "obj"));
+
+  std::unique_ptr<MemoryBuffer> Obj = Cache.getObject(createModule("f").get());
+  ASSERT_TRUE(Obj);
+  EXPECT_EQ(Obj->getBuffer(), "object");
+  EXPECT_FALSE(Cache.getObject(M.get()));
+}
+
+TEST_F(OnDiskObjectCacheTest, UnexpectedObjectsAreNotStored) {
+  OnDiskObjectCache Cache(CacheDir);
+  auto M = createModule("f");
+
+  // Without a preceding query there is no key for the object, so it is
+  // dropped and the cache directory is not even created.
+  Cache.notifyObjectCompiled(M.get(), MemoryBufferRef("object", "obj"));
+  EXPECT_FALSE(sys::fs::exists(CacheDir));
+  EXPECT_FALSE(Cache.getObject(M.get()));
+}
+
+TEST_F(OnDiskObjectCacheTest, FailedCompilesForgetTheKey) {
+  OnDiskObjectCache Cache(CacheDir);
+  auto M = createModule("f");
+  EXPECT_FALSE(Cache.getObject(M.get()));
+  Cache.notifyCompileFailed(M.get());
+
+  // The key of the failed compile is gone, so an object reported later for
+  // the same address is dropped like any other unexpected object.
+  Cache.notifyObjectCompiled(M.get(), MemoryBufferRef("object", "obj"));
+  EXPECT_FALSE(sys::fs::exists(CacheDir));
+
+  // A new query computes the key again and the object is stored.
+  compile(Cache, *M, "object");
+  std::unique_ptr<MemoryBuffer> Obj = Cache.getObject(M.get());
+  ASSERT_TRUE(Obj);
+  EXPECT_EQ(Obj->getBuffer(), "object");
+}
+
+} // end anonymous namespace
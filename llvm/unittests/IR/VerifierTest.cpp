@@ -93,6 +93,37 @@ TEST(VerifierTest, Freeze) {
   FI->eraseFromParent();
 }
 
+TEST(VerifierTest, GetActiveLaneMask) {
+  LLVMContext C;
+  Module M("M", C);
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), /*isVarArg=*/false);
+  Function *F = Function::Create(FTy, Function::ExternalLinkage, "foo", M);
+  BasicBlock *Entry = BasicBlock::Create(C, "entry", F);
+  IRBuilder<> Builder(Entry);
+  Value *Base = Builder.getInt64(0);
+  Value *BTC = Builder.getInt64(7);
+
+  // Valid type : <4 x i1>
+  Builder.CreateIntrinsic(Intrinsic::get_active_lane_mask,
+                          {VectorType::get(Builder.getInt1Ty(), 4),
+                           Builder.getInt64Ty()},
+                          {Base, BTC});
+  Builder.CreateRetVoid();
+  EXPECT_FALSE(verifyFunction(*F));
+
+  // Invalid type : <4 x i32>
+  Builder.SetInsertPoint(Entry->getTerminator());
+  Builder.CreateIntrinsic(Intrinsic::get_active_lane_mask,
+                          {VectorType::get(Builder.getInt32Ty(), 4),
+                           Builder.getInt64Ty()},
+                          {Base, BTC});
+  std::string Error;
+  raw_string_ostream ErrorOS(Error);
+  EXPECT_TRUE(verifyFunction(*F, &ErrorOS));
+  EXPECT_TRUE(StringRef(ErrorOS.str())
+                  .startswith("get_active_lane_mask: element type is not i1"));
+}
+
 TEST(VerifierTest, InvalidRetAttribute) {
   LLVMContext C;
   Module M("M", C);
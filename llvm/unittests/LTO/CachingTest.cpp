@@ -0,0 +1,133 @@
+//===- CachingTest.cpp - Unit tests for the ThinLTO caches ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/LTO/Caching.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+#include <mutex>
+
+using namespace llvm;
+using namespace llvm::lto;
+
+namespace {
+
+// An in-memory RemoteCacheStore that can be made to fail.
+class FakeRemoteStore : public RemoteCacheStore {
+public:
+  Expected<std::unique_ptr<MemoryBuffer>> fetch(StringRef Key) override {
+    std::lock_guard<std::mutex> Lock(M);
+    ++NumFetches;
+    if (Fail)
+      return make_error<StringError>("store unreachable",
+                                     inconvertibleErrorCode());
+    auto I = Objects.find(Key);
+    if (I == Objects.end())
+      return nullptr;
+    return MemoryBuffer::getMemBufferCopy(I->second);
+  }
+
+  Error store(StringRef Key, MemoryBufferRef Object) override {
+    std::lock_guard<std::mutex> Lock(M);
+    if (Fail)
+      return make_error<StringError>("store unreachable",
+                                     inconvertibleErrorCode());
+    Objects[Key] = Object.getBuffer().str();
+    return Error::success();
+  }
+
+  std::mutex M;
+  StringMap<std::string> Objects;
+  unsigned NumFetches = 0;
+  bool Fail = false;
+};
+
+class RemoteCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(
+        sys::fs::createUniqueDirectory("RemoteCacheTest", CacheDirectory));
+    Store = std::make_shared<FakeRemoteStore>();
+  }
+
+  void TearDown() override {
+    EXPECT_FALSE(sys::fs::remove_directories(CacheDirectory));
+  }
+
+  NativeObjectCache createCache() {
+    auto CacheOrErr = remoteCache(
+        CacheDirectory, Store,
+        [this](unsigned Task, std::unique_ptr<MemoryBuffer> MB) {
+          Added.push_back(MB->getBuffer().str());
+        });
+    EXPECT_THAT_EXPECTED(CacheOrErr, Succeeded());
+    return CacheOrErr ? std::move(*CacheOrErr) : NativeObjectCache();
+  }
+
+  // Looks Key up in Cache and, on a miss, builds Contents for it the way
+  // LTO::run() does. Returns true on a hit.
+  bool lookupOrBuild(NativeObjectCache &Cache, StringRef Key,
+                     StringRef Contents) {
+    AddStreamFn AddStream = Cache(0, Key);
+    if (!AddStream)
+      return true;
+    *AddStream(0)->OS << Contents;
+    return false;
+  }
+
+  SmallString<128> CacheDirectory;
+  std::shared_ptr<FakeRemoteStore> Store;
+  std::vector<std::string> Added;
+};
+
+TEST_F(RemoteCacheTest, MissesAreUploaded) {
+  NativeObjectCache Cache = createCache();
+  EXPECT_FALSE(lookupOrBuild(Cache, "key", "built"));
+
+  // The object built on a miss is added to the link and uploaded.
+  EXPECT_EQ(Added, std::vector<std::string>{"built"});
+  EXPECT_EQ(Store->Objects.lookup("key"), "built");
+
+  // After that it is a local hit, without going to the store.
+  unsigned NumFetches = Store->NumFetches;
+  EXPECT_TRUE(lookupOrBuild(Cache, "key", "rebuilt"));
+  EXPECT_EQ(Store->NumFetches, NumFetches);
+  EXPECT_EQ(Added.back(), "built");
+}
+
+TEST_F(RemoteCacheTest, RemoteHitsAreCopiedLocally) {
+  Store->Objects["key"] = "remote";
+  NativeObjectCache Cache = createCache();
+  EXPECT_TRUE(lookupOrBuild(Cache, "key", "built"));
+  EXPECT_EQ(Added, std::vector<std::string>{"remote"});
+
+  // The object is now in the local cache, so it is found even when the store
+  // is unreachable.
+  Store->Fail = true;
+  EXPECT_TRUE(lookupOrBuild(Cache, "key", "built"));
+  EXPECT_EQ(Added.back(), "remote");
+}
+
+TEST_F(RemoteCacheTest, StoreErrorsAreMisses) {
+  Store->Fail = true;
+  NativeObjectCache Cache = createCache();
+  EXPECT_FALSE(lookupOrBuild(Cache, "key", "built"));
+
+  // The failed upload does not keep the object from the link or the local
+  // cache.
+  EXPECT_EQ(Added, std::vector<std::string>{"built"});
+  EXPECT_TRUE(Store->Objects.empty());
+  EXPECT_TRUE(lookupOrBuild(Cache, "key", "rebuilt"));
+  EXPECT_EQ(Added.back(), "built");
+}
+
+} // end anonymous namespace
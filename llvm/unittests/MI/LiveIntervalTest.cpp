@@ -462,6 +462,39 @@ TEST(LiveIntervalTest, TestMoveSubRegDefAcrossUseDefMulti) {
      testHandleMove(MF, LIS, 4, 1, 1);
   });
 }
+TEST(LiveIntervalTest, InsertInstrRangeInMaps) {
+  // Insert more instructions than the gap between two indexes has room for,
+  // so that the index list has to be renumbered.
+  liveIntervalTest(R"MIR(
+    S_NOP 0
+    S_NOP 0
+)MIR", [](MachineFunction &MF, LiveIntervals &LIS) {
+    MachineInstr &First = getMI(MF, 0, 0);
+    MachineBasicBlock &MBB = *First.getParent();
+    MachineBasicBlock::iterator InsertPt = std::next(First.getIterator());
+    MachineBasicBlock::iterator Begin = InsertPt;
+    for (unsigned I = 0; I != 40; ++I) {
+      MachineInstr *NewMI = MF.CloneMachineInstr(&First);
+      MBB.insert(InsertPt, NewMI);
+      if (I == 0)
+        Begin = NewMI->getIterator();
+    }
+    LIS.InsertMachineInstrRangeInMaps(Begin, InsertPt);
+
+    SlotIndexes &Indexes = *LIS.getSlotIndexes();
+    SlotIndex Prev;
+    for (MachineInstr &MI : MBB) {
+      ASSERT_TRUE(Indexes.hasIndex(MI));
+      SlotIndex Idx = LIS.getInstructionIndex(MI);
+      EXPECT_EQ(Indexes.getInstructionFromIndex(Idx), &MI);
+      if (Prev.isValid())
+        EXPECT_TRUE(Prev < Idx);
+      Prev = Idx;
+    }
+    EXPECT_TRUE(Prev < Indexes.getMBBEndIdx(&MBB));
+  });
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   initLLVM();
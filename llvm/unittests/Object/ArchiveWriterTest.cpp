@@ -0,0 +1,55 @@
+//===- ArchiveWriterTest.cpp - Tests for ArchiveWriter.cpp ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/ArchiveWriter.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+TEST(ArchiveWriterTest, OversizedMember) {
+  if (sizeof(void *) < 8)
+    return;
+
+  // Back the oversized member by a sparse file, so that the test needs
+  // neither the disk space nor the memory for it.
+  int FD;
+  SmallString<128> BigPath;
+  ASSERT_FALSE(
+      sys::fs::createTemporaryFile("archive-big-member", "o", FD, BigPath));
+  FileRemover BigRemover(BigPath);
+  ASSERT_FALSE(sys::fs::resize_file(FD, Archive::MaxMemberSize + 1));
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BigBuf = MemoryBuffer::getOpenFile(
+      sys::fs::convertFDToNativeFile(FD), BigPath, -1,
+      /*RequiresNullTerminator=*/false);
+  sys::Process::SafelyCloseFileDescriptor(FD);
+  if (!BigBuf)
+    return;
+
+  std::vector<NewArchiveMember> Members(2);
+  Members[0].Buf = MemoryBuffer::getMemBuffer("small", "small.o");
+  Members[0].MemberName = "small.o";
+  Members[1].Buf = std::move(*BigBuf);
+  Members[1].MemberName = "big.o";
+
+  SmallString<128> ArchivePath;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("archive-big", "a", ArchivePath));
+  FileRemover ArchiveRemover(ArchivePath);
+  Error E = writeArchive(ArchivePath, Members, /*WriteSymtab=*/true,
+                         Archive::K_GNU, /*Deterministic=*/true,
+                         /*Thin=*/false);
+  EXPECT_EQ("File big.o exceeds size limit", toString(std::move(E)));
+}
+
+} // namespace
@@ -11,6 +11,7 @@
 #include "llvm/ProfileData/Coverage/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/ProfileData/InstrProfWriter.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Testing/Support/Error.h"
 #include "llvm/Testing/Support/SupportHelpers.h"
@@ -895,4 +896,70 @@ INSTANTIATE_TEST_CASE_P(ParameterizedCovMapTest, CoverageMappingTest,
                                           std::pair<bool, bool>({true, false}),
                                           std::pair<bool, bool>({true, true})),);
 
+// Loads coverage from files on disk: an empty indexed profile, plus an ELF
+// object with no sections at all and so no coverage data.
+class CoverageMappingFileTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ProfilePath = writeTempFile("profile", "profdata", [](raw_fd_ostream &OS) {
+      InstrProfWriter Writer;
+      Writer.write(OS);
+    });
+    ObjectPath = writeTempFile("nocov", "o", [](raw_fd_ostream &OS) {
+      // A 64-bit little-endian x86-64 relocatable ELF header, no sections.
+      const uint8_t Header[64] = {
+          0x7f, 'E', 'L', 'F', 2, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          1,    0,   62,  0,   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0,    0,   0,   0,   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0,    0,   0,   0,   64, 0, 0, 0, 0, 0, 64, 0, 0, 0, 0, 0};
+      OS.write(reinterpret_cast<const char *>(Header), sizeof(Header));
+    });
+    MissingPath = ObjectPath + ".missing";
+  }
+
+  void TearDown() override {
+    sys::fs::remove(ProfilePath);
+    sys::fs::remove(ObjectPath);
+  }
+
+  template <typename WriteFn>
+  std::string writeTempFile(StringRef Prefix, StringRef Suffix,
+                            WriteFn Write) {
+    int FD;
+    SmallString<128> Path;
+    EXPECT_FALSE(sys::fs::createTemporaryFile(Prefix, Suffix, FD, Path));
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    Write(OS);
+    return std::string(Path.str());
+  }
+
+  Expected<std::unique_ptr<CoverageMapping>>
+  load(ArrayRef<StringRef> Objects) {
+    return CoverageMapping::load(Objects, ProfilePath);
+  }
+
+  std::string ProfilePath;
+  std::string ObjectPath;
+  std::string MissingPath;
+};
+
+TEST_F(CoverageMappingFileTest, missing_object_file) {
+  EXPECT_THAT_EXPECTED(load({MissingPath}), Failed());
+  // The other objects' results are dropped along with the error.
+  EXPECT_THAT_EXPECTED(load({ObjectPath, MissingPath, ObjectPath}), Failed());
+}
+
+TEST_F(CoverageMappingFileTest, object_without_coverage) {
+  // An object without coverage data isn't an error by itself, but coverage
+  // needs at least one object that has some.
+  auto CoverageOrErr = load({ObjectPath});
+  ASSERT_FALSE(CoverageOrErr);
+  EXPECT_TRUE(ErrorEquals(coveragemap_error::no_data_found,
+                          CoverageOrErr.takeError()));
+  CoverageOrErr = load({ObjectPath, ObjectPath});
+  ASSERT_FALSE(CoverageOrErr);
+  EXPECT_TRUE(ErrorEquals(coveragemap_error::no_data_found,
+                          CoverageOrErr.takeError()));
+}
+
 } // end anonymous namespace
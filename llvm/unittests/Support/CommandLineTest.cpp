@@ -136,6 +136,42 @@ TEST(CommandLineTest, ModifyExisitingOption) {
   ASSERT_EQ(cl::Hidden, TestOption.getOptionHiddenFlag()) <<
     "Failed to modify option's hidden flag.";
 }
+
+TEST(CommandLineTest, ModifyOptionBeforeLookup) {
+  // Options are only added to the map when it is first looked up, so renaming
+  // or removing an option before that must not leave stale entries behind.
+  StackOption<int> Renamed("renamed-option-old");
+  Renamed.setArgStr("renamed-option-new");
+  {
+    StackOption<int> Removed("removed-option");
+  }
+
+  StringMap<cl::Option *> &Map =
+      cl::getRegisteredOptions(*cl::TopLevelSubCommand);
+  EXPECT_EQ(0u, Map.count("renamed-option-old"));
+  EXPECT_EQ(&Renamed, Map.lookup("renamed-option-new"));
+  EXPECT_EQ(0u, Map.count("removed-option"));
+}
+
+TEST(CommandLineTest, RegisterOptionDuringParse) {
+  // Like -load, -load-plugin registers a new option partway through the
+  // parse, and later arguments must be able to use it.
+  std::unique_ptr<StackOption<int>> PluginOption;
+  StackOption<bool> LoadPlugin(
+      "load-plugin", cl::callback([&](const bool &) {
+        PluginOption = std::make_unique<StackOption<int>>("plugin-option");
+      }));
+
+  const char *Args[] = {"prog", "-load-plugin", "-plugin-option=3"};
+  EXPECT_TRUE(
+      cl::ParseCommandLineOptions(3, Args, StringRef(), &llvm::nulls()));
+  ASSERT_TRUE(PluginOption);
+  EXPECT_EQ(3, *PluginOption);
+  EXPECT_EQ(PluginOption.get(), cl::getRegisteredOptions().lookup(
+                                    "plugin-option"));
+  cl::ResetAllOptionOccurrences();
+}
+
 #ifndef SKIP_ENVIRONMENT_TESTS
 
 const char test_env_var[] = "LLVM_TEST_COMMAND_LINE_FLAGS";
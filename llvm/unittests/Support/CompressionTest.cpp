@@ -71,6 +71,46 @@ TEST(CompressionTest, ZlibCRC32) {
       zlib::crc32(StringRef("The quick brown fox jumps over the lazy dog")));
 }
 
+TEST(CompressionTest, ZlibAdler32) {
+  StringRef Input("The quick brown fox jumps over the lazy dog");
+  EXPECT_EQ(0x5BDC0FDAU, zlib::adler32(Input));
+  EXPECT_EQ(zlib::adler32(Input),
+            zlib::adler32Combine(zlib::adler32(Input.take_front(10)),
+                                 zlib::adler32(Input.drop_front(10)),
+                                 Input.size() - 10));
+}
+
+TEST(CompressionTest, ZlibRawShards) {
+  const size_t kSize = 4096;
+  std::string Input;
+  for (size_t i = 0; i < kSize; ++i)
+    Input += 'a' + (i * i) % 26;
+  StringRef Shards[] = {StringRef(Input).take_front(1000),
+                        StringRef(Input).slice(1000, 3000), StringRef(),
+                        StringRef(Input).drop_front(3000)};
+
+  // Independently compressed shards form a single zlib stream once they are
+  // given a header and the combined checksum.
+  SmallString<32> Compressed("\x78\x01");
+  uint32_t Checksum = zlib::adler32("");
+  for (size_t I = 0, E = array_lengthof(Shards); I != E; ++I) {
+    Error Err = zlib::compressRaw(Shards[I], Compressed,
+                                  zlib::DefaultCompression, I + 1 == E);
+    EXPECT_FALSE(Err);
+    consumeError(std::move(Err));
+    Checksum = zlib::adler32Combine(Checksum, zlib::adler32(Shards[I]),
+                                    Shards[I].size());
+  }
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    Compressed.push_back((Checksum >> Shift) & 0xff);
+
+  SmallString<32> Uncompressed;
+  Error E = zlib::uncompress(Compressed, Uncompressed, Input.size());
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+  EXPECT_EQ(Input, Uncompressed);
+}
+
 #endif
 
 }
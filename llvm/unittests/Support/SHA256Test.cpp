@@ -0,0 +1,74 @@
+//===- llvm/unittest/Support/SHA256Test.cpp - SHA256 tests ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/SHA256.h"
+#include "llvm/ADT/StringExtras.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+std::string hashToHex(StringRef Input) {
+  SHA256 Hash;
+  Hash.update(Input);
+  return toHex(Hash.final());
+}
+
+TEST(SHA256Test, Basic) {
+  EXPECT_EQ("E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855",
+            hashToHex(""));
+  EXPECT_EQ("BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD",
+            hashToHex("abc"));
+  EXPECT_EQ(
+      "248D6A61D20638B8E5C026930C3E6039A33CE45964FF2167F6ECEDD419DB06C1",
+      hashToHex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+
+  std::array<uint8_t, 32> Vec =
+      SHA256::hash(arrayRefFromStringRef("Hello World!"));
+  EXPECT_EQ("7F83B1657FF1FC53B92DC18148A1D65DFC2D4B1FA3D677284ADDD200126D9069",
+            toHex(makeArrayRef(Vec)));
+}
+
+// Hash many blocks at once, split at offsets that are not multiples of the
+// block size, so that both the buffered and the whole-block paths are used.
+TEST(SHA256Test, MultipleBlocks) {
+  std::vector<uint8_t> Input(1000);
+  for (size_t I = 0; I < Input.size(); ++I)
+    Input[I] = I * 131 + 7;
+  std::string Expected =
+      "533B698850849B7908B20A22658F639C0B2A476F1791F85F50188287C31A9ABA";
+
+  std::array<uint8_t, 32> Vec = SHA256::hash(Input);
+  EXPECT_EQ(Expected, toHex(makeArrayRef(Vec)));
+
+  SHA256 Hash;
+  ArrayRef<uint8_t> Data(Input);
+  for (size_t Chunk : {1, 63, 65, 128, 743}) {
+    Hash.update(Data.take_front(Chunk));
+    Data = Data.drop_front(Chunk);
+  }
+  ASSERT_TRUE(Data.empty());
+  EXPECT_EQ(Expected, toHex(Hash.final()));
+}
+
+// Check that getting the intermediate hash in the middle of the stream does
+// not invalidate the final result.
+TEST(SHA256Test, Intermediate) {
+  SHA256 Hash;
+  Hash.update("Hello");
+  EXPECT_EQ("185F8DB32271FE25F561A6FC938B2E264306EC304EDA518007D1764826381969",
+            toHex(Hash.result()));
+  Hash.update(" World!");
+  EXPECT_EQ("7F83B1657FF1FC53B92DC18148A1D65DFC2D4B1FA3D677284ADDD200126D9069",
+            toHex(Hash.final()));
+}
+
+} // end anonymous namespace
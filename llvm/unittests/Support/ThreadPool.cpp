@@ -129,6 +129,21 @@ TEST_F(ThreadPoolTest, Async) {
   ASSERT_EQ(2, i.load());
 }
 
+TEST_F(ThreadPoolTest, Priority) {
+  CHECK_UNSUPPORTED();
+  ThreadPool Pool(1);
+  std::vector<int> Order;
+  // Keep the only thread busy until every task has been queued.
+  Pool.asyncWithPriority(3, [this] { waitForMainThread(); });
+  Pool.asyncWithPriority(0, [&Order] { Order.push_back(0); });
+  Pool.asyncWithPriority(2, [&Order] { Order.push_back(2); });
+  Pool.asyncWithPriority(1, [&Order] { Order.push_back(1); });
+  Pool.asyncWithPriority(2, [&Order] { Order.push_back(3); });
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(std::vector<int>({2, 3, 1, 0}), Order);
+}
+
 TEST_F(ThreadPoolTest, GetFuture) {
   CHECK_UNSUPPORTED();
   ThreadPool Pool{2};
@@ -7,6 +7,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Timer.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 #if _WIN32
@@ -61,4 +63,42 @@ TEST(Timer, CheckIfTriggered) {
   EXPECT_FALSE(T1.hasTriggered());
 }
 
+TEST(Timer, PerfCounters) {
+  auto *Opt = static_cast<cl::opt<bool> *>(
+      cl::getRegisteredOptions()["track-perf-counters"]);
+  ASSERT_TRUE(Opt);
+
+  // Without the option no counters are read.
+  TimerGroup Untracked("untracked", "Untracked");
+  Timer T1("T1", "T1", Untracked);
+  T1.startTimer();
+  SleepMS();
+  T1.stopTimer();
+  EXPECT_FALSE(T1.getTotalTime().hasPerfCounters());
+
+  // With it, the counters are read if the kernel provides them. The output
+  // only has the counter columns if it does.
+  Opt->setValue(true);
+  TimerGroup Tracked("tracked", "Tracked");
+  Timer T2("T2", "T2", Tracked);
+  T2.startTimer();
+  volatile unsigned Sum = 0;
+  for (unsigned I = 0; I != 100000; ++I)
+    Sum += I;
+  T2.stopTimer();
+  TimeRecord TR = T2.getTotalTime();
+  Opt->setValue(false);
+
+  std::string Output;
+  raw_string_ostream OS(Output);
+  Tracked.print(OS);
+  OS.flush();
+  if (TR.hasPerfCounters()) {
+    EXPECT_GT(TR.getInstructions(), 100000u);
+    EXPECT_NE(Output.find("Instructions        Cycles"), std::string::npos);
+  } else {
+    EXPECT_EQ(Output.find("Instructions"), std::string::npos);
+  }
+}
+
 } // end anon namespace
@@ -14,6 +14,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Testing/Support/Error.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include <map>
@@ -934,6 +935,159 @@ TEST(ProxyFileSystemTest, Basic) {
   EXPECT_FALSE(Local);
 }
 
+namespace {
+/// Counts the status calls that reach the wrapped file system.
+class CountingFileSystem : public vfs::ProxyFileSystem {
+public:
+  explicit CountingFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  ErrorOr<vfs::Status> status(const Twine &Path) override {
+    ++NumStatusCalls;
+    return ProxyFileSystem::status(Path);
+  }
+
+  unsigned NumStatusCalls = 0;
+};
+
+std::unique_ptr<MemoryBuffer> writeStatCache(vfs::FileSystem &FS,
+                                             ArrayRef<std::string> Roots) {
+  std::string Cache;
+  raw_string_ostream OS(Cache);
+  EXPECT_FALSE(
+      errorToBool(vfs::StatCacheFileSystem::writeStatCache(FS, Roots, OS)));
+  return MemoryBuffer::getMemBufferCopy(OS.str(), "stat-cache");
+}
+} // end anonymous namespace
+
+TEST(StatCacheFileSystemTest, Basic) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Base(
+      new vfs::InMemoryFileSystem());
+  Base->addFile("/sdk/include/a.h", 0, MemoryBuffer::getMemBuffer("a"));
+  Base->addFile("/sdk/include/sys/b.h", 0, MemoryBuffer::getMemBuffer("bb"));
+  Base->addFile("/other/c.h", 0, MemoryBuffer::getMemBuffer("c"));
+
+  IntrusiveRefCntPtr<CountingFileSystem> Counting(
+      new CountingFileSystem(Base));
+  auto FS = vfs::StatCacheFileSystem::create(
+      writeStatCache(*Base, {"/sdk"}), Counting);
+  ASSERT_THAT_EXPECTED(FS, Succeeded());
+
+  auto Stat = (*FS)->status("/sdk/include/sys/b.h");
+  ASSERT_FALSE(Stat.getError());
+  EXPECT_TRUE(Stat->isRegularFile());
+  EXPECT_EQ("/sdk/include/sys/b.h", Stat->getName());
+  EXPECT_EQ(2u, Stat->getSize());
+  EXPECT_EQ(Base->status("/sdk/include/sys/b.h")->getUniqueID(),
+            Stat->getUniqueID());
+
+  // Negative lookups below a cached directory only reach the base to check
+  // that the directory has not changed, once per directory.
+  unsigned Calls = Counting->NumStatusCalls;
+  EXPECT_EQ((*FS)->status("/sdk/include/sys/missing.h").getError(),
+            errc::no_such_file_or_directory);
+  EXPECT_EQ((*FS)->status("/sdk/include/missing/x.h").getError(),
+            errc::no_such_file_or_directory);
+  EXPECT_EQ((*FS)->openFileForRead("/sdk/include/missing.h").getError(),
+            errc::no_such_file_or_directory);
+  EXPECT_EQ((*FS)->status("/sdk/include/sys/missing2.h").getError(),
+            errc::no_such_file_or_directory);
+  EXPECT_EQ(Calls + 2, Counting->NumStatusCalls);
+
+  // Paths outside of the cache are forwarded.
+  EXPECT_FALSE((*FS)->status("/other/c.h").getError());
+
+  auto File = (*FS)->openFileForRead("/sdk/include/a.h");
+  ASSERT_FALSE(File.getError());
+  EXPECT_EQ("a", (*(*File)->getBuffer("ignored"))->getBuffer());
+}
+
+TEST(StatCacheFileSystemTest, ChangedDirectory) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Old(
+      new vfs::InMemoryFileSystem());
+  Old->addFile("/sdk/include/a.h", 0, MemoryBuffer::getMemBuffer("a"));
+  std::unique_ptr<MemoryBuffer> Cache = writeStatCache(*Old, {"/sdk"});
+
+  // The same tree with a different modification time on the directory that
+  // gained a header. In-memory directories take the time of the first file.
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> New(
+      new vfs::InMemoryFileSystem());
+  New->addFile("/sdk/include/b.h", 1, MemoryBuffer::getMemBuffer("b"));
+  New->addFile("/sdk/include/a.h", 0, MemoryBuffer::getMemBuffer("a"));
+  ASSERT_NE(Old->status("/sdk/include")->getLastModificationTime(),
+            New->status("/sdk/include")->getLastModificationTime());
+
+  auto FS = vfs::StatCacheFileSystem::create(std::move(Cache), New);
+  ASSERT_THAT_EXPECTED(FS, Succeeded());
+  EXPECT_FALSE((*FS)->status("/sdk/include/b.h").getError());
+  EXPECT_FALSE((*FS)->status("/sdk/include/a.h").getError());
+}
+
+TEST(StatCacheFileSystemTest, ModifiedInPlace) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Old(
+      new vfs::InMemoryFileSystem());
+  Old->addFile("/sdk/include/a.h", 0, MemoryBuffer::getMemBuffer("a"));
+  std::unique_ptr<MemoryBuffer> Cache = writeStatCache(*Old, {"/sdk"});
+
+  // Rewriting a file in place leaves its directory unchanged.
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> New(
+      new vfs::InMemoryFileSystem());
+  New->addFile("/sdk/include/a.h", 0, MemoryBuffer::getMemBuffer("aaaa"));
+  ASSERT_EQ(Old->status("/sdk/include")->getLastModificationTime(),
+            New->status("/sdk/include")->getLastModificationTime());
+
+  auto FS = vfs::StatCacheFileSystem::create(std::move(Cache), New);
+  ASSERT_THAT_EXPECTED(FS, Succeeded());
+  auto Stat = (*FS)->status("/sdk/include/a.h");
+  ASSERT_FALSE(Stat.getError());
+  EXPECT_EQ(4u, Stat->getSize());
+}
+
+namespace {
+/// Looks up names in the wrapped file system in lower case, like a case
+/// insensitive file system holding lower case names.
+class LowerCaseFileSystem : public vfs::ProxyFileSystem {
+public:
+  explicit LowerCaseFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  ErrorOr<vfs::Status> status(const Twine &Path) override {
+    return ProxyFileSystem::status(StringRef(Path.str()).lower());
+  }
+  ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    return ProxyFileSystem::openFileForRead(StringRef(Path.str()).lower());
+  }
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    return ProxyFileSystem::dir_begin(StringRef(Dir.str()).lower(), EC);
+  }
+};
+} // end anonymous namespace
+
+TEST(StatCacheFileSystemTest, CaseInsensitive) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Base(
+      new vfs::InMemoryFileSystem());
+  Base->addFile("/sdk/include/a.h", 0, MemoryBuffer::getMemBuffer("a"));
+  IntrusiveRefCntPtr<LowerCaseFileSystem> Lower(new LowerCaseFileSystem(Base));
+
+  auto FS = vfs::StatCacheFileSystem::create(
+      writeStatCache(*Lower, {"/SDK"}), Lower);
+  ASSERT_THAT_EXPECTED(FS, Succeeded());
+  EXPECT_FALSE((*FS)->status("/sdk/Include/A.h").getError());
+  EXPECT_FALSE((*FS)->openFileForRead("/SDK/include/a.H").getError());
+  EXPECT_EQ((*FS)->status("/Sdk/include/B.h").getError(),
+            errc::no_such_file_or_directory);
+}
+
+TEST(StatCacheFileSystemTest, InvalidCache) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Base(
+      new vfs::InMemoryFileSystem());
+  auto FS = vfs::StatCacheFileSystem::create(
+      MemoryBuffer::getMemBuffer("not a stat cache"), Base);
+  EXPECT_THAT_EXPECTED(FS, Failed());
+}
+
 class InMemoryFileSystemTest : public ::testing::Test {
 protected:
   llvm::vfs::InMemoryFileSystem FS;
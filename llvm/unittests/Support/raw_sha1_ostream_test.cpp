@@ -11,6 +11,7 @@
 #include "gtest/gtest.h"
 
 #include <string>
+#include <vector>
 
 using namespace llvm;
 
@@ -59,6 +60,27 @@ TEST(sha1_hash_test, Update) {
   ASSERT_EQ("3E4A614101AD84985AB0FE54DC12A6D71551E5AE", Hash);
 }
 
+// Hash many blocks at once, split at offsets that are not multiples of the
+// block size, so that both the buffered and the whole-block paths are used.
+TEST(sha1_hash_test, MultipleBlocks) {
+  std::vector<uint8_t> Input(1000);
+  for (size_t I = 0; I < Input.size(); ++I)
+    Input[I] = I * 131 + 7;
+  std::string Expected = "425B5F2D2D344F4F6467CDA9065CDC840619DC2D";
+
+  std::array<uint8_t, 20> Vec = SHA1::hash(Input);
+  ASSERT_EQ(Expected, toHex({(const char *)Vec.data(), 20}));
+
+  SHA1 sha1;
+  ArrayRef<uint8_t> Data(Input);
+  for (size_t Chunk : {1, 63, 65, 128, 743}) {
+    sha1.update(Data.take_front(Chunk));
+    Data = Data.drop_front(Chunk);
+  }
+  ASSERT_TRUE(Data.empty());
+  ASSERT_EQ(Expected, toHex(sha1.final()));
+}
+
 // Check that getting the intermediate hash in the middle of the stream does
 // not invalidate the final result.
 TEST(raw_sha1_ostreamTest, Intermediate) {
@@ -9,6 +9,8 @@
 #include "llvm/Support/xxhash.h"
 #include "gtest/gtest.h"
 
+#include <vector>
+
 using namespace llvm;
 
 TEST(xxhashTest, Basic) {
@@ -17,3 +19,26 @@ TEST(xxhashTest, Basic) {
   EXPECT_EQ(0x69196c1b3af0bff9U,
             xxHash64("0123456789abcdefghijklmnopqrstuvwxyz"));
 }
+
+TEST(xxhashTest, xxh3) {
+  EXPECT_EQ(0x2d06800538d394c2U, xxh3_64bits(""));
+  EXPECT_EQ(0xab6e5f64077e7d8aU, xxh3_64bits("foo"));
+  EXPECT_EQ(0xd463c860a032d362U, xxh3_64bits("bar"));
+  EXPECT_EQ(0xffb92a87c6306d55U,
+            xxh3_64bits("0123456789abcdefghijklmnopqrstuvwxyz"));
+
+  // One length from each of the size classes xxh3 handles differently, up to
+  // inputs that span several stripes and blocks.
+  std::vector<uint8_t> Input(100000);
+  for (size_t I = 0; I < Input.size(); ++I)
+    Input[I] = I * 131 + 7;
+  ArrayRef<uint8_t> Data(Input);
+  EXPECT_EQ(0x6e3e2670e61106acU, xxh3_64bits(Data.take_front(3)));
+  EXPECT_EQ(0xf9fd4dd0b04d78f5U, xxh3_64bits(Data.take_front(8)));
+  EXPECT_EQ(0x86abf6baccea0858U, xxh3_64bits(Data.take_front(16)));
+  EXPECT_EQ(0x10d17f72c0ccba41U, xxh3_64bits(Data.take_front(128)));
+  EXPECT_EQ(0xb6cfaf343fab81e6U, xxh3_64bits(Data.take_front(240)));
+  EXPECT_EQ(0x70bd377d9574f4bbU, xxh3_64bits(Data.take_front(1024)));
+  EXPECT_EQ(0x9ddd66c14af0daffU, xxh3_64bits(Data.take_front(4096)));
+  EXPECT_EQ(0x14ce8d6fc2c4868bU, xxh3_64bits(Data));
+}
@@ -0,0 +1,195 @@
+//===- ActiveLaneMaskTest.cpp ---------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Vectorize/LoopVectorize.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// A loop whose tail is folded into the vector body with a VF of 4.
+const char *TailFoldedLoopIR = R"(
+  define void @f(i32* noalias %a, i32* noalias %b, i64 %n) {
+  entry:
+    br label %loop
+
+  loop:
+    %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+    %pb = getelementptr inbounds i32, i32* %b, i64 %i
+    %v = load i32, i32* %pb
+    %add = add i32 %v, 1
+    %pa = getelementptr inbounds i32, i32* %a, i64 %i
+    store i32 %add, i32* %pa
+    %i.next = add nuw nsw i64 %i, 1
+    %done = icmp eq i64 %i.next, %n
+    br i1 %done, label %exit, label %loop, !llvm.loop !0
+
+  exit:
+    ret void
+  }
+
+  !0 = distinct !{!0, !1, !2, !3}
+  !1 = !{!"llvm.loop.vectorize.enable", i1 true}
+  !2 = !{!"llvm.loop.vectorize.predicate.enable", i1 true}
+  !3 = !{!"llvm.loop.vectorize.width", i32 4}
+)";
+
+class ActiveLaneMaskTest : public testing::Test {
+protected:
+  static void SetUpTestCase() {
+    LLVMInitializeAArch64TargetInfo();
+    LLVMInitializeAArch64Target();
+    LLVMInitializeAArch64TargetMC();
+    LLVMInitializeAArch64AsmPrinter();
+  }
+
+  std::unique_ptr<TargetMachine> createTargetMachine(StringRef Features) {
+    std::string Error;
+    const Target *T = TargetRegistry::lookupTarget("aarch64--", Error);
+    EXPECT_TRUE(T) << Error;
+    if (!T)
+      return nullptr;
+    return std::unique_ptr<TargetMachine>(
+        T->createTargetMachine("aarch64--", "", Features, TargetOptions(),
+                               None, None, CodeGenOpt::Default));
+  }
+
+  std::unique_ptr<Module> parse(StringRef IR, TargetMachine &TM) {
+    SMDiagnostic Error;
+    std::unique_ptr<Module> M = parseAssemblyString(IR, Error, Context);
+    EXPECT_TRUE(M) << Error.getMessage();
+    if (M) {
+      M->setTargetTriple(TM.getTargetTriple().str());
+      M->setDataLayout(TM.createDataLayout());
+    }
+    return M;
+  }
+
+  // Returns the assembly generated for IR with the given target features.
+  std::string compile(StringRef IR, StringRef Features) {
+    std::unique_ptr<TargetMachine> TM = createTargetMachine(Features);
+    if (!TM)
+      return "";
+    std::unique_ptr<Module> M = parse(IR, *TM);
+    if (!M)
+      return "";
+
+    SmallString<0> Asm;
+    raw_svector_ostream OS(Asm);
+    legacy::PassManager PM;
+    EXPECT_FALSE(TM->addPassesToEmitFile(PM, OS, nullptr, CGFT_AssemblyFile));
+    PM.run(*M);
+    return Asm.str().str();
+  }
+
+  // Vectorizes TailFoldedLoopIR with the given target features and returns
+  // whether the header mask uses @llvm.get.active.lane.mask.
+  bool vectorizeUsesActiveLaneMask(StringRef Features) {
+    std::unique_ptr<TargetMachine> TM = createTargetMachine(Features);
+    if (!TM)
+      return false;
+    std::unique_ptr<Module> M = parse(TailFoldedLoopIR, *TM);
+    if (!M)
+      return false;
+
+    PassBuilder PB(TM.get());
+    LoopAnalysisManager LAM;
+    FunctionAnalysisManager FAM;
+    CGSCCAnalysisManager CGAM;
+    ModuleAnalysisManager MAM;
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+    FunctionPassManager FPM;
+    FPM.addPass(LoopVectorizePass());
+    FPM.run(*M->getFunction("f"), FAM);
+
+    bool Vectorized = false, UsesActiveLaneMask = false;
+    for (Instruction &I : instructions(*M->getFunction("f"))) {
+      Vectorized |= I.getType()->isVectorTy();
+      if (auto *II = dyn_cast<IntrinsicInst>(&I))
+        UsesActiveLaneMask |=
+            II->getIntrinsicID() == Intrinsic::get_active_lane_mask;
+    }
+    EXPECT_TRUE(Vectorized);
+    return UsesActiveLaneMask;
+  }
+
+  LLVMContext Context;
+};
+
+TEST_F(ActiveLaneMaskTest, LoopVectorize) {
+  // With SVE the folded tail is predicated with the intrinsic. Without it
+  // masked stores are not legal, so the tail is not folded at all.
+  EXPECT_TRUE(vectorizeUsesActiveLaneMask("+sve"));
+  EXPECT_FALSE(vectorizeUsesActiveLaneMask("+neon"));
+}
+
+TEST_F(ActiveLaneMaskTest, ExpandFixedWidth) {
+  // Without a lane-mask instruction for fixed-width vectors, the intrinsic is
+  // expanded to unsigned compares of the lane indices.
+  std::string Asm = compile(R"(
+    declare <4 x i1> @llvm.get.active.lane.mask.v4i1.i32(i32, i32)
+
+    define void @f(i32 %base, i32 %btc, <4 x i32>* %p) {
+      %m = call <4 x i1> @llvm.get.active.lane.mask.v4i1.i32(i32 %base,
+                                                             i32 %btc)
+      %z = zext <4 x i1> %m to <4 x i32>
+      store <4 x i32> %z, <4 x i32>* %p
+      ret void
+    }
+  )", "+neon");
+  EXPECT_EQ(Asm.find("uqadd"), std::string::npos) << Asm;
+  EXPECT_NE(Asm.find("cmhs"), std::string::npos) << Asm;
+}
+
+TEST_F(ActiveLaneMaskTest, ExpandLargestBackedgeTakenCount) {
+  // Base + 2 and Base + 3 wrap, so only the first two lanes are active even
+  // though every wrapped index is ule the count. The expansion folds to the
+  // constant 0b0011.
+  std::string Asm = compile(R"(
+    declare <4 x i1> @llvm.get.active.lane.mask.v4i1.i32(i32, i32)
+
+    define i32 @f() {
+      %m = call <4 x i1> @llvm.get.active.lane.mask.v4i1.i32(i32 -2, i32 -1)
+      %b = bitcast <4 x i1> %m to i4
+      %z = zext i4 %b to i32
+      ret i32 %z
+    }
+  )", "+neon");
+  EXPECT_NE(Asm.find("mov\tw0, #3\n"), std::string::npos) << Asm;
+}
+
+TEST_F(ActiveLaneMaskTest, SVEWhileLS) {
+  std::string Asm = compile(R"(
+    declare <vscale x 4 x i1> @llvm.get.active.lane.mask.nxv4i1.i64(i64, i64)
+
+    define <vscale x 4 x i1> @f(i64 %base, i64 %btc) {
+      %m = call <vscale x 4 x i1> @llvm.get.active.lane.mask.nxv4i1.i64(
+          i64 %base, i64 %btc)
+      ret <vscale x 4 x i1> %m
+    }
+  )", "+sve");
+  EXPECT_NE(Asm.find("whilels\tp0.s, x0, x1"), std::string::npos) << Asm;
+}
+
+} // end anonymous namespace
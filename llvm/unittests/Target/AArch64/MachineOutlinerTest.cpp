@@ -0,0 +1,198 @@
+//===- MachineOutlinerTest.cpp --------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetMachine.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// Several minsize functions sharing a long run of stores, which the outliner
+// pulls out, and a shorter run that only some of them share.
+const char *RepeatedStoresIR = R"(
+  define void @f1(i32* %p) minsize nounwind {
+    %p1 = getelementptr i32, i32* %p, i64 1
+    %p2 = getelementptr i32, i32* %p, i64 2
+    %p3 = getelementptr i32, i32* %p, i64 3
+    %p4 = getelementptr i32, i32* %p, i64 4
+    store volatile i32 1, i32* %p
+    store volatile i32 2, i32* %p1
+    store volatile i32 3, i32* %p2
+    store volatile i32 4, i32* %p3
+    store volatile i32 5, i32* %p4
+    store volatile i32 6, i32* %p
+    store volatile i32 7, i32* %p1
+    ret void
+  }
+
+  define void @f2(i32* %p) minsize nounwind {
+    %p1 = getelementptr i32, i32* %p, i64 1
+    %p2 = getelementptr i32, i32* %p, i64 2
+    %p3 = getelementptr i32, i32* %p, i64 3
+    %p4 = getelementptr i32, i32* %p, i64 4
+    store volatile i32 1, i32* %p
+    store volatile i32 2, i32* %p1
+    store volatile i32 3, i32* %p2
+    store volatile i32 4, i32* %p3
+    store volatile i32 5, i32* %p4
+    store volatile i32 6, i32* %p
+    store volatile i32 7, i32* %p1
+    ret void
+  }
+
+  define void @f3(i32* %p) minsize nounwind {
+    %p1 = getelementptr i32, i32* %p, i64 1
+    %p2 = getelementptr i32, i32* %p, i64 2
+    %p3 = getelementptr i32, i32* %p, i64 3
+    %p4 = getelementptr i32, i32* %p, i64 4
+    store volatile i32 1, i32* %p
+    store volatile i32 2, i32* %p1
+    store volatile i32 3, i32* %p2
+    store volatile i32 4, i32* %p3
+    store volatile i32 5, i32* %p4
+    store volatile i32 8, i32* %p
+    store volatile i32 9, i32* %p1
+    ret void
+  }
+
+  define void @f4(i32* %p) minsize nounwind {
+    %p1 = getelementptr i32, i32* %p, i64 1
+    %p2 = getelementptr i32, i32* %p, i64 2
+    %p3 = getelementptr i32, i32* %p, i64 3
+    %p4 = getelementptr i32, i32* %p, i64 4
+    store volatile i32 1, i32* %p
+    store volatile i32 2, i32* %p1
+    store volatile i32 3, i32* %p2
+    store volatile i32 4, i32* %p3
+    store volatile i32 5, i32* %p4
+    store volatile i32 8, i32* %p
+    store volatile i32 9, i32* %p1
+    ret void
+  }
+)";
+
+class MachineOutlinerTest : public testing::Test {
+protected:
+  static void SetUpTestCase() {
+    LLVMInitializeAArch64TargetInfo();
+    LLVMInitializeAArch64Target();
+    LLVMInitializeAArch64TargetMC();
+    LLVMInitializeAArch64AsmPrinter();
+  }
+
+  void SetUp() override {
+    auto &Opts = cl::getRegisteredOptions();
+    UseSuffixArray =
+        static_cast<cl::opt<bool> *>(Opts["outliner-use-suffix-array"]);
+    ParallelBenefit =
+        static_cast<cl::opt<bool> *>(Opts["outliner-parallel-benefit"]);
+    Reruns = static_cast<cl::opt<unsigned> *>(Opts["machine-outliner-reruns"]);
+    LinkOnceODRFunctions =
+        static_cast<cl::opt<bool> *>(Opts["outliner-linkonceodr-functions"]);
+    ASSERT_TRUE(UseSuffixArray && ParallelBenefit && Reruns &&
+                LinkOnceODRFunctions);
+  }
+
+  void TearDown() override {
+    UseSuffixArray->setValue(false);
+    ParallelBenefit->setValue(false);
+    Reruns->setValue(0);
+    LinkOnceODRFunctions->setValue(false);
+  }
+
+  // Compiles IR with the current outliner options and returns the assembly.
+  std::string compile(StringRef IR = RepeatedStoresIR) {
+    LLVMContext Context;
+    SMDiagnostic Error;
+    std::unique_ptr<Module> M = parseAssemblyString(IR, Error, Context);
+    EXPECT_TRUE(M) << Error.getMessage();
+    if (!M)
+      return "";
+
+    std::string TT = "aarch64--";
+    std::string ErrorStr;
+    const Target *T = TargetRegistry::lookupTarget(TT, ErrorStr);
+    EXPECT_TRUE(T) << ErrorStr;
+    if (!T)
+      return "";
+    std::unique_ptr<TargetMachine> TM(T->createTargetMachine(
+        TT, "", "", TargetOptions(), None, None, CodeGenOpt::Default));
+    M->setDataLayout(TM->createDataLayout());
+
+    SmallString<0> Asm;
+    raw_svector_ostream OS(Asm);
+    legacy::PassManager PM;
+    EXPECT_FALSE(TM->addPassesToEmitFile(PM, OS, nullptr, CGFT_AssemblyFile));
+    PM.run(*M);
+    return Asm.str().str();
+  }
+
+  cl::opt<bool> *UseSuffixArray = nullptr;
+  cl::opt<bool> *ParallelBenefit = nullptr;
+  cl::opt<unsigned> *Reruns = nullptr;
+  cl::opt<bool> *LinkOnceODRFunctions = nullptr;
+};
+
+TEST_F(MachineOutlinerTest, SuffixArrayMatchesSuffixTree) {
+  std::string Tree = compile();
+  EXPECT_NE(Tree.find("OUTLINED_FUNCTION_0:"), std::string::npos) << Tree;
+
+  // Both engines report the same repeated sequences, so the outliner makes
+  // the same decisions.
+  UseSuffixArray->setValue(true);
+  EXPECT_EQ(compile(), Tree);
+}
+
+TEST_F(MachineOutlinerTest, ParallelBenefitMatchesSerial) {
+  std::string Serial = compile();
+  ParallelBenefit->setValue(true);
+  EXPECT_EQ(compile(), Serial);
+
+  UseSuffixArray->setValue(true);
+  EXPECT_EQ(compile(), Serial);
+}
+
+TEST_F(MachineOutlinerTest, Reruns) {
+  std::string Once = compile();
+
+  // Functions outlined in later rounds are named after their round, so the
+  // first round's functions keep their names.
+  Reruns->setValue(2);
+  std::string Rerun = compile();
+  EXPECT_NE(Rerun.find("OUTLINED_FUNCTION_0:"), std::string::npos) << Rerun;
+  EXPECT_EQ(Rerun.find("OUTLINED_FUNCTION_1_"), std::string::npos) << Rerun;
+  if (Rerun.find("OUTLINED_FUNCTION_2_") == std::string::npos)
+    EXPECT_EQ(Rerun, Once);
+}
+
+TEST_F(MachineOutlinerTest, ContentBasedNamesIgnoreIRNames) {
+  LinkOnceODRFunctions->setValue(true);
+  std::string Asm = compile();
+  EXPECT_EQ(Asm.find("OUTLINED_FUNCTION_0:"), std::string::npos) << Asm;
+  EXPECT_NE(Asm.find("OUTLINED_FUNCTION_"), std::string::npos) << Asm;
+
+  // The memory operands of the outlined stores name the IR values they
+  // store to. Renaming those values does not change the code, so the
+  // outlined functions get the same names.
+  std::string Renamed = RepeatedStoresIR;
+  for (size_t Pos = Renamed.find("%p"); Pos != std::string::npos;
+       Pos = Renamed.find("%p", Pos))
+    Renamed.replace(Pos, 2, "%addr");
+  EXPECT_EQ(compile(Renamed), Asm);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,221 @@
+//===- GCNSchedStrategyTest.cpp -------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassTimingInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Target/TargetMachine.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// A kernel with several blocks of independent loads and arithmetic, so that
+// the scheduler sees several regions worth rescheduling. The volatile loads in
+// the entry block all have to complete before the first volatile store, which
+// keeps more values live than fit in the registers available at full
+// occupancy. The scheduler lowers the occupancy and reschedules every region
+// for it.
+const char *KernelIR = R"(
+  define amdgpu_kernel void @k(float addrspace(1)* %p, i32 %n) {
+  entry:
+    %vp = bitcast float addrspace(1)* %p to <4 x float> addrspace(1)*
+    %vp0 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 4
+    %vp1 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 5
+    %vp2 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 6
+    %vp3 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 7
+    %vp4 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 8
+    %vp5 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 9
+    %vp6 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 10
+    %vp7 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 11
+    %vp8 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 12
+    %vp9 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 13
+    %vp10 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 14
+    %vp11 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 15
+    %vp12 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 16
+    %vp13 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 17
+    %vp14 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 18
+    %vp15 = getelementptr <4 x float>, <4 x float> addrspace(1)* %vp, i64 19
+    %v0 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp0
+    %v1 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp1
+    %v2 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp2
+    %v3 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp3
+    %v4 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp4
+    %v5 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp5
+    %v6 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp6
+    %v7 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp7
+    %v8 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp8
+    %v9 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp9
+    %v10 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp10
+    %v11 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp11
+    %v12 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp12
+    %v13 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp13
+    %v14 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp14
+    %v15 = load volatile <4 x float>, <4 x float> addrspace(1)* %vp15
+    store volatile <4 x float> %v0, <4 x float> addrspace(1)* %vp15
+    store volatile <4 x float> %v1, <4 x float> addrspace(1)* %vp14
+    store volatile <4 x float> %v2, <4 x float> addrspace(1)* %vp13
+    store volatile <4 x float> %v3, <4 x float> addrspace(1)* %vp12
+    store volatile <4 x float> %v4, <4 x float> addrspace(1)* %vp11
+    store volatile <4 x float> %v5, <4 x float> addrspace(1)* %vp10
+    store volatile <4 x float> %v6, <4 x float> addrspace(1)* %vp9
+    store volatile <4 x float> %v7, <4 x float> addrspace(1)* %vp8
+    store volatile <4 x float> %v8, <4 x float> addrspace(1)* %vp7
+    store volatile <4 x float> %v9, <4 x float> addrspace(1)* %vp6
+    store volatile <4 x float> %v10, <4 x float> addrspace(1)* %vp5
+    store volatile <4 x float> %v11, <4 x float> addrspace(1)* %vp4
+    store volatile <4 x float> %v12, <4 x float> addrspace(1)* %vp3
+    store volatile <4 x float> %v13, <4 x float> addrspace(1)* %vp2
+    store volatile <4 x float> %v14, <4 x float> addrspace(1)* %vp1
+    store volatile <4 x float> %v15, <4 x float> addrspace(1)* %vp0
+    %p1 = getelementptr float, float addrspace(1)* %p, i64 1
+    %p2 = getelementptr float, float addrspace(1)* %p, i64 2
+    %p3 = getelementptr float, float addrspace(1)* %p, i64 3
+    %a = load float, float addrspace(1)* %p
+    %b = load float, float addrspace(1)* %p1
+    %c = load float, float addrspace(1)* %p2
+    %d = load float, float addrspace(1)* %p3
+    %ab = fmul float %a, %b
+    %cd = fmul float %c, %d
+    %s = fadd float %ab, %cd
+    store float %s, float addrspace(1)* %p
+    %cmp = icmp sgt i32 %n, 0
+    br i1 %cmp, label %then, label %exit
+
+  then:
+    %e = load float, float addrspace(1)* %p2
+    %f = load float, float addrspace(1)* %p3
+    %ef = fmul float %e, %f
+    %t = fadd float %ef, %s
+    store float %t, float addrspace(1)* %p1
+    store float %ef, float addrspace(1)* %p3
+    br label %exit
+
+  exit:
+    %g = load float, float addrspace(1)* %p1
+    %h = load float, float addrspace(1)* %p
+    %gh = fsub float %g, %h
+    store float %gh, float addrspace(1)* %p2
+    ret void
+  }
+)";
+
+class GCNSchedStrategyTest : public testing::Test {
+protected:
+  static void SetUpTestCase() {
+    LLVMInitializeAMDGPUTargetInfo();
+    LLVMInitializeAMDGPUTarget();
+    LLVMInitializeAMDGPUTargetMC();
+    LLVMInitializeAMDGPUAsmPrinter();
+    // Statistics only register when first bumped, so enable them before any
+    // test runs the scheduler.
+    EnableStatistics(/*PrintOnExit=*/false);
+  }
+
+  void SetUp() override {
+    auto &Opts = cl::getRegisteredOptions();
+    Budget = static_cast<cl::opt<unsigned> *>(Opts["amdgpu-reschedule-budget"]);
+    ASSERT_TRUE(Budget);
+    OldBudget = *Budget;
+  }
+
+  void TearDown() override { Budget->setValue(OldBudget); }
+
+  // Compiles KernelIR with -amdgpu-reschedule-budget=NumInstrs and returns
+  // the assembly.
+  std::string compile(unsigned NumInstrs) {
+    Budget->setValue(NumInstrs);
+
+    LLVMContext Context;
+    SMDiagnostic Error;
+    std::unique_ptr<Module> M = parseAssemblyString(KernelIR, Error, Context);
+    EXPECT_TRUE(M) << Error.getMessage();
+    if (!M)
+      return "";
+
+    std::string TT = "amdgcn--amdhsa";
+    std::string ErrorStr;
+    const Target *T = TargetRegistry::lookupTarget(TT, ErrorStr);
+    EXPECT_TRUE(T) << ErrorStr;
+    if (!T)
+      return "";
+    std::unique_ptr<TargetMachine> TM(T->createTargetMachine(
+        TT, "gfx900", "", TargetOptions(), None, None, CodeGenOpt::Default));
+    M->setDataLayout(TM->createDataLayout());
+
+    SmallString<0> Asm;
+    raw_svector_ostream OS(Asm);
+    legacy::PassManager PM;
+    EXPECT_FALSE(TM->addPassesToEmitFile(PM, OS, nullptr, CGFT_AssemblyFile));
+    ResetStatistics();
+    PM.run(*M);
+    return Asm.str().str();
+  }
+
+  // Returns the value of the scheduler statistic \p Name from the last
+  // compile(), or 0 if statistics are compiled out.
+  static unsigned getStatistic(StringRef Name) {
+    for (const auto &Stat : GetStatistics())
+      if (Stat.first == Name)
+        return Stat.second;
+    return 0;
+  }
+
+  cl::opt<unsigned> *Budget = nullptr;
+  unsigned OldBudget = 0;
+};
+
+TEST_F(GCNSchedStrategyTest, RescheduleBudget) {
+  std::string Unlimited = compile(0);
+  ASSERT_FALSE(Unlimited.empty());
+  unsigned NumRescheduled = getStatistic("NumRegionsRescheduled");
+  EXPECT_EQ(getStatistic("NumRegionsOverBudget"), 0u);
+
+  // A budget that covers the whole function changes nothing.
+  EXPECT_EQ(compile(1 << 30), Unlimited);
+  EXPECT_EQ(getStatistic("NumRegionsRescheduled"), NumRescheduled);
+  EXPECT_EQ(getStatistic("NumRegionsOverBudget"), 0u);
+
+  // A budget too small for any region leaves every region with its initial
+  // schedule, which is still a valid one.
+  std::string Minimal = compile(1);
+  EXPECT_NE(Minimal.find("s_endpgm"), std::string::npos);
+  EXPECT_EQ(getStatistic("NumRegionsRescheduled"), 0u);
+  EXPECT_EQ(getStatistic("NumRegionsOverBudget"), NumRescheduled);
+
+#if LLVM_ENABLE_STATS
+  // The occupancy drops in the entry block, so every region of the function
+  // is rescheduled at least once more.
+  EXPECT_GE(NumRescheduled, 3u);
+#endif
+}
+
+TEST_F(GCNSchedStrategyTest, StageTimers) {
+  bool OldTimePasses = TimePassesIsEnabled;
+  TimePassesIsEnabled = true;
+  compile(0);
+  TimePassesIsEnabled = OldTimePasses;
+
+  std::string Report;
+  raw_string_ostream OS(Report);
+  TimerGroup::printAll(OS);
+  OS.flush();
+  EXPECT_NE(Report.find("AMDGPU Scheduling Stages"), std::string::npos);
+  EXPECT_NE(Report.find("Initial Schedule"), std::string::npos);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,132 @@
+//===- WebAssemblyTTITest.cpp - WebAssemblyTTIImpl unit tests -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetMachine.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class WebAssemblyTTITest : public testing::Test {
+protected:
+  static void SetUpTestCase() {
+    LLVMInitializeWebAssemblyTargetInfo();
+    LLVMInitializeWebAssemblyTarget();
+    LLVMInitializeWebAssemblyTargetMC();
+  }
+
+  // Returns the TTI of an empty function compiled with the given features.
+  TargetTransformInfo getTTI(StringRef Features) {
+    auto TT(Triple::normalize("wasm32-unknown-unknown"));
+    std::string Error;
+    const Target *TheTarget = TargetRegistry::lookupTarget(TT, Error);
+    assert(TheTarget);
+    TM.reset(TheTarget->createTargetMachine(TT, "", Features, TargetOptions(),
+                                            None, None, CodeGenOpt::Default));
+
+    M = std::make_unique<Module>("test", Context);
+    M->setDataLayout(TM->createDataLayout());
+    Function *F =
+        Function::Create(FunctionType::get(Type::getVoidTy(Context), false),
+                         GlobalValue::ExternalLinkage, "f", M.get());
+    return TM->getTargetTransformInfo(*F);
+  }
+
+  LLVMContext Context;
+  std::unique_ptr<TargetMachine> TM;
+  std::unique_ptr<Module> M;
+};
+
+TEST_F(WebAssemblyTTITest, ShuffleCost) {
+  TargetTransformInfo TTI = getTTI("+simd128");
+  Type *V16I8 = VectorType::get(Type::getInt8Ty(Context), 16);
+  Type *V4I32 = VectorType::get(Type::getInt32Ty(Context), 4);
+  Type *V8I32 = VectorType::get(Type::getInt32Ty(Context), 8);
+  Type *V16I32 = VectorType::get(Type::getInt32Ty(Context), 16);
+
+  // Any permutation of a legal vector is one v8x16.shuffle.
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_PermuteSingleSrc, V16I8),
+            1);
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_PermuteTwoSrc, V4I32),
+            1);
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_Reverse, V4I32), 1);
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_Broadcast, V4I32), 1);
+
+  // A part of a split vector that draws from at most two source parts is one
+  // shuffle.
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_Broadcast, V8I32), 2);
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_Select, V8I32), 2);
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_Reverse, V8I32), 2);
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_PermuteSingleSrc,
+                               V8I32),
+            2);
+
+  // A part that may draw from more is built with an extract_lane and a
+  // replace_lane per lane.
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_PermuteTwoSrc, V8I32),
+            16);
+  EXPECT_EQ(TTI.getShuffleCost(TargetTransformInfo::SK_PermuteSingleSrc,
+                               V16I32),
+            32);
+
+  // Without SIMD128, permutations are still built lane by lane.
+  TargetTransformInfo ScalarTTI = getTTI("");
+  EXPECT_GT(ScalarTTI.getShuffleCost(TargetTransformInfo::SK_PermuteTwoSrc,
+                                     V4I32),
+            4);
+}
+
+TEST_F(WebAssemblyTTITest, InterleavedMemoryOpCost) {
+  TargetTransformInfo TTI = getTTI("+simd128");
+  EXPECT_TRUE(TTI.enableInterleavedAccessVectorization());
+
+  Type *V8I32 = VectorType::get(Type::getInt32Ty(Context), 8);
+  Type *V16I32 = VectorType::get(Type::getInt32Ty(Context), 16);
+  int Load8Cost = TTI.getMemoryOpCost(Instruction::Load, V8I32, MaybeAlign(4),
+                                      /*AddressSpace=*/0);
+  int Load16Cost = TTI.getMemoryOpCost(Instruction::Load, V16I32,
+                                       MaybeAlign(4), /*AddressSpace=*/0);
+  int Store16Cost = TTI.getMemoryOpCost(Instruction::Store, V16I32,
+                                        MaybeAlign(4), /*AddressSpace=*/0);
+
+  // With a factor of two, each legal part of each member is one shuffle.
+  EXPECT_EQ(TTI.getInterleavedMemoryOpCost(Instruction::Load, V8I32, 2, {0, 1},
+                                           4, 0),
+            Load8Cost + 2);
+  EXPECT_EQ(TTI.getInterleavedMemoryOpCost(Instruction::Load, V8I32, 2, {0}, 4,
+                                           0),
+            Load8Cost + 1);
+  EXPECT_EQ(TTI.getInterleavedMemoryOpCost(Instruction::Load, V16I32, 2,
+                                           {0, 1}, 4, 0),
+            Load16Cost + 4);
+  EXPECT_EQ(TTI.getInterleavedMemoryOpCost(Instruction::Store, V16I32, 2, {},
+                                           4, 0),
+            Store16Cost + 4);
+
+  // Larger factors keep the generic lane-by-lane cost.
+  Type *V12I32 = VectorType::get(Type::getInt32Ty(Context), 12);
+  int Load12Cost = TTI.getMemoryOpCost(Instruction::Load, V12I32,
+                                       MaybeAlign(4), /*AddressSpace=*/0);
+  EXPECT_GT(TTI.getInterleavedMemoryOpCost(Instruction::Load, V12I32, 3,
+                                           {0, 1, 2}, 4, 0),
+            Load12Cost + 3);
+
+  TargetTransformInfo ScalarTTI = getTTI("");
+  EXPECT_FALSE(ScalarTTI.enableInterleavedAccessVectorization());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,184 @@
+//===- SROATest.cpp - SROA unit tests -------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Scalar/SROA.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassInstrumentation.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+class SROATest : public testing::Test {
+protected:
+  void parseAssembly(StringRef Assembly) {
+    SMDiagnostic Error;
+    M = parseAssemblyString(Assembly, Error, Context);
+    ASSERT_TRUE(M) << Error.getMessage();
+    F = M->getFunction("f");
+    ASSERT_TRUE(F);
+  }
+
+  void runSROA() {
+    FunctionAnalysisManager FAM;
+    FAM.registerPass([] { return DominatorTreeAnalysis(); });
+    FAM.registerPass([] { return AssumptionAnalysis(); });
+    FAM.registerPass([] { return PassInstrumentationAnalysis(); });
+    SROA().run(*F, FAM);
+  }
+
+  unsigned countAllocas() {
+    unsigned Count = 0;
+    for (Instruction &I : instructions(*F))
+      Count += isa<AllocaInst>(I);
+    return Count;
+  }
+
+  LLVMContext Context;
+  std::unique_ptr<Module> M;
+  Function *F = nullptr;
+};
+
+// Each memcpy copies from its own offset to the end of the alloca, so every
+// partition after the first carries the tails of all the earlier memcpys.
+const char *OverlappingCopiesIR = R"(
+  declare void @llvm.memcpy.p0i8.p0i8.i64(i8*, i8*, i64, i1)
+  declare void @use(i32)
+
+  define void @f([4 x i32]* %src) {
+    %a = alloca [4 x i32]
+    %d0 = getelementptr inbounds [4 x i32], [4 x i32]* %a, i32 0, i32 0
+    %d1 = getelementptr inbounds [4 x i32], [4 x i32]* %a, i32 0, i32 1
+    %d2 = getelementptr inbounds [4 x i32], [4 x i32]* %a, i32 0, i32 2
+    %d3 = getelementptr inbounds [4 x i32], [4 x i32]* %a, i32 0, i32 3
+    %s0 = getelementptr inbounds [4 x i32], [4 x i32]* %src, i32 0, i32 0
+    %s1 = getelementptr inbounds [4 x i32], [4 x i32]* %src, i32 0, i32 1
+    %s2 = getelementptr inbounds [4 x i32], [4 x i32]* %src, i32 0, i32 2
+    %s3 = getelementptr inbounds [4 x i32], [4 x i32]* %src, i32 0, i32 3
+    %dd0 = bitcast i32* %d0 to i8*
+    %dd1 = bitcast i32* %d1 to i8*
+    %dd2 = bitcast i32* %d2 to i8*
+    %dd3 = bitcast i32* %d3 to i8*
+    %ss0 = bitcast i32* %s0 to i8*
+    %ss1 = bitcast i32* %s1 to i8*
+    %ss2 = bitcast i32* %s2 to i8*
+    %ss3 = bitcast i32* %s3 to i8*
+    call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dd0, i8* %ss0, i64 16, i1 false)
+    call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dd1, i8* %ss1, i64 12, i1 false)
+    call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dd2, i8* %ss2, i64 8, i1 false)
+    call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dd3, i8* %ss3, i64 4, i1 false)
+    %l0 = load i32, i32* %d0
+    %l1 = load i32, i32* %d1
+    %l2 = load i32, i32* %d2
+    %l3 = load i32, i32* %d3
+    call void @use(i32 %l0)
+    call void @use(i32 %l1)
+    call void @use(i32 %l2)
+    call void @use(i32 %l3)
+    ret void
+  }
+)";
+
+TEST_F(SROATest, ManySmallAllocas) {
+  // Enough allocas that dropping each one from the worklists by rescanning
+  // them would show up, all used in a single block.
+  const unsigned NumAllocas = 256;
+  std::string IR = "declare void @use(i32)\n"
+                   "%P = type { i32, i32 }\n"
+                   "define void @f() {\n";
+  for (unsigned I = 0; I != NumAllocas; ++I)
+    IR += "  %a" + std::to_string(I) + " = alloca %P\n";
+  for (unsigned I = 0; I != NumAllocas; ++I) {
+    std::string N = std::to_string(I);
+    IR += "  %x" + N + " = getelementptr inbounds %P, %P* %a" + N +
+          ", i32 0, i32 0\n";
+    IR += "  %y" + N + " = getelementptr inbounds %P, %P* %a" + N +
+          ", i32 0, i32 1\n";
+    IR += "  store i32 " + N + ", i32* %x" + N + "\n";
+    IR += "  store i32 " + N + ", i32* %y" + N + "\n";
+  }
+  for (unsigned I = 0; I != NumAllocas; ++I) {
+    std::string N = std::to_string(I);
+    IR += "  %l" + N + " = load i32, i32* %x" + N + "\n";
+    IR += "  call void @use(i32 %l" + N + ")\n";
+  }
+  IR += "  ret void\n}\n";
+
+  parseAssembly(IR);
+  EXPECT_EQ(countAllocas(), NumAllocas);
+  runSROA();
+  EXPECT_EQ(countAllocas(), 0u);
+}
+
+TEST_F(SROATest, LiveInDefiningBlocks) {
+  // %loop and %exit are both joins that write %a. %loop reads it first, so
+  // the value is live into it and needs a phi. %exit writes it before reading
+  // it, so it needs none.
+  parseAssembly(R"(
+    declare void @use(i32)
+
+    define void @f(i32 %n) {
+    entry:
+      %a = alloca i32
+      store i32 0, i32* %a
+      %z = icmp eq i32 %n, 0
+      br i1 %z, label %exit, label %loop
+    loop:
+      %v = load i32, i32* %a
+      %inc = add i32 %v, 1
+      store i32 %inc, i32* %a
+      %c = icmp slt i32 %inc, %n
+      br i1 %c, label %loop, label %exit
+    exit:
+      store i32 %n, i32* %a
+      %r = load i32, i32* %a
+      call void @use(i32 %r)
+      ret void
+    }
+  )");
+  runSROA();
+  EXPECT_EQ(countAllocas(), 0u);
+
+  unsigned NumPhis = 0;
+  for (Instruction &I : instructions(*F))
+    if (auto *PN = dyn_cast<PHINode>(&I)) {
+      ++NumPhis;
+      EXPECT_EQ(PN->getParent()->getName(), "loop");
+    }
+  EXPECT_EQ(NumPhis, 1u);
+}
+
+TEST_F(SROATest, SplitTailLimit) {
+  parseAssembly(OverlappingCopiesIR);
+  runSROA();
+  EXPECT_EQ(countAllocas(), 0u);
+
+  auto &Opts = cl::getRegisteredOptions();
+  auto *MaxSplitTails =
+      static_cast<cl::opt<unsigned> *>(Opts["sroa-max-split-tails-per-slice"]);
+  ASSERT_TRUE(MaxSplitTails);
+  unsigned OldMaxSplitTails = *MaxSplitTails;
+  MaxSplitTails->setValue(0);
+
+  // Past the limit the alloca is left alone rather than split.
+  parseAssembly(OverlappingCopiesIR);
+  runSROA();
+  EXPECT_EQ(countAllocas(), 1u);
+
+  MaxSplitTails->setValue(OldMaxSplitTails);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,52 @@
+//===- CodeLayoutTest.cpp - CodeLayout unit tests -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/CodeLayout.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(CodeLayoutTest, HotPathFallsThrough) {
+  // 0 -> 1 (cold) and 0 -> 2 (hot), both rejoining at 3.
+  std::vector<uint64_t> Sizes = {16, 16, 16, 16};
+  std::vector<uint64_t> Counts = {100, 1, 99, 100};
+  std::vector<EdgeCountT> Edges = {
+      {{0, 1}, 1}, {{0, 2}, 99}, {{1, 3}, 1}, {{2, 3}, 99}};
+
+  std::vector<uint64_t> Order = applyExtTspLayout(Sizes, Counts, Edges);
+  EXPECT_EQ(Order, (std::vector<uint64_t>{0, 2, 3, 1}));
+  EXPECT_GT(calcExtTspScore(Order, Sizes, Counts, Edges),
+            calcExtTspScore(Sizes, Counts, Edges));
+}
+
+TEST(CodeLayoutTest, EntryStaysFirst) {
+  // A hot loop 1 <-> 2 entered once from 0; 3 is never executed.
+  std::vector<uint64_t> Sizes = {8, 8, 8, 8};
+  std::vector<uint64_t> Counts = {1, 1000, 1000, 0};
+  std::vector<EdgeCountT> Edges = {
+      {{0, 2}, 1}, {{2, 1}, 1000}, {{1, 2}, 999}, {{0, 3}, 0}};
+
+  std::vector<uint64_t> Order = applyExtTspLayout(Sizes, Counts, Edges);
+  ASSERT_EQ(Order.size(), 4u);
+  EXPECT_EQ(Order.front(), 0u);
+  // The cold block goes last.
+  EXPECT_EQ(Order.back(), 3u);
+}
+
+TEST(CodeLayoutTest, BlocksWithoutProfileKeepOrder) {
+  std::vector<uint64_t> Sizes = {4, 4, 4, 4, 4};
+  std::vector<uint64_t> Counts = {0, 0, 0, 0, 0};
+  std::vector<EdgeCountT> Edges = {{{0, 1}, 0}, {{1, 2}, 0}, {{3, 4}, 0}};
+
+  std::vector<uint64_t> Order = applyExtTspLayout(Sizes, Counts, Edges);
+  EXPECT_EQ(Order, (std::vector<uint64_t>{0, 1, 2, 3, 4}));
+}
+
+} // end anonymous namespace
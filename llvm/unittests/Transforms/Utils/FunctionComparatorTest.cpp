@@ -127,3 +127,38 @@ TEST(FunctionComparatorTest, TestAPI) {
   EXPECT_EQ(Cmp.testCmpTypes(F1.T, F2.T), 0);
   EXPECT_EQ(Cmp.testCmpPrimitives(), -4);
 }
+
+/// Functions that differ only in a constant hash alike and can be compared
+/// modulo that constant.
+TEST(FunctionComparatorTest, CompareModuloConstants) {
+  LLVMContext C;
+  Module M("test", C);
+  TestFunction F1(C, M, 27);
+  TestFunction F2(C, M, 28);
+  TestFunction F3(C, M, 27);
+
+  EXPECT_EQ(FunctionComparator::functionHash(*F1.F),
+            FunctionComparator::functionHash(*F2.F));
+
+  GlobalNumberState GN;
+  SmallVector<FunctionComparator::ConstantDiff, 4> Diffs;
+  EXPECT_EQ(FunctionComparator(F1.F, F2.F, &GN).compareModuloConstants(Diffs),
+            0);
+  ASSERT_EQ(Diffs.size(), 1u);
+  EXPECT_EQ(Diffs[0].Inst, F1.I);
+  EXPECT_EQ(Diffs[0].OpNo, 1u);
+  EXPECT_EQ(Diffs[0].RightValue, F2.C);
+
+  Diffs.clear();
+  EXPECT_EQ(FunctionComparator(F1.F, F3.F, &GN).compareModuloConstants(Diffs),
+            0);
+  EXPECT_TRUE(Diffs.empty());
+
+  // A different operation still makes the functions differ.
+  cast<BinaryOperator>(F2.I)->setHasNoSignedWrap();
+  EXPECT_NE(FunctionComparator(F1.F, F2.F, &GN).compareModuloConstants(Diffs),
+            0);
+  EXPECT_TRUE(Diffs.empty());
+  EXPECT_NE(FunctionComparator::functionHash(*F1.F),
+            FunctionComparator::functionHash(*F2.F));
+}
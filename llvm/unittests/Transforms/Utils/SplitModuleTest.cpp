@@ -0,0 +1,119 @@
+//===- SplitModuleTest.cpp - SplitModule unit tests -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// An external function calling a few small internal ones and one large one,
+// which is the usual shape of a module after full LTO internalization.
+const char *InternalCalleesIR = R"(
+  define internal i32 @a(i32 %x) {
+    %r = add i32 %x, 1
+    ret i32 %r
+  }
+
+  define internal i32 @b(i32 %x) {
+    %r = add i32 %x, 2
+    ret i32 %r
+  }
+
+  define internal i32 @c(i32 %x) {
+    %r = add i32 %x, 3
+    ret i32 %r
+  }
+
+  define internal i32 @big(i32 %x) {
+    %r0 = mul i32 %x, %x
+    %r1 = mul i32 %r0, %x
+    %r2 = mul i32 %r1, %x
+    %r3 = mul i32 %r2, %x
+    %r4 = mul i32 %r3, %x
+    %r5 = mul i32 %r4, %x
+    %r6 = mul i32 %r5, %x
+    %r7 = mul i32 %r6, %x
+    %r8 = mul i32 %r7, %x
+    %r9 = mul i32 %r8, %x
+    ret i32 %r9
+  }
+
+  define i32 @main(i32 %x) {
+    %a = call i32 @a(i32 %x)
+    %b = call i32 @b(i32 %a)
+    %c = call i32 @c(i32 %b)
+    %r = call i32 @big(i32 %c)
+    ret i32 %r
+  }
+)";
+
+// Splits InternalCalleesIR into N partitions and returns the names of the
+// functions defined in each.
+std::vector<std::vector<std::string>> splitInternalCallees(unsigned N,
+                                                           bool PreserveLocals) {
+  LLVMContext Context;
+  SMDiagnostic Error;
+  std::unique_ptr<Module> M =
+      parseAssemblyString(InternalCalleesIR, Error, Context);
+  EXPECT_TRUE(M) << Error.getMessage();
+  if (!M)
+    return {};
+
+  std::vector<std::vector<std::string>> Partitions;
+  SplitModule(
+      std::move(M), N,
+      [&](std::unique_ptr<Module> MPart) {
+        Partitions.emplace_back();
+        for (Function &F : *MPart)
+          if (!F.isDeclaration())
+            Partitions.back().push_back(F.getName().str());
+      },
+      PreserveLocals);
+  return Partitions;
+}
+
+TEST(SplitModuleTest, ExternalizedLocalsAreBalanced) {
+  std::vector<std::vector<std::string>> Partitions =
+      splitInternalCallees(4, /*PreserveLocals=*/false);
+  ASSERT_EQ(Partitions.size(), 4u);
+
+  // Every partition gets some of the work, and the large function is not
+  // paired with anything else.
+  unsigned NumDefs = 0;
+  for (const std::vector<std::string> &Part : Partitions) {
+    EXPECT_FALSE(Part.empty());
+    NumDefs += Part.size();
+    if (llvm::is_contained(Part, "big"))
+      EXPECT_EQ(Part.size(), 1u);
+  }
+  EXPECT_EQ(NumDefs, 5u);
+}
+
+TEST(SplitModuleTest, PreservedLocalsStayWithTheirUsers) {
+  std::vector<std::vector<std::string>> Partitions =
+      splitInternalCallees(4, /*PreserveLocals=*/true);
+  ASSERT_EQ(Partitions.size(), 4u);
+
+  // All the internal functions have to stay with @main, so there is only one
+  // non-empty partition.
+  unsigned NumNonEmpty = 0;
+  for (const std::vector<std::string> &Part : Partitions)
+    if (!Part.empty()) {
+      ++NumNonEmpty;
+      EXPECT_EQ(Part.size(), 5u);
+    }
+  EXPECT_EQ(NumNonEmpty, 1u);
+}
+
+} // end anonymous namespace
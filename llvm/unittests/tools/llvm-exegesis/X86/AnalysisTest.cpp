@@ -0,0 +1,129 @@
+//===-- AnalysisTest.cpp ----------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "Analysis.h"
+
+#include <memory>
+
+#include "TestBase.h"
+#include "X86InstrInfo.h"
+#include "llvm/MC/MCInstBuilder.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace llvm {
+namespace exegesis {
+namespace {
+
+using testing::HasSubstr;
+using testing::Not;
+
+class AnalysisTest : public X86TestBase {
+protected:
+  static void SetUpTestCase() {
+    X86TestBase::SetUpTestCase();
+    LLVMInitializeX86Disassembler();
+  }
+
+  // Adds a uops point for `Opcode` with the given per-port pressure on
+  // HWPort0, HWPort1, HWPort5 and HWPort6.
+  void addUopsPoint(unsigned Opcode, double NumMicroOps, double P0, double P1,
+                    double P5, double P6) {
+    InstructionBenchmark Point;
+    Point.Mode = InstructionBenchmark::Uops;
+    Point.CpuName = "haswell";
+    Point.LLVMTriple = "x86_64-unknown-linux";
+    Point.Key.Instructions.push_back(MCInstBuilder(Opcode)
+                                         .addReg(X86::EAX)
+                                         .addReg(X86::EAX)
+                                         .addReg(X86::ECX));
+    Point.Measurements = {BenchmarkMeasure::Create("NumMicroOps", NumMicroOps),
+                          BenchmarkMeasure::Create("HWPort0", P0),
+                          BenchmarkMeasure::Create("HWPort1", P1),
+                          BenchmarkMeasure::Create("HWPort5", P5),
+                          BenchmarkMeasure::Create("HWPort6", P6)};
+    Points.push_back(std::move(Point));
+  }
+
+  std::string printOverrides() {
+    auto Clustering = InstructionBenchmarkClustering::create(
+        Points, InstructionBenchmarkClustering::ModeE::Naive,
+        /*DbscanMinPts=*/1, /*AnalysisClusteringEpsilon=*/0.1,
+        State.getInstrInfo().getNumOpcodes());
+    EXPECT_TRUE((bool)Clustering);
+    if (!Clustering)
+      return toString(Clustering.takeError());
+    const Target &TheTarget = State.getTargetMachine().getTarget();
+    Analysis A(TheTarget, std::unique_ptr<MCInstrInfo>(
+                              TheTarget.createMCInstrInfo()),
+               *Clustering, /*AnalysisInconsistencyEpsilon=*/0.1,
+               /*AnalysisDisplayUnstableOpcodes=*/false);
+    std::string Buffer;
+    raw_string_ostream OS(Buffer);
+    EXPECT_FALSE((bool)A.run<Analysis::PrintSchedModelOverrides>(OS));
+    return OS.str();
+  }
+
+  std::vector<InstructionBenchmark> Points;
+};
+
+TEST_F(AnalysisTest, SchedModelOverridesUseGroupOfFractionalPorts) {
+  // A uop spread evenly over ports 0, 1 and 5 is a use of HWPort015.
+  addUopsPoint(X86::ADD32rr, 1.0, 0.33, 0.33, 0.34, 0.0);
+  addUopsPoint(X86::ADD32rr, 1.0, 0.33, 0.33, 0.34, 0.0);
+  const std::string Output = printOverrides();
+  EXPECT_THAT(Output, HasSubstr("fitted by llvm-exegesis from 2 benchmark "
+                                "points.\n"));
+  EXPECT_THAT(Output,
+              HasSubstr("\n// ADD32rr: HWPort0=0.33 HWPort1=0.33 "
+                        "HWPort5=0.34\n"
+                        "def ExegesisWrite_ADD32rr : "
+                        "SchedWriteRes<[HWPort015]> {\n"
+                        "  let NumMicroOps = 1;\n"
+                        "  let ResourceCycles = [1];\n"
+                        "}\n"
+                        "def : InstRW<[ExegesisWrite_ADD32rr], (instrs "
+                        "ADD32rr)>;\n"));
+}
+
+TEST_F(AnalysisTest, SchedModelOverridesWithoutMatchingGroup) {
+  // There is no HWPort016, so each port is listed on its own.
+  addUopsPoint(X86::SUB32rr, 1.0, 0.33, 0.33, 0.0, 0.34);
+  // Full uses of ports 0 and 5 are not a use of HWPort05.
+  addUopsPoint(X86::AND32rr, 2.0, 1.0, 0.0, 1.0, 0.0);
+  const std::string Output = printOverrides();
+  EXPECT_THAT(Output,
+              HasSubstr("def ExegesisWrite_SUB32rr : SchedWriteRes<[HWPort0, "
+                        "HWPort1, HWPort6]> {\n"
+                        "  let NumMicroOps = 1;\n"
+                        "  let ResourceCycles = [1, 1, 1];\n"
+                        "}\n"));
+  EXPECT_THAT(Output,
+              HasSubstr("def ExegesisWrite_AND32rr : SchedWriteRes<[HWPort0, "
+                        "HWPort5]> {\n"
+                        "  let NumMicroOps = 2;\n"
+                        "  let ResourceCycles = [1, 1];\n"
+                        "}\n"));
+  EXPECT_THAT(Output, Not(HasSubstr("HWPort05]")));
+}
+
+TEST_F(AnalysisTest, SchedModelOverridesSkipErrorPoints) {
+  addUopsPoint(X86::ADD32rr, 1.0, 0.33, 0.33, 0.34, 0.0);
+  Points.back().Error = "oops";
+  addUopsPoint(X86::SUB32rr, 1.0, 1.0, 0.0, 0.0, 0.0);
+  const std::string Output = printOverrides();
+  EXPECT_THAT(Output, Not(HasSubstr("ADD32rr")));
+  EXPECT_THAT(Output, HasSubstr("def ExegesisWrite_SUB32rr : "
+                                "SchedWriteRes<[HWPort0]> {\n"));
+}
+
+} // namespace
+} // namespace exegesis
+} // namespace llvm
@@ -12,7 +12,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "CodeGenDAGPatterns.h"
-#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
@@ -30,6 +29,7 @@
 #include <cstdio>
 #include <iterator>
 #include <set>
+#include <tuple>
 using namespace llvm;
 
 #define DEBUG_TYPE "dag-patterns"
@@ -4619,9 +4619,35 @@ void CodeGenDAGPatterns::GenerateVariants() {
   // already been added.
   //
   const unsigned NumOriginalPatterns = PatternsToMatch.size();
-  BitVector MatchedPatterns(NumOriginalPatterns);
-  std::vector<BitVector> MatchedPredicates(NumOriginalPatterns,
-                                           BitVector(NumOriginalPatterns));
+
+  // Partition the patterns into classes with identical predicate lists. A
+  // variant can only be a duplicate of a pattern in its own class, so each
+  // variant is checked against the members of that class instead of against
+  // every pattern. The ordering mirrors Predicate::operator==, which is what
+  // decides whether two predicate lists match.
+  auto PredicateLess = [](const Predicate &A, const Predicate &B) {
+    return std::make_tuple(A.IsHwMode, A.IfCond, A.Def) <
+           std::make_tuple(B.IsHwMode, B.IfCond, B.Def);
+  };
+  auto PredicatesLess = [&](const std::vector<Predicate> *A,
+                            const std::vector<Predicate> *B) {
+    return std::lexicographical_compare(A->begin(), A->end(), B->begin(),
+                                        B->end(), PredicateLess);
+  };
+  std::map<const std::vector<Predicate> *, unsigned, decltype(PredicatesLess)>
+      PredicateClassIDs(PredicatesLess);
+  std::vector<unsigned> PredicateClassOf(NumOriginalPatterns);
+  std::vector<std::vector<unsigned>> PredicateClasses;
+  for (unsigned i = 0; i != NumOriginalPatterns; ++i) {
+    auto Ins = PredicateClassIDs.insert(std::make_pair(
+        &PatternsToMatch[i].getPredicates(), PredicateClasses.size()));
+    if (Ins.second)
+      PredicateClasses.emplace_back();
+    PredicateClassOf[i] = Ins.first->second;
+    PredicateClasses[Ins.first->second].push_back(i);
+  }
+  // PatternsToMatch grows below; the keys must not be used past this point.
+  PredicateClassIDs.clear();
 
   typedef std::pair<MultipleUseVarSet, std::vector<TreePatternNodePtr>>
       DepsAndVariants;
@@ -4646,29 +4672,6 @@ void CodeGenDAGPatterns::GenerateVariants() {
                PatternsToMatch[i].getSrcPattern()->dump(); errs() << "\n");
 
     PatternsWithVariants[i] = std::make_pair(DepVars, Variants);
-
-    // Cache matching predicates.
-    if (MatchedPatterns[i])
-      continue;
-
-    const std::vector<Predicate> &Predicates =
-        PatternsToMatch[i].getPredicates();
-
-    BitVector &Matches = MatchedPredicates[i];
-    MatchedPatterns.set(i);
-    Matches.set(i);
-
-    // Don't test patterns that have already been cached - it won't match.
-    for (unsigned p = 0; p != NumOriginalPatterns; ++p)
-      if (!MatchedPatterns[p])
-        Matches[p] = (Predicates == PatternsToMatch[p].getPredicates());
-
-    // Copy this to all the matching patterns.
-    for (int p = Matches.find_first(); p != -1; p = Matches.find_next(p))
-      if (p != (int)i) {
-        MatchedPatterns.set(p);
-        MatchedPredicates[p] = Matches;
-      }
   }
 
   for (auto it : PatternsWithVariants) {
@@ -4678,17 +4681,14 @@ void CodeGenDAGPatterns::GenerateVariants() {
 
     for (unsigned v = 0, e = Variants.size(); v != e; ++v) {
       TreePatternNodePtr Variant = Variants[v];
-      BitVector &Matches = MatchedPredicates[i];
+      std::vector<unsigned> &Matches = PredicateClasses[PredicateClassOf[i]];
 
       LLVM_DEBUG(errs() << "  VAR#" << v << ": "; Variant->dump();
                  errs() << "\n");
 
       // Scan to see if an instruction or explicit pattern already matches this.
       bool AlreadyExists = false;
-      for (unsigned p = 0, e = PatternsToMatch.size(); p != e; ++p) {
-        // Skip if the top level predicates do not match.
-        if (!Matches[p])
-          continue;
+      for (unsigned p : Matches) {
         // Check to see if this variant already exists.
         if (Variant->isIsomorphicTo(PatternsToMatch[p].getSrcPattern(),
                                     DepVars)) {
@@ -4706,11 +4706,9 @@ void CodeGenDAGPatterns::GenerateVariants() {
           Variant, PatternsToMatch[i].getDstPatternShared(),
           PatternsToMatch[i].getDstRegs(),
           PatternsToMatch[i].getAddedComplexity(), Record::getNewUID()));
-      MatchedPredicates.push_back(Matches);
 
-      // Add a new match the same as this pattern.
-      for (auto &P : MatchedPredicates)
-        P.push_back(P[i]);
+      // The new pattern shares the predicates of the one it was made from.
+      Matches.push_back(PatternsToMatch.size() - 1);
     }
 
     LLVM_DEBUG(errs() << "\n");
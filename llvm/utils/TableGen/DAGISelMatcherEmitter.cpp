@@ -31,6 +31,9 @@ enum {
   HistOpcWidth = 40,
 };
 
+// Switches with at least this many cases are emitted in their table form.
+static const unsigned MinSwitchTableCases = 4;
+
 cl::OptionCategory DAGISelCat("Options for -gen-dag-isel");
 
 // To reduce generated source code size.
@@ -79,8 +82,7 @@ class MatcherTableEmitter {
   }
 
 public:
-  MatcherTableEmitter(const CodeGenDAGPatterns &cgp)
-    : CGP(cgp) {}
+  MatcherTableEmitter(const Matcher *TheMatcher, const CodeGenDAGPatterns &cgp);
 
   unsigned EmitMatcherList(const Matcher *N, unsigned Indent,
                            unsigned StartIdx, raw_ostream &OS);
@@ -98,6 +100,10 @@ private:
   unsigned EmitMatcher(const Matcher *N, unsigned Indent, unsigned CurrentIdx,
                        raw_ostream &OS);
 
+  unsigned EmitSwitchTable(const Matcher *N, unsigned NumCases,
+                           unsigned Indent, unsigned CurrentIdx,
+                           raw_ostream &OS);
+
   unsigned getNodePredicate(TreePredicateFn Pred) {
     TreePattern *TP = Pred.getOrigPatFragRecord();
     unsigned &Entry = NodePredicateMap[TP];
@@ -157,6 +163,69 @@ private:
 };
 } // end anonymous namespace.
 
+/// CountUses - Count how many times each node predicate, pattern predicate and
+/// complex pattern is checked by the matcher.
+static void
+CountUses(const Matcher *N, MapVector<TreePattern *, unsigned> &NodePredUses,
+          MapVector<StringRef, unsigned> &PatternPredUses,
+          MapVector<const ComplexPattern *, unsigned> &ComplexPatUses) {
+  for (; N; N = N->getNext()) {
+    if (const auto *SM = dyn_cast<ScopeMatcher>(N)) {
+      for (unsigned i = 0, e = SM->getNumChildren(); i != e; ++i)
+        CountUses(SM->getChild(i), NodePredUses, PatternPredUses,
+                  ComplexPatUses);
+    } else if (const auto *SOM = dyn_cast<SwitchOpcodeMatcher>(N)) {
+      for (unsigned i = 0, e = SOM->getNumCases(); i != e; ++i)
+        CountUses(SOM->getCaseMatcher(i), NodePredUses, PatternPredUses,
+                  ComplexPatUses);
+    } else if (const auto *STM = dyn_cast<SwitchTypeMatcher>(N)) {
+      for (unsigned i = 0, e = STM->getNumCases(); i != e; ++i)
+        CountUses(STM->getCaseMatcher(i), NodePredUses, PatternPredUses,
+                  ComplexPatUses);
+    } else if (const auto *CPM = dyn_cast<CheckPredicateMatcher>(N)) {
+      ++NodePredUses[CPM->getPredicate().getOrigPatFragRecord()];
+    } else if (const auto *CPPM = dyn_cast<CheckPatternPredicateMatcher>(N)) {
+      ++PatternPredUses[CPPM->getPredicate()];
+    } else if (const auto *CCPM = dyn_cast<CheckComplexPatMatcher>(N)) {
+      ++ComplexPatUses[&CCPM->getPattern()];
+    }
+  }
+}
+
+/// SortByUses - Return the keys of \p Uses, most used first.  Keys that are
+/// used equally often stay in the order they were first seen.
+template <typename KeyT>
+static std::vector<KeyT> SortByUses(MapVector<KeyT, unsigned> &Uses) {
+  auto Entries = Uses.takeVector();
+  llvm::stable_sort(Entries, [](const std::pair<KeyT, unsigned> &A,
+                                const std::pair<KeyT, unsigned> &B) {
+    return A.second > B.second;
+  });
+  std::vector<KeyT> Keys;
+  for (auto &Entry : Entries)
+    Keys.push_back(Entry.first);
+  return Keys;
+}
+
+MatcherTableEmitter::MatcherTableEmitter(const Matcher *TheMatcher,
+                                         const CodeGenDAGPatterns &cgp)
+    : CGP(cgp) {
+  // Hand out the predicate and complex pattern numbers by decreasing number
+  // of uses, so that the most common ones get the space-optimized opcodes
+  // that implicitly encode numbers 0...7.
+  MapVector<TreePattern *, unsigned> NodePredUses;
+  MapVector<StringRef, unsigned> PatternPredUses;
+  MapVector<const ComplexPattern *, unsigned> ComplexPatUses;
+  CountUses(TheMatcher, NodePredUses, PatternPredUses, ComplexPatUses);
+
+  for (TreePattern *TP : SortByUses(NodePredUses))
+    getNodePredicate(TreePredicateFn(TP));
+  for (StringRef Pred : SortByUses(PatternPredUses))
+    getPatternPredicate(Pred);
+  for (const ComplexPattern *P : SortByUses(ComplexPatUses))
+    getComplexPat(*P);
+}
+
 static std::string GetPatFromTreePatternNode(const TreePatternNode *N) {
   std::string str;
   raw_string_ostream Stream(str);
@@ -399,31 +468,40 @@ EmitMatcher(const Matcher *N, unsigned Indent, unsigned CurrentIdx,
 
   case Matcher::CheckPatternPredicate: {
     StringRef Pred =cast<CheckPatternPredicateMatcher>(N)->getPredicate();
-    OS << "OPC_CheckPatternPredicate, " << getPatternPredicate(Pred) << ',';
+    unsigned PredNo = getPatternPredicate(Pred);
+    if (PredNo < 8)
+      OS << "OPC_CheckPatternPredicate" << PredNo << ',';
+    else
+      OS << "OPC_CheckPatternPredicate, " << PredNo << ',';
     if (!OmitComments)
       OS << " // " << Pred;
     OS << '\n';
-    return 2;
+    return PredNo < 8 ? 1 : 2;
   }
   case Matcher::CheckPredicate: {
     TreePredicateFn Pred = cast<CheckPredicateMatcher>(N)->getPredicate();
-    unsigned OperandBytes = 0;
+    unsigned PredNo = getNodePredicate(Pred);
+    unsigned Bytes;
 
     if (Pred.usesOperands()) {
       unsigned NumOps = cast<CheckPredicateMatcher>(N)->getNumOperands();
       OS << "OPC_CheckPredicateWithOperands, " << NumOps << "/*#Ops*/, ";
       for (unsigned i = 0; i < NumOps; ++i)
         OS << cast<CheckPredicateMatcher>(N)->getOperandNo(i) << ", ";
-      OperandBytes = 1 + NumOps;
+      OS << PredNo << ',';
+      Bytes = 3 + NumOps;
+    } else if (PredNo < 8) {
+      OS << "OPC_CheckPredicate" << PredNo << ',';
+      Bytes = 1;
     } else {
-      OS << "OPC_CheckPredicate, ";
+      OS << "OPC_CheckPredicate, " << PredNo << ',';
+      Bytes = 2;
     }
 
-    OS << getNodePredicate(Pred) << ',';
     if (!OmitComments)
       OS << " // " << Pred.getFnName();
     OS << '\n';
-    return 2 + OperandBytes;
+    return Bytes;
   }
 
   case Matcher::CheckOpcode:
@@ -436,13 +514,21 @@ EmitMatcher(const Matcher *N, unsigned Indent, unsigned CurrentIdx,
     unsigned StartIdx = CurrentIdx;
 
     unsigned NumCases;
-    if (const SwitchOpcodeMatcher *SOM = dyn_cast<SwitchOpcodeMatcher>(N)) {
-      OS << "OPC_SwitchOpcode ";
+    if (const SwitchOpcodeMatcher *SOM = dyn_cast<SwitchOpcodeMatcher>(N))
       NumCases = SOM->getNumCases();
-    } else {
-      OS << "OPC_SwitchType ";
+    else
       NumCases = cast<SwitchTypeMatcher>(N)->getNumCases();
-    }
+
+    // Larger switches are emitted as a table of case values so that looking
+    // up a case doesn't have to step over all the case bodies before it.  The
+    // root switch is left alone: SelectCodeCommon indexes it with its
+    // OpcodeOffset cache.
+    if (StartIdx != 0 && NumCases >= MinSwitchTableCases)
+      if (unsigned Size = EmitSwitchTable(N, NumCases, Indent, CurrentIdx, OS))
+        return Size;
+
+    OS << (isa<SwitchOpcodeMatcher>(N) ? "OPC_SwitchOpcode "
+                                       : "OPC_SwitchType ");
 
     if (!OmitComments)
       OS << "/*" << NumCases << " cases */";
@@ -567,8 +653,12 @@ EmitMatcher(const Matcher *N, unsigned Indent, unsigned CurrentIdx,
   case Matcher::CheckComplexPat: {
     const CheckComplexPatMatcher *CCPM = cast<CheckComplexPatMatcher>(N);
     const ComplexPattern &Pattern = CCPM->getPattern();
-    OS << "OPC_CheckComplexPat, /*CP*/" << getComplexPat(Pattern) << ", /*#*/"
-       << CCPM->getMatchNumber() << ',';
+    unsigned PatNo = getComplexPat(Pattern);
+    if (PatNo < 8)
+      OS << "OPC_CheckComplexPat" << PatNo << ", /*#*/";
+    else
+      OS << "OPC_CheckComplexPat, /*CP*/" << PatNo << ", /*#*/";
+    OS << CCPM->getMatchNumber() << ',';
 
     if (!OmitComments) {
       OS << " // " << Pattern.getSelectFunc();
@@ -580,7 +670,7 @@ EmitMatcher(const Matcher *N, unsigned Indent, unsigned CurrentIdx,
         OS << " + chain result";
     }
     OS << '\n';
-    return 3;
+    return PatNo < 8 ? 2 : 3;
   }
 
   case Matcher::CheckAndImm: {
@@ -810,6 +900,80 @@ EmitMatcher(const Matcher *N, unsigned Indent, unsigned CurrentIdx,
   llvm_unreachable("Unreachable");
 }
 
+/// EmitSwitchTable - Emit a SwitchOpcode or SwitchType matcher in its table
+/// form: the number of cases, then the value of each case along with the
+/// 16-bit offset of its body from the end of the table, then the bodies.
+/// Return the number of bytes emitted, or zero without emitting anything if
+/// the bodies are too large to be reached with 16-bit offsets.
+unsigned MatcherTableEmitter::EmitSwitchTable(const Matcher *N,
+                                              unsigned NumCases,
+                                              unsigned Indent,
+                                              unsigned CurrentIdx,
+                                              raw_ostream &OS) {
+  const auto *SOM = dyn_cast<SwitchOpcodeMatcher>(N);
+  const auto *STM = dyn_cast<SwitchTypeMatcher>(N);
+  unsigned EntrySize = SOM ? 4 : 3;
+  unsigned TableIdx = CurrentIdx + 1 + GetVBRSize(NumCases);
+  unsigned BodiesIdx = TableIdx + NumCases * EntrySize;
+
+  // Emit the case bodies first to find out where each of them starts.
+  SmallString<128> Bodies;
+  raw_svector_ostream BodiesOS(Bodies);
+  SmallVector<unsigned, 16> Offsets;
+  unsigned BodiesSize = 0;
+  for (unsigned i = 0; i != NumCases; ++i) {
+    if (!isUInt<16>(BodiesSize))
+      return 0;
+    Offsets.push_back(BodiesSize);
+
+    const Matcher *Child;
+    if (SOM) {
+      Child = SOM->getCaseMatcher(i);
+    } else {
+      Child = STM->getCaseMatcher(i);
+      assert(STM->getCaseType(i) != MVT::iPTR &&
+             "The table form doesn't resolve iPTR");
+    }
+
+    if (!OmitComments) {
+      BodiesOS.indent(FullIndexWidth + Indent*2 + 2) << "// ";
+      if (SOM)
+        BodiesOS << SOM->getCaseOpcode(i).getEnumName() << '\n';
+      else
+        BodiesOS << getEnumName(STM->getCaseType(i)) << '\n';
+    }
+
+    unsigned ChildSize = EmitMatcherList(Child, Indent+1,
+                                         BodiesIdx+BodiesSize, BodiesOS);
+    assert(ChildSize != 0 && "Should not have a zero-sized child!");
+    BodiesSize += ChildSize;
+  }
+
+  OS << (SOM ? "OPC_SwitchOpcodeTable " : "OPC_SwitchTypeTable ");
+  if (!OmitComments)
+    OS << "/*" << NumCases << " cases */";
+  OS << ", ";
+  EmitVBRValue(NumCases, OS);
+  OS << '\n';
+
+  for (unsigned i = 0; i != NumCases; ++i) {
+    if (!OmitComments)
+      OS << "/*" << format_decimal(TableIdx + i*EntrySize, IndexWidth) << "*/";
+    OS.indent(Indent*2 + 2);
+    if (SOM)
+      OS << "TARGET_VAL(" << SOM->getCaseOpcode(i).getEnumName() << "), ";
+    else
+      OS << getEnumName(STM->getCaseType(i)) << ", ";
+    OS << "TARGET_VAL(" << Offsets[i] << "),";
+    if (!OmitComments)
+      OS << " // ->" << BodiesIdx + Offsets[i];
+    OS << '\n';
+  }
+
+  OS << Bodies;
+  return BodiesIdx + BodiesSize - CurrentIdx;
+}
+
 /// EmitMatcherList - Emit the bytes for the specified matcher subtree.
 unsigned MatcherTableEmitter::
 EmitMatcherList(const Matcher *N, unsigned Indent, unsigned CurrentIdx,
@@ -1094,7 +1258,7 @@ void llvm::EmitMatcherTable(const Matcher *TheMatcher,
   OS << "#endif\n\n";
 
   BeginEmitFunction(OS, "void", "SelectCode(SDNode *N)", false/*AddOverride*/);
-  MatcherTableEmitter MatcherEmitter(CGP);
+  MatcherTableEmitter MatcherEmitter(TheMatcher, CGP);
 
   OS << "{\n";
   OS << "  // Some target values are emitted as 2 bytes, TARGET_VAL handles\n";
@@ -618,6 +618,13 @@ public:
   /// response to the generated cl::opt.
   void emitNameMatcher(raw_ostream &OS) const;
 
+  /// Return the name of the generated statistic counting the \p Event's of
+  /// \p Rule.
+  std::string getRuleStatisticName(const CombineRule &Rule,
+                                   StringRef Event) const {
+    return (Name + "Rule" + Twine(Rule.getID()) + Event).str();
+  }
+
   void generateDeclarationsCodeForTree(raw_ostream &OS, const GIMatchTree &Tree) const;
   void generateCodeForTree(raw_ostream &OS, const GIMatchTree &Tree,
                            StringRef Indent) const;
@@ -725,13 +732,17 @@ void GICombinerEmitter::generateCodeForTree(raw_ostream &OS,
                                             const GIMatchTree &Tree,
                                             StringRef Indent) const {
   if (Tree.getPartitioner() != nullptr) {
+    // Dispatch to the selected partition with a switch so that each level of
+    // the tree costs a single jump rather than a comparison per partition.
     Tree.getPartitioner()->generatePartitionSelectorCode(OS, Indent);
+    OS << Indent << "switch (Partition) {\n";
     for (const auto &EnumChildren : enumerate(Tree.children())) {
-      OS << Indent << "if (Partition == " << EnumChildren.index() << " /* "
-         << format_partition_name(Tree, EnumChildren.index()) << " */) {\n";
+      OS << Indent << "case " << EnumChildren.index() << ": { // "
+         << format_partition_name(Tree, EnumChildren.index()) << "\n";
       generateCodeForTree(OS, EnumChildren.value(), (Indent + "  ").str());
-      OS << Indent << "}\n";
+      OS << Indent << "  break;\n" << Indent << "}\n";
     }
+    OS << Indent << "}\n";
     return;
   }
 
@@ -743,7 +754,8 @@ void GICombinerEmitter::generateCodeForTree(raw_ostream &OS,
     const Record &RuleDef = Rule->getDef();
 
     OS << Indent << "// Rule: " << RuleDef.getName() << "\n"
-       << Indent << "if (!isRuleDisabled(" << Rule->getID() << ")) {\n";
+       << Indent << "if (!isRuleDisabled(" << Rule->getID() << ")) {\n"
+       << Indent << "  ++" << getRuleStatisticName(*Rule, "Tried") << ";\n";
 
     CodeExpansions Expansions;
     for (const auto &VarBinding : Leaf.var_bindings()) {
@@ -807,7 +819,10 @@ void GICombinerEmitter::generateCodeForTree(raw_ostream &OS,
          << Indent << "      return true;\n"
          << Indent << "  }()";
     }
-    OS << ") {\n" << Indent << "   ";
+    OS << ") {\n"
+       << Indent << "    ++" << getRuleStatisticName(*Rule, "Applied")
+       << ";\n"
+       << Indent << "   ";
 
     if (const CodeInit *Code = dyn_cast<CodeInit>(Applyer->getArg(0))) {
       OS << CodeExpander(Code->getAsUnquotedString(), Expansions,
@@ -884,6 +899,7 @@ void GICombinerEmitter::run(raw_ostream &OS) {
                      TimeRegions);
   OS << "#ifdef " << Name.upper() << "_GENCOMBINERHELPER_DEPS\n"
      << "#include \"llvm/ADT/SparseBitVector.h\"\n"
+     << "#include \"llvm/ADT/Statistic.h\"\n"
      << "namespace llvm {\n"
      << "extern cl::OptionCategory GICombinerOptionCategory;\n"
      << "} // end namespace llvm\n"
@@ -955,6 +971,19 @@ void GICombinerEmitter::run(raw_ostream &OS) {
      << "  return true;\n"
      << "}\n\n";
 
+  // Count how often each rule gets as far as its untested predicates and C++
+  // match code, and how often it is applied. Rules which are tried much more
+  // often than they are applied are the ones the match tree doesn't filter.
+  for (const auto &Rule : Rules) {
+    OS << "STATISTIC(" << getRuleStatisticName(*Rule, "Tried")
+       << ", \"Number of times the " << Rule->getName()
+       << " rule was tried\");\n"
+       << "STATISTIC(" << getRuleStatisticName(*Rule, "Applied")
+       << ", \"Number of times the " << Rule->getName()
+       << " rule was applied\");\n";
+  }
+  OS << "\n";
+
   OS << "bool " << getClassName() << "::tryCombineAll(\n"
      << "    GISelChangeObserver &Observer,\n"
      << "    MachineInstr &MI,\n"
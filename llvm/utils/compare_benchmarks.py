@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Compare the LLVM benchmarks of two build trees.
+
+Runs every benchmark binary in llvm/benchmarks from a baseline build and a
+new build, alternating between the two, and reports the change in the median
+time of each benchmark:
+
+  compare_benchmarks.py <baseline-build> <new-build>
+  compare_benchmarks.py <baseline-build> <new-build> ADT InstCombine \\
+      --filter 'DenseMap' --repetitions 10 --threshold 3
+
+Both trees need the benchmarks built, e.g. with `ninja Benchmarks` and
+-DLLVM_INCLUDE_BENCHMARKS=ON. The script exits with status 1 if any
+benchmark got slower by more than the threshold.
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+
+AGGREGATE_SUFFIXES = ('_mean', '_median', '_stddev')
+TIME_UNITS = {'ns': 1e-9, 'us': 1e-6, 'ms': 1e-3, 's': 1.0}
+
+
+def find_benchmarks(build_dir):
+    bench_dir = os.path.join(build_dir, 'benchmarks')
+    if not os.path.isdir(bench_dir):
+        sys.exit('error: no benchmarks directory in %s' % build_dir)
+    return sorted(name for name in os.listdir(bench_dir)
+                  if os.path.isfile(os.path.join(bench_dir, name)) and
+                  os.access(os.path.join(bench_dir, name), os.X_OK))
+
+
+def run_benchmark(build_dir, name, args):
+    """Run one benchmark binary once and return {benchmark: seconds}."""
+    binary = os.path.join(build_dir, 'benchmarks', name)
+    cmd = [binary, '--benchmark_format=json',
+           '--benchmark_filter=' + args.filter]
+    if args.min_time is not None:
+        cmd.append('--benchmark_min_time=%s' % args.min_time)
+    output = subprocess.check_output(cmd)
+    times = {}
+    for run in json.loads(output.decode('utf-8'))['benchmarks']:
+        if run.get('error_occurred'):
+            continue
+        if run['name'].endswith(AGGREGATE_SUFFIXES):
+            continue
+        if args.metric not in run:
+            continue
+        scale = TIME_UNITS[run.get('time_unit', 'ns')]
+        times[run['name']] = run[args.metric] * scale
+    return times
+
+
+def format_time(seconds):
+    for unit, scale in (('s', 1.0), ('ms', 1e-3), ('us', 1e-6)):
+        if seconds >= scale:
+            return '%.3f %s' % (seconds / scale, unit)
+    return '%.1f ns' % (seconds / 1e-9)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('baseline', help='baseline build directory')
+    parser.add_argument('new', help='build directory to compare')
+    parser.add_argument('benchmarks', nargs='*',
+                        help='benchmark binaries to run (default: all)')
+    parser.add_argument('--filter', default='.',
+                        help='regex of the benchmarks to run in each binary')
+    parser.add_argument('--repetitions', type=int, default=5,
+                        help='number of runs of each build (default: 5)')
+    parser.add_argument('--min-time', type=float,
+                        help='minimum time per benchmark, in seconds')
+    parser.add_argument('--metric', default='cpu_time',
+                        choices=['cpu_time', 'real_time'],
+                        help='which time to compare (default: cpu_time)')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='slowdown in percent to report as a regression '
+                             '(default: 5)')
+    args = parser.parse_args()
+
+    names = args.benchmarks
+    if not names:
+        new_names = set(find_benchmarks(args.new))
+        names = [n for n in find_benchmarks(args.baseline) if n in new_names]
+    if not names:
+        sys.exit('error: no benchmarks found in both build trees')
+
+    regressions = 0
+    print('%-48s %12s %12s %8s' % ('Benchmark', 'Baseline', 'New', 'Change'))
+    for name in names:
+        # Alternate between the builds so that drift in machine load affects
+        # both of them alike.
+        samples = ({}, {})
+        for _ in range(args.repetitions):
+            for build, sample in zip((args.baseline, args.new), samples):
+                for bench, seconds in run_benchmark(build, name, args).items():
+                    sample.setdefault(bench, []).append(seconds)
+
+        base_samples, new_samples = samples
+        for bench in sorted(base_samples):
+            if bench not in new_samples:
+                continue
+            base = statistics.median(base_samples[bench])
+            new = statistics.median(new_samples[bench])
+            change = (new - base) / base * 100 if base else 0.0
+            marker = ''
+            if change > args.threshold:
+                marker = '  REGRESSION'
+                regressions += 1
+            elif change < -args.threshold:
+                marker = '  improvement'
+            print('%-48s %12s %12s %+7.1f%%%s' %
+                  (name + ':' + bench, format_time(base), format_time(new),
+                   change, marker))
+
+    if regressions:
+        print('\n%d benchmark(s) regressed by more than %.1f%%' %
+              (regressions, args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -34,9 +34,14 @@ namespace mlir {
 
 class ModuleOp;
 
-/// A simple object cache following Lang's LLJITWithObjectCache example.
+/// A simple object cache following Lang's LLJITWithObjectCache example. If a
+/// cache directory is provided, objects are also written to it, named after the
+/// identifier of their module, and read back from it by later processes.
 class SimpleObjectCache : public llvm::ObjectCache {
 public:
+  explicit SimpleObjectCache(StringRef cacheDir = "")
+      : cacheDir(cacheDir.str()) {}
+
   void notifyObjectCompiled(const llvm::Module *M,
                             llvm::MemoryBufferRef ObjBuffer) override;
   std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *M) override;
@@ -45,7 +50,18 @@ public:
   void dumpToObjectFile(StringRef filename);
 
 private:
+  /// Returns the path of the object for module `M` in the cache directory.
+  std::string getCachedObjectPath(const llvm::Module *M) const;
+
+  /// Writes the object for module `M` to the cache directory.
+  llvm::Error writeToCacheDir(const llvm::Module *M,
+                              llvm::MemoryBufferRef ObjBuffer);
+
   llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> cachedObjects;
+
+  /// Directory in which objects persist across processes, empty if objects
+  /// are only cached in memory.
+  std::string cacheDir;
 };
 
 /// JIT-backed execution engine for MLIR modules.  Assumes the module can be
@@ -60,7 +76,7 @@ private:
 /// be used to invoke the JIT-compiled function.
 class ExecutionEngine {
 public:
-  ExecutionEngine(bool enableObjectCache);
+  ExecutionEngine(bool enableObjectCache, StringRef objectCacheDir = "");
 
   /// Creates an execution engine for the given module.  If `transformer` is
   /// provided, it will be called on the LLVM module during JIT-compilation and
@@ -68,12 +84,18 @@ public:
   /// when provided, is used as the optimization level for target code
   /// generation. If `sharedLibPaths` are provided, the underlying
   /// JIT-compilation will open and link the shared libraries for symbol
-  /// resolution. If `objectCache` is provided, JIT compiler will use it to
-  /// store the object generated for the given module.
+  /// resolution. If `enableObjectCache` is set, JIT compiler will store the
+  /// object generated for the given module in memory, so that it can be
+  /// dumped with `dumpToObjectFile`. If `objectCacheDir` is provided, the
+  /// object is also stored in that directory, keyed by a hash of the
+  /// transformed LLVM module and of the target configuration, and engines
+  /// created for the same module in later processes load it instead of
+  /// generating code again.
   static llvm::Expected<std::unique_ptr<ExecutionEngine>> create(
       ModuleOp m, std::function<llvm::Error(llvm::Module *)> transformer = {},
       Optional<llvm::CodeGenOpt::Level> jitCodeGenOptLevel = llvm::None,
-      ArrayRef<StringRef> sharedLibPaths = {}, bool enableObjectCache = false);
+      ArrayRef<StringRef> sharedLibPaths = {}, bool enableObjectCache = false,
+      StringRef objectCacheDir = "");
 
   /// Looks up a packed-argument function with the given name and returns a
   /// pointer to it.  Propagates errors in case of failure.
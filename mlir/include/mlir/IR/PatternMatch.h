@@ -448,8 +448,8 @@ private:
   void operator=(const RewritePatternMatcher &) = delete;
 
   /// The group of patterns that are matched for optimization through this
-  /// matcher.
-  std::vector<RewritePattern *> patterns;
+  /// matcher, keyed by the root operation they match and sorted by benefit.
+  DenseMap<OperationName, SmallVector<RewritePattern *, 2>> patterns;
 };
 
 /// Rewrite the regions of the specified operation, which must be isolated from
@@ -225,11 +225,14 @@ public:
   // Pass Timing
 
   /// Add an instrumentation to time the execution of passes and the computation
-  /// of analyses.
+  /// of analyses. If 'displayThreads' is true, the report also shows the time
+  /// each thread spent in the pipelines of every parallel pass adaptor, which
+  /// helps finding operations that hold up the other threads.
   /// Note: Timing should be enabled after all other instrumentations to avoid
   /// any potential "ghost" timing from other instrumentations being
   /// unintentionally included in the timing results.
-  void enableTiming(PassDisplayMode displayMode = PassDisplayMode::Pipeline);
+  void enableTiming(PassDisplayMode displayMode = PassDisplayMode::Pipeline,
+                    bool displayThreads = false);
 
   /// Prompts the pass manager to print the statistics collected for each of the
   /// held passes after each call to 'run'.
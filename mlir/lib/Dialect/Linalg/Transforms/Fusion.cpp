@@ -530,6 +530,12 @@ struct FuseGenericTensorOps : public OpRewritePattern<GenericOp> {
       if (!fusedOp)
         continue;
       rewriter.replaceOp(op, fusedOp.getValue().getOperation()->getResults());
+      // A generic op on tensors has no side effects, but isn't marked as such
+      // because the same op on buffers does. Erase the producer once it has
+      // been fused into all its consumers, so that the intermediate tensor is
+      // never materialized.
+      if (definingOp.getOperation()->use_empty())
+        rewriter.eraseOp(definingOp);
       return matchSuccess();
     }
     return matchFailure();
@@ -16,6 +16,7 @@
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Target/LLVMIR.h"
 
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
@@ -30,6 +31,9 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/ToolOutputFile.h"
 
@@ -65,10 +69,57 @@ void SimpleObjectCache::notifyObjectCompiled(const Module *M,
                                              MemoryBufferRef ObjBuffer) {
   cachedObjects[M->getModuleIdentifier()] = MemoryBuffer::getMemBufferCopy(
       ObjBuffer.getBuffer(), ObjBuffer.getBufferIdentifier());
+
+  // The cache directory only saves later processes some work, so failing to
+  // write to it is not an error.
+  if (cacheDir.empty())
+    return;
+  if (Error err = writeToCacheDir(M, ObjBuffer))
+    errs() << "Could not cache object in " << cacheDir << ": "
+           << llvm::toString(std::move(err)) << "\n";
+}
+
+std::string SimpleObjectCache::getCachedObjectPath(const Module *M) const {
+  SmallString<128> path(cacheDir);
+  llvm::sys::path::append(path, M->getModuleIdentifier() + ".o");
+  return std::string(path.str());
+}
+
+Error SimpleObjectCache::writeToCacheDir(const Module *M,
+                                         MemoryBufferRef ObjBuffer) {
+  if (std::error_code ec = llvm::sys::fs::create_directories(cacheDir))
+    return llvm::errorCodeToError(ec);
+
+  // Write to a temporary file and rename it, so that other processes sharing
+  // the directory never read a partially written object.
+  std::string path = getCachedObjectPath(M);
+  auto temp = llvm::sys::fs::TempFile::create(path + ".tmp%%%%%%");
+  if (!temp)
+    return temp.takeError();
+  llvm::raw_fd_ostream os(temp->FD, /*shouldClose=*/false);
+  os << ObjBuffer.getBuffer();
+  os.flush();
+  if (os.has_error()) {
+    os.clear_error();
+    consumeError(temp->discard());
+    return make_string_error("could not write " + temp->TmpName);
+  }
+  return temp->keep(path);
 }
 
 std::unique_ptr<MemoryBuffer> SimpleObjectCache::getObject(const Module *M) {
   auto I = cachedObjects.find(M->getModuleIdentifier());
+  if (I == cachedObjects.end() && !cacheDir.empty()) {
+    // Fall back to an object written by an earlier process.
+    auto object = MemoryBuffer::getFile(getCachedObjectPath(M), /*FileSize=*/-1,
+                                        /*RequiresNullTerminator=*/false);
+    if (object) {
+      LLVM_DEBUG(dbgs() << "Object for " << M->getModuleIdentifier()
+                        << " read from " << cacheDir << ".\n");
+      I = cachedObjects.try_emplace(M->getModuleIdentifier(), std::move(*object))
+              .first;
+    }
+  }
   if (I == cachedObjects.end()) {
     LLVM_DEBUG(dbgs() << "No object for " << M->getModuleIdentifier()
                       << " in cache. Compiling.\n");
@@ -96,6 +147,10 @@ void SimpleObjectCache::dumpToObjectFile(StringRef outputFilename) {
 }
 
 void ExecutionEngine::dumpToObjectFile(StringRef filename) {
+  if (!cache) {
+    errs() << "cannot dump object code to file: object cache is disabled\n";
+    return;
+  }
   cache->dumpToObjectFile(filename);
 }
 
@@ -182,15 +237,36 @@ static void packFunctionArguments(Module *module) {
   }
 }
 
-ExecutionEngine::ExecutionEngine(bool enableObjectCache)
-    : cache(enableObjectCache ? nullptr : new SimpleObjectCache()),
+// Returns the key of the object compiled from `module` in an object cache
+// directory. Besides the module itself, the object depends on the target
+// configuration the code is generated for.
+static std::string getObjectCacheKey(const Module &module,
+                                     StringRef targetConfig) {
+  SmallVector<char, 0> buffer;
+  {
+    llvm::raw_svector_ostream os(buffer);
+    WriteBitcodeToFile(module, os);
+  }
+  llvm::SHA1 hasher;
+  hasher.update(StringRef(buffer.data(), buffer.size()));
+  hasher.update(targetConfig);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+ExecutionEngine::ExecutionEngine(bool enableObjectCache,
+                                 StringRef objectCacheDir)
+    : cache(enableObjectCache || !objectCacheDir.empty()
+                ? new SimpleObjectCache(objectCacheDir)
+                : nullptr),
       gdbListener(llvm::JITEventListener::createGDBRegistrationListener()) {}
 
 Expected<std::unique_ptr<ExecutionEngine>> ExecutionEngine::create(
     ModuleOp m, std::function<Error(llvm::Module *)> transformer,
     Optional<llvm::CodeGenOpt::Level> jitCodeGenOptLevel,
-    ArrayRef<StringRef> sharedLibPaths, bool enableObjectCache) {
-  auto engine = std::make_unique<ExecutionEngine>(enableObjectCache);
+    ArrayRef<StringRef> sharedLibPaths, bool enableObjectCache,
+    StringRef objectCacheDir) {
+  auto engine =
+      std::make_unique<ExecutionEngine>(enableObjectCache, objectCacheDir);
 
   std::unique_ptr<llvm::LLVMContext> ctx(new llvm::LLVMContext);
   auto llvmModule = translateModuleToLLVMIR(m);
@@ -265,6 +341,7 @@ Expected<std::unique_ptr<ExecutionEngine>> ExecutionEngine::create(
 
   // Callback to inspect the cache and recompile on demand. This follows Lang's
   // LLJITWithObjectCache example.
+  std::string targetConfig;
   auto compileFunctionCreator = [&](JITTargetMachineBuilder JTMB)
       -> Expected<std::unique_ptr<IRCompileLayer::IRCompiler>> {
     if (jitCodeGenOptLevel)
@@ -272,6 +349,9 @@ Expected<std::unique_ptr<ExecutionEngine>> ExecutionEngine::create(
     auto TM = JTMB.createTargetMachine();
     if (!TM)
       return TM.takeError();
+    llvm::raw_string_ostream(targetConfig)
+        << (*TM)->getTargetTriple().str() << ' ' << (*TM)->getTargetCPU() << ' '
+        << (*TM)->getTargetFeatureString() << ' ' << (*TM)->getOptLevel();
     return std::make_unique<TMOwningSimpleCompiler>(std::move(*TM),
                                                     engine->cache.get());
   };
@@ -288,6 +368,13 @@ Expected<std::unique_ptr<ExecutionEngine>> ExecutionEngine::create(
   if (transformer)
     cantFail(tsm.withModuleDo(
         [&](llvm::Module &module) { return transformer(&module); }));
+
+  // Objects in the cache directory are looked up by module identifier, so
+  // name the module after what its object is compiled from.
+  if (!objectCacheDir.empty())
+    tsm.withModuleDo([&](llvm::Module &module) {
+      module.setModuleIdentifier(getObjectCacheKey(module, targetConfig));
+    });
   cantFail(jit->addIRModule(std::move(tsm)));
   engine->jit = std::move(jit);
 
@@ -170,25 +170,28 @@ void PatternRewriter::cloneRegionBefore(Region &region, Block *before) {
 
 RewritePatternMatcher::RewritePatternMatcher(
     const OwningRewritePatternList &patterns) {
+  // Group the patterns by their root operation, dropping the ones that can
+  // never match, so that matching an operation only visits its own patterns.
   for (auto &pattern : patterns)
-    this->patterns.push_back(pattern.get());
+    if (!pattern->getBenefit().isImpossibleToMatch())
+      this->patterns[pattern->getRootKind()].push_back(pattern.get());
 
   // Sort the patterns by benefit to simplify the matching logic.
-  std::stable_sort(this->patterns.begin(), this->patterns.end(),
-                   [](RewritePattern *l, RewritePattern *r) {
-                     return r->getBenefit() < l->getBenefit();
-                   });
+  for (auto &it : this->patterns)
+    std::stable_sort(it.second.begin(), it.second.end(),
+                     [](RewritePattern *l, RewritePattern *r) {
+                       return r->getBenefit() < l->getBenefit();
+                     });
 }
 
 /// Try to match the given operation to a pattern and rewrite it.
 bool RewritePatternMatcher::matchAndRewrite(Operation *op,
                                             PatternRewriter &rewriter) {
-  for (auto *pattern : patterns) {
-    // Ignore patterns that are for the wrong root or are impossible to match.
-    if (pattern->getRootKind() != op->getName() ||
-        pattern->getBenefit().isImpossibleToMatch())
-      continue;
+  auto it = patterns.find(op->getName());
+  if (it == patterns.end())
+    return false;
 
+  for (auto *pattern : it->second) {
     // Try to match and rewrite this pattern. The patterns are sorted by
     // benefit, so if we match we can immediately rewrite and return.
     if (pattern->matchAndRewrite(op, rewriter))
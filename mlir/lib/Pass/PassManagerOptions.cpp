@@ -74,6 +74,10 @@ struct PassManagerOptions {
                      "display the results in a list sorted by total time"),
           clEnumValN(PassDisplayMode::Pipeline, "pipeline",
                      "display the results with a nested pipeline view"))};
+  llvm::cl::opt<bool> passTimingThreads{
+      "pass-timing-threads",
+      llvm::cl::desc("Also display the time each thread spent in the pipelines "
+                     "of parallel pass adaptors")};
 
   //===--------------------------------------------------------------------===//
   // Pass Statistics
@@ -141,7 +145,7 @@ void PassManagerOptions::addPrinterInstrumentation(PassManager &pm) {
 /// Add a pass timing instrumentation if enabled by 'pass-timing' flags.
 void PassManagerOptions::addTimingInstrumentation(PassManager &pm) {
   if (passTiming)
-    pm.enableTiming(passTimingDisplayMode);
+    pm.enableTiming(passTimingDisplayMode, passTimingThreads);
 }
 
 void mlir::registerPassManagerCLOptions() {
@@ -159,8 +159,16 @@ struct Timer {
   TimerKind kind;
 };
 
+/// The time a single thread spent running the pipelines of a parallel pass
+/// adaptor.
+struct ThreadRecord {
+  TimeRecord time;
+  unsigned numPipelines = 0;
+};
+
 struct PassTiming : public PassInstrumentation {
-  PassTiming(PassDisplayMode displayMode) : displayMode(displayMode) {}
+  PassTiming(PassDisplayMode displayMode, bool displayThreads)
+      : displayMode(displayMode), displayThreads(displayThreads) {}
   ~PassTiming() override { print(); }
 
   /// Setup the instrumentation hooks.
@@ -202,6 +210,10 @@ struct PassTiming : public PassInstrumentation {
   void printResultsAsPipeline(raw_ostream &os, Timer *root,
                               TimeRecord totalTime);
 
+  /// Print the time each thread spent in the pipelines of each parallel
+  /// adaptor.
+  void printThreadResults(raw_ostream &os, TimeRecord totalTime);
+
   /// Returns a timer for the provided identifier and name.
   Timer *getTimer(const void *id, TimerKind kind,
                   std::function<std::string()> &&nameBuilder) {
@@ -234,6 +246,15 @@ struct PassTiming : public PassInstrumentation {
   /// The display mode to use when printing the timing results.
   PassDisplayMode displayMode;
 
+  /// Whether to also print the time spent by each thread in the pipelines of
+  /// parallel adaptors. The merged report only shows the slowest thread, which
+  /// hides how evenly the work was spread.
+  bool displayThreads;
+
+  /// The per-thread pipeline times of each parallel adaptor, recorded before
+  /// the pipeline timers are merged into the parent thread.
+  llvm::MapVector<Pass *, llvm::MapVector<uint64_t, ThreadRecord>> threadTimes;
+
   /// A mapping of pipeline timers that need to be merged into the parent
   /// collection. The timers are mapped to the parent info to merge into.
   DenseMap<PipelineParentInfo, SmallVector<Timer::ChildrenMap::value_type, 4>>
@@ -255,13 +276,21 @@ void PassTiming::runAfterPipeline(const OperationName &name,
   auto tid = llvm::get_threadid();
   auto &activeTimers = activeThreadTimers[tid];
   assert(!activeTimers.empty() && "expected active timer");
-  activeTimers.pop_back();
+  Timer *pipelineTimer = activeTimers.pop_back_val();
 
   // If the current thread is the same as the parent, there is nothing left to
   // do.
   if (tid == parentInfo.parentThreadID)
     return;
 
+  // A pipeline on another thread has a fresh timer for each run, so its total
+  // is the time of this run alone.
+  if (displayThreads) {
+    ThreadRecord &record = threadTimes[parentInfo.parentPass][tid];
+    record.time += pipelineTimer->getTotalTime();
+    ++record.numPipelines;
+  }
+
   // Otherwise, mark the pipeline timer for merging into the correct parent
   // thread.
   assert(activeTimers.empty() && "expected parent timer to be root");
@@ -370,11 +399,14 @@ void PassTiming::print() {
     break;
   }
   printTimeEntry(*os, 0, "Total", totalTime, totalTime);
+  if (displayThreads)
+    printThreadResults(*os, totalTime);
   os->flush();
 
   // Reset root timers.
   rootTimers.clear();
   activeThreadTimers.clear();
+  threadTimes.clear();
 }
 
 /// Print the timing result in list mode.
@@ -449,16 +481,46 @@ void PassTiming::printResultsAsPipeline(raw_ostream &os, Timer *root,
     printTimer(0, topLevelTimer.second.get());
 }
 
+/// Print the time each thread spent in the pipelines of each parallel adaptor.
+void PassTiming::printThreadResults(raw_ostream &os, TimeRecord totalTime) {
+  if (threadTimes.empty())
+    return;
+
+  os << "\n  --- Per-thread Pipeline Time ---\n";
+  for (auto &adaptorIt : threadTimes) {
+    TimeRecord adaptorTime;
+    for (auto &threadIt : adaptorIt.second)
+      adaptorTime += threadIt.second.time;
+    printTimeEntry(os, 0, getAdaptorPassBase(adaptorIt.first)->getName(),
+                   adaptorTime, totalTime);
+
+    // Sort the threads by wall time, so that stragglers come first.
+    std::vector<std::pair<uint64_t, ThreadRecord>> threads(
+        adaptorIt.second.begin(), adaptorIt.second.end());
+    llvm::sort(threads, [](const std::pair<uint64_t, ThreadRecord> &lhs,
+                           const std::pair<uint64_t, ThreadRecord> &rhs) {
+      return lhs.second.time.wall > rhs.second.time.wall;
+    });
+    for (auto &threadIt : threads)
+      printTimeEntry(os, 2,
+                     llvm::formatv("Thread {0} ({1} pipelines)", threadIt.first,
+                                   threadIt.second.numPipelines)
+                         .str(),
+                     threadIt.second.time, totalTime);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // PassManager
 //===----------------------------------------------------------------------===//
 
 /// Add an instrumentation to time the execution of passes and the computation
 /// of analyses.
-void PassManager::enableTiming(PassDisplayMode displayMode) {
+void PassManager::enableTiming(PassDisplayMode displayMode,
+                               bool displayThreads) {
   // Check if pass timing is already enabled.
   if (passTiming)
     return;
-  addInstrumentation(std::make_unique<PassTiming>(displayMode));
+  addInstrumentation(std::make_unique<PassTiming>(displayMode, displayThreads));
   passTiming = true;
 }
@@ -92,6 +92,11 @@ static llvm::cl::opt<std::string> objectFilename(
     "object-filename",
     llvm::cl::desc("Dump JITted-compiled object to file <input file>.o"));
 
+static llvm::cl::opt<std::string> objectCacheDir(
+    "object-cache-dir",
+    llvm::cl::desc("Directory in which to cache JIT-compiled objects across "
+                   "runs"));
+
 static OwningModuleRef parseMLIRInput(StringRef inputFilename,
                                       MLIRContext *context) {
   // Set up the input file.
@@ -144,8 +149,9 @@ compileAndExecute(ModuleOp module, StringRef entryPoint,
     jitCodeGenOptLevel =
         static_cast<llvm::CodeGenOpt::Level>(clOptLevel.getValue());
   SmallVector<StringRef, 4> libs(clSharedLibs.begin(), clSharedLibs.end());
-  auto expectedEngine = mlir::ExecutionEngine::create(module, transformer,
-                                                      jitCodeGenOptLevel, libs);
+  auto expectedEngine = mlir::ExecutionEngine::create(
+      module, transformer, jitCodeGenOptLevel, libs, dumpObjectFile,
+      objectCacheDir);
   if (!expectedEngine)
     return expectedEngine.takeError();
 
@@ -11,6 +11,9 @@
 #include "mlir/Support/LLVM.h"
 #include "llvm/Support/RWMutex.h"
 
+#include <array>
+#include <climits>
+
 using namespace mlir;
 using namespace mlir::detail;
 
@@ -46,27 +49,28 @@ struct StorageUniquerImpl {
               function_ref<bool(const BaseStorage *)> isEqual,
               function_ref<BaseStorage *(StorageAllocator &)> ctorFn) {
     LookupKey lookupKey{kind, hashValue, isEqual};
+    StorageShard &shard = getShard(hashValue);
 
     // Check for an existing instance in read-only mode.
     {
-      llvm::sys::SmartScopedReader<true> typeLock(mutex);
-      auto it = storageTypes.find_as(lookupKey);
-      if (it != storageTypes.end())
+      llvm::sys::SmartScopedReader<true> typeLock(shard.mutex);
+      auto it = shard.storageTypes.find_as(lookupKey);
+      if (it != shard.storageTypes.end())
         return it->storage;
     }
 
     // Acquire a writer-lock so that we can safely create the new type instance.
-    llvm::sys::SmartScopedWriter<true> typeLock(mutex);
+    llvm::sys::SmartScopedWriter<true> typeLock(shard.mutex);
 
     // Check for an existing instance again here, because another writer thread
     // may have already created one.
-    auto existing = storageTypes.insert_as({}, lookupKey);
+    auto existing = shard.storageTypes.insert_as({}, lookupKey);
     if (!existing.second)
       return existing.first->storage;
 
     // Otherwise, construct and initialize the derived storage for this type
     // instance.
-    BaseStorage *storage = initializeStorage(kind, ctorFn);
+    BaseStorage *storage = initializeStorage(kind, shard.allocator, ctorFn);
     *existing.first = HashedStorage{hashValue, storage};
     return storage;
   }
@@ -93,7 +97,7 @@ struct StorageUniquerImpl {
       return result;
 
     // Otherwise, create and return a new storage instance.
-    return result = initializeStorage(kind, ctorFn);
+    return result = initializeStorage(kind, allocator, ctorFn);
   }
 
   /// Erase an instance of a complex derived type.
@@ -103,14 +107,15 @@ struct StorageUniquerImpl {
     LookupKey lookupKey{kind, hashValue, isEqual};
 
     // Acquire a writer-lock so that we can safely erase the type instance.
-    llvm::sys::SmartScopedWriter<true> typeLock(mutex);
-    auto existing = storageTypes.find_as(lookupKey);
-    if (existing == storageTypes.end())
+    StorageShard &shard = getShard(hashValue);
+    llvm::sys::SmartScopedWriter<true> typeLock(shard.mutex);
+    auto existing = shard.storageTypes.find_as(lookupKey);
+    if (existing == shard.storageTypes.end())
       return;
 
     // Cleanup the storage and remove it from the map.
     cleanupFn(existing->storage);
-    storageTypes.erase(existing);
+    shard.storageTypes.erase(existing);
   }
 
   //===--------------------------------------------------------------------===//
@@ -119,7 +124,7 @@ struct StorageUniquerImpl {
 
   /// Utility to create and initialize a storage instance.
   BaseStorage *
-  initializeStorage(unsigned kind,
+  initializeStorage(unsigned kind, StorageAllocator &allocator,
                     function_ref<BaseStorage *(StorageAllocator &)> ctorFn) {
     BaseStorage *storage = ctorFn(allocator);
     storage->kind = kind;
@@ -154,15 +159,34 @@ struct StorageUniquerImpl {
 
   // Unique types with specific hashing or storage constraints.
   using StorageTypeSet = DenseSet<HashedStorage, StorageKeyInfo>;
-  StorageTypeSet storageTypes;
+
+  /// A shard of the complex storage instances. Each shard has its own lock
+  /// and allocator, so that threads uniquing different instances at the same
+  /// time rarely contend with each other.
+  struct StorageShard {
+    StorageTypeSet storageTypes;
+    StorageAllocator allocator;
+    llvm::sys::SmartRWMutex<true> mutex;
+  };
+
+  /// The number of shards, which must be a power of two.
+  static constexpr unsigned numShardBits = 5;
+
+  /// Return the shard holding instances with the given hash value. This uses
+  /// the top bits of the hash, as the storage sets bucket on the low bits.
+  StorageShard &getShard(unsigned hashValue) {
+    return shards[hashValue >> (sizeof(unsigned) * CHAR_BIT - numShardBits)];
+  }
+
+  std::array<StorageShard, 1 << numShardBits> shards;
 
   // Unique types with just the kind.
   DenseMap<unsigned, BaseStorage *> simpleTypes;
 
-  // Allocator to use when constructing derived type instances.
+  // Allocator to use when constructing simple derived type instances.
   StorageUniquer::StorageAllocator allocator;
 
-  // A mutex to keep type uniquing thread-safe.
+  // A mutex to keep simple type uniquing thread-safe.
   llvm::sys::SmartRWMutex<true> mutex;
 };
 } // end namespace detail
@@ -68,6 +68,15 @@ static llvm::cl::opt<unsigned long long> clFusionLocalBufThreshold(
                    "memory space"),
     llvm::cl::cat(clOptionsCategory));
 
+// Bounds the compile time of fusion on large functions. Each candidate is
+// checked for feasibility and profitability by computing slice unions at every
+// candidate loop depth, which is the dominant cost of the pass.
+static llvm::cl::opt<unsigned> clFusionMaxCandidates(
+    "fusion-max-candidates",
+    llvm::cl::desc("Maximum number of fusion candidates to evaluate per "
+                   "function (0 means no limit)"),
+    llvm::cl::init(0), llvm::cl::cat(clOptionsCategory));
+
 namespace {
 
 /// Loop fusion pass. This pass currently supports a greedy fusion policy,
@@ -1428,6 +1437,8 @@ public:
   // If true, ignore any additional (redundant) computation tolerance threshold
   // that would have prevented fusion.
   bool maximalFusion;
+  // Number of fusion candidates evaluated so far.
+  unsigned numCandidatesEvaluated = 0;
 
   using Node = MemRefDependenceGraph::Node;
 
@@ -1449,6 +1460,24 @@ public:
     }
   }
 
+  // Returns true if the budget of fusion candidates has been used up, in which
+  // case no further candidates should be evaluated.
+  bool isCandidateBudgetExhausted() const {
+    return clFusionMaxCandidates != 0 &&
+           numCandidatesEvaluated >= clFusionMaxCandidates;
+  }
+
+  // Counts a fusion candidate against the budget. Returns false, without
+  // counting it, if the budget has been used up.
+  bool takeCandidateFromBudget() {
+    if (isCandidateBudgetExhausted()) {
+      LLVM_DEBUG(llvm::dbgs() << "Fusion candidate budget reached\n");
+      return false;
+    }
+    ++numCandidatesEvaluated;
+    return true;
+  }
+
   // Run the GreedyFusion pass.
   // *) First pass through the nodes fuses single-use producer nodes into their
   //    unique consumer.
@@ -1465,7 +1494,7 @@ public:
 
   void fuseProducerConsumerNodes(unsigned maxSrcUserCount) {
     init();
-    while (!worklist.empty()) {
+    while (!worklist.empty() && !isCandidateBudgetExhausted()) {
       unsigned dstId = worklist.back();
       worklist.pop_back();
       worklistSet.erase(dstId);
@@ -1511,6 +1540,9 @@ public:
           // Skip if this node was removed (fused into another node).
           if (mdg->nodes.count(srcId) == 0)
             continue;
+          // Stop once the budget of candidates to evaluate is used up.
+          if (!takeCandidateFromBudget())
+            return;
           // Get 'srcNode' from which to attempt fusion into 'dstNode'.
           auto *srcNode = mdg->getNode(srcId);
           // Skip if 'srcNode' is not a loop nest.
@@ -1707,7 +1739,7 @@ public:
   // its sibling nodes (nodes which share a parent, but no dependence edges).
   void fuseSiblingNodes() {
     init();
-    while (!worklist.empty()) {
+    while (!worklist.empty() && !isCandidateBudgetExhausted()) {
       unsigned dstId = worklist.back();
       worklist.pop_back();
       worklistSet.erase(dstId);
@@ -1730,6 +1762,9 @@ public:
     DenseSet<unsigned> visitedSibNodeIds;
     std::pair<unsigned, Value> idAndMemref;
     while (findSiblingNodeToFuse(dstNode, &visitedSibNodeIds, &idAndMemref)) {
+      // Stop once the budget of candidates to evaluate is used up.
+      if (!takeCandidateFromBudget())
+        return;
       unsigned sibId = idAndMemref.first;
       Value memref = idAndMemref.second;
       // TODO(andydavis) Check that 'sibStoreOpInst' post-dominates all other
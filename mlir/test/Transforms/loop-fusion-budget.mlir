@@ -0,0 +1,37 @@
+// RUN: mlir-opt %s -affine-loop-fusion | FileCheck %s
+// RUN: mlir-opt %s -affine-loop-fusion -fusion-max-candidates=1 | FileCheck %s --check-prefix=BUDGET
+
+// Two independent producer-consumer pairs. Without a budget both are fused
+// into loops over private buffers. With a budget of one candidate only one
+// of them is fused, and the pass stops looking for more.
+
+// CHECK-LABEL: func @two_producer_consumer_pairs
+// CHECK-COUNT-2: alloc() : memref<1xf32>
+// CHECK-NOT:     alloc() : memref<1xf32>
+// CHECK:         return
+
+// BUDGET-LABEL: func @two_producer_consumer_pairs
+// BUDGET:       alloc() : memref<1xf32>
+// BUDGET-NOT:   alloc() : memref<1xf32>
+// BUDGET:       affine.store %{{.*}}, %{{.*}}[%{{.*}}] : memref<10xf32>
+// BUDGET:       affine.load %{{.*}}[%{{.*}}] : memref<10xf32>
+// BUDGET:       return
+func @two_producer_consumer_pairs() {
+  %a = alloc() : memref<10xf32>
+  %b = alloc() : memref<10xf32>
+  %cf7 = constant 7.0 : f32
+
+  affine.for %i0 = 0 to 10 {
+    affine.store %cf7, %a[%i0] : memref<10xf32>
+  }
+  affine.for %i1 = 0 to 10 {
+    %v0 = affine.load %a[%i1] : memref<10xf32>
+  }
+  affine.for %i2 = 0 to 10 {
+    affine.store %cf7, %b[%i2] : memref<10xf32>
+  }
+  affine.for %i3 = 0 to 10 {
+    %v1 = affine.load %b[%i3] : memref<10xf32>
+  }
+  return
+}
@@ -0,0 +1,30 @@
+// REQUIRES: asserts
+// RUN: rm -rf %t.cache
+// RUN: mlir-cpu-runner %s -object-cache-dir=%t.cache -debug-only=execution-engine 2>&1 | FileCheck %s --check-prefix=MISS
+// RUN: ls %t.cache | count 1
+
+// A later run reads the object from the directory instead of compiling.
+// RUN: mlir-cpu-runner %s -object-cache-dir=%t.cache -debug-only=execution-engine 2>&1 | FileCheck %s --check-prefix=HIT
+// RUN: ls %t.cache | count 1
+
+// A different optimization level gives a different object.
+// RUN: mlir-cpu-runner %s -O3 -object-cache-dir=%t.cache | FileCheck %s
+// RUN: ls %t.cache | count 2
+
+// MISS: No object for {{[0-9a-f]+}} in cache. Compiling.
+// MISS: 4.200000e+02
+
+// HIT-NOT: Compiling.
+// HIT: Object for {{[0-9a-f]+}} read from {{.*}}.cache.
+// HIT: Object for {{[0-9a-f]+}} loaded from cache.
+// HIT-NOT: Compiling.
+// HIT: 4.200000e+02
+
+llvm.func @fabsf(!llvm.float) -> !llvm.float
+
+llvm.func @main() -> !llvm.float {
+  %0 = llvm.mlir.constant(-4.200000e+02 : f32) : !llvm.float
+  %1 = llvm.call @fabsf(%0) : (!llvm.float) -> !llvm.float
+  llvm.return %1 : !llvm.float
+}
+// CHECK: 4.200000e+02
@@ -0,0 +1,202 @@
+//===-- memory_pool.h - Caching device memory pool -------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Size-class caching pool for device memory, shared by the target plugins.
+// Must be included in the plugin source file AFTER omptarget.h has been
+// included and macro DP(...) has been defined.
+//
+// Requests up to a threshold are rounded up to a power of two and, when
+// released, kept on a per-class free list instead of being returned to the
+// device. A later request of the same class reuses the cached block without
+// calling into the device driver. The total number of cached bytes is capped;
+// blocks that would exceed the cap, and requests larger than the threshold,
+// go straight to the device allocator.
+//
+// The pool does not synchronize with the device. A plugin may only use it if
+// a block handed to release() is no longer accessed by any pending device
+// work, e.g. because kernel launches and copies are synchronous.
+//
+//===----------------------------------------------------------------------===//
+
+#if !(defined(_OMPTARGET_H_) && defined(DP))
+#error Include memory_pool.h in the plugin source AFTER omptarget.h has been\
+ included and macro DP(...) has been defined.
+#endif
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/// Interface to the device allocator backing a memory pool. Both functions
+/// are called with the device context current. Blocks up to the pool
+/// threshold are allocated and freed with the pool lock held, but larger
+/// blocks are not, so the implementation must be safe to call concurrently.
+class DeviceAllocatorTy {
+public:
+  virtual ~DeviceAllocatorTy() {}
+
+  /// Allocate \p Size bytes of device memory, return nullptr on failure.
+  virtual void *allocate(size_t Size) = 0;
+
+  /// Return \p Ptr to the device, return OFFLOAD_SUCCESS or OFFLOAD_FAIL.
+  virtual int free(void *Ptr) = 0;
+};
+
+/// Caching allocator on top of a DeviceAllocatorTy.
+class MemoryPoolTy {
+  /// Smallest size class; smaller requests are rounded up to it.
+  static const size_t MinBlockSizeLog2 = 8; // 256 bytes
+
+  DeviceAllocatorTy &Allocator;
+
+  /// Requests larger than this bypass the pool. Zero disables the pool.
+  size_t Threshold;
+
+  /// Maximum number of bytes kept on the free lists.
+  size_t CacheLimit;
+
+  /// Bytes currently kept on the free lists.
+  size_t CachedBytes = 0;
+
+  /// Free blocks, indexed by log2 of their size minus MinBlockSizeLog2.
+  std::vector<std::vector<void *>> FreeLists;
+
+  /// Size class of every live block that was allocated through the pool.
+  std::unordered_map<void *, unsigned> LiveBlocks;
+
+  std::mutex Mtx;
+
+  static unsigned getSizeClass(size_t Size) {
+    unsigned Log2 = MinBlockSizeLog2;
+    while ((size_t(1) << Log2) < Size)
+      ++Log2;
+    return Log2 - MinBlockSizeLog2;
+  }
+
+  static size_t getClassSize(unsigned Class) {
+    return size_t(1) << (Class + MinBlockSizeLog2);
+  }
+
+  /// Return the size in environment variable \p Name, or \p Default if it
+  /// is not set or is not a valid size.
+  static size_t getEnvSize(const char *Name, size_t Default) {
+    const char *EnvStr = getenv(Name);
+    if (!EnvStr)
+      return Default;
+
+    // strtoull skips leading white space and silently negates values with a
+    // minus sign, so only accept strings starting with a digit.
+    char *End = nullptr;
+    unsigned long long Value = 0;
+    errno = 0;
+    if (isdigit(static_cast<unsigned char>(*EnvStr)))
+      Value = strtoull(EnvStr, &End, 10);
+    if (!End || *End || errno == ERANGE || Value > SIZE_MAX) {
+      DP("Ignoring invalid %s=%s, using %zu\n", Name, EnvStr, Default);
+      return Default;
+    }
+    DP("Parsed %s=%zu\n", Name, size_t(Value));
+    return Value;
+  }
+
+  /// Return every cached block to the device. Requires the lock to be held.
+  void releaseCached() {
+    for (auto &List : FreeLists) {
+      for (void *Ptr : List)
+        if (Allocator.free(Ptr) != OFFLOAD_SUCCESS)
+          DP("Error when returning cached block " DPxMOD " to the device\n",
+             DPxPTR(Ptr));
+      List.clear();
+    }
+    CachedBytes = 0;
+  }
+
+public:
+  /// Create a pool on top of \p Allocator. The limits default to
+  /// \p DefaultThreshold and \p DefaultCacheLimit bytes and may be overridden
+  /// with LIBOMPTARGET_MEMORY_POOL_THRESHOLD and
+  /// LIBOMPTARGET_MEMORY_POOL_LIMIT.
+  MemoryPoolTy(DeviceAllocatorTy &Allocator, size_t DefaultThreshold,
+               size_t DefaultCacheLimit)
+      : Allocator(Allocator) {
+    Threshold =
+        getEnvSize("LIBOMPTARGET_MEMORY_POOL_THRESHOLD", DefaultThreshold);
+    CacheLimit =
+        getEnvSize("LIBOMPTARGET_MEMORY_POOL_LIMIT", DefaultCacheLimit);
+    if (Threshold)
+      FreeLists.resize(getSizeClass(Threshold) + 1);
+  }
+
+  MemoryPoolTy(const MemoryPoolTy &) = delete;
+  MemoryPoolTy &operator=(const MemoryPoolTy &) = delete;
+
+  /// Allocate \p Size bytes, reusing a cached block if one is available.
+  void *allocate(size_t Size) {
+    // A zero threshold disables the pool, and there are no free lists.
+    if (!Threshold || Size > Threshold)
+      return Allocator.allocate(Size);
+
+    unsigned Class = getSizeClass(Size);
+    std::lock_guard<std::mutex> LG(Mtx);
+
+    auto &List = FreeLists[Class];
+    void *Ptr;
+    if (!List.empty()) {
+      Ptr = List.back();
+      List.pop_back();
+      CachedBytes -= getClassSize(Class);
+    } else {
+      Ptr = Allocator.allocate(getClassSize(Class));
+      if (!Ptr && CachedBytes) {
+        // The device may be out of memory because of cached blocks of other
+        // sizes; hand those back and try once more.
+        DP("Device allocation failed, releasing %zu cached bytes\n",
+           CachedBytes);
+        releaseCached();
+        Ptr = Allocator.allocate(getClassSize(Class));
+      }
+      if (!Ptr)
+        return nullptr;
+    }
+
+    LiveBlocks[Ptr] = Class;
+    return Ptr;
+  }
+
+  /// Release \p Ptr, keeping it cached if the pool limit allows.
+  int release(void *Ptr) {
+    std::unique_lock<std::mutex> LG(Mtx);
+    auto It = LiveBlocks.find(Ptr);
+    if (It == LiveBlocks.end()) {
+      // Not a pooled block, it was larger than the threshold.
+      LG.unlock();
+      return Allocator.free(Ptr);
+    }
+
+    unsigned Class = It->second;
+    LiveBlocks.erase(It);
+
+    size_t ClassSize = getClassSize(Class);
+    if (CachedBytes + ClassSize > CacheLimit)
+      return Allocator.free(Ptr);
+
+    FreeLists[Class].push_back(Ptr);
+    CachedBytes += ClassSize;
+    return OFFLOAD_SUCCESS;
+  }
+
+  /// Return all cached blocks to the device. Live blocks are left untouched.
+  void clear() {
+    std::lock_guard<std::mutex> LG(Mtx);
+    releaseCached();
+  }
+};
@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cuda.h>
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -50,6 +51,7 @@ static int DebugLevel = 0;
 #endif // OMPTARGET_DEBUG
 
 #include "../../common/elf_common.c"
+#include "../../common/memory_pool.h"
 
 /// Keep entries table per device.
 struct FuncOrGblEntryTy {
@@ -83,6 +85,32 @@ struct omptarget_device_environmentTy {
   int32_t debug_level;
 };
 
+/// Backing allocator for the device memory pool. The caller makes the
+/// device context current.
+class CUDADeviceAllocatorTy : public DeviceAllocatorTy {
+public:
+  void *allocate(size_t Size) override {
+    CUdeviceptr Ptr;
+    CUresult Err = cuMemAlloc(&Ptr, Size);
+    if (Err != CUDA_SUCCESS) {
+      DP("Error while trying to allocate %d\n", Err);
+      CUDA_ERR_STRING(Err);
+      return nullptr;
+    }
+    return (void *)Ptr;
+  }
+
+  int free(void *Ptr) override {
+    CUresult Err = cuMemFree((CUdeviceptr)Ptr);
+    if (Err != CUDA_SUCCESS) {
+      DP("Error when freeing CUDA memory\n");
+      CUDA_ERR_STRING(Err);
+      return OFFLOAD_FAIL;
+    }
+    return OFFLOAD_SUCCESS;
+  }
+};
+
 /// List that contains all the kernels.
 /// FIXME: we may need this to be per device and per library.
 std::list<KernelTy> KernelsList;
@@ -96,6 +124,12 @@ public:
   std::vector<CUmodule> Modules;
   std::vector<CUcontext> Contexts;
 
+  // Device memory pools, created with the device context. Kernel launches
+  // synchronize with the device, so a mapping freed by the host runtime is
+  // no longer in use and can be cached for the next allocation.
+  CUDADeviceAllocatorTy Allocator;
+  std::vector<std::unique_ptr<MemoryPoolTy>> MemoryPools;
+
   // Device properties
   std::vector<int> ThreadsPerBlock;
   std::vector<int> BlocksPerGrid;
@@ -117,6 +151,8 @@ public:
   static const int HardThreadLimit = 1024;
   static const int DefaultNumTeams = 128;
   static const int DefaultNumThreads = 128;
+  static const size_t DefaultPoolThreshold = 1 << 20;   // 1MB
+  static const size_t DefaultPoolLimit = 256 << 20; // 256MB
 
   // Record entry point associated with device
   void addOffloadEntry(int32_t device_id, __tgt_offload_entry entry) {
@@ -205,6 +241,7 @@ public:
 
     FuncGblEntries.resize(NumberOfDevices);
     Contexts.resize(NumberOfDevices);
+    MemoryPools.resize(NumberOfDevices);
     ThreadsPerBlock.resize(NumberOfDevices);
     BlocksPerGrid.resize(NumberOfDevices);
     WarpSize.resize(NumberOfDevices);
@@ -244,6 +281,11 @@ public:
         }
       }
 
+    // Return cached device memory before the contexts go away
+    for (size_t I = 0; I < MemoryPools.size(); ++I)
+      if (MemoryPools[I] && cuCtxSetCurrent(Contexts[I]) == CUDA_SUCCESS)
+        MemoryPools[I]->clear();
+
     // Destroy contexts
     for (auto &ctx : Contexts)
       if (ctx) {
@@ -294,6 +336,11 @@ int32_t __tgt_rtl_init_device(int32_t device_id) {
     return OFFLOAD_FAIL;
   }
 
+  DeviceInfo.MemoryPools[device_id].reset(
+      new MemoryPoolTy(DeviceInfo.Allocator,
+                       RTLDeviceInfoTy::DefaultPoolThreshold,
+                       RTLDeviceInfoTy::DefaultPoolLimit));
+
   // Query attributes to determine number of threads/block and blocks/grid.
   int maxGridDimX;
   err = cuDeviceGetAttribute(&maxGridDimX, CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_X,
@@ -585,16 +632,7 @@ void *__tgt_rtl_data_alloc(int32_t device_id, int64_t size, void *hst_ptr) {
     return NULL;
   }
 
-  CUdeviceptr ptr;
-  err = cuMemAlloc(&ptr, size);
-  if (err != CUDA_SUCCESS) {
-    DP("Error while trying to allocate %d\n", err);
-    CUDA_ERR_STRING(err);
-    return NULL;
-  }
-
-  void *vptr = (void *)ptr;
-  return vptr;
+  return DeviceInfo.MemoryPools[device_id]->allocate(size);
 }
 
 int32_t __tgt_rtl_data_submit(int32_t device_id, void *tgt_ptr, void *hst_ptr,
@@ -648,13 +686,7 @@ int32_t __tgt_rtl_data_delete(int32_t device_id, void *tgt_ptr) {
     return OFFLOAD_FAIL;
   }
 
-  err = cuMemFree((CUdeviceptr)tgt_ptr);
-  if (err != CUDA_SUCCESS) {
-    DP("Error when freeing CUDA memory\n");
-    CUDA_ERR_STRING(err);
-    return OFFLOAD_FAIL;
-  }
-  return OFFLOAD_SUCCESS;
+  return DeviceInfo.MemoryPools[device_id]->release(tgt_ptr);
 }
 
 int32_t __tgt_rtl_run_target_team_region(int32_t device_id, void *tgt_entry_ptr,
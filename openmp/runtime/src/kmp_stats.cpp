@@ -551,13 +551,17 @@ void kmp_stats_output_module::init() {
   plotFileName = getenv("KMP_STATS_PLOT_FILE");
   char *threadStats = getenv("KMP_STATS_THREADS");
   char *threadEvents = getenv("KMP_STATS_EVENTS");
+  char *traceFile = getenv("KMP_STATS_TRACE_FILE");
 
   // set the stats output filenames based on environment variables and defaults
-  if (statsFileName) {
+  if (statsFileName || traceFile) {
     char imageName[1024];
-    // Process any escapes (e.g., %p, %e, %t) in the name
-    outputFileName = generateFilename(
-        statsFileName, getImageName(&imageName[0], sizeof(imageName)));
+    getImageName(&imageName[0], sizeof(imageName));
+    // Process any escapes (e.g., %p, %e, %t) in the names
+    if (statsFileName)
+      outputFileName = generateFilename(statsFileName, &imageName[0]);
+    if (traceFile)
+      traceFileName = generateFilename(traceFile, &imageName[0]);
   }
   eventsFileName = eventsFileName ? eventsFileName : "events.dat";
   plotFileName = plotFileName ? plotFileName : "events.plt";
@@ -570,7 +574,7 @@ void kmp_stats_output_module::init() {
   if (printPerThreadEventsFlag) {
     // assigns a color to each timer for printing
     setupEventColors();
-  } else {
+  } else if (!tracePrintingEnabled()) {
     // will clear flag so that no event will be logged
     timeStat::clearEventFlags();
   }
@@ -677,6 +681,30 @@ void kmp_stats_output_module::printEvents(FILE *eventsOut,
   return;
 }
 
+// Write the events as complete ("X") events of the Chrome trace event format.
+// Timestamps are in microseconds since __kmp_stats_init() when the tick period
+// is known, raw ticks otherwise. Each OpenMP thread is shown as its own track.
+void kmp_stats_output_module::printTraceEvents(
+    FILE *traceOut, kmp_stats_event_vector *theEvents, int gtid, bool &first) {
+#if KMP_HAVE_TICK_TIME
+  double scale = tsc_tick_count::tick_time() * 1e6;
+#else
+  double scale = 1.0;
+#endif
+  int pid = getpid();
+
+  theEvents->sort();
+  for (int i = 0; i < theEvents->size(); i++) {
+    kmp_stats_event ev = theEvents->at(i);
+    fprintf(traceOut,
+            "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+            "\"ts\":%.3f,\"dur\":%.3f}",
+            first ? "\n" : ",\n", timeStat::name(ev.getTimerName()), pid, gtid,
+            ev.getStart() * scale, (ev.getStop() - ev.getStart()) * scale);
+    first = false;
+  }
+}
+
 void kmp_stats_output_module::windupExplicitTimers() {
   // Wind up any explicit timers. We assume that it's fair at this point to just
   // walk all the explicit timers in all threads and say "it's over".
@@ -807,6 +835,14 @@ void kmp_stats_output_module::outputStats(const char *heading) {
     eventsOut = fopen(eventsFileName, "w+");
   }
 
+  FILE *traceOut = NULL;
+  bool firstTraceEvent = true;
+  if (tracePrintingEnabled()) {
+    traceOut = fopen(traceFileName.c_str(), "w");
+    if (traceOut)
+      fprintf(traceOut, "{\"traceEvents\":[");
+  }
+
   printHeaderInfo(statsOut);
   fprintf(statsOut, "%s\n", heading);
   // Accumulate across threads.
@@ -825,6 +861,10 @@ void kmp_stats_output_module::outputStats(const char *heading) {
       kmp_stats_event_vector events = (*it)->getEventVector();
       printEvents(eventsOut, &events, t);
     }
+    if (traceOut) {
+      kmp_stats_event_vector events = (*it)->getEventVector();
+      printTraceEvents(traceOut, &events, t, firstTraceEvent);
+    }
 
     // Accumulate timers.
     for (timer_e s = timer_e(0); s < TIMER_LAST; s = timer_e(s + 1)) {
@@ -858,6 +898,11 @@ void kmp_stats_output_module::outputStats(const char *heading) {
     fclose(eventsOut);
   }
 
+  if (traceOut) {
+    fprintf(traceOut, "\n]}\n");
+    fclose(traceOut);
+  }
+
   fprintf(statsOut, "Aggregate for all threads\n");
   printTimerStats(statsOut, &allStats[0], &totalStats[0]);
   fprintf(statsOut, "\n");
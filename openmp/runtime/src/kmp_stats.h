@@ -810,6 +810,9 @@ public:
                        events
    KMP_STATS_EVENTS_FILE -- if set, all events are outputted to this file,
                             otherwise, output is sent to "events.dat"
+   KMP_STATS_TRACE_FILE -- if set, log events and also write them to this file
+                           in the Chrome trace event format, viewable with
+                           chrome://tracing or Perfetto
 **************************************************************** */
 class kmp_stats_output_module {
 
@@ -822,6 +825,7 @@ public:
 
 private:
   std::string outputFileName;
+  std::string traceFileName;
   static const char *eventsFileName;
   static const char *plotFileName;
   static int printPerThreadFlag;
@@ -839,9 +843,13 @@ private:
   static void printCounters(FILE *statsOut, counter const *theCounters);
   static void printEvents(FILE *eventsOut, kmp_stats_event_vector *theEvents,
                           int gtid);
+  static void printTraceEvents(FILE *traceOut,
+                               kmp_stats_event_vector *theEvents, int gtid,
+                               bool &first);
   static rgb_color getEventColor(timer_e e) { return timerColorInfo[e]; }
   static void windupExplicitTimers();
   bool eventPrintingEnabled() const { return printPerThreadEventsFlag; }
+  bool tracePrintingEnabled() const { return !traceFileName.empty(); }
 
 public:
   kmp_stats_output_module() { init(); }